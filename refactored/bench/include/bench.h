@@ -0,0 +1,144 @@
+/**
+ * bench.h
+ * Hot-Path Microbenchmarks
+ *
+ * The subset of the Google Benchmark API the benchmarks under bench/src
+ * use, so they read (and would build) the same against the real library,
+ * which the offline native toolchain can't fetch:
+ *
+ *   static void BM_thing(benchmark::State& state) {
+ *       for (auto _ : state) {
+ *           benchmark::DoNotOptimize(thing(state.range(0)));
+ *       }
+ *   }
+ *   BENCHMARK(BM_thing)->Arg(1)->Arg(8);
+ *
+ * The runner (bench_main.cpp) takes the library's flags
+ * (--benchmark_filter, _min_time, _repetitions, _format, _out) and writes
+ * its JSON format, so results can be diffed between branches with
+ * tools/bench_compare.py or the library's own compare.py.
+ *
+ * Runs on the host: figures are for comparing builds, not ESP32 timings.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace benchmark {
+
+class State;
+typedef void (*Function)(State& state);
+
+/**
+ * Per-run state: the timed loop and what the benchmark reports
+ */
+class State {
+public:
+    struct __attribute__((unused)) Value {};     // "for (auto _ : state)" without unused warnings
+
+    class Iterator {
+    public:
+        Iterator(State* parent, int64_t remaining) : parent_(parent), remaining_(remaining) {}
+        Value operator*(void) const { return Value(); }
+        Iterator& operator++(void) { --remaining_; return *this; }
+        bool operator!=(const Iterator&) {
+            if (remaining_ != 0) {
+                return true;
+            }
+            parent_->stopTimer();
+            return false;
+        }
+
+    private:
+        State* parent_;
+        int64_t remaining_;
+    };
+
+    State(int64_t iterations, const std::vector<int64_t>& args);
+
+    Iterator begin(void) { startTimer(); return Iterator(this, iterations_); }
+    Iterator end(void) { return Iterator(this, 0); }
+
+    int64_t iterations(void) const { return iterations_; }
+    int64_t range(size_t index = 0) const { return index < args_.size() ? args_[index] : 0; }
+
+    void SetItemsProcessed(int64_t items) { itemsProcessed_ = items; }
+    void SetBytesProcessed(int64_t bytes) { bytesProcessed_ = bytes; }
+    void SetLabel(const std::string& label) { label_ = label; }
+    void SkipWithError(const char* message) { error_ = message ? message : "error"; }
+
+    // Runner side
+    double realSeconds(void) const { return realNs_ / 1e9; }
+    double cpuSeconds(void) const { return cpuNs_ / 1e9; }
+    int64_t itemsProcessed(void) const { return itemsProcessed_; }
+    int64_t bytesProcessed(void) const { return bytesProcessed_; }
+    const std::string& label(void) const { return label_; }
+    const std::string& error(void) const { return error_; }
+
+private:
+    void startTimer(void);
+    void stopTimer(void);
+
+    int64_t iterations_;
+    std::vector<int64_t> args_;
+    int64_t realStartNs_;
+    int64_t cpuStartNs_;
+    int64_t realNs_;
+    int64_t cpuNs_;
+    int64_t itemsProcessed_;
+    int64_t bytesProcessed_;
+    std::string label_;
+    std::string error_;
+};
+
+/**
+ * A registered benchmark (one family; each Arg() adds an instance)
+ */
+class Benchmark {
+public:
+    Benchmark(const char* name, Function fn) : name_(name), fn_(fn) {}
+    Benchmark* Arg(int64_t value) { args_.push_back(value); return this; }
+
+    const std::string& name(void) const { return name_; }
+    Function function(void) const { return fn_; }
+    const std::vector<int64_t>& args(void) const { return args_; }
+
+private:
+    std::string name_;
+    Function fn_;
+    std::vector<int64_t> args_;
+};
+
+/**
+ * Register a benchmark (BENCHMARK() does this at static init)
+ */
+Benchmark* RegisterBenchmark(const char* name, Function fn);
+
+/**
+ * Keep a value the compiler would otherwise drop as unused
+ */
+template <class T>
+inline void DoNotOptimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Force pending writes to memory
+ */
+inline void ClobberMemory(void) {
+    asm volatile("" : : : "memory");
+}
+
+} // namespace benchmark
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_(a, b)
+#define BENCHMARK(fn) \
+    static benchmark::Benchmark* BENCH_CONCAT(benchReg_, __LINE__) __attribute__((unused)) = \
+        benchmark::RegisterBenchmark(#fn, fn)
+
+#endif // BENCH_H
@@ -0,0 +1,51 @@
+/**
+ * bench_control.cpp
+ * Control Loop Benchmarks
+ *
+ * The single-mode steps are reached through output_manager_internal.h.
+ * The clock is moved one control period per iteration so every call
+ * computes a new output instead of hitting the "too soon" return.
+ */
+
+#include "bench.h"
+#include "host.h"
+#include "output_manager_internal.h"
+
+#define BENCH_CONTROL_PERIOD_US 100000      // controlTask interval
+
+/**
+ * Measurement that wanders around the target by a few LSBs
+ */
+static float benchReading(int64_t i) {
+    return 29.5f + (float)(i & 15) * 0.0625f;
+}
+
+static void BM_updatePID(benchmark::State& state) {
+    int64_t i = 0;
+    for (auto _ : state) {
+        host_clock_advance(BENCH_CONTROL_PERIOD_US);
+        benchmark::DoNotOptimize(output_manager_step_pid(0, benchReading(i++)));
+    }
+}
+BENCHMARK(BM_updatePID);
+
+static void BM_updateTimeProp(benchmark::State& state) {
+    int64_t i = 0;
+    for (auto _ : state) {
+        host_clock_advance(BENCH_CONTROL_PERIOD_US);
+        benchmark::DoNotOptimize(output_manager_step_time_prop(1, benchReading(i++)));
+    }
+}
+BENCHMARK(BM_updateTimeProp);
+
+/**
+ * One full control tick: sensor lookups, energy, model, all three outputs
+ * (and, amortized, the hourly energy save to preferences)
+ */
+static void BM_output_manager_update(benchmark::State& state) {
+    for (auto _ : state) {
+        host_clock_advance(BENCH_CONTROL_PERIOD_US);
+        output_manager_update();
+    }
+}
+BENCHMARK(BM_output_manager_update);
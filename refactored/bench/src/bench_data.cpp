@@ -0,0 +1,110 @@
+/**
+ * bench_data.cpp
+ * Sensor Lookup, History and Console Benchmarks
+ *
+ * Public module APIs only, against the state bench_main.cpp set up
+ * (simulated sensors assigned to outputs, a warmed-up console store).
+ */
+
+#include "bench.h"
+#include "console.h"
+#include "host.h"
+#include "sensor_manager.h"
+#include "temp_history.h"
+
+// ===== SENSORS =====
+
+/**
+ * Look up the sensor at an index (3 outputs x up to 3 lookups per tick);
+ * an index past the last sensor looks up an unknown address (full scan)
+ */
+static void BM_sensor_manager_get_sensor_by_address(benchmark::State& state) {
+    int index = (int)state.range(0);
+    char address[24] = "28FFFFFFFFFFFFFF";
+    const SensorInfo_t* sensor = sensor_manager_get_sensor(index);
+    if (sensor) {
+        strncpy(address, sensor->addressString, sizeof(address) - 1);
+    } else if (index < sensor_manager_get_count()) {
+        state.SkipWithError("no sensor");
+        return;
+    }
+    state.SetLabel(sensor ? "hit" : "miss");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sensor_manager_get_sensor_by_address(address));
+    }
+}
+BENCHMARK(BM_sensor_manager_get_sensor_by_address)->Arg(0)->Arg(2)->Arg(3);
+
+// ===== HISTORY =====
+
+/**
+ * Call from loop() between samples (returns at the interval check)
+ */
+static void BM_temp_history_record_idle(benchmark::State& state) {
+    temp_history_record(28.0f);
+    for (auto _ : state) {
+        temp_history_record(28.0f);
+    }
+}
+BENCHMARK(BM_temp_history_record_idle);
+
+/**
+ * Call that stores a sample (clock moved one interval per iteration)
+ */
+static void BM_temp_history_record_sample(benchmark::State& state) {
+    float temp = 28.0f;
+    for (auto _ : state) {
+        host_clock_advance((uint64_t)HISTORY_SAMPLE_INTERVAL * 1000ULL);
+        temp_history_record(temp);
+        temp += 0.0625f;
+    }
+}
+BENCHMARK(BM_temp_history_record_sample);
+
+/**
+ * Read every point, oldest first, as /api/history does
+ */
+static void BM_temp_history_get_point(benchmark::State& state) {
+    while (temp_history_get_count() < HISTORY_BUFFER_SIZE) {
+        host_clock_advance((uint64_t)HISTORY_SAMPLE_INTERVAL * 1000ULL);
+        temp_history_record(28.0f);
+    }
+    for (auto _ : state) {
+        float sum = 0;
+        for (int i = 0; i < HISTORY_BUFFER_SIZE; i++) {
+            sum += temp_history_get_point(i)->temperature;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * HISTORY_BUFFER_SIZE);
+}
+BENCHMARK(BM_temp_history_get_point);
+
+// ===== CONSOLE =====
+
+/**
+ * A typical control event: formatted, timestamped and appended to a full
+ * store (so each append also drops the oldest records)
+ */
+static void BM_console_add_event_f(benchmark::State& state) {
+    int i = 0;
+    for (auto _ : state) {
+        console_add_event_f(CONSOLE_EVENT_PID, "Output %d: PID %.1f%% (temp %.2f, target %.1f)",
+                            (i % 3) + 1, 42.5f, 29.75f, 30.0f);
+        i++;
+    }
+}
+BENCHMARK(BM_console_add_event_f);
+
+/**
+ * The per-round temperature event, stored packed
+ */
+static void BM_console_add_event_p(benchmark::State& state) {
+    int i = 0;
+    for (auto _ : state) {
+        console_add_event_p(CONSOLE_EVENT_TEMP, CONSOLE_FMT_TEMP, 20.0f + (i % 50) * 0.1f);
+        i++;
+    }
+}
+BENCHMARK(BM_console_add_event_p);
@@ -0,0 +1,562 @@
+/**
+ * bench_main.cpp
+ * Hot-Path Microbenchmark Runner
+ *
+ * Usage: program [--benchmark_filter=REGEX] [--benchmark_min_time=SECONDS|Nx]
+ *                [--benchmark_repetitions=N] [--benchmark_format=console|json]
+ *                [--benchmark_out=FILE] [--benchmark_list_tests] [--firmware_log]
+ *
+ * Brings the firmware modules up the way setup() does (simulated sensors,
+ * preferences in a temporary directory), then runs the registered
+ * benchmarks. Results go to stdout; the firmware's Serial output is
+ * dropped unless --firmware_log sends it to stderr.
+ */
+
+#include <Arduino.h>
+#include <dirent.h>
+#include <math.h>
+#include <regex>
+#include <signal.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include "bench.h"
+#include "config.h"
+#include "console.h"
+#include "event_bus.h"
+#include "heap_monitor.h"
+#include "host.h"
+#include "host_sim.h"
+#include "output_manager.h"
+#include "sensor_manager.h"
+#include "temp_history.h"
+
+#define I2C_SDA_PIN 21                  // Same as main.cpp
+#define I2C_SCL_PIN 26
+#define MAX_ITERATIONS 1000000000LL
+#define DEFAULT_MIN_TIME_SEC 0.5
+#define WARMUP_STEP_US 100000           // Virtual control ticks before the first benchmark
+#define WARMUP_STEPS 100
+
+static char dataDir[] = "/tmp/vt_bench.XXXXXX";
+static uint32_t localIP = 0;
+
+// ===== HOST PROCESS =====
+
+const char* host_data_dir(void) {
+    return dataDir;
+}
+
+uint16_t host_http_port(void) {
+    return 0;       // Any free port: benchmarks serve() requests without connecting
+}
+
+uint32_t host_local_ip(void) {
+    return localIP;
+}
+
+bool host_restarted(void) {
+    return false;
+}
+
+void host_restart(void) {
+    fprintf(stderr, "bench: firmware asked to restart\n");
+    _exit(1);
+}
+
+// ===== HARNESS =====
+
+namespace benchmark {
+
+static std::vector<Benchmark*>& registry(void) {
+    static std::vector<Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+Benchmark* RegisterBenchmark(const char* name, Function fn) {
+    Benchmark* b = new Benchmark(name, fn);
+    registry().push_back(b);
+    return b;
+}
+
+static int64_t clockNs(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+State::State(int64_t iterations, const std::vector<int64_t>& args)
+    : iterations_(iterations), args_(args), realStartNs_(0), cpuStartNs_(0), realNs_(0), cpuNs_(0),
+      itemsProcessed_(0), bytesProcessed_(0) {}
+
+void State::startTimer(void) {
+    cpuStartNs_ = clockNs(CLOCK_THREAD_CPUTIME_ID);
+    realStartNs_ = clockNs(CLOCK_MONOTONIC);
+}
+
+void State::stopTimer(void) {
+    realNs_ = clockNs(CLOCK_MONOTONIC) - realStartNs_;
+    cpuNs_ = clockNs(CLOCK_THREAD_CPUTIME_ID) - cpuStartNs_;
+}
+
+} // namespace benchmark
+
+using benchmark::Benchmark;
+using benchmark::State;
+
+/**
+ * One benchmark instance (family + argument)
+ */
+typedef struct {
+    const Benchmark* family;
+    int familyIndex;
+    int instanceIndex;
+    std::vector<int64_t> args;
+    std::string name;
+} Instance_t;
+
+/**
+ * One reported row: a repetition or an aggregate
+ */
+typedef struct {
+    const Instance_t* instance;
+    const char* aggregate;          // nullptr for a repetition
+    int repetitionIndex;
+    int64_t iterations;
+    double realNs;                  // Per iteration
+    double cpuNs;
+    double itemsPerSec;             // 0 if not set
+    double bytesPerSec;
+    std::string label;
+    std::string error;
+} Result_t;
+
+static struct {
+    std::string filter;
+    double minTimeSec = DEFAULT_MIN_TIME_SEC;
+    int64_t fixedIterations = 0;    // --benchmark_min_time=Nx
+    int repetitions = 1;
+    bool json = false;
+    std::string outPath;
+    bool listTests = false;
+    bool firmwareLog = false;
+} options;
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --benchmark_filter=REGEX         Run matching benchmarks ('-REGEX' excludes)\n"
+            "  --benchmark_min_time=S|Nx        Seconds per run (default %.1f), or N iterations\n"
+            "  --benchmark_repetitions=N        Runs per benchmark, with mean/median/stddev\n"
+            "  --benchmark_format=console|json  Format on stdout (default console)\n"
+            "  --benchmark_out=FILE             Also write JSON to FILE\n"
+            "  --benchmark_list_tests           List benchmarks and exit\n"
+            "  --firmware_log                   Firmware Serial output to stderr\n",
+            name, DEFAULT_MIN_TIME_SEC);
+    exit(2);
+}
+
+static bool parseFlag(const char* arg, const char* name, const char** value) {
+    size_t len = strlen(name);
+    if (strncmp(arg, name, len) != 0 || arg[len] != '=') {
+        return false;
+    }
+    *value = arg + len + 1;
+    return true;
+}
+
+static void parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const char* value;
+        if (parseFlag(argv[i], "--benchmark_filter", &value)) {
+            options.filter = value;
+        } else if (parseFlag(argv[i], "--benchmark_min_time", &value)) {
+            char* end;
+            double n = strtod(value, &end);
+            if (end == value || n <= 0) usage(argv[0]);
+            if (*end == 'x') {
+                options.fixedIterations = (int64_t)n;
+            } else if (*end == '\0' || strcmp(end, "s") == 0) {
+                options.minTimeSec = n;
+            } else {
+                usage(argv[0]);
+            }
+        } else if (parseFlag(argv[i], "--benchmark_repetitions", &value)) {
+            options.repetitions = atoi(value);
+            if (options.repetitions < 1) usage(argv[0]);
+        } else if (parseFlag(argv[i], "--benchmark_format", &value)) {
+            if (strcmp(value, "json") == 0) {
+                options.json = true;
+            } else if (strcmp(value, "console") != 0) {
+                usage(argv[0]);
+            }
+        } else if (parseFlag(argv[i], "--benchmark_out", &value)) {
+            options.outPath = value;
+        } else if (parseFlag(argv[i], "--benchmark_out_format", &value)) {
+            if (strcmp(value, "json") != 0) usage(argv[0]);
+        } else if (strcmp(argv[i], "--benchmark_list_tests") == 0) {
+            options.listTests = true;
+        } else if (strcmp(argv[i], "--firmware_log") == 0) {
+            options.firmwareLog = true;
+        } else {
+            usage(argv[0]);
+        }
+    }
+}
+
+/**
+ * Expand families into instances and apply the filter
+ */
+static std::vector<Instance_t> selectInstances(void) {
+    bool negate = !options.filter.empty() && options.filter[0] == '-';
+    std::regex pattern(negate ? options.filter.substr(1) : options.filter);
+
+    std::vector<Instance_t> instances;
+    const std::vector<Benchmark*>& families = benchmark::registry();
+    for (size_t f = 0; f < families.size(); f++) {
+        std::vector<std::vector<int64_t>> argSets;
+        for (int64_t a : families[f]->args()) {
+            argSets.push_back({a});
+        }
+        if (argSets.empty()) {
+            argSets.push_back({});
+        }
+        int instanceIndex = 0;
+        for (const auto& args : argSets) {
+            std::string name = families[f]->name();
+            for (int64_t a : args) {
+                name += "/" + std::to_string(a);
+            }
+            if (!options.filter.empty() && std::regex_search(name, pattern) == negate) {
+                continue;
+            }
+            instances.push_back({families[f], (int)f, instanceIndex++, args, name});
+        }
+    }
+    return instances;
+}
+
+static Result_t makeResult(const Instance_t* instance, const State& state, int repetition) {
+    Result_t r;
+    r.instance = instance;
+    r.aggregate = nullptr;
+    r.repetitionIndex = repetition;
+    r.iterations = state.iterations();
+    r.realNs = state.realSeconds() * 1e9 / (double)state.iterations();
+    r.cpuNs = state.cpuSeconds() * 1e9 / (double)state.iterations();
+    double cpu = state.cpuSeconds() > 0 ? state.cpuSeconds() : state.realSeconds();
+    r.itemsPerSec = state.itemsProcessed() && cpu > 0 ? state.itemsProcessed() / cpu : 0;
+    r.bytesPerSec = state.bytesProcessed() && cpu > 0 ? state.bytesProcessed() / cpu : 0;
+    r.label = state.label();
+    r.error = state.error();
+    return r;
+}
+
+/**
+ * Run an instance: grow the iteration count until a run takes the minimum
+ * time (or use the fixed count), then repeat it at that count
+ */
+static void runInstance(const Instance_t* instance, std::vector<Result_t>* results) {
+    int64_t iterations = options.fixedIterations > 0 ? options.fixedIterations : 1;
+    for (;;) {
+        State state(iterations, instance->args);
+        instance->family->function()(state);
+        if (!state.error().empty() || options.fixedIterations > 0 ||
+            state.realSeconds() >= options.minTimeSec || iterations >= MAX_ITERATIONS) {
+            results->push_back(makeResult(instance, state, 0));
+            break;
+        }
+        double multiplier = state.realSeconds() > 0 ? options.minTimeSec * 1.4 / state.realSeconds() : 10.0;
+        multiplier = multiplier > 10.0 ? 10.0 : multiplier;
+        int64_t next = (int64_t)(iterations * multiplier + 0.5);
+        iterations = next > iterations ? next : iterations + 1;
+        iterations = iterations < MAX_ITERATIONS ? iterations : MAX_ITERATIONS;
+    }
+    if (!results->back().error.empty()) {
+        return;
+    }
+
+    size_t first = results->size() - 1;
+    for (int rep = 1; rep < options.repetitions; rep++) {
+        State state(iterations, instance->args);
+        instance->family->function()(state);
+        results->push_back(makeResult(instance, state, rep));
+    }
+    if (options.repetitions < 2) {
+        return;
+    }
+
+    // Aggregates over the repetitions, as the library reports them
+    std::vector<Result_t> reps(results->begin() + first, results->end());
+    int n = (int)reps.size();
+    auto stat = [&](const char* name, double (*pick)(const Result_t&)) {
+        std::vector<double> v;
+        for (const Result_t& r : reps) v.push_back(pick(r));
+        std::sort(v.begin(), v.end());
+        double mean = 0;
+        for (double x : v) mean += x;
+        mean /= n;
+        if (strcmp(name, "mean") == 0) return mean;
+        if (strcmp(name, "median") == 0) return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+        double var = 0;
+        for (double x : v) var += (x - mean) * (x - mean);
+        return sqrt(var / (n - 1));
+    };
+    static const char* AGGREGATES[] = {"mean", "median", "stddev"};
+    for (const char* name : AGGREGATES) {
+        Result_t a = reps[0];
+        a.aggregate = name;
+        a.iterations = n;
+        a.realNs = stat(name, [](const Result_t& r) { return r.realNs; });
+        a.cpuNs = stat(name, [](const Result_t& r) { return r.cpuNs; });
+        a.itemsPerSec = stat(name, [](const Result_t& r) { return r.itemsPerSec; });
+        a.bytesPerSec = stat(name, [](const Result_t& r) { return r.bytesPerSec; });
+        results->push_back(a);
+    }
+}
+
+// ===== REPORTS =====
+
+static std::string resultName(const Result_t& r) {
+    return r.aggregate ? r.instance->name + "_" + r.aggregate : r.instance->name;
+}
+
+static void writeJsonString(FILE* out, const std::string& s) {
+    fputc('"', out);
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            fprintf(out, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static double cpuMhz(void) {
+    FILE* f = fopen("/proc/cpuinfo", "r");
+    double mhz = 0;
+    char line[256];
+    while (f && fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "cpu MHz : %lf", &mhz) == 1) {
+            break;
+        }
+    }
+    if (f) fclose(f);
+    return mhz;
+}
+
+/**
+ * Google Benchmark JSON (context + benchmarks)
+ */
+static void writeJson(FILE* out, const std::vector<Result_t>& results, const char* executable) {
+    char date[32];
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", &local);
+    struct utsname host;
+    uname(&host);
+    double load[3] = {0, 0, 0};
+    getloadavg(load, 3);
+
+    fprintf(out, "{\n  \"context\": {\n");
+    fprintf(out, "    \"date\": \"%s\",\n", date);
+    fprintf(out, "    \"host_name\": ");
+    writeJsonString(out, host.nodename);
+    fprintf(out, ",\n    \"executable\": ");
+    writeJsonString(out, executable);
+    fprintf(out, ",\n    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(out, "    \"mhz_per_cpu\": %.0f,\n", cpuMhz());
+    fprintf(out, "    \"cpu_scaling_enabled\": false,\n");
+    fprintf(out, "    \"load_avg\": [%.2f, %.2f, %.2f],\n", load[0], load[1], load[2]);
+#ifdef __OPTIMIZE__
+    fprintf(out, "    \"library_build_type\": \"release\",\n");
+#else
+    fprintf(out, "    \"library_build_type\": \"debug\",\n");
+#endif
+    fprintf(out, "    \"firmware_version\": \"%s\"\n  },\n", FIRMWARE_VERSION);
+
+    fprintf(out, "  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result_t& r = results[i];
+        fprintf(out, "%s\n    {\n      \"name\": ", i ? "," : "");
+        writeJsonString(out, resultName(r));
+        fprintf(out, ",\n      \"family_index\": %d,\n", r.instance->familyIndex);
+        fprintf(out, "      \"per_family_instance_index\": %d,\n", r.instance->instanceIndex);
+        fprintf(out, "      \"run_name\": ");
+        writeJsonString(out, r.instance->name);
+        fprintf(out, ",\n      \"run_type\": \"%s\",\n", r.aggregate ? "aggregate" : "iteration");
+        fprintf(out, "      \"repetitions\": %d,\n", options.repetitions);
+        if (r.aggregate) {
+            fprintf(out, "      \"threads\": 1,\n      \"aggregate_name\": \"%s\",\n", r.aggregate);
+            fprintf(out, "      \"aggregate_unit\": \"time\",\n");
+        } else {
+            fprintf(out, "      \"repetition_index\": %d,\n      \"threads\": 1,\n", r.repetitionIndex);
+        }
+        if (!r.error.empty()) {
+            fprintf(out, "      \"error_occurred\": true,\n      \"error_message\": ");
+            writeJsonString(out, r.error);
+            fprintf(out, "\n    }");
+            continue;
+        }
+        fprintf(out, "      \"iterations\": %lld,\n", (long long)r.iterations);
+        fprintf(out, "      \"real_time\": %.6e,\n", r.realNs);
+        fprintf(out, "      \"cpu_time\": %.6e,\n", r.cpuNs);
+        fprintf(out, "      \"time_unit\": \"ns\"");
+        if (r.itemsPerSec > 0) {
+            fprintf(out, ",\n      \"items_per_second\": %.6e", r.itemsPerSec);
+        }
+        if (r.bytesPerSec > 0) {
+            fprintf(out, ",\n      \"bytes_per_second\": %.6e", r.bytesPerSec);
+        }
+        if (!r.label.empty()) {
+            fprintf(out, ",\n      \"label\": ");
+            writeJsonString(out, r.label);
+        }
+        fprintf(out, "\n    }");
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static void writeConsoleHeader(FILE* out, size_t nameWidth) {
+    std::string rule(nameWidth + 44, '-');
+    fprintf(out, "%s\n%-*s %13s %15s %12s\n%s\n", rule.c_str(), (int)nameWidth, "Benchmark", "Time", "CPU",
+            "Iterations", rule.c_str());
+}
+
+static void writeConsoleRow(FILE* out, const Result_t& r, size_t nameWidth) {
+    std::string name = resultName(r);
+    if (!r.error.empty()) {
+        fprintf(out, "%-*s ERROR OCCURRED: '%s'\n", (int)nameWidth, name.c_str(), r.error.c_str());
+        return;
+    }
+    fprintf(out, "%-*s %10.1f ns %12.1f ns %12lld", (int)nameWidth, name.c_str(), r.realNs, r.cpuNs,
+            (long long)r.iterations);
+    if (r.itemsPerSec > 0) {
+        fprintf(out, " items_per_second=%.4gM/s", r.itemsPerSec / 1e6);
+    }
+    if (r.bytesPerSec > 0) {
+        fprintf(out, " bytes_per_second=%.4gMi/s", r.bytesPerSec / (1024.0 * 1024.0));
+    }
+    if (!r.label.empty()) {
+        fprintf(out, " %s", r.label.c_str());
+    }
+    fputc('\n', out);
+}
+
+// ===== FIRMWARE =====
+
+/**
+ * Bring the modules up as setup() does, up to the control task, then run
+ * some virtual time so outputs hold readings and the PID has history
+ */
+static void firmwareInit(void) {
+    host_sim_init(22.0f, HOST_SIM_SENSORS);
+    console_init();
+    temp_history_init(millis());
+    event_bus_init();
+    heap_monitor_init();
+    sensor_manager_init(ONE_WIRE_BUS, I2C_SDA_PIN, I2C_SCL_PIN);
+    output_manager_init();
+
+    static const ControlMode_t MODES[] = {CONTROL_MODE_PID, CONTROL_MODE_TIME_PROP, CONTROL_MODE_ONOFF};
+    for (int i = 0; i < 3 && i < sensor_manager_get_count(); i++) {
+        output_manager_set_sensor(i, sensor_manager_get_sensor(i)->addressString);
+        output_manager_set_enabled(i, true);
+        output_manager_set_mode(i, MODES[i]);
+        output_manager_set_target(i, 30.0f);
+    }
+
+    for (int i = 0; i < WARMUP_STEPS; i++) {
+        host_clock_advance(WARMUP_STEP_US);
+        sensor_manager_poll();
+        output_manager_update();
+    }
+}
+
+static void removeDataDir(void) {
+    DIR* dir = opendir(dataDir);
+    struct dirent* entry;
+    while (dir && (entry = readdir(dir))) {
+        if (entry->d_name[0] != '.') {
+            std::string path = std::string(dataDir) + "/" + entry->d_name;
+            unlink(path.c_str());
+        }
+    }
+    if (dir) closedir(dir);
+    rmdir(dataDir);
+}
+
+int main(int argc, char** argv) {
+    parseArgs(argc, argv);
+    std::vector<Instance_t> instances = selectInstances();
+    if (options.listTests) {
+        for (const Instance_t& instance : instances) {
+            printf("%s\n", instance.name.c_str());
+        }
+        return 0;
+    }
+
+    // Results keep the real stdout; Serial (stdout) goes to stderr or nowhere
+    FILE* results = fdopen(dup(STDOUT_FILENO), "w");
+    int sink = options.firmwareLog ? dup(STDERR_FILENO) : open("/dev/null", O_WRONLY);
+    dup2(sink, STDOUT_FILENO);
+    close(sink);
+
+    if (!mkdtemp(dataDir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    atexit(removeDataDir);
+    signal(SIGPIPE, SIG_IGN);
+    inet_pton(AF_INET, "127.0.0.1", &localIP);
+    firmwareInit();
+
+    size_t nameWidth = 10;
+    for (const Instance_t& instance : instances) {
+        size_t width = instance.name.size() + (options.repetitions > 1 ? 7 : 0);
+        nameWidth = width > nameWidth ? width : nameWidth;
+    }
+    if (!options.json) {
+        fprintf(stderr, "Run on (%ld X %.0f MHz CPU s), firmware v%s\n", sysconf(_SC_NPROCESSORS_ONLN),
+                cpuMhz(), FIRMWARE_VERSION);
+        writeConsoleHeader(results, nameWidth);
+    }
+
+    std::vector<Result_t> all;
+    for (const Instance_t& instance : instances) {
+        size_t first = all.size();
+        runInstance(&instance, &all);
+        if (!options.json) {
+            for (size_t i = first; i < all.size(); i++) {
+                writeConsoleRow(results, all[i], nameWidth);
+            }
+            fflush(results);
+        }
+    }
+
+    if (options.json) {
+        writeJson(results, all, argv[0]);
+    }
+    if (!options.outPath.empty()) {
+        FILE* out = fopen(options.outPath.c_str(), "w");
+        if (!out) {
+            perror(options.outPath.c_str());
+            return 1;
+        }
+        writeJson(out, all, argv[0]);
+        fclose(out);
+    }
+    fflush(results);
+
+    for (const Result_t& r : all) {
+        if (!r.error.empty()) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * bench_mqtt.cpp
+ * MQTT and Web API Benchmarks
+ *
+ * mqtt_publish_all_outputs() runs against a sink on 127.0.0.1 that
+ * accepts the connection and discards what it is sent, so the figure is
+ * the topic/JSON formatting plus the client's socket writes.
+ *
+ * Web routes are served without a connection through the host
+ * WebServer's serve() on the server webserver_init() started
+ * (WebServer::active()), which keeps the response in memory.
+ */
+
+#include "bench.h"
+#include "mqtt_manager.h"
+#include "web_server.h"
+#include <Preferences.h>
+#include <WebServer.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+// ===== MQTT =====
+
+/**
+ * Accept one client, answer its CONNECT and drop everything after
+ */
+static void sinkServe(int listenFd) {
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0) {
+        return;
+    }
+    uint8_t buf[4096];
+    if (recv(fd, buf, sizeof(buf), 0) > 0) {
+        static const uint8_t CONNACK[] = {0x20, 0x02, 0x00, 0x00};
+        send(fd, CONNACK, sizeof(CONNACK), MSG_NOSIGNAL);
+        while (recv(fd, buf, sizeof(buf), 0) > 0) {
+        }
+    }
+    close(fd);
+}
+
+/**
+ * Start the sink and connect the firmware's client to it
+ * @return true if connected
+ */
+static bool mqttSetup(void) {
+    static bool ready = false;
+    if (ready) {
+        return mqtt_is_connected();
+    }
+    ready = true;
+
+    int listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (listenFd < 0 || bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 1) < 0 ||
+        getsockname(listenFd, (struct sockaddr*)&addr, &len) < 0) {
+        return false;
+    }
+    std::thread(sinkServe, listenFd).detach();
+
+    Preferences prefs;
+    prefs.begin("thermostat", false);
+    prefs.putString("mqtt_broker", "127.0.0.1");
+    prefs.putFloat("mqtt_port", (float)ntohs(addr.sin_port));
+    prefs.end();
+
+    mqtt_init();
+    return mqtt_connect();
+}
+
+static void BM_mqtt_publish_all_outputs(benchmark::State& state) {
+    if (!mqttSetup()) {
+        state.SkipWithError("MQTT sink not connected");
+        return;
+    }
+    for (auto _ : state) {
+        mqtt_publish_all_outputs(-52, ESP.getFreeHeap(), millis() / 1000);
+    }
+}
+BENCHMARK(BM_mqtt_publish_all_outputs);
+
+// ===== WEB =====
+
+/**
+ * Start the firmware's web server once
+ * @return The server, nullptr if it did not start
+ */
+static WebServer* webSetup(void) {
+    static bool ready = false;
+    if (!ready) {
+        webserver_init();
+        ready = true;
+    }
+    return WebServer::active();
+}
+
+/**
+ * GET /api/outputs: three output snapshots built into a document and
+ * serialized into the response
+ */
+static void BM_handleOutputsAPI(benchmark::State& state) {
+    WebServer* server = webSetup();
+    if (!server) {
+        state.SkipWithError("web server not started");
+        return;
+    }
+    std::string response;
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        response.clear();
+        server->serve(HTTP_GET, "/api/outputs", &response);
+        bytes += (int64_t)response.size();
+    }
+    if (response.compare(0, 12, "HTTP/1.1 200") != 0) {
+        state.SkipWithError("/api/outputs did not return 200");
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_handleOutputsAPI);
@@ -0,0 +1,261 @@
+/**
+ * Arduino.h
+ * Host Shim: Arduino Core
+ *
+ * Just enough of the ESP32 Arduino core for the firmware to build and run
+ * as a Linux process (pio run -e host): String, Print, Serial (stdout),
+ * millis()/micros() from the monotonic clock, simulated GPIO and the ESP
+ * object. Behaviour follows the ESP32 core where the firmware depends on
+ * it (String number formatting, Print overloads).
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_system.h"
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+
+#define PROGMEM
+#define F(s) (s)
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ===== TIME / GPIO =====
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+uint32_t esp_random(void);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+void configTzTime(const char* tz, const char* server1, const char* server2 = nullptr,
+                  const char* server3 = nullptr);
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+// ===== STRING =====
+
+class String {
+public:
+    String(const char* s = "") : s_(s ? s : "") {}
+    String(const String& other) = default;
+    String(String&& other) = default;
+    explicit String(const std::string& s) : s_(s) {}
+    explicit String(char c) : s_(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimals = 2);
+    explicit String(double value, unsigned int decimals = 2);
+
+    String& operator=(const String& other) = default;
+    String& operator=(String&& other) = default;
+    String& operator=(const char* s) { s_ = s ? s : ""; return *this; }
+
+    const char* c_str(void) const { return s_.c_str(); }
+    unsigned int length(void) const { return (unsigned int)s_.size(); }
+    bool isEmpty(void) const { return s_.empty(); }
+    bool reserve(unsigned int size) { s_.reserve(size); return true; }
+
+    bool concat(const String& s) { s_ += s.s_; return true; }
+    bool concat(const char* s) { if (s) s_ += s; return s != nullptr; }
+    bool concat(const char* s, unsigned int len) { if (s) s_.append(s, len); return s != nullptr; }
+    bool concat(char c) { s_ += c; return true; }
+    template <typename T>
+    bool concat(T value) { return concat(String(value)); }
+
+    template <typename T>
+    String& operator+=(const T& value) { concat(value); return *this; }
+    String& operator+=(const char* s) { concat(s); return *this; }
+
+    bool equals(const String& s) const { return s_ == s.s_; }
+    bool equals(const char* s) const { return s_ == (s ? s : ""); }
+    bool equalsIgnoreCase(const String& s) const { return strcasecmp(c_str(), s.c_str()) == 0; }
+    int compareTo(const String& s) const { return strcmp(c_str(), s.c_str()); }
+    bool operator==(const String& s) const { return equals(s); }
+    bool operator==(const char* s) const { return equals(s); }
+    bool operator!=(const String& s) const { return !equals(s); }
+    bool operator!=(const char* s) const { return !equals(s); }
+    bool operator<(const String& s) const { return compareTo(s) < 0; }
+    bool startsWith(const String& prefix) const { return s_.compare(0, prefix.s_.size(), prefix.s_) == 0; }
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const { return index < s_.size() ? s_[index] : '\0'; }
+    void setCharAt(unsigned int index, char c) { if (index < s_.size()) s_[index] = c; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index);
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& s, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(const String& s) const;
+    String substring(unsigned int begin) const;
+    String substring(unsigned int begin, unsigned int end) const;
+
+    void replace(char find, char with);
+    void replace(const String& find, const String& with);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase(void);
+    void toUpperCase(void);
+    void trim(void);
+
+    long toInt(void) const { return atol(c_str()); }
+    float toFloat(void) const { return (float)atof(c_str()); }
+    double toDouble(void) const { return atof(c_str()); }
+    void getBytes(unsigned char* buf, unsigned int size, unsigned int index = 0) const;
+    void toCharArray(char* buf, unsigned int size, unsigned int index = 0) const {
+        getBytes((unsigned char*)buf, size, index);
+    }
+
+private:
+    std::string s_;
+};
+
+// Arduino's concatenation temporary; libraries that name it (ArduinoJson) see a String
+class StringSumHelper : public String {
+public:
+    using String::String;
+    StringSumHelper(const String& s) : String(s) {}
+};
+
+String operator+(const String& a, const String& b);
+String operator+(const String& a, const char* b);
+String operator+(const char* a, const String& b);
+String operator+(const String& a, char b);
+template <typename T>
+String operator+(const String& a, T b) {
+    String r(a);
+    r += b;
+    return r;
+}
+
+// ===== PRINT =====
+
+class Print;
+
+class Printable {
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t len);
+    size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+    size_t write(const char* buf, size_t len) { return write((const uint8_t*)buf, len); }
+    virtual void flush(void) {}
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = DEC) { return print(String(n, base)); }
+    size_t print(int n, int base = DEC) { return print(String(n, base)); }
+    size_t print(unsigned int n, int base = DEC) { return print(String(n, base)); }
+    size_t print(long n, int base = DEC) { return print(String(n, base)); }
+    size_t print(unsigned long n, int base = DEC) { return print(String(n, base)); }
+    size_t print(long long n, int base = DEC) { return print(String(n, base)); }
+    size_t print(unsigned long long n, int base = DEC) { return print(String(n, base)); }
+    size_t print(double n, int digits = 2) { return print(String(n, digits)); }
+    size_t print(const Printable& x) { return x.printTo(*this); }
+
+    size_t println(void) { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// ===== SERIAL =====
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end(void) {}
+    int available(void) { return 0; }
+    int read(void) { return -1; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t len) override;
+    using Print::write;
+    void flush(void) override;
+};
+
+extern HardwareSerial Serial;
+
+// ===== ESP =====
+
+class EspClass {
+public:
+    uint64_t getEfuseMac(void);
+    uint32_t getCycleCount(void);
+    uint32_t getFreeHeap(void);
+    uint32_t getHeapSize(void);
+    uint32_t getMinFreeHeap(void);
+    uint32_t getMaxAllocHeap(void);
+    uint32_t getCpuFreqMHz(void) { return 240; }
+    const char* getChipModel(void) { return "Host"; }
+    uint32_t getFlashChipSize(void) { return 4 * 1024 * 1024; }
+    uint32_t getFlashChipSpeed(void) { return 80000000; }
+    [[noreturn]] void restart(void);
+};
+
+extern EspClass ESP;
+
+#endif // HOST_ARDUINO_H
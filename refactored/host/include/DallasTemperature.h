@@ -0,0 +1,43 @@
+/**
+ * DallasTemperature.h
+ * Host Shim: DS18B20 Driver (readings come from host_sim.h)
+ *
+ * Conversions take the real 94-750ms: a reading taken before
+ * millisToWaitForConversion() has passed is the previous conversion,
+ * as on the device.
+ */
+
+#ifndef HOST_DALLASTEMPERATURE_H
+#define HOST_DALLASTEMPERATURE_H
+
+#include <Arduino.h>
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C -127
+
+typedef uint8_t DeviceAddress[8];
+
+class DallasTemperature {
+public:
+    explicit DallasTemperature(OneWire* bus) : bus_(bus), resolution_(12), waitForConversion_(true), requestedMs_(0) {}
+    void begin(void) {}
+    uint8_t getDeviceCount(void);
+    bool getAddress(uint8_t* address, uint8_t index);
+    void setResolution(uint8_t bits) { resolution_ = bits; }
+    void setResolution(const uint8_t* address, uint8_t bits) { (void)address; resolution_ = bits; }
+    uint8_t getResolution(void) { return resolution_; }
+    void setWaitForConversion(bool wait) { waitForConversion_ = wait; }
+    bool isConversionComplete(void);
+    int16_t millisToWaitForConversion(uint8_t bits);
+    void requestTemperatures(void);
+    bool requestTemperaturesByAddress(const uint8_t* address) { (void)address; requestTemperatures(); return true; }
+    float getTempC(const uint8_t* address);
+
+private:
+    OneWire* bus_;
+    uint8_t resolution_;
+    bool waitForConversion_;
+    unsigned long requestedMs_;
+};
+
+#endif // HOST_DALLASTEMPERATURE_H
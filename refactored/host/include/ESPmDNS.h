@@ -0,0 +1,27 @@
+/**
+ * ESPmDNS.h
+ * Host Shim: mDNS (accepted and ignored; use the --port URL)
+ */
+
+#ifndef HOST_ESPMDNS_H
+#define HOST_ESPMDNS_H
+
+#include <Arduino.h>
+
+class MDNSResponder {
+public:
+    bool begin(const char* hostname) { (void)hostname; return true; }
+    void end(void) {}
+    bool addService(const char* service, const char* proto, uint16_t port) {
+        (void)service; (void)proto; (void)port;
+        return true;
+    }
+    bool addServiceTxt(const char* service, const char* proto, const char* key, const char* value) {
+        (void)service; (void)proto; (void)key; (void)value;
+        return true;
+    }
+};
+
+extern MDNSResponder MDNS;
+
+#endif // HOST_ESPMDNS_H
@@ -0,0 +1,46 @@
+/**
+ * HTTPClient.h
+ * Host Shim: HTTP Client
+ *
+ * Update checks reach HTTPS hosts, which the host build has no TLS for:
+ * every request fails with HTTPC_ERROR_CONNECTION_REFUSED, the same path
+ * the firmware takes when the device is offline.
+ */
+
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include <Arduino.h>
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+typedef enum {
+    HTTPC_DISABLE_FOLLOW_REDIRECTS,
+    HTTPC_STRICT_FOLLOW_REDIRECTS,
+    HTTPC_FORCE_FOLLOW_REDIRECTS
+} followRedirects_t;
+
+class HTTPClient {
+public:
+    bool begin(const String& url) { url_ = url; return true; }
+    bool begin(WiFiClient& client, const String& url) { (void)client; return begin(url); }
+    void end(void) {}
+    void setFollowRedirects(followRedirects_t follow) { (void)follow; }
+    void setTimeout(uint16_t ms) { (void)ms; }
+    void setUserAgent(const String& agent) { (void)agent; }
+    void addHeader(const String& name, const String& value) { (void)name; (void)value; }
+    int GET(void) { return HTTPC_ERROR_CONNECTION_REFUSED; }
+    int POST(const String& payload) { (void)payload; return HTTPC_ERROR_CONNECTION_REFUSED; }
+    int getSize(void) { return -1; }
+    String getString(void) { return String(); }
+    WiFiClient* getStreamPtr(void) { return &stream_; }
+    bool connected(void) { return false; }
+    static String errorToString(int error) { (void)error; return String("connection refused (host build)"); }
+
+private:
+    String url_;
+    WiFiClient stream_;
+};
+
+#endif // HOST_HTTPCLIENT_H
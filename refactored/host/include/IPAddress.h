@@ -0,0 +1,30 @@
+/**
+ * IPAddress.h
+ * Host Shim: IPv4 Address
+ */
+
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress : public Printable {
+public:
+    IPAddress() : addr_(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : addr_((uint32_t)a | (uint32_t)b << 8 | (uint32_t)c << 16 | (uint32_t)d << 24) {}
+    IPAddress(uint32_t addr) : addr_(addr) {}   // Network byte order, as on the ESP32
+
+    bool fromString(const char* s);
+    bool fromString(const String& s) { return fromString(s.c_str()); }
+    String toString(void) const;
+    operator uint32_t() const { return addr_; }
+    uint8_t operator[](int index) const { return (uint8_t)(addr_ >> (8 * index)); }
+    bool operator==(const IPAddress& other) const { return addr_ == other.addr_; }
+    size_t printTo(Print& p) const override { return p.print(toString()); }
+
+private:
+    uint32_t addr_;
+};
+
+#endif // HOST_IPADDRESS_H
@@ -0,0 +1,23 @@
+/**
+ * OneWire.h
+ * Host Shim: 1-Wire Bus (enumerates the simulated sensors, host_sim.h)
+ */
+
+#ifndef HOST_ONEWIRE_H
+#define HOST_ONEWIRE_H
+
+#include <Arduino.h>
+
+class OneWire {
+public:
+    explicit OneWire(uint8_t pin) : pin_(pin), searchIndex_(0) {}
+    void reset_search(void) { searchIndex_ = 0; }
+    bool search(uint8_t* address);
+    static uint8_t crc8(const uint8_t* data, uint8_t len);
+
+private:
+    uint8_t pin_;
+    int searchIndex_;
+};
+
+#endif // HOST_ONEWIRE_H
@@ -0,0 +1,65 @@
+/**
+ * Preferences.h
+ * Host Shim: NVS Preferences, File-Backed
+ *
+ * Each namespace is a text file "<namespace>.nvs" in the data directory
+ * (host_data_dir(), --data), one "key type hex" line per entry, rewritten
+ * on every put so a killed process loses nothing. Types are checked like
+ * NVS: reading a key with a different type returns the default.
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+    Preferences() : open_(false), readOnly_(false) { ns_[0] = '\0'; }
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnly = false);
+    void end(void);
+    bool clear(void);
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBool(const char* key, bool value);
+    size_t putUChar(const char* key, uint8_t value);
+    size_t putUShort(const char* key, uint16_t value);
+    size_t putShort(const char* key, int16_t value);
+    size_t putInt(const char* key, int32_t value);
+    size_t putUInt(const char* key, uint32_t value);
+    size_t putLong(const char* key, int32_t value);
+    size_t putULong(const char* key, uint32_t value);
+    size_t putULong64(const char* key, uint64_t value);
+    size_t putFloat(const char* key, float value);
+    size_t putString(const char* key, const char* value);
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t len);
+
+    bool getBool(const char* key, bool defaultValue = false);
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0);
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0);
+    int16_t getShort(const char* key, int16_t defaultValue = 0);
+    int32_t getInt(const char* key, int32_t defaultValue = 0);
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+    int32_t getLong(const char* key, int32_t defaultValue = 0);
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0);
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0);
+    float getFloat(const char* key, float defaultValue = NAN);
+    String getString(const char* key, String defaultValue = String());
+    size_t getString(const char* key, char* value, size_t maxLen);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+    size_t put(const char* key, char type, const void* value, size_t len);
+    bool get(const char* key, char type, void* value, size_t len);
+
+    char ns_[16];
+    bool open_;
+    bool readOnly_;
+};
+
+#endif // HOST_PREFERENCES_H
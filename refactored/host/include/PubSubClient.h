@@ -0,0 +1,74 @@
+/**
+ * PubSubClient.h
+ * Host Shim: MQTT 3.1.1 Client
+ *
+ * The PubSubClient API over WiFiClient: CONNECT (with will), QoS 0
+ * PUBLISH, SUBSCRIBE, keepalive PINGREQ and incoming PUBLISH dispatch,
+ * so a virtual thermostat talks to a real broker (mosquitto) like the
+ * device does. No QoS 1/2, matching how the firmware uses it.
+ */
+
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <functional>
+#include "WiFiClient.h"
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient : public Print {
+public:
+    explicit PubSubClient(WiFiClient& client);
+    ~PubSubClient() override;
+
+    PubSubClient& setServer(const char* host, uint16_t port);
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+    PubSubClient& setKeepAlive(uint16_t seconds) { keepAliveSec_ = seconds; return *this; }
+    bool setBufferSize(uint16_t size);
+    uint16_t getBufferSize(void) { return bufferSize_; }
+
+    bool connect(const char* id);
+    bool connect(const char* id, const char* user, const char* pass);
+    bool connect(const char* id, const char* user, const char* pass, const char* willTopic,
+                 uint8_t willQos, bool willRetain, const char* willMessage);
+    void disconnect(void);
+    bool connected(void);
+    int state(void) { return state_; }
+    bool loop(void);
+
+    bool publish(const char* topic, const char* payload, bool retained = false);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained = false);
+    bool beginPublish(const char* topic, unsigned int length, bool retained);
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t len) override;
+    using Print::write;
+    int endPublish(void);
+    bool subscribe(const char* topic, uint8_t qos = 0);
+    bool unsubscribe(const char* topic);
+
+private:
+    bool sendPacket(uint8_t header, const uint8_t* body, size_t len);
+    bool readPacket(uint8_t* header, size_t* len);
+
+    WiFiClient* client_;
+    std::function<void(char*, uint8_t*, unsigned int)> callback_;
+    char host_[64];
+    uint16_t port_;
+    uint16_t keepAliveSec_;
+    uint16_t bufferSize_;
+    uint8_t* buffer_;
+    uint16_t nextMsgId_;
+    unsigned long lastOutMs_;
+    unsigned long lastInMs_;
+    bool pingOutstanding_;
+    int state_;
+};
+
+#endif // HOST_PUBSUBCLIENT_H
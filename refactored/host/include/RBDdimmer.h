@@ -0,0 +1,35 @@
+/**
+ * RBDdimmer.h
+ * Host Shim: AC Dimmer (power goes to the plant, host_sim.h)
+ */
+
+#ifndef HOST_RBDDIMMER_H
+#define HOST_RBDDIMMER_H
+
+#include <Arduino.h>
+#include "host_sim.h"
+
+enum DIMMER_MODE_typedef { NORMAL_MODE, TOGGLE_MODE };
+enum ON_OFF_typedef { OFF, ON };
+
+class dimmerLamp {
+public:
+    dimmerLamp(int pin, int zeroCrossPin) : pin_((uint8_t)pin), power_(0), on_(true) { (void)zeroCrossPin; }
+    void begin(DIMMER_MODE_typedef mode, ON_OFF_typedef state) { (void)mode; setState(state); }
+    void setPower(int power) {
+        power_ = constrain(power, 0, 100);
+        host_sim_set_dimmer(pin_, on_ ? power_ : 0);
+    }
+    int getPower(void) { return power_; }
+    void setState(ON_OFF_typedef state) {
+        on_ = (state == ON);
+        host_sim_set_dimmer(pin_, on_ ? power_ : 0);
+    }
+
+private:
+    uint8_t pin_;
+    int power_;
+    bool on_;
+};
+
+#endif // HOST_RBDDIMMER_H
@@ -0,0 +1,11 @@
+/**
+ * SPI.h
+ * Host Shim: SPI (nothing on the bus)
+ */
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <Arduino.h>
+
+#endif // HOST_SPI_H
@@ -0,0 +1,95 @@
+/**
+ * TFT_eSPI.h
+ * Host Shim: TFT Display (draws nothing; the web UI is the screen here)
+ */
+
+#ifndef HOST_TFT_ESPI_H
+#define HOST_TFT_ESPI_H
+
+#include <Arduino.h>
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_DARKCYAN 0x03EF
+#define TFT_MAROON 0x7800
+#define TFT_PURPLE 0x780F
+#define TFT_OLIVE 0x7BE0
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_DARKGREY 0x7BEF
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+#define TFT_GREENYELLOW 0xB7E0
+#define TFT_PINK 0xFE19
+#define TFT_BROWN 0x9A60
+#define TFT_GOLD 0xFEA0
+#define TFT_SILVER 0xC618
+#define TFT_SKYBLUE 0x867D
+#define TFT_VIOLET 0x915C
+#define TFT_GREY 0x8410
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+class TFT_eSPI : public Print {
+public:
+    TFT_eSPI(int16_t width = 240, int16_t height = 320) : width_(width), height_(height) {}
+    void init(void) {}
+    void begin(void) {}
+    void setRotation(uint8_t rotation) { if (rotation & 1) std::swap(width_, height_); }
+    int16_t width(void) const { return width_; }
+    int16_t height(void) const { return height_; }
+    void writecommand(uint8_t c) { (void)c; }
+
+    void fillScreen(uint32_t color) { (void)color; }
+    void drawPixel(int32_t x, int32_t y, uint32_t color) { (void)x; (void)y; (void)color; }
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) { (void)x0; (void)y0; (void)x1; (void)y1; (void)color; }
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { (void)x; (void)y; (void)w; (void)color; }
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { (void)x; (void)y; (void)h; (void)color; }
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) { (void)x; (void)y; (void)w; (void)h; (void)color; }
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) { (void)x; (void)y; (void)w; (void)h; (void)color; }
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) { (void)x; (void)y; (void)w; (void)h; (void)r; (void)color; }
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) { (void)x; (void)y; (void)w; (void)h; (void)r; (void)color; }
+    void drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color) { (void)x; (void)y; (void)r; (void)color; }
+    void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color) { (void)x; (void)y; (void)r; (void)color; }
+    void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color) {
+        (void)x0; (void)y0; (void)x1; (void)y1; (void)x2; (void)y2; (void)color;
+    }
+    uint16_t color565(uint8_t r, uint8_t g, uint8_t b) { return (uint16_t)((r & 0xF8) << 8 | (g & 0xFC) << 3 | b >> 3); }
+
+    void setTextColor(uint16_t fg) { (void)fg; }
+    void setTextColor(uint16_t fg, uint16_t bg, bool fill = false) { (void)fg; (void)bg; (void)fill; }
+    void setTextDatum(uint8_t datum) { (void)datum; }
+    void setTextSize(uint8_t size) { (void)size; }
+    void setTextFont(uint8_t font) { (void)font; }
+    void setTextPadding(uint16_t width) { (void)width; }
+    void setTextWrap(bool wrap) { (void)wrap; }
+    void setCursor(int16_t x, int16_t y) { (void)x; (void)y; }
+    int16_t textWidth(const char* s, uint8_t font = 1) { return (int16_t)(strlen(s) * 6 * font); }
+    int16_t textWidth(const String& s, uint8_t font = 1) { return textWidth(s.c_str(), font); }
+    int16_t fontHeight(int16_t font = 1) { return (int16_t)(8 * font); }
+    int16_t drawString(const char* s, int32_t x, int32_t y, uint8_t font = 1) { (void)x; (void)y; return textWidth(s, font); }
+    int16_t drawString(const String& s, int32_t x, int32_t y, uint8_t font = 1) { return drawString(s.c_str(), x, y, font); }
+
+    size_t write(uint8_t c) override { (void)c; return 1; }
+    using Print::write;
+
+private:
+    int16_t width_;
+    int16_t height_;
+};
+
+#endif // HOST_TFT_ESPI_H
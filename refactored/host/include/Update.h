@@ -0,0 +1,32 @@
+/**
+ * Update.h
+ * Host Shim: Firmware Update (no flash; begin() fails unless
+ * host_ota_accept() is on, then images are counted and discarded)
+ */
+
+#ifndef HOST_UPDATE_H
+#define HOST_UPDATE_H
+
+#include <Arduino.h>
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+class UpdateClass {
+public:
+    bool begin(size_t size);
+    size_t write(uint8_t* data, size_t len);
+    bool end(bool evenIfRemaining = false);
+    void abort(void);
+    bool hasError(void) { return error_; }
+    void printError(Print& out);
+
+private:
+    size_t size_ = 0;
+    size_t written_ = 0;
+    bool open_ = false;
+    bool error_ = false;
+};
+
+extern UpdateClass Update;
+
+#endif // HOST_UPDATE_H
@@ -0,0 +1,147 @@
+/**
+ * WebServer.h
+ * Host Shim: ESP32 WebServer
+ *
+ * Same model as the ESP32 core: handleClient() accepts at most one
+ * connection per call, reads the whole request, runs the handler on the
+ * loop() thread and closes the connection. Port 80 is moved to
+ * host_http_port(). Responses with CONTENT_LENGTH_UNKNOWN are chunked
+ * and output is coalesced into TCP-segment-sized writes.
+ * Request parsing follows the core: query and urlencoded form fields are
+ * args, other bodies are the "plain" arg, multipart file parts go to the
+ * upload handler in HTTP_UPLOAD_BUFLEN chunks. serve() runs a request
+ * without a socket so benchmarks can time the real handlers, reaching the
+ * firmware's (file-static) server through WebServer::active().
+ */
+
+#ifndef HOST_WEBSERVER_H
+#define HOST_WEBSERVER_H
+
+#include <Arduino.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define HTTP_UPLOAD_BUFLEN 1436
+#define HTTP_MAX_DATA_WAIT 5000         // ms to wait for the rest of a request
+#define HTTP_MAX_BODY (4 * 1024 * 1024)   // Whole request is buffered (firmware images fit)
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+typedef enum {
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+} HTTPMethod;
+
+typedef enum {
+    UPLOAD_FILE_START,
+    UPLOAD_FILE_WRITE,
+    UPLOAD_FILE_END,
+    UPLOAD_FILE_ABORTED
+} HTTPUploadStatus;
+
+typedef struct {
+    HTTPUploadStatus status;
+    String filename;
+    String name;
+    String type;
+    size_t totalSize;
+    size_t currentSize;
+    uint8_t buf[HTTP_UPLOAD_BUFLEN];
+} HTTPUpload;
+
+class WebServer {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    explicit WebServer(int port = 80);
+    ~WebServer();
+
+    void begin(void);
+    void close(void);
+    void handleClient(void);
+
+    void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler) { on(uri, method, handler, nullptr); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler, THandlerFunction upload);
+    void onNotFound(THandlerFunction handler) { notFound_ = handler; }
+
+    void send(int code, const char* contentType = nullptr, const String& content = String(""));
+    void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+    void send(int code, const char* contentType, const char* content) { send(code, contentType, String(content)); }
+    void send_P(int code, const char* contentType, const char* content) { send(code, contentType, content); }
+    void sendHeader(const String& name, const String& value, bool first = false);
+    void setContentLength(size_t length) { contentLength_ = length; }
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* content, size_t length);
+    void sendContent_P(const char* content) { sendContent(content, strlen(content)); }
+
+    String uri(void) const { return String(uri_.c_str()); }
+    HTTPMethod method(void) const { return method_; }
+    int args(void) const { return (int)args_.size(); }
+    String arg(int index) const;
+    String arg(const String& name) const;
+    String argName(int index) const;
+    bool hasArg(const String& name) const;
+    void collectHeaders(const char* headerKeys[], size_t count) { (void)headerKeys; (void)count; }
+    String header(const String& name) const;
+    bool hasHeader(const String& name) const;
+    HTTPUpload& upload(void) { return upload_; }
+
+    // Host only: run a request through the routes without a connection,
+    // appending the response bytes to *response (benchmarks)
+    void serve(HTTPMethod method, const String& uri, std::string* response);
+
+    // Host only: the server that last called begin(), nullptr if none
+    static WebServer* active(void) { return active_; }
+
+private:
+    struct Route {
+        std::string uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+        THandlerFunction upload;
+    };
+
+    void resetRequest(void);
+    void dispatch(const std::string& body);
+    bool readRequest(std::string* body);
+    void parseArgs(const std::string& query);
+    void handleMultipart(const std::string& body, const std::string& boundary, const Route* route);
+    void finishResponse(void);
+    void writeRaw(const char* data, size_t len);
+    void flushOut(void);
+
+    int port_;
+    int listenFd_;
+    int clientFd_;
+    std::vector<Route> routes_;
+    THandlerFunction notFound_;
+
+    // Current request
+    HTTPMethod method_;
+    bool http11_;
+    std::string uri_;
+    std::vector<std::pair<std::string, std::string>> args_;
+    std::vector<std::pair<std::string, std::string>> headers_;
+    HTTPUpload upload_;
+
+    // Current response
+    std::vector<std::pair<std::string, std::string>> responseHeaders_;
+    size_t contentLength_;
+    bool headersSent_;
+    bool chunked_;
+    std::string out_;
+    std::string* capture_;          // serve(): response goes here, not to clientFd_
+
+    static WebServer* active_;
+};
+
+#endif // HOST_WEBSERVER_H
@@ -0,0 +1,51 @@
+/**
+ * WiFi.h
+ * Host Shim: WiFi Station / AP
+ *
+ * Station mode "connects" at once to any SSID: the host's network is the
+ * WiFi. localIP() is the address given with --ip (default 127.0.0.1).
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include "IPAddress.h"
+#include "WiFiClient.h"
+#include "WiFiUdp.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+class WiFiClass {
+public:
+    wl_status_t status(void);
+    bool isConnected(void) { return status() == WL_CONNECTED; }
+    wl_status_t begin(const char* ssid, const char* password = nullptr);
+    bool mode(wifi_mode_t mode);
+    bool softAPConfig(IPAddress ip, IPAddress gateway, IPAddress subnet);
+    bool softAP(const char* ssid, const char* password = nullptr);
+    IPAddress softAPIP(void);
+    IPAddress localIP(void);
+    int8_t RSSI(void);
+    String SSID(void);
+    String macAddress(void);
+    bool setHostname(const char* name);
+    bool disconnect(bool wifiOff = false);
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
@@ -0,0 +1,39 @@
+/**
+ * WiFiClient.h
+ * Host Shim: TCP Client (blocking BSD socket)
+ */
+
+#ifndef HOST_WIFICLIENT_H
+#define HOST_WIFICLIENT_H
+
+#include <Arduino.h>
+#include "IPAddress.h"
+
+class WiFiClient : public Print {
+public:
+    WiFiClient() : fd_(-1), timeoutMs_(1000) {}
+    explicit WiFiClient(int fd) : fd_(fd), timeoutMs_(1000) {}
+    ~WiFiClient() override;
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+
+    int connect(const char* host, uint16_t port);
+    int connect(IPAddress ip, uint16_t port) { return connect(ip.toString().c_str(), port); }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t len) override;
+    using Print::write;
+    int available(void);
+    int read(void);
+    int read(uint8_t* buf, size_t len);
+    int readBytes(uint8_t* buf, size_t len);     // Waits up to the timeout for len bytes
+    uint8_t connected(void);
+    void stop(void);
+    void setTimeout(uint32_t ms) { timeoutMs_ = ms; }
+    int fd(void) const { return fd_; }
+
+private:
+    int fd_;
+    uint32_t timeoutMs_;
+};
+
+#endif // HOST_WIFICLIENT_H
@@ -0,0 +1,47 @@
+/**
+ * WiFiUdp.h
+ * Host Shim: UDP and Multicast (real sockets, so several virtual
+ * thermostats on one machine see each other's fleet frames)
+ */
+
+#ifndef HOST_WIFIUDP_H
+#define HOST_WIFIUDP_H
+
+#include <Arduino.h>
+#include "IPAddress.h"
+
+class WiFiUDP {
+public:
+    WiFiUDP() : fd_(-1), port_(0), txLen_(0), rxLen_(0), rxPos_(0) {}
+    ~WiFiUDP() { stop(); }
+
+    uint8_t begin(uint16_t port);
+    uint8_t beginMulticast(IPAddress group, uint16_t port);
+    int beginPacket(IPAddress ip, uint16_t port);
+    int beginMulticastPacket(void);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t len);
+    int endPacket(void);
+    int parsePacket(void);
+    int available(void) { return rxLen_ - rxPos_; }
+    int read(uint8_t* buf, size_t len);
+    IPAddress remoteIP(void) { return remoteIP_; }
+    uint16_t remotePort(void) { return remotePort_; }
+    void stop(void);
+
+private:
+    int fd_;
+    uint16_t port_;
+    IPAddress group_;
+    IPAddress txIP_;
+    uint16_t txPort_ = 0;
+    uint8_t txBuf_[1460];
+    int txLen_;
+    uint8_t rxBuf_[1460];
+    int rxLen_;
+    int rxPos_;
+    IPAddress remoteIP_;
+    uint16_t remotePort_ = 0;
+};
+
+#endif // HOST_WIFIUDP_H
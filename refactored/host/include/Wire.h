@@ -0,0 +1,26 @@
+/**
+ * Wire.h
+ * Host Shim: I2C (empty bus: every address NACKs, so no SHT3x/BME280)
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { (void)sda; (void)scl; (void)frequency; return true; }
+    void setTimeOut(uint16_t ms) { (void)ms; }
+    void beginTransmission(uint8_t address) { (void)address; }
+    size_t write(uint8_t data) { (void)data; return 1; }
+    size_t write(const uint8_t* data, size_t len) { (void)data; return len; }
+    uint8_t endTransmission(bool stop = true) { (void)stop; return 2; }   // Address NACK
+    uint8_t requestFrom(uint8_t address, uint8_t len) { (void)address; (void)len; return 0; }
+    int available(void) { return 0; }
+    int read(void) { return -1; }
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,27 @@
+/**
+ * XPT2046_Touchscreen.h
+ * Host Shim: Touch Controller (never touched)
+ */
+
+#ifndef HOST_XPT2046_TOUCHSCREEN_H
+#define HOST_XPT2046_TOUCHSCREEN_H
+
+#include <Arduino.h>
+
+class TS_Point {
+public:
+    TS_Point() : x(0), y(0), z(0) {}
+    int16_t x, y, z;
+};
+
+class XPT2046_Touchscreen {
+public:
+    explicit XPT2046_Touchscreen(uint8_t csPin, uint8_t irqPin = 255) { (void)csPin; (void)irqPin; }
+    bool begin(void) { return true; }
+    bool touched(void) { return false; }
+    bool tirqTouched(void) { return false; }
+    TS_Point getPoint(void) { return TS_Point(); }
+    void setRotation(uint8_t rotation) { (void)rotation; }
+};
+
+#endif // HOST_XPT2046_TOUCHSCREEN_H
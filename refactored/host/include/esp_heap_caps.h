@@ -0,0 +1,22 @@
+/**
+ * esp_heap_caps.h
+ * Host Shim: Heap Capabilities
+ *
+ * Reports a fixed, healthy ESP32 heap (see ESP.getFreeHeap()); the host
+ * heap has nothing to say about fragmentation on the device.
+ */
+
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+
+#endif // HOST_ESP_HEAP_CAPS_H
@@ -0,0 +1,21 @@
+/**
+ * esp_partition.h
+ * Host Shim: Flash Partitions (one fixed "app0", nothing to read)
+ */
+
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct {
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size);
+
+#endif // HOST_ESP_PARTITION_H
@@ -0,0 +1,17 @@
+/**
+ * esp_sntp.h
+ * Host Shim: SNTP
+ *
+ * The host clock is already synced; configTzTime() reports a sync at once.
+ */
+
+#ifndef HOST_ESP_SNTP_H
+#define HOST_ESP_SNTP_H
+
+#include <sys/time.h>
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
+
+#endif // HOST_ESP_SNTP_H
@@ -0,0 +1,17 @@
+/**
+ * esp_task_wdt.h
+ * Host Shim: Task Watchdog (accepted and ignored; heartbeats still run)
+ */
+
+#ifndef HOST_ESP_TASK_WDT_H
+#define HOST_ESP_TASK_WDT_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+static inline esp_err_t esp_task_wdt_init(uint32_t timeoutSec, bool panic) { (void)timeoutSec; (void)panic; return ESP_OK; }
+static inline esp_err_t esp_task_wdt_add(void* task) { (void)task; return ESP_OK; }
+static inline esp_err_t esp_task_wdt_delete(void* task) { (void)task; return ESP_OK; }
+static inline esp_err_t esp_task_wdt_reset(void) { return ESP_OK; }
+
+#endif // HOST_ESP_TASK_WDT_H
@@ -0,0 +1,13 @@
+/**
+ * esp_timer.h
+ * Host Shim: Microsecond Clock (CLOCK_MONOTONIC since process start)
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif // HOST_ESP_TIMER_H
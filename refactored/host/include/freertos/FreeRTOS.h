@@ -0,0 +1,43 @@
+/**
+ * FreeRTOS.h
+ * Host Shim: FreeRTOS Types and Critical Sections
+ *
+ * Ticks are milliseconds (configTICK_RATE_HZ 1000, as in the ESP32 core).
+ * portMUX critical sections are a plain pthread mutex: they exclude other
+ * threads but, unlike on the ESP32, don't stop preemption.
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void* TaskHandle_t;
+typedef struct HostSemaphore* SemaphoreHandle_t;
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+typedef struct {
+    pthread_mutex_t lock;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { PTHREAD_MUTEX_INITIALIZER }
+
+static inline void portENTER_CRITICAL(portMUX_TYPE* mux) { pthread_mutex_lock(&mux->lock); }
+static inline void portEXIT_CRITICAL(portMUX_TYPE* mux) { pthread_mutex_unlock(&mux->lock); }
+#define portENTER_CRITICAL_ISR portENTER_CRITICAL
+#define portEXIT_CRITICAL_ISR portEXIT_CRITICAL
+
+#endif // HOST_FREERTOS_H
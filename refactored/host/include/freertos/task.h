@@ -0,0 +1,27 @@
+/**
+ * task.h
+ * Host Shim: FreeRTOS Tasks
+ *
+ * Tasks are detached threads; priority and core are ignored (Linux
+ * schedules them), so a task that never blocks costs a whole CPU here
+ * just as it would starve lower priorities on the device.
+ */
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void* param);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                       void* param, UBaseType_t priority, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period);
+TickType_t xTaskGetTickCount(void);
+
+#endif // HOST_FREERTOS_TASK_H
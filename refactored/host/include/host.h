@@ -0,0 +1,59 @@
+/**
+ * host.h
+ * Virtual Thermostat Process
+ *
+ * The firmware built as a Linux process (pio run -e host): host_main.cpp
+ * parses the command line, then runs setup() and loop() like the ESP32
+ * core's loopTask. See README "Virtual Thermostat".
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+
+/**
+ * Get the directory holding preferences (*.nvs)
+ * @return Path (--data, default ./vt_data)
+ */
+const char* host_data_dir(void);
+
+/**
+ * Get the TCP port the web server listens on instead of 80
+ * @return Port (--port, default 8080)
+ */
+uint16_t host_http_port(void);
+
+/**
+ * Get the address reported as WiFi.localIP()
+ * @return IPv4 address, network byte order (--ip, default 127.0.0.1)
+ */
+uint32_t host_local_ip(void);
+
+/**
+ * Check if this process was started by ESP.restart()
+ * @return true after a restart (reset reason ESP_RST_SW)
+ */
+bool host_restarted(void);
+
+/**
+ * Restart: re-execute the process with the same arguments
+ */
+[[noreturn]] void host_restart(void);
+
+/**
+ * Move the monotonic clock (millis(), micros(), esp_timer) forward without
+ * waiting, e.g. so a benchmark can pass a rate limit on every iteration
+ * @param us Microseconds to add
+ */
+void host_clock_advance(uint64_t us);
+
+/**
+ * Let Update accept images (counted, then discarded) instead of failing at
+ * begin(), so the OTA write and verify path runs; the running slot stays
+ * the boot slot
+ * @param accept true to accept images
+ */
+void host_ota_accept(bool accept);
+
+#endif // HOST_H
@@ -0,0 +1,66 @@
+/**
+ * host_sim.h
+ * Virtual Thermostat Plant
+ *
+ * Three simulated DS18B20s, each warmed by one output's heater:
+ *   sensor 1 <- output 1 AC dimmer (GPIO5, phase-angle power %)
+ *   sensor 2 <- output 2 SSR (GPIO14 level)
+ *   sensor 3 <- output 3 relay (GPIO32 level)
+ * Each is a first-order lag towards ambient + HOST_SIM_GAIN_C x drive,
+ * integrated in real time whenever a heater changes or a sensor is read,
+ * and reported at DS18B20 12-bit resolution.
+ */
+
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include <stdint.h>
+
+#define HOST_SIM_SENSORS 3
+#define HOST_SIM_GAIN_C 15.0f      // Steady-state rise at full power
+#define HOST_SIM_TAU_SEC 300.0f    // Time constant
+
+/**
+ * Set up the plant
+ * @param ambientC Room temperature (--ambient, default 22)
+ * @param sensorCount Sensors on the bus, 0..HOST_SIM_SENSORS (--sensors, default 3)
+ */
+void host_sim_init(float ambientC, int sensorCount);
+
+/**
+ * Get number of sensors on the bus
+ */
+int host_sim_sensor_count(void);
+
+/**
+ * Get a sensor's ROM address
+ * @param index Sensor index
+ * @param address Output, 8 bytes (family 0x28, Dallas CRC in byte 7)
+ */
+void host_sim_sensor_address(int index, uint8_t* address);
+
+/**
+ * Read a sensor
+ * @param address ROM address
+ * @return °C at 0.0625°C resolution, -127 (DEVICE_DISCONNECTED_C) if unknown
+ */
+float host_sim_read(const uint8_t* address);
+
+/**
+ * Record a GPIO level (digitalWrite)
+ */
+void host_sim_set_pin(uint8_t pin, uint8_t level);
+
+/**
+ * Get a GPIO level (digitalRead)
+ */
+int host_sim_get_pin(uint8_t pin);
+
+/**
+ * Record a dimmer's power
+ * @param pin Dimmer output pin
+ * @param power 0-100%
+ */
+void host_sim_set_dimmer(uint8_t pin, int power);
+
+#endif // HOST_SIM_H
@@ -0,0 +1,484 @@
+/**
+ * arduino_core.cpp
+ * Host Shim: Arduino Core Implementation
+ */
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <new>
+#include <random>
+#include <thread>
+#include "host.h"
+#include "host_sim.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// Reported heap (a healthy ESP32 with WiFi, MQTT and the web server up)
+#define HOST_HEAP_SIZE 327680
+#define HOST_HEAP_FREE 180000
+#define HOST_HEAP_MIN_FREE 150000
+#define HOST_HEAP_LARGEST 110000
+
+#define SNTP_RESYNC_SEC 3600
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+static std::atomic<int64_t> clockOffsetUs(0);
+static sntp_sync_time_cb_t sntpCallback = nullptr;
+
+// ===== TIME =====
+
+int64_t esp_timer_get_time(void) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count() + clockOffsetUs.load(std::memory_order_relaxed);
+}
+
+void host_clock_advance(uint64_t us) {
+    clockOffsetUs.fetch_add((int64_t)us, std::memory_order_relaxed);
+}
+
+unsigned long millis(void) {
+    return (unsigned long)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros(void) {
+    return (unsigned long)esp_timer_get_time();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield(void) {
+    std::this_thread::yield();
+}
+
+bool getLocalTime(struct tm* info, uint32_t ms) {
+    (void)ms;
+    time_t now = time(nullptr);
+    localtime_r(&now, info);
+    return true;
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2, const char* server3) {
+    // POSIX TZ offsets are west-positive
+    char tz[32];
+    snprintf(tz, sizeof(tz), "UTC%+ld", -(gmtOffsetSec + daylightOffsetSec) / 3600);
+    configTzTime(tz, server1, server2, server3);
+}
+
+void configTzTime(const char* tz, const char* server1, const char* server2, const char* server3) {
+    (void)server1;
+    (void)server2;
+    (void)server3;
+    setenv("TZ", tz, 1);
+    tzset();
+
+    // The host clock is NTP-disciplined already: report a sync now and hourly
+    static bool started = false;
+    if (!started) {
+        started = true;
+        std::thread([]() {
+            for (;;) {
+                if (sntpCallback) {
+                    struct timeval tv;
+                    gettimeofday(&tv, nullptr);
+                    sntpCallback(&tv);
+                }
+                std::this_thread::sleep_for(std::chrono::seconds(SNTP_RESYNC_SEC));
+            }
+        }).detach();
+    }
+}
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback) {
+    sntpCallback = callback;
+}
+
+// ===== GPIO =====
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    host_sim_set_pin(pin, value ? HIGH : LOW);
+}
+
+int digitalRead(uint8_t pin) {
+    return host_sim_get_pin(pin);
+}
+
+// ===== MISC =====
+
+static std::mt19937& rng(void) {
+    static std::mt19937 gen(std::random_device{}());
+    return gen;
+}
+
+static std::mutex rngMutex;
+
+uint32_t esp_random(void) {
+    std::lock_guard<std::mutex> lock(rngMutex);
+    return (uint32_t)rng()();
+}
+
+long random(long max) {
+    return max > 0 ? (long)(esp_random() % (uint32_t)max) : 0;
+}
+
+long random(long min, long max) {
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    std::lock_guard<std::mutex> lock(rngMutex);
+    rng().seed((uint32_t)seed);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+// ===== STRING =====
+
+static std::string formatInteger(unsigned long long value, bool negative, unsigned char base) {
+    if (base < 2 || base > 36) {
+        base = 10;
+    }
+    char buf[72];
+    int pos = sizeof(buf) - 1;
+    buf[pos] = '\0';
+    do {
+        int digit = (int)(value % base);
+        buf[--pos] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value > 0);
+    if (negative) {
+        buf[--pos] = '-';
+    }
+    return std::string(buf + pos);
+}
+
+static std::string formatSigned(long long value, unsigned char base) {
+    if (value < 0 && base == 10) {
+        return formatInteger(0ULL - (unsigned long long)value, true, base);
+    }
+    // Other bases print the two's complement, like ltoa() on the device
+    return formatInteger(base == 10 ? (unsigned long long)value : (unsigned long long)(unsigned long)value, false, base);
+}
+
+static std::string formatFloat(double value, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+    return std::string(buf);
+}
+
+String::String(unsigned char value, unsigned char base) : s_(formatInteger(value, false, base)) {}
+String::String(int value, unsigned char base) : s_(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : s_(formatInteger(value, false, base)) {}
+String::String(long value, unsigned char base) : s_(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : s_(formatInteger(value, false, base)) {}
+String::String(long long value, unsigned char base) : s_(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : s_(formatInteger(value, false, base)) {}
+String::String(float value, unsigned int decimals) : s_(formatFloat(value, decimals)) {}
+String::String(double value, unsigned int decimals) : s_(formatFloat(value, decimals)) {}
+
+bool String::endsWith(const String& suffix) const {
+    return s_.size() >= suffix.s_.size() &&
+           s_.compare(s_.size() - suffix.s_.size(), suffix.s_.size(), suffix.s_) == 0;
+}
+
+char& String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= s_.size()) {
+        dummy = '\0';
+        return dummy;
+    }
+    return s_[index];
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = s_.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& s, unsigned int from) const {
+    size_t pos = s_.find(s.s_, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t pos = s_.rfind(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& s) const {
+    size_t pos = s_.rfind(s.s_);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int begin) const {
+    return substring(begin, (unsigned int)s_.size());
+}
+
+String String::substring(unsigned int begin, unsigned int end) const {
+    if (begin > end) {
+        std::swap(begin, end);
+    }
+    if (begin >= s_.size()) {
+        return String();
+    }
+    if (end > s_.size()) {
+        end = (unsigned int)s_.size();
+    }
+    return String(s_.substr(begin, end - begin));
+}
+
+void String::replace(char find, char with) {
+    std::replace(s_.begin(), s_.end(), find, with);
+}
+
+void String::replace(const String& find, const String& with) {
+    if (find.s_.empty()) {
+        return;
+    }
+    size_t pos = 0;
+    while ((pos = s_.find(find.s_, pos)) != std::string::npos) {
+        s_.replace(pos, find.s_.size(), with.s_);
+        pos += with.s_.size();
+    }
+}
+
+void String::remove(unsigned int index) {
+    if (index < s_.size()) {
+        s_.erase(index);
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < s_.size()) {
+        s_.erase(index, count);
+    }
+}
+
+void String::toLowerCase(void) {
+    for (char& c : s_) c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase(void) {
+    for (char& c : s_) c = (char)toupper((unsigned char)c);
+}
+
+void String::trim(void) {
+    size_t begin = 0;
+    while (begin < s_.size() && isspace((unsigned char)s_[begin])) begin++;
+    size_t end = s_.size();
+    while (end > begin && isspace((unsigned char)s_[end - 1])) end--;
+    s_ = s_.substr(begin, end - begin);
+}
+
+void String::getBytes(unsigned char* buf, unsigned int size, unsigned int index) const {
+    if (size == 0) {
+        return;
+    }
+    size_t n = 0;
+    if (index < s_.size()) {
+        n = std::min((size_t)size - 1, s_.size() - index);
+        memcpy(buf, s_.data() + index, n);
+    }
+    buf[n] = '\0';
+}
+
+String operator+(const String& a, const String& b) {
+    String r(a);
+    r.concat(b);
+    return r;
+}
+
+String operator+(const String& a, const char* b) {
+    String r(a);
+    r.concat(b);
+    return r;
+}
+
+String operator+(const char* a, const String& b) {
+    String r(a);
+    r.concat(b);
+    return r;
+}
+
+String operator+(const String& a, char b) {
+    String r(a);
+    r.concat(b);
+    return r;
+}
+
+// ===== PRINT / SERIAL =====
+
+size_t Print::write(const uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (len--) {
+        n += write(*buf++);
+    }
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char small[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (len < 0) {
+        return 0;
+    }
+    if ((size_t)len < sizeof(small)) {
+        return write((const uint8_t*)small, len);
+    }
+    std::string big(len + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&big[0], big.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)big.data(), len);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t len) {
+    // Drop the CR of println()'s CRLF so logs read normally in a terminal
+    if (len >= 2 && buf[len - 2] == '\r' && buf[len - 1] == '\n') {
+        fwrite(buf, 1, len - 2, stdout);
+        fputc('\n', stdout);
+        return len;
+    }
+    if (len == 2 && buf[0] == '\r') {
+        fputc('\n', stdout);
+        return len;
+    }
+    return fwrite(buf, 1, len, stdout);
+}
+
+void HardwareSerial::flush(void) {
+    fflush(stdout);
+}
+
+// ===== ESP =====
+
+uint64_t EspClass::getEfuseMac(void) {
+    // Locally administered, unique per --ip/--port so fleet peers differ
+    uint32_t ip = host_local_ip();
+    uint16_t port = host_http_port();
+    uint8_t mac[6] = {0x02, (uint8_t)(ip >> 16), (uint8_t)(ip >> 24), 0x00,
+                      (uint8_t)(port >> 8), (uint8_t)port};
+    uint64_t value = 0;
+    for (int i = 5; i >= 0; i--) {
+        value = value << 8 | mac[i];
+    }
+    return value;
+}
+
+uint32_t EspClass::getCycleCount(void) {
+    // 240 MHz, like CCOUNT
+    return (uint32_t)(esp_timer_get_time() * 240);
+}
+
+uint32_t EspClass::getFreeHeap(void) {
+    return HOST_HEAP_FREE;
+}
+
+uint32_t EspClass::getHeapSize(void) {
+    return HOST_HEAP_SIZE;
+}
+
+uint32_t EspClass::getMinFreeHeap(void) {
+    return HOST_HEAP_MIN_FREE;
+}
+
+uint32_t EspClass::getMaxAllocHeap(void) {
+    return HOST_HEAP_LARGEST;
+}
+
+void EspClass::restart(void) {
+    host_restart();
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    (void)caps;
+    return HOST_HEAP_FREE;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    (void)caps;
+    return HOST_HEAP_LARGEST;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    (void)caps;
+    return HOST_HEAP_MIN_FREE;
+}
+
+#if HEAP_TRACKING_ENABLED
+// On the ESP32 libstdc++ is linked in statically, so --wrap=malloc sees
+// operator new too. The host's shared libstdc++ calls its own malloc:
+// route new through the wrapped one so per-request counts match
+// (pio run -e host-heapdebug).
+void* operator new(size_t size) {
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t size) noexcept {
+    (void)size;
+    free(p);
+}
+
+void operator delete[](void* p, size_t size) noexcept {
+    (void)size;
+    free(p);
+}
+#endif // HEAP_TRACKING_ENABLED
+
+esp_reset_reason_t esp_reset_reason(void) {
+    return host_restarted() ? ESP_RST_SW : ESP_RST_POWERON;
+}
@@ -0,0 +1,208 @@
+/**
+ * esp_idf.cpp
+ * Host Shim: ESP-IDF Implementation
+ *
+ * One valid, never-updated app slot, an Update that only counts bytes,
+ * SHA-256 (so OTA digest code runs for real) and the globals of the
+ * no-op libraries.
+ */
+
+#include <Arduino.h>
+#include <ESPmDNS.h>
+#include <Update.h>
+#include <Wire.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
+#include "host.h"
+
+MDNSResponder MDNS;
+UpdateClass Update;
+TwoWire Wire;
+
+static const esp_partition_t appPartition = {0x10000, 0x1E0000, "app0"};
+static bool otaAccept = false;
+
+// ===== OTA / PARTITIONS =====
+
+const esp_partition_t* esp_ota_get_running_partition(void) {
+    return &appPartition;
+}
+
+const esp_partition_t* esp_ota_get_boot_partition(void) {
+    return &appPartition;
+}
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t* partition, esp_ota_img_states_t* state) {
+    (void)partition;
+    *state = ESP_OTA_IMG_VALID;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot(void) {
+    host_restart();
+}
+
+void host_ota_accept(bool accept) {
+    otaAccept = accept;
+}
+
+bool UpdateClass::begin(size_t size) {
+    open_ = otaAccept && size > 0 && (size == UPDATE_SIZE_UNKNOWN || size <= appPartition.size);
+    error_ = !open_;
+    size_ = size;
+    written_ = 0;
+    return open_;
+}
+
+size_t UpdateClass::write(uint8_t* data, size_t len) {
+    (void)data;
+    if (!open_ || (size_ != UPDATE_SIZE_UNKNOWN && written_ + len > size_) ||
+        written_ + len > appPartition.size) {
+        error_ = true;
+        return 0;
+    }
+    written_ += len;
+    return len;
+}
+
+bool UpdateClass::end(bool evenIfRemaining) {
+    if (!open_ || error_ || written_ == 0 ||
+        (!evenIfRemaining && size_ != UPDATE_SIZE_UNKNOWN && written_ != size_)) {
+        error_ = true;
+        open_ = false;
+        return false;
+    }
+    open_ = false;
+    return true;
+}
+
+void UpdateClass::abort(void) {
+    open_ = false;
+}
+
+void UpdateClass::printError(Print& out) {
+    out.println(otaAccept ? "Update: image rejected" : "Update: no OTA partition in the host build");
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size) {
+    if (offset + size > partition->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(dst, 0xFF, size);    // Erased flash
+    return ESP_OK;
+}
+
+// ===== SHA-256 =====
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static uint32_t ror(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static void sha256Block(mbedtls_sha256_context* ctx, const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ror(w[i - 15], 7) ^ ror(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ror(w[i - 2], 17) ^ ror(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = ctx->state[0], b = ctx->state[1], c = ctx->state[2], d = ctx->state[3];
+    uint32_t e = ctx->state[4], f = ctx->state[5], g = ctx->state[6], h = ctx->state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (ror(e, 6) ^ ror(e, 11) ^ ror(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+        uint32_t t2 = (ror(a, 2) ^ ror(a, 13) ^ ror(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    ctx->state[0] += a;
+    ctx->state[1] += b;
+    ctx->state[2] += c;
+    ctx->state[3] += d;
+    ctx->state[4] += e;
+    ctx->state[5] += f;
+    ctx->state[6] += g;
+    ctx->state[7] += h;
+}
+
+void mbedtls_sha256_init(mbedtls_sha256_context* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_sha256_starts_ret(mbedtls_sha256_context* ctx, int is224) {
+    static const uint32_t init[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    if (is224) {
+        return -1;
+    }
+    memcpy(ctx->state, init, sizeof(init));
+    ctx->total = 0;
+    return 0;
+}
+
+int mbedtls_sha256_update_ret(mbedtls_sha256_context* ctx, const unsigned char* input, size_t len) {
+    size_t fill = (size_t)(ctx->total % 64);
+    ctx->total += len;
+    while (len > 0) {
+        size_t n = 64 - fill < len ? 64 - fill : len;
+        memcpy(ctx->buffer + fill, input, n);
+        fill += n;
+        input += n;
+        len -= n;
+        if (fill == 64) {
+            sha256Block(ctx, ctx->buffer);
+            fill = 0;
+        }
+    }
+    return 0;
+}
+
+int mbedtls_sha256_finish_ret(mbedtls_sha256_context* ctx, unsigned char output[32]) {
+    uint64_t bits = ctx->total * 8;
+    static const uint8_t pad[64] = {0x80};
+    size_t fill = (size_t)(ctx->total % 64);
+    mbedtls_sha256_update_ret(ctx, pad, fill < 56 ? 56 - fill : 120 - fill);
+
+    uint8_t length[8];
+    for (int i = 0; i < 8; i++) {
+        length[i] = (uint8_t)(bits >> (56 - 8 * i));
+    }
+    mbedtls_sha256_update_ret(ctx, length, 8);
+
+    for (int i = 0; i < 8; i++) {
+        output[i * 4] = (uint8_t)(ctx->state[i] >> 24);
+        output[i * 4 + 1] = (uint8_t)(ctx->state[i] >> 16);
+        output[i * 4 + 2] = (uint8_t)(ctx->state[i] >> 8);
+        output[i * 4 + 3] = (uint8_t)ctx->state[i];
+    }
+    return 0;
+}
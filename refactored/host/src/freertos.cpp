@@ -0,0 +1,96 @@
+/**
+ * freertos.cpp
+ * Host Shim: FreeRTOS Implementation
+ *
+ * Tasks are detached threads (priority and core are ignored), ticks are
+ * milliseconds of the monotonic clock and semaphores are timed mutexes.
+ */
+
+#include <Arduino.h>
+#include <mutex>
+#include <thread>
+
+struct HostSemaphore {
+    std::recursive_timed_mutex mutex;
+};
+
+// ===== TASKS =====
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+    (void)stackDepth;
+    (void)priority;
+    (void)core;
+    std::thread thread(task, param);
+    pthread_setname_np(thread.native_handle(), std::string(name).substr(0, 15).c_str());
+    if (handle) {
+        *handle = (TaskHandle_t)thread.native_handle();
+    }
+    thread.detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                       void* param, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(task, name, stackDepth, param, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr) {
+        pthread_exit(nullptr);
+    }
+    // Deleting another task isn't supported; the firmware only deletes itself
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks);
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period) {
+    TickType_t wake = *previousWake + period;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(wake - now) > 0) {
+        delay(wake - now);
+    }
+    *previousWake = wake;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)millis();
+}
+
+// ===== SEMAPHORES =====
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return new HostSemaphore();
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    return new HostSemaphore();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        sem->mutex.lock();
+        return pdTRUE;
+    }
+    return sem->mutex.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    sem->mutex.unlock();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+    return xSemaphoreTake(sem, ticks);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+    return xSemaphoreGive(sem);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    delete sem;
+}
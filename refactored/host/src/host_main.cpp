@@ -0,0 +1,140 @@
+/**
+ * host_main.cpp
+ * Virtual Thermostat Entry Point
+ *
+ * Usage: program [--port N] [--data DIR] [--ip A.B.C.D] [--ambient C]
+ *                [--sensors N] [--mqtt HOST[:PORT]]
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <arpa/inet.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "host.h"
+#include "host_sim.h"
+
+#define LOOP_SLEEP_US 1000          // Between loop() calls (the core spins; this bounds CPU)
+#define RESTART_ENV "VT_RESTARTED"
+
+// Firmware entry points (main.cpp)
+void setup(void);
+void loop(void);
+
+static char exePath[4096];
+static char** savedArgv = nullptr;
+static const char* dataDir = "vt_data";
+static uint16_t httpPort = 8080;
+static uint32_t localIP = 0;
+static bool restarted = false;
+
+const char* host_data_dir(void) {
+    return dataDir;
+}
+
+uint16_t host_http_port(void) {
+    return httpPort;
+}
+
+uint32_t host_local_ip(void) {
+    return localIP;
+}
+
+bool host_restarted(void) {
+    return restarted;
+}
+
+void host_restart(void) {
+    Serial.println("[HOST] Restarting");
+    fflush(stdout);
+    setenv(RESTART_ENV, "1", 1);
+    execv(exePath, savedArgv);
+    perror("execv");
+    _exit(1);
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --port N          HTTP port (default 8080)\n"
+            "  --data DIR        Preferences directory (default ./vt_data)\n"
+            "  --ip A.B.C.D      Address reported as the station IP (default 127.0.0.1)\n"
+            "  --ambient C       Room temperature of the plant (default 22)\n"
+            "  --sensors N       Simulated DS18B20s, 0-%d (default %d)\n"
+            "  --mqtt HOST[:P]   Save this MQTT broker before starting\n",
+            name, HOST_SIM_SENSORS, HOST_SIM_SENSORS);
+    exit(2);
+}
+
+/**
+ * First-run settings: join "WiFi" instead of starting the setup AP, and
+ * point MQTT at a local broker (refused at once if there is none, where
+ * the device default would time out on every retry)
+ */
+static void seedPreferences(const char* mqtt) {
+    Preferences prefs;
+    prefs.begin("thermostat", false);
+    if (!prefs.isKey("wifi_ssid")) {
+        prefs.putString("wifi_ssid", "host");
+    }
+    if (mqtt) {
+        String broker(mqtt);
+        int colon = broker.indexOf(':');
+        if (colon >= 0) {
+            prefs.putFloat("mqtt_port", broker.substring(colon + 1).toFloat());
+            broker = broker.substring(0, colon);
+        }
+        prefs.putString("mqtt_broker", broker);
+    } else if (!prefs.isKey("mqtt_broker")) {
+        prefs.putString("mqtt_broker", "127.0.0.1");
+    }
+    prefs.end();
+}
+
+int main(int argc, char** argv) {
+    // The real path, so the restarted process keeps its name
+    ssize_t len = readlink("/proc/self/exe", exePath, sizeof(exePath) - 1);
+    exePath[len > 0 ? len : 0] = '\0';
+    savedArgv = argv;
+    restarted = getenv(RESTART_ENV) != nullptr;
+    inet_pton(AF_INET, "127.0.0.1", &localIP);
+
+    float ambientC = 22.0f;
+    int sensorCount = HOST_SIM_SENSORS;
+    const char* mqtt = nullptr;
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            usage(argv[0]);
+        } else if (strcmp(argv[i], "--port") == 0) {
+            httpPort = (uint16_t)atoi(value);
+        } else if (strcmp(argv[i], "--data") == 0) {
+            dataDir = value;
+        } else if (strcmp(argv[i], "--ip") == 0) {
+            if (inet_pton(AF_INET, value, &localIP) != 1) usage(argv[0]);
+        } else if (strcmp(argv[i], "--ambient") == 0) {
+            ambientC = (float)atof(value);
+        } else if (strcmp(argv[i], "--sensors") == 0) {
+            sensorCount = atoi(value);
+        } else if (strcmp(argv[i], "--mqtt") == 0) {
+            mqtt = value;
+        } else {
+            usage(argv[0]);
+        }
+        i++;
+    }
+
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    signal(SIGPIPE, SIG_IGN);
+    mkdir(dataDir, 0755);
+
+    host_sim_init(ambientC, sensorCount);
+    seedPreferences(restarted ? nullptr : mqtt);
+
+    setup();
+    for (;;) {
+        loop();
+        usleep(LOOP_SLEEP_US);
+    }
+}
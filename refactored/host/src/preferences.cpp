@@ -0,0 +1,301 @@
+/**
+ * preferences.cpp
+ * Host Shim: File-Backed Preferences
+ *
+ * One text file per namespace in the data directory, a "key type hex"
+ * line per entry. Type letters follow NVS (floats are blobs, as in the
+ * ESP32 library). Files are rewritten on every put, which is fine for
+ * settings traffic, and shared by all threads under one lock.
+ */
+
+#include <Preferences.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include "host.h"
+
+#define PREFS_KEY_MAX 15        // NVS key limit
+
+typedef struct {
+    char type;
+    std::string value;
+} Entry_t;
+
+typedef std::map<std::string, Entry_t> Namespace_t;
+
+static std::recursive_mutex prefsMutex;
+
+static std::string nsPath(const char* ns) {
+    return std::string(host_data_dir()) + "/" + ns + ".nvs";
+}
+
+static Namespace_t load(const char* ns) {
+    Namespace_t entries;
+    FILE* f = fopen(nsPath(ns).c_str(), "r");
+    if (!f) {
+        return entries;
+    }
+    char key[64];
+    char type;
+    static char hex[2 * 65536 + 2];
+    while (fscanf(f, "%63s %c %131073s", key, &type, hex) == 3) {
+        Entry_t entry;
+        entry.type = type;
+        if (strcmp(hex, "-") != 0) {
+            for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+                unsigned int byte;
+                sscanf(hex + i, "%2x", &byte);
+                entry.value.push_back((char)byte);
+            }
+        }
+        entries[key] = entry;
+    }
+    fclose(f);
+    return entries;
+}
+
+static bool save(const char* ns, const Namespace_t& entries) {
+    std::string path = nsPath(ns);
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "w");
+    if (!f) {
+        return false;
+    }
+    for (const auto& kv : entries) {
+        fprintf(f, "%s %c ", kv.first.c_str(), kv.second.type);
+        if (kv.second.value.empty()) {
+            fputc('-', f);
+        }
+        for (unsigned char c : kv.second.value) {
+            fprintf(f, "%02x", c);
+        }
+        fputc('\n', f);
+    }
+    bool ok = fclose(f) == 0;
+    return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+// ===== NAMESPACE =====
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    if (open_ || !name || strlen(name) >= sizeof(ns_)) {
+        return false;
+    }
+    strcpy(ns_, name);
+    readOnly_ = readOnly;
+    open_ = true;
+    return true;
+}
+
+void Preferences::end(void) {
+    open_ = false;
+}
+
+bool Preferences::clear(void) {
+    if (!open_ || readOnly_) {
+        return false;
+    }
+    std::lock_guard<std::recursive_mutex> lock(prefsMutex);
+    return save(ns_, Namespace_t());
+}
+
+bool Preferences::remove(const char* key) {
+    if (!open_ || readOnly_) {
+        return false;
+    }
+    std::lock_guard<std::recursive_mutex> lock(prefsMutex);
+    Namespace_t entries = load(ns_);
+    if (entries.erase(key) == 0) {
+        return false;
+    }
+    return save(ns_, entries);
+}
+
+bool Preferences::isKey(const char* key) {
+    if (!open_) {
+        return false;
+    }
+    std::lock_guard<std::recursive_mutex> lock(prefsMutex);
+    Namespace_t entries = load(ns_);
+    return entries.find(key) != entries.end();
+}
+
+// ===== RAW ACCESS =====
+
+size_t Preferences::put(const char* key, char type, const void* value, size_t len) {
+    if (!open_ || readOnly_ || !key || strlen(key) > PREFS_KEY_MAX) {
+        return 0;
+    }
+    std::lock_guard<std::recursive_mutex> lock(prefsMutex);
+    Namespace_t entries = load(ns_);
+    Entry_t& entry = entries[key];
+    entry.type = type;
+    entry.value.assign((const char*)value, len);
+    return save(ns_, entries) ? len : 0;
+}
+
+bool Preferences::get(const char* key, char type, void* value, size_t len) {
+    if (!open_ || !key) {
+        return false;
+    }
+    std::lock_guard<std::recursive_mutex> lock(prefsMutex);
+    Namespace_t entries = load(ns_);
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.type != type || it->second.value.size() != len) {
+        return false;
+    }
+    memcpy(value, it->second.value.data(), len);
+    return true;
+}
+
+// ===== PUT =====
+
+size_t Preferences::putBool(const char* key, bool value) {
+    return putUChar(key, value ? 1 : 0);
+}
+
+size_t Preferences::putUChar(const char* key, uint8_t value) {
+    return put(key, '1', &value, sizeof(value));
+}
+
+size_t Preferences::putUShort(const char* key, uint16_t value) {
+    return put(key, 'S', &value, sizeof(value));
+}
+
+size_t Preferences::putShort(const char* key, int16_t value) {
+    return put(key, 's', &value, sizeof(value));
+}
+
+size_t Preferences::putInt(const char* key, int32_t value) {
+    return put(key, 'i', &value, sizeof(value));
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+    return put(key, 'I', &value, sizeof(value));
+}
+
+size_t Preferences::putLong(const char* key, int32_t value) {
+    return putInt(key, value);
+}
+
+size_t Preferences::putULong(const char* key, uint32_t value) {
+    return putUInt(key, value);
+}
+
+size_t Preferences::putULong64(const char* key, uint64_t value) {
+    return put(key, 'L', &value, sizeof(value));
+}
+
+size_t Preferences::putFloat(const char* key, float value) {
+    return putBytes(key, &value, sizeof(value));
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    return value ? put(key, 'z', value, strlen(value)) : 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    return value ? put(key, 'B', value, len) : 0;
+}
+
+// ===== GET =====
+
+bool Preferences::getBool(const char* key, bool defaultValue) {
+    return getUChar(key, defaultValue ? 1 : 0) != 0;
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) {
+    uint8_t value = defaultValue;
+    get(key, '1', &value, sizeof(value));
+    return value;
+}
+
+uint16_t Preferences::getUShort(const char* key, uint16_t defaultValue) {
+    uint16_t value = defaultValue;
+    get(key, 'S', &value, sizeof(value));
+    return value;
+}
+
+int16_t Preferences::getShort(const char* key, int16_t defaultValue) {
+    int16_t value = defaultValue;
+    get(key, 's', &value, sizeof(value));
+    return value;
+}
+
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+    int32_t value = defaultValue;
+    get(key, 'i', &value, sizeof(value));
+    return value;
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+    uint32_t value = defaultValue;
+    get(key, 'I', &value, sizeof(value));
+    return value;
+}
+
+int32_t Preferences::getLong(const char* key, int32_t defaultValue) {
+    return getInt(key, defaultValue);
+}
+
+uint32_t Preferences::getULong(const char* key, uint32_t defaultValue) {
+    return getUInt(key, defaultValue);
+}
+
+uint64_t Preferences::getULong64(const char* key, uint64_t defaultValue) {
+    uint64_t value = defaultValue;
+    get(key, 'L', &value, sizeof(value));
+    return value;
+}
+
+float Preferences::getFloat(const char* key, float defaultValue) {
+    float value = defaultValue;
+    get(key, 'B', &value, sizeof(value));
+    return value;
+}
+
+String Preferences::getString(const char* key, String defaultValue) {
+    if (!open_ || !key) {
+        return defaultValue;
+    }
+    std::lock_guard<std::recursive_mutex> lock(prefsMutex);
+    Namespace_t entries = load(ns_);
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.type != 'z') {
+        return defaultValue;
+    }
+    return String(it->second.value);
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    String s = getString(key, String());
+    if (s.length() == 0 || s.length() + 1 > maxLen) {
+        return 0;
+    }
+    memcpy(value, s.c_str(), s.length() + 1);
+    return s.length() + 1;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!open_ || !key) {
+        return 0;
+    }
+    std::lock_guard<std::recursive_mutex> lock(prefsMutex);
+    Namespace_t entries = load(ns_);
+    auto it = entries.find(key);
+    return (it == entries.end() || it->second.type != 'B') ? 0 : it->second.value.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    if (!open_ || !key) {
+        return 0;
+    }
+    std::lock_guard<std::recursive_mutex> lock(prefsMutex);
+    Namespace_t entries = load(ns_);
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.type != 'B' || it->second.value.size() > maxLen) {
+        return 0;
+    }
+    memcpy(buf, it->second.value.data(), it->second.value.size());
+    return it->second.value.size();
+}
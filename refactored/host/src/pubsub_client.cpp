@@ -0,0 +1,338 @@
+/**
+ * pubsub_client.cpp
+ * Host Shim: MQTT 3.1.1 Client
+ *
+ * QoS 0 publish, QoS 0/1 subscribe, keepalive and last will, with the
+ * PubSubClient limits the firmware is written against: packets larger
+ * than the buffer are refused (publish) or dropped (receive).
+ */
+
+#include <PubSubClient.h>
+#include <vector>
+
+#define MQTT_DEFAULT_BUFFER 256
+#define MQTT_DEFAULT_KEEPALIVE 15
+#define MQTT_SOCKET_TIMEOUT_MS 15000
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CONNECT 0x10
+#define MQTT_CONNACK 0x20
+#define MQTT_PUBLISH 0x30
+#define MQTT_PUBACK 0x40
+#define MQTT_SUBSCRIBE 0x82
+#define MQTT_UNSUBSCRIBE 0xA2
+#define MQTT_PINGREQ 0xC0
+#define MQTT_PINGRESP 0xD0
+#define MQTT_DISCONNECT 0xE0
+
+static void putString(std::vector<uint8_t>& out, const char* s) {
+    size_t len = strlen(s);
+    out.push_back((uint8_t)(len >> 8));
+    out.push_back((uint8_t)len);
+    out.insert(out.end(), s, s + len);
+}
+
+static void putLength(std::vector<uint8_t>& out, size_t len) {
+    do {
+        uint8_t digit = len % 128;
+        len /= 128;
+        out.push_back(len > 0 ? (digit | 0x80) : digit);
+    } while (len > 0);
+}
+
+PubSubClient::PubSubClient(WiFiClient& client)
+    : client_(&client), port_(1883), keepAliveSec_(MQTT_DEFAULT_KEEPALIVE),
+      bufferSize_(0), buffer_(nullptr), nextMsgId_(1), lastOutMs_(0), lastInMs_(0),
+      pingOutstanding_(false), state_(MQTT_DISCONNECTED) {
+    host_[0] = '\0';
+    setBufferSize(MQTT_DEFAULT_BUFFER);
+}
+
+PubSubClient::~PubSubClient() {
+    free(buffer_);
+}
+
+PubSubClient& PubSubClient::setServer(const char* host, uint16_t port) {
+    strlcpy(host_, host, sizeof(host_));
+    port_ = port;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+    callback_ = callback;
+    return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+    if (size == 0) {
+        return false;
+    }
+    uint8_t* buffer = (uint8_t*)realloc(buffer_, size);
+    if (!buffer) {
+        return false;
+    }
+    buffer_ = buffer;
+    bufferSize_ = size;
+    return true;
+}
+
+// ===== CONNECTION =====
+
+bool PubSubClient::connect(const char* id) {
+    return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+    return connect(id, user, pass, nullptr, 0, false, nullptr);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass, const char* willTopic,
+                           uint8_t willQos, bool willRetain, const char* willMessage) {
+    if (connected()) {
+        return true;
+    }
+    client_->setTimeout(MQTT_SOCKET_TIMEOUT_MS);
+    if (!client_->connect(host_, port_)) {
+        state_ = MQTT_CONNECT_FAILED;
+        return false;
+    }
+
+    uint8_t flags = 0x02;   // Clean session
+    if (willTopic) {
+        flags |= 0x04 | (uint8_t)(willQos << 3) | (willRetain ? 0x20 : 0);
+    }
+    if (user && *user) {
+        flags |= 0x80;
+        if (pass) {
+            flags |= 0x40;
+        }
+    }
+
+    std::vector<uint8_t> body;
+    putString(body, "MQTT");
+    body.push_back(4);      // 3.1.1
+    body.push_back(flags);
+    body.push_back((uint8_t)(keepAliveSec_ >> 8));
+    body.push_back((uint8_t)keepAliveSec_);
+    putString(body, id);
+    if (willTopic) {
+        putString(body, willTopic);
+        putString(body, willMessage ? willMessage : "");
+    }
+    if (flags & 0x80) {
+        putString(body, user);
+        if (flags & 0x40) {
+            putString(body, pass);
+        }
+    }
+    if (!sendPacket(MQTT_CONNECT, body.data(), body.size())) {
+        state_ = MQTT_CONNECT_FAILED;
+        return false;
+    }
+
+    uint8_t header;
+    size_t len;
+    if (!readPacket(&header, &len)) {
+        client_->stop();
+        state_ = MQTT_CONNECTION_TIMEOUT;
+        return false;
+    }
+    if ((header & 0xF0) != MQTT_CONNACK || len < 2 || buffer_[1] != 0) {
+        client_->stop();
+        state_ = len >= 2 ? buffer_[1] : MQTT_CONNECT_FAILED;
+        return false;
+    }
+
+    lastInMs_ = lastOutMs_ = millis();
+    pingOutstanding_ = false;
+    state_ = MQTT_CONNECTED;
+    return true;
+}
+
+void PubSubClient::disconnect(void) {
+    if (client_->connected()) {
+        sendPacket(MQTT_DISCONNECT, nullptr, 0);
+    }
+    client_->stop();
+    state_ = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::connected(void) {
+    if (client_->connected()) {
+        return state_ == MQTT_CONNECTED;
+    }
+    if (state_ == MQTT_CONNECTED) {
+        state_ = MQTT_CONNECTION_LOST;
+    }
+    return false;
+}
+
+bool PubSubClient::loop(void) {
+    if (!connected()) {
+        return false;
+    }
+
+    unsigned long now = millis();
+    unsigned long keepAliveMs = keepAliveSec_ * 1000UL;
+    if (keepAliveMs > 0 && (now - lastInMs_ > keepAliveMs || now - lastOutMs_ > keepAliveMs)) {
+        if (pingOutstanding_) {
+            client_->stop();
+            state_ = MQTT_CONNECTION_TIMEOUT;
+            return false;
+        }
+        sendPacket(MQTT_PINGREQ, nullptr, 0);
+        pingOutstanding_ = true;
+        lastInMs_ = lastOutMs_ = now;
+    }
+
+    while (client_->available() > 0) {
+        uint8_t header;
+        size_t len;
+        if (!readPacket(&header, &len)) {
+            continue;       // Oversized - dropped
+        }
+        lastInMs_ = millis();
+
+        switch (header & 0xF0) {
+            case MQTT_PUBLISH: {
+                if (len < 2) break;
+                size_t topicLen = (size_t)buffer_[0] << 8 | buffer_[1];
+                size_t payloadStart = 2 + topicLen + ((header & 0x06) ? 2 : 0);
+                if (payloadStart > len) break;
+                if (header & 0x06) {
+                    uint8_t ack[2] = {buffer_[2 + topicLen], buffer_[3 + topicLen]};
+                    sendPacket(MQTT_PUBACK, ack, 2);
+                }
+                // Topic moves over its length field so it can be terminated in place
+                memmove(buffer_, buffer_ + 2, topicLen);
+                buffer_[topicLen] = '\0';
+                if (callback_) {
+                    callback_((char*)buffer_, buffer_ + payloadStart, (unsigned int)(len - payloadStart));
+                }
+                break;
+            }
+            case MQTT_PINGREQ:
+                sendPacket(MQTT_PINGRESP, nullptr, 0);
+                break;
+            case MQTT_PINGRESP:
+                pingOutstanding_ = false;
+                break;
+            default:
+                break;      // SUBACK, UNSUBACK
+        }
+    }
+    return connected();
+}
+
+// ===== PUBLISH / SUBSCRIBE =====
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+    return publish(topic, (const uint8_t*)payload, payload ? (unsigned int)strlen(payload) : 0, retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained) {
+    if (!connected() || MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + length > bufferSize_) {
+        return false;
+    }
+    std::vector<uint8_t> body;
+    putString(body, topic);
+    body.insert(body.end(), payload, payload + length);
+    return sendPacket(MQTT_PUBLISH | (retained ? 1 : 0), body.data(), body.size());
+}
+
+bool PubSubClient::beginPublish(const char* topic, unsigned int length, bool retained) {
+    if (!connected()) {
+        return false;
+    }
+    std::vector<uint8_t> packet;
+    packet.push_back(MQTT_PUBLISH | (retained ? 1 : 0));
+    putLength(packet, 2 + strlen(topic) + length);
+    putString(packet, topic);
+    lastOutMs_ = millis();
+    return client_->write(packet.data(), packet.size()) == packet.size();
+}
+
+size_t PubSubClient::write(const uint8_t* buf, size_t len) {
+    lastOutMs_ = millis();
+    return client_->write(buf, len);
+}
+
+int PubSubClient::endPublish(void) {
+    return connected() ? 1 : 0;
+}
+
+bool PubSubClient::subscribe(const char* topic, uint8_t qos) {
+    if (!connected() || qos > 1) {
+        return false;
+    }
+    std::vector<uint8_t> body;
+    uint16_t id = nextMsgId_++;
+    if (nextMsgId_ == 0) nextMsgId_ = 1;
+    body.push_back((uint8_t)(id >> 8));
+    body.push_back((uint8_t)id);
+    putString(body, topic);
+    body.push_back(qos);
+    return sendPacket(MQTT_SUBSCRIBE, body.data(), body.size());
+}
+
+bool PubSubClient::unsubscribe(const char* topic) {
+    if (!connected()) {
+        return false;
+    }
+    std::vector<uint8_t> body;
+    uint16_t id = nextMsgId_++;
+    if (nextMsgId_ == 0) nextMsgId_ = 1;
+    body.push_back((uint8_t)(id >> 8));
+    body.push_back((uint8_t)id);
+    putString(body, topic);
+    return sendPacket(MQTT_UNSUBSCRIBE, body.data(), body.size());
+}
+
+// ===== PACKETS =====
+
+bool PubSubClient::sendPacket(uint8_t header, const uint8_t* body, size_t len) {
+    std::vector<uint8_t> packet;
+    packet.reserve(len + MQTT_MAX_HEADER_SIZE);
+    packet.push_back(header);
+    putLength(packet, len);
+    if (len > 0) {
+        packet.insert(packet.end(), body, body + len);
+    }
+    lastOutMs_ = millis();
+    return client_->write(packet.data(), packet.size()) == packet.size();
+}
+
+bool PubSubClient::readPacket(uint8_t* header, size_t* len) {
+    if (client_->readBytes(header, 1) != 1) {
+        return false;
+    }
+    size_t length = 0;
+    size_t multiplier = 1;
+    for (int i = 0; i < 4; i++) {
+        uint8_t digit;
+        if (client_->readBytes(&digit, 1) != 1) {
+            return false;
+        }
+        length += (digit & 0x7F) * multiplier;
+        multiplier *= 128;
+        if (!(digit & 0x80)) {
+            break;
+        }
+    }
+
+    // Read the body, keeping what fits in the buffer
+    size_t got = 0;
+    while (got < length) {
+        uint8_t scratch[256];
+        uint8_t* dst = got < bufferSize_ ? buffer_ + got : scratch;
+        size_t room = got < bufferSize_ ? bufferSize_ - got : sizeof(scratch);
+        size_t want = length - got < room ? length - got : room;
+        int n = client_->readBytes(dst, want);
+        if (n <= 0) {
+            return false;
+        }
+        got += (size_t)n;
+    }
+    *len = length;
+    return length <= bufferSize_;
+}
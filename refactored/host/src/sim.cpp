@@ -0,0 +1,179 @@
+/**
+ * sim.cpp
+ * Virtual Thermostat Plant, OneWire Bus and DS18B20 Implementation
+ */
+
+#include <DallasTemperature.h>
+#include <OneWire.h>
+#include <math.h>
+#include <mutex>
+#include "host_sim.h"
+
+#define SIM_PINS 40
+#define DS18B20_FAMILY 0x28
+
+typedef struct {
+    uint8_t pin;            // Heater drive pin
+    bool dimmer;            // Drive is the dimmer power, not the pin level
+    float tempC;
+    float drive;            // 0..1
+} SimSensor_t;
+
+static std::mutex simMutex;
+static SimSensor_t sensors[HOST_SIM_SENSORS] = {
+    {5, true, 0, 0},
+    {14, false, 0, 0},
+    {32, false, 0, 0},
+};
+static int sensorCount = HOST_SIM_SENSORS;
+static float ambient = 22.0f;
+static uint8_t pinLevel[SIM_PINS];
+static unsigned long lastStepMs = 0;
+
+/**
+ * Integrate the plant up to now (call with simMutex held)
+ */
+static void step(void) {
+    unsigned long now = millis();
+    float dt = (now - lastStepMs) / 1000.0f;
+    lastStepMs = now;
+    float k = 1.0f - expf(-dt / HOST_SIM_TAU_SEC);
+    for (int i = 0; i < HOST_SIM_SENSORS; i++) {
+        float target = ambient + HOST_SIM_GAIN_C * sensors[i].drive;
+        sensors[i].tempC += (target - sensors[i].tempC) * k;
+    }
+}
+
+// ===== PLANT =====
+
+void host_sim_init(float ambientC, int count) {
+    std::lock_guard<std::mutex> lock(simMutex);
+    ambient = ambientC;
+    sensorCount = constrain(count, 0, HOST_SIM_SENSORS);
+    for (int i = 0; i < HOST_SIM_SENSORS; i++) {
+        sensors[i].tempC = ambientC;
+        sensors[i].drive = 0;
+    }
+    lastStepMs = millis();
+}
+
+int host_sim_sensor_count(void) {
+    return sensorCount;
+}
+
+void host_sim_sensor_address(int index, uint8_t* address) {
+    address[0] = DS18B20_FAMILY;
+    address[1] = 0x5E;          // "SE"nsor, then the index
+    address[2] = 0x45;
+    address[3] = (uint8_t)(index + 1);
+    address[4] = 0;
+    address[5] = 0;
+    address[6] = 0;
+    address[7] = OneWire::crc8(address, 7);
+}
+
+float host_sim_read(const uint8_t* address) {
+    std::lock_guard<std::mutex> lock(simMutex);
+    for (int i = 0; i < sensorCount; i++) {
+        uint8_t expected[8];
+        host_sim_sensor_address(i, expected);
+        if (memcmp(address, expected, 8) == 0) {
+            step();
+            return roundf(sensors[i].tempC * 16.0f) / 16.0f;     // 12-bit: 0.0625 C
+        }
+    }
+    return DEVICE_DISCONNECTED_C;
+}
+
+void host_sim_set_pin(uint8_t pin, uint8_t level) {
+    if (pin >= SIM_PINS) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(simMutex);
+    step();
+    pinLevel[pin] = level;
+    for (int i = 0; i < HOST_SIM_SENSORS; i++) {
+        if (sensors[i].pin == pin && !sensors[i].dimmer) {
+            sensors[i].drive = level ? 1.0f : 0.0f;
+        }
+    }
+}
+
+int host_sim_get_pin(uint8_t pin) {
+    std::lock_guard<std::mutex> lock(simMutex);
+    return pin < SIM_PINS ? pinLevel[pin] : LOW;
+}
+
+void host_sim_set_dimmer(uint8_t pin, int power) {
+    std::lock_guard<std::mutex> lock(simMutex);
+    step();
+    for (int i = 0; i < HOST_SIM_SENSORS; i++) {
+        if (sensors[i].pin == pin && sensors[i].dimmer) {
+            sensors[i].drive = constrain(power, 0, 100) / 100.0f;
+        }
+    }
+}
+
+// ===== ONEWIRE =====
+
+bool OneWire::search(uint8_t* address) {
+    if (searchIndex_ >= host_sim_sensor_count()) {
+        return false;
+    }
+    host_sim_sensor_address(searchIndex_++, address);
+    return true;
+}
+
+uint8_t OneWire::crc8(const uint8_t* data, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        uint8_t in = *data++;
+        for (int i = 0; i < 8; i++) {
+            uint8_t mix = (crc ^ in) & 0x01;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            in >>= 1;
+        }
+    }
+    return crc;
+}
+
+// ===== DS18B20 =====
+
+uint8_t DallasTemperature::getDeviceCount(void) {
+    return (uint8_t)host_sim_sensor_count();
+}
+
+bool DallasTemperature::getAddress(uint8_t* address, uint8_t index) {
+    if (index >= host_sim_sensor_count()) {
+        return false;
+    }
+    host_sim_sensor_address(index, address);
+    return true;
+}
+
+int16_t DallasTemperature::millisToWaitForConversion(uint8_t bits) {
+    switch (bits) {
+        case 9: return 94;
+        case 10: return 188;
+        case 11: return 375;
+        default: return 750;
+    }
+}
+
+bool DallasTemperature::isConversionComplete(void) {
+    return millis() - requestedMs_ >= (unsigned long)millisToWaitForConversion(resolution_);
+}
+
+void DallasTemperature::requestTemperatures(void) {
+    requestedMs_ = millis();
+    if (waitForConversion_) {
+        delay(millisToWaitForConversion(resolution_));
+    }
+}
+
+float DallasTemperature::getTempC(const uint8_t* address) {
+    return host_sim_read(address);
+}
@@ -0,0 +1,517 @@
+/**
+ * webserver.cpp
+ * Host Shim: ESP32 WebServer Implementation
+ */
+
+#include <WebServer.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "host.h"
+
+#define HTTP_MAX_HEADER 16384
+#define HTTP_OUT_FLUSH 1460         // One TCP segment
+#define HTTP_BACKLOG 32
+
+static const char* statusText(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "";
+    }
+}
+
+static HTTPMethod parseMethod(const std::string& s) {
+    if (s == "GET") return HTTP_GET;
+    if (s == "HEAD") return HTTP_HEAD;
+    if (s == "POST") return HTTP_POST;
+    if (s == "PUT") return HTTP_PUT;
+    if (s == "PATCH") return HTTP_PATCH;
+    if (s == "DELETE") return HTTP_DELETE;
+    if (s == "OPTIONS") return HTTP_OPTIONS;
+    return HTTP_ANY;
+}
+
+static std::string urlDecode(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '+') {
+            out += ' ';
+        } else if (s[i] == '%' && i + 2 < s.size() && isxdigit((unsigned char)s[i + 1]) &&
+                   isxdigit((unsigned char)s[i + 2])) {
+            out += (char)strtol(s.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+static std::string lower(std::string s) {
+    for (char& c : s) c = (char)tolower((unsigned char)c);
+    return s;
+}
+
+/**
+ * Write a whole buffer (a client that went away gets the rest dropped)
+ */
+static void sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (fd >= 0 && sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        sent += (size_t)n;
+    }
+}
+
+/**
+ * Get a parameter of a header value, e.g. boundary= or name="..."
+ */
+static std::string headerParam(const std::string& value, const std::string& key) {
+    size_t pos = lower(value).find(key + "=");
+    if (pos == std::string::npos) {
+        return std::string();
+    }
+    pos += key.size() + 1;
+    if (pos < value.size() && value[pos] == '"') {
+        size_t end = value.find('"', pos + 1);
+        return value.substr(pos + 1, end == std::string::npos ? std::string::npos : end - pos - 1);
+    }
+    size_t end = value.find(';', pos);
+    return value.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+}
+
+WebServer* WebServer::active_ = nullptr;
+
+WebServer::WebServer(int port)
+    : port_(port), listenFd_(-1), clientFd_(-1),
+      method_(HTTP_ANY), http11_(false), contentLength_(CONTENT_LENGTH_NOT_SET),
+      headersSent_(false), chunked_(false), capture_(nullptr) {
+    upload_.status = UPLOAD_FILE_START;
+    upload_.totalSize = 0;
+    upload_.currentSize = 0;
+}
+
+WebServer::~WebServer() {
+    if (active_ == this) {
+        active_ = nullptr;
+    }
+    close();
+}
+
+void WebServer::begin(void) {
+    active_ = this;
+
+    // Resolved here: the server is usually a global, constructed before main() parses --port
+    if (port_ == 80) {
+        port_ = host_http_port();
+    }
+    listenFd_ = socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (listenFd_ < 0) {
+        return;
+    }
+    int one = 1;
+    int zero = 0;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(listenFd_, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+
+    struct sockaddr_in6 addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons((uint16_t)port_);
+    if (bind(listenFd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd_, HTTP_BACKLOG) < 0) {
+        Serial.printf("[HOST] HTTP port %d: %s\n", port_, strerror(errno));
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return;
+    }
+    Serial.printf("[HOST] UI at http://localhost:%d/\n", port_);
+}
+
+void WebServer::close(void) {
+    if (listenFd_ >= 0) {
+        ::close(listenFd_);
+        listenFd_ = -1;
+    }
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler, THandlerFunction upload) {
+    routes_.push_back({uri.c_str(), method, handler, upload});
+}
+
+// ===== REQUEST =====
+
+void WebServer::handleClient(void) {
+    if (listenFd_ < 0) {
+        return;
+    }
+    clientFd_ = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (clientFd_ < 0) {
+        return;
+    }
+
+    resetRequest();
+    std::string body;
+    if (readRequest(&body)) {
+        dispatch(body);
+    }
+
+    finishResponse();
+    ::close(clientFd_);
+    clientFd_ = -1;
+}
+
+void WebServer::serve(HTTPMethod method, const String& uri, std::string* response) {
+    resetRequest();
+    method_ = method;
+    http11_ = true;
+    uri_ = uri.c_str();
+    capture_ = response;
+    dispatch(std::string());
+    finishResponse();
+    capture_ = nullptr;
+}
+
+void WebServer::resetRequest(void) {
+    args_.clear();
+    headers_.clear();
+    responseHeaders_.clear();
+    out_.clear();
+    contentLength_ = CONTENT_LENGTH_NOT_SET;
+    headersSent_ = false;
+    chunked_ = false;
+}
+
+void WebServer::dispatch(const std::string& body) {
+    const Route* route = nullptr;
+    for (const Route& r : routes_) {
+        if (r.uri == uri_ && (r.method == HTTP_ANY || r.method == method_)) {
+            route = &r;
+            break;
+        }
+    }
+
+    std::string type = lower(header("Content-Type").c_str());
+    if (route && route->upload && type.compare(0, 19, "multipart/form-data") == 0) {
+        handleMultipart(body, headerParam(header("Content-Type").c_str(), "boundary"), route);
+    } else if (!body.empty()) {
+        if (type.compare(0, 33, "application/x-www-form-urlencoded") == 0) {
+            parseArgs(body);
+        }
+        args_.push_back({"plain", body});
+    }
+
+    if (route) {
+        route->handler();
+    } else if (notFound_) {
+        notFound_();
+    } else {
+        send(404, "text/plain", String("Not found: ") + uri_.c_str());
+    }
+}
+
+bool WebServer::readRequest(std::string* body) {
+    std::string data;
+    size_t headerEnd = std::string::npos;
+    size_t bodyLen = 0;
+    unsigned long start = millis();
+    char buf[4096];
+
+    for (;;) {
+        if (headerEnd == std::string::npos) {
+            headerEnd = data.find("\r\n\r\n");
+            if (headerEnd != std::string::npos) {
+                // Request line and headers
+                size_t lineEnd = data.find("\r\n");
+                std::string line = data.substr(0, lineEnd);
+                size_t sp1 = line.find(' ');
+                size_t sp2 = line.rfind(' ');
+                if (sp1 == std::string::npos || sp2 == sp1) {
+                    send(400, "text/plain", "Bad Request");
+                    return false;
+                }
+                method_ = parseMethod(line.substr(0, sp1));
+                http11_ = line.compare(sp2 + 1, std::string::npos, "HTTP/1.1") == 0;
+                std::string target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+                size_t q = target.find('?');
+                uri_ = target.substr(0, q);
+                if (q != std::string::npos) {
+                    parseArgs(target.substr(q + 1));
+                }
+
+                size_t pos = lineEnd + 2;
+                while (pos < headerEnd) {
+                    size_t end = data.find("\r\n", pos);
+                    std::string h = data.substr(pos, end - pos);
+                    size_t colon = h.find(':');
+                    if (colon != std::string::npos) {
+                        size_t v = h.find_first_not_of(" \t", colon + 1);
+                        headers_.push_back({h.substr(0, colon), v == std::string::npos ? "" : h.substr(v)});
+                    }
+                    pos = end + 2;
+                }
+
+                bodyLen = (size_t)strtoul(header("Content-Length").c_str(), nullptr, 10);
+                if (bodyLen > HTTP_MAX_BODY) {
+                    send(413, "text/plain", "Payload Too Large");
+                    return false;
+                }
+                headerEnd += 4;
+            } else if (data.size() > HTTP_MAX_HEADER) {
+                send(400, "text/plain", "Bad Request");
+                return false;
+            }
+        }
+        if (headerEnd != std::string::npos && data.size() >= headerEnd + bodyLen) {
+            *body = data.substr(headerEnd, bodyLen);
+            return true;
+        }
+
+        long left = HTTP_MAX_DATA_WAIT - (long)(millis() - start);
+        struct pollfd pfd = {clientFd_, POLLIN, 0};
+        if (left <= 0 || poll(&pfd, 1, (int)left) <= 0) {
+            return false;
+        }
+        ssize_t n = recv(clientFd_, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return false;
+        }
+        data.append(buf, (size_t)n);
+    }
+}
+
+void WebServer::parseArgs(const std::string& query) {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) end = query.size();
+        std::string pair = query.substr(pos, end - pos);
+        if (!pair.empty()) {
+            size_t eq = pair.find('=');
+            args_.push_back({urlDecode(pair.substr(0, eq)),
+                             eq == std::string::npos ? "" : urlDecode(pair.substr(eq + 1))});
+        }
+        pos = end + 1;
+    }
+}
+
+void WebServer::handleMultipart(const std::string& body, const std::string& boundary, const Route* route) {
+    if (boundary.empty()) {
+        return;
+    }
+    std::string delim = "--" + boundary;
+    size_t pos = body.find(delim);
+    while (pos != std::string::npos) {
+        pos += delim.size();
+        if (body.compare(pos, 2, "--") == 0) {
+            break;              // Closing delimiter
+        }
+        size_t partHeaders = pos + 2;
+        size_t partData = body.find("\r\n\r\n", partHeaders);
+        size_t next = body.find("\r\n" + delim, partHeaders);
+        if (partData == std::string::npos || next == std::string::npos || partData > next) {
+            break;
+        }
+
+        std::string disposition;
+        std::string contentType;
+        std::string headers = body.substr(partHeaders, partData - partHeaders);
+        size_t h = 0;
+        while (h < headers.size()) {
+            size_t end = headers.find("\r\n", h);
+            if (end == std::string::npos) end = headers.size();
+            std::string line = headers.substr(h, end - h);
+            std::string key = lower(line.substr(0, line.find(':')));
+            std::string value = line.find(':') == std::string::npos ? "" : line.substr(line.find(':') + 1);
+            if (key == "content-disposition") disposition = value;
+            if (key == "content-type") contentType = value.substr(value.find_first_not_of(' '));
+            h = end + 2;
+        }
+
+        partData += 4;
+        std::string name = headerParam(disposition, "name");
+        if (disposition.find("filename") == std::string::npos) {
+            args_.push_back({name, body.substr(partData, next - partData)});
+        } else {
+            // File part: same START / WRITE... / END sequence as the core
+            upload_.filename = String(headerParam(disposition, "filename"));
+            upload_.name = String(name);
+            upload_.type = String(contentType);
+            upload_.totalSize = 0;
+            upload_.currentSize = 0;
+            upload_.status = UPLOAD_FILE_START;
+            route->upload();
+
+            for (size_t p = partData; p < next; p += HTTP_UPLOAD_BUFLEN) {
+                size_t n = std::min((size_t)HTTP_UPLOAD_BUFLEN, next - p);
+                memcpy(upload_.buf, body.data() + p, n);
+                upload_.currentSize = n;
+                upload_.totalSize += n;
+                upload_.status = UPLOAD_FILE_WRITE;
+                route->upload();
+            }
+
+            upload_.currentSize = 0;
+            upload_.status = UPLOAD_FILE_END;
+            route->upload();
+        }
+        pos = next + 2;
+    }
+}
+
+String WebServer::arg(int index) const {
+    return index >= 0 && index < (int)args_.size() ? String(args_[index].second) : String();
+}
+
+String WebServer::arg(const String& name) const {
+    for (const auto& a : args_) {
+        if (a.first == name.c_str()) {
+            return String(a.second);
+        }
+    }
+    return String();
+}
+
+String WebServer::argName(int index) const {
+    return index >= 0 && index < (int)args_.size() ? String(args_[index].first) : String();
+}
+
+bool WebServer::hasArg(const String& name) const {
+    for (const auto& a : args_) {
+        if (a.first == name.c_str()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+String WebServer::header(const String& name) const {
+    for (const auto& h : headers_) {
+        if (strcasecmp(h.first.c_str(), name.c_str()) == 0) {
+            return String(h.second);
+        }
+    }
+    return String();
+}
+
+bool WebServer::hasHeader(const String& name) const {
+    for (const auto& h : headers_) {
+        if (strcasecmp(h.first.c_str(), name.c_str()) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ===== RESPONSE =====
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+    std::pair<std::string, std::string> h(name.c_str(), value.c_str());
+    if (first) {
+        responseHeaders_.insert(responseHeaders_.begin(), h);
+    } else {
+        responseHeaders_.push_back(h);
+    }
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+    if (headersSent_) {
+        return;
+    }
+    std::string head = "HTTP/1.1 " + std::to_string(code) + " " + statusText(code) + "\r\n";
+    if (contentType && *contentType) {
+        head += std::string("Content-Type: ") + contentType + "\r\n";
+    }
+    for (const auto& h : responseHeaders_) {
+        head += h.first + ": " + h.second + "\r\n";
+    }
+    if (contentLength_ == CONTENT_LENGTH_UNKNOWN) {
+        // Length-less HTTP/1.0 responses end at close
+        chunked_ = http11_;
+        if (chunked_) {
+            head += "Transfer-Encoding: chunked\r\n";
+        }
+    } else {
+        size_t length = contentLength_ == CONTENT_LENGTH_NOT_SET ? content.length() : contentLength_;
+        head += "Content-Length: " + std::to_string(length) + "\r\n";
+    }
+    head += "Connection: close\r\n\r\n";
+    headersSent_ = true;
+    writeRaw(head.data(), head.size());
+
+    if (method_ != HTTP_HEAD && content.length() > 0) {
+        sendContent(content);
+    }
+    if (!chunked_) {
+        flushOut();     // Complete: out before the handler goes on (e.g. to restart)
+    }
+}
+
+void WebServer::sendContent(const char* content, size_t length) {
+    if (!chunked_) {
+        writeRaw(content, length);
+        return;
+    }
+    char size[16];
+    int n = snprintf(size, sizeof(size), "%zx\r\n", length);
+    writeRaw(size, (size_t)n);
+    writeRaw(content, length);
+    writeRaw("\r\n", 2);
+    if (length == 0) {
+        chunked_ = false;       // Last chunk
+        flushOut();
+    }
+}
+
+void WebServer::finishResponse(void) {
+    if (chunked_) {
+        writeRaw("0\r\n\r\n", 5);
+        chunked_ = false;
+    }
+    flushOut();
+    if (clientFd_ >= 0) {
+        shutdown(clientFd_, SHUT_WR);
+    }
+}
+
+void WebServer::writeRaw(const char* data, size_t len) {
+    out_.append(data, len);
+    if (out_.size() >= HTTP_OUT_FLUSH) {
+        flushOut();
+    }
+}
+
+void WebServer::flushOut(void) {
+    if (capture_) {
+        capture_->append(out_);
+    } else {
+        sendAll(clientFd_, out_);
+    }
+    out_.clear();
+}
@@ -0,0 +1,373 @@
+/**
+ * wifi.cpp
+ * Host Shim: WiFi, TCP Client and UDP Implementation
+ *
+ * The station is "connected" as soon as begin() is called and reports the
+ * --ip address. Sockets are real, so MQTT and fleet multicast reach real
+ * brokers and other instances.
+ */
+
+#include <WiFi.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "host.h"
+
+#define HOST_RSSI -55
+
+WiFiClass WiFi;
+
+static bool staStarted = false;
+static bool apStarted = false;
+static String staSSID;
+
+// ===== IPADDRESS =====
+
+bool IPAddress::fromString(const char* s) {
+    struct in_addr addr;
+    if (!s || inet_pton(AF_INET, s, &addr) != 1) {
+        return false;
+    }
+    addr_ = addr.s_addr;
+    return true;
+}
+
+String IPAddress::toString(void) const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+}
+
+// ===== WIFI =====
+
+wl_status_t WiFiClass::status(void) {
+    return staStarted ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password) {
+    (void)password;
+    staSSID = ssid ? ssid : "";
+    staStarted = true;
+    return WL_CONNECTED;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    if (!(mode & WIFI_STA)) {
+        staStarted = false;
+    }
+    if (!(mode & WIFI_AP)) {
+        apStarted = false;
+    }
+    return true;
+}
+
+bool WiFiClass::softAPConfig(IPAddress ip, IPAddress gateway, IPAddress subnet) {
+    (void)ip;
+    (void)gateway;
+    (void)subnet;
+    return true;
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* password) {
+    (void)ssid;
+    (void)password;
+    apStarted = true;
+    return true;
+}
+
+IPAddress WiFiClass::softAPIP(void) {
+    // The UI is still served on the host; report where to find it
+    return apStarted ? IPAddress(host_local_ip()) : IPAddress();
+}
+
+IPAddress WiFiClass::localIP(void) {
+    return staStarted ? IPAddress(host_local_ip()) : IPAddress();
+}
+
+int8_t WiFiClass::RSSI(void) {
+    return staStarted ? HOST_RSSI : 0;
+}
+
+String WiFiClass::SSID(void) {
+    return staStarted ? staSSID : String();
+}
+
+String WiFiClass::macAddress(void) {
+    uint64_t mac = ESP.getEfuseMac();
+    char buf[18];
+    snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X",
+             (unsigned)(mac & 0xFF), (unsigned)(mac >> 8 & 0xFF), (unsigned)(mac >> 16 & 0xFF),
+             (unsigned)(mac >> 24 & 0xFF), (unsigned)(mac >> 32 & 0xFF), (unsigned)(mac >> 40 & 0xFF));
+    return String(buf);
+}
+
+bool WiFiClass::setHostname(const char* name) {
+    (void)name;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+    (void)wifiOff;
+    staStarted = false;
+    return true;
+}
+
+// ===== TCP CLIENT =====
+
+WiFiClient::~WiFiClient() {
+    stop();
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    stop();
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* res = nullptr;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &res) != 0 || !res) {
+        return 0;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        return 0;
+    }
+
+    // Connect with the timeout, like lwIP's, instead of the kernel's minutes
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    int rc = ::connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (rc < 0 && errno == EINPROGRESS) {
+        struct pollfd pfd = {fd, POLLOUT, 0};
+        int err = 0;
+        socklen_t errLen = sizeof(err);
+        if (poll(&pfd, 1, (int)timeoutMs_) == 1 &&
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) == 0 && err == 0) {
+            rc = 0;
+        }
+    }
+    if (rc < 0) {
+        close(fd);
+        return 0;
+    }
+    fcntl(fd, F_SETFL, 0);
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fd_ = fd;
+    return 1;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t len) {
+    size_t sent = 0;
+    while (fd_ >= 0 && sent < len) {
+        ssize_t n = send(fd_, buf + sent, len - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            stop();
+            break;
+        }
+        sent += (size_t)n;
+    }
+    return sent;
+}
+
+int WiFiClient::available(void) {
+    int n = 0;
+    if (fd_ < 0 || ioctl(fd_, FIONREAD, &n) < 0) {
+        return 0;
+    }
+    return n;
+}
+
+int WiFiClient::read(void) {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t len) {
+    if (fd_ < 0) {
+        return -1;
+    }
+    ssize_t n = recv(fd_, buf, len, MSG_DONTWAIT);
+    if (n == 0) {
+        stop();     // Peer closed
+        return -1;
+    }
+    return n < 0 ? -1 : (int)n;
+}
+
+int WiFiClient::readBytes(uint8_t* buf, size_t len) {
+    size_t got = 0;
+    unsigned long start = millis();
+    while (got < len && fd_ >= 0) {
+        struct pollfd pfd = {fd_, POLLIN, 0};
+        long left = (long)timeoutMs_ - (long)(millis() - start);
+        if (left <= 0 || poll(&pfd, 1, (int)left) <= 0) {
+            break;
+        }
+        int n = read(buf + got, len - got);
+        if (n > 0) {
+            got += (size_t)n;
+        }
+    }
+    return (int)got;
+}
+
+uint8_t WiFiClient::connected(void) {
+    if (fd_ < 0) {
+        return 0;
+    }
+    uint8_t c;
+    ssize_t n = recv(fd_, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiClient::stop(void) {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+// ===== UDP =====
+
+static int udpSocket(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    // Several instances on one machine share the fleet port
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+    stop();
+    fd_ = udpSocket(port);
+    port_ = port;
+    return fd_ >= 0;
+}
+
+uint8_t WiFiUDP::beginMulticast(IPAddress group, uint16_t port) {
+    if (!begin(port)) {
+        return 0;
+    }
+    struct ip_mreq mreq;
+    mreq.imr_multiaddr.s_addr = (uint32_t)group;
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        stop();
+        return 0;
+    }
+    int loop = 1;
+    setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    group_ = group;
+    return 1;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    if (fd_ < 0 && !begin(0)) {
+        return 0;
+    }
+    txIP_ = ip;
+    txPort_ = port;
+    txLen_ = 0;
+    return 1;
+}
+
+int WiFiUDP::beginMulticastPacket(void) {
+    if ((uint32_t)group_ == 0) {
+        return 0;
+    }
+    return beginPacket(group_, port_);
+}
+
+size_t WiFiUDP::write(const uint8_t* buf, size_t len) {
+    size_t room = sizeof(txBuf_) - (size_t)txLen_;
+    if (len > room) {
+        len = room;
+    }
+    memcpy(txBuf_ + txLen_, buf, len);
+    txLen_ += (int)len;
+    return len;
+}
+
+int WiFiUDP::endPacket(void) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = (uint32_t)txIP_;
+    addr.sin_port = htons(txPort_);
+    ssize_t n = sendto(fd_, txBuf_, (size_t)txLen_, 0, (struct sockaddr*)&addr, sizeof(addr));
+    txLen_ = 0;
+    return n >= 0;
+}
+
+int WiFiUDP::parsePacket(void) {
+    rxLen_ = 0;
+    rxPos_ = 0;
+    if (fd_ < 0) {
+        return 0;
+    }
+    struct sockaddr_in from;
+    socklen_t fromLen = sizeof(from);
+    ssize_t n = recvfrom(fd_, rxBuf_, sizeof(rxBuf_), 0, (struct sockaddr*)&from, &fromLen);
+    if (n <= 0) {
+        return 0;
+    }
+    rxLen_ = (int)n;
+    remoteIP_ = IPAddress((uint32_t)from.sin_addr.s_addr);
+    remotePort_ = ntohs(from.sin_port);
+    return rxLen_;
+}
+
+int WiFiUDP::read(uint8_t* buf, size_t len) {
+    int n = available();
+    if ((size_t)n > len) {
+        n = (int)len;
+    }
+    memcpy(buf, rxBuf_ + rxPos_, (size_t)n);
+    rxPos_ += n;
+    return n;
+}
+
+void WiFiUDP::stop(void) {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+    group_ = IPAddress();
+    rxLen_ = 0;
+    rxPos_ = 0;
+}
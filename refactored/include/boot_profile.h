@@ -0,0 +1,62 @@
+/**
+ * boot_profile.h
+ * Boot Phase Timing
+ *
+ * Records when each stage of the staged startup completed
+ * (milliseconds since reset) so slow phases can be spotted
+ * and time-to-control verified.
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <Arduino.h>
+
+/**
+ * Boot phases, in the order setup() runs them
+ */
+typedef enum {
+    BOOT_PHASE_CORE = 0,       // Logger, console, safety manager
+    BOOT_PHASE_CONFIG,         // Sensors scanned, output config restored
+    BOOT_PHASE_CONTROL,        // Control task running
+    BOOT_PHASE_DISPLAY,        // Display initialized (includes splash)
+    BOOT_PHASE_WIFI,           // WiFi connected or AP started
+    BOOT_PHASE_NETWORK,        // mDNS, NTP, MQTT
+    BOOT_PHASE_WEBSERVER,      // Web server listening
+    BOOT_PHASE_READY,          // setup() complete
+    BOOT_PHASE_COUNT
+} BootPhase_t;
+
+/**
+ * Mark a phase as complete
+ * @param phase Phase just finished
+ */
+void boot_profile_mark(BootPhase_t phase);
+
+/**
+ * Get phase completion time
+ * @param phase Phase
+ * @return Milliseconds since reset, or 0 if not reached
+ */
+uint32_t boot_profile_get_ms(BootPhase_t phase);
+
+/**
+ * Get time spent in a phase
+ * @param phase Phase
+ * @return Milliseconds since previous phase completed, or 0 if not reached
+ */
+uint32_t boot_profile_get_duration_ms(BootPhase_t phase);
+
+/**
+ * Get phase name
+ * @param phase Phase
+ * @return Short name string (e.g., "control")
+ */
+const char* boot_profile_get_phase_name(BootPhase_t phase);
+
+/**
+ * Write phase timings to the console
+ */
+void boot_profile_log_summary(void);
+
+#endif // BOOT_PROFILE_H
@@ -0,0 +1,96 @@
+/**
+ * cascade_control.h
+ * Two-Loop (Cascade) Temperature Control
+ *
+ * Outer loop: air sensor vs target -> surface setpoint for the heater
+ * Inner loop: surface sensor vs that setpoint -> heater power %
+ *
+ * The outer output is an offset above the air target, clamped to
+ * [outer.outMin, outer.outMax] and never above surfaceMaxC. The inner
+ * loop runs faster, so a disturbance at the heater (supply sag, damp
+ * substrate) is corrected before the air sees it. Power is forced to 0
+ * while the surface reads at or above surfaceMaxC.
+ *
+ * Both loops are pid_control_step() with fixed gains: derivative on
+ * measurement (no kick when the outer loop moves the inner setpoint),
+ * conditional integration plus back-calculation while clamped, and
+ * bumpless restarts. The air target is setpoint weighted like the
+ * single-loop PID; the inner setpoint is not.
+ */
+
+#ifndef CASCADE_CONTROL_H
+#define CASCADE_CONTROL_H
+
+#include "pid_control.h"
+#include <stdint.h>
+
+/**
+ * Gains and output clamp for one loop
+ */
+typedef struct {
+    float kp;
+    float ki;
+    float kd;
+    float outMin;
+    float outMax;
+} PidLoopParams_t;
+
+/**
+ * Cascade configuration
+ */
+typedef struct {
+    PidLoopParams_t outer;    // Air loop, output in °C above the air target
+    PidLoopParams_t inner;    // Surface loop, output in power % (0-100)
+    float surfaceMaxC;        // Hard surface ceiling
+    float outerPeriodSec;     // Outer loop period (slow, air responds slowly)
+    float innerPeriodSec;     // Inner loop period
+} CascadeParams_t;
+
+/**
+ * Cascade runtime state
+ */
+typedef struct {
+    PidControlState_t outer;  // I term in °C of offset
+    PidControlState_t inner;  // I term in % power
+    float surfaceSetpoint;    // Last outer loop result
+    float outerElapsed;       // Seconds since the outer loop ran
+    float innerElapsed;       // Seconds since the inner loop ran
+    float power;              // Last inner loop result (0-100)
+    bool started;             // Loops have run since reset
+    bool atCeiling;           // Surface at or above surfaceMaxC
+} CascadeState_t;
+
+/**
+ * Fill in default cascade parameters
+ * @param params Parameters to fill
+ */
+void cascade_default_params(CascadeParams_t* params);
+
+/**
+ * Reset cascade state (both loops, both timers)
+ * @param state Cascade state
+ * @param bumpless true: the next update starts the surface setpoint at the
+ *                 surface reading and the power at currentPower;
+ *                 false: both integrals start from zero
+ */
+void cascade_reset(CascadeState_t* state, bool bumpless);
+
+/**
+ * Advance the cascade
+ * Each loop runs when its period has elapsed; in between the last
+ * power is held. Call as often as convenient.
+ * @param params Cascade configuration
+ * @param state Cascade state
+ * @param airTarget Air setpoint (°C)
+ * @param airTemp Air reading (°C)
+ * @param surfaceTemp Surface reading (°C)
+ * @param setpointWeight Share of an air target step the outer P reacts to (0-1)
+ * @param currentPower Power applied now (%), picked up by a bumpless reset
+ * @param dt Seconds since the previous call
+ * @return Heater power % (0-100)
+ */
+float cascade_update(const CascadeParams_t* params, CascadeState_t* state,
+                     float airTarget, float airTemp, float surfaceTemp,
+                     float setpointWeight, float currentPower, float dt);
+
+#endif // CASCADE_CONTROL_H
@@ -4,12 +4,28 @@
  *
  * Captures system events, MQTT activity, and debug messages
  * for real-time streaming to web console
+ *
+ * Every event gets a sequence number (events added since boot, not
+ * reset by clear), so pollers read only what is new: ask for events
+ * from the last seq + 1, and if that is older than the oldest event
+ * still in the ring, the events in between were overwritten.
+ *
+ * Events live in one packed store (event_log.h) shared with the system
+ * log: each is tagged with the views it belongs to, the console and/or
+ * the log, and logger.h reads the log view. Uptime is stored as a number
+ * and formatted as "[hh:mm:ss] " when an event is read.
+ *
+ * Recurring fixed-format events (the temperature every sensor round,
+ * MQTT output publishes) are added with console_add_event_p(): stored as
+ * a format id and varint arguments, ~6 bytes instead of 16-30, and
+ * formatted when read like the time.
  */
 
 #ifndef CONSOLE_H
 #define CONSOLE_H
 
 #include <Arduino.h>
+#include "event_log.h"
 
 // Event types for filtering
 typedef enum {
@@ -23,6 +39,32 @@ typedef enum {
     CONSOLE_EVENT_DEBUG      // General debug messages
 } ConsoleEventType_t;
 
+// Fixed-format events for console_add_event_p(), formats in console.cpp
+typedef enum {
+    CONSOLE_FMT_TEMP,            // "Temp: %.1f°C"
+    CONSOLE_FMT_MQTT_OUTPUT,     // "MQTT PUB: Output %d changed"
+    CONSOLE_FMT_COUNT
+} ConsoleFormat_t;
+
+#define CONSOLE_STORE_BYTES 9360     // Console + log: the 50 x 136 + 20 x 128 the fixed slots used
+#define CONSOLE_MAX_EVENTS 50           // Most events returned per /api/console request
+#define CONSOLE_MAX_EVENT_LENGTH EVENT_LOG_MAX_LINE
+#define CONSOLE_TYPE_MASK(type) (1UL << (type))
+#define CONSOLE_TYPES_ALL 0xFFFFFFFFUL
+
+// Views an event appears in
+#define CONSOLE_VIEW_CONSOLE 0x01      // Live console (/console, /api/console)
+#define CONSOLE_VIEW_LOG 0x02          // System log (/logs, /api/logs)
+
+/**
+ * Copy of one event
+ */
+typedef struct {
+    uint32_t seq;
+    ConsoleEventType_t type;
+    char message[CONSOLE_MAX_EVENT_LENGTH];   // "[hh:mm:ss] text"
+} ConsoleRecord_t;
+
 /**
  * Initialize console event buffer
  */
@@ -44,27 +86,81 @@ void console_add_event(ConsoleEventType_t type, const char* message);
 void console_add_event_f(ConsoleEventType_t type, const char* format, ...);
 
 /**
- * Get total number of events in buffer
+ * Add a fixed-format console event, stored packed
+ * Arguments as printf would take them for the format: integers (%d, %u,
+ * %lu, %x) and floats (%.1f; kept to tenths). An argument that can't be
+ * packed (non-finite float) stores the event as text instead.
+ * @param type Event type for filtering
+ * @param format CONSOLE_FMT_* id
+ * @param ... Arguments for the format
+ */
+void console_add_event_p(ConsoleEventType_t type, ConsoleFormat_t format, ...);
+
+/**
+ * Add event to one or more views, stored once
+ * @param type Event type for filtering
+ * @param views CONSOLE_VIEW_* bits
+ * @param message Event message
+ */
+void console_add_event_to(ConsoleEventType_t type, uint8_t views, const char* message);
+
+/**
+ * Get number of console events in the store
  * @return Number of events
  */
 int console_get_count(void);
 
 /**
- * Get event at index (newest first)
- * @param index Event index (0 = newest)
- * @return Event string or nullptr if invalid index
+ * Get sequence number of the oldest event still in the store (any view)
+ * @return Sequence number (equals the next seq when empty)
+ */
+uint32_t console_get_first_seq(void);
+
+/**
+ * Get sequence number the next event will get
+ * @return Events added since boot
+ */
+uint32_t console_get_next_seq(void);
+
+/**
+ * Copy the first matching console event at or after a cursor
+ * Copies under the buffer lock, so the event can't be overwritten mid-read.
+ * @param cursor In: first sequence number wanted (older ones are skipped).
+ *               Out: where the next call should continue (after the event
+ *               returned, or the next seq if nothing matched)
+ * @param typeMask CONSOLE_TYPE_MASK() bits of the types wanted
+ * @param out Copy of the event
+ * @return false if no event matched
+ */
+bool console_read(uint32_t* cursor, uint32_t typeMask, ConsoleRecord_t* out);
+
+/**
+ * Copy the first event in any of the given views at or after a cursor
+ * @param cursor As for console_read()
+ * @param views CONSOLE_VIEW_* bits
+ * @param typeMask CONSOLE_TYPE_MASK() bits of the types wanted
+ * @param out Copy of the event
+ * @return false if no event matched
+ */
+bool console_read_view(uint32_t* cursor, uint8_t views, uint32_t typeMask, ConsoleRecord_t* out);
+
+/**
+ * Get number of events in a view
+ * @param view One CONSOLE_VIEW_* bit
+ * @return Number of events
  */
-const char* console_get_event(int index);
+int console_get_view_count(uint8_t view);
 
 /**
- * Get event type at index
- * @param index Event index (0 = newest)
- * @return Event type
+ * Look up an event type by name (case-insensitive)
+ * @param name Type name as returned by console_get_type_name()
+ * @param type Output
+ * @return false if the name is unknown
  */
-ConsoleEventType_t console_get_event_type(int index);
+bool console_parse_type(const char* name, ConsoleEventType_t* type);
 
 /**
- * Clear all events from buffer
+ * Clear all events from the store (console and log)
  */
 void console_clear(void);
 
@@ -0,0 +1,158 @@
+/**
+ * crash_log.h
+ * Crash/Reset Forensics
+ *
+ * Keeps a small record of what the firmware was doing in RTC memory
+ * that survives a panic, watchdog or brownout reset:
+ * - Per-subsystem breadcrumb trail (last checkpoint hit in each subsystem)
+ * - Ring of the most recent console events
+ * - Uptime at last loop iteration
+ *
+ * On the next boot the record is tagged with esp_reset_reason(),
+ * copied to NVS if the reset was abnormal, and served at /api/v1/crashlog.
+ */
+
+#ifndef CRASH_LOG_H
+#define CRASH_LOG_H
+
+#include <Arduino.h>
+
+#define CRASH_LOG_TRAIL_LEN 16      // Breadcrumb history (power of two)
+#define CRASH_LOG_EVENTS 8          // Console events kept
+#define CRASH_LOG_EVENT_LEN 96      // Bytes per event (truncated)
+#define CRASH_LOG_MAGIC 0xC0FFEE42UL
+
+/**
+ * Subsystems that leave breadcrumbs
+ */
+typedef enum {
+    CRASH_SUB_LOOP = 0,
+    CRASH_SUB_WIFI,
+    CRASH_SUB_MQTT,
+    CRASH_SUB_WEB,
+    CRASH_SUB_DISPLAY,
+    CRASH_SUB_SENSORS,
+    CRASH_SUB_OUTPUTS,
+    CRASH_SUB_SAFETY,
+    CRASH_SUB_COUNT
+} CrashSubsystem_t;
+
+// Common checkpoints (subsystems may define their own from 16 up)
+#define CRASH_PT_ENTER 1
+#define CRASH_PT_EXIT  2
+#define CRASH_PT_HEARTBEAT_STALL 16   // + HeartbeatId_t (safety subsystem)
+
+/**
+ * RTC no-init record (survives warm resets, garbage after power-on)
+ */
+typedef struct {
+    uint32_t magic;                             // CRASH_LOG_MAGIC when valid
+    uint32_t uptimeMs;                          // millis() at last loop tick
+    uint8_t lastCrumb[CRASH_SUB_COUNT];         // Last checkpoint per subsystem
+    uint16_t trail[CRASH_LOG_TRAIL_LEN];        // (subsystem << 8) | checkpoint
+    uint8_t trailHead;                          // Next trail slot (wraps)
+    uint8_t eventHead;                          // Next event slot (wraps)
+    uint8_t eventCount;
+    char events[CRASH_LOG_EVENTS][CRASH_LOG_EVENT_LEN];
+} CrashRtcData_t;
+
+/**
+ * Record of a previous abnormal reset (as stored in NVS)
+ */
+typedef struct {
+    uint8_t resetReason;                        // esp_reset_reason_t
+    uint32_t uptimeMs;
+    uint8_t lastCrumb[CRASH_SUB_COUNT];
+    uint16_t trail[CRASH_LOG_TRAIL_LEN];        // Oldest first
+    uint8_t trailCount;
+    uint8_t eventCount;
+    char events[CRASH_LOG_EVENTS][CRASH_LOG_EVENT_LEN];  // Oldest first
+} CrashRecord_t;
+
+// Live RTC record - written directly by the breadcrumb macro
+extern CrashRtcData_t crash_rtc;
+
+/**
+ * Drop a breadcrumb (three stores, safe on the hot path)
+ * @param sub Subsystem
+ * @param point Checkpoint number
+ */
+static inline void crash_log_breadcrumb(CrashSubsystem_t sub, uint8_t point) {
+    crash_rtc.lastCrumb[sub] = point;
+    crash_rtc.trail[crash_rtc.trailHead & (CRASH_LOG_TRAIL_LEN - 1)] = ((uint16_t)sub << 8) | point;
+    crash_rtc.trailHead++;
+}
+
+#define CRASH_BREADCRUMB(sub, point) crash_log_breadcrumb(sub, point)
+
+/**
+ * Initialize crash log
+ * Captures reset reason, saves the previous RTC record to NVS if the
+ * reset was abnormal, then re-arms the RTC record for this boot.
+ * Call first thing in setup().
+ */
+void crash_log_init(void);
+
+/**
+ * Record loop uptime (call once per loop iteration)
+ */
+void crash_log_tick(void);
+
+/**
+ * Copy a console event into the RTC ring
+ * @param message Event text (truncated to CRASH_LOG_EVENT_LEN - 1)
+ */
+void crash_log_add_event(const char* message);
+
+/**
+ * Get reset reason for this boot
+ * @return esp_reset_reason_t value
+ */
+uint8_t crash_log_get_reset_reason(void);
+
+/**
+ * Get reset reason name
+ * @param reason esp_reset_reason_t value
+ * @return Name string (e.g., "task_wdt", "brownout")
+ */
+const char* crash_log_get_reset_reason_name(uint8_t reason);
+
+/**
+ * Check if a reset reason indicates a crash
+ * @param reason esp_reset_reason_t value
+ * @return true for panic, watchdog, brownout and unknown resets
+ */
+bool crash_log_is_abnormal(uint8_t reason);
+
+/**
+ * Check if a reset reason was a watchdog timeout
+ * @param reason esp_reset_reason_t value
+ * @return true for interrupt, task or other watchdog resets
+ */
+bool crash_log_is_watchdog(uint8_t reason);
+
+/**
+ * Get last stored crash record
+ * @return Pointer to record, or nullptr if none stored
+ */
+const CrashRecord_t* crash_log_get_last(void);
+
+/**
+ * Get number of abnormal resets recorded
+ * @return Crash count (persisted)
+ */
+uint16_t crash_log_get_count(void);
+
+/**
+ * Clear stored crash record and count
+ */
+void crash_log_clear(void);
+
+/**
+ * Get subsystem name
+ * @param sub Subsystem
+ * @return Short name string
+ */
+const char* crash_log_get_subsystem_name(CrashSubsystem_t sub);
+
+#endif // CRASH_LOG_H
@@ -0,0 +1,141 @@
+/**
+ * delta_patch.h
+ * Streaming Binary Delta Decoder
+ *
+ * Rebuilds a new firmware image from the running one plus a patch, as the
+ * patch arrives over the network. bsdiff-style control records, with the
+ * diff bytes zero-run coded instead of compressed so no dictionary or window
+ * is needed - RAM use is fixed at sizeof(DeltaPatch_t).
+ *
+ * Patch format (little endian, varints are LEB128):
+ *   header:  "TDP1" | u32 oldSize | u32 newSize
+ *   record:  varint diffLen | varint extraLen | varint zigzag(seek)
+ *            diff:  (varint zeroRun | varint litLen | litLen bytes)... covering diffLen
+ *                   new = old + byte (mod 256); zero runs copy old unchanged
+ *            extra: extraLen literal bytes
+ *            then oldPos += seek
+ *   Records repeat until newSize bytes have been produced.
+ *
+ * Patches are made by tools/delta_ota.py.
+ */
+
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DELTA_MAGIC "TDP1"
+#define DELTA_HEADER_SIZE 12
+#define DELTA_OUT_BUF_SIZE 512      // Rebuilt bytes batched per write callback
+#define DELTA_OLD_BUF_SIZE 256      // Read-ahead from the old image
+
+/**
+ * Read from the old (running) image
+ * @return false on read error
+ */
+typedef bool (*DeltaReadOldFn)(void* ctx, uint32_t offset, uint8_t* buf, size_t len);
+
+/**
+ * Receive rebuilt new-image bytes
+ * @return false to abort
+ */
+typedef bool (*DeltaWriteFn)(void* ctx, const uint8_t* data, size_t len);
+
+/**
+ * Decoder result
+ */
+typedef enum {
+    DELTA_OK = 0,
+    DELTA_ERR_MAGIC,           // Not a TDP1 patch
+    DELTA_ERR_FORMAT,          // Malformed record or varint
+    DELTA_ERR_RANGE,           // Record reads/writes outside the images
+    DELTA_ERR_READ,            // Old image read failed
+    DELTA_ERR_WRITE,           // Write callback refused data
+    DELTA_ERR_TRUNCATED        // Patch ended before newSize bytes
+} DeltaResult_t;
+
+/**
+ * Decoder state (caller allocates; no heap use inside)
+ */
+typedef struct {
+    DeltaReadOldFn readOld;
+    DeltaWriteFn write;
+    void* ctx;
+    uint32_t oldLimit;                   // Readable bytes of the old image
+
+    uint8_t state;
+    uint8_t header[DELTA_HEADER_SIZE];
+    uint8_t headerLen;
+    uint32_t oldSize;
+    uint32_t newSize;
+
+    uint32_t oldPos;
+    uint32_t newPos;
+    uint32_t diffRemain;
+    uint32_t extraRemain;
+    uint32_t runRemain;
+    int32_t seek;                        // Applied to oldPos after diff + extra
+
+    uint32_t varint;                     // Varint being decoded
+    uint8_t varintShift;
+
+    uint8_t oldBuf[DELTA_OLD_BUF_SIZE];
+    uint32_t oldBufStart;
+    uint16_t oldBufLen;
+
+    uint8_t outBuf[DELTA_OUT_BUF_SIZE];
+    uint16_t outLen;
+
+    DeltaResult_t error;
+} DeltaPatch_t;
+
+/**
+ * Start decoding a patch
+ * @param p Decoder state
+ * @param readOld Old image reader
+ * @param write New image sink
+ * @param ctx Passed to both callbacks
+ * @param oldLimit Size of the readable old image (e.g., running partition size)
+ */
+void delta_patch_init(DeltaPatch_t* p, DeltaReadOldFn readOld, DeltaWriteFn write,
+                      void* ctx, uint32_t oldLimit);
+
+/**
+ * Feed the next chunk of patch data
+ * @param p Decoder state
+ * @param data Patch bytes
+ * @param len Number of bytes
+ * @return DELTA_OK, or the first error (sticky)
+ */
+DeltaResult_t delta_patch_feed(DeltaPatch_t* p, const uint8_t* data, size_t len);
+
+/**
+ * Flush output and check the patch was complete
+ * @param p Decoder state
+ * @return DELTA_OK if exactly newSize bytes were produced
+ */
+DeltaResult_t delta_patch_finish(DeltaPatch_t* p);
+
+/**
+ * Get new image size from the header
+ * @param p Decoder state
+ * @return Size, or 0 before the header has been read
+ */
+uint32_t delta_patch_get_new_size(const DeltaPatch_t* p);
+
+/**
+ * Get bytes of the new image produced so far
+ * @param p Decoder state
+ * @return Byte count
+ */
+uint32_t delta_patch_get_progress(const DeltaPatch_t* p);
+
+/**
+ * Get result name
+ * @param result Result code
+ * @return Description string
+ */
+const char* delta_patch_get_error_name(DeltaResult_t result);
+
+#endif // DELTA_PATCH_H
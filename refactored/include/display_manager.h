@@ -44,7 +44,7 @@ struct DisplayOutputData {
     char name[32];             // Output name
     float currentTemp;         // Current temperature
     float targetTemp;          // Target temperature
-    char mode[16];             // Control mode (off, manual, pid, onoff, schedule)
+    char mode[16];             // Control mode (off, manual, pid, onoff, schedule, cascade)
     int power;                 // Power percentage (0-100)
     bool heating;              // Currently heating
     bool enabled;              // Output enabled
@@ -0,0 +1,106 @@
+/**
+ * energy_meter.h
+ * Per-Output Energy and Duty Accounting
+ *
+ * Integrates delivered power at every control tick into exact integer
+ * counters, so months of 100ms ticks add up without rounding drift:
+ * - energy in millijoules (rated watts x delivered fraction x ms, the
+ *   sub-millijoule remainder carried to the next tick)
+ * - ON time (any power applied) and full-power-equivalent time in ms
+ *
+ * Closed hour/day/month buckets are the difference of the lifetime
+ * counter at their start and end, so rounding to mWh happens once per
+ * bucket instead of once per tick.
+ *
+ * Pure C++ with no Arduino dependencies.
+ */
+
+#ifndef ENERGY_METER_H
+#define ENERGY_METER_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define ENERGY_HOURS 24             // Closed hourly buckets kept
+#define ENERGY_DAYS 31              // Closed daily buckets kept
+#define ENERGY_MONTHS 12            // Closed monthly buckets kept
+#define ENERGY_METER_VERSION 1      // Bump when the layout changes (NVS blob)
+
+/**
+ * Energy counters for one output
+ */
+typedef struct {
+    uint8_t version;
+
+    // Lifetime counters
+    uint64_t energyMj;              // Energy delivered (mJ)
+    uint64_t onMs;                  // Time with any power applied
+    uint64_t dutyMs;                // Full-power-equivalent time
+    uint32_t energyRem;             // Carried remainder (1/1000 mJ)
+    uint32_t dutyRem;               // Carried remainder (1/1000 ms)
+
+    // Open buckets: lifetime energy when they started, and which
+    // hour/day/month they are (0 = clock not set yet)
+    uint64_t hourStartMj;
+    uint64_t dayStartMj;
+    uint64_t monthStartMj;
+    int32_t hourStamp;              // Days since 1970 x 24 + hour
+    int32_t dayStamp;               // Days since 1970
+    int32_t monthStamp;             // Year x 12 + month
+
+    // Closed buckets, newest first (mWh)
+    uint32_t hourMwh[ENERGY_HOURS];
+    uint32_t dayMwh[ENERGY_DAYS];
+    uint32_t monthMwh[ENERGY_MONTHS];
+} EnergyMeter_t;
+
+/**
+ * Clear all counters and buckets
+ * @param meter Meter
+ */
+void energy_meter_reset(EnergyMeter_t* meter);
+
+/**
+ * Add one control tick
+ * @param meter Meter
+ * @param ratedWatts Load rating at full power (0 = unknown, only time is counted)
+ * @param fractionPermille Share of rated power delivered (0-1000)
+ * @param dtMs Milliseconds the fraction was applied for
+ */
+void energy_meter_add(EnergyMeter_t* meter, uint16_t ratedWatts, uint16_t fractionPermille,
+                      uint32_t dtMs);
+
+/**
+ * Close finished buckets
+ * Call with the current wall-clock time once it is known; buckets don't
+ * roll before that (energy until then lands in the first open bucket).
+ * @param meter Meter
+ * @param now Current local time
+ */
+void energy_meter_roll(EnergyMeter_t* meter, const struct tm* now);
+
+/**
+ * Energy in the open bucket
+ * @param meter Meter
+ * @param period 'h' (this hour), 'd' (today) or 'm' (this month)
+ * @return mWh
+ */
+uint32_t energy_meter_open_mwh(const EnergyMeter_t* meter, char period);
+
+/**
+ * Lifetime energy
+ * @param meter Meter
+ * @return kWh (for display - the counter itself is integer)
+ */
+double energy_meter_total_kwh(const EnergyMeter_t* meter);
+
+/**
+ * Delivered power fraction of a phase-angle dimmer
+ * RMS power into a resistive load when firing is delayed by
+ * (1 - powerPct/100) of each half cycle.
+ * @param powerPct Dimmer setting (0-100)
+ * @return Fraction of full power (0-1000 permille)
+ */
+uint16_t energy_dimmer_fraction_permille(int powerPct);
+
+#endif // ENERGY_METER_H
@@ -0,0 +1,192 @@
+/**
+ * event_bus.h
+ * Typed Publish/Subscribe Event Bus
+ *
+ * Modules publish state changes instead of being polled from main.cpp:
+ * - output_manager: output temp/target/mode/power/heating/fault/name
+ * - sensor_manager: sensor stopped or resumed reading
+ * - wifi_manager / mqtt_manager: connection changes
+ * - safety_manager: emergency stop, outputs held/released
+ *
+ * Topics are fixed at compile time. Each subscriber owns a fixed-size ring
+ * of events filled by event_bus_publish() and drained with event_bus_poll()
+ * from its own task, so nothing is allocated after boot. A full ring drops
+ * its oldest event (newer state supersedes it) and counts the drop.
+ *
+ * Safe to publish from the control task and loop().
+ */
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+
+#define EVENT_MAX_SUBSCRIBERS 4     // display, web, MQTT + one spare
+#define EVENT_QUEUE_DEPTH 8         // Events buffered per subscriber
+
+/**
+ * Topic IDs
+ */
+typedef enum {
+    EVENT_OUTPUT_STATE = 0,   // OutputEvent_t
+    EVENT_SENSOR_HEALTH,      // SensorEvent_t
+    EVENT_NETWORK_STATUS,     // NetworkEvent_t
+    EVENT_MQTT_STATUS,        // MqttEvent_t
+    EVENT_SAFETY,             // SafetyEvent_t
+    EVENT_TOPIC_COUNT
+} EventTopic_t;
+
+#define EVENT_MASK(topic) (1UL << (topic))
+
+/**
+ * OutputEvent_t.changed bits
+ */
+#define OUTPUT_CHG_TEMP     0x0001
+#define OUTPUT_CHG_TARGET   0x0002
+#define OUTPUT_CHG_MODE     0x0004
+#define OUTPUT_CHG_POWER    0x0008
+#define OUTPUT_CHG_HEATING  0x0010
+#define OUTPUT_CHG_ENABLED  0x0020
+#define OUTPUT_CHG_FAULT    0x0040
+#define OUTPUT_CHG_NAME     0x0080
+
+// Changes worth telling remote clients about right away
+#define OUTPUT_CHG_CONTROL (OUTPUT_CHG_TARGET | OUTPUT_CHG_MODE | OUTPUT_CHG_HEATING | \
+                            OUTPUT_CHG_ENABLED | OUTPUT_CHG_FAULT)
+
+/**
+ * Output state (full state plus what changed)
+ */
+typedef struct {
+    uint8_t index;            // Output index (0-2)
+    uint8_t mode;             // ControlMode_t
+    uint8_t fault;            // FaultState_t
+    uint8_t power;            // Current power %
+    bool heating;
+    bool enabled;
+    uint16_t changed;         // OUTPUT_CHG_* bits
+    float temp;
+    float target;
+    char name[32];
+} OutputEvent_t;
+
+/**
+ * Sensor health transition
+ */
+typedef struct {
+    uint8_t index;            // Sensor index
+    bool ok;                  // false = reads failing, true = recovered
+    float lastReading;        // Last valid reading
+    char address[17];
+} SensorEvent_t;
+
+/**
+ * WiFi status
+ */
+typedef struct {
+    bool connected;           // Station connected
+    bool apMode;              // Running own access point
+    char ssid[33];
+    char ip[16];
+} NetworkEvent_t;
+
+/**
+ * MQTT broker status
+ */
+typedef struct {
+    bool connected;
+} MqttEvent_t;
+
+/**
+ * Safety actions
+ */
+typedef enum {
+    SAFETY_EVENT_EMERGENCY_STOP = 0,
+    SAFETY_EVENT_OUTPUTS_HELD,      // Control/sensor stall forced outputs off
+    SAFETY_EVENT_OUTPUTS_RELEASED,
+    SAFETY_EVENT_SAFE_MODE_EXIT
+} SafetyEventKind_t;
+
+typedef struct {
+    uint8_t kind;             // SafetyEventKind_t
+    int8_t heartbeat;         // HeartbeatId_t that stalled, -1 if none
+} SafetyEvent_t;
+
+/**
+ * Event (tagged union - read the member matching topic)
+ */
+typedef struct {
+    uint8_t topic;            // EventTopic_t
+    uint32_t timestamp;       // millis() at publish
+    union {
+        OutputEvent_t output;
+        SensorEvent_t sensor;
+        NetworkEvent_t network;
+        MqttEvent_t mqtt;
+        SafetyEvent_t safety;
+    };
+} Event_t;
+
+/**
+ * Initialize event bus
+ * Call before any module publishes
+ */
+void event_bus_init(void);
+
+/**
+ * Register a subscriber
+ * @param topicMask EVENT_MASK() of each wanted topic, OR'd together
+ * @param name Short name for diagnostics (not copied)
+ * @return Subscriber ID, or -1 if all slots are taken
+ */
+int event_bus_subscribe(uint32_t topicMask, const char* name);
+
+/**
+ * Publish an event to every subscriber of its topic
+ * @param event Event with topic and matching payload set (timestamp is filled in)
+ * @return Number of subscribers that received it
+ */
+int event_bus_publish(Event_t* event);
+
+/**
+ * Take the oldest pending event for a subscriber
+ * @param subscriber Subscriber ID
+ * @param event Output event
+ * @return true if an event was returned
+ */
+bool event_bus_poll(int subscriber, Event_t* event);
+
+/**
+ * Get events dropped because a subscriber's ring was full
+ * @param subscriber Subscriber ID
+ * @return Drop count
+ */
+uint32_t event_bus_get_dropped(int subscriber);
+
+/**
+ * Get total events published
+ * @return Publish count
+ */
+uint32_t event_bus_get_published(void);
+
+/**
+ * Get subscriber count
+ * @return Number of registered subscribers
+ */
+int event_bus_get_subscriber_count(void);
+
+/**
+ * Get subscriber name
+ * @param subscriber Subscriber ID
+ * @return Name, or nullptr if invalid
+ */
+const char* event_bus_get_subscriber_name(int subscriber);
+
+/**
+ * Get topic name
+ * @param topic Topic ID
+ * @return Topic name string
+ */
+const char* event_bus_get_topic_name(EventTopic_t topic);
+
+#endif // EVENT_BUS_H
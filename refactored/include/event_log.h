@@ -0,0 +1,131 @@
+/**
+ * event_log.h
+ * Packed Event Store
+ *
+ * One byte ring holding the console events and the system log as
+ * variable-length records, instead of fixed 128-byte slots:
+ *
+ *   len    u8       Record size in bytes, header included; bit 7 marks packed
+ *   tag    u8       views << 4 | type
+ *   dt     varint   Seconds since the previous record (LEB128, usually 1 byte)
+ *   body   len - 2 - varint bytes: text without a terminator, or for a
+ *          packed record whatever the owner encoded (console.cpp stores a
+ *          format id and binary arguments)
+ *
+ * Timestamps are stored as deltas and formatted when read. A typical
+ * 30-40 character event costs ~35 bytes against 136 (console) or 128
+ * (log) before, a packed one 5-8 bytes, and an event wanted in both the
+ * console and the log is stored once.
+ *
+ * Records are numbered from boot (not reset by clear). Appending drops
+ * the oldest records until the new one fits. Readers walk from the oldest
+ * record or from where the previous read stopped (read hint), so a
+ * forward scan over the whole ring stays linear.
+ *
+ * Not locked: the owner (console.cpp) serializes access.
+ */
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define EVENT_LOG_MAX_TEXT 116        // Stored text, without the time prefix
+#define EVENT_LOG_MAX_LINE (EVENT_LOG_MAX_TEXT + 17)   // "[hhhhhhh:mm:ss] " + text + NUL (32-bit uptime: 1193046 h)
+#define EVENT_LOG_VIEWS 4             // View bits in the tag's high nibble
+#define EVENT_LOG_TYPES 16            // Types in the tag's low nibble
+#define EVENT_LOG_PACKED 0x80         // Length byte flag: body is not text
+
+/**
+ * Store state (buffer supplied by the owner)
+ */
+typedef struct {
+    uint8_t* buf;
+    uint32_t size;
+    uint32_t head;                    // Offset of the oldest record
+    uint32_t used;                    // Bytes in use
+    uint32_t firstSeq;                // Seq of the oldest record (== nextSeq when empty)
+    uint32_t nextSeq;                 // Records appended since init
+    uint32_t firstTime;               // Time of the oldest record
+    uint32_t lastTime;                // Time of the newest record
+    uint16_t count;
+    uint16_t viewCount[EVENT_LOG_VIEWS];
+    uint32_t hintSeq;                 // A record a previous read stopped at...
+    uint32_t hintOffset;              // ...its offset...
+    uint32_t hintTime;                // ...and time
+} EventLog_t;
+
+/**
+ * Copy of one record
+ */
+typedef struct {
+    uint32_t seq;
+    uint32_t timeSec;
+    uint8_t type;
+    uint8_t views;
+    bool packed;                      // text holds a packed body, not text
+    uint8_t length;                   // Bytes in text, without the terminator
+    char text[EVENT_LOG_MAX_TEXT + 1];
+} EventLogRecord_t;
+
+/**
+ * Initialize a store
+ * @param log Store
+ * @param buf Ring buffer
+ * @param size Buffer size in bytes
+ */
+void event_log_init(EventLog_t* log, uint8_t* buf, uint32_t size);
+
+/**
+ * Append a record, dropping the oldest ones until it fits
+ * @param log Store
+ * @param type Type (0..EVENT_LOG_TYPES-1)
+ * @param views View bits (1..(1 << EVENT_LOG_VIEWS)-1)
+ * @param timeSec Timestamp (non-decreasing; an earlier one is stored as the previous)
+ * @param text Message (truncated to EVENT_LOG_MAX_TEXT)
+ * @return Sequence number of the record
+ */
+uint32_t event_log_append(EventLog_t* log, uint8_t type, uint8_t views, uint32_t timeSec, const char* text);
+
+/**
+ * Append a packed record, dropping the oldest ones until it fits
+ * @param log Store
+ * @param type Type (0..EVENT_LOG_TYPES-1)
+ * @param views View bits (1..(1 << EVENT_LOG_VIEWS)-1)
+ * @param timeSec Timestamp, as for event_log_append()
+ * @param data Body, read back unchanged with packed set
+ * @param length Body size (truncated to EVENT_LOG_MAX_TEXT)
+ * @return Sequence number of the record
+ */
+uint32_t event_log_append_packed(EventLog_t* log, uint8_t type, uint8_t views, uint32_t timeSec,
+                                 const uint8_t* data, size_t length);
+
+/**
+ * Copy the first matching record at or after a cursor
+ * @param log Store
+ * @param cursor In: first sequence number wanted (older ones are skipped).
+ *               Out: where the next call should continue (after the record
+ *               returned, or nextSeq if nothing matched)
+ * @param views Record must be in one of these views
+ * @param typeMask Bit (1 << type) of each type wanted
+ * @param out Copy of the record
+ * @return false if no record matched
+ */
+bool event_log_read(EventLog_t* log, uint32_t* cursor, uint8_t views, uint32_t typeMask, EventLogRecord_t* out);
+
+/**
+ * Count records in a view
+ * @param log Store
+ * @param view One view bit
+ * @return Records held in that view
+ */
+int event_log_count(const EventLog_t* log, uint8_t view);
+
+/**
+ * Remove all records (sequence numbers carry on)
+ * @param log Store
+ */
+void event_log_clear(EventLog_t* log);
+
+#endif // EVENT_LOG_H
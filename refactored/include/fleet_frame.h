@@ -0,0 +1,161 @@
+/**
+ * fleet_frame.h
+ * Fleet Status Frame and Peer Table
+ *
+ * Every unit with fleet mode on multicasts one 54-byte frame with its
+ * output states every FLEET_TX_PERIOD_MS. Any unit (the /fleet page) or
+ * a Linux box (tools/fleet_aggregator.cpp) collects them into a peer
+ * table and serves a dashboard of the whole room.
+ *
+ * Frame (little-endian):
+ *   0  'T' 'F'          magic
+ *   2  version          FLEET_VERSION
+ *   3  outputCount      0..FLEET_OUTPUTS
+ *   4  nodeId   u32     low 32 bits of the MAC
+ *   8  seq      u16     +1 per frame (loss counting)
+ *  10  uptime   u32     seconds
+ *  14  name     16      device name, NUL-padded
+ *  30  outputs  8 each: temp i16 (0.1°C, INT16_MIN = none), target i16
+ *                       (0.1°C), humidity u8 (0.5%, 0xFF = none),
+ *                       power u8 (%), mode u8 (ControlMode_t), flags u8
+ */
+
+#ifndef FLEET_FRAME_H
+#define FLEET_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FLEET_GROUP "239.255.42.99"   // Site-local multicast group
+#define FLEET_PORT 42420
+#define FLEET_VERSION 1
+#define FLEET_OUTPUTS 3
+#define FLEET_NAME_LEN 16
+#define FLEET_FRAME_SIZE (30 + 8 * FLEET_OUTPUTS)
+#define FLEET_TX_PERIOD_MS 5000
+#define FLEET_PEER_TIMEOUT_MS 30000   // Peers silent this long are dropped
+
+// Output flags
+#define FLEET_OUT_ENABLED 0x01
+#define FLEET_OUT_HEATING 0x02
+#define FLEET_OUT_FAULT 0x04
+
+/**
+ * One output's state
+ */
+typedef struct {
+    float temp;               // °C, NAN if no valid reading
+    float target;             // °C
+    float humidity;           // %RH, NAN if the sensor has none
+    uint8_t power;            // %
+    uint8_t mode;             // ControlMode_t
+    uint8_t flags;            // FLEET_OUT_*
+} FleetOutput_t;
+
+/**
+ * Decoded status frame
+ */
+typedef struct {
+    uint32_t nodeId;
+    uint16_t seq;
+    uint32_t uptimeSec;
+    char name[FLEET_NAME_LEN + 1];
+    uint8_t outputCount;
+    FleetOutput_t outputs[FLEET_OUTPUTS];
+} FleetStatus_t;
+
+/**
+ * One known unit
+ */
+typedef struct {
+    bool used;
+    FleetStatus_t status;
+    uint32_t ip;              // IPv4 as received (network byte order)
+    uint32_t lastSeenMs;
+    uint32_t frames;
+    uint32_t lost;            // Frames missed (sequence gaps)
+} FleetPeer_t;
+
+/**
+ * Peer table (storage supplied by the caller)
+ */
+typedef struct {
+    FleetPeer_t* peers;
+    int capacity;
+    uint32_t framesIn;        // Valid frames
+    uint32_t bytesIn;         // Valid frame bytes
+    uint32_t rejected;        // Wrong magic/version/size
+    uint32_t full;            // New peers dropped (table full)
+} FleetTable_t;
+
+/**
+ * Encode a status frame
+ * @param status Status to send
+ * @param buf Output buffer
+ * @param len Buffer size
+ * @return Bytes written (FLEET_FRAME_SIZE), 0 if the buffer is too small
+ */
+size_t fleet_frame_encode(const FleetStatus_t* status, uint8_t* buf, size_t len);
+
+/**
+ * Decode a status frame
+ * @param buf Received bytes
+ * @param len Number of bytes
+ * @param status Output
+ * @return true if it is a valid frame of this version
+ */
+bool fleet_frame_decode(const uint8_t* buf, size_t len, FleetStatus_t* status);
+
+/**
+ * Initialize a peer table
+ * @param table Table
+ * @param storage Peer slots
+ * @param capacity Number of slots
+ */
+void fleet_table_init(FleetTable_t* table, FleetPeer_t* storage, int capacity);
+
+/**
+ * Decode a received frame and record it
+ * @param table Table
+ * @param buf Received bytes
+ * @param len Number of bytes
+ * @param ip Sender (network byte order)
+ * @param nowMs Current time
+ * @return Updated peer, nullptr if the frame was rejected or the table is full
+ */
+FleetPeer_t* fleet_table_receive(FleetTable_t* table, const uint8_t* buf, size_t len,
+                                 uint32_t ip, uint32_t nowMs);
+
+/**
+ * Drop peers not heard from in FLEET_PEER_TIMEOUT_MS
+ * @param table Table
+ * @param nowMs Current time
+ * @return Number of peers dropped
+ */
+int fleet_table_expire(FleetTable_t* table, uint32_t nowMs);
+
+/**
+ * Count live peers
+ * @param table Table
+ * @return Peers in use
+ */
+int fleet_table_count(const FleetTable_t* table);
+
+/**
+ * Format one peer as a GET /api/v1/fleet node object
+ * @param peer Peer
+ * @param nowMs Current time (for ageSec)
+ * @param self true for the unit serving the page
+ * @param buf Output buffer (768 bytes fits any peer)
+ * @param len Buffer size
+ * @return Length written, 0 if it did not fit
+ */
+size_t fleet_peer_json(const FleetPeer_t* peer, uint32_t nowMs, bool self, char* buf, size_t len);
+
+/**
+ * Dashboard script shared by the /fleet page and the Linux aggregator
+ * Renders GET /api/v1/fleet into the element with id 'fleet' every 5s.
+ */
+extern const char FLEET_DASHBOARD_JS[];
+
+#endif // FLEET_FRAME_H
@@ -0,0 +1,55 @@
+/**
+ * fleet_manager.h
+ * Fleet Status Multicast (UDP)
+ *
+ * Optional (Settings > Fleet, off by default). When on, the unit
+ * multicasts its output states to FLEET_GROUP:FLEET_PORT every
+ * FLEET_TX_PERIOD_MS and listens for the other units, so /fleet shows
+ * the whole room. Frame format and peer table: fleet_frame.h.
+ */
+
+#ifndef FLEET_MANAGER_H
+#define FLEET_MANAGER_H
+
+#include <Arduino.h>
+#include "fleet_frame.h"
+
+#define FLEET_MAX_PEERS 32          // Allocated only when fleet mode is on
+#define FLEET_RX_PER_TASK 8         // Frames handled per fleet_task() call
+
+/**
+ * Initialize (reads the enable flag; allocates the peer table when on)
+ */
+void fleet_init(void);
+
+/**
+ * Join the group once WiFi is up, receive frames, send ours when due
+ * Call from loop()
+ */
+void fleet_task(void);
+
+/**
+ * Check if fleet mode is on
+ * @return true if enabled in settings
+ */
+bool fleet_is_enabled(void);
+
+/**
+ * Build this unit's entry (what the next frame will carry)
+ * @param peer Output: own status, IP and counters
+ */
+void fleet_get_self(FleetPeer_t* peer);
+
+/**
+ * Peer table (nullptr when fleet mode is off)
+ * @return Table of the other units
+ */
+const FleetTable_t* fleet_get_table(void);
+
+/**
+ * Get number of frames sent
+ * @return Frames sent since boot
+ */
+uint32_t fleet_get_frames_sent(void);
+
+#endif // FLEET_MANAGER_H
@@ -0,0 +1,61 @@
+/**
+ * frame_codec.h
+ * Binary Frame Field Helpers
+ *
+ * Little-endian integers and the fixed-point fields shared by the fleet
+ * status frame, the compact telemetry frame and the history bulk transfer:
+ *
+ *   temperature  i16  0.1°C, FRAME_TEMP_NONE (INT16_MIN) = no reading
+ *   humidity     u8   0.5 %RH, FRAME_HUMIDITY_NONE (0xFF) = no reading
+ */
+
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <math.h>
+#include <stdint.h>
+
+#define FRAME_TEMP_NONE INT16_MIN
+#define FRAME_HUMIDITY_NONE 0xFF
+
+static inline void frame_put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void frame_put32(uint8_t* p, uint32_t v) {
+    frame_put16(p, (uint16_t)v);
+    frame_put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t frame_get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static inline uint32_t frame_get32(const uint8_t* p) {
+    return frame_get16(p) | (uint32_t)frame_get16(p + 2) << 16;
+}
+
+static inline int16_t frame_encode_temp(float c) {
+    if (isnan(c) || c < -3000.0f || c > 3000.0f) {
+        return FRAME_TEMP_NONE;
+    }
+    return (int16_t)lroundf(c * 10.0f);
+}
+
+static inline float frame_decode_temp(int16_t v) {
+    return v == FRAME_TEMP_NONE ? NAN : v / 10.0f;
+}
+
+static inline uint8_t frame_encode_humidity(float rh) {
+    if (isnan(rh) || rh < 0.0f || rh > 100.0f) {
+        return FRAME_HUMIDITY_NONE;
+    }
+    return (uint8_t)lroundf(rh * 2.0f);
+}
+
+static inline float frame_decode_humidity(uint8_t v) {
+    return v == FRAME_HUMIDITY_NONE ? NAN : v / 2.0f;
+}
+
+#endif // FRAME_CODEC_H
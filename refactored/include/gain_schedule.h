@@ -0,0 +1,86 @@
+/**
+ * gain_schedule.h
+ * PID Gain Scheduling and Ambient Feedforward
+ *
+ * Heat loss, and so the power an output needs, depends on how far the
+ * target sits above the room. The operating point ("load") is
+ *
+ *   load = target - ambient  (°C)
+ *
+ * and PID gains are interpolated from a small table of load breakpoints
+ * instead of being re-tuned live. A feedforward term supplies the steady
+ * state power up front so the integrator only has to trim:
+ *
+ *   ff = ffGain * load  (% power, never negative)
+ *
+ * Ambient comes from an optional room sensor, else the thermal model's
+ * zero-power equilibrium (see thermal_model.h).
+ */
+
+#ifndef GAIN_SCHEDULE_H
+#define GAIN_SCHEDULE_H
+
+#include <stdint.h>
+
+#define GAIN_SCHEDULE_POINTS 4        // Table breakpoints per output
+#define GAIN_SCHEDULE_FF_MAX 20.0f    // % power per °C of load
+#define GAIN_SCHEDULE_LOAD_MIN -20.0f // Breakpoint range (°C above ambient)
+#define GAIN_SCHEDULE_LOAD_MAX 60.0f
+
+/**
+ * Gains at one operating point
+ */
+typedef struct {
+    float load;               // target - ambient (°C)
+    float kp;
+    float ki;
+    float kd;
+} GainPoint_t;
+
+/**
+ * Gain table and feedforward
+ */
+typedef struct {
+    bool enabled;             // Use the table and feedforward (else fixed gains only)
+    uint8_t count;            // Breakpoints in use (0 = fixed gains, feedforward only)
+    GainPoint_t points[GAIN_SCHEDULE_POINTS];   // Ascending load
+    float ffGain;             // % per °C of load, 0 = no feedforward
+
+    // Precomputed by gain_schedule_prepare(): per-segment slopes
+    float slope[GAIN_SCHEDULE_POINTS - 1][3];
+} GainSchedule_t;
+
+/**
+ * Reset to "disabled, no feedforward"
+ * @param schedule Schedule
+ */
+void gain_schedule_init(GainSchedule_t* schedule);
+
+/**
+ * Validate, sort and precompute a table after its points change
+ * Clamps count, loads and negative gains, sorts by load, computes slopes.
+ * @param schedule Schedule
+ */
+void gain_schedule_prepare(GainSchedule_t* schedule);
+
+/**
+ * Interpolated gains at an operating point (clamped at the table ends)
+ * @param schedule Prepared schedule
+ * @param load target - ambient (°C)
+ * @param kp Output: proportional gain
+ * @param ki Output: integral gain
+ * @param kd Output: derivative gain
+ * @return false if the table is disabled or empty (outputs untouched)
+ */
+bool gain_schedule_lookup(const GainSchedule_t* schedule, float load,
+                          float* kp, float* ki, float* kd);
+
+/**
+ * Feedforward power for an operating point
+ * @param schedule Schedule
+ * @param load target - ambient (°C)
+ * @return Power % (0-100), 0 if the schedule is disabled
+ */
+float gain_schedule_feedforward(const GainSchedule_t* schedule, float load);
+
+#endif // GAIN_SCHEDULE_H
@@ -0,0 +1,168 @@
+/**
+ * heap_monitor.h
+ * Heap and Fragmentation Tracker
+ *
+ * Periodically samples the 8-bit capable heap:
+ * - Free bytes, largest free block, all-time minimum
+ * - Fragmentation % (how much of the free heap is unusable as one block)
+ * - Rolling trend with a leak slope estimate (bytes/hour)
+ * - Alert callback when the largest block drops below what OTA/TLS needs
+ *
+ * Debug builds (-D HEAP_TRACKING_ENABLED=1) can also tag call sites with
+ * HEAP_TRACK_SCOPE("name") to see which code paths leave heap behind, and
+ * count every malloc/calloc/realloc. Tracking builds must link with
+ * -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc (see [env:esp32dev-heapdebug]).
+ */
+
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+
+#ifndef HEAP_TRACKING_ENABLED
+#define HEAP_TRACKING_ENABLED 0
+#endif
+
+#define HEAP_SAMPLE_INTERVAL_MS 10000      // One trend point every 10s
+#define HEAP_TREND_POINTS 90               // 15 minutes of history
+#define HEAP_LOW_BLOCK_THRESHOLD 40960     // TLS handshake + OTA buffers need ~40KB contiguous
+#define HEAP_LOW_BLOCK_HYSTERESIS 4096     // Re-arm alert once recovered by this much
+#define HEAP_MAX_TRACK_SITES 16
+
+/**
+ * One heap sample
+ */
+typedef struct {
+    uint32_t uptimeSec;
+    uint32_t freeBytes;
+    uint32_t largestBlock;
+} HeapSample_t;
+
+/**
+ * Per-call-site tracking (debug builds)
+ */
+typedef struct {
+    const char* tag;        // Static string passed to HEAP_TRACK_SCOPE
+    uint32_t calls;
+    int32_t netBytes;       // Sum of (free before - free after); positive = retained
+    int32_t maxRetained;    // Worst single call
+} HeapTrackSite_t;
+
+/**
+ * Alert callback
+ * @param largestBlock Current largest free block (bytes)
+ * @param freeBytes Current free heap (bytes)
+ */
+typedef void (*HeapAlertCallback_t)(uint32_t largestBlock, uint32_t freeBytes);
+
+/**
+ * Initialize heap monitor and take the first sample
+ */
+void heap_monitor_init(void);
+
+/**
+ * Sample heap if interval elapsed (call from loop)
+ */
+void heap_monitor_task(void);
+
+/**
+ * Get most recent sample
+ * @return Pointer to latest sample
+ */
+const HeapSample_t* heap_monitor_get_latest(void);
+
+/**
+ * Get trend sample (oldest first)
+ * @param index Sample index (0 = oldest)
+ * @return Pointer to sample, or nullptr if invalid
+ */
+const HeapSample_t* heap_monitor_get_sample(int index);
+
+/**
+ * Get number of trend samples stored
+ * @return Sample count (0 to HEAP_TREND_POINTS)
+ */
+int heap_monitor_get_sample_count(void);
+
+/**
+ * Calculate fragmentation of a sample
+ * @param sample Sample
+ * @return 0-100 (0 = all free memory in one block)
+ */
+uint8_t heap_monitor_get_fragmentation(const HeapSample_t* sample);
+
+/**
+ * Estimate free-heap slope over the trend window (least squares)
+ * @return Bytes per hour (negative = heap shrinking)
+ */
+int32_t heap_monitor_get_trend_bytes_per_hour(void);
+
+/**
+ * Get lowest largest-block value seen since boot
+ * @return Bytes
+ */
+uint32_t heap_monitor_get_min_largest_block(void);
+
+/**
+ * Check if the low-block alert is currently raised
+ * @return true if largest block is below HEAP_LOW_BLOCK_THRESHOLD
+ */
+bool heap_monitor_is_low(void);
+
+/**
+ * Set callback fired when the largest block falls below the threshold
+ * @param callback Function to call (once per excursion)
+ */
+void heap_monitor_set_alert_callback(HeapAlertCallback_t callback);
+
+/**
+ * Get number of tracked call sites
+ * @return Site count (0 if tracking compiled out)
+ */
+int heap_monitor_get_site_count(void);
+
+/**
+ * Get tracked call site
+ * @param index Site index
+ * @return Pointer to site, or nullptr if invalid
+ */
+const HeapTrackSite_t* heap_monitor_get_site(int index);
+
+/**
+ * Get number of heap allocations since boot
+ * @return malloc/calloc/realloc calls (always 0 unless HEAP_TRACKING_ENABLED)
+ */
+uint32_t heap_monitor_get_alloc_count(void);
+
+/**
+ * Record one tracked scope (used by HEAP_TRACK_SCOPE)
+ * @param tag Static tag string
+ * @param freeBefore Free heap on entry
+ * @param freeAfter Free heap on exit
+ */
+void heap_monitor_record_site(const char* tag, uint32_t freeBefore, uint32_t freeAfter);
+
+#if HEAP_TRACKING_ENABLED
+
+// Measures free heap across the enclosing scope. Other tasks allocating
+// concurrently show up too, so read per-site numbers as trends.
+class HeapTrackScope {
+public:
+    explicit HeapTrackScope(const char* tag) : tag_(tag), before_(ESP.getFreeHeap()) {}
+    ~HeapTrackScope() { heap_monitor_record_site(tag_, before_, ESP.getFreeHeap()); }
+private:
+    const char* tag_;
+    uint32_t before_;
+};
+
+#define HEAP_TRACK_CONCAT_(a, b) a##b
+#define HEAP_TRACK_CONCAT(a, b) HEAP_TRACK_CONCAT_(a, b)
+#define HEAP_TRACK_SCOPE(tag) HeapTrackScope HEAP_TRACK_CONCAT(_heapTrack_, __LINE__)(tag)
+
+#else
+
+#define HEAP_TRACK_SCOPE(tag) do {} while (0)
+
+#endif // HEAP_TRACKING_ENABLED
+
+#endif // HEAP_MONITOR_H
@@ -0,0 +1,82 @@
+/**
+ * history_bulk.h
+ * Compact Binary History Transfer
+ *
+ * Wire format of GET /api/v1/history/bulk, for collectors that pull
+ * every unit's history incrementally instead of re-reading the JSON.
+ * Points carry sequence numbers (count of points recorded since boot),
+ * so a collector asks for "everything after the last seq I have"; the
+ * boot ID tells it when the numbering restarted.
+ *
+ * Response (little-endian):
+ *   0  'T' 'H'          magic
+ *   2  version          HISTORY_BULK_VERSION
+ *   3  flags            HISTORY_BULK_MORE: more points after this batch
+ *   4  bootId    u32    random per boot
+ *   8  firstSeq  u32    seq of the first point in this response
+ *  12  nextSeq   u32    seq the next point recorded will get
+ *  16  baseTime  u32    unix time of the first point
+ *  20  count     u16    points that follow
+ *  22  interval  u16    sample interval (s)
+ *  24  points:   dt u16 (s since the previous point; 0xFFFF = absolute
+ *                time u32 follows), temp i16 (0.1°C, INT16_MIN = none)
+ *
+ * A point is 4 bytes (8 when the clock jumps, e.g. at NTP sync) against
+ * ~45 bytes in /api/history JSON.
+ */
+
+#ifndef HISTORY_BULK_H
+#define HISTORY_BULK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HISTORY_BULK_VERSION 1
+#define HISTORY_BULK_HEADER_SIZE 24
+#define HISTORY_BULK_POINT_MAX 8        // Largest encoded point
+#define HISTORY_BULK_MORE 0x01          // Flag: response was cut at max
+
+/**
+ * Response header
+ */
+typedef struct {
+    uint8_t flags;
+    uint32_t bootId;
+    uint32_t firstSeq;
+    uint32_t nextSeq;
+    uint32_t baseTime;
+    uint16_t count;
+    uint16_t intervalSec;
+} HistoryBulkHeader_t;
+
+/**
+ * Encode the response header
+ * @param header Header
+ * @param buf Output (HISTORY_BULK_HEADER_SIZE bytes)
+ */
+void history_bulk_encode_header(const HistoryBulkHeader_t* header, uint8_t* buf);
+
+/**
+ * Encode one point
+ * @param prevTime Time of the previous point (baseTime before the first); updated
+ * @param timestamp Unix time of this point
+ * @param temperature °C, NAN if none
+ * @param buf Output (HISTORY_BULK_POINT_MAX bytes)
+ * @return Bytes written
+ */
+size_t history_bulk_encode_point(uint32_t* prevTime, uint32_t timestamp, float temperature, uint8_t* buf);
+
+/**
+ * Decode a response
+ * @param buf Response body
+ * @param len Body length
+ * @param header Output header
+ * @param times Output timestamps (header->count entries, may be nullptr to only read the header)
+ * @param temps Output temperatures
+ * @param max Capacity of times/temps
+ * @return Points decoded, -1 if the body is malformed or larger than max
+ */
+int history_bulk_decode(const uint8_t* buf, size_t len, HistoryBulkHeader_t* header,
+                        uint32_t* times, float* temps, int max);
+
+#endif // HISTORY_BULK_H
@@ -0,0 +1,101 @@
+/**
+ * humidity_control.h
+ * Relative Humidity Control (Foggers and Misters)
+ *
+ * Both methods switch the output fully on or off:
+ * - On/off: on below targetRh - hysteresisRh, off again at targetRh.
+ *   Once switched, the output holds its state for at least minOnSec /
+ *   minOffSec (pumps need time to prime, relays to rest).
+ * - Time-proportional: duty = (targetRh - rh) / bandRh, spread over
+ *   cycleSec cycles with the same minimum ON/OFF times.
+ *
+ * Waterlogging limits apply on top of either method and override the
+ * minimum ON time:
+ * - No single burst runs longer than maxOnSec; the output then rests for
+ *   at least minOffSec so the water can soak in.
+ * - A duty budget caps the long-run ON share at maxDutyPct. The budget
+ *   refills at maxDutyPct% of elapsed time, holds at most maxDutyPct% of
+ *   dutyWindowMin, and every second ON spends a second of it.
+ *
+ * Pure C++ with no Arduino dependencies.
+ */
+
+#ifndef HUMIDITY_CONTROL_H
+#define HUMIDITY_CONTROL_H
+
+#include <stdint.h>
+
+/**
+ * Control method
+ */
+typedef enum {
+    HUMIDITY_METHOD_ONOFF = 0,    // Hysteresis with minimum run/rest times
+    HUMIDITY_METHOD_TIME_PROP     // Proportional duty over fixed cycles
+} HumidityMethod_t;
+
+/**
+ * Humidity control configuration
+ */
+typedef struct {
+    float targetRh;           // %RH
+    HumidityMethod_t method;
+    float hysteresisRh;       // On/off: switch on this far below target
+    float bandRh;             // Time-prop: full duty this far below target
+    uint16_t cycleSec;        // Time-prop cycle length
+    uint16_t minOnSec;        // Shortest run once switched on
+    uint16_t minOffSec;       // Shortest rest once switched off (soak time)
+    uint16_t maxOnSec;        // Longest single burst, 0 = no limit
+    uint8_t maxDutyPct;       // Long-run ON share, 100 = no limit
+    uint16_t dutyWindowMin;   // Budget size: maxDutyPct of this many minutes
+} HumidityParams_t;
+
+/**
+ * Humidity control runtime state
+ */
+typedef struct {
+    bool on;                  // Output state
+    float stateSec;           // Seconds in the current on/off state
+    float cycleElapsed;       // Time-prop: seconds into the current cycle
+    float cycleOnSec;         // Time-prop: ON time planned for this cycle
+    float duty;               // Requested duty % (time-prop; 0/100 for on/off)
+    float budgetSec;          // ON seconds the duty budget still allows
+    bool limited;             // Wanted to run but a waterlogging limit held it off
+} HumidityState_t;
+
+/**
+ * Fill in default parameters (conservative mister limits)
+ * @param params Parameters to fill
+ */
+void humidity_default_params(HumidityParams_t* params);
+
+/**
+ * Clamp parameters to their valid ranges
+ * @param params Parameters
+ */
+void humidity_validate_params(HumidityParams_t* params);
+
+/**
+ * Reset state: output off, free to start, full duty budget
+ * @param params Configuration (budget size)
+ * @param state State
+ */
+void humidity_reset(const HumidityParams_t* params, HumidityState_t* state);
+
+/**
+ * Budget capacity in seconds of ON time
+ * @param params Configuration
+ * @return Seconds
+ */
+float humidity_budget_capacity(const HumidityParams_t* params);
+
+/**
+ * Advance the controller
+ * @param params Configuration
+ * @param state State
+ * @param rh Current relative humidity (%)
+ * @param dt Seconds since the previous call
+ * @return true if the output should be on
+ */
+bool humidity_update(const HumidityParams_t* params, HumidityState_t* state, float rh, float dt);
+
+#endif // HUMIDITY_CONTROL_H
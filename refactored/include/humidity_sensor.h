@@ -0,0 +1,76 @@
+/**
+ * humidity_sensor.h
+ * I2C Temperature/Humidity Sensor Drivers (SHT3x, BME280)
+ *
+ * Minimal drivers split into start and read so sensor_manager can trigger
+ * a measurement, go on with other work, and collect the result after
+ * humidity_sensor_conversion_ms() - the same way it handles the DS18B20
+ * conversion. Nothing here waits on the sensor.
+ *
+ * - SHT3x (0x44/0x45): single-shot, high repeatability, CRC checked
+ * - BME280 (0x76/0x77): forced mode, x1 oversampling, pressure skipped,
+ *   datasheet integer compensation
+ */
+
+#ifndef HUMIDITY_SENSOR_H
+#define HUMIDITY_SENSOR_H
+
+#include <Arduino.h>
+#include "sensor_manager.h"
+
+/**
+ * BME280 factory calibration (temperature and humidity only)
+ */
+typedef struct {
+    uint16_t T1;
+    int16_t T2;
+    int16_t T3;
+    uint8_t H1;
+    int16_t H2;
+    uint8_t H3;
+    int16_t H4;
+    int16_t H5;
+    int8_t H6;
+} Bme280Calib_t;
+
+/**
+ * One detected I2C sensor
+ */
+typedef struct {
+    SensorType_t type;
+    uint8_t address;          // 7-bit I2C address
+    Bme280Calib_t calib;      // BME280 only
+} HumiditySensor_t;
+
+/**
+ * Probe an address for a supported sensor
+ * @param address 7-bit I2C address (0x44, 0x45, 0x76 or 0x77)
+ * @param sensor Output: detected sensor (calibration loaded)
+ * @return true if a supported sensor answered
+ */
+bool humidity_sensor_probe(uint8_t address, HumiditySensor_t* sensor);
+
+/**
+ * Trigger one measurement (returns immediately)
+ * @param sensor Detected sensor
+ * @return true if the sensor accepted the command
+ */
+bool humidity_sensor_start(const HumiditySensor_t* sensor);
+
+/**
+ * Time from humidity_sensor_start() until the result is ready
+ * @param sensor Detected sensor
+ * @return Milliseconds
+ */
+uint16_t humidity_sensor_conversion_ms(const HumiditySensor_t* sensor);
+
+/**
+ * Read the measurement started by humidity_sensor_start()
+ * @param sensor Detected sensor
+ * @param temperature Output: °C
+ * @param humidity Output: %RH
+ * @return true if the read succeeded (and the CRC matched, SHT3x)
+ */
+bool humidity_sensor_read(const HumiditySensor_t* sensor, float* temperature, float* humidity);
+
+#endif // HUMIDITY_SENSOR_H
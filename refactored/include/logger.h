@@ -2,17 +2,30 @@
  * logger.h
  * System Logging Interface
  *
- * Centralized logging with timestamps and circular buffer
+ * The system log is a view of the console's event store (console.h):
+ * entries are stored once, packed, next to the console events, and an
+ * event meant for both is added with console_add_event_to().
+ *
+ * Entries carry the store's sequence numbers (shared with console
+ * events, so they are increasing but not consecutive), so
+ * /api/logs?since= returns only new ones.
  */
 
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <stdint.h>
+#include "event_log.h"
+
+#define LOGGER_MAX_LENGTH EVENT_LOG_MAX_LINE
+
 /**
- * Initialize logger with boot time
- * @param boot_time_ms Boot timestamp in milliseconds
+ * Copy of one entry
  */
-void logger_init(unsigned long boot_time_ms);
+typedef struct {
+    uint32_t seq;
+    char message[LOGGER_MAX_LENGTH];   // "[hh:mm:ss] text"
+} LogRecord_t;
 
 /**
  * Add entry to log
@@ -21,21 +34,29 @@ void logger_init(unsigned long boot_time_ms);
 void logger_add(const char* message);
 
 /**
- * Get log entry by index
- * @param index Entry index (0 = newest)
- * @return Log entry string, or nullptr if invalid index
+ * Get sequence number of the oldest entry still in the store
+ * @return Sequence number (equals the next seq when empty)
  */
-const char* logger_get_entry(int index);
+uint32_t logger_get_first_seq(void);
 
 /**
- * Get total number of log entries
- * @return Entry count
+ * Get sequence number the next entry will get (at the earliest)
+ * @return Events added since boot
  */
-int logger_get_count(void);
+uint32_t logger_get_next_seq(void);
 
 /**
- * Clear all log entries
+ * Copy the first entry at or after a sequence number
+ * @param seq First sequence number wanted (older ones are skipped)
+ * @param out Copy of the entry
+ * @return false if there is no such entry
  */
-void logger_clear(void);
+bool logger_read(uint32_t seq, LogRecord_t* out);
+
+/**
+ * Get total number of log entries
+ * @return Entry count
+ */
+int logger_get_count(void);
 
 #endif // LOGGER_H
@@ -0,0 +1,137 @@
+/**
+ * loop_profiler.h
+ * Main-Loop Subsystem Profiler
+ *
+ * Lightweight timing instrumentation for the main loop:
+ * - Cycle-counter timestamps around each subsystem call
+ * - Log2-bucketed latency histograms (min/p50/p99/max)
+ * - Call counts and accumulated time per subsystem
+ *
+ * Compile out entirely with -D LOOP_PROFILER_ENABLED=0
+ */
+
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+
+#ifndef LOOP_PROFILER_ENABLED
+#define LOOP_PROFILER_ENABLED 1
+#endif
+
+#define PROFILER_BUCKETS 32    // One bucket per power of two CPU cycles
+
+/**
+ * Profiled sections (one histogram each)
+ */
+typedef enum {
+    PROF_LOOP_TOTAL = 0,    // Whole loop() iteration
+    PROF_WIFI,              // wifi_task()
+    PROF_MQTT,              // mqtt_task()
+    PROF_WEBSERVER,         // webserver_task()
+    PROF_DISPLAY,           // display_task()
+    PROF_SENSORS,           // readSensors()
+    PROF_OUTPUTS,           // updateOutputs()
+    PROF_MQTT_PUBLISH,      // MQTT status publish block
+    PROF_SECTION_COUNT
+} ProfilerSection_t;
+
+/**
+ * Per-section statistics
+ */
+typedef struct {
+    uint32_t count;                      // Number of recorded calls
+    uint32_t minCycles;                  // Fastest call
+    uint32_t maxCycles;                  // Slowest call
+    uint64_t totalCycles;                // Sum of all calls
+    uint32_t buckets[PROFILER_BUCKETS];  // buckets[n] = calls taking [2^n, 2^(n+1)) cycles
+} ProfilerStats_t;
+
+#if LOOP_PROFILER_ENABLED
+
+/**
+ * Read the CPU cycle counter
+ * @return Current cycle count (wraps every ~17s at 240MHz)
+ */
+static inline uint32_t profiler_cycles(void) {
+    return ESP.getCycleCount();
+}
+
+// Bracket a subsystem call. BEGIN declares a local, so both must be in the same scope.
+#define PROFILE_BEGIN(section) const uint32_t _profStart_##section = profiler_cycles()
+#define PROFILE_END(section) profiler_record(section, profiler_cycles() - _profStart_##section)
+
+#else
+
+#define PROFILE_BEGIN(section) do {} while (0)
+#define PROFILE_END(section) do {} while (0)
+
+#endif // LOOP_PROFILER_ENABLED
+
+/**
+ * Record one timed call
+ * @param section Section being timed
+ * @param cycles Elapsed CPU cycles
+ */
+void profiler_record(ProfilerSection_t section, uint32_t cycles);
+
+/**
+ * Clear all histograms and counters
+ */
+void profiler_reset(void);
+
+/**
+ * Get statistics for a section
+ * @param section Section to query
+ * @return Pointer to stats, or nullptr if invalid (or profiler compiled out)
+ */
+const ProfilerStats_t* profiler_get_stats(ProfilerSection_t section);
+
+/**
+ * Get section name
+ * @param section Section
+ * @return Short name string (e.g., "wifi")
+ */
+const char* profiler_get_section_name(ProfilerSection_t section);
+
+/**
+ * Estimate a latency percentile from the histogram
+ * Returns the upper edge of the bucket holding the percentile, clamped to max
+ * @param section Section to query
+ * @param percentile Percentile (1-100)
+ * @return Latency in microseconds, or 0 if no samples
+ */
+uint32_t profiler_get_percentile_us(ProfilerSection_t section, uint8_t percentile);
+
+/**
+ * Convert CPU cycles to microseconds
+ * @param cycles Cycle count
+ * @return Microseconds
+ */
+uint32_t profiler_cycles_to_us(uint64_t cycles);
+
+/**
+ * Convert CPU cycles to microseconds without truncating
+ * @param cycles Cycle count (e.g. a section's total, past 2^32 us after ~71 min)
+ * @return Microseconds
+ */
+uint64_t profiler_cycles_to_us64(uint64_t cycles);
+
+/**
+ * Get time since last reset
+ * @return Milliseconds covered by the current statistics
+ */
+unsigned long profiler_get_window_ms(void);
+
+/**
+ * Write a one-line summary per section to the console
+ */
+void profiler_log_summary(void);
+
+/**
+ * Check if profiler is compiled in
+ * @return true if LOOP_PROFILER_ENABLED
+ */
+bool profiler_is_enabled(void);
+
+#endif // LOOP_PROFILER_H
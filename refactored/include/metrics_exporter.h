@@ -0,0 +1,28 @@
+/**
+ * metrics_exporter.h
+ * Prometheus Metrics Exposition
+ *
+ * Renders GET /metrics in the Prometheus text format (0.0.4):
+ * per-output and per-sensor gauges, network and heap state, error and
+ * connection counters, and the loop profiler's histograms.
+ *
+ * Metric names, types and help text live in one constant table; each
+ * sample is formatted into a small stack buffer and written straight to
+ * the response, so a scrape builds no JSON document or String.
+ */
+
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <Arduino.h>
+
+#define METRICS_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+/**
+ * Write every metric family
+ * @param out Response stream
+ * @param version Firmware version (thermostat_build_info label)
+ */
+void metrics_exporter_write(Print& out, const char* version);
+
+#endif // METRICS_EXPORTER_H
@@ -7,6 +7,7 @@
  * - Home Assistant MQTT auto-discovery
  * - Topic subscription and message callbacks
  * - Status publishing (temperature, state, mode)
+ * - Compact binary telemetry for metered links (telemetry_frame.h)
  */
 
 #ifndef MQTT_MANAGER_H
@@ -73,6 +74,24 @@ bool mqtt_is_connected(void);
  */
 MQTTState_t mqtt_get_state(void);
 
+/**
+ * Get number of successful broker connections since boot
+ * @return Connections (reconnects = connections - 1)
+ */
+uint32_t mqtt_get_connect_count(void);
+
+/**
+ * Get number of failed connection attempts since boot
+ * @return Failed attempts
+ */
+uint32_t mqtt_get_connect_failures(void);
+
+/**
+ * Check if compact telemetry is on (settings: mqtt_compact, read at init)
+ * @return true if status goes out as one binary frame on {base}/telemetry
+ */
+bool mqtt_is_compact(void);
+
 /**
  * Publish temperature value
  * @param temperature Current temperature in °C
@@ -121,12 +140,20 @@ void mqtt_publish_status_extended(float temperature, float setpoint,
  * Publish all outputs status with system info (Multi-Output)
  * Publishes temperature, setpoint, state, mode, and power for all 3 outputs
  * Topics: baseTopic/output1/..., baseTopic/output2/..., baseTopic/output3/...
+ * In compact mode: a single binary frame on baseTopic/telemetry
  * @param wifiRssi WiFi signal strength (dBm)
  * @param freeHeap Free heap memory (bytes)
  * @param uptimeSeconds System uptime (seconds)
  */
 void mqtt_publish_all_outputs(int wifiRssi, uint32_t freeHeap, unsigned long uptimeSeconds);
 
+/**
+ * Publish low-heap alert to {base}/alert
+ * @param largestBlock Largest free heap block (bytes)
+ * @param freeHeap Total free heap (bytes)
+ */
+void mqtt_publish_heap_alert(uint32_t largestBlock, uint32_t freeHeap);
+
 /**
  * Send Home Assistant auto-discovery messages
  * Creates climate entity and temperature sensor
@@ -0,0 +1,239 @@
+/**
+ * ota_manager.h
+ * A/B Firmware Update with Verification and Rollback
+ *
+ * Writes new firmware to the inactive OTA slot while hashing it:
+ * - SHA-256 computed on the fly and checked against the release manifest
+ *   (or a digest supplied with a manual upload) before the slot is activated
+ * - New image boots in "pending verify" state; it is only confirmed once
+ *   safety_manager_mark_stable() runs on a healthy boot
+ * - If the stable mark is not reached (crash, watchdog, stall, timeout) the
+ *   bootloader falls back to the previous slot
+ *
+ * Release manifest (firmware.json, published next to firmware.bin):
+ *   {"version":"2.4.0","file":"firmware.bin","size":1234567,"sha256":"<64 hex>",
+ *    "deltas":[{"from":"2.3.0","file":"firmware-from-2.3.0.tdp","size":48213}]}
+ *
+ * When a delta from the running version is listed it is applied against the
+ * running slot (see delta_patch.h); any failure falls back to the full image.
+ * The digest always covers the rebuilt image. tools/delta_ota.py writes both.
+ */
+
+#ifndef OTA_MANAGER_H
+#define OTA_MANAGER_H
+
+#include <Arduino.h>
+
+#define OTA_SHA256_LEN 32
+#define OTA_VERIFY_TIMEOUT_MS 180000UL   // Pending image must be confirmed within 3 min
+#define OTA_CHUNK_SIZE 1024              // Download buffer (from the scratch pool)
+#define OTA_MANIFEST_FILE "firmware.json"
+
+/**
+ * Update session state
+ */
+typedef enum {
+    OTA_STATE_IDLE = 0,
+    OTA_STATE_WRITING,         // Image being streamed into the inactive slot
+    OTA_STATE_READY,           // Verified and activated - reboot to run it
+    OTA_STATE_FAILED           // Last attempt failed (see OtaError_t)
+} OtaState_t;
+
+/**
+ * Failure reasons
+ */
+typedef enum {
+    OTA_ERR_NONE = 0,
+    OTA_ERR_BUSY,              // Another update already in progress
+    OTA_ERR_PENDING,           // Running image not confirmed yet (other slot is the fallback)
+    OTA_ERR_BEGIN,             // Could not open the inactive slot
+    OTA_ERR_WRITE,             // Flash write failed
+    OTA_ERR_SIZE,              // Image size differs from the manifest
+    OTA_ERR_HASH,              // SHA-256 mismatch
+    OTA_ERR_END,               // Image validation / slot switch failed
+    OTA_ERR_MANIFEST,          // Manifest missing or malformed
+    OTA_ERR_DOWNLOAD,          // HTTP error or connection dropped
+    OTA_ERR_PATCH              // Delta patch malformed or not for this image
+} OtaError_t;
+
+/**
+ * Parsed release manifest
+ */
+typedef struct {
+    char version[16];
+    char file[48];
+    uint32_t size;                      // 0 = unknown
+    uint8_t sha256[OTA_SHA256_LEN];
+    char deltaFile[48];                 // Patch from the running version ("" = none)
+    uint32_t deltaSize;
+} OtaManifest_t;
+
+/**
+ * Initialize OTA manager
+ * Detects a pending-verify image and a rollback from the previous boot.
+ * Call after safety_manager_init().
+ */
+void ota_manager_init(void);
+
+/**
+ * Periodic check (call from loop)
+ * Confirms a pending image once the boot is stable and control is
+ * healthy (not in safe mode, outputs not held off); rolls it back if that
+ * has not happened by OTA_VERIFY_TIMEOUT_MS.
+ */
+void ota_manager_task(void);
+
+/**
+ * Start streaming an image into the inactive slot
+ * @param size Image size in bytes (0 if unknown)
+ * @param expectedSha256 Expected digest, or nullptr to skip the check
+ * @return true if the slot was opened
+ */
+bool ota_manager_begin(size_t size, const uint8_t* expectedSha256);
+
+/**
+ * Hash and write the next chunk
+ * @param data Chunk data
+ * @param len Chunk length
+ * @return true on success (session is aborted on failure)
+ */
+bool ota_manager_write(const uint8_t* data, size_t len);
+
+/**
+ * Finish the session: verify size and hash, then activate the slot
+ * @return true if the new image will boot on next restart
+ */
+bool ota_manager_end(void);
+
+/**
+ * Abandon the current session (inactive slot is left unused)
+ */
+void ota_manager_abort(void);
+
+/**
+ * Download the latest GitHub release manifest and firmware and install it
+ * Blocks until the image is written. Does not reboot.
+ * @return true if the image is verified and ready
+ */
+bool ota_manager_install_release(void);
+
+/**
+ * Confirm the running image (called from safety_manager_mark_stable)
+ * Cancels the bootloader rollback if the image was pending verify.
+ */
+void ota_manager_mark_valid(void);
+
+/**
+ * Reject the running image and reboot into the previous slot
+ * No-op unless the running image is pending verify.
+ */
+void ota_manager_rollback(void);
+
+/**
+ * Parse a release manifest
+ * @param json Manifest text
+ * @param runningVersion Version to pick a delta for (nullptr = full image only)
+ * @param out Parsed manifest
+ * @return true if version, file and a valid sha256 are present
+ */
+bool ota_manager_parse_manifest(const char* json, const char* runningVersion, OtaManifest_t* out);
+
+/**
+ * Parse a 64-character hex SHA-256 digest
+ * @param hex Digest text (case-insensitive)
+ * @param out Binary digest
+ * @return true if the text is exactly 64 hex digits
+ */
+bool ota_manager_parse_sha256(const char* hex, uint8_t out[OTA_SHA256_LEN]);
+
+/**
+ * Format a digest as lowercase hex
+ * @param digest Binary digest
+ * @param out Output buffer (at least 65 bytes)
+ */
+void ota_manager_format_sha256(const uint8_t digest[OTA_SHA256_LEN], char* out);
+
+/**
+ * Get session state
+ * @return Current state
+ */
+OtaState_t ota_manager_get_state(void);
+
+/**
+ * Get last error
+ * @return Error code (OTA_ERR_NONE if the last session succeeded)
+ */
+OtaError_t ota_manager_get_error(void);
+
+/**
+ * Get state name
+ * @param state State
+ * @return Name string
+ */
+const char* ota_manager_get_state_name(OtaState_t state);
+
+/**
+ * Get error description
+ * @param error Error code
+ * @return Description string
+ */
+const char* ota_manager_get_error_name(OtaError_t error);
+
+/**
+ * Get bytes written in the current/last session
+ * @return Byte count
+ */
+uint32_t ota_manager_get_progress(void);
+
+/**
+ * Get bytes downloaded by the last GitHub update
+ * @return Byte count (patch size for delta updates)
+ */
+uint32_t ota_manager_get_download_bytes(void);
+
+/**
+ * Check if the last GitHub update used a delta patch
+ * @return true if delta
+ */
+bool ota_manager_last_was_delta(void);
+
+/**
+ * Get digest of the last completed image
+ * @return Pointer to 32-byte digest, or nullptr if none
+ */
+const uint8_t* ota_manager_get_last_sha256(void);
+
+/**
+ * Check if the latest image was installed without a digest to check
+ * Manual uploads may omit the SHA-256; such an image is only checked by
+ * the bootloader's own image validation. Refers to the image written
+ * this boot, else to the running one (persisted).
+ * @return true if unverified
+ */
+bool ota_manager_image_unverified(void);
+
+/**
+ * Check if the running image is waiting to be confirmed
+ * @return true if pending verify
+ */
+bool ota_manager_is_pending_verify(void);
+
+/**
+ * Check if the previous update was rolled back
+ * @return true if this boot is running the old image after a failed update
+ */
+bool ota_manager_was_rolled_back(void);
+
+/**
+ * Get number of updates that were rolled back
+ * @return Rollback count (persisted)
+ */
+uint16_t ota_manager_get_rollback_count(void);
+
+/**
+ * Get label of the running partition
+ * @return Partition label (e.g., "app0")
+ */
+const char* ota_manager_get_running_partition(void);
+
+#endif // OTA_MANAGER_H
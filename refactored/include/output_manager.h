@@ -6,15 +6,26 @@
  * - Output 1: Lights (AC dimmer only)
  * - Output 2: Heat devices (SSR only)
  * - Output 3: Heat devices (SSR only)
+ *
+ * Readers (web, MQTT, display) never see the live config. They pin a
+ * published snapshot with OutputSnapshot; every change made through the
+ * setters or the control loop publishes a new consistent copy.
  */
 
 #ifndef OUTPUT_MANAGER_H
 #define OUTPUT_MANAGER_H
 
 #include <Arduino.h>
+#include "cascade_control.h"
+#include "energy_meter.h"
+#include "gain_schedule.h"
+#include "humidity_control.h"
+#include "pid_control.h"
+#include "thermal_model.h"
 
 #define MAX_OUTPUTS 3
 #define MAX_SCHEDULE_SLOTS 8
+#define OUTPUT_SNAPSHOT_SLOTS 3   // Published + one being written + one pinned by a slow reader
 
 /**
  * Sensor health states
@@ -76,7 +87,9 @@ typedef enum {
     CONTROL_MODE_PID,         // PID temperature control
     CONTROL_MODE_ONOFF,       // Simple thermostat (on/off)
     CONTROL_MODE_SCHEDULE,    // Schedule-based control
-    CONTROL_MODE_TIME_PROP    // Time-proportional control (PID with timed cycles)
+    CONTROL_MODE_TIME_PROP,   // Time-proportional control (PID with timed cycles)
+    CONTROL_MODE_CASCADE,     // Air PID sets a surface setpoint for a surface PID
+    CONTROL_MODE_HUMIDITY     // Relative humidity (fogger/mister), on/off or time-prop
 } ControlMode_t;
 
 /**
@@ -112,10 +125,18 @@ typedef struct {
     float pidKp;
     float pidKi;
     float pidKd;
-    float pidIntegral;
-    float pidLastError;
+    float pidSetpointWeight;          // Share of a target step P reacts to (0-1, default 1)
+
+    // PID runtime state (integral, last input, active gains, feedforward, load)
+    PidControlState_t pidState;
     unsigned long pidLastTime;
 
+    // Gain scheduling and ambient feedforward (PID and time-prop modes).
+    // Ambient comes from ambientSensorAddress, else the thermal model.
+    char ambientSensorAddress[17];    // DS18B20 ROM address in the room ("" = none)
+    float ambientTemp;
+    GainSchedule_t gainSchedule;
+
     // Time-proportional control parameters
     uint8_t timePropCycleSec;         // Cycle period in seconds (5-120, default 30)
     uint8_t timePropMinOnSec;         // Minimum ON time in seconds (default 1)
@@ -126,8 +147,39 @@ typedef struct {
     bool timePropCurrentState;        // Current ON/OFF state within cycle
     float timePropDutyCycle;          // Current calculated duty cycle (0-100%)
 
+    // Cascade control: outer loop on sensorAddress (air), inner loop on
+    // surfaceSensorAddress (heater surface). SSR outputs apply the result
+    // with the time-proportional cycle settings above.
+    char surfaceSensorAddress[17];    // DS18B20 ROM address on the heater surface
+    float surfaceTemp;
+    CascadeParams_t cascade;
+
+    // Cascade runtime state
+    CascadeState_t cascadeState;
+    unsigned long cascadeLastTime;
+
+    // Humidity control on sensorAddress (SHT3x/BME280); the temperature
+    // limits keep working from the same sensor
+    float currentHumidity;            // %RH, NAN if the sensor has no humidity
+    HumidityParams_t humidity;
+
+    // Humidity runtime state
+    HumidityState_t humidityState;
+    unsigned long humidityLastTime;
+
     // Schedule
     ScheduleSlot_t schedule[MAX_SCHEDULE_SLOTS];
+    bool schedulePredictive;          // Preheat so each slot's target is met at its start
+    float scheduleSlotTarget;         // Active slot's own target (targetTemp may be ramped)
+
+    // Learned heat-up/cool-down model (fed in every mode while the sensor is valid)
+    ThermalModel_t thermalModel;
+
+    // Energy accounting (the counters live outside the snapshot, see
+    // output_manager_get_energy)
+    uint16_t ratedWatts;              // Load rating at full power, 0 = unknown
+    float powerW;                     // Power being delivered now (estimate)
+    float energyKwh;                  // Lifetime energy (display copy)
 
     // Safety settings (per-output)
     float maxTempC;              // Hard cutoff max (default 40.0)
@@ -153,11 +205,55 @@ typedef struct {
 void output_manager_init(void);
 
 /**
- * Get output configuration
+ * Pin the latest published snapshot of an output (lock-free)
+ * The snapshot never changes while pinned. Prefer OutputSnapshot.
+ * @param outputIndex Output index (0-2)
+ * @return Read-only snapshot, or nullptr if invalid
+ */
+const OutputConfig_t* output_manager_snapshot_acquire(int outputIndex);
+
+/**
+ * Unpin a snapshot from output_manager_snapshot_acquire
+ * @param outputIndex Output index (0-2)
+ * @param snapshot Snapshot pointer
+ */
+void output_manager_snapshot_release(int outputIndex, const OutputConfig_t* snapshot);
+
+/**
+ * Get snapshot version (increments on every publish)
  * @param outputIndex Output index (0-2)
- * @return Pointer to output config, or nullptr if invalid
+ * @return Version counter
+ */
+uint32_t output_manager_get_version(int outputIndex);
+
+/**
+ * Get number of publishes skipped because every spare slot was pinned
+ * @return Skip count
  */
-OutputConfig_t* output_manager_get_output(int outputIndex);
+uint32_t output_manager_get_publish_skips(void);
+
+/**
+ * Scoped read-only view of an output
+ * Pins the snapshot for the lifetime of the object.
+ */
+class OutputSnapshot {
+public:
+    explicit OutputSnapshot(int outputIndex)
+        : index(outputIndex), snap(output_manager_snapshot_acquire(outputIndex)) {}
+    ~OutputSnapshot() { output_manager_snapshot_release(index, snap); }
+
+    const OutputConfig_t* operator->() const { return snap; }
+    const OutputConfig_t& operator*() const { return *snap; }
+    const OutputConfig_t* get() const { return snap; }
+    explicit operator bool() const { return snap != nullptr; }
+
+private:
+    OutputSnapshot(const OutputSnapshot&) = delete;
+    OutputSnapshot& operator=(const OutputSnapshot&) = delete;
+
+    int index;
+    const OutputConfig_t* snap;
+};
 
 /**
  * Update output control loop
@@ -165,6 +261,20 @@ OutputConfig_t* output_manager_get_output(int outputIndex);
  */
 void output_manager_update(void);
 
+/**
+ * Force all outputs off regardless of mode
+ * Used by the safety manager when control or sensor heartbeats stall.
+ * Outputs stay off until the hold is released.
+ * @param hold true to force off, false to resume normal control
+ */
+void output_manager_set_safe_hold(bool hold);
+
+/**
+ * Check if outputs are held off by the safety manager
+ * @return true if safe hold active
+ */
+bool output_manager_is_safe_hold(void);
+
 /**
  * Set output enable/disable
  * @param outputIndex Output index (0-2)
@@ -225,6 +335,7 @@ void output_manager_set_sensor(int outputIndex, const char* sensorAddress);
 
 /**
  * Set PID parameters
+ * Bumpless: the output carries on from its current power.
  * @param outputIndex Output index (0-2)
  * @param kp Proportional gain
  * @param ki Integral gain
@@ -232,6 +343,15 @@ void output_manager_set_sensor(int outputIndex, const char* sensorAddress);
  */
 void output_manager_set_pid_params(int outputIndex, float kp, float ki, float kd);
 
+/**
+ * Set PID setpoint weight
+ * Below 1 the proportional term reacts less to target changes (less
+ * overshoot after a step) while disturbance rejection is unchanged.
+ * @param outputIndex Output index (0-2)
+ * @param weight 0-1 (clamped)
+ */
+void output_manager_set_setpoint_weight(int outputIndex, float weight);
+
 /**
  * Set time-proportional control parameters
  * @param outputIndex Output index (0-2)
@@ -242,6 +362,45 @@ void output_manager_set_pid_params(int outputIndex, float kp, float ki, float kd
 void output_manager_set_time_prop_params(int outputIndex, uint8_t cycleSec,
                                           uint8_t minOnSec, uint8_t minOffSec);
 
+/**
+ * Assign surface sensor (inner loop of cascade mode)
+ * @param outputIndex Output index (0-2)
+ * @param sensorAddress Sensor ROM address string ("" to unassign)
+ */
+void output_manager_set_surface_sensor(int outputIndex, const char* sensorAddress);
+
+/**
+ * Set cascade control parameters
+ * Out-of-range values are clamped; both loops restart from zero.
+ * @param outputIndex Output index (0-2)
+ * @param params Outer/inner gains and clamps, surface ceiling, loop periods
+ */
+void output_manager_set_cascade_params(int outputIndex, const CascadeParams_t* params);
+
+/**
+ * Set humidity control parameters
+ * Out-of-range values are clamped; the controller restarts off with a
+ * full duty budget.
+ * @param outputIndex Output index (0-2)
+ * @param params Target, method and waterlogging limits
+ */
+void output_manager_set_humidity_params(int outputIndex, const HumidityParams_t* params);
+
+/**
+ * Assign room ambient sensor (gain schedule and feedforward)
+ * @param outputIndex Output index (0-2)
+ * @param sensorAddress Sensor ROM address string ("" to use the thermal model estimate)
+ */
+void output_manager_set_ambient_sensor(int outputIndex, const char* sensorAddress);
+
+/**
+ * Set gain schedule and feedforward
+ * Gains and ffGain are clamped and points sorted; the integral restarts.
+ * @param outputIndex Output index (0-2)
+ * @param schedule Table, enable flag and ffGain
+ */
+void output_manager_set_gain_schedule(int outputIndex, const GainSchedule_t* schedule);
+
 /**
  * Set schedule slot
  * @param outputIndex Output index (0-2)
@@ -255,6 +414,40 @@ void output_manager_set_time_prop_params(int outputIndex, uint8_t cycleSec,
 bool output_manager_set_schedule_slot(int outputIndex, int slotIndex,
                                       bool enabled, uint8_t hour, uint8_t minute, float targetTemp);
 
+/**
+ * Enable predictive schedule preheat
+ * @param outputIndex Output index (0-2)
+ * @param enabled Ramp the target ahead of upward slot changes once the model is learned
+ */
+void output_manager_set_schedule_predictive(int outputIndex, bool enabled);
+
+/**
+ * Forget the learned thermal model (e.g. after moving the heater)
+ * @param outputIndex Output index (0-2)
+ */
+void output_manager_reset_thermal_model(int outputIndex);
+
+/**
+ * Set the load rating used for energy accounting
+ * @param outputIndex Output index (0-2)
+ * @param watts Power drawn at 100% (0 = unknown, only ON time is counted)
+ */
+void output_manager_set_rated_watts(int outputIndex, uint16_t watts);
+
+/**
+ * Copy an output's energy counters
+ * @param outputIndex Output index (0-2)
+ * @param meter Output: counters and hour/day/month buckets
+ * @return true if the index is valid
+ */
+bool output_manager_get_energy(int outputIndex, EnergyMeter_t* meter);
+
+/**
+ * Clear an output's energy counters (e.g. after swapping the heater)
+ * @param outputIndex Output index (0-2)
+ */
+void output_manager_reset_energy(int outputIndex);
+
 /**
  * Load configuration from preferences
  */
@@ -318,6 +511,13 @@ void output_manager_set_safety_limits(int outputIndex, float maxTempC, float min
  */
 void output_manager_set_fault_mode(int outputIndex, FaultMode_t faultMode, uint8_t capPowerPct);
 
+/**
+ * Set auto-resume after sensor recovery
+ * @param outputIndex Output index (0-2)
+ * @param autoResume Resume normal control once the sensor reads OK again
+ */
+void output_manager_set_auto_resume(int outputIndex, bool autoResume);
+
 /**
  * Clear fault state (manual reset)
  * @param outputIndex Output index (0-2)
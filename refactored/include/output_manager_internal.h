@@ -0,0 +1,32 @@
+/**
+ * output_manager_internal.h
+ * Output Manager Control Steps for Host Tools
+ *
+ * The per-mode steps output_manager_update() runs for one output, exposed
+ * so the host benchmarks (bench/src/bench_control.cpp) can time them on
+ * their own. They touch the working copy without the output lock and
+ * publish nothing: single-threaded host tools only, never firmware modules.
+ */
+
+#ifndef OUTPUT_MANAGER_INTERNAL_H
+#define OUTPUT_MANAGER_INTERNAL_H
+
+#include "output_manager.h"
+
+/**
+ * Run the PID mode step on a reading (updatePID)
+ * @param outputIndex Output index (0-2)
+ * @param temp Air reading (°C)
+ * @return Power % applied
+ */
+int output_manager_step_pid(int outputIndex, float temp);
+
+/**
+ * Run the time-proportional mode step on a reading (updateTimeProp)
+ * @param outputIndex Output index (0-2)
+ * @param temp Air reading (°C)
+ * @return Duty cycle % the PID computed
+ */
+float output_manager_step_time_prop(int outputIndex, float temp);
+
+#endif // OUTPUT_MANAGER_INTERNAL_H
@@ -0,0 +1,83 @@
+/**
+ * pid_control.h
+ * Single-Loop PID Step (PID, time-prop and schedule modes)
+ *
+ * One step of the air-sensor PID that output_manager runs every control
+ * tick:
+ *
+ * - Gains come from the gain schedule when it is enabled and ambient is
+ *   known; feedforward adds the steady-state power for the load
+ *   (target - ambient, see gain_schedule.h)
+ * - The integral holds the I term in % so gains can change without
+ *   moving the output
+ * - While the output is saturated the integral stops growing and any
+ *   part of it beyond the limit bleeds off with time constant Tt
+ * - D acts on the measurement, and the integral absorbs (1 - setpointWeight)
+ *   of the P kick, so a target step moves the output by Kp * weight * step
+ *   and never through D
+ * - A bumpless reset starts the integral from the power already applied;
+ *   a gap longer than maxGapSec restarts the derivative
+ */
+
+#ifndef PID_CONTROL_H
+#define PID_CONTROL_H
+
+#include "gain_schedule.h"
+#include <stdint.h>
+
+/**
+ * Gains, limits and schedule for one output
+ */
+typedef struct {
+    float kp;                 // Fixed gains (the schedule replaces them when it applies)
+    float ki;
+    float kd;
+    float setpointWeight;     // Share of a target step P reacts to (0-1)
+    float outMin;             // Actuator limits (% power)
+    float outMax;
+    float integralMax;        // I term limit (% power)
+    float maxGapSec;          // Longer gaps restart the derivative
+    const GainSchedule_t* schedule;   // nullptr = fixed gains, no feedforward
+} PidControlParams_t;
+
+/**
+ * Runtime state for one output
+ */
+typedef struct {
+    float integral;           // I term (% power)
+    float lastInput;          // Measurement at the last step (D on measurement)
+    float lastTarget;         // Target at the last step (setpoint weighting)
+    bool primed;              // lastInput is valid
+    bool tracking;            // Next step starts the integral from currentPower
+
+    // Last step, for status
+    float activeKp;
+    float activeKi;
+    float activeKd;
+    float feedforward;        // % power
+    float load;               // target - ambient, NAN when ambient is unknown
+} PidControlState_t;
+
+/**
+ * Run one PID step
+ * @param params Gains, limits and schedule
+ * @param state Loop state
+ * @param target Setpoint (°C)
+ * @param input Measurement (°C)
+ * @param ambient Room temperature (°C), NAN if unknown
+ * @param currentPower Power applied now (%), picked up by a bumpless reset
+ * @param dt Seconds since the previous step
+ * @return Output % (outMin-outMax)
+ */
+float pid_control_step(const PidControlParams_t* params, PidControlState_t* state,
+                       float target, float input, float ambient, float currentPower, float dt);
+
+/**
+ * Restart the loop
+ * @param state Loop state
+ * @param bumpless true: the next step continues from currentPower;
+ *                 false: the integral starts from zero
+ */
+void pid_control_reset(PidControlState_t* state, bool bumpless);
+
+#endif // PID_CONTROL_H
@@ -7,6 +7,7 @@
  * - Boot loop detection
  * - Safe mode operation
  * - Emergency shutdown capability
+ * - Per-subsystem heartbeat supervision
  */
 
 #ifndef SAFETY_MANAGER_H
@@ -22,6 +23,9 @@
 #define BOOT_STABLE_TIME_SEC 60        // Time before boot is considered stable
 #define BOOT_WINDOW_SEC 300            // Time window to count rapid reboots (5 min)
 
+// Heartbeat supervision
+#define HEARTBEAT_GRACE_FACTOR 3       // Stall = no check-in for this many expected periods
+
 /**
  * Safe mode reasons
  */
@@ -33,6 +37,29 @@ typedef enum {
     SAFE_MODE_CRITICAL_FAULT   // Critical fault (e.g., all sensors failed)
 } SafeModeReason_t;
 
+/**
+ * Supervised subsystems (heartbeat registry slots)
+ */
+typedef enum {
+    HEARTBEAT_CONTROL = 0,     // Output control loop
+    HEARTBEAT_SENSORS,         // Sensor polling
+    HEARTBEAT_NETWORK,         // Web server / network servicing
+    HEARTBEAT_DISPLAY,         // TFT display and touch
+    HEARTBEAT_COUNT
+} HeartbeatId_t;
+
+/**
+ * Heartbeat registry entry
+ */
+typedef struct {
+    bool registered;               // Subsystem is supervised
+    bool stalled;                  // Currently past its deadline
+    uint32_t periodMs;             // Expected check-in period
+    unsigned long lastBeat;        // millis() of last check-in
+    uint32_t beats;                // Total check-ins
+    uint16_t stalls;               // Stall events this boot
+} HeartbeatInfo_t;
+
 /**
  * Safety manager state
  */
@@ -44,6 +71,9 @@ typedef struct {
     unsigned long stableTime;         // When boot became stable (0 if not yet)
     bool watchdogEnabled;             // Watchdog is active
     unsigned long lastWatchdogFeed;   // Last watchdog feed time
+    bool outputsHeldSafe;             // Outputs forced OFF by heartbeat supervisor
+    int8_t lastStallId;               // Last subsystem to miss its deadline (persisted, -1 = none)
+    uint16_t stallCount;              // Total stalls recorded (persisted)
 } SafetyState_t;
 
 /**
@@ -59,6 +89,13 @@ bool safety_manager_init(void);
  */
 void safety_manager_feed_watchdog(void);
 
+/**
+ * Subscribe the calling task to the hardware watchdog
+ * The task must then call safety_manager_feed_watchdog() itself.
+ * No-op if the watchdog is not running (e.g., safe mode).
+ */
+void safety_manager_watchdog_subscribe(void);
+
 /**
  * Mark boot as stable
  * Call after successful initialization to clear boot counter
@@ -127,4 +164,39 @@ bool safety_manager_is_watchdog_enabled(void);
  */
 unsigned long safety_manager_get_watchdog_margin(void);
 
+/**
+ * Register a subsystem for heartbeat supervision
+ * @param id Subsystem
+ * @param periodMs Expected interval between check-ins
+ */
+void safety_manager_register_heartbeat(HeartbeatId_t id, uint32_t periodMs);
+
+/**
+ * Subsystem check-in
+ * Call each time the subsystem completes a unit of work
+ * @param id Subsystem
+ */
+void safety_manager_heartbeat(HeartbeatId_t id);
+
+/**
+ * Check all registered heartbeats for missed deadlines
+ * Forces outputs safe on a control/sensor stall and releases them on recovery.
+ * Call regularly from the main loop.
+ */
+void safety_manager_check_heartbeats(void);
+
+/**
+ * Get heartbeat registry entry
+ * @param id Subsystem
+ * @return Pointer to entry, or nullptr if invalid
+ */
+const HeartbeatInfo_t* safety_manager_get_heartbeat(HeartbeatId_t id);
+
+/**
+ * Get heartbeat subsystem name
+ * @param id Subsystem
+ * @return Name string (e.g., "control")
+ */
+const char* safety_manager_get_heartbeat_name(HeartbeatId_t id);
+
 #endif // SAFETY_MANAGER_H
@@ -0,0 +1,159 @@
+/**
+ * scratch_pool.h
+ * Fixed-Size Scratch Arena Pool
+ *
+ * Preallocated (static) arenas for per-request scratch memory:
+ * - JSON documents (ScratchJsonDocument)
+ * - Response streaming buffers (HTML pages, serialized JSON)
+ * - MQTT payload building
+ *
+ * Arenas come in two size classes. Each is a bump-pointer allocator
+ * that is reset when acquired and returned whole on release, so request
+ * handling never touches malloc and memory use is bounded at build time.
+ * If every suitable arena is busy, allocations fall back to malloc and
+ * are counted so undersized pools show up in /api/v1/heap.
+ *
+ * Not thread-safe: only use from the loop() task (web, MQTT).
+ */
+
+#ifndef SCRATCH_POOL_H
+#define SCRATCH_POOL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define SCRATCH_SMALL_SIZE 1024     // Stream/chunk buffers, MQTT payloads
+#define SCRATCH_SMALL_COUNT 2
+#define SCRATCH_LARGE_SIZE 6144     // JSON documents
+#define SCRATCH_LARGE_COUNT 2
+
+/**
+ * Arena handle
+ */
+typedef struct {
+    uint8_t* buffer;
+    uint16_t size;
+    uint16_t used;      // Bump pointer
+    bool inUse;
+} ScratchArena_t;
+
+/**
+ * Pool statistics
+ */
+typedef struct {
+    uint32_t acquisitions;      // Arenas handed out
+    uint32_t fallbacks;         // Requests served by malloc (pool busy or too small)
+    uint32_t exhausted;         // Acquire calls that found no arena
+    uint8_t inUse;              // Arenas currently out
+    uint8_t peakInUse;          // High-water mark
+    uint16_t peakLargeUsed;     // Largest number of bytes bumped in one large arena
+} ScratchPoolStats_t;
+
+/**
+ * Acquire an arena of at least minSize bytes (reset to empty)
+ * @param minSize Required capacity
+ * @return Arena, or nullptr if none free / too large
+ */
+ScratchArena_t* scratch_pool_acquire(size_t minSize);
+
+/**
+ * Return an arena to the pool
+ * @param arena Arena from scratch_pool_acquire (nullptr ignored)
+ */
+void scratch_pool_release(ScratchArena_t* arena);
+
+/**
+ * Bump-allocate from an arena (4-byte aligned)
+ * @param arena Arena
+ * @param size Bytes
+ * @return Pointer, or nullptr if the arena is full
+ */
+void* scratch_alloc(ScratchArena_t* arena, size_t size);
+
+/**
+ * Get pool statistics
+ * @return Pointer to stats
+ */
+const ScratchPoolStats_t* scratch_pool_get_stats(void);
+
+/**
+ * Reset counters (arena state untouched)
+ */
+void scratch_pool_reset_stats(void);
+
+/**
+ * Allocate a block from the pool, falling back to malloc (used by ScratchAllocator)
+ * @param size Bytes
+ * @return Pointer, or nullptr if malloc also failed
+ */
+void* scratch_pool_malloc(size_t size);
+
+/**
+ * Free a block from scratch_pool_malloc
+ * @param ptr Pointer (pool or heap)
+ */
+void scratch_pool_free(void* ptr);
+
+/**
+ * Resize a block from scratch_pool_malloc
+ * Pool blocks resize in place up to the arena size.
+ * @param ptr Pointer (pool or heap)
+ * @param size New size
+ * @return Pointer, or nullptr if it cannot grow
+ */
+void* scratch_pool_realloc(void* ptr, size_t size);
+
+/**
+ * ArduinoJson allocator backed by the scratch pool
+ */
+struct ScratchAllocator {
+    void* allocate(size_t size) { return scratch_pool_malloc(size); }
+    void deallocate(void* ptr) { scratch_pool_free(ptr); }
+    void* reallocate(void* ptr, size_t size) { return scratch_pool_realloc(ptr, size); }
+};
+
+// Drop-in replacement for DynamicJsonDocument in request handlers
+typedef BasicJsonDocument<ScratchAllocator> ScratchJsonDocument;
+
+/**
+ * Buffered Print sink over a scratch arena
+ * Collects output and hands full chunks to a flush callback.
+ * Falls back to a small stack buffer if no arena is free.
+ */
+class ScratchStream : public Print {
+public:
+    typedef void (*FlushFn)(void* ctx, const uint8_t* data, size_t len);
+
+    ScratchStream(FlushFn flush, void* ctx);
+    ~ScratchStream();
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t len) override;
+    using Print::write;
+
+    ScratchStream& operator+=(const char* str) { print(str); return *this; }
+    ScratchStream& operator+=(const String& str) { write((const uint8_t*)str.c_str(), str.length()); return *this; }
+    ScratchStream& operator+=(char c) { write((uint8_t)c); return *this; }
+
+    /**
+     * Push buffered bytes to the flush callback
+     */
+    void flush() override;
+
+    /**
+     * Bytes written since construction
+     */
+    size_t total() const { return total_; }
+
+private:
+    ScratchArena_t* arena_;
+    uint8_t fallback_[128];
+    uint8_t* buf_;
+    size_t cap_;
+    size_t len_;
+    size_t total_;
+    FlushFn flushFn_;
+    void* ctx_;
+};
+
+#endif // SCRATCH_POOL_H
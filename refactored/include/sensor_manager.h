@@ -1,11 +1,14 @@
 /**
  * sensor_manager.h
- * DS18B20 Temperature Sensor Management
+ * Temperature and Humidity Sensor Management
  *
- * Handles multiple DS18B20 sensors on OneWire bus:
+ * Handles DS18B20 sensors on the OneWire bus and SHT3x/BME280
+ * temperature/humidity sensors on I2C:
  * - Discovery and enumeration
  * - Sensor naming and identification
- * - Reading multiple sensors
+ * - Non-blocking polling: one scheduler starts every conversion
+ *   (DS18B20 and I2C alike), returns, and collects the results once the
+ *   slowest conversion is done
  */
 
 #ifndef SENSOR_MANAGER_H
@@ -13,29 +16,44 @@
 
 #include <Arduino.h>
 
-#define MAX_SENSORS 6  // Support up to 6 DS18B20 sensors
+#define MAX_SENSORS 6              // DS18B20 and I2C sensors together
+#define SENSOR_POLL_PERIOD_MS 2000 // Time between measurement rounds
+
+/**
+ * Sensor hardware types
+ */
+typedef enum {
+    SENSOR_TYPE_DS18B20 = 0,      // OneWire temperature
+    SENSOR_TYPE_SHT3X,            // I2C temperature + humidity
+    SENSOR_TYPE_BME280            // I2C temperature + humidity (pressure unused)
+} SensorType_t;
 
 /**
  * Sensor information structure
  */
 typedef struct {
     bool discovered;              // Sensor found on bus
-    uint8_t address[8];           // 64-bit ROM address
-    char addressString[17];       // Hex string (e.g., "28FF1A2B3C4D5E6F")
+    SensorType_t type;
+    uint8_t address[8];           // 64-bit ROM address (DS18B20), I2C address in [0]
+    char addressString[17];       // "28FF1A2B3C4D5E6F" (DS18B20), "SHT3X-44", "BME280-76"
     char name[32];                // User-friendly name (e.g., "Basking Spot")
     float lastReading;            // Last temperature reading
+    float lastHumidity;           // Last %RH reading, NAN for temperature-only sensors
     unsigned long lastReadTime;   // When last read
     int errorCount;               // Consecutive read errors
+    uint32_t totalErrors;         // Read errors since discovery
 } SensorInfo_t;
 
 /**
  * Initialize sensor manager
  * @param oneWirePin GPIO pin for OneWire bus
+ * @param sdaPin GPIO pin for I2C data
+ * @param sclPin GPIO pin for I2C clock
  */
-void sensor_manager_init(uint8_t oneWirePin);
+void sensor_manager_init(uint8_t oneWirePin, uint8_t sdaPin, uint8_t sclPin);
 
 /**
- * Scan OneWire bus for DS18B20 sensors
+ * Scan the OneWire bus for DS18B20 sensors and probe I2C for SHT3x/BME280
  * @return Number of sensors found
  */
 int sensor_manager_scan(void);
@@ -61,18 +79,13 @@ const SensorInfo_t* sensor_manager_get_sensor(int index);
 const SensorInfo_t* sensor_manager_get_sensor_by_address(const char* addressString);
 
 /**
- * Read temperature from specific sensor
- * @param index Sensor index
- * @param temperature Output temperature value
- * @return true if read successful, false on error
- */
-bool sensor_manager_read_sensor(int index, float* temperature);
-
-/**
- * Read all sensors
- * Updates lastReading and lastReadTime for all discovered sensors
+ * Advance the polling scheduler (never waits on a sensor)
+ * Call every control tick. Every SENSOR_POLL_PERIOD_MS it starts all
+ * conversions; once the slowest one is due it collects every sensor and
+ * updates lastReading, lastHumidity and lastReadTime.
+ * @return true on the call that collected a fresh round of readings
  */
-void sensor_manager_read_all(void);
+bool sensor_manager_poll(void);
 
 /**
  * Set user-friendly name for sensor
@@ -100,6 +113,13 @@ void sensor_manager_save_names(void);
  */
 void sensor_manager_get_default_name(int index, char* buffer, size_t maxLen);
 
+/**
+ * Get sensor type name
+ * @param type Sensor type
+ * @return Type name string
+ */
+const char* sensor_manager_get_type_name(SensorType_t type);
+
 /**
  * Validate temperature reading
  * @param temp Temperature value
@@ -107,4 +127,11 @@ void sensor_manager_get_default_name(int index, char* buffer, size_t maxLen);
  */
 bool sensor_manager_is_valid_temp(float temp);
 
+/**
+ * Validate humidity reading
+ * @param humidity %RH value (NAN when the sensor has none)
+ * @return true if valid
+ */
+bool sensor_manager_is_valid_humidity(float humidity);
+
 #endif // SENSOR_MANAGER_H
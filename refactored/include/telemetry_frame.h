@@ -0,0 +1,91 @@
+/**
+ * telemetry_frame.h
+ * Compact MQTT Telemetry Frame
+ *
+ * With compact telemetry on, the 30s MQTT publish is one binary frame on
+ * {base}/telemetry instead of five plain topics and a JSON status per
+ * output: one 91-byte MQTT packet against 18 packets and ~1.3 KB, for
+ * metered (LTE) uplinks.
+ * tools/telemetry_decode.cpp turns frames back into JSON on the host.
+ *
+ * Frame (little-endian):
+ *   0  version      u8    TELEMETRY_VERSION
+ *   1  flags        u8    TELEMETRY_SYS_*
+ *   2  seq          u16   +1 per frame (loss counting)
+ *   4  uptime       u32   seconds
+ *   8  rssi         i8    dBm
+ *   9  outputCount  u8    0..TELEMETRY_OUTPUTS
+ *  10  heapFree     u16   16-byte units
+ *  12  heapLargest  u16   16-byte units
+ *  14  outputs      14 each: temp i16 (0.1°C, INT16_MIN = none), target i16
+ *                   (0.1°C), humidity u8 (0.5%, 0xFF = none), power u8 (%),
+ *                   mode u8 (ControlMode_t), flags u8 (TELEMETRY_OUT_*),
+ *                   powerW u16 (0.1 W), energy u32 (Wh, lifetime)
+ */
+
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_OUTPUTS 3
+#define TELEMETRY_FRAME_SIZE (14 + 14 * TELEMETRY_OUTPUTS)
+#define TELEMETRY_HEAP_UNIT 16
+
+// System flags
+#define TELEMETRY_SYS_SAFE_MODE 0x01
+
+// Output flags
+#define TELEMETRY_OUT_ENABLED 0x01
+#define TELEMETRY_OUT_HEATING 0x02
+#define TELEMETRY_OUT_FAULT 0x04
+
+/**
+ * One output's state
+ */
+typedef struct {
+    float temp;               // °C, NAN if no valid reading
+    float target;             // °C
+    float humidity;           // %RH, NAN if the sensor has none
+    uint8_t power;            // %
+    uint8_t mode;             // ControlMode_t
+    uint8_t flags;            // TELEMETRY_OUT_*
+    float powerW;             // Power being delivered
+    uint32_t energyWh;        // Lifetime energy
+} TelemetryOutput_t;
+
+/**
+ * Decoded telemetry frame
+ */
+typedef struct {
+    uint8_t flags;            // TELEMETRY_SYS_*
+    uint16_t seq;
+    uint32_t uptimeSec;
+    int8_t rssi;              // dBm, 0 if not connected
+    uint32_t heapFree;        // Bytes (multiple of TELEMETRY_HEAP_UNIT)
+    uint32_t heapLargest;     // Bytes (multiple of TELEMETRY_HEAP_UNIT)
+    uint8_t outputCount;
+    TelemetryOutput_t outputs[TELEMETRY_OUTPUTS];
+} Telemetry_t;
+
+/**
+ * Encode a telemetry frame
+ * @param telemetry Frame contents
+ * @param buf Output buffer
+ * @param len Buffer size
+ * @return Bytes written (TELEMETRY_FRAME_SIZE), 0 if the buffer is too small
+ */
+size_t telemetry_frame_encode(const Telemetry_t* telemetry, uint8_t* buf, size_t len);
+
+/**
+ * Decode a telemetry frame
+ * @param buf Received bytes
+ * @param len Number of bytes
+ * @param telemetry Output
+ * @return true if it is a valid frame of this version
+ */
+bool telemetry_frame_decode(const uint8_t* buf, size_t len, Telemetry_t* telemetry);
+
+#endif // TELEMETRY_FRAME_H
@@ -4,6 +4,13 @@
  *
  * Records temperature readings over time with configurable
  * sample interval and buffer size for visualization
+ *
+ * Every point gets a sequence number (points recorded since boot,
+ * not reset by clear) so collectors can fetch only what is new;
+ * the boot ID changes when the numbering restarts.
+ *
+ * Points recorded before NTP sync carry the 1970-based boot clock;
+ * temp_history_restamp() moves them once the real time is known.
  */
 
 #ifndef TEMP_HISTORY_H
@@ -60,4 +67,47 @@ void temp_history_clear(void);
  */
 unsigned long temp_history_get_last_sample_time(void);
 
+/**
+ * Shift timestamps taken before the clock was set
+ * @param before Points stamped earlier than this (TIME_VALID_EPOCH) are moved
+ * @param offset Seconds to add (the clock step)
+ * @return Number of points re-stamped
+ */
+int temp_history_restamp(unsigned long before, long offset);
+
+/**
+ * Get sequence number of the oldest stored point
+ * Point at index i has seq first + i.
+ * @return Sequence number of index 0
+ */
+uint32_t temp_history_get_first_seq(void);
+
+/**
+ * Get sequence number the next recorded point will get
+ * @return Points recorded since boot
+ */
+uint32_t temp_history_get_next_seq(void);
+
+/**
+ * Copy stored points from a sequence number on
+ * Indices and points are read under the lock recording takes, so a point
+ * recorded meanwhile (control task) cannot shift the copy against its
+ * sequence numbers.
+ * @param since First sequence number wanted; older points are gone, the
+ *              copy then starts at the oldest stored one
+ * @param max Capacity of points
+ * @param points Output, oldest first
+ * @param firstSeq Output: sequence number of points[0]
+ * @param nextSeq Output: sequence number the next recorded point will get
+ * @return Points copied
+ */
+int temp_history_copy_since(uint32_t since, int max, TempHistoryPoint_t* points,
+                            uint32_t* firstSeq, uint32_t* nextSeq);
+
+/**
+ * Get this boot's ID (random, changes when sequence numbers restart)
+ * @return Boot ID
+ */
+uint32_t temp_history_get_boot_id(void);
+
 #endif // TEMP_HISTORY_H
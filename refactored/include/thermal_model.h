@@ -0,0 +1,120 @@
+/**
+ * thermal_model.h
+ * Online First-Order Enclosure Model
+ *
+ * Learns how fast an output heats its enclosure and how fast it cools:
+ *
+ *   dT/dt (°C/min) = heat * u + loss * (T - THERMAL_MODEL_REF_C) + bias
+ *
+ * u is the applied power (0-1), loss is negative (Newton cooling) and bias
+ * absorbs the ambient temperature. Parameters are fitted by recursive least
+ * squares on 2-minute samples of temperature change vs average power, with
+ * forgetting so the fit follows seasons.
+ *
+ * The schedule uses the model to preheat: before a slot raises the target
+ * it ramps the setpoint along the model's heating curve so the new target
+ * is reached at the slot time instead of after it.
+ */
+
+#ifndef THERMAL_MODEL_H
+#define THERMAL_MODEL_H
+
+#include <stdint.h>
+
+#define THERMAL_MODEL_SAMPLE_SEC 120      // Fit interval
+#define THERMAL_MODEL_REF_C 25.0f         // Temperature regressor offset (conditioning)
+#define THERMAL_MODEL_MIN_SAMPLES 30      // 1 hour before predictions are used
+#define THERMAL_MODEL_MIN_HEAT_SAMPLES 10 // Samples with real heater power in them
+#define THERMAL_MODEL_PLAN_POWER 70.0f    // Preheat plans at this power (headroom for the PID)
+#define THERMAL_MODEL_MAX_LEAD_MIN 240.0f // Never start a preheat earlier than this
+
+/**
+ * Model state (caller allocates)
+ */
+typedef struct {
+    float theta[3];           // heat, loss, bias
+    float P[3][3];            // RLS covariance
+    uint32_t samples;         // Fitted samples
+    uint32_t heatSamples;     // Fitted samples with average power > 30%
+
+    // Sample being accumulated
+    float accSec;
+    float accPowerSec;
+    float startTemp;
+    bool sampling;
+} ThermalModel_t;
+
+/**
+ * Reset model to "nothing learned"
+ * @param model Model
+ */
+void thermal_model_init(ThermalModel_t* model);
+
+/**
+ * Restore fitted parameters (e.g. from NVS)
+ * Covariance restarts moderately wide so the fit can still move.
+ * @param model Model
+ * @param heat Heating rate at full power (°C/min)
+ * @param loss Loss coefficient (1/min, negative)
+ * @param bias Bias term (°C/min)
+ * @param samples Sample count to treat as already seen
+ */
+void thermal_model_restore(ThermalModel_t* model, float heat, float loss, float bias,
+                           uint32_t samples);
+
+/**
+ * Feed one control step
+ * @param model Model
+ * @param temp Current valid temperature (°C)
+ * @param powerPct Power actually applied over the step (0-100)
+ * @param dt Step length (s)
+ * @return true if a sample was fitted
+ */
+bool thermal_model_update(ThermalModel_t* model, float temp, float powerPct, float dt);
+
+/**
+ * Drop a partial sample (sensor gap, fault)
+ * @param model Model
+ */
+void thermal_model_break(ThermalModel_t* model);
+
+/**
+ * Check the model has learned enough to plan with
+ * @param model Model
+ * @return true if predictions are usable
+ */
+bool thermal_model_valid(const ThermalModel_t* model);
+
+/**
+ * Steady-state temperature at a constant power
+ * @param model Model
+ * @param powerPct Power (0-100)
+ * @return Temperature (°C)
+ */
+float thermal_model_equilibrium(const ThermalModel_t* model, float powerPct);
+
+/**
+ * Minutes to go from one temperature to another at a constant power
+ * @param model Model
+ * @param from Start temperature
+ * @param to End temperature
+ * @param powerPct Power (0-100)
+ * @return Minutes, or -1 if unreachable at that power
+ */
+float thermal_model_time_to(const ThermalModel_t* model, float from, float to, float powerPct);
+
+/**
+ * Setpoint for the current slot, ramped toward the next one
+ * Upward transitions follow the model's THERMAL_MODEL_PLAN_POWER heating
+ * curve backwards from the slot time; downward ones are left alone (the
+ * current slot keeps its target until it ends).
+ * @param model Model
+ * @param target Current slot target
+ * @param nextTarget Next slot target
+ * @param minutesToNext Minutes until the next slot starts
+ * @return Setpoint to use now (target if the model is not valid)
+ */
+float thermal_model_ramp_setpoint(const ThermalModel_t* model, float target, float nextTarget,
+                                  float minutesToNext);
+
+#endif // THERMAL_MODEL_H
@@ -0,0 +1,142 @@
+/**
+ * time_service.h
+ * Clock, Timezone and Cached Local Time
+ *
+ * One place for time:
+ * - 64-bit microsecond monotonic clock (esp_timer, never wraps in practice)
+ * - UTC with sync-quality flags (valid / NTP-synced / stale)
+ * - POSIX TZ string with DST rules (settings key "tz"), applied before
+ *   NTP starts so schedules run in local time
+ * - Broken-down local time refreshed once per second by time_service_task(),
+ *   so readers (schedules, energy buckets, web) never call localtime_r() or
+ *   getLocalTime(), which waits up to 5s while the clock isn't set
+ *
+ * When the first NTP sync steps the clock from its 1970-based boot value,
+ * the sync callback gets the step so samples stamped before it can be
+ * moved to real UTC.
+ *
+ * Readers may run on the control task; the cache is published with a
+ * sequence counter so they never see a half-written struct tm.
+ */
+
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <Arduino.h>
+#include <time.h>
+
+#define TIME_VALID_EPOCH 1577836800L      // 2020-01-01: earlier means the clock isn't set
+#define TIME_SYNC_STALE_SEC (6 * 3600)    // SNTP resyncs hourly; this long without one is stale
+#define TIME_TZ_MAX_LEN 64
+#define TIME_DEFAULT_TZ "UTC0"
+
+// Sync quality flags
+#define TIME_FLAG_VALID 0x01              // Clock is past TIME_VALID_EPOCH (NTP, or kept across a soft reset)
+#define TIME_FLAG_SYNCED 0x02             // NTP synced at least once this boot
+#define TIME_FLAG_STALE 0x04              // Synced, but not within TIME_SYNC_STALE_SEC
+
+/**
+ * Clock status
+ */
+typedef struct {
+    uint8_t flags;                        // TIME_FLAG_*
+    uint32_t syncCount;                   // NTP syncs this boot
+    uint32_t lastSyncAgeSec;              // Since the last NTP sync (0 if none)
+    int32_t firstStepSec;                 // Clock step at the first valid time (0 if it was already valid)
+} TimeStatus_t;
+
+/**
+ * Sync callback
+ * @param stepSec Seconds the clock moved when it first became valid; stamps
+ *                taken before then (below TIME_VALID_EPOCH) need this added
+ */
+typedef void (*TimeSyncCallback_t)(int32_t stepSec);
+
+/**
+ * Initialize time service
+ * Applies the saved timezone. Call early in setup().
+ */
+void time_service_init(void);
+
+/**
+ * Start NTP (station mode only)
+ */
+void time_service_start_sync(void);
+
+/**
+ * Time service task - call from main loop
+ * Refreshes the cached local time when the second changes and
+ * detects the first valid time.
+ */
+void time_service_task(void);
+
+/**
+ * Get monotonic time since boot
+ * @return Microseconds
+ */
+uint64_t time_service_uptime_us(void);
+
+/**
+ * Get monotonic time since boot
+ * @return Milliseconds (64-bit, unlike millis())
+ */
+uint64_t time_service_uptime_ms(void);
+
+/**
+ * Get seconds since boot
+ * @return Seconds (from the 64-bit clock, so no wrap at 49.7 days like millis() / 1000)
+ */
+uint32_t time_service_uptime_sec(void);
+
+/**
+ * Check if the clock is set
+ * @return true if UTC is past TIME_VALID_EPOCH
+ */
+bool time_service_is_valid(void);
+
+/**
+ * Get UTC
+ * @return Unix time, 0 if the clock isn't set
+ */
+time_t time_service_utc(void);
+
+/**
+ * Get cached local time (refreshed once per second)
+ * @param out Broken-down local time
+ * @return false if the clock isn't set (out untouched)
+ */
+bool time_service_get_local(struct tm* out);
+
+/**
+ * Get clock status
+ * @param status Output
+ */
+void time_service_get_status(TimeStatus_t* status);
+
+/**
+ * Get timezone
+ * @return POSIX TZ string (static, do not free)
+ */
+const char* time_service_get_timezone(void);
+
+/**
+ * Check a POSIX TZ string, e.g. "CET-1CEST,M3.5.0,M10.5.0/3"
+ * @param tz Timezone
+ * @return true if it looks usable (name, offset, optional DST rule)
+ */
+bool time_service_is_valid_timezone(const char* tz);
+
+/**
+ * Set timezone, apply it and save it to preferences
+ * @param tz POSIX TZ string
+ * @return false if it was rejected
+ */
+bool time_service_set_timezone(const char* tz);
+
+/**
+ * Set callback fired once when the clock first becomes valid
+ * @param callback Function to call (from time_service_task)
+ */
+void time_service_set_sync_callback(TimeSyncCallback_t callback);
+
+#endif // TIME_SERVICE_H
@@ -53,46 +53,36 @@ void webserver_set_schedule_callback(ScheduleSaveCallback_t callback);
  */
 void webserver_set_restart_callback(WebServerCallback_t callback);
 
-/**
- * Set current thermostat state for web pages
- * Call this to update values before serving pages
- */
-void webserver_set_state(float currentTemp, float targetTemp, 
-                         bool heating, const char* mode, int power);
-
 /**
  * Set device information for web pages
  */
 void webserver_set_device_info(const char* deviceName, const char* firmwareVersion);
 
-/**
- * Set network status for info page
- */
-void webserver_set_network_status(bool connected, bool apMode, 
-                                  const char* ssid, const char* ip);
-
 /**
  * Add log entry for logs page
  * @param message Log message to add
  */
 void webserver_add_log(const char* message);
 
+// webserver_set_state() and webserver_set_network_status() removed -
+// the web server follows Output 1 and WiFi status on the event bus
+
 // webserver_set_schedule_data() removed - legacy function
 // Schedule data now managed per-output via output_manager
 
 /**
- * Get HTML header with navigation
+ * Write HTML header with navigation
+ * @param out Page being written (the handler's response stream)
  * @param title Page title
  * @param activePage Active navigation item ("home", "schedule", "info", "logs", "settings")
- * @return HTML header string (caller must free)
  */
-String webserver_get_html_header(const char* title, const char* activePage);
+void webserver_write_html_header(Print& out, const char* title, const char* activePage);
 
 /**
- * Get HTML footer
+ * Write HTML footer
+ * @param out Page being written
  * @param uptimeSeconds System uptime in seconds
- * @return HTML footer string (caller must free)
  */
-String webserver_get_html_footer(unsigned long uptimeSeconds);
+void webserver_write_html_footer(Print& out, unsigned long uptimeSeconds);
 
 #endif // WEB_SERVER_H
@@ -0,0 +1,120 @@
+/**
+ * cascade_control.cpp
+ * Two-Loop (Cascade) Temperature Control Implementation
+ */
+
+#include "cascade_control.h"
+#include <math.h>
+#include <string.h>
+
+// Defaults (tuned with tools/thermal_sim.cpp on a 20W mat under glass)
+#define DEFAULT_OUTER_KP 2.0f         // °C of surface per °C of air error
+#define DEFAULT_OUTER_KI 0.004f
+#define DEFAULT_OUTER_KD 0.0f
+#define DEFAULT_OUTER_MAX_OFFSET 15.0f
+#define DEFAULT_INNER_KP 12.0f        // % power per °C of surface error
+#define DEFAULT_INNER_KI 0.08f
+#define DEFAULT_INNER_KD 0.0f
+#define DEFAULT_SURFACE_MAX_C 40.0f
+#define DEFAULT_OUTER_PERIOD_SEC 10.0f
+#define DEFAULT_INNER_PERIOD_SEC 2.0f  // Sensor read interval
+#define CASCADE_MAX_GAP_PERIODS 3.0f   // Longer gaps restart a loop's derivative
+
+static inline float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+/**
+ * Shared PID parameters for one loop (fixed gains, no feedforward)
+ */
+static PidControlParams_t loopParams(const PidLoopParams_t* loop, float setpointWeight,
+                                     float periodSec) {
+    PidControlParams_t params;
+    params.kp = loop->kp;
+    params.ki = loop->ki;
+    params.kd = loop->kd;
+    params.setpointWeight = setpointWeight;
+    params.outMin = loop->outMin;
+    params.outMax = loop->outMax;
+    params.integralMax = fmaxf(fabsf(loop->outMin), fabsf(loop->outMax));
+    params.maxGapSec = CASCADE_MAX_GAP_PERIODS * periodSec;
+    params.schedule = nullptr;
+    return params;
+}
+
+/**
+ * Default cascade parameters
+ */
+void cascade_default_params(CascadeParams_t* params) {
+    params->outer.kp = DEFAULT_OUTER_KP;
+    params->outer.ki = DEFAULT_OUTER_KI;
+    params->outer.kd = DEFAULT_OUTER_KD;
+    params->outer.outMin = 0.0f;
+    params->outer.outMax = DEFAULT_OUTER_MAX_OFFSET;
+
+    params->inner.kp = DEFAULT_INNER_KP;
+    params->inner.ki = DEFAULT_INNER_KI;
+    params->inner.kd = DEFAULT_INNER_KD;
+    params->inner.outMin = 0.0f;
+    params->inner.outMax = 100.0f;
+
+    params->surfaceMaxC = DEFAULT_SURFACE_MAX_C;
+    params->outerPeriodSec = DEFAULT_OUTER_PERIOD_SEC;
+    params->innerPeriodSec = DEFAULT_INNER_PERIOD_SEC;
+}
+
+/**
+ * Reset cascade state
+ */
+void cascade_reset(CascadeState_t* state, bool bumpless) {
+    memset(state, 0, sizeof(*state));
+    pid_control_reset(&state->outer, bumpless);
+    pid_control_reset(&state->inner, bumpless);
+}
+
+/**
+ * Advance the cascade
+ */
+float cascade_update(const CascadeParams_t* params, CascadeState_t* state,
+                     float airTarget, float airTemp, float surfaceTemp,
+                     float setpointWeight, float currentPower, float dt) {
+    state->outerElapsed += dt;
+    state->innerElapsed += dt;
+
+    // Outer loop: air error -> surface setpoint
+    if (!state->started || state->outerElapsed >= params->outerPeriodSec) {
+        // Offset clamp shrinks so the setpoint never passes the ceiling -
+        // the outer integrator then stops winding up against it too
+        PidLoopParams_t outer = params->outer;
+        float headroom = params->surfaceMaxC - airTarget;
+        if (outer.outMax > headroom) outer.outMax = headroom;
+        if (outer.outMin > outer.outMax) outer.outMin = outer.outMax;
+        PidControlParams_t pid = loopParams(&outer, setpointWeight, params->outerPeriodSec);
+
+        // A bumpless start holds the surface where it is, so the inner
+        // loop begins with no error and carries on from currentPower
+        float offsetNow = isnan(surfaceTemp) ? outer.outMin
+                                             : clampf(surfaceTemp - airTarget, outer.outMin, outer.outMax);
+        float offset = pid_control_step(&pid, &state->outer, airTarget, airTemp, NAN, offsetNow,
+                                        state->started ? state->outerElapsed : 0.0f);
+        state->surfaceSetpoint = airTarget + offset;
+        state->outerElapsed = 0.0f;
+    }
+
+    // Inner loop: surface error -> power
+    if (!state->started || state->innerElapsed >= params->innerPeriodSec) {
+        PidControlParams_t pid = loopParams(&params->inner, 1.0f, params->innerPeriodSec);
+        state->power = pid_control_step(&pid, &state->inner, state->surfaceSetpoint, surfaceTemp,
+                                        NAN, currentPower, state->started ? state->innerElapsed : 0.0f);
+        state->innerElapsed = 0.0f;
+    }
+    state->started = true;
+
+    // Hard ceiling, checked on every call rather than at the inner rate
+    state->atCeiling = (surfaceTemp >= params->surfaceMaxC);
+    if (state->atCeiling) {
+        state->power = 0.0f;
+    }
+
+    return state->power;
+}
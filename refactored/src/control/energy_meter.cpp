@@ -0,0 +1,130 @@
+/**
+ * energy_meter.cpp
+ * Per-Output Energy and Duty Accounting Implementation
+ */
+
+#include "energy_meter.h"
+#include <math.h>
+#include <string.h>
+
+#define MJ_PER_MWH 3600ULL
+
+/**
+ * Days since 1970-01-01 (proleptic Gregorian, H. Hinnant's days_from_civil)
+ */
+static int32_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    int32_t yoe = year - era * 400;
+    int32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static uint32_t mjToMwh(uint64_t mj) {
+    uint64_t mwh = (mj + MJ_PER_MWH / 2) / MJ_PER_MWH;
+    return mwh > UINT32_MAX ? UINT32_MAX : (uint32_t)mwh;
+}
+
+/**
+ * Close the open bucket of one period
+ * steps periods have passed: the open bucket becomes ring[steps - 1] and
+ * the ones in between (device off) stay empty.
+ */
+static void rollPeriod(int32_t* stamp, int32_t current, uint32_t* ring, int size,
+                       uint64_t* startMj, uint64_t energyMj) {
+    if (*stamp == 0 || current < *stamp) {
+        // First clock sync, or the clock went back: keep the open bucket
+        *stamp = current;
+        return;
+    }
+    if (current == *stamp) {
+        return;
+    }
+
+    int32_t steps = current - *stamp;
+    uint32_t closed = mjToMwh(energyMj - *startMj);
+    if (steps > size) {
+        memset(ring, 0, size * sizeof(uint32_t));
+    } else {
+        memmove(ring + steps, ring, (size - steps) * sizeof(uint32_t));
+        memset(ring, 0, steps * sizeof(uint32_t));
+        ring[steps - 1] = closed;
+    }
+    *startMj = energyMj;
+    *stamp = current;
+}
+
+/**
+ * Clear all counters
+ */
+void energy_meter_reset(EnergyMeter_t* meter) {
+    memset(meter, 0, sizeof(*meter));
+    meter->version = ENERGY_METER_VERSION;
+}
+
+/**
+ * Add one control tick
+ */
+void energy_meter_add(EnergyMeter_t* meter, uint16_t ratedWatts, uint16_t fractionPermille,
+                      uint32_t dtMs) {
+    if (fractionPermille == 0 || dtMs == 0) {
+        return;
+    }
+    if (fractionPermille > 1000) {
+        fractionPermille = 1000;
+    }
+    meter->onMs += dtMs;
+
+    // ms x permille / 1000 = full-power ms
+    uint64_t duty = (uint64_t)fractionPermille * dtMs + meter->dutyRem;
+    meter->dutyMs += duty / 1000;
+    meter->dutyRem = (uint32_t)(duty % 1000);
+
+    // W x permille/1000 x ms/1000 = J, x1000 = mJ
+    uint64_t energy = (uint64_t)ratedWatts * fractionPermille * dtMs + meter->energyRem;
+    meter->energyMj += energy / 1000;
+    meter->energyRem = (uint32_t)(energy % 1000);
+}
+
+/**
+ * Close finished buckets
+ */
+void energy_meter_roll(EnergyMeter_t* meter, const struct tm* now) {
+    int32_t day = daysFromCivil(now->tm_year + 1900, now->tm_mon + 1, now->tm_mday);
+    rollPeriod(&meter->hourStamp, day * 24 + now->tm_hour, meter->hourMwh, ENERGY_HOURS,
+               &meter->hourStartMj, meter->energyMj);
+    rollPeriod(&meter->dayStamp, day, meter->dayMwh, ENERGY_DAYS,
+               &meter->dayStartMj, meter->energyMj);
+    rollPeriod(&meter->monthStamp, (now->tm_year + 1900) * 12 + now->tm_mon, meter->monthMwh,
+               ENERGY_MONTHS, &meter->monthStartMj, meter->energyMj);
+}
+
+/**
+ * Energy in the open bucket
+ */
+uint32_t energy_meter_open_mwh(const EnergyMeter_t* meter, char period) {
+    uint64_t start = period == 'h' ? meter->hourStartMj :
+                     period == 'd' ? meter->dayStartMj : meter->monthStartMj;
+    return mjToMwh(meter->energyMj - start);
+}
+
+/**
+ * Lifetime energy in kWh
+ */
+double energy_meter_total_kwh(const EnergyMeter_t* meter) {
+    return meter->energyMj / 3.6e9;
+}
+
+/**
+ * Dimmer power fraction
+ */
+uint16_t energy_dimmer_fraction_permille(int powerPct) {
+    if (powerPct <= 0) return 0;
+    if (powerPct >= 100) return 1000;
+
+    // Firing angle a (rad): P/Pfull = 1 - a/pi + sin(2a)/(2pi)
+    float a = (float)M_PI * (1.0f - powerPct / 100.0f);
+    float fraction = 1.0f - a / (float)M_PI + sinf(2.0f * a) / (2.0f * (float)M_PI);
+    return (uint16_t)lroundf(fraction * 1000.0f);
+}
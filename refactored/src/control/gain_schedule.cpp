@@ -0,0 +1,106 @@
+/**
+ * gain_schedule.cpp
+ * PID Gain Scheduling and Ambient Feedforward Implementation
+ */
+
+#include "gain_schedule.h"
+#include <string.h>
+
+/**
+ * Reset schedule
+ */
+void gain_schedule_init(GainSchedule_t* schedule) {
+    memset(schedule, 0, sizeof(*schedule));
+}
+
+/**
+ * Validate, sort and precompute
+ */
+void gain_schedule_prepare(GainSchedule_t* schedule) {
+    if (schedule->count > GAIN_SCHEDULE_POINTS) {
+        schedule->count = GAIN_SCHEDULE_POINTS;
+    }
+    if (schedule->ffGain < 0.0f) schedule->ffGain = 0.0f;
+    if (schedule->ffGain > GAIN_SCHEDULE_FF_MAX) schedule->ffGain = GAIN_SCHEDULE_FF_MAX;
+
+    GainPoint_t* p = schedule->points;
+    int n = schedule->count;
+    for (int i = 0; i < n; i++) {
+        if (p[i].load < GAIN_SCHEDULE_LOAD_MIN) p[i].load = GAIN_SCHEDULE_LOAD_MIN;
+        if (p[i].load > GAIN_SCHEDULE_LOAD_MAX) p[i].load = GAIN_SCHEDULE_LOAD_MAX;
+        if (p[i].kp < 0.0f) p[i].kp = 0.0f;
+        if (p[i].ki < 0.0f) p[i].ki = 0.0f;
+        if (p[i].kd < 0.0f) p[i].kd = 0.0f;
+    }
+
+    // Insertion sort - at most GAIN_SCHEDULE_POINTS entries
+    for (int i = 1; i < n; i++) {
+        GainPoint_t key = p[i];
+        int j = i - 1;
+        while (j >= 0 && p[j].load > key.load) {
+            p[j + 1] = p[j];
+            j--;
+        }
+        p[j + 1] = key;
+    }
+
+    memset(schedule->slope, 0, sizeof(schedule->slope));
+    for (int i = 0; i + 1 < n; i++) {
+        float span = p[i + 1].load - p[i].load;
+        if (span <= 0.0f) {
+            continue;   // Duplicate breakpoint: step, no slope
+        }
+        schedule->slope[i][0] = (p[i + 1].kp - p[i].kp) / span;
+        schedule->slope[i][1] = (p[i + 1].ki - p[i].ki) / span;
+        schedule->slope[i][2] = (p[i + 1].kd - p[i].kd) / span;
+    }
+}
+
+/**
+ * Interpolated gains
+ */
+bool gain_schedule_lookup(const GainSchedule_t* schedule, float load,
+                          float* kp, float* ki, float* kd) {
+    if (!schedule->enabled || schedule->count == 0) {
+        return false;
+    }
+    const GainPoint_t* p = schedule->points;
+    int last = schedule->count - 1;
+
+    // Clamp outside the table
+    if (load <= p[0].load) {
+        *kp = p[0].kp;
+        *ki = p[0].ki;
+        *kd = p[0].kd;
+        return true;
+    }
+    if (load >= p[last].load) {
+        *kp = p[last].kp;
+        *ki = p[last].ki;
+        *kd = p[last].kd;
+        return true;
+    }
+
+    int seg = 0;
+    while (seg < last - 1 && load >= p[seg + 1].load) {
+        seg++;
+    }
+    float dx = load - p[seg].load;
+    *kp = p[seg].kp + schedule->slope[seg][0] * dx;
+    *ki = p[seg].ki + schedule->slope[seg][1] * dx;
+    *kd = p[seg].kd + schedule->slope[seg][2] * dx;
+    return true;
+}
+
+/**
+ * Feedforward power
+ */
+float gain_schedule_feedforward(const GainSchedule_t* schedule, float load) {
+    if (!schedule->enabled) {
+        return 0.0f;
+    }
+    float ff = schedule->ffGain * load;
+    if (ff < 0.0f) return 0.0f;
+    if (ff > 100.0f) return 100.0f;
+    return ff;
+}
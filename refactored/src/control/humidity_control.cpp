@@ -0,0 +1,172 @@
+/**
+ * humidity_control.cpp
+ * Relative Humidity Control Implementation
+ */
+
+#include "humidity_control.h"
+#include <string.h>
+
+// Defaults: short bursts with long soaks, so a mister can't flood the
+// enclosure before the first reading catches up
+#define DEFAULT_TARGET_RH 70.0f
+#define DEFAULT_HYSTERESIS_RH 5.0f
+#define DEFAULT_BAND_RH 10.0f
+#define DEFAULT_CYCLE_SEC 300
+#define DEFAULT_MIN_ON_SEC 5
+#define DEFAULT_MIN_OFF_SEC 60
+#define DEFAULT_MAX_ON_SEC 30
+#define DEFAULT_MAX_DUTY_PCT 10
+#define DEFAULT_DUTY_WINDOW_MIN 60
+
+#define MIN_DUTY_PCT 2.0f           // Below this a cycle stays off (same as heater time-prop)
+
+static inline float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+/**
+ * Fill in defaults
+ */
+void humidity_default_params(HumidityParams_t* params) {
+    params->targetRh = DEFAULT_TARGET_RH;
+    params->method = HUMIDITY_METHOD_ONOFF;
+    params->hysteresisRh = DEFAULT_HYSTERESIS_RH;
+    params->bandRh = DEFAULT_BAND_RH;
+    params->cycleSec = DEFAULT_CYCLE_SEC;
+    params->minOnSec = DEFAULT_MIN_ON_SEC;
+    params->minOffSec = DEFAULT_MIN_OFF_SEC;
+    params->maxOnSec = DEFAULT_MAX_ON_SEC;
+    params->maxDutyPct = DEFAULT_MAX_DUTY_PCT;
+    params->dutyWindowMin = DEFAULT_DUTY_WINDOW_MIN;
+}
+
+/**
+ * Clamp parameters
+ */
+void humidity_validate_params(HumidityParams_t* params) {
+    params->targetRh = clampf(params->targetRh, 0.0f, 100.0f);
+    if (params->method != HUMIDITY_METHOD_TIME_PROP) {
+        params->method = HUMIDITY_METHOD_ONOFF;
+    }
+    params->hysteresisRh = clampf(params->hysteresisRh, 0.5f, 30.0f);
+    params->bandRh = clampf(params->bandRh, 1.0f, 50.0f);
+    if (params->minOnSec < 1) params->minOnSec = 1;
+    if (params->minOnSec > 600) params->minOnSec = 600;
+    if (params->minOffSec > 3600) params->minOffSec = 3600;
+    if (params->maxOnSec > 3600) params->maxOnSec = 3600;
+    if (params->maxOnSec > 0 && params->maxOnSec < params->minOnSec) {
+        params->maxOnSec = params->minOnSec;
+    }
+    if (params->maxDutyPct < 1) params->maxDutyPct = 1;
+    if (params->maxDutyPct > 100) params->maxDutyPct = 100;
+    if (params->dutyWindowMin < 1) params->dutyWindowMin = 1;
+    if (params->dutyWindowMin > 1440) params->dutyWindowMin = 1440;
+
+    // A cycle must fit its minimum ON and OFF parts
+    if (params->cycleSec > 3600) params->cycleSec = 3600;
+    uint16_t minCycle = params->minOnSec + params->minOffSec;
+    if (minCycle < 10) minCycle = 10;
+    if (params->cycleSec < minCycle) params->cycleSec = minCycle;
+}
+
+/**
+ * Budget capacity
+ */
+float humidity_budget_capacity(const HumidityParams_t* params) {
+    return params->maxDutyPct / 100.0f * params->dutyWindowMin * 60.0f;
+}
+
+/**
+ * Reset state
+ */
+void humidity_reset(const HumidityParams_t* params, HumidityState_t* state) {
+    memset(state, 0, sizeof(*state));
+    state->stateSec = params->minOffSec;          // Free to start right away
+    state->cycleElapsed = params->cycleSec;       // First update plans a cycle
+    state->budgetSec = humidity_budget_capacity(params);
+}
+
+/**
+ * Plan the ON time of a time-proportional cycle
+ */
+static void planCycle(const HumidityParams_t* params, HumidityState_t* state, float rh) {
+    float duty = clampf((params->targetRh - rh) / params->bandRh * 100.0f,
+                        0.0f, params->maxDutyPct);
+    float cycle = params->cycleSec;
+    float onSec = duty / 100.0f * cycle;
+
+    if (duty < MIN_DUTY_PCT) {
+        onSec = 0.0f;
+    } else {
+        if (onSec < params->minOnSec) onSec = params->minOnSec;
+        if (onSec > cycle - params->minOffSec) onSec = cycle - params->minOffSec;
+        if (params->maxOnSec > 0 && onSec > params->maxOnSec) onSec = params->maxOnSec;
+    }
+    state->duty = duty;
+    state->cycleOnSec = onSec;
+    state->cycleElapsed = 0.0f;
+}
+
+/**
+ * Advance the controller
+ */
+bool humidity_update(const HumidityParams_t* params, HumidityState_t* state, float rh, float dt) {
+    bool budgeted = params->maxDutyPct < 100;
+    state->stateSec += dt;
+
+    // Spend/refill the budget for the time that just passed
+    if (budgeted) {
+        float capacity = humidity_budget_capacity(params);
+        state->budgetSec += dt * params->maxDutyPct / 100.0f;
+        if (state->on) {
+            state->budgetSec -= dt;
+        }
+        state->budgetSec = clampf(state->budgetSec, 0.0f, capacity);
+    }
+
+    // What the method asks for
+    bool want;
+    if (params->method == HUMIDITY_METHOD_TIME_PROP) {
+        state->cycleElapsed += dt;
+        if (state->cycleElapsed >= params->cycleSec) {
+            planCycle(params, state, rh);
+        }
+        want = state->cycleElapsed < state->cycleOnSec;
+    } else {
+        if (state->on) {
+            want = rh < params->targetRh;
+        } else {
+            want = rh < params->targetRh - params->hysteresisRh;
+        }
+        state->duty = want ? 100.0f : 0.0f;
+    }
+
+    if (state->on) {
+        // Waterlogging limits win over the minimum run time
+        bool limit = (params->maxOnSec > 0 && state->stateSec >= params->maxOnSec) ||
+                     (budgeted && state->budgetSec <= 0.0f);
+        bool hold = state->stateSec < params->minOnSec;
+        if (limit || (!want && !hold)) {
+            state->on = false;
+            state->stateSec = 0.0f;
+            state->limited = limit && want;
+        }
+    } else if (want && state->stateSec >= params->minOffSec) {
+        // Don't start a burst the budget can't carry to its minimum length
+        float need = params->minOnSec;
+        float capacity = humidity_budget_capacity(params);
+        if (need > capacity) need = capacity;
+        if (!budgeted || state->budgetSec >= need) {
+            state->on = true;
+            state->stateSec = 0.0f;
+        } else {
+            state->limited = true;
+        }
+    }
+
+    // Cleared once running again or no longer needed
+    if (state->on || !want) {
+        state->limited = false;
+    }
+    return state->on;
+}
@@ -4,10 +4,16 @@
  */
 
 #include "output_manager.h"
+#include "output_manager_internal.h"
 #include "sensor_manager.h"
 #include "console.h"
+#include "safety_manager.h"
+#include "event_bus.h"
+#include "time_service.h"
 #include <RBDdimmer.h>
 #include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 // Hardware pin assignments
 #define OUTPUT1_PIN 5      // AC Dimmer PWM
@@ -18,14 +24,79 @@
 // PID limits
 #define PID_OUTPUT_MIN 0
 #define PID_OUTPUT_MAX 100
-#define PID_INTEGRAL_MAX 100.0f
+#define PID_INTEGRAL_MAX 100.0f          // I term limit (% power)
+#define PID_MAX_GAP_SEC 5.0f             // Longer gaps restart the derivative
 
-// Output array
+// Cascade parameter limits
+#define CASCADE_SURFACE_MAX_LIMIT 60.0f   // Highest ceiling the API accepts
+#define CASCADE_OFFSET_LIMIT 30.0f        // Max surface setpoint above the air target
+
+// Output array (working copy - only touched with the output lock held)
 static OutputConfig_t outputs[MAX_OUTPUTS];
 
+// Published read-only copies. Readers pin a slot; writers fill a slot that is
+// neither published nor pinned and then swap the published index.
+static OutputConfig_t snapshots[MAX_OUTPUTS][OUTPUT_SNAPSHOT_SLOTS];
+static uint8_t publishedSlot[MAX_OUTPUTS];
+static uint8_t slotReaders[MAX_OUTPUTS][OUTPUT_SNAPSHOT_SLOTS];
+static uint32_t snapshotVersion[MAX_OUTPUTS];
+static uint32_t publishSkips = 0;
+static bool publishing = false;   // Claimed by whoever is filling a slot (lock holder or safe hold)
+
+// Last state sent on the event bus (change detection)
+#define POWER_EVENT_MIN_MS 1000   // Power-only changes (PID jitter) at most 1/s
+static OutputEvent_t lastEvent[MAX_OUTPUTS];
+static bool eventSent[MAX_OUTPUTS];
+static unsigned long lastPowerEvent[MAX_OUTPUTS];
+
 // Hardware objects
 static dimmerLamp* dimmer1 = nullptr;  // Output 1 (AC dimmer)
 
+// Power actually driven (SSR is 0 or 100) - what the thermal model learns from
+static int appliedPower[MAX_OUTPUTS];
+
+// Thermal model bookkeeping
+#define MODEL_MAX_GAP_SEC 5.0f                          // Longer update gaps restart the sample
+#define MODEL_SAVE_INTERVAL_MS (6UL * 3600UL * 1000UL)  // Persist learned models (flash wear)
+static unsigned long lastControlUpdate = 0;
+static unsigned long lastModelSave = 0;
+
+// Energy counters (kept out of the snapshots - readers copy them under the lock)
+#define ENERGY_SAVE_INTERVAL_MS (3600UL * 1000UL)      // Persist hourly (flash wear vs. loss on power cut)
+#define ENERGY_MAX_TICK_MS 10000UL                      // Longer gaps are stalls, not delivered power
+static EnergyMeter_t energyMeters[MAX_OUTPUTS];
+static unsigned long lastEnergySave = 0;
+
+// Safety hold (set by safety manager in loop() when control/sensor heartbeat
+// stalls, read by the control task)
+static bool safeHold = false;
+
+// Serializes config changes (web/MQTT/display) against the control task.
+// Recursive so public setters can call each other. Releasing the outermost
+// lock publishes fresh snapshots, so every change becomes visible at once.
+static SemaphoreHandle_t outputMutex = nullptr;
+static int lockDepth = 0;
+
+static void publishSnapshots(void);
+static void publishForcedOff(void);
+static void publishOutputEvent(int index);
+
+class OutputLock {
+public:
+    explicit OutputLock(TickType_t wait = portMAX_DELAY) {
+        held = !outputMutex || xSemaphoreTakeRecursive(outputMutex, wait) == pdTRUE;
+        if (held) lockDepth++;
+    }
+    ~OutputLock() {
+        if (!held) return;
+        if (--lockDepth == 0) publishSnapshots();
+        if (outputMutex) xSemaphoreGiveRecursive(outputMutex);
+    }
+    bool isHeld() const { return held; }
+private:
+    bool held;
+};
+
 // Default safety limits
 #define DEFAULT_MAX_TEMP_C 40.0f
 #define DEFAULT_MIN_TEMP_C 5.0f
@@ -35,13 +106,24 @@ static dimmerLamp* dimmer1 = nullptr;  // Output 1 (AC dimmer)
 // Forward declarations
 static void updateOutput(int index);
 static void updatePID(int index);
+static float computePID(int index, float dt);
+static void resetPidState(int index, bool bumpless);
 static void updateTimeProp(int index);
+static void applyTimePropDuty(int index, unsigned long now);
 static void resetTimePropState(int index);
+static void updateCascade(int index);
+static void resetCascadeState(int index, bool bumpless);
+static void updateHumidity(int index);
+static void resetHumidityState(int index);
 static void updateSchedule(int index);
 static void setOutputPower(int index, int power);
 static void checkSensorHealth(int index);
 static void checkTemperatureLimits(int index);
 static void handleFaultState(int index);
+static void saveThermalModels(Preferences& prefs);
+static void updateEnergy(int index, uint32_t elapsedMs);
+static void rollEnergyBuckets(void);
+static void saveEnergyMeters(Preferences& prefs);
 
 /**
  * Initialize output manager
@@ -49,6 +131,10 @@ static void handleFaultState(int index);
 void output_manager_init(void) {
     Serial.println("[OutputMgr] Initializing...");
 
+    if (!outputMutex) {
+        outputMutex = xSemaphoreCreateRecursiveMutex();
+    }
+
     // Clear output array
     memset(outputs, 0, sizeof(outputs));
 
@@ -74,6 +160,27 @@ void output_manager_init(void) {
         outputs[i].timePropCycleStart = 0;
         outputs[i].timePropCurrentState = false;
         outputs[i].timePropDutyCycle = 0.0f;
+
+        // Cascade defaults
+        cascade_default_params(&outputs[i].cascade);
+        outputs[i].surfaceTemp = -127.0f;
+
+        outputs[i].pidSetpointWeight = 1.0f;
+
+        // Energy accounting
+        energy_meter_reset(&energyMeters[i]);
+
+        // Humidity defaults (conservative mister limits)
+        humidity_default_params(&outputs[i].humidity);
+        humidity_reset(&outputs[i].humidity, &outputs[i].humidityState);
+        outputs[i].currentHumidity = NAN;
+
+        // Gain schedule off: fixed gains, no feedforward
+        gain_schedule_init(&outputs[i].gainSchedule);
+        outputs[i].ambientTemp = -127.0f;
+        outputs[i].pidState.load = NAN;
+
+        thermal_model_init(&outputs[i].thermalModel);
     }
 
     // Initialize Output 1 (AC Dimmer for lights)
@@ -135,24 +242,75 @@ void output_manager_init(void) {
 }
 
 /**
- * Get output configuration
+ * Pin the current snapshot of an output
  */
-OutputConfig_t* output_manager_get_output(int outputIndex) {
+const OutputConfig_t* output_manager_snapshot_acquire(int outputIndex) {
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return nullptr;
     }
-    return &outputs[outputIndex];
+
+    for (;;) {
+        uint8_t slot = __atomic_load_n(&publishedSlot[outputIndex], __ATOMIC_ACQUIRE);
+        __atomic_add_fetch(&slotReaders[outputIndex][slot], 1, __ATOMIC_ACQ_REL);
+
+        // Still published after pinning: a writer can no longer pick this slot
+        if (__atomic_load_n(&publishedSlot[outputIndex], __ATOMIC_ACQUIRE) == slot) {
+            return &snapshots[outputIndex][slot];
+        }
+        __atomic_sub_fetch(&slotReaders[outputIndex][slot], 1, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * Unpin a snapshot
+ */
+void output_manager_snapshot_release(int outputIndex, const OutputConfig_t* snapshot) {
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS || !snapshot) {
+        return;
+    }
+    int slot = snapshot - snapshots[outputIndex];
+    if (slot >= 0 && slot < OUTPUT_SNAPSHOT_SLOTS) {
+        __atomic_sub_fetch(&slotReaders[outputIndex][slot], 1, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * Get snapshot version
+ */
+uint32_t output_manager_get_version(int outputIndex) {
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
+        return 0;
+    }
+    return __atomic_load_n(&snapshotVersion[outputIndex], __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Get number of skipped publishes
+ */
+uint32_t output_manager_get_publish_skips(void) {
+    return publishSkips;
 }
 
 /**
  * Update output control loop
  */
 void output_manager_update(void) {
+    OutputLock lock;
+    unsigned long now = millis();
+    unsigned long elapsedMs = lastControlUpdate ? now - lastControlUpdate : 0;
+    float dt = elapsedMs / 1000.0f;
+    lastControlUpdate = now;
+
     for (int i = 0; i < MAX_OUTPUTS; i++) {
+        // Count what was delivered since the last tick, before the power changes
+        updateEnergy(i, elapsedMs);
+
         // Always update current temperature from sensor (even if disabled)
         const SensorInfo_t* sensor = sensor_manager_get_sensor_by_address(outputs[i].sensorAddress);
+        outputs[i].currentHumidity = NAN;
         if (sensor && sensor->discovered) {
             outputs[i].currentTemp = sensor->lastReading;
+            outputs[i].currentHumidity = sensor->lastHumidity;
 
             // Track valid readings for fault recovery
             if (sensor_manager_is_valid_temp(outputs[i].currentTemp)) {
@@ -166,7 +324,28 @@ void output_manager_update(void) {
             outputs[i].currentTemp = -127.0f;
         }
 
-        if (outputs[i].enabled) {
+        // Surface sensor (cascade inner loop) - invalid when unassigned so
+        // cascade mode never runs without it
+        const SensorInfo_t* surface = nullptr;
+        if (outputs[i].surfaceSensorAddress[0] != '\0') {
+            surface = sensor_manager_get_sensor_by_address(outputs[i].surfaceSensorAddress);
+        }
+        outputs[i].surfaceTemp = (surface && surface->discovered) ? surface->lastReading : -127.0f;
+
+        // Room sensor (gain schedule / feedforward) - optional, the thermal
+        // model's estimate stands in without it
+        const SensorInfo_t* ambient = nullptr;
+        if (outputs[i].ambientSensorAddress[0] != '\0') {
+            ambient = sensor_manager_get_sensor_by_address(outputs[i].ambientSensorAddress);
+        }
+        outputs[i].ambientTemp = (ambient && ambient->discovered) ? ambient->lastReading : -127.0f;
+
+        if (__atomic_load_n(&safeHold, __ATOMIC_ACQUIRE)) {
+            // Supervisor has forced outputs off
+            setOutputPower(i, 0);
+            outputs[i].currentPower = 0;
+            outputs[i].heating = false;
+        } else if (outputs[i].enabled) {
             // Check sensor health first
             checkSensorHealth(i);
 
@@ -186,7 +365,60 @@ void output_manager_update(void) {
             outputs[i].currentPower = 0;
             outputs[i].heating = false;
         }
+
+        // Learn heat-up/cool-down from what was actually applied (off time
+        // teaches cooling, so this runs in every mode)
+        if (sensor_manager_is_valid_temp(outputs[i].currentTemp) &&
+            outputs[i].faultState == FAULT_NONE && dt < MODEL_MAX_GAP_SEC) {
+            thermal_model_update(&outputs[i].thermalModel, outputs[i].currentTemp, appliedPower[i], dt);
+        } else {
+            thermal_model_break(&outputs[i].thermalModel);
+        }
+    }
+
+    if (now - lastModelSave >= MODEL_SAVE_INTERVAL_MS) {
+        lastModelSave = now;
+        Preferences prefs;
+        saveThermalModels(prefs);
     }
+
+    rollEnergyBuckets();
+    if (now - lastEnergySave >= ENERGY_SAVE_INTERVAL_MS) {
+        lastEnergySave = now;
+        Preferences prefs;
+        saveEnergyMeters(prefs);
+    }
+
+    safety_manager_heartbeat(HEARTBEAT_CONTROL);
+}
+
+/**
+ * Force all outputs off (or release)
+ */
+void output_manager_set_safe_hold(bool hold) {
+    __atomic_store_n(&safeHold, hold, __ATOMIC_RELEASE);
+    if (!hold) {
+        return;
+    }
+
+    // Don't wait for the next update - it may be the thing that stalled
+    for (int i = 0; i < MAX_OUTPUTS; i++) {
+        setOutputPower(i, 0);
+    }
+
+    // Publish it as off now. Holding the lock, releasing it does that; without
+    // it (the control task may be stalled holding it) write free slots directly.
+    OutputLock lock(0);
+    if (!lock.isHeld()) {
+        publishForcedOff();
+    }
+}
+
+/**
+ * Check safety hold
+ */
+bool output_manager_is_safe_hold(void) {
+    return __atomic_load_n(&safeHold, __ATOMIC_ACQUIRE);
 }
 
 /**
@@ -260,6 +492,30 @@ static void updateOutput(int index) {
                 output->heating = false;
             }
             break;
+
+        case CONTROL_MODE_CASCADE:
+            // Needs both loops' sensors - no surface reading means no ceiling
+            if (sensor_manager_is_valid_temp(output->currentTemp) &&
+                sensor_manager_is_valid_temp(output->surfaceTemp)) {
+                updateCascade(index);
+                output->lastValidPower = output->currentPower;  // Track for fault recovery
+            } else {
+                setOutputPower(index, 0);
+                output->currentPower = 0;
+                output->heating = false;
+            }
+            break;
+
+        case CONTROL_MODE_HUMIDITY:
+            if (sensor_manager_is_valid_humidity(output->currentHumidity)) {
+                updateHumidity(index);
+                output->lastValidPower = output->currentPower;  // Track for fault recovery
+            } else {
+                setOutputPower(index, 0);
+                output->currentPower = 0;
+                output->heating = false;
+            }
+            break;
     }
 }
 
@@ -276,37 +532,7 @@ static void updatePID(int index) {
         return;  // Too soon, wait for more time
     }
 
-    // Calculate error
-    float error = output->targetTemp - output->currentTemp;
-
-    // Proportional term
-    float P = output->pidKp * error;
-
-    // Integral term
-    output->pidIntegral += error * dt;
-    // Anti-windup
-    if (output->pidIntegral > PID_INTEGRAL_MAX) {
-        output->pidIntegral = PID_INTEGRAL_MAX;
-    } else if (output->pidIntegral < -PID_INTEGRAL_MAX) {
-        output->pidIntegral = -PID_INTEGRAL_MAX;
-    }
-    float I = output->pidKi * output->pidIntegral;
-
-    // Derivative term
-    float D = 0.0f;
-    if (dt > 0.0f) {
-        D = output->pidKd * (error - output->pidLastError) / dt;
-    }
-
-    // Calculate output
-    float pidOutput = P + I + D;
-
-    // Clamp output
-    if (pidOutput < PID_OUTPUT_MIN) {
-        pidOutput = PID_OUTPUT_MIN;
-    } else if (pidOutput > PID_OUTPUT_MAX) {
-        pidOutput = PID_OUTPUT_MAX;
-    }
+    float pidOutput = computePID(index, dt);
 
     // Set power
     int power = (int)pidOutput;
@@ -314,11 +540,51 @@ static void updatePID(int index) {
     output->currentPower = power;
     output->heating = (power > 5);  // Consider heating if power > 5%
 
-    // Update state
-    output->pidLastError = error;
     output->pidLastTime = now;
 }
 
+/**
+ * One PID step on the air sensor, shared by PID, time-prop and schedule modes
+ * (see pid_control.h). Ambient is the room sensor, else the model's
+ * zero-power equilibrium.
+ * @return Output % (PID_OUTPUT_MIN-PID_OUTPUT_MAX)
+ */
+static float computePID(int index, float dt) {
+    OutputConfig_t* output = &outputs[index];
+
+    PidControlParams_t params;
+    params.kp = output->pidKp;
+    params.ki = output->pidKi;
+    params.kd = output->pidKd;
+    params.setpointWeight = output->pidSetpointWeight;
+    params.outMin = PID_OUTPUT_MIN;
+    params.outMax = PID_OUTPUT_MAX;
+    params.integralMax = PID_INTEGRAL_MAX;
+    params.maxGapSec = PID_MAX_GAP_SEC;
+    params.schedule = &output->gainSchedule;
+
+    float ambient = NAN;
+    if (sensor_manager_is_valid_temp(output->ambientTemp)) {
+        ambient = output->ambientTemp;
+    } else if (thermal_model_valid(&output->thermalModel)) {
+        ambient = thermal_model_equilibrium(&output->thermalModel, 0.0f);
+    }
+
+    return pid_control_step(&params, &output->pidState, output->targetTemp, output->currentTemp,
+                            ambient, output->currentPower, dt);
+}
+
+/**
+ * Restart the PID
+ * Bumpless: the next step sets the integral so the output carries on from
+ * currentPower. Otherwise the integral starts from zero.
+ */
+static void resetPidState(int index, bool bumpless) {
+    OutputConfig_t* output = &outputs[index];
+    pid_control_reset(&output->pidState, bumpless);
+    output->pidLastTime = millis();
+}
+
 /**
  * Reset time-proportional cycle state
  */
@@ -338,41 +604,23 @@ static void updateTimeProp(int index) {
     OutputConfig_t* output = &outputs[index];
     unsigned long now = millis();
 
-    // Calculate cycle duration in milliseconds
-    unsigned long cycleDurationMs = (unsigned long)output->timePropCycleSec * 1000UL;
-
     // Always run PID calculation (every ~100ms update) for responsive control
     float dt = (now - output->pidLastTime) / 1000.0f;
     if (dt >= 0.1f) {
-        float error = output->targetTemp - output->currentTemp;
-
-        // Proportional
-        float P = output->pidKp * error;
-
-        // Integral with anti-windup
-        output->pidIntegral += error * dt;
-        if (output->pidIntegral > PID_INTEGRAL_MAX) {
-            output->pidIntegral = PID_INTEGRAL_MAX;
-        } else if (output->pidIntegral < -PID_INTEGRAL_MAX) {
-            output->pidIntegral = -PID_INTEGRAL_MAX;
-        }
-        float I = output->pidKi * output->pidIntegral;
-
-        // Derivative
-        float D = 0.0f;
-        if (dt > 0.0f) {
-            D = output->pidKd * (error - output->pidLastError) / dt;
-        }
-
-        // Calculate and clamp duty cycle
-        output->timePropDutyCycle = P + I + D;
-        if (output->timePropDutyCycle < 0) output->timePropDutyCycle = 0;
-        if (output->timePropDutyCycle > 100) output->timePropDutyCycle = 100;
-
-        output->pidLastError = error;
+        output->timePropDutyCycle = computePID(index, dt);
         output->pidLastTime = now;
     }
 
+    applyTimePropDuty(index, now);
+}
+
+/**
+ * Drive the output with timed ON/OFF cycles at timePropDutyCycle
+ */
+static void applyTimePropDuty(int index, unsigned long now) {
+    OutputConfig_t* output = &outputs[index];
+    unsigned long cycleDurationMs = (unsigned long)output->timePropCycleSec * 1000UL;
+
     // Check if we need to start a new cycle (separate from PID calculation)
     if (output->timePropCycleStart == 0 || (now - output->timePropCycleStart >= cycleDurationMs)) {
         output->timePropCycleStart = now;
@@ -417,15 +665,77 @@ static void updateTimeProp(int index) {
     output->timePropCurrentState = shouldBeOn;
 }
 
+/**
+ * Restart the cascade loops
+ * Bumpless: the next update holds the surface where it is and carries on
+ * from currentPower. Otherwise both integrals start from zero.
+ */
+static void resetCascadeState(int index, bool bumpless) {
+    cascade_reset(&outputs[index].cascadeState, bumpless);
+    outputs[index].cascadeLastTime = millis();
+}
+
+/**
+ * Update cascade control
+ * Outer loop (air) and inner loop (surface) run at their own periods
+ * inside cascade_update(); this feeds it elapsed time and applies power.
+ */
+static void updateCascade(int index) {
+    OutputConfig_t* output = &outputs[index];
+    unsigned long now = millis();
+    float dt = (now - output->cascadeLastTime) / 1000.0f;
+    output->cascadeLastTime = now;
+
+    float power = cascade_update(&output->cascade, &output->cascadeState,
+                                 output->targetTemp, output->currentTemp, output->surfaceTemp,
+                                 output->pidSetpointWeight, output->currentPower, dt);
+
+    if (output->hardwareType == HARDWARE_SSR) {
+        // SSR is on/off - spread the power over time-prop cycles
+        output->timePropDutyCycle = power;
+        applyTimePropDuty(index, now);
+    } else {
+        setOutputPower(index, (int)power);
+        output->currentPower = (int)power;
+        output->heating = (power > 5.0f);
+    }
+}
+
+/**
+ * Reset humidity control state (off, full duty budget)
+ */
+static void resetHumidityState(int index) {
+    humidity_reset(&outputs[index].humidity, &outputs[index].humidityState);
+    outputs[index].humidityLastTime = millis();
+}
+
+/**
+ * Update humidity control
+ * The fogger/mister is switched fully on or off; power shows the duty the
+ * controller is asking for.
+ */
+static void updateHumidity(int index) {
+    OutputConfig_t* output = &outputs[index];
+    unsigned long now = millis();
+    float dt = (now - output->humidityLastTime) / 1000.0f;
+    output->humidityLastTime = now;
+
+    bool on = humidity_update(&output->humidity, &output->humidityState,
+                              output->currentHumidity, dt);
+    setOutputPower(index, on ? 100 : 0);
+    output->currentPower = (int)output->humidityState.duty;
+    output->heating = on;
+}
+
 /**
  * Update schedule control
  */
 static void updateSchedule(int index) {
     OutputConfig_t* output = &outputs[index];
 
-    // Get current time
+    // Cached local time (no wait when the clock isn't set)
     struct tm timeinfo;
-    if (!getLocalTime(&timeinfo)) {
+    if (!time_service_get_local(&timeinfo)) {
         // Time not set, default to manual mode behavior
         setOutputPower(index, output->manualPower);
         output->currentPower = output->manualPower;
@@ -436,9 +746,12 @@ static void updateSchedule(int index) {
     int currentMinute = timeinfo.tm_min;
     int currentTotalMinutes = currentHour * 60 + currentMinute;
 
-    // Find active schedule slot
+    // Find active slot (latest start, wrapping to yesterday's last slot
+    // before the first one of the day) and the next slot
     int activeSlot = -1;
-    int minDiff = 24 * 60;  // Max difference in minutes
+    int nextSlot = -1;
+    int minSince = 24 * 60;
+    int minUntil = 24 * 60 + 1;
 
     for (int i = 0; i < MAX_SCHEDULE_SLOTS; i++) {
         if (!output->schedule[i].enabled) {
@@ -446,17 +759,32 @@ static void updateSchedule(int index) {
         }
 
         int slotTotalMinutes = output->schedule[i].hour * 60 + output->schedule[i].minute;
-        int diff = currentTotalMinutes - slotTotalMinutes;
+        int since = (currentTotalMinutes - slotTotalMinutes + 24 * 60) % (24 * 60);
+        int until = 24 * 60 - since;  // Slot starting now is next due tomorrow
 
-        if (diff >= 0 && diff < minDiff) {
-            minDiff = diff;
+        if (since < minSince) {
+            minSince = since;
             activeSlot = i;
         }
+        if (until < minUntil) {
+            minUntil = until;
+            nextSlot = i;
+        }
     }
 
     if (activeSlot >= 0) {
         // Apply schedule target temperature
-        output->targetTemp = output->schedule[activeSlot].targetTemp;
+        output->scheduleSlotTarget = output->schedule[activeSlot].targetTemp;
+        output->targetTemp = output->scheduleSlotTarget;
+
+        // Preheat: ramp ahead of an upward change so it is met on time
+        if (output->schedulePredictive && nextSlot >= 0) {
+            float minutesToNext = minUntil - timeinfo.tm_sec / 60.0f;
+            output->targetTemp = thermal_model_ramp_setpoint(&output->thermalModel,
+                                                             output->scheduleSlotTarget,
+                                                             output->schedule[nextSlot].targetTemp,
+                                                             minutesToNext);
+        }
         // Use PID to reach target
         if (sensor_manager_is_valid_temp(output->currentTemp)) {
             updatePID(index);
@@ -479,6 +807,9 @@ static void updateSchedule(int index) {
 static void setOutputPower(int index, int power) {
     if (power < 0) power = 0;
     if (power > 100) power = 100;
+    if (index >= 0 && index < MAX_OUTPUTS) {
+        appliedPower[index] = (index == 0) ? power : (power > 50 ? 100 : 0);
+    }
 
     switch (index) {
         case 0:
@@ -504,9 +835,13 @@ static void setOutputPower(int index, int power) {
  * Set output enabled
  */
 void output_manager_set_enabled(int outputIndex, bool enabled) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return;
     }
+    if (enabled && !outputs[outputIndex].enabled) {
+        resetPidState(outputIndex, false);   // Integral is stale after a disabled spell
+    }
     outputs[outputIndex].enabled = enabled;
     if (!enabled) {
         setOutputPower(outputIndex, 0);
@@ -518,6 +853,7 @@ void output_manager_set_enabled(int outputIndex, bool enabled) {
  * Set output name
  */
 void output_manager_set_name(int outputIndex, const char* name) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS || !name) {
         return;
     }
@@ -529,6 +865,7 @@ void output_manager_set_name(int outputIndex, const char* name) {
  * Set hardware type (with restrictions)
  */
 bool output_manager_set_hardware_type(int outputIndex, HardwareType_t hardwareType) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return false;
     }
@@ -554,6 +891,7 @@ bool output_manager_set_hardware_type(int outputIndex, HardwareType_t hardwareTy
  * Set device type (with compatibility check)
  */
 bool output_manager_set_device_type(int outputIndex, DeviceType_t deviceType) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return false;
     }
@@ -571,20 +909,30 @@ bool output_manager_set_device_type(int outputIndex, DeviceType_t deviceType) {
  * Set control mode
  */
 void output_manager_set_mode(int outputIndex, ControlMode_t mode) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return;
     }
+    ControlMode_t previous = outputs[outputIndex].controlMode;
+    if (mode == previous) {
+        return;   // Re-applying the same mode must not disturb the loop
+    }
     outputs[outputIndex].controlMode = mode;
 
-    // Reset PID state when changing modes
-    outputs[outputIndex].pidIntegral = 0.0f;
-    outputs[outputIndex].pidLastError = 0.0f;
-    outputs[outputIndex].pidLastTime = millis();
+    // PID and cascade pick up from the power the previous mode was
+    // delivering (bumpless); from Off there is nothing to continue
+    resetPidState(outputIndex, previous != CONTROL_MODE_OFF);
 
     // Reset time-prop state when entering that mode
-    if (mode == CONTROL_MODE_TIME_PROP) {
+    if (mode == CONTROL_MODE_TIME_PROP || mode == CONTROL_MODE_CASCADE) {
         resetTimePropState(outputIndex);
     }
+    if (mode == CONTROL_MODE_CASCADE) {
+        resetCascadeState(outputIndex, previous != CONTROL_MODE_OFF);
+    }
+    if (mode == CONTROL_MODE_HUMIDITY) {
+        resetHumidityState(outputIndex);
+    }
 
     console_add_event_f(CONSOLE_EVENT_SYSTEM, "Output %d mode: %s",
                        outputIndex + 1, output_manager_get_mode_name(mode));
@@ -594,6 +942,7 @@ void output_manager_set_mode(int outputIndex, ControlMode_t mode) {
  * Set target temperature
  */
 void output_manager_set_target(int outputIndex, float targetTemp) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return;
     }
@@ -604,6 +953,7 @@ void output_manager_set_target(int outputIndex, float targetTemp) {
  * Set manual power
  */
 void output_manager_set_manual_power(int outputIndex, int power) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return;
     }
@@ -616,6 +966,7 @@ void output_manager_set_manual_power(int outputIndex, int power) {
  * Assign sensor to output
  */
 void output_manager_set_sensor(int outputIndex, const char* sensorAddress) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS || !sensorAddress) {
         return;
     }
@@ -629,6 +980,7 @@ void output_manager_set_sensor(int outputIndex, const char* sensorAddress) {
  * Set PID parameters
  */
 void output_manager_set_pid_params(int outputIndex, float kp, float ki, float kd) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return;
     }
@@ -636,8 +988,20 @@ void output_manager_set_pid_params(int outputIndex, float kp, float ki, float kd
     outputs[outputIndex].pidKi = ki;
     outputs[outputIndex].pidKd = kd;
 
-    // Reset integral
-    outputs[outputIndex].pidIntegral = 0.0f;
+    // Bumpless: the integral absorbs the change in P
+    resetPidState(outputIndex, true);
+}
+
+/**
+ * Set setpoint weight
+ */
+void output_manager_set_setpoint_weight(int outputIndex, float weight) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
+        return;
+    }
+    outputs[outputIndex].pidSetpointWeight = constrain(weight, 0.0f, 1.0f);
+    resetPidState(outputIndex, true);
 }
 
 /**
@@ -645,6 +1009,7 @@ void output_manager_set_pid_params(int outputIndex, float kp, float ki, float kd
  */
 void output_manager_set_time_prop_params(int outputIndex, uint8_t cycleSec,
                                           uint8_t minOnSec, uint8_t minOffSec) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return;
     }
@@ -668,11 +1033,104 @@ void output_manager_set_time_prop_params(int outputIndex, uint8_t cycleSec,
     resetTimePropState(outputIndex);
 }
 
+/**
+ * Assign surface sensor
+ */
+void output_manager_set_surface_sensor(int outputIndex, const char* sensorAddress) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS || !sensorAddress) {
+        return;
+    }
+    OutputConfig_t* output = &outputs[outputIndex];
+    strncpy(output->surfaceSensorAddress, sensorAddress, sizeof(output->surfaceSensorAddress) - 1);
+    output->surfaceSensorAddress[sizeof(output->surfaceSensorAddress) - 1] = '\0';
+    resetCascadeState(outputIndex, true);
+
+    console_add_event_f(CONSOLE_EVENT_SYSTEM, "Output %d surface sensor %s", outputIndex + 1,
+                        sensorAddress[0] ? "assigned" : "cleared");
+}
+
+/**
+ * Set cascade control parameters
+ */
+void output_manager_set_cascade_params(int outputIndex, const CascadeParams_t* params) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS || !params) {
+        return;
+    }
+    CascadeParams_t p = *params;
+
+    // Outer output is a surface offset above the air target
+    p.outer.outMin = constrain(p.outer.outMin, 0.0f, CASCADE_OFFSET_LIMIT);
+    p.outer.outMax = constrain(p.outer.outMax, p.outer.outMin, CASCADE_OFFSET_LIMIT);
+
+    // Inner output is power %
+    p.inner.outMin = constrain(p.inner.outMin, 0.0f, 100.0f);
+    p.inner.outMax = constrain(p.inner.outMax, p.inner.outMin, 100.0f);
+
+    p.surfaceMaxC = constrain(p.surfaceMaxC, 20.0f, CASCADE_SURFACE_MAX_LIMIT);
+
+    // Inner loop must be at least as fast as the outer one
+    p.outerPeriodSec = constrain(p.outerPeriodSec, 2.0f, 120.0f);
+    p.innerPeriodSec = constrain(p.innerPeriodSec, 0.5f, p.outerPeriodSec);
+
+    outputs[outputIndex].cascade = p;
+    resetCascadeState(outputIndex, true);
+}
+
+/**
+ * Set humidity control parameters
+ */
+void output_manager_set_humidity_params(int outputIndex, const HumidityParams_t* params) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS || !params) {
+        return;
+    }
+    HumidityParams_t p = *params;
+    humidity_validate_params(&p);
+    outputs[outputIndex].humidity = p;
+    resetHumidityState(outputIndex);
+}
+
+/**
+ * Assign room ambient sensor
+ */
+void output_manager_set_ambient_sensor(int outputIndex, const char* sensorAddress) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS || !sensorAddress) {
+        return;
+    }
+    OutputConfig_t* output = &outputs[outputIndex];
+    strncpy(output->ambientSensorAddress, sensorAddress, sizeof(output->ambientSensorAddress) - 1);
+    output->ambientSensorAddress[sizeof(output->ambientSensorAddress) - 1] = '\0';
+
+    console_add_event_f(CONSOLE_EVENT_SYSTEM, "Output %d ambient sensor %s", outputIndex + 1,
+                        sensorAddress[0] ? "assigned" : "cleared");
+}
+
+/**
+ * Set gain schedule and feedforward
+ */
+void output_manager_set_gain_schedule(int outputIndex, const GainSchedule_t* schedule) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS || !schedule) {
+        return;
+    }
+    GainSchedule_t gs = *schedule;
+    gain_schedule_prepare(&gs);
+
+    outputs[outputIndex].gainSchedule = gs;
+
+    // Bumpless: the integral absorbs the change in gains and feedforward
+    resetPidState(outputIndex, true);
+}
+
 /**
  * Set schedule slot
  */
 bool output_manager_set_schedule_slot(int outputIndex, int slotIndex,
                                       bool enabled, uint8_t hour, uint8_t minute, float targetTemp) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return false;
     }
@@ -691,10 +1149,43 @@ bool output_manager_set_schedule_slot(int outputIndex, int slotIndex,
     return true;
 }
 
+/**
+ * Enable predictive schedule preheat
+ */
+void output_manager_set_schedule_predictive(int outputIndex, bool enabled) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
+        return;
+    }
+    outputs[outputIndex].schedulePredictive = enabled;
+}
+
+/**
+ * Forget the learned thermal model
+ */
+void output_manager_reset_thermal_model(int outputIndex) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
+        return;
+    }
+    thermal_model_init(&outputs[outputIndex].thermalModel);
+
+    // Don't bring the old fit back on the next boot
+    Preferences prefs;
+    char namespace_name[16];
+    snprintf(namespace_name, sizeof(namespace_name), "output%d", outputIndex + 1);
+    prefs.begin(namespace_name, false);
+    prefs.remove("tmSamples");
+    prefs.end();
+
+    console_add_event_f(CONSOLE_EVENT_SYSTEM, "Output %d thermal model reset", outputIndex + 1);
+}
+
 /**
  * Load configuration from preferences
  */
 void output_manager_load_config(void) {
+    OutputLock lock;
     Preferences prefs;
 
     for (int i = 0; i < MAX_OUTPUTS; i++) {
@@ -724,12 +1215,65 @@ void output_manager_load_config(void) {
         outputs[i].pidKp = prefs.getFloat("pidKp", outputs[i].pidKp);
         outputs[i].pidKi = prefs.getFloat("pidKi", outputs[i].pidKi);
         outputs[i].pidKd = prefs.getFloat("pidKd", outputs[i].pidKd);
+        outputs[i].pidSetpointWeight = prefs.getFloat("pidSpWeight", 1.0f);
 
         // Load time-proportional params
         outputs[i].timePropCycleSec = prefs.getUChar("tpCycleSec", 30);
         outputs[i].timePropMinOnSec = prefs.getUChar("tpMinOnSec", 1);
         outputs[i].timePropMinOffSec = prefs.getUChar("tpMinOffSec", 1);
 
+        // Load cascade params
+        String surfaceSensor = prefs.getString("surfSensor", "");
+        if (surfaceSensor.length() > 0) {
+            strncpy(outputs[i].surfaceSensorAddress, surfaceSensor.c_str(), sizeof(outputs[i].surfaceSensorAddress) - 1);
+        }
+        CascadeParams_t* cp = &outputs[i].cascade;
+        cp->outer.kp = prefs.getFloat("csOutKp", cp->outer.kp);
+        cp->outer.ki = prefs.getFloat("csOutKi", cp->outer.ki);
+        cp->outer.kd = prefs.getFloat("csOutKd", cp->outer.kd);
+        cp->outer.outMin = prefs.getFloat("csOutMin", cp->outer.outMin);
+        cp->outer.outMax = prefs.getFloat("csOutMax", cp->outer.outMax);
+        cp->inner.kp = prefs.getFloat("csInKp", cp->inner.kp);
+        cp->inner.ki = prefs.getFloat("csInKi", cp->inner.ki);
+        cp->inner.kd = prefs.getFloat("csInKd", cp->inner.kd);
+        cp->inner.outMin = prefs.getFloat("csInMin", cp->inner.outMin);
+        cp->inner.outMax = prefs.getFloat("csInMax", cp->inner.outMax);
+        cp->surfaceMaxC = prefs.getFloat("csSurfMaxC", cp->surfaceMaxC);
+        cp->outerPeriodSec = prefs.getFloat("csOutSec", cp->outerPeriodSec);
+        cp->innerPeriodSec = prefs.getFloat("csInSec", cp->innerPeriodSec);
+        cascade_reset(&outputs[i].cascadeState, false);
+
+        // Load humidity params
+        HumidityParams_t* hp = &outputs[i].humidity;
+        hp->targetRh = prefs.getFloat("rhTarget", hp->targetRh);
+        hp->method = (HumidityMethod_t)prefs.getUChar("rhMethod", hp->method);
+        hp->hysteresisRh = prefs.getFloat("rhHyst", hp->hysteresisRh);
+        hp->bandRh = prefs.getFloat("rhBand", hp->bandRh);
+        hp->cycleSec = prefs.getUShort("rhCycleSec", hp->cycleSec);
+        hp->minOnSec = prefs.getUShort("rhMinOnSec", hp->minOnSec);
+        hp->minOffSec = prefs.getUShort("rhMinOffSec", hp->minOffSec);
+        hp->maxOnSec = prefs.getUShort("rhMaxOnSec", hp->maxOnSec);
+        hp->maxDutyPct = prefs.getUChar("rhMaxDuty", hp->maxDutyPct);
+        hp->dutyWindowMin = prefs.getUShort("rhWindowMin", hp->dutyWindowMin);
+        humidity_validate_params(hp);
+        humidity_reset(hp, &outputs[i].humidityState);
+
+        // Load gain schedule
+        String ambientSensor = prefs.getString("ambSensor", "");
+        if (ambientSensor.length() > 0) {
+            strncpy(outputs[i].ambientSensorAddress, ambientSensor.c_str(), sizeof(outputs[i].ambientSensorAddress) - 1);
+        }
+        GainSchedule_t* gs = &outputs[i].gainSchedule;
+        gs->enabled = prefs.getBool("gsEnabled", false);
+        gs->ffGain = prefs.getFloat("gsFf", 0.0f);
+        gs->count = prefs.getUChar("gsCount", 0);
+        if (prefs.getBytesLength("gsPoints") == sizeof(gs->points)) {
+            prefs.getBytes("gsPoints", gs->points, sizeof(gs->points));
+        } else {
+            gs->count = 0;
+        }
+        gain_schedule_prepare(gs);
+
         // Load safety settings
         outputs[i].maxTempC = prefs.getFloat("maxTempC", DEFAULT_MAX_TEMP_C);
         outputs[i].minTempC = prefs.getFloat("minTempC", DEFAULT_MIN_TEMP_C);
@@ -738,7 +1282,25 @@ void output_manager_load_config(void) {
         outputs[i].capPowerPct = prefs.getUChar("capPowerPct", DEFAULT_CAP_POWER_PCT);
         outputs[i].autoResumeOnSensorOk = prefs.getBool("autoResume", false);
 
+        // Load energy rating and counters (a blob from another layout starts over)
+        outputs[i].ratedWatts = prefs.getUShort("ratedW", 0);
+        if (prefs.getBytesLength("energy") == sizeof(EnergyMeter_t)) {
+            EnergyMeter_t meter;
+            prefs.getBytes("energy", &meter, sizeof(meter));
+            if (meter.version == ENERGY_METER_VERSION) {
+                energyMeters[i] = meter;
+                outputs[i].energyKwh = (float)energy_meter_total_kwh(&meter);
+            }
+        }
+
         // Load schedule
+        outputs[i].schedulePredictive = prefs.getBool("schPredict", false);
+        uint32_t modelSamples = prefs.getUInt("tmSamples", 0);
+        if (modelSamples > 0) {
+            thermal_model_restore(&outputs[i].thermalModel, prefs.getFloat("tmHeat", 0.0f),
+                                  prefs.getFloat("tmLoss", 0.0f), prefs.getFloat("tmBias", 0.0f),
+                                  modelSamples);
+        }
         for (int j = 0; j < MAX_SCHEDULE_SLOTS; j++) {
             char key[16];
             snprintf(key, sizeof(key), "sch%d_en", j);
@@ -764,6 +1326,7 @@ void output_manager_load_config(void) {
  * Save configuration to preferences
  */
 void output_manager_save_config(void) {
+    OutputLock lock;
     Preferences prefs;
 
     for (int i = 0; i < MAX_OUTPUTS; i++) {
@@ -785,12 +1348,51 @@ void output_manager_save_config(void) {
         prefs.putFloat("pidKp", outputs[i].pidKp);
         prefs.putFloat("pidKi", outputs[i].pidKi);
         prefs.putFloat("pidKd", outputs[i].pidKd);
+        prefs.putFloat("pidSpWeight", outputs[i].pidSetpointWeight);
 
         // Save time-proportional params
         prefs.putUChar("tpCycleSec", outputs[i].timePropCycleSec);
         prefs.putUChar("tpMinOnSec", outputs[i].timePropMinOnSec);
         prefs.putUChar("tpMinOffSec", outputs[i].timePropMinOffSec);
 
+        // Save cascade params
+        const CascadeParams_t* cp = &outputs[i].cascade;
+        prefs.putString("surfSensor", outputs[i].surfaceSensorAddress);
+        prefs.putFloat("csOutKp", cp->outer.kp);
+        prefs.putFloat("csOutKi", cp->outer.ki);
+        prefs.putFloat("csOutKd", cp->outer.kd);
+        prefs.putFloat("csOutMin", cp->outer.outMin);
+        prefs.putFloat("csOutMax", cp->outer.outMax);
+        prefs.putFloat("csInKp", cp->inner.kp);
+        prefs.putFloat("csInKi", cp->inner.ki);
+        prefs.putFloat("csInKd", cp->inner.kd);
+        prefs.putFloat("csInMin", cp->inner.outMin);
+        prefs.putFloat("csInMax", cp->inner.outMax);
+        prefs.putFloat("csSurfMaxC", cp->surfaceMaxC);
+        prefs.putFloat("csOutSec", cp->outerPeriodSec);
+        prefs.putFloat("csInSec", cp->innerPeriodSec);
+
+        // Save humidity params
+        const HumidityParams_t* hp = &outputs[i].humidity;
+        prefs.putFloat("rhTarget", hp->targetRh);
+        prefs.putUChar("rhMethod", hp->method);
+        prefs.putFloat("rhHyst", hp->hysteresisRh);
+        prefs.putFloat("rhBand", hp->bandRh);
+        prefs.putUShort("rhCycleSec", hp->cycleSec);
+        prefs.putUShort("rhMinOnSec", hp->minOnSec);
+        prefs.putUShort("rhMinOffSec", hp->minOffSec);
+        prefs.putUShort("rhMaxOnSec", hp->maxOnSec);
+        prefs.putUChar("rhMaxDuty", hp->maxDutyPct);
+        prefs.putUShort("rhWindowMin", hp->dutyWindowMin);
+
+        // Save gain schedule
+        const GainSchedule_t* gs = &outputs[i].gainSchedule;
+        prefs.putString("ambSensor", outputs[i].ambientSensorAddress);
+        prefs.putBool("gsEnabled", gs->enabled);
+        prefs.putFloat("gsFf", gs->ffGain);
+        prefs.putUChar("gsCount", gs->count);
+        prefs.putBytes("gsPoints", gs->points, sizeof(gs->points));
+
         // Save safety settings
         prefs.putFloat("maxTempC", outputs[i].maxTempC);
         prefs.putFloat("minTempC", outputs[i].minTempC);
@@ -798,8 +1400,10 @@ void output_manager_save_config(void) {
         prefs.putUChar("faultMode", outputs[i].faultMode);
         prefs.putUChar("capPowerPct", outputs[i].capPowerPct);
         prefs.putBool("autoResume", outputs[i].autoResumeOnSensorOk);
+        prefs.putUShort("ratedW", outputs[i].ratedWatts);
 
         // Save schedule
+        prefs.putBool("schPredict", outputs[i].schedulePredictive);
         for (int j = 0; j < MAX_SCHEDULE_SLOTS; j++) {
             char key[16];
             snprintf(key, sizeof(key), "sch%d_en", j);
@@ -818,10 +1422,123 @@ void output_manager_save_config(void) {
         prefs.end();
     }
 
+    saveThermalModels(prefs);
+    lastModelSave = millis();
+    saveEnergyMeters(prefs);
+    lastEnergySave = millis();
+
     Serial.println("[OutputMgr] Configuration saved");
     console_add_event(CONSOLE_EVENT_SYSTEM, "Output configuration saved");
 }
 
+/**
+ * Persist learned thermal models (only once they are usable)
+ */
+static void saveThermalModels(Preferences& prefs) {
+    for (int i = 0; i < MAX_OUTPUTS; i++) {
+        const ThermalModel_t* model = &outputs[i].thermalModel;
+        if (!thermal_model_valid(model)) {
+            continue;
+        }
+        char namespace_name[16];
+        snprintf(namespace_name, sizeof(namespace_name), "output%d", i + 1);
+
+        prefs.begin(namespace_name, false);
+        prefs.putFloat("tmHeat", model->theta[0]);
+        prefs.putFloat("tmLoss", model->theta[1]);
+        prefs.putFloat("tmBias", model->theta[2]);
+        prefs.putUInt("tmSamples", model->samples);
+        prefs.end();
+    }
+}
+
+/**
+ * Integrate one tick of delivered power
+ * Output 1's dimmer delivers the RMS share of its phase angle; the SSRs
+ * are fully on or off.
+ */
+static void updateEnergy(int index, uint32_t elapsedMs) {
+    OutputConfig_t* output = &outputs[index];
+    uint16_t fraction = (index == 0) ? energy_dimmer_fraction_permille(appliedPower[index])
+                                     : (appliedPower[index] > 0 ? 1000 : 0);
+    if (elapsedMs <= ENERGY_MAX_TICK_MS) {
+        energy_meter_add(&energyMeters[index], output->ratedWatts, fraction, elapsedMs);
+    }
+    output->powerW = output->ratedWatts * fraction / 1000.0f;
+    output->energyKwh = (float)energy_meter_total_kwh(&energyMeters[index]);
+}
+
+/**
+ * Close finished hour/day/month buckets once the clock is set
+ */
+static void rollEnergyBuckets(void) {
+    struct tm timeinfo;
+    if (!time_service_get_local(&timeinfo)) {
+        return;
+    }
+    for (int i = 0; i < MAX_OUTPUTS; i++) {
+        energy_meter_roll(&energyMeters[i], &timeinfo);
+    }
+}
+
+/**
+ * Persist energy counters
+ */
+static void saveEnergyMeters(Preferences& prefs) {
+    for (int i = 0; i < MAX_OUTPUTS; i++) {
+        char namespace_name[16];
+        snprintf(namespace_name, sizeof(namespace_name), "output%d", i + 1);
+
+        prefs.begin(namespace_name, false);
+        prefs.putBytes("energy", &energyMeters[i], sizeof(EnergyMeter_t));
+        prefs.end();
+    }
+}
+
+/**
+ * Set load rating
+ */
+void output_manager_set_rated_watts(int outputIndex, uint16_t watts) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
+        return;
+    }
+    outputs[outputIndex].ratedWatts = watts;
+}
+
+/**
+ * Copy energy counters
+ */
+bool output_manager_get_energy(int outputIndex, EnergyMeter_t* meter) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS || !meter) {
+        return false;
+    }
+    *meter = energyMeters[outputIndex];
+    return true;
+}
+
+/**
+ * Clear energy counters
+ */
+void output_manager_reset_energy(int outputIndex) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
+        return;
+    }
+    energy_meter_reset(&energyMeters[outputIndex]);
+    outputs[outputIndex].energyKwh = 0.0f;
+
+    Preferences prefs;
+    char namespace_name[16];
+    snprintf(namespace_name, sizeof(namespace_name), "output%d", outputIndex + 1);
+    prefs.begin(namespace_name, false);
+    prefs.remove("energy");
+    prefs.end();
+
+    console_add_event_f(CONSOLE_EVENT_SYSTEM, "Output %d energy counters reset", outputIndex + 1);
+}
+
 /**
  * Get device type name
  */
@@ -859,6 +1576,8 @@ const char* output_manager_get_mode_name(ControlMode_t mode) {
         case CONTROL_MODE_ONOFF: return "OnOff";
         case CONTROL_MODE_SCHEDULE: return "Schedule";
         case CONTROL_MODE_TIME_PROP: return "TimeProp";
+        case CONTROL_MODE_CASCADE: return "Cascade";
+        case CONTROL_MODE_HUMIDITY: return "Humidity";
         default: return "Unknown";
     }
 }
@@ -885,7 +1604,8 @@ int output_manager_get_output_by_name(const char* name) {
     }
 
     for (int i = 0; i < MAX_OUTPUTS; i++) {
-        if (strcmp(outputs[i].name, name) == 0) {
+        OutputSnapshot output(i);
+        if (output && strcmp(output->name, name) == 0) {
             return i;
         }
     }
@@ -893,6 +1613,159 @@ int output_manager_get_output_by_name(const char* name) {
     return -1;
 }
 
+/**
+ * Copy the working outputs into free snapshot slots and publish them
+ * Called with the output lock held. Never waits on readers: if every spare
+ * slot is pinned the previous snapshot stays published until the next change.
+ */
+static void publishSnapshots(void) {
+    if (__atomic_exchange_n(&publishing, true, __ATOMIC_ACQUIRE)) {
+        publishSkips++;   // Safe hold is publishing; the next change catches up
+        return;
+    }
+
+    bool hold = __atomic_load_n(&safeHold, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < MAX_OUTPUTS; i++) {
+        if (hold) {
+            // Whoever holds the lock publishes the hold, not just the control task
+            outputs[i].currentPower = 0;
+            outputs[i].heating = false;
+        }
+
+        uint8_t current = __atomic_load_n(&publishedSlot[i], __ATOMIC_ACQUIRE);
+        int target = -1;
+        for (int slot = 0; slot < OUTPUT_SNAPSHOT_SLOTS; slot++) {
+            if (slot != current && __atomic_load_n(&slotReaders[i][slot], __ATOMIC_ACQUIRE) == 0) {
+                target = slot;
+                break;
+            }
+        }
+        if (target < 0) {
+            publishSkips++;
+            continue;
+        }
+
+        memcpy(&snapshots[i][target], &outputs[i], sizeof(OutputConfig_t));
+        __atomic_store_n(&publishedSlot[i], (uint8_t)target, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&snapshotVersion[i], 1, __ATOMIC_RELEASE);
+    }
+    __atomic_store_n(&publishing, false, __ATOMIC_RELEASE);
+
+    for (int i = 0; i < MAX_OUTPUTS; i++) {
+        publishOutputEvent(i);
+    }
+}
+
+/**
+ * Publish every output as off without the output lock
+ * For safe hold while another task holds the lock. Builds each snapshot
+ * from the published one (never written while published), not from the
+ * working copy the holder may be changing, and sends the state change
+ * without touching the lock-guarded change detection (the holder's next
+ * publish sends it again).
+ */
+static void publishForcedOff(void) {
+    if (__atomic_exchange_n(&publishing, true, __ATOMIC_ACQUIRE)) {
+        return;   // The holder is publishing, so it is running and sees safeHold next tick
+    }
+
+    Event_t events[MAX_OUTPUTS];
+    int eventCount = 0;
+    for (int i = 0; i < MAX_OUTPUTS; i++) {
+        uint8_t current = __atomic_load_n(&publishedSlot[i], __ATOMIC_ACQUIRE);
+        const OutputConfig_t* published = &snapshots[i][current];
+        if (published->currentPower == 0 && !published->heating) {
+            continue;
+        }
+        int target = -1;
+        for (int slot = 0; slot < OUTPUT_SNAPSHOT_SLOTS; slot++) {
+            if (slot != current && __atomic_load_n(&slotReaders[i][slot], __ATOMIC_ACQUIRE) == 0) {
+                target = slot;
+                break;
+            }
+        }
+        if (target < 0) {
+            publishSkips++;
+            continue;
+        }
+
+        OutputConfig_t* forced = &snapshots[i][target];
+        memcpy(forced, published, sizeof(OutputConfig_t));
+        forced->currentPower = 0;
+        forced->heating = false;
+        __atomic_store_n(&publishedSlot[i], (uint8_t)target, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&snapshotVersion[i], 1, __ATOMIC_RELEASE);
+
+        Event_t* event = &events[eventCount++];
+        event->topic = EVENT_OUTPUT_STATE;
+        event->output.index = i;
+        event->output.temp = forced->currentTemp;
+        event->output.target = forced->targetTemp;
+        event->output.mode = (uint8_t)forced->controlMode;
+        event->output.power = 0;
+        event->output.heating = false;
+        event->output.enabled = forced->enabled;
+        event->output.fault = (uint8_t)forced->faultState;
+        strlcpy(event->output.name, forced->name, sizeof(event->output.name));
+        event->output.changed = OUTPUT_CHG_POWER | OUTPUT_CHG_HEATING;
+    }
+    __atomic_store_n(&publishing, false, __ATOMIC_RELEASE);
+
+    for (int i = 0; i < eventCount; i++) {
+        event_bus_publish(&events[i]);
+    }
+}
+
+/**
+ * Publish an output's state on the event bus if anything visible changed
+ * Called with the output lock held.
+ */
+static void publishOutputEvent(int index) {
+    const OutputConfig_t* out = &outputs[index];
+    OutputEvent_t* last = &lastEvent[index];
+    uint16_t changed = 0;
+
+    if (!eventSent[index]) {
+        changed = 0xFFFF;
+    } else {
+        if (fabsf(out->currentTemp - last->temp) >= 0.05f) changed |= OUTPUT_CHG_TEMP;
+        if (out->targetTemp != last->target) changed |= OUTPUT_CHG_TARGET;
+        if ((uint8_t)out->controlMode != last->mode) changed |= OUTPUT_CHG_MODE;
+        if ((uint8_t)out->currentPower != last->power) changed |= OUTPUT_CHG_POWER;
+        if (out->heating != last->heating) changed |= OUTPUT_CHG_HEATING;
+        if (out->enabled != last->enabled) changed |= OUTPUT_CHG_ENABLED;
+        if ((uint8_t)out->faultState != last->fault) changed |= OUTPUT_CHG_FAULT;
+        if (strcmp(out->name, last->name) != 0) changed |= OUTPUT_CHG_NAME;
+    }
+
+    if (changed == 0) {
+        return;
+    }
+    if (changed == OUTPUT_CHG_POWER && millis() - lastPowerEvent[index] < POWER_EVENT_MIN_MS) {
+        return;   // Caught up by the next event or the next second
+    }
+
+    last->index = index;
+    last->temp = out->currentTemp;
+    last->target = out->targetTemp;
+    last->mode = (uint8_t)out->controlMode;
+    last->power = (uint8_t)out->currentPower;
+    last->heating = out->heating;
+    last->enabled = out->enabled;
+    last->fault = (uint8_t)out->faultState;
+    strlcpy(last->name, out->name, sizeof(last->name));
+    last->changed = changed;
+    eventSent[index] = true;
+    if (changed & OUTPUT_CHG_POWER) {
+        lastPowerEvent[index] = millis();
+    }
+
+    Event_t event;
+    event.topic = EVENT_OUTPUT_STATE;
+    event.output = *last;
+    event_bus_publish(&event);
+}
+
 /**
  * Check sensor health status
  */
@@ -1040,6 +1913,7 @@ static void handleFaultState(int index) {
  * Set safety limits
  */
 void output_manager_set_safety_limits(int outputIndex, float maxTempC, float minTempC, uint16_t faultTimeoutSec) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return;
     }
@@ -1057,6 +1931,7 @@ void output_manager_set_safety_limits(int outputIndex, float maxTempC, float min
  * Set fault mode
  */
 void output_manager_set_fault_mode(int outputIndex, FaultMode_t faultMode, uint8_t capPowerPct) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return;
     }
@@ -1065,10 +1940,23 @@ void output_manager_set_fault_mode(int outputIndex, FaultMode_t faultMode, uint8
     outputs[outputIndex].capPowerPct = capPowerPct;
 }
 
+/**
+ * Set auto-resume after sensor recovery
+ */
+void output_manager_set_auto_resume(int outputIndex, bool autoResume) {
+    OutputLock lock;
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
+        return;
+    }
+
+    outputs[outputIndex].autoResumeOnSensorOk = autoResume;
+}
+
 /**
  * Clear fault state (manual reset)
  */
 bool output_manager_clear_fault(int outputIndex) {
+    OutputLock lock;
     if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
         return false;
     }
@@ -1121,3 +2009,27 @@ const char* output_manager_get_sensor_health_name(SensorHealth_t health) {
         default: return "Unknown";
     }
 }
+
+/**
+ * PID mode step for host tools (output_manager_internal.h)
+ */
+int output_manager_step_pid(int outputIndex, float temp) {
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
+        return 0;
+    }
+    outputs[outputIndex].currentTemp = temp;
+    updatePID(outputIndex);
+    return outputs[outputIndex].currentPower;
+}
+
+/**
+ * Time-proportional mode step for host tools (output_manager_internal.h)
+ */
+float output_manager_step_time_prop(int outputIndex, float temp) {
+    if (outputIndex < 0 || outputIndex >= MAX_OUTPUTS) {
+        return 0.0f;
+    }
+    outputs[outputIndex].currentTemp = temp;
+    updateTimeProp(outputIndex);
+    return outputs[outputIndex].timePropDutyCycle;
+}
@@ -0,0 +1,109 @@
+/**
+ * pid_control.cpp
+ * Single-Loop PID Step Implementation
+ */
+
+#include "pid_control.h"
+#include <math.h>
+
+static inline float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+/**
+ * Run one PID step
+ */
+float pid_control_step(const PidControlParams_t* params, PidControlState_t* state,
+                       float target, float input, float ambient, float currentPower, float dt) {
+    float kp = params->kp;
+    float ki = params->ki;
+    float kd = params->kd;
+    float ff = 0.0f;
+
+    // Operating point for the gain schedule and feedforward
+    state->load = target - ambient;
+    if (params->schedule && !isnan(state->load)) {
+        gain_schedule_lookup(params->schedule, state->load, &kp, &ki, &kd);
+        ff = gain_schedule_feedforward(params->schedule, state->load);
+    }
+
+    float error = target - input;
+
+    // Long gap (sensor dropout, fault, mode without PID): the last input is
+    // stale, the integral is still the best estimate of the needed power
+    if (dt > params->maxGapSec) {
+        state->primed = false;
+    }
+
+    // Proportional term
+    float P = kp * error;
+
+    if (state->tracking) {
+        // Bumpless transfer: continue from whatever the output was doing
+        state->integral = currentPower - P - ff;
+        state->tracking = false;
+    } else if (state->primed) {
+        // Scheduled Kp moved - keep P + I where it was
+        state->integral += (state->activeKp - kp) * error;
+
+        // Setpoint weighting: the integral absorbs (1 - weight) of the kick
+        // a target change gives P, and works it off as the error closes
+        float step = target - state->lastTarget;
+        state->integral -= kp * (1.0f - params->setpointWeight) * step;
+    }
+
+    // Derivative term (on measurement)
+    float D = 0.0f;
+    if (state->primed) {
+        D = -kd * (input - state->lastInput) / dt;
+    }
+
+    // Calculate output
+    float out = P + state->integral + D + ff;
+
+    // Integral anti-windup, against the actuator's real limits
+    float excess = 0.0f;
+    if (out > params->outMax) {
+        excess = out - params->outMax;
+    } else if (out < params->outMin) {
+        excess = out - params->outMin;
+    }
+    if (state->primed && ki > 0.0f) {
+        // Conditional integration: don't push a saturated output further out
+        if (!(excess > 0.0f && error > 0.0f) && !(excess < 0.0f && error < 0.0f)) {
+            state->integral += ki * error * dt;
+        }
+
+        // Back-calculation: bleed integral wound up in the saturating
+        // direction with time constant Tt, but never past zero (P alone
+        // saturating during a warm-up must not drive I negative)
+        float ti = kp / ki;                       // Integral time (s)
+        float tt = (kd > 0.0f && kp > 0.0f) ? sqrtf(ti * kd / kp) : ti;
+        float track = (tt > dt) ? dt / tt : 1.0f;
+        if (excess > 0.0f && state->integral > 0.0f) {
+            state->integral = fmaxf(state->integral - excess * track, 0.0f);
+        } else if (excess < 0.0f && state->integral < 0.0f) {
+            state->integral = fminf(state->integral - excess * track, 0.0f);
+        }
+    }
+    state->integral = clampf(state->integral, -params->integralMax, params->integralMax);
+
+    // Update state
+    state->lastInput = input;
+    state->lastTarget = target;
+    state->primed = true;
+    state->activeKp = kp;
+    state->activeKi = ki;
+    state->activeKd = kd;
+    state->feedforward = ff;
+    return clampf(out, params->outMin, params->outMax);
+}
+
+/**
+ * Restart the loop
+ */
+void pid_control_reset(PidControlState_t* state, bool bumpless) {
+    state->integral = 0.0f;
+    state->primed = false;
+    state->tracking = bumpless;
+}
@@ -0,0 +1,178 @@
+/**
+ * thermal_model.cpp
+ * Online First-Order Enclosure Model Implementation
+ */
+
+#include "thermal_model.h"
+#include <math.h>
+#include <string.h>
+
+#define RLS_FORGET 0.998f          // ~17h memory at 2 min samples
+#define RLS_P_INIT 100.0f
+#define RLS_P_RESTORE 1.0f
+#define RLS_TRACE_MAX 1000.0f      // Stop forgetting when unexcited (steady state)
+#define HEAT_SAMPLE_POWER 0.3f
+
+// Plausible ranges - outside these the fit is noise, not an enclosure
+#define LOSS_MIN 0.002f            // 1/min (time constant under ~8h)
+#define LOSS_MAX 0.5f
+#define HEAT_MIN 0.01f             // °C/min at full power
+
+static void resetCovariance(ThermalModel_t* model, float value) {
+    memset(model->P, 0, sizeof(model->P));
+    for (int i = 0; i < 3; i++) {
+        model->P[i][i] = value;
+    }
+}
+
+/**
+ * Reset model
+ */
+void thermal_model_init(ThermalModel_t* model) {
+    memset(model, 0, sizeof(*model));
+    resetCovariance(model, RLS_P_INIT);
+}
+
+/**
+ * Restore fitted parameters
+ */
+void thermal_model_restore(ThermalModel_t* model, float heat, float loss, float bias,
+                           uint32_t samples) {
+    thermal_model_init(model);
+    model->theta[0] = heat;
+    model->theta[1] = loss;
+    model->theta[2] = bias;
+    model->samples = samples;
+    model->heatSamples = samples ? THERMAL_MODEL_MIN_HEAT_SAMPLES : 0;
+    resetCovariance(model, RLS_P_RESTORE);
+}
+
+/**
+ * Drop a partial sample
+ */
+void thermal_model_break(ThermalModel_t* model) {
+    model->sampling = false;
+}
+
+/**
+ * Feed one control step
+ */
+bool thermal_model_update(ThermalModel_t* model, float temp, float powerPct, float dt) {
+    if (!model->sampling) {
+        model->sampling = true;
+        model->startTemp = temp;
+        model->accSec = 0.0f;
+        model->accPowerSec = 0.0f;
+        return false;
+    }
+
+    model->accSec += dt;
+    model->accPowerSec += powerPct / 100.0f * dt;
+    if (model->accSec < THERMAL_MODEL_SAMPLE_SEC) {
+        return false;
+    }
+
+    // Regression sample: slope vs [power, temperature, 1]
+    float minutes = model->accSec / 60.0f;
+    float x[3] = {
+        model->accPowerSec / model->accSec,
+        (model->startTemp + temp) * 0.5f - THERMAL_MODEL_REF_C,
+        1.0f
+    };
+    float y = (temp - model->startTemp) / minutes;
+
+    // Next sample starts where this one ended
+    model->startTemp = temp;
+    model->accSec = 0.0f;
+    model->accPowerSec = 0.0f;
+
+    // Recursive least squares
+    float Px[3];
+    float denom;
+    float trace = model->P[0][0] + model->P[1][1] + model->P[2][2];
+    float lambda = (trace > RLS_TRACE_MAX) ? 1.0f : RLS_FORGET;
+
+    denom = lambda;
+    for (int i = 0; i < 3; i++) {
+        Px[i] = model->P[i][0] * x[0] + model->P[i][1] * x[1] + model->P[i][2] * x[2];
+        denom += x[i] * Px[i];
+    }
+    float err = y - (model->theta[0] * x[0] + model->theta[1] * x[1] + model->theta[2] * x[2]);
+    for (int i = 0; i < 3; i++) {
+        float k = Px[i] / denom;
+        model->theta[i] += k * err;
+        for (int j = 0; j < 3; j++) {
+            model->P[i][j] = (model->P[i][j] - k * Px[j]) / lambda;
+        }
+    }
+
+    model->samples++;
+    if (x[0] > HEAT_SAMPLE_POWER) {
+        model->heatSamples++;
+    }
+    return true;
+}
+
+/**
+ * Check the model is usable
+ */
+bool thermal_model_valid(const ThermalModel_t* model) {
+    float loss = -model->theta[1];
+    return model->samples >= THERMAL_MODEL_MIN_SAMPLES &&
+           model->heatSamples >= THERMAL_MODEL_MIN_HEAT_SAMPLES &&
+           loss >= LOSS_MIN && loss <= LOSS_MAX &&
+           model->theta[0] >= HEAT_MIN;
+}
+
+/**
+ * Steady-state temperature at constant power
+ */
+float thermal_model_equilibrium(const ThermalModel_t* model, float powerPct) {
+    // 0 = heat*u + loss*(T - ref) + bias
+    float loss = model->theta[1];
+    if (loss >= 0.0f) {
+        return THERMAL_MODEL_REF_C;
+    }
+    return THERMAL_MODEL_REF_C - (model->theta[0] * powerPct / 100.0f + model->theta[2]) / loss;
+}
+
+/**
+ * Minutes between two temperatures at constant power
+ */
+float thermal_model_time_to(const ThermalModel_t* model, float from, float to, float powerPct) {
+    float k = -model->theta[1];
+    if (k <= 0.0f) {
+        return -1.0f;
+    }
+    // T(t) = Tss + (from - Tss) * e^(-k t)
+    float tss = thermal_model_equilibrium(model, powerPct);
+    float ratio = (to - tss) / (from - tss);
+    if (ratio <= 0.0f || ratio > 1.0f) {
+        return -1.0f;   // On the far side of equilibrium
+    }
+    return -logf(ratio) / k;
+}
+
+/**
+ * Setpoint for now, ramped toward the next slot
+ */
+float thermal_model_ramp_setpoint(const ThermalModel_t* model, float target, float nextTarget,
+                                  float minutesToNext) {
+    if (nextTarget <= target || minutesToNext < 0.0f || !thermal_model_valid(model)) {
+        return target;
+    }
+    if (minutesToNext > THERMAL_MODEL_MAX_LEAD_MIN) {
+        return target;
+    }
+
+    float k = -model->theta[1];
+    float tss = thermal_model_equilibrium(model, THERMAL_MODEL_PLAN_POWER);
+    if (tss <= nextTarget) {
+        // Can't get there at plan power - heat as early as allowed
+        return nextTarget;
+    }
+
+    // Temperature that reaches nextTarget exactly at the slot time
+    float onCurve = tss + (nextTarget - tss) * expf(k * minutesToNext);
+    return onCurve > target ? onCurve : target;
+}
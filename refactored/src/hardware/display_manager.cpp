@@ -5,6 +5,9 @@
 
 #include "display_manager.h"
 #include "output_manager.h"
+#include "safety_manager.h"
+#include "event_bus.h"
+#include "time_service.h"
 #include <Arduino.h>
 
 // TFT and Touch instances
@@ -38,6 +41,9 @@ static DisplayOutputData outputs[3] = {0};
 // System data
 static DisplaySystemData systemData = {0};
 
+// Event bus subscription (output state, WiFi/MQTT status)
+static int eventSub = -1;
+
 // Callbacks
 static DisplayControlCallback_t controlCallback = nullptr;
 static DisplayModeCallback_t modeCallback = nullptr;
@@ -60,6 +66,7 @@ static void handleTouch(void);
 static void handleControlTouch(int x, int y);
 static uint16_t getHeatColor(int power);
 static void invalidatePreviousValues(void);  // Force full redraw next time
+static void processEvents(void);
 
 /**
  * Initialize display and touch screen
@@ -84,6 +91,9 @@ void display_init(void) {
     initialized = true;
     lastInteraction = millis();
 
+    eventSub = event_bus_subscribe(EVENT_MASK(EVENT_OUTPUT_STATE) | EVENT_MASK(EVENT_NETWORK_STATUS) |
+                                   EVENT_MASK(EVENT_MQTT_STATUS), "display");
+
     // Draw splash screen
     tft.setTextColor(TFT_WHITE, TFT_BLACK);
     tft.setTextDatum(MC_DATUM);
@@ -101,7 +111,15 @@ void display_init(void) {
  * Display task - non-blocking update loop
  */
 void display_task(void) {
-    if (!initialized || sleeping) {
+    if (!initialized) {
+        return;
+    }
+
+    // Keep data current even while asleep so wake shows the latest state
+    processEvents();
+
+    if (sleeping) {
+        safety_manager_heartbeat(HEARTBEAT_DISPLAY);
         return;
     }
 
@@ -125,6 +143,8 @@ void display_task(void) {
     //     Serial.println("[Display] Auto-sleep timeout");
     //     display_sleep(true);
     // }
+
+    safety_manager_heartbeat(HEARTBEAT_DISPLAY);
 }
 
 /**
@@ -702,6 +722,7 @@ static void drawInfoScreen(void) {
     tft.setTextColor(TFT_CYAN, TFT_BLACK);
     tft.drawString("Uptime:", 10, y, 2);
     tft.setTextColor(TFT_WHITE, TFT_BLACK);
+    systemData.uptime = time_service_uptime_sec();
     unsigned long hours = systemData.uptime / 3600;
     unsigned long mins = (systemData.uptime % 3600) / 60;
     sprintf(buf, "%luh %lum", hours, mins);
@@ -712,6 +733,7 @@ static void drawInfoScreen(void) {
     tft.setTextColor(TFT_CYAN, TFT_BLACK);
     tft.drawString("Memory:", 10, y, 2);
     tft.setTextColor(TFT_WHITE, TFT_BLACK);
+    systemData.freeMemory = (ESP.getFreeHeap() * 100) / ESP.getHeapSize();
     sprintf(buf, "%d%% free", systemData.freeMemory);
     tft.drawString(buf, 80, y, 2);
 
@@ -862,9 +884,9 @@ static void handleControlTouch(int x, int y) {
     // Mode button (40, 210, 160x40)
     if (x >= 40 && x <= (SCREEN_WIDTH - 40) && y >= 210 && y <= 250) {
         if (modeCallback) {
-            // Cycle through modes: off -> manual -> pid -> onoff -> timeprop -> schedule -> off
-            const char* modes[] = {"off", "manual", "pid", "onoff", "timeprop", "schedule"};
-            int numModes = 6;
+            // Cycle through modes: off -> manual -> pid -> onoff -> timeprop -> schedule -> cascade -> humidity -> off
+            const char* modes[] = {"off", "manual", "pid", "onoff", "timeprop", "schedule", "cascade", "humidity"};
+            int numModes = 8;
             int currentModeIndex = 0;
             for (int i = 0; i < numModes; i++) {
                 if (strcmp(output->mode, modes[i]) == 0) {
@@ -909,3 +931,44 @@ static uint16_t getHeatColor(int power) {
         return tft.color565(r, g, b);
     }
 }
+
+/**
+ * Apply pending bus events to the display data
+ * Replaces main.cpp copying every output into the display every 2s.
+ */
+static void processEvents(void) {
+    Event_t event;
+    while (event_bus_poll(eventSub, &event)) {
+        switch (event.topic) {
+            case EVENT_OUTPUT_STATE: {
+                const OutputEvent_t* out = &event.output;
+                if (out->enabled) {
+                    display_update_output(out->index, out->temp, out->target,
+                                          output_manager_get_mode_name((ControlMode_t)out->mode),
+                                          out->power, out->heating);
+                }
+                if ((out->changed & OUTPUT_CHG_NAME) && out->name[0] != '\0') {
+                    display_set_output_name(out->index, out->name);
+                    needsFullRedraw = true;
+                    needsRefresh = true;
+                }
+                break;
+            }
+
+            case EVENT_NETWORK_STATUS:
+                systemData.wifiConnected = event.network.connected;
+                strlcpy(systemData.ssid, event.network.ssid, sizeof(systemData.ssid));
+                strlcpy(systemData.ipAddress, event.network.ip, sizeof(systemData.ipAddress));
+                needsFullRedraw = true;   // Header WiFi indicator
+                needsRefresh = true;
+                break;
+
+            case EVENT_MQTT_STATUS:
+                systemData.mqttConnected = event.mqtt.connected;
+                break;
+
+            default:
+                break;
+        }
+    }
+}
@@ -0,0 +1,213 @@
+/**
+ * humidity_sensor.cpp
+ * I2C Temperature/Humidity Sensor Drivers Implementation
+ */
+
+#include "humidity_sensor.h"
+#include <Wire.h>
+
+// SHT3x commands
+#define SHT3X_CMD_MEASURE 0x2400      // Single shot, high repeatability, no clock stretching
+#define SHT3X_CMD_STATUS 0xF32D       // Read status register (used to probe)
+#define SHT3X_CONVERSION_MS 16        // 15.5ms max at high repeatability
+
+// BME280 registers
+#define BME280_REG_CHIP_ID 0xD0
+#define BME280_REG_CALIB_T 0x88       // T1..T3, then pressure (unused), 0xA1 = H1
+#define BME280_REG_CALIB_H1 0xA1
+#define BME280_REG_CALIB_H2 0xE1      // H2..H6 (7 bytes)
+#define BME280_REG_CTRL_HUM 0xF2
+#define BME280_REG_CTRL_MEAS 0xF4
+#define BME280_REG_DATA 0xF7          // press[3], temp[3], hum[2]
+#define BME280_CHIP_ID 0x60           // BMP280 (0x58) has no humidity
+#define BME280_HUM_X1 0x01
+#define BME280_MEAS_FORCED 0x21       // Temp x1, pressure skipped, forced mode
+#define BME280_CONVERSION_MS 10       // 1.25 + 2.3 * 2 + 0.575ms worst case
+
+// ===== I2C HELPERS =====
+
+static bool writeBytes(uint8_t address, const uint8_t* data, size_t len) {
+    Wire.beginTransmission(address);
+    Wire.write(data, len);
+    return Wire.endTransmission() == 0;
+}
+
+static bool readBytes(uint8_t address, uint8_t* data, size_t len) {
+    if (Wire.requestFrom(address, (uint8_t)len) != len) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        data[i] = Wire.read();
+    }
+    return true;
+}
+
+static bool readRegisters(uint8_t address, uint8_t reg, uint8_t* data, size_t len) {
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0) {
+        return false;
+    }
+    return readBytes(address, data, len);
+}
+
+static bool sht3xCommand(uint8_t address, uint16_t command) {
+    uint8_t cmd[2] = {(uint8_t)(command >> 8), (uint8_t)(command & 0xFF)};
+    return writeBytes(address, cmd, sizeof(cmd));
+}
+
+/**
+ * SHT3x CRC-8 (poly 0x31, init 0xFF)
+ */
+static uint8_t sht3xCrc(const uint8_t* data, size_t len) {
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// ===== PROBE =====
+
+static bool probeSht3x(uint8_t address) {
+    uint8_t status[3];
+    if (!sht3xCommand(address, SHT3X_CMD_STATUS) || !readBytes(address, status, sizeof(status))) {
+        return false;
+    }
+    return sht3xCrc(status, 2) == status[2];
+}
+
+static bool probeBme280(uint8_t address, Bme280Calib_t* calib) {
+    uint8_t id = 0;
+    if (!readRegisters(address, BME280_REG_CHIP_ID, &id, 1)) {
+        return false;
+    }
+    if (id != BME280_CHIP_ID) {
+        Serial.printf("[Humidity] 0x%02X: chip id 0x%02X is not a BME280, skipping\n", address, id);
+        return false;
+    }
+
+    uint8_t t[6];
+    uint8_t h1;
+    uint8_t h[7];
+    if (!readRegisters(address, BME280_REG_CALIB_T, t, sizeof(t)) ||
+        !readRegisters(address, BME280_REG_CALIB_H1, &h1, 1) ||
+        !readRegisters(address, BME280_REG_CALIB_H2, h, sizeof(h))) {
+        return false;
+    }
+    calib->T1 = (uint16_t)(t[1] << 8 | t[0]);
+    calib->T2 = (int16_t)(t[3] << 8 | t[2]);
+    calib->T3 = (int16_t)(t[5] << 8 | t[4]);
+    calib->H1 = h1;
+    calib->H2 = (int16_t)(h[1] << 8 | h[0]);
+    calib->H3 = h[2];
+    calib->H4 = (int16_t)((int8_t)h[3] * 16 | (h[4] & 0x0F));
+    calib->H5 = (int16_t)((int8_t)h[5] * 16 | (h[4] >> 4));
+    calib->H6 = (int8_t)h[6];
+    return true;
+}
+
+/**
+ * Probe an address
+ */
+bool humidity_sensor_probe(uint8_t address, HumiditySensor_t* sensor) {
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->address = address;
+
+    if ((address == 0x44 || address == 0x45) && probeSht3x(address)) {
+        sensor->type = SENSOR_TYPE_SHT3X;
+        return true;
+    }
+    if ((address == 0x76 || address == 0x77) && probeBme280(address, &sensor->calib)) {
+        sensor->type = SENSOR_TYPE_BME280;
+        return true;
+    }
+    return false;
+}
+
+// ===== MEASUREMENT =====
+
+/**
+ * Trigger one measurement
+ */
+bool humidity_sensor_start(const HumiditySensor_t* sensor) {
+    if (sensor->type == SENSOR_TYPE_SHT3X) {
+        return sht3xCommand(sensor->address, SHT3X_CMD_MEASURE);
+    }
+    if (sensor->type == SENSOR_TYPE_BME280) {
+        // ctrl_hum only takes effect after the ctrl_meas write
+        uint8_t hum[2] = {BME280_REG_CTRL_HUM, BME280_HUM_X1};
+        uint8_t meas[2] = {BME280_REG_CTRL_MEAS, BME280_MEAS_FORCED};
+        return writeBytes(sensor->address, hum, sizeof(hum)) &&
+               writeBytes(sensor->address, meas, sizeof(meas));
+    }
+    return false;
+}
+
+/**
+ * Conversion time
+ */
+uint16_t humidity_sensor_conversion_ms(const HumiditySensor_t* sensor) {
+    return sensor->type == SENSOR_TYPE_BME280 ? BME280_CONVERSION_MS : SHT3X_CONVERSION_MS;
+}
+
+static bool readSht3x(const HumiditySensor_t* sensor, float* temperature, float* humidity) {
+    uint8_t data[6];
+    if (!readBytes(sensor->address, data, sizeof(data))) {
+        return false;
+    }
+    if (sht3xCrc(data, 2) != data[2] || sht3xCrc(data + 3, 2) != data[5]) {
+        return false;
+    }
+    uint16_t rawT = (uint16_t)(data[0] << 8 | data[1]);
+    uint16_t rawH = (uint16_t)(data[3] << 8 | data[4]);
+    *temperature = -45.0f + 175.0f * rawT / 65535.0f;
+    *humidity = 100.0f * rawH / 65535.0f;
+    return true;
+}
+
+static bool readBme280(const HumiditySensor_t* sensor, float* temperature, float* humidity) {
+    uint8_t data[8];
+    if (!readRegisters(sensor->address, BME280_REG_DATA, data, sizeof(data))) {
+        return false;
+    }
+    int32_t adcT = (int32_t)data[3] << 12 | (int32_t)data[4] << 4 | data[5] >> 4;
+    int32_t adcH = (int32_t)data[6] << 8 | data[7];
+    if (adcT == 0x80000 || adcH == 0x8000) {
+        return false;   // Skipped/not measured (reset values)
+    }
+    const Bme280Calib_t* c = &sensor->calib;
+
+    // Datasheet section 4.2.3 (32-bit integer compensation)
+    int32_t var1 = ((((adcT >> 3) - ((int32_t)c->T1 << 1))) * (int32_t)c->T2) >> 11;
+    int32_t var2 = (((((adcT >> 4) - (int32_t)c->T1) * ((adcT >> 4) - (int32_t)c->T1)) >> 12) *
+                    (int32_t)c->T3) >> 14;
+    int32_t tFine = var1 + var2;
+    *temperature = ((tFine * 5 + 128) >> 8) / 100.0f;
+
+    int32_t v = tFine - 76800;
+    v = (((((adcH << 14) - ((int32_t)c->H4 << 20) - ((int32_t)c->H5 * v)) + 16384) >> 15) *
+         (((((((v * (int32_t)c->H6) >> 10) * (((v * (int32_t)c->H3) >> 11) + 32768)) >> 10) +
+            2097152) * (int32_t)c->H2 + 8192) >> 14));
+    v = v - (((((v >> 15) * (v >> 15)) >> 7) * (int32_t)c->H1) >> 4);
+    if (v < 0) v = 0;
+    if (v > 419430400) v = 419430400;
+    *humidity = (uint32_t)(v >> 12) / 1024.0f;
+    return true;
+}
+
+/**
+ * Read a finished measurement
+ */
+bool humidity_sensor_read(const HumiditySensor_t* sensor, float* temperature, float* humidity) {
+    if (sensor->type == SENSOR_TYPE_SHT3X) {
+        return readSht3x(sensor, temperature, humidity);
+    }
+    if (sensor->type == SENSOR_TYPE_BME280) {
+        return readBme280(sensor, temperature, humidity);
+    }
+    return false;
+}
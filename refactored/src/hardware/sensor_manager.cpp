@@ -1,32 +1,63 @@
 /**
  * sensor_manager.cpp
- * DS18B20 Temperature Sensor Management Implementation
+ * Temperature and Humidity Sensor Management Implementation
  */
 
 #include "sensor_manager.h"
+#include "humidity_sensor.h"
+#include "safety_manager.h"
+#include "event_bus.h"
 #include <OneWire.h>
 #include <DallasTemperature.h>
 #include <Preferences.h>
+#include <Wire.h>
 
 // OneWire and sensor objects
 static OneWire* oneWire = nullptr;
 static DallasTemperature* sensors = nullptr;
 static uint8_t oneWirePin = 0;
 
+// I2C bus (SHT3x/BME280)
+#define I2C_CLOCK_HZ 100000
+#define I2C_TIMEOUT_MS 10         // A stuck bus can't stall the control task for long
+static const uint8_t i2cProbeAddresses[] = {0x44, 0x45, 0x76, 0x77};
+
 // Sensor array
 static SensorInfo_t sensorArray[MAX_SENSORS];
+static HumiditySensor_t i2cSensors[MAX_SENSORS];   // Driver state, same index as sensorArray
 static int sensorCount = 0;
 
+// Consecutive failed reads before a sensor is reported as failing
+#define SENSOR_FAIL_EVENT_COUNT 3
+static bool reportedFailing[MAX_SENSORS];
+
+// Polling scheduler: start all conversions, collect when the slowest is done
+static bool converting = false;
+static unsigned long roundStart = 0;
+static unsigned long lastRoundStart = 0;
+static uint16_t conversionMs = 0;
+static bool started[MAX_SENSORS];       // I2C sensor accepted this round's trigger
+
+// Forward declarations
+static void publishHealth(int index, bool ok);
+static void startRound(void);
+static void collectRound(void);
+static void recordReading(int index, bool ok, float temp, float humidity);
+
 /**
  * Initialize sensor manager
  */
-void sensor_manager_init(uint8_t pin) {
+void sensor_manager_init(uint8_t pin, uint8_t sdaPin, uint8_t sclPin) {
     oneWirePin = pin;
 
     // Initialize OneWire and DallasTemperature
     oneWire = new OneWire(oneWirePin);
     sensors = new DallasTemperature(oneWire);
     sensors->begin();
+    sensors->setWaitForConversion(false);   // Poll collects after the conversion time
+
+    Wire.begin(sdaPin, sclPin, I2C_CLOCK_HZ);
+    Wire.setTimeOut(I2C_TIMEOUT_MS);
 
     // Clear sensor array
     memset(sensorArray, 0, sizeof(sensorArray));
@@ -55,7 +86,10 @@ int sensor_manager_scan(void) {
 
     // Clear previous scan results
     memset(sensorArray, 0, sizeof(sensorArray));
+    memset(i2cSensors, 0, sizeof(i2cSensors));
+    memset(reportedFailing, 0, sizeof(reportedFailing));
     sensorCount = 0;
+    converting = false;
 
     // Search for devices
     uint8_t address[8];
@@ -79,6 +113,7 @@ int sensor_manager_scan(void) {
             SensorInfo_t* sensor = &sensorArray[sensorCount];
 
             sensor->discovered = true;
+            sensor->type = SENSOR_TYPE_DS18B20;
             memcpy(sensor->address, address, 8);
 
             // Convert address to hex string
@@ -91,8 +126,10 @@ int sensor_manager_scan(void) {
             sensor_manager_get_default_name(sensorCount, sensor->name, sizeof(sensor->name));
 
             sensor->lastReading = -127.0f;
+            sensor->lastHumidity = NAN;
             sensor->lastReadTime = 0;
             sensor->errorCount = 0;
+            sensor->totalErrors = 0;
 
             Serial.printf("[SensorMgr] Sensor %d: %s (%s)\n",
                          sensorCount, sensor->addressString, sensor->name);
@@ -104,6 +141,37 @@ int sensor_manager_scan(void) {
         }
     }
 
+    // Probe the fixed SHT3x/BME280 addresses on I2C
+    for (uint8_t addr : i2cProbeAddresses) {
+        HumiditySensor_t probe;
+        if (!humidity_sensor_probe(addr, &probe)) {
+            continue;
+        }
+        if (sensorCount >= MAX_SENSORS) {
+            Serial.println("[SensorMgr] Max sensors reached, ignoring I2C sensors");
+            break;
+        }
+
+        SensorInfo_t* sensor = &sensorArray[sensorCount];
+        i2cSensors[sensorCount] = probe;
+        sensor->discovered = true;
+        sensor->type = probe.type;
+        sensor->address[0] = addr;
+        snprintf(sensor->addressString, sizeof(sensor->addressString), "%s-%02X",
+                 probe.type == SENSOR_TYPE_SHT3X ? "SHT3X" : "BME280", addr);
+        sensor_manager_get_default_name(sensorCount, sensor->name, sizeof(sensor->name));
+        sensor->lastReading = -127.0f;
+        sensor->lastHumidity = NAN;
+        sensor->lastReadTime = 0;
+        sensor->errorCount = 0;
+        sensor->totalErrors = 0;
+
+        Serial.printf("[SensorMgr] Sensor %d: %s (%s)\n",
+                     sensorCount, sensor->addressString, sensor->name);
+
+        sensorCount++;
+    }
+
     return sensorCount;
 }
 
@@ -142,61 +210,34 @@ const SensorInfo_t* sensor_manager_get_sensor_by_address(const char* addressStri
 }
 
 /**
- * Read temperature from specific sensor
+ * Advance the polling scheduler
  */
-bool sensor_manager_read_sensor(int index, float* temperature) {
-    if (!sensors || index < 0 || index >= sensorCount || !temperature) {
+bool sensor_manager_poll(void) {
+    if (!sensors) {
         return false;
     }
+    unsigned long now = millis();
 
-    SensorInfo_t* sensor = &sensorArray[index];
-
-    // Request temperature
-    sensors->requestTemperaturesByAddress(sensor->address);
-
-    // Read temperature
-    float temp = sensors->getTempC(sensor->address);
-
-    // Validate
-    if (sensor_manager_is_valid_temp(temp)) {
-        *temperature = temp;
-        sensor->lastReading = temp;
-        sensor->lastReadTime = millis();
-        sensor->errorCount = 0;
-        return true;
-    } else {
-        sensor->errorCount++;
-        Serial.printf("[SensorMgr] Sensor %d read error (count: %d)\n",
-                     index, sensor->errorCount);
+    if (!converting) {
+        if (lastRoundStart != 0 && now - lastRoundStart < SENSOR_POLL_PERIOD_MS) {
+            return false;
+        }
+        if (sensorCount == 0) {
+            // Nothing to poll, but the bus is alive
+            lastRoundStart = now;
+            safety_manager_heartbeat(HEARTBEAT_SENSORS);
+            return false;
+        }
+        startRound();
         return false;
     }
-}
-
-/**
- * Read all sensors
- */
-void sensor_manager_read_all(void) {
-    if (!sensors || sensorCount == 0) {
-        return;
-    }
-
-    // Request temperatures from all sensors at once
-    sensors->requestTemperatures();
 
-    // Read each sensor
-    for (int i = 0; i < sensorCount; i++) {
-        SensorInfo_t* sensor = &sensorArray[i];
-
-        float temp = sensors->getTempC(sensor->address);
-
-        if (sensor_manager_is_valid_temp(temp)) {
-            sensor->lastReading = temp;
-            sensor->lastReadTime = millis();
-            sensor->errorCount = 0;
-        } else {
-            sensor->errorCount++;
-        }
+    if (now - roundStart < conversionMs) {
+        return false;
     }
+    collectRound();
+    safety_manager_heartbeat(HEARTBEAT_SENSORS);
+    return true;
 }
 
 /**
@@ -262,7 +303,20 @@ void sensor_manager_get_default_name(int index, char* buffer, size_t maxLen) {
         return;
     }
 
-    snprintf(buffer, maxLen, "Temperature Sensor %d", index + 1);
+    bool humidity = index >= 0 && index < MAX_SENSORS && sensorArray[index].type != SENSOR_TYPE_DS18B20;
+    snprintf(buffer, maxLen, "%s Sensor %d", humidity ? "Humidity" : "Temperature", index + 1);
+}
+
+/**
+ * Get sensor type name
+ */
+const char* sensor_manager_get_type_name(SensorType_t type) {
+    switch (type) {
+        case SENSOR_TYPE_DS18B20: return "DS18B20";
+        case SENSOR_TYPE_SHT3X: return "SHT3x";
+        case SENSOR_TYPE_BME280: return "BME280";
+        default: return "Unknown";
+    }
 }
 
 /**
@@ -277,3 +331,102 @@ bool sensor_manager_is_valid_temp(float temp) {
     }
     return true;
 }
+
+/**
+ * Validate humidity reading
+ */
+bool sensor_manager_is_valid_humidity(float humidity) {
+    return !isnan(humidity) && humidity >= 0.0f && humidity <= 100.0f;
+}
+
+// ===== INTERNAL FUNCTIONS =====
+
+/**
+ * Start every conversion of a round
+ * DS18B20s convert together on one bus command; each I2C sensor gets its
+ * own trigger. Collection waits for the slowest.
+ */
+static void startRound(void) {
+    unsigned long now = millis();
+    conversionMs = 0;
+    bool anyDs18b20 = false;
+
+    for (int i = 0; i < sensorCount; i++) {
+        started[i] = false;
+        if (sensorArray[i].type == SENSOR_TYPE_DS18B20) {
+            anyDs18b20 = true;
+            continue;
+        }
+        started[i] = humidity_sensor_start(&i2cSensors[i]);
+        uint16_t ms = humidity_sensor_conversion_ms(&i2cSensors[i]);
+        if (ms > conversionMs) conversionMs = ms;
+    }
+    if (anyDs18b20) {
+        sensors->requestTemperatures();   // Returns at once (setWaitForConversion(false))
+        uint16_t ms = sensors->millisToWaitForConversion(sensors->getResolution());
+        if (ms > conversionMs) conversionMs = ms;
+    }
+
+    roundStart = now;
+    lastRoundStart = now;
+    converting = true;
+}
+
+/**
+ * Collect a finished round
+ */
+static void collectRound(void) {
+    converting = false;
+
+    for (int i = 0; i < sensorCount; i++) {
+        SensorInfo_t* sensor = &sensorArray[i];
+        if (sensor->type == SENSOR_TYPE_DS18B20) {
+            float temp = sensors->getTempC(sensor->address);
+            recordReading(i, sensor_manager_is_valid_temp(temp), temp, NAN);
+            continue;
+        }
+
+        float temp = -127.0f;
+        float humidity = NAN;
+        bool ok = started[i] && humidity_sensor_read(&i2cSensors[i], &temp, &humidity);
+        recordReading(i, ok && sensor_manager_is_valid_temp(temp) &&
+                         sensor_manager_is_valid_humidity(humidity), temp, humidity);
+    }
+}
+
+/**
+ * Store one sensor's result and publish health transitions
+ */
+static void recordReading(int index, bool ok, float temp, float humidity) {
+    SensorInfo_t* sensor = &sensorArray[index];
+    if (ok) {
+        sensor->lastReading = temp;
+        sensor->lastHumidity = humidity;
+        sensor->lastReadTime = millis();
+        sensor->errorCount = 0;
+        if (reportedFailing[index]) {
+            reportedFailing[index] = false;
+            publishHealth(index, true);
+        }
+    } else {
+        sensor->errorCount++;
+        sensor->totalErrors++;
+        if (sensor->errorCount == SENSOR_FAIL_EVENT_COUNT) {
+            reportedFailing[index] = true;
+            publishHealth(index, false);
+        }
+    }
+}
+
+/**
+ * Publish a sensor health transition on the event bus
+ */
+static void publishHealth(int index, bool ok) {
+    Event_t event;
+    event.topic = EVENT_SENSOR_HEALTH;
+    event.sensor.index = index;
+    event.sensor.ok = ok;
+    event.sensor.lastReading = sensorArray[index].lastReading;
+    strlcpy(event.sensor.address, sensorArray[index].addressString, sizeof(event.sensor.address));
+    event_bus_publish(&event);
+}
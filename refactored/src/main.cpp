@@ -22,10 +22,9 @@
 // Include network modules (Phase 2)
 #include "wifi_manager.h"
 #include "mqtt_manager.h"
+#include "fleet_manager.h"
 #include "web_server.h"
-
-// Include control modules (Phase 3)
-#include "system_state.h"
+#include "ota_manager.h"
 
 // Include hardware modules (Phase 4)
 #include "display_manager.h"
@@ -39,35 +38,41 @@
 #include "temp_history.h"
 #include "console.h"
 #include "safety_manager.h"
+#include "crash_log.h"
+#include "boot_profile.h"
+#include "heap_monitor.h"
+#include "loop_profiler.h"
+#include "event_bus.h"
+#include "time_service.h"
 
 // Firmware version
 #define FIRMWARE_VERSION "2.2.0"
 
 // Hardware configuration
 #define ONE_WIRE_BUS 4  // DS18B20 OneWire bus pin
+#define I2C_SDA_PIN 21  // SHT3x/BME280 humidity sensors
+#define I2C_SCL_PIN 26  // (GPIO22, the usual SCL, is the touch CS)
+
+// Control task (sensors + outputs, started before display and network)
+#define CONTROL_TASK_STACK 4096
+#define CONTROL_TASK_PRIORITY 2     // Above loop() (1) so web/MQTT can't starve it
+#define CONTROL_TASK_CORE 1
+#define CONTROL_PERIOD_MS 100       // Output update rate (sensors poll every SENSOR_POLL_PERIOD_MS)
+static TaskHandle_t controlTaskHandle = nullptr;
 
 // Timing
-unsigned long lastSensorRead = 0;
-unsigned long lastOutputUpdate = 0;
 unsigned long lastMqttPublish = 0;
 unsigned long bootTime = 0;
 
 // Device name (global for use in loop)
 char deviceName[32] = "ESP32-Thermostat";
 
-// Legacy compatibility (for TFT display - uses Output 1 by default)
-static SystemState_t legacyState = {
-    0.0f,      // currentTemp
-    25.0f,     // targetTemp
-    false,     // heating
-    "off",     // mode
-    0          // power
-};
-
 // Forward declarations
 void readSensors(void);
 void updateOutputs(void);
-void updateLegacyState(void);
+void controlTask(void* param);
+void onHeapLow(uint32_t largestBlock, uint32_t freeHeap);
+void onTimeSync(int32_t stepSec);
 void onMQTTSetpoint(const char* topic, const char* message);
 void onMQTTMode(const char* topic, const char* message);
 void onWebControl(float temp, const char* mode);
@@ -78,15 +83,31 @@ void setup() {
     Serial.begin(115200);
     bootTime = millis();
 
-    // Initialize logger, history, and console
-    logger_init(bootTime);
-    temp_history_init(bootTime);
+    // Capture reset reason and save previous boot's breadcrumbs (before anything logs)
+    crash_log_init();
+
+    // Initialize console/log store and history
     console_init();
+    temp_history_init(bootTime);
+
+    // Modules publish state changes from here on (display/web/MQTT subscribe in their init)
+    event_bus_init();
+
+    // Timezone before anything reads local time; history is re-stamped at the first sync
+    time_service_init();
+    time_service_set_sync_callback(onTimeSync);
 
     Serial.println("=== ESP32 Reptile Thermostat v" FIRMWARE_VERSION " ===");
     Serial.println("=== Multi-Output Environmental Control ===");
-    logger_add("System boot - v" FIRMWARE_VERSION);
-    console_add_event(CONSOLE_EVENT_SYSTEM, "System boot - v" FIRMWARE_VERSION);
+    console_add_event_to(CONSOLE_EVENT_SYSTEM, CONSOLE_VIEW_CONSOLE | CONSOLE_VIEW_LOG,
+                         "System boot - v" FIRMWARE_VERSION);
+
+    // Start loop profiling window
+    profiler_reset();
+
+    // Start heap trend (alerts go out over MQTT once connected)
+    heap_monitor_init();
+    heap_monitor_set_alert_callback(onHeapLow);
 
     // Initialize safety manager (watchdog, boot loop detection)
     // Must be early in setup - before hardware that could cause issues
@@ -96,19 +117,26 @@ void setup() {
         logger_add("SAFE MODE ACTIVE");
     }
 
-    // Initialize TFT display (3-output support)
-    display_init();
+    // Detect a pending-verify image or a rollback of the last update
+    ota_manager_init();
+
+    boot_profile_mark(BOOT_PHASE_CORE);
+
+    // === Stage 1: restore control ===
+    // Sensors and outputs come up first so heat management resumes
+    // within a few hundred ms of reset, before the display splash and WiFi.
 
     // Initialize sensor manager
-    sensor_manager_init(ONE_WIRE_BUS);
+    sensor_manager_init(ONE_WIRE_BUS, I2C_SDA_PIN, I2C_SCL_PIN);
     int sensorCount = sensor_manager_get_count();
-    console_add_event_f(CONSOLE_EVENT_SYSTEM, "Found %d temperature sensors", sensorCount);
-    logger_add("Sensor manager initialized");
+    char sensorLog[48];
+    snprintf(sensorLog, sizeof(sensorLog), "Sensor manager initialized, %d sensors", sensorCount);
+    console_add_event_to(CONSOLE_EVENT_SYSTEM, CONSOLE_VIEW_CONSOLE | CONSOLE_VIEW_LOG, sensorLog);
 
     // Initialize output manager
     output_manager_init();
-    console_add_event(CONSOLE_EVENT_SYSTEM, "Output manager initialized (3 outputs)");
-    logger_add("Output manager initialized");
+    console_add_event_to(CONSOLE_EVENT_SYSTEM, CONSOLE_VIEW_CONSOLE | CONSOLE_VIEW_LOG,
+                         "Output manager initialized (3 outputs)");
 
     // Auto-assign sensors to outputs (if available)
     if (sensorCount > 0) {
@@ -123,6 +151,27 @@ void setup() {
         }
     }
 
+    // Boot-loop safe mode: force outputs off now that config is loaded
+    if (!normalBoot) {
+        safety_manager_emergency_stop();
+    }
+    boot_profile_mark(BOOT_PHASE_CONFIG);
+
+    // Start control task (first sensor read happens immediately)
+    xTaskCreatePinnedToCore(controlTask, "control", CONTROL_TASK_STACK, nullptr,
+                            CONTROL_TASK_PRIORITY, &controlTaskHandle, CONTROL_TASK_CORE);
+    safety_manager_register_heartbeat(HEARTBEAT_CONTROL, 5000);
+    safety_manager_register_heartbeat(HEARTBEAT_SENSORS, 5000);
+    boot_profile_mark(BOOT_PHASE_CONTROL);
+    console_add_event_f(CONSOLE_EVENT_SYSTEM, "Control task started %lums after reset",
+                       (unsigned long)boot_profile_get_ms(BOOT_PHASE_CONTROL));
+
+    // === Stage 2: display and network (control task keeps running) ===
+
+    // Initialize TFT display (3-output support)
+    display_init();
+    boot_profile_mark(BOOT_PHASE_DISPLAY);
+
     // Load device name from preferences
     // (deviceName is global variable)
     Preferences prefs;
@@ -148,6 +197,8 @@ void setup() {
         else if (strcmp(mode, "onoff") == 0) modeEnum = CONTROL_MODE_ONOFF;
         else if (strcmp(mode, "timeprop") == 0) modeEnum = CONTROL_MODE_TIME_PROP;
         else if (strcmp(mode, "schedule") == 0) modeEnum = CONTROL_MODE_SCHEDULE;
+        else if (strcmp(mode, "cascade") == 0) modeEnum = CONTROL_MODE_CASCADE;
+        else if (strcmp(mode, "humidity") == 0) modeEnum = CONTROL_MODE_HUMIDITY;
 
         output_manager_set_mode(outputId, modeEnum);
         console_add_event_f(CONSOLE_EVENT_SYSTEM, "Display: Output %d mode set to %s", outputId + 1, mode);
@@ -156,13 +207,14 @@ void setup() {
     // Initialize WiFi
     wifi_init();
     logger_add("WiFi initialized");
+    boot_profile_mark(BOOT_PHASE_WIFI);
     
     // Setup mDNS if connected
     if (!wifi_is_ap_mode()) {
         wifi_setup_mdns(deviceName);
         
-        // Setup NTP time
-        configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+        // Setup NTP time (in the saved timezone)
+        time_service_start_sync();
         logger_add("Time sync started");
         
         // Initialize MQTT
@@ -170,7 +222,11 @@ void setup() {
         mqtt_set_setpoint_callback(onMQTTSetpoint);
         mqtt_set_mode_callback(onMQTTMode);
         logger_add("MQTT initialized");
+
+        // Fleet status multicast (no-op unless enabled in settings)
+        fleet_init();
     }
+    boot_profile_mark(BOOT_PHASE_NETWORK);
     
     // Initialize web server
     webserver_init();
@@ -179,12 +235,14 @@ void setup() {
     webserver_set_restart_callback(onWebRestart);
     // Note: Schedule data now managed per-output via output_manager
     logger_add("Web server started");
+    boot_profile_mark(BOOT_PHASE_WEBSERVER);
     
     // Display is initialized and showing main screen
 
-    // Do immediate first display update so temps show right away
+    // Seed the display with current state so temps show right away
+    // (outputs published their first events before the display subscribed)
     for (int i = 0; i < 3; i++) {
-        OutputConfig_t* output = output_manager_get_output(i);
+        OutputSnapshot output(i);
         if (output && output->enabled) {
             const char* modeStr = output_manager_get_mode_name(output->controlMode);
             display_update_output(
@@ -206,6 +264,8 @@ void setup() {
     strncpy(sysData.deviceName, deviceName, sizeof(sysData.deviceName) - 1);
     strncpy(sysData.firmwareVersion, FIRMWARE_VERSION, sizeof(sysData.firmwareVersion) - 1);
     sysData.wifiConnected = !wifi_is_ap_mode();
+    strncpy(sysData.ssid, wifi_get_ssid(), sizeof(sysData.ssid) - 1);
+    strncpy(sysData.ipAddress, wifi_get_ip_address(), sizeof(sysData.ipAddress) - 1);
     sysData.mqttConnected = mqtt_is_connected();
     sysData.uptime = (millis() - bootTime) / 1000;
     sysData.freeMemory = (ESP.getFreeHeap() * 100) / ESP.getHeapSize();
@@ -215,14 +275,34 @@ void setup() {
     Serial.print("Free heap: ");
     Serial.println(ESP.getFreeHeap());
 
+    // Register loop() heartbeats (stall = silent for 3x period).
+    // Periods are loose because wifi_connect() can block the loop for ~10s.
+    safety_manager_register_heartbeat(HEARTBEAT_NETWORK, 10000);
+    if (display_is_initialized()) {
+        safety_manager_register_heartbeat(HEARTBEAT_DISPLAY, 5000);
+    }
+
+    boot_profile_mark(BOOT_PHASE_READY);
+    boot_profile_log_summary();
+
     // Feed watchdog after successful init
     safety_manager_feed_watchdog();
 }
 
 void loop() {
+    PROFILE_BEGIN(PROF_LOOP_TOTAL);
+    crash_log_tick();
+    CRASH_BREADCRUMB(CRASH_SUB_LOOP, CRASH_PT_ENTER);
+
     // Feed watchdog at start of each loop iteration
     safety_manager_feed_watchdog();
 
+    // Check per-subsystem heartbeats (forces outputs off on control/sensor stall)
+    safety_manager_check_heartbeats();
+
+    // Cached local time (once per second) and first-sync detection
+    time_service_task();
+
     // Mark boot as stable after 60 seconds of successful operation
     static bool bootMarkedStable = false;
     if (!bootMarkedStable && millis() > 60000) {
@@ -231,78 +311,52 @@ void loop() {
     }
 
     // Network tasks
+    PROFILE_BEGIN(PROF_WIFI);
+    CRASH_BREADCRUMB(CRASH_SUB_WIFI, CRASH_PT_ENTER);
     wifi_task();
+    CRASH_BREADCRUMB(CRASH_SUB_WIFI, CRASH_PT_EXIT);
+    PROFILE_END(PROF_WIFI);
 
     if (!wifi_is_ap_mode()) {
+        PROFILE_BEGIN(PROF_MQTT);
+        CRASH_BREADCRUMB(CRASH_SUB_MQTT, CRASH_PT_ENTER);
         mqtt_task();
+        CRASH_BREADCRUMB(CRASH_SUB_MQTT, CRASH_PT_EXIT);
+        PROFILE_END(PROF_MQTT);
+
+        fleet_task();
     }
 
+    PROFILE_BEGIN(PROF_WEBSERVER);
+    CRASH_BREADCRUMB(CRASH_SUB_WEB, CRASH_PT_ENTER);
     webserver_task();
+    CRASH_BREADCRUMB(CRASH_SUB_WEB, CRASH_PT_EXIT);
+    PROFILE_END(PROF_WEBSERVER);
 
     // Display task (handles screen updates and touch input)
+    PROFILE_BEGIN(PROF_DISPLAY);
+    CRASH_BREADCRUMB(CRASH_SUB_DISPLAY, CRASH_PT_ENTER);
     display_task();
+    CRASH_BREADCRUMB(CRASH_SUB_DISPLAY, CRASH_PT_EXIT);
+    PROFILE_END(PROF_DISPLAY);
 
-    // Read all sensors (every 2s)
-    if (millis() - lastSensorRead >= 2000) {
-        readSensors();
-        lastSensorRead = millis();
-    }
+    // Sensors and outputs run in controlTask()
 
-    // Update all outputs (every 100ms for responsive control)
-    if (millis() - lastOutputUpdate >= 100) {
-        updateOutputs();
-        lastOutputUpdate = millis();
-    }
+    // Heap trend and low-block alert (every 10s)
+    heap_monitor_task();
 
-    // Update display with all 3 outputs (every 2 seconds for live temp updates)
-    static unsigned long lastDisplayUpdate = 0;
-    if (millis() - lastDisplayUpdate >= 2000) {
-        for (int i = 0; i < 3; i++) {
-            OutputConfig_t* output = output_manager_get_output(i);
-            if (output && output->enabled) {
-                // Get mode name as string
-                const char* modeStr = output_manager_get_mode_name(output->controlMode);
-
-                display_update_output(
-                    i,
-                    output->currentTemp,
-                    output->targetTemp,
-                    modeStr ? modeStr : "off",
-                    output->currentPower,
-                    output->heating
-                );
-
-                // Update output name on display
-                if (output->name[0] != '\0') {
-                    display_set_output_name(i, output->name);
-                }
-            }
-        }
+    // Roll back an updated image that never reached the stable mark
+    ota_manager_task();
 
-        // Update system status for display
-        DisplaySystemData sysData = {0};
-        strncpy(sysData.deviceName, deviceName, sizeof(sysData.deviceName) - 1);
-        strncpy(sysData.firmwareVersion, FIRMWARE_VERSION, sizeof(sysData.firmwareVersion) - 1);
-        sysData.wifiConnected = !wifi_is_ap_mode();
-        sysData.mqttConnected = mqtt_is_connected();
-        sysData.uptime = (millis() - bootTime) / 1000;
-        sysData.freeMemory = (ESP.getFreeHeap() * 100) / ESP.getHeapSize();
-        display_update_system(&sysData);
-
-        lastDisplayUpdate = millis();
-    }
+    // Display, web and MQTT pick up output/network changes from the event bus
 
-    // Update webserver state (legacy - uses Output 1)
-    webserver_set_state(legacyState.currentTemp, legacyState.targetTemp, legacyState.heating,
-                       legacyState.mode, legacyState.power);
-    webserver_set_network_status(!wifi_is_ap_mode(), wifi_is_ap_mode(),
-                                 wifi_get_ssid(), wifi_get_ip_address());
-    
     // Publish MQTT status (every 30s) - Multi-output
     if (!wifi_is_ap_mode() && mqtt_is_connected()) {
         if (millis() - lastMqttPublish >= 30000) {
+            PROFILE_BEGIN(PROF_MQTT_PUBLISH);
+
             // Publish all 3 outputs status
-            mqtt_publish_all_outputs(WiFi.RSSI(), ESP.getFreeHeap(), millis() / 1000);
+            mqtt_publish_all_outputs(WiFi.RSSI(), ESP.getFreeHeap(), time_service_uptime_sec());
             lastMqttPublish = millis();
 
             // Send HA discovery once
@@ -319,23 +373,73 @@ void loop() {
                 mqtt_send_ha_discovery(devName, "reptile_thermostat_01");
                 discoveryDone = true;
             }
+
+            PROFILE_END(PROF_MQTT_PUBLISH);
         }
     }
+
+    PROFILE_END(PROF_LOOP_TOTAL);
 }
 
 // ===== HELPER FUNCTIONS =====
 
 /**
- * Read all sensors
+ * Heap low-block alert handler
+ */
+void onHeapLow(uint32_t largestBlock, uint32_t freeHeap) {
+    logger_add("Heap fragmented - OTA/TLS may fail");
+    if (!wifi_is_ap_mode()) {
+        mqtt_publish_heap_alert(largestBlock, freeHeap);
+    }
+}
+
+/**
+ * Control task
+ * Polls sensors and updates outputs every 100ms, independent of display
+ * and network. Sensor conversions run in the background between ticks
+ * (a new round every 2s), so no tick waits on a sensor. Started early in
+ * setup() and fed to the watchdog separately from loop().
+ */
+void controlTask(void* param) {
+    (void)param;
+    safety_manager_watchdog_subscribe();
+
+    TickType_t lastWake = xTaskGetTickCount();
+
+    for (;;) {
+        safety_manager_feed_watchdog();
+
+        // Start/collect sensor conversions (first round starts immediately)
+        PROFILE_BEGIN(PROF_SENSORS);
+        CRASH_BREADCRUMB(CRASH_SUB_SENSORS, CRASH_PT_ENTER);
+        readSensors();
+        CRASH_BREADCRUMB(CRASH_SUB_SENSORS, CRASH_PT_EXIT);
+        PROFILE_END(PROF_SENSORS);
+
+        // Update all outputs (every 100ms for responsive control)
+        PROFILE_BEGIN(PROF_OUTPUTS);
+        CRASH_BREADCRUMB(CRASH_SUB_OUTPUTS, CRASH_PT_ENTER);
+        updateOutputs();
+        CRASH_BREADCRUMB(CRASH_SUB_OUTPUTS, CRASH_PT_EXIT);
+        PROFILE_END(PROF_OUTPUTS);
+
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CONTROL_PERIOD_MS));
+    }
+}
+
+/**
+ * Poll sensors; history and console follow each completed round
  */
 void readSensors(void) {
-    sensor_manager_read_all();
+    if (!sensor_manager_poll()) {
+        return;
+    }
 
     // Update temperature history (use Output 1's sensor for now)
-    OutputConfig_t* output1 = output_manager_get_output(0);
+    OutputSnapshot output1(0);
     if (output1 && sensor_manager_is_valid_temp(output1->currentTemp)) {
         temp_history_record(output1->currentTemp);
-        console_add_event_f(CONSOLE_EVENT_TEMP, "Temp: %.1f°C", output1->currentTemp);
+        console_add_event_p(CONSOLE_EVENT_TEMP, CONSOLE_FMT_TEMP, output1->currentTemp);
     }
 }
 
@@ -346,43 +450,15 @@ void updateOutputs(void) {
     output_manager_update();
 }
 
-/**
- * Update legacy state from Output 1 (for TFT display and web compatibility)
- */
-void updateLegacyState(void) {
-    OutputConfig_t* output1 = output_manager_get_output(0);
-    if (!output1) return;
-
-    legacyState.currentTemp = output1->currentTemp;
-    legacyState.targetTemp = output1->targetTemp;
-    legacyState.heating = output1->heating;
-    legacyState.power = output1->currentPower;
+// ===== CALLBACK FUNCTIONS =====
 
-    // Map control mode to legacy mode string
-    switch (output1->controlMode) {
-        case CONTROL_MODE_OFF:
-            strcpy(legacyState.mode, "off");
-            break;
-        case CONTROL_MODE_MANUAL:
-            strcpy(legacyState.mode, "manual");
-            break;
-        case CONTROL_MODE_PID:
-            strcpy(legacyState.mode, "auto");
-            break;
-        case CONTROL_MODE_ONOFF:
-            strcpy(legacyState.mode, "onoff");
-            break;
-        case CONTROL_MODE_SCHEDULE:
-            strcpy(legacyState.mode, "schedule");
-            break;
-        default:
-            strcpy(legacyState.mode, "off");
-            break;
+void onTimeSync(int32_t stepSec) {
+    int moved = temp_history_restamp(TIME_VALID_EPOCH, stepSec);
+    if (moved > 0) {
+        console_add_event_f(CONSOLE_EVENT_SYSTEM, "Time: re-stamped %d history point(s) taken before sync", moved);
     }
 }
 
-// ===== CALLBACK FUNCTIONS =====
-
 void onMQTTSetpoint(const char* topic, const char* message) {
     // Apply to Output 1 (legacy compatibility)
     float newTarget = atof(message);
@@ -391,8 +467,7 @@ void onMQTTSetpoint(const char* topic, const char* message) {
 
         char log[64];
         snprintf(log, sizeof(log), "Output 1 target: %.1f°C (MQTT)", newTarget);
-        logger_add(log);
-        console_add_event_f(CONSOLE_EVENT_MQTT, "MQTT: Target %.1f°C", newTarget);
+        console_add_event_to(CONSOLE_EVENT_MQTT, CONSOLE_VIEW_CONSOLE | CONSOLE_VIEW_LOG, log);
 
         // tft_request_update();  // OLD TFT - display updates automatically
     }
@@ -416,8 +491,7 @@ void onMQTTMode(const char* topic, const char* message) {
 
     char log[64];
     snprintf(log, sizeof(log), "Output 1 mode: %s (MQTT)", newMode.c_str());
-    logger_add(log);
-    console_add_event_f(CONSOLE_EVENT_MQTT, "MQTT: Mode %s", newMode.c_str());
+    console_add_event_to(CONSOLE_EVENT_MQTT, CONSOLE_VIEW_CONSOLE | CONSOLE_VIEW_LOG, log);
 
     // tft_request_update();  // OLD TFT - display updates automatically
 }
@@ -440,16 +514,9 @@ void onWebControl(float temp, const char* newMode) {
 
     char log[64];
     snprintf(log, sizeof(log), "Output 1: %.1f°C, %s (Web)", temp, newMode);
-    logger_add(log);
-    console_add_event_f(CONSOLE_EVENT_SYSTEM, "Web control: %.1f°C %s", temp, newMode);
-
-    // tft_request_update();  // OLD TFT - display updates automatically
+    console_add_event_to(CONSOLE_EVENT_SYSTEM, CONSOLE_VIEW_CONSOLE | CONSOLE_VIEW_LOG, log);
 
-    // Publish to MQTT
-    if (mqtt_is_connected()) {
-        mqtt_publish_status(legacyState.currentTemp, legacyState.targetTemp,
-                           legacyState.heating, legacyState.mode, legacyState.power);
-    }
+    // Display and MQTT follow via the event bus
 }
 
 void onWebRestart(void) {
@@ -460,7 +527,7 @@ void onWebRestart(void) {
 /*  OLD TFT BUTTON HANDLER - NO LONGER USED
 void onTouchButton(int buttonId) {
     // TFT controls Output 1 only (legacy compatibility)
-    OutputConfig_t* output1 = output_manager_get_output(0);
+    OutputSnapshot output1(0);
     if (!output1) return;
 
     switch (buttonId) {
@@ -471,11 +538,6 @@ void onTouchButton(int buttonId) {
                 if (newTarget > 45.0) newTarget = 45.0;
                 output_manager_set_target(0, newTarget);
                 tft_request_update();
-
-                if (mqtt_is_connected()) {
-                    mqtt_publish_status(legacyState.currentTemp, legacyState.targetTemp,
-                                       legacyState.heating, legacyState.mode, legacyState.power);
-                }
             }
             break;
 
@@ -486,11 +548,6 @@ void onTouchButton(int buttonId) {
                 if (newTarget < 15.0) newTarget = 15.0;
                 output_manager_set_target(0, newTarget);
                 tft_request_update();
-
-                if (mqtt_is_connected()) {
-                    mqtt_publish_status(legacyState.currentTemp, legacyState.targetTemp,
-                                       legacyState.heating, legacyState.mode, legacyState.power);
-                }
             }
             break;
 
@@ -0,0 +1,246 @@
+/**
+ * fleet_frame.cpp
+ * Fleet Status Frame and Peer Table Implementation
+ */
+
+#include "fleet_frame.h"
+#include "frame_codec.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// ===== FRAME =====
+
+/**
+ * Encode a status frame
+ */
+size_t fleet_frame_encode(const FleetStatus_t* status, uint8_t* buf, size_t len) {
+    if (len < FLEET_FRAME_SIZE) {
+        return 0;
+    }
+    memset(buf, 0, FLEET_FRAME_SIZE);
+    buf[0] = 'T';
+    buf[1] = 'F';
+    buf[2] = FLEET_VERSION;
+    buf[3] = status->outputCount > FLEET_OUTPUTS ? FLEET_OUTPUTS : status->outputCount;
+    frame_put32(buf + 4, status->nodeId);
+    frame_put16(buf + 8, status->seq);
+    frame_put32(buf + 10, status->uptimeSec);
+    memcpy(buf + 14, status->name, strnlen(status->name, FLEET_NAME_LEN));
+
+    for (int i = 0; i < FLEET_OUTPUTS; i++) {
+        const FleetOutput_t* o = &status->outputs[i];
+        uint8_t* p = buf + 30 + 8 * i;
+        frame_put16(p, (uint16_t)frame_encode_temp(o->temp));
+        frame_put16(p + 2, (uint16_t)frame_encode_temp(o->target));
+        p[4] = frame_encode_humidity(o->humidity);
+        p[5] = o->power;
+        p[6] = o->mode;
+        p[7] = o->flags;
+    }
+    return FLEET_FRAME_SIZE;
+}
+
+/**
+ * Decode a status frame
+ */
+bool fleet_frame_decode(const uint8_t* buf, size_t len, FleetStatus_t* status) {
+    if (len != FLEET_FRAME_SIZE || buf[0] != 'T' || buf[1] != 'F' || buf[2] != FLEET_VERSION ||
+        buf[3] > FLEET_OUTPUTS) {
+        return false;
+    }
+    memset(status, 0, sizeof(*status));
+    status->outputCount = buf[3];
+    status->nodeId = frame_get32(buf + 4);
+    status->seq = frame_get16(buf + 8);
+    status->uptimeSec = frame_get32(buf + 10);
+    memcpy(status->name, buf + 14, FLEET_NAME_LEN);
+    status->name[FLEET_NAME_LEN] = '\0';
+
+    for (int i = 0; i < FLEET_OUTPUTS; i++) {
+        FleetOutput_t* o = &status->outputs[i];
+        const uint8_t* p = buf + 30 + 8 * i;
+        o->temp = frame_decode_temp((int16_t)frame_get16(p));
+        o->target = frame_decode_temp((int16_t)frame_get16(p + 2));
+        o->humidity = frame_decode_humidity(p[4]);
+        o->power = p[5];
+        o->mode = p[6];
+        o->flags = p[7];
+    }
+    return true;
+}
+
+// ===== PEER TABLE =====
+
+/**
+ * Initialize a peer table
+ */
+void fleet_table_init(FleetTable_t* table, FleetPeer_t* storage, int capacity) {
+    memset(table, 0, sizeof(*table));
+    memset(storage, 0, capacity * sizeof(FleetPeer_t));
+    table->peers = storage;
+    table->capacity = capacity;
+}
+
+/**
+ * Record a received frame
+ */
+FleetPeer_t* fleet_table_receive(FleetTable_t* table, const uint8_t* buf, size_t len,
+                                 uint32_t ip, uint32_t nowMs) {
+    FleetStatus_t status;
+    if (!fleet_frame_decode(buf, len, &status)) {
+        table->rejected++;
+        return nullptr;
+    }
+
+    FleetPeer_t* peer = nullptr;
+    FleetPeer_t* freeSlot = nullptr;
+    for (int i = 0; i < table->capacity; i++) {
+        FleetPeer_t* p = &table->peers[i];
+        if (!p->used) {
+            if (!freeSlot) freeSlot = p;
+        } else if (p->status.nodeId == status.nodeId) {
+            peer = p;
+            break;
+        }
+    }
+
+    if (peer) {
+        // Gaps up to half the sequence space are losses; anything else is a reboot
+        uint16_t gap = (uint16_t)(status.seq - peer->status.seq);
+        if (gap > 1 && gap < 0x8000) {
+            peer->lost += gap - 1;
+        }
+    } else if (freeSlot) {
+        peer = freeSlot;
+        memset(peer, 0, sizeof(*peer));
+        peer->used = true;
+    } else {
+        table->full++;
+        return nullptr;
+    }
+
+    peer->status = status;
+    peer->ip = ip;
+    peer->lastSeenMs = nowMs;
+    peer->frames++;
+    table->framesIn++;
+    table->bytesIn += (uint32_t)len;
+    return peer;
+}
+
+/**
+ * Drop silent peers
+ */
+int fleet_table_expire(FleetTable_t* table, uint32_t nowMs) {
+    int dropped = 0;
+    for (int i = 0; i < table->capacity; i++) {
+        FleetPeer_t* p = &table->peers[i];
+        if (p->used && nowMs - p->lastSeenMs >= FLEET_PEER_TIMEOUT_MS) {
+            p->used = false;
+            dropped++;
+        }
+    }
+    return dropped;
+}
+
+/**
+ * Count live peers
+ */
+int fleet_table_count(const FleetTable_t* table) {
+    int count = 0;
+    for (int i = 0; i < table->capacity; i++) {
+        if (table->peers[i].used) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// ===== JSON =====
+
+static size_t appendf(char* buf, size_t len, size_t pos, const char* fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static size_t appendf(char* buf, size_t len, size_t pos, const char* fmt, ...) {
+    if (pos >= len) {
+        return pos;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + pos, len - pos, fmt, args);
+    va_end(args);
+    return n < 0 ? pos : pos + (size_t)n;
+}
+
+static size_t appendNumber(char* buf, size_t len, size_t pos, float v) {
+    return isnan(v) ? appendf(buf, len, pos, "null") : appendf(buf, len, pos, "%.1f", v);
+}
+
+/**
+ * Format one peer for GET /api/v1/fleet
+ */
+size_t fleet_peer_json(const FleetPeer_t* peer, uint32_t nowMs, bool self, char* buf, size_t len) {
+    const FleetStatus_t* s = &peer->status;
+    size_t pos = appendf(buf, len, 0, "{\"id\":\"%08lx\",\"name\":\"", (unsigned long)s->nodeId);
+    for (const char* c = s->name; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            pos = appendf(buf, len, pos, "\\%c", *c);
+        } else if ((unsigned char)*c < 0x20) {
+            pos = appendf(buf, len, pos, "\\u%04x", (unsigned char)*c);
+        } else {
+            pos = appendf(buf, len, pos, "%c", *c);
+        }
+    }
+    const uint8_t* ip = (const uint8_t*)&peer->ip;
+    pos = appendf(buf, len, pos,
+                  "\",\"ip\":\"%u.%u.%u.%u\",\"self\":%s,\"ageSec\":%lu,\"uptime\":%lu,"
+                  "\"frames\":%lu,\"lost\":%lu,\"outputs\":[",
+                  ip[0], ip[1], ip[2], ip[3], self ? "true" : "false",
+                  (unsigned long)((nowMs - peer->lastSeenMs) / 1000), (unsigned long)s->uptimeSec,
+                  (unsigned long)peer->frames, (unsigned long)peer->lost);
+    for (int i = 0; i < s->outputCount; i++) {
+        const FleetOutput_t* o = &s->outputs[i];
+        pos = appendf(buf, len, pos, "%s{\"temp\":", i ? "," : "");
+        pos = appendNumber(buf, len, pos, o->temp);
+        pos = appendf(buf, len, pos, ",\"target\":");
+        pos = appendNumber(buf, len, pos, o->target);
+        pos = appendf(buf, len, pos, ",\"humidity\":");
+        pos = appendNumber(buf, len, pos, o->humidity);
+        pos = appendf(buf, len, pos,
+                      ",\"power\":%u,\"mode\":%u,\"enabled\":%s,\"heating\":%s,\"fault\":%s}",
+                      o->power, o->mode, (o->flags & FLEET_OUT_ENABLED) ? "true" : "false",
+                      (o->flags & FLEET_OUT_HEATING) ? "true" : "false",
+                      (o->flags & FLEET_OUT_FAULT) ? "true" : "false");
+    }
+    pos = appendf(buf, len, pos, "]}");
+    return pos < len ? pos : 0;
+}
+
+// ===== DASHBOARD =====
+
+// Mode names follow ControlMode_t
+const char FLEET_DASHBOARD_JS[] =
+    "const FLEET_MODES=['Off','Manual','PID','On/Off','Schedule','Time-Prop','Cascade','Humidity'];"
+    "function fleetEsc(s){return String(s).replace(/[&<>\"']/g,c=>'&#'+c.charCodeAt(0)+';');}"
+    "function fleetCell(o){if(!o.enabled){return '<td style=\"color:#999\">disabled</td>';}"
+    "let bg=o.fault?'#ffcdd2':(o.heating?'#fff3e0':'');"
+    "let t=o.temp===null?'--':o.temp.toFixed(1)+'°C';"
+    "let rh=o.humidity===null?'':' '+o.humidity.toFixed(0)+'%RH';"
+    "return '<td style=\"padding:8px;background:'+bg+'\"><b>'+t+'</b>'+rh+' &rarr; '+(o.target===null?'--':o.target.toFixed(1))+"
+    "'<br><small>'+(FLEET_MODES[o.mode]||o.mode)+', '+o.power+'%'+(o.fault?', FAULT':'')+'</small></td>';}"
+    "function fleetLoad(){fetch('/api/v1/fleet').then(r=>r.json()).then(j=>{let d=j.data;"
+    "d.nodes.sort((a,b)=>a.name.localeCompare(b.name));"
+    "let lost=d.nodes.reduce((n,p)=>n+p.lost,0);"
+    "let h='<p>'+d.nodes.length+' units | '+d.stats.framesIn+' frames received, '+lost+' lost, '+d.stats.rejected+' rejected</p>';"
+    "h+='<table style=\"width:100%;border-collapse:collapse\"><tr style=\"background:#f0f0f0\">"
+    "<th style=\"padding:8px;text-align:left\">Unit</th><th>Output 1</th><th>Output 2</th><th>Output 3</th><th>Seen</th></tr>';"
+    "d.nodes.forEach(n=>{h+='<tr style=\"border-bottom:1px solid #ddd\"><td style=\"padding:8px\">"
+    "<a href=\"http://'+n.ip+'/\">'+fleetEsc(n.name||n.id)+'</a>'+(n.self?' (this unit)':'')+"
+    "'<br><small>'+n.ip+' | up '+Math.floor(n.uptime/3600)+'h</small></td>';"
+    "for(let i=0;i<3;i++){h+=i<n.outputs.length?fleetCell(n.outputs[i]):'<td></td>';}"
+    "h+='<td style=\"padding:8px\">'+(n.self?'-':n.ageSec+'s ago')+'</td></tr>';});"
+    "document.getElementById('fleet').innerHTML=h+'</table>';})"
+    ".catch(e=>{document.getElementById('fleet').innerText='Fleet data unavailable';});}"
+    "fleetLoad();setInterval(fleetLoad,5000);";
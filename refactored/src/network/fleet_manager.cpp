@@ -0,0 +1,212 @@
+/**
+ * fleet_manager.cpp
+ * Fleet Status Multicast Implementation
+ */
+
+#include "fleet_manager.h"
+#include "output_manager.h"
+#include "sensor_manager.h"
+#include "console.h"
+#include "time_service.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <Preferences.h>
+
+static bool enabled = false;
+static bool joined = false;
+static WiFiUDP udp;
+
+static FleetTable_t table;
+static FleetPeer_t* peers = nullptr;   // FLEET_MAX_PEERS, allocated when enabled
+
+static uint32_t nodeId = 0;
+static char nodeName[FLEET_NAME_LEN + 1] = "";
+static uint16_t txSeq = 0;
+static uint32_t framesSent = 0;
+static unsigned long lastTx = 0;
+static unsigned long txOffset = 0;     // Spreads units across the period
+static unsigned long lastExpire = 0;
+
+static void buildStatus(FleetStatus_t* status);
+static void receiveFrames(void);
+static void sendFrame(void);
+
+/**
+ * Initialize fleet mode
+ */
+void fleet_init(void) {
+    Preferences prefs;
+    prefs.begin("thermostat", true);
+    enabled = prefs.getBool("fleet_en", false);
+    String name = prefs.getString("device_name", "ESP32-Thermostat");
+    prefs.end();
+
+    if (!enabled) {
+        return;
+    }
+
+    peers = (FleetPeer_t*)calloc(FLEET_MAX_PEERS, sizeof(FleetPeer_t));
+    if (!peers) {
+        Serial.println("[Fleet] No memory for the peer table, fleet mode off");
+        enabled = false;
+        return;
+    }
+    fleet_table_init(&table, peers, FLEET_MAX_PEERS);
+
+    nodeId = (uint32_t)ESP.getEfuseMac();
+    strncpy(nodeName, name.c_str(), FLEET_NAME_LEN);
+    nodeName[FLEET_NAME_LEN] = '\0';
+    txOffset = nodeId % FLEET_TX_PERIOD_MS;
+
+    Serial.printf("[Fleet] Enabled, node %08lx on %s:%d\n", (unsigned long)nodeId, FLEET_GROUP, FLEET_PORT);
+}
+
+/**
+ * Fleet task
+ */
+void fleet_task(void) {
+    if (!enabled) {
+        return;
+    }
+
+    if (!WiFi.isConnected()) {
+        if (joined) {
+            udp.stop();
+            joined = false;
+        }
+        return;
+    }
+    if (!joined) {
+        IPAddress group;
+        group.fromString(FLEET_GROUP);
+        joined = udp.beginMulticast(group, FLEET_PORT);
+        if (!joined) {
+            return;
+        }
+        lastTx = millis() - FLEET_TX_PERIOD_MS + txOffset;
+        console_add_event_f(CONSOLE_EVENT_SYSTEM, "Fleet: joined %s:%d", FLEET_GROUP, FLEET_PORT);
+    }
+
+    receiveFrames();
+
+    unsigned long now = millis();
+    if (now - lastTx >= FLEET_TX_PERIOD_MS) {
+        lastTx = now;
+        sendFrame();
+    }
+    if (now - lastExpire >= 1000) {
+        lastExpire = now;
+        int dropped = fleet_table_expire(&table, now);
+        if (dropped > 0) {
+            console_add_event_f(CONSOLE_EVENT_SYSTEM, "Fleet: %d unit(s) went silent", dropped);
+        }
+    }
+}
+
+/**
+ * Handle pending frames (bounded so a flood can't stall the loop)
+ */
+static void receiveFrames(void) {
+    uint8_t buf[FLEET_FRAME_SIZE + 1];
+    for (int i = 0; i < FLEET_RX_PER_TASK; i++) {
+        int size = udp.parsePacket();
+        if (size <= 0) {
+            return;
+        }
+        int len = udp.read(buf, sizeof(buf));   // Oversized packets are cut and rejected
+        if (len <= 0) {
+            continue;
+        }
+
+        // Our own frames come back through multicast loopback
+        FleetStatus_t status;
+        if (fleet_frame_decode(buf, len, &status) && status.nodeId == nodeId) {
+            continue;
+        }
+
+        FleetPeer_t* peer = fleet_table_receive(&table, buf, len, (uint32_t)udp.remoteIP(), millis());
+        if (peer && peer->frames == 1) {
+            console_add_event_f(CONSOLE_EVENT_SYSTEM, "Fleet: found %s (%s)",
+                                peer->status.name, udp.remoteIP().toString().c_str());
+        }
+    }
+}
+
+/**
+ * Multicast our status
+ */
+static void sendFrame(void) {
+    FleetStatus_t status;
+    buildStatus(&status);
+    status.seq = txSeq++;
+
+    uint8_t buf[FLEET_FRAME_SIZE];
+    size_t len = fleet_frame_encode(&status, buf, sizeof(buf));
+    if (udp.beginMulticastPacket() && udp.write(buf, len) == len && udp.endPacket()) {
+        framesSent++;
+    }
+}
+
+/**
+ * Fill in this unit's status from the output snapshots
+ */
+static void buildStatus(FleetStatus_t* status) {
+    memset(status, 0, sizeof(*status));
+    status->nodeId = nodeId;
+    status->seq = txSeq;
+    status->uptimeSec = time_service_uptime_sec();
+    strlcpy(status->name, nodeName, sizeof(status->name));
+    status->outputCount = FLEET_OUTPUTS;
+
+    for (int i = 0; i < FLEET_OUTPUTS; i++) {
+        FleetOutput_t* o = &status->outputs[i];
+        OutputSnapshot output(i);
+        if (!output) {
+            o->temp = NAN;
+            o->target = NAN;
+            o->humidity = NAN;
+            continue;
+        }
+        o->temp = sensor_manager_is_valid_temp(output->currentTemp) ? output->currentTemp : NAN;
+        o->target = output->targetTemp;
+        o->humidity = sensor_manager_is_valid_humidity(output->currentHumidity) ? output->currentHumidity : NAN;
+        o->power = (uint8_t)constrain(output->currentPower, 0, 100);
+        o->mode = (uint8_t)output->controlMode;
+        o->flags = (output->enabled ? FLEET_OUT_ENABLED : 0) |
+                   (output->heating ? FLEET_OUT_HEATING : 0) |
+                   (output->faultState != FAULT_NONE ? FLEET_OUT_FAULT : 0);
+    }
+}
+
+/**
+ * Check if fleet mode is on
+ */
+bool fleet_is_enabled(void) {
+    return enabled;
+}
+
+/**
+ * Own entry for the dashboard
+ */
+void fleet_get_self(FleetPeer_t* peer) {
+    memset(peer, 0, sizeof(*peer));
+    peer->used = true;
+    buildStatus(&peer->status);
+    peer->ip = (uint32_t)WiFi.localIP();
+    peer->lastSeenMs = millis();
+    peer->frames = framesSent;
+}
+
+/**
+ * Peer table
+ */
+const FleetTable_t* fleet_get_table(void) {
+    return enabled ? &table : nullptr;
+}
+
+/**
+ * Frames sent
+ */
+uint32_t fleet_get_frames_sent(void) {
+    return framesSent;
+}
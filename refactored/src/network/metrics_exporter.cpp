@@ -0,0 +1,401 @@
+/**
+ * metrics_exporter.cpp
+ * Prometheus Metrics Exposition Implementation
+ */
+
+#include "metrics_exporter.h"
+#include "output_manager.h"
+#include "sensor_manager.h"
+#include "energy_meter.h"
+#include "mqtt_manager.h"
+#include "event_bus.h"
+#include "loop_profiler.h"
+#include "safety_manager.h"
+#include "time_service.h"
+#include <WiFi.h>
+
+// Histogram bounds: every second power of two CPU cycles, 2^12 (~17us
+// at 240MHz) to 2^32 (~18s). Bounds are cumulative, so skipping every
+// other profiler bucket keeps the counts exact.
+#define HIST_FIRST_SHIFT 12
+#define HIST_LAST_SHIFT 32
+#define HIST_STEP 2
+
+#define CONTROL_MODE_COUNT (CONTROL_MODE_HUMIDITY + 1)
+#define FAULT_STATE_COUNT (FAULT_HEATER_RUNAWAY + 1)
+
+/**
+ * Metric families (output order)
+ */
+typedef enum {
+    M_BUILD_INFO = 0,
+    M_UPTIME,
+    M_SAFE_MODE,
+    M_OUTPUT_ENABLED,
+    M_OUTPUT_MODE,
+    M_OUTPUT_TEMP,
+    M_OUTPUT_TARGET,
+    M_OUTPUT_HUMIDITY,
+    M_OUTPUT_POWER,
+    M_OUTPUT_HEATING,
+    M_OUTPUT_FAULT,
+    M_OUTPUT_WATTS,
+    M_OUTPUT_ENERGY,
+    M_SENSOR_TEMP,
+    M_SENSOR_HUMIDITY,
+    M_SENSOR_ERRORS,
+    M_SENSOR_CONSECUTIVE,
+    M_WIFI_CONNECTED,
+    M_WIFI_RSSI,
+    M_MQTT_CONNECTED,
+    M_MQTT_CONNECTS,
+    M_MQTT_FAILURES,
+    M_HEAP_FREE,
+    M_HEAP_MIN_FREE,
+    M_HEAP_LARGEST,
+    M_HEAP_SIZE,
+    M_EVENTS_PUBLISHED,
+    M_EVENTS_DROPPED,
+    M_LOOP_SECONDS,
+    M_COUNT
+} MetricId_t;
+
+typedef struct {
+    const char* name;
+    const char* type;
+    const char* help;
+} MetricFamily_t;
+
+static const MetricFamily_t FAMILIES[M_COUNT] = {
+    {"thermostat_build_info", "gauge", "Firmware version"},
+    {"thermostat_uptime_seconds", "gauge", "Seconds since boot"},
+    {"thermostat_safe_mode", "gauge", "1 while in safe mode"},
+    {"thermostat_output_enabled", "gauge", "1 if the output is enabled"},
+    {"thermostat_output_mode", "gauge", "Control mode (one series per mode, 1 for the active one)"},
+    {"thermostat_output_temperature_celsius", "gauge", "Control sensor temperature"},
+    {"thermostat_output_target_celsius", "gauge", "Target temperature"},
+    {"thermostat_output_humidity_percent", "gauge", "Control sensor relative humidity"},
+    {"thermostat_output_power_percent", "gauge", "Output power"},
+    {"thermostat_output_heating", "gauge", "1 while the output is driving its load"},
+    {"thermostat_output_fault", "gauge", "Fault state (one series per fault, 1 for the active one)"},
+    {"thermostat_output_power_watts", "gauge", "Estimated power delivered (rated watts x share)"},
+    {"thermostat_output_energy_joules_total", "counter", "Energy delivered since the meter was reset"},
+    {"thermostat_sensor_temperature_celsius", "gauge", "Last sensor temperature"},
+    {"thermostat_sensor_humidity_percent", "gauge", "Last sensor relative humidity"},
+    {"thermostat_sensor_read_errors_total", "counter", "Failed sensor reads"},
+    {"thermostat_sensor_consecutive_errors", "gauge", "Failed sensor reads since the last good one"},
+    {"thermostat_wifi_connected", "gauge", "1 while WiFi is connected"},
+    {"thermostat_wifi_rssi_dbm", "gauge", "WiFi signal strength"},
+    {"thermostat_mqtt_connected", "gauge", "1 while connected to the MQTT broker"},
+    {"thermostat_mqtt_connects_total", "counter", "Successful MQTT broker connections"},
+    {"thermostat_mqtt_connect_failures_total", "counter", "Failed MQTT connection attempts"},
+    {"thermostat_heap_free_bytes", "gauge", "Free heap"},
+    {"thermostat_heap_min_free_bytes", "gauge", "Lowest free heap since boot"},
+    {"thermostat_heap_largest_block_bytes", "gauge", "Largest allocatable heap block"},
+    {"thermostat_heap_size_bytes", "gauge", "Total heap"},
+    {"thermostat_events_published_total", "counter", "Event bus events published"},
+    {"thermostat_events_dropped_total", "counter", "Event bus events dropped (subscriber queue full)"},
+    {"thermostat_loop_section_seconds", "histogram", "Main loop section run time"},
+};
+
+/**
+ * Per-output values, copied once so each family doesn't re-take the lock
+ */
+typedef struct {
+    bool valid;
+    char name[32];
+    bool enabled;
+    ControlMode_t mode;
+    float temp;
+    float target;
+    float humidity;
+    int power;
+    bool heating;
+    FaultState_t fault;
+    float watts;
+    uint64_t energyMj;
+} OutputMetrics_t;
+
+// ===== FORMATTING =====
+
+static void writeLine(Print& out, const char* line, int len, size_t size) {
+    if (len > 0) {
+        out.write((const uint8_t*)line, (size_t)len < size ? (size_t)len : size - 1);
+    }
+}
+
+static void writeFamily(Print& out, MetricId_t id) {
+    const MetricFamily_t* f = &FAMILIES[id];
+    char line[160];
+    int len = snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n", f->name, f->help, f->name, f->type);
+    writeLine(out, line, len, sizeof(line));
+}
+
+/**
+ * Write one sample: name{labels} value (labels may be empty)
+ * @param suffix Appended to the family name (histogram _bucket/_sum/_count), or ""
+ */
+static void writeSample(Print& out, MetricId_t id, const char* suffix, const char* labels, const char* value) {
+    char line[256];
+    int len = snprintf(line, sizeof(line), "%s%s%s%s%s %s\n", FAMILIES[id].name, suffix,
+                       labels[0] ? "{" : "", labels, labels[0] ? "}" : "", value);
+    writeLine(out, line, len, sizeof(line));
+}
+
+static void writeFloat(Print& out, MetricId_t id, const char* labels, float v) {
+    char value[24];
+    snprintf(value, sizeof(value), "%.2f", v);
+    writeSample(out, id, "", labels, value);
+}
+
+static void writeUint(Print& out, MetricId_t id, const char* labels, uint64_t v) {
+    char value[24];
+    snprintf(value, sizeof(value), "%llu", (unsigned long long)v);
+    writeSample(out, id, "", labels, value);
+}
+
+static void writeInt(Print& out, MetricId_t id, const char* labels, long v) {
+    char value[24];
+    snprintf(value, sizeof(value), "%ld", v);
+    writeSample(out, id, "", labels, value);
+}
+
+/**
+ * Append key="value" to a label list, escaping the value
+ */
+static void addLabel(char* buf, size_t len, const char* key, const char* value) {
+    size_t pos = strlen(buf);
+    pos += snprintf(buf + pos, pos < len ? len - pos : 0, "%s%s=\"", pos ? "," : "", key);
+    for (const char* c = value; *c && pos + 3 < len; c++) {
+        if (*c == '"' || *c == '\\') {
+            buf[pos++] = '\\';
+            buf[pos++] = *c;
+        } else if (*c == '\n') {
+            buf[pos++] = '\\';
+            buf[pos++] = 'n';
+        } else {
+            buf[pos++] = *c;
+        }
+    }
+    if (pos + 1 < len) {
+        buf[pos++] = '"';
+    }
+    buf[pos < len ? pos : len - 1] = '\0';
+}
+
+static void outputLabels(char* buf, size_t len, int index, const OutputMetrics_t* o) {
+    char id[12];   // Fits any int
+    snprintf(id, sizeof(id), "%d", index + 1);
+    buf[0] = '\0';
+    addLabel(buf, len, "output", id);
+    addLabel(buf, len, "name", o->name);
+}
+
+/**
+ * Write a state set: one sample per state, 1 for the active one, so a
+ * change moves the 1 between series instead of leaving the old one stale
+ */
+static void writeStateSet(Print& out, MetricId_t id, const char* labels, const char* key,
+                          int first, int count, int active, const char* (*stateName)(int)) {
+    char stateLabels[192];
+    for (int state = first; state < count; state++) {
+        strlcpy(stateLabels, labels, sizeof(stateLabels));
+        addLabel(stateLabels, sizeof(stateLabels), key, stateName(state));
+        writeInt(out, id, stateLabels, state == active);
+    }
+}
+
+static const char* modeName(int mode) {
+    return output_manager_get_mode_name((ControlMode_t)mode);
+}
+
+static const char* faultName(int fault) {
+    return output_manager_get_fault_name((FaultState_t)fault);
+}
+
+static void sensorLabels(char* buf, size_t len, const SensorInfo_t* s) {
+    buf[0] = '\0';
+    addLabel(buf, len, "sensor", s->addressString);
+    addLabel(buf, len, "name", s->name);
+}
+
+// ===== FAMILIES =====
+
+static void collectOutputs(OutputMetrics_t* outputs) {
+    for (int i = 0; i < MAX_OUTPUTS; i++) {
+        OutputMetrics_t* o = &outputs[i];
+        EnergyMeter_t meter;
+        o->energyMj = output_manager_get_energy(i, &meter) ? meter.energyMj : 0;
+
+        OutputSnapshot output(i);
+        o->valid = (bool)output;
+        if (!o->valid) {
+            continue;
+        }
+        strlcpy(o->name, output->name, sizeof(o->name));
+        o->enabled = output->enabled;
+        o->mode = output->controlMode;
+        o->temp = output->currentTemp;
+        o->target = output->targetTemp;
+        o->humidity = output->currentHumidity;
+        o->power = output->currentPower;
+        o->heating = output->heating;
+        o->fault = output->faultState;
+        o->watts = output->powerW;
+    }
+}
+
+static void writeOutputs(Print& out) {
+    OutputMetrics_t outputs[MAX_OUTPUTS];
+    memset(outputs, 0, sizeof(outputs));
+    collectOutputs(outputs);
+    char labels[160];
+
+    for (int id = M_OUTPUT_ENABLED; id <= M_OUTPUT_ENERGY; id++) {
+        writeFamily(out, (MetricId_t)id);
+        for (int i = 0; i < MAX_OUTPUTS; i++) {
+            const OutputMetrics_t* o = &outputs[i];
+            if (!o->valid) {
+                continue;
+            }
+            outputLabels(labels, sizeof(labels), i, o);
+            switch (id) {
+                case M_OUTPUT_ENABLED:  writeInt(out, M_OUTPUT_ENABLED, labels, o->enabled); break;
+                case M_OUTPUT_MODE:
+                    writeStateSet(out, M_OUTPUT_MODE, labels, "mode", 0, CONTROL_MODE_COUNT, o->mode, modeName);
+                    break;
+                case M_OUTPUT_TEMP:
+                    if (sensor_manager_is_valid_temp(o->temp)) writeFloat(out, M_OUTPUT_TEMP, labels, o->temp);
+                    break;
+                case M_OUTPUT_TARGET:   writeFloat(out, M_OUTPUT_TARGET, labels, o->target); break;
+                case M_OUTPUT_HUMIDITY:
+                    if (sensor_manager_is_valid_humidity(o->humidity)) writeFloat(out, M_OUTPUT_HUMIDITY, labels, o->humidity);
+                    break;
+                case M_OUTPUT_POWER:    writeInt(out, M_OUTPUT_POWER, labels, o->power); break;
+                case M_OUTPUT_HEATING:  writeInt(out, M_OUTPUT_HEATING, labels, o->heating); break;
+                case M_OUTPUT_FAULT:
+                    // No "none" series: any sample at 1 is a fault
+                    writeStateSet(out, M_OUTPUT_FAULT, labels, "fault", FAULT_NONE + 1, FAULT_STATE_COUNT,
+                                  o->fault, faultName);
+                    break;
+                case M_OUTPUT_WATTS:    writeFloat(out, M_OUTPUT_WATTS, labels, o->watts); break;
+                case M_OUTPUT_ENERGY:
+                    // Integer joules: exact, and a float would lose precision past ~16 MJ
+                    writeUint(out, M_OUTPUT_ENERGY, labels, o->energyMj / 1000);
+                    break;
+            }
+        }
+    }
+}
+
+static void writeSensors(Print& out) {
+    char labels[128];
+    int count = sensor_manager_get_count();
+    for (int id = M_SENSOR_TEMP; id <= M_SENSOR_CONSECUTIVE; id++) {
+        writeFamily(out, (MetricId_t)id);
+        for (int i = 0; i < count; i++) {
+            const SensorInfo_t* s = sensor_manager_get_sensor(i);
+            if (!s || !s->discovered) {
+                continue;
+            }
+            sensorLabels(labels, sizeof(labels), s);
+            switch (id) {
+                case M_SENSOR_TEMP:
+                    if (sensor_manager_is_valid_temp(s->lastReading)) writeFloat(out, M_SENSOR_TEMP, labels, s->lastReading);
+                    break;
+                case M_SENSOR_HUMIDITY:
+                    if (sensor_manager_is_valid_humidity(s->lastHumidity)) writeFloat(out, M_SENSOR_HUMIDITY, labels, s->lastHumidity);
+                    break;
+                case M_SENSOR_ERRORS:      writeUint(out, M_SENSOR_ERRORS, labels, s->totalErrors); break;
+                case M_SENSOR_CONSECUTIVE: writeInt(out, M_SENSOR_CONSECUTIVE, labels, s->errorCount); break;
+            }
+        }
+    }
+}
+
+static void writeLoopHistograms(Print& out) {
+    writeFamily(out, M_LOOP_SECONDS);
+    char labels[48];
+    char value[24];
+    for (int s = 0; s < PROF_SECTION_COUNT; s++) {
+        const ProfilerStats_t* stats = profiler_get_stats((ProfilerSection_t)s);
+        if (!stats) {
+            return;   // Profiler compiled out
+        }
+        const char* section = profiler_get_section_name((ProfilerSection_t)s);
+
+        uint64_t cumulative = 0;
+        int bucket = 0;
+        for (int shift = HIST_FIRST_SHIFT; shift <= HIST_LAST_SHIFT; shift += HIST_STEP) {
+            // Profiler bucket n holds [2^n, 2^(n+1)) cycles: all below 2^shift
+            for (; bucket < shift && bucket < PROFILER_BUCKETS; bucket++) {
+                cumulative += stats->buckets[bucket];
+            }
+            snprintf(labels, sizeof(labels), "section=\"%s\",le=\"%.6g\"", section,
+                     profiler_cycles_to_us(1ULL << shift) / 1e6);
+            snprintf(value, sizeof(value), "%llu", (unsigned long long)cumulative);
+            writeSample(out, M_LOOP_SECONDS, "_bucket", labels, value);
+        }
+        snprintf(labels, sizeof(labels), "section=\"%s\",le=\"+Inf\"", section);
+        snprintf(value, sizeof(value), "%lu", (unsigned long)stats->count);
+        writeSample(out, M_LOOP_SECONDS, "_bucket", labels, value);
+
+        snprintf(labels, sizeof(labels), "section=\"%s\"", section);
+        snprintf(value, sizeof(value), "%.6f", profiler_cycles_to_us64(stats->totalCycles) / 1e6);
+        writeSample(out, M_LOOP_SECONDS, "_sum", labels, value);
+        snprintf(value, sizeof(value), "%lu", (unsigned long)stats->count);
+        writeSample(out, M_LOOP_SECONDS, "_count", labels, value);
+    }
+}
+
+/**
+ * Write every metric family
+ */
+void metrics_exporter_write(Print& out, const char* version) {
+    char labels[64];
+
+    labels[0] = '\0';
+    addLabel(labels, sizeof(labels), "version", version);
+    writeFamily(out, M_BUILD_INFO);
+    writeInt(out, M_BUILD_INFO, labels, 1);
+    writeFamily(out, M_UPTIME);
+    writeUint(out, M_UPTIME, "", time_service_uptime_sec());
+    writeFamily(out, M_SAFE_MODE);
+    writeInt(out, M_SAFE_MODE, "", safety_manager_is_safe_mode());
+
+    writeOutputs(out);
+    writeSensors(out);
+
+    writeFamily(out, M_WIFI_CONNECTED);
+    writeInt(out, M_WIFI_CONNECTED, "", WiFi.isConnected());
+    if (WiFi.isConnected()) {
+        writeFamily(out, M_WIFI_RSSI);
+        writeInt(out, M_WIFI_RSSI, "", WiFi.RSSI());
+    }
+    writeFamily(out, M_MQTT_CONNECTED);
+    writeInt(out, M_MQTT_CONNECTED, "", mqtt_is_connected());
+    writeFamily(out, M_MQTT_CONNECTS);
+    writeUint(out, M_MQTT_CONNECTS, "", mqtt_get_connect_count());
+    writeFamily(out, M_MQTT_FAILURES);
+    writeUint(out, M_MQTT_FAILURES, "", mqtt_get_connect_failures());
+
+    writeFamily(out, M_HEAP_FREE);
+    writeUint(out, M_HEAP_FREE, "", ESP.getFreeHeap());
+    writeFamily(out, M_HEAP_MIN_FREE);
+    writeUint(out, M_HEAP_MIN_FREE, "", ESP.getMinFreeHeap());
+    writeFamily(out, M_HEAP_LARGEST);
+    writeUint(out, M_HEAP_LARGEST, "", ESP.getMaxAllocHeap());
+    writeFamily(out, M_HEAP_SIZE);
+    writeUint(out, M_HEAP_SIZE, "", ESP.getHeapSize());
+
+    writeFamily(out, M_EVENTS_PUBLISHED);
+    writeUint(out, M_EVENTS_PUBLISHED, "", event_bus_get_published());
+    writeFamily(out, M_EVENTS_DROPPED);
+    for (int i = 0; i < event_bus_get_subscriber_count(); i++) {
+        labels[0] = '\0';
+        addLabel(labels, sizeof(labels), "subscriber", event_bus_get_subscriber_name(i));
+        writeUint(out, M_EVENTS_DROPPED, labels, event_bus_get_dropped(i));
+    }
+
+    writeLoopHistograms(out);
+}
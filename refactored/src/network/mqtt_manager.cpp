@@ -6,7 +6,15 @@
 #include "mqtt_manager.h"
 #include "console.h"
 #include "output_manager.h"
+#include "sensor_manager.h"
+#include "heap_monitor.h"
+#include "event_bus.h"
+#include "energy_meter.h"
+#include "safety_manager.h"
+#include "telemetry_frame.h"
+#include "time_service.h"
 #include <Arduino.h>
+#include <WiFi.h>
 #include <ArduinoJson.h>
 
 // Default MQTT configuration
@@ -25,6 +33,14 @@ static PubSubClient mqttClient(espClient);
 static MQTTState_t currentState = MQTT_STATE_DISCONNECTED;
 static unsigned long lastConnectionAttempt = 0;
 static const unsigned long CONNECTION_RETRY_INTERVAL = 5000; // 5 seconds
+static uint32_t connectCount = 0;
+static uint32_t connectFailures = 0;
+
+// Compact telemetry (metered uplinks): one binary frame instead of per-output topics,
+// and a longer keepalive so idle pings don't outweigh the data
+static const uint16_t COMPACT_KEEPALIVE_S = 120;
+static bool compactMode = false;
+static uint16_t telemetrySeq = 0;
 
 // Topic storage
 static char baseTopic[64] = "reptile/thermostat_01";
@@ -34,6 +50,7 @@ static char modeTopic[80];
 static char setTempTopic[80];
 static char modeSetTopic[80];
 static char statusTopic[80];
+static char telemetryTopic[80];
 
 // Device info for HA discovery
 static char deviceName[32] = "Reptile Thermostat";
@@ -43,9 +60,17 @@ static char deviceId[32] = "reptile_thermostat_01";
 static MQTTMessageCallback_t setpointCallback = NULL;
 static MQTTMessageCallback_t modeCallback = NULL;
 
+// Event bus subscription (output changes, sensor faults, safety actions)
+static int eventSub = -1;
+
 // Forward declarations
 static void buildTopics(void);
 static void mqttCallback(char* topic, byte* payload, unsigned int length);
+static void publishOutputTopics(int outputNum, float temp, float target, bool heating,
+                                bool active, int power);
+static void processEvents(void);
+static void publishConnectionEvent(bool connected);
+static void publishTelemetry(void);
 
 /**
  * Initialize MQTT manager
@@ -58,26 +83,40 @@ void mqtt_init(void) {
     prefs.begin("thermostat", true);
     String server = prefs.getString("mqtt_broker", DEFAULT_MQTT_SERVER);
     int port = (int)prefs.getFloat("mqtt_port", DEFAULT_MQTT_PORT);
+    compactMode = prefs.getBool("mqtt_compact", false);
     prefs.end();
     
     // Setup MQTT client
     mqttClient.setServer(server.c_str(), port);
     mqttClient.setCallback(mqttCallback);
     mqttClient.setBufferSize(512);
+    if (compactMode) {
+        mqttClient.setKeepAlive(COMPACT_KEEPALIVE_S);
+    }
     
     // Build topic strings
     buildTopics();
+
+    if (eventSub < 0) {
+        eventSub = event_bus_subscribe(EVENT_MASK(EVENT_OUTPUT_STATE) | EVENT_MASK(EVENT_SENSOR_HEALTH) |
+                                       EVENT_MASK(EVENT_SAFETY), "mqtt");
+    }
     
     Serial.print("[MQTT] Configured for broker: ");
     Serial.print(server);
     Serial.print(":");
     Serial.println(port);
+    if (compactMode) {
+        Serial.printf("[MQTT] Compact telemetry on %s\n", telemetryTopic);
+    }
 }
 
 /**
  * MQTT task - handles reconnection and message loop
  */
 void mqtt_task(void) {
+    HEAP_TRACK_SCOPE("mqtt_task");
+
     // Process incoming messages if connected
     if (mqttClient.connected()) {
         mqttClient.loop();
@@ -89,6 +128,7 @@ void mqtt_task(void) {
         if (currentState != MQTT_STATE_DISCONNECTED) {
             Serial.println("[MQTT] Connection lost");
             currentState = MQTT_STATE_DISCONNECTED;
+            publishConnectionEvent(false);
         }
         
         // Attempt reconnection at interval
@@ -96,6 +136,8 @@ void mqtt_task(void) {
             mqtt_connect();
         }
     }
+
+    processEvents();
 }
 
 /**
@@ -127,6 +169,7 @@ bool mqtt_connect(void) {
     if (mqttClient.connect(MQTT_CLIENT_ID, user.c_str(), password.c_str())) {
         Serial.println(" connected");
         currentState = MQTT_STATE_CONNECTED;
+        connectCount++;
 
         // Subscribe to command topics for all 3 outputs
         for (int i = 1; i <= 3; i++) {
@@ -144,11 +187,13 @@ bool mqtt_connect(void) {
 
         Serial.println("[MQTT] Subscribed to command topics (3 outputs + legacy)");
 
+        publishConnectionEvent(true);
         return true;
     } else {
         Serial.print(" failed, rc=");
         Serial.println(mqttClient.state());
         currentState = MQTT_STATE_DISCONNECTED;
+        connectFailures++;
         return false;
     }
 }
@@ -178,6 +223,27 @@ MQTTState_t mqtt_get_state(void) {
     return currentState;
 }
 
+/**
+ * Get successful connections
+ */
+uint32_t mqtt_get_connect_count(void) {
+    return connectCount;
+}
+
+/**
+ * Get failed connection attempts
+ */
+uint32_t mqtt_get_connect_failures(void) {
+    return connectFailures;
+}
+
+/**
+ * Check if compact telemetry is on
+ */
+bool mqtt_is_compact(void) {
+    return compactMode;
+}
+
 /**
  * Publish temperature
  */
@@ -279,53 +345,38 @@ void mqtt_publish_status_extended(float temperature, float setpoint,
  */
 void mqtt_publish_all_outputs(int wifiRssi, uint32_t freeHeap, unsigned long uptimeSeconds) {
     if (!mqttClient.connected()) return;
+    HEAP_TRACK_SCOPE("mqtt_publish");
+
+    if (compactMode) {
+        publishTelemetry();
+        return;
+    }
 
     // Publish each output individually
     for (int i = 0; i < 3; i++) {
-        OutputConfig_t* output = output_manager_get_output(i);
+        OutputSnapshot output(i);
         if (!output) continue;
 
         int outputNum = i + 1;
         char topicBuf[80];
 
-        // Temperature topic
-        snprintf(topicBuf, sizeof(topicBuf), "%s/output%d/temperature", baseTopic, outputNum);
-        char tempStr[8];
-        snprintf(tempStr, sizeof(tempStr), "%.1f", output->currentTemp);
-        mqttClient.publish(topicBuf, tempStr, true);
-
-        // Setpoint topic
-        snprintf(topicBuf, sizeof(topicBuf), "%s/output%d/setpoint", baseTopic, outputNum);
-        char setpointStr[8];
-        snprintf(setpointStr, sizeof(setpointStr), "%.1f", output->targetTemp);
-        mqttClient.publish(topicBuf, setpointStr, true);
-
-        // State topic (heating/idle)
-        snprintf(topicBuf, sizeof(topicBuf), "%s/output%d/state", baseTopic, outputNum);
-        mqttClient.publish(topicBuf, output->heating ? "heating" : "idle", true);
-
-        // Mode topic (map to HA modes)
-        snprintf(topicBuf, sizeof(topicBuf), "%s/output%d/mode", baseTopic, outputNum);
-        const char* haMode = "off";
-        if (output->controlMode != CONTROL_MODE_OFF && output->enabled) {
-            haMode = "heat";
-        }
-        mqttClient.publish(topicBuf, haMode, true);
-
-        // Power topic
-        snprintf(topicBuf, sizeof(topicBuf), "%s/output%d/power", baseTopic, outputNum);
-        char powerStr[8];
-        snprintf(powerStr, sizeof(powerStr), "%d", output->currentPower);
-        mqttClient.publish(topicBuf, powerStr, true);
+        publishOutputTopics(outputNum, output->currentTemp, output->targetTemp, output->heating,
+                            output->controlMode != CONTROL_MODE_OFF && output->enabled,
+                            output->currentPower);
 
         // Status topic (JSON with all data)
         snprintf(topicBuf, sizeof(topicBuf), "%s/output%d/status", baseTopic, outputNum);
-        StaticJsonDocument<384> doc;
+        StaticJsonDocument<512> doc;
         doc["temperature"] = round(output->currentTemp * 10) / 10.0;
+        if (sensor_manager_is_valid_humidity(output->currentHumidity)) {
+            doc["humidity"] = round(output->currentHumidity * 10) / 10.0;
+        }
         doc["setpoint"] = output->targetTemp;
         doc["heating"] = output->heating;
         doc["mode"] = output_manager_get_mode_name(output->controlMode);
         doc["power"] = output->currentPower;
+        doc["power_w"] = round(output->powerW * 10) / 10.0;
+        doc["energy_kwh"] = round(output->energyKwh * 1000) / 1000.0;
         doc["enabled"] = output->enabled;
         doc["name"] = output->name;
 
@@ -334,9 +385,14 @@ void mqtt_publish_all_outputs(int wifiRssi, uint32_t freeHeap, unsigned long upt
             doc["wifi_rssi"] = wifiRssi;
             doc["free_heap"] = freeHeap;
             doc["uptime"] = uptimeSeconds;
+
+            const HeapSample_t* heap = heap_monitor_get_latest();
+            doc["heap_largest"] = heap->largestBlock;
+            doc["heap_frag"] = heap_monitor_get_fragmentation(heap);
+            doc["heap_trend"] = heap_monitor_get_trend_bytes_per_hour();
         }
 
-        char jsonBuf[384];
+        char jsonBuf[512];
         serializeJson(doc, jsonBuf);
         mqttClient.publish(topicBuf, jsonBuf, true);
     }
@@ -344,10 +400,34 @@ void mqtt_publish_all_outputs(int wifiRssi, uint32_t freeHeap, unsigned long upt
     console_add_event(CONSOLE_EVENT_MQTT, "MQTT PUB: All 3 outputs published");
 }
 
+/**
+ * Publish low-heap alert
+ */
+void mqtt_publish_heap_alert(uint32_t largestBlock, uint32_t freeHeap) {
+    if (!mqttClient.connected()) return;
+
+    char topicBuf[96];
+    snprintf(topicBuf, sizeof(topicBuf), "%s/alert", baseTopic);
+
+    char payload[160];
+    snprintf(payload, sizeof(payload),
+             "{\"type\":\"heap_low\",\"largest_block\":%lu,\"free_heap\":%lu,\"threshold\":%u}",
+             (unsigned long)largestBlock, (unsigned long)freeHeap, HEAP_LOW_BLOCK_THRESHOLD);
+    mqttClient.publish(topicBuf, payload, false);
+
+    console_add_event_f(CONSOLE_EVENT_MQTT, "MQTT PUB: %s heap_low", topicBuf);
+}
+
 /**
  * Send Home Assistant auto-discovery (Multi-Output)
  */
 void mqtt_send_ha_discovery(const char* devName, const char* devId) {
+    // The entities read the per-output topics, which compact mode doesn't publish
+    if (compactMode) {
+        console_add_event(CONSOLE_EVENT_MQTT, "MQTT: compact telemetry, HA discovery skipped");
+        return;
+    }
+
     if (!mqttClient.connected()) {
         Serial.println("[MQTT] Cannot send HA discovery: not connected");
         return;
@@ -361,7 +441,7 @@ void mqtt_send_ha_discovery(const char* devName, const char* devId) {
 
     // Create 3 climate entities (one per output)
     for (int i = 1; i <= 3; i++) {
-        OutputConfig_t* output = output_manager_get_output(i - 1);
+        OutputSnapshot output(i - 1);
         if (!output) continue;
 
         char topicBuf[128];
@@ -369,7 +449,9 @@ void mqtt_send_ha_discovery(const char* devName, const char* devId) {
 
         // Build climate discovery config
         StaticJsonDocument<768> doc;
-        doc["name"] = String(output->name) + " (" + String(deviceName) + ")";
+        char textBuf[80];
+        snprintf(textBuf, sizeof(textBuf), "%s (%s)", output->name, deviceName);
+        doc["name"] = textBuf;
 
         // Topics for this output
         snprintf(topicBuf, sizeof(topicBuf), "%s/output%d/mode", baseTopic, i);
@@ -388,7 +470,8 @@ void mqtt_send_ha_discovery(const char* devName, const char* devId) {
         doc["temp_step"] = 0.5;
         doc["min_temp"] = 15;
         doc["max_temp"] = 45;
-        doc["unique_id"] = String(deviceId) + "_output" + String(i);
+        snprintf(textBuf, sizeof(textBuf), "%s_output%d", deviceId, i);
+        doc["unique_id"] = textBuf;
 
         JsonArray modes = doc.createNestedArray("modes");
         modes.add("off");
@@ -410,20 +493,67 @@ void mqtt_send_ha_discovery(const char* devName, const char* devId) {
         mqttClient.publish(topicBuf, payloadBuf, true);
 
         delay(50); // Small delay between publishes
+
+        // Energy sensor (HA Energy dashboard: total_increasing kWh)
+        StaticJsonDocument<512> energyDoc;
+        snprintf(textBuf, sizeof(textBuf), "%s Energy (%s)", output->name, deviceName);
+        energyDoc["name"] = textBuf;
+        snprintf(topicBuf, sizeof(topicBuf), "%s/output%d/status", baseTopic, i);
+        energyDoc["state_topic"] = topicBuf;
+        energyDoc["value_template"] = "{{ value_json.energy_kwh }}";
+        energyDoc["unit_of_measurement"] = "kWh";
+        energyDoc["device_class"] = "energy";
+        energyDoc["state_class"] = "total_increasing";
+        snprintf(textBuf, sizeof(textBuf), "%s_output%d_energy", deviceId, i);
+        energyDoc["unique_id"] = textBuf;
+
+        JsonObject energyDevice = energyDoc.createNestedObject("device");
+        energyDevice["identifiers"][0] = deviceId;
+
+        serializeJson(energyDoc, payloadBuf);
+        snprintf(topicBuf, sizeof(topicBuf), "%s/sensor/%s_output%d_energy/config",
+                 HA_DISCOVERY_PREFIX, deviceId, i);
+        mqttClient.publish(topicBuf, payloadBuf, true);
+
+        // Power sensor (instantaneous estimate from the rating)
+        StaticJsonDocument<512> powerDoc;
+        snprintf(textBuf, sizeof(textBuf), "%s Power (%s)", output->name, deviceName);
+        powerDoc["name"] = textBuf;
+        snprintf(topicBuf, sizeof(topicBuf), "%s/output%d/status", baseTopic, i);
+        powerDoc["state_topic"] = topicBuf;
+        powerDoc["value_template"] = "{{ value_json.power_w }}";
+        powerDoc["unit_of_measurement"] = "W";
+        powerDoc["device_class"] = "power";
+        powerDoc["state_class"] = "measurement";
+        snprintf(textBuf, sizeof(textBuf), "%s_output%d_power", deviceId, i);
+        powerDoc["unique_id"] = textBuf;
+
+        JsonObject powerDevice = powerDoc.createNestedObject("device");
+        powerDevice["identifiers"][0] = deviceId;
+
+        serializeJson(powerDoc, payloadBuf);
+        snprintf(topicBuf, sizeof(topicBuf), "%s/sensor/%s_output%d_power/config",
+                 HA_DISCOVERY_PREFIX, deviceId, i);
+        mqttClient.publish(topicBuf, payloadBuf, true);
+
+        delay(50);
     }
 
     // System diagnostic sensors (attached to device, not specific output)
 
     // WiFi RSSI sensor
+    char textBuf[80];
     StaticJsonDocument<512> rssiDoc;
-    rssiDoc["name"] = String(deviceName) + " WiFi Signal";
+    snprintf(textBuf, sizeof(textBuf), "%s WiFi Signal", deviceName);
+    rssiDoc["name"] = textBuf;
     char statusTopic1[80];
     snprintf(statusTopic1, sizeof(statusTopic1), "%s/output1/status", baseTopic);
     rssiDoc["state_topic"] = statusTopic1;
     rssiDoc["value_template"] = "{{ value_json.wifi_rssi }}";
     rssiDoc["unit_of_measurement"] = "dBm";
     rssiDoc["device_class"] = "signal_strength";
-    rssiDoc["unique_id"] = String(deviceId) + "_rssi";
+    snprintf(textBuf, sizeof(textBuf), "%s_rssi", deviceId);
+    rssiDoc["unique_id"] = textBuf;
     rssiDoc["entity_category"] = "diagnostic";
 
     JsonObject rssiDevice = rssiDoc.createNestedObject("device");
@@ -439,11 +569,13 @@ void mqtt_send_ha_discovery(const char* devName, const char* devId) {
 
     // Free heap sensor
     StaticJsonDocument<512> heapDoc;
-    heapDoc["name"] = String(deviceName) + " Free Memory";
+    snprintf(textBuf, sizeof(textBuf), "%s Free Memory", deviceName);
+    heapDoc["name"] = textBuf;
     heapDoc["state_topic"] = statusTopic1;
     heapDoc["value_template"] = "{{ value_json.free_heap }}";
     heapDoc["unit_of_measurement"] = "bytes";
-    heapDoc["unique_id"] = String(deviceId) + "_heap";
+    snprintf(textBuf, sizeof(textBuf), "%s_heap", deviceId);
+    heapDoc["unique_id"] = textBuf;
     heapDoc["entity_category"] = "diagnostic";
     heapDoc["icon"] = "mdi:memory";
 
@@ -460,11 +592,13 @@ void mqtt_send_ha_discovery(const char* devName, const char* devId) {
 
     // Uptime sensor
     StaticJsonDocument<512> uptimeDoc;
-    uptimeDoc["name"] = String(deviceName) + " Uptime";
+    snprintf(textBuf, sizeof(textBuf), "%s Uptime", deviceName);
+    uptimeDoc["name"] = textBuf;
     uptimeDoc["state_topic"] = statusTopic1;
     uptimeDoc["value_template"] = "{{ value_json.uptime }}";
     uptimeDoc["unit_of_measurement"] = "s";
-    uptimeDoc["unique_id"] = String(deviceId) + "_uptime";
+    snprintf(textBuf, sizeof(textBuf), "%s_uptime", deviceId);
+    uptimeDoc["unique_id"] = textBuf;
     uptimeDoc["entity_category"] = "diagnostic";
     uptimeDoc["icon"] = "mdi:clock-outline";
 
@@ -479,7 +613,30 @@ void mqtt_send_ha_discovery(const char* devName, const char* devId) {
              "%s/sensor/%s_uptime/config", HA_DISCOVERY_PREFIX, deviceId);
     mqttClient.publish(uptimeDiscTopic, uptimePayload, true);
 
-    Serial.println("[MQTT] Home Assistant discovery sent (3 climates + 3 diagnostics)");
+    // Largest free block sensor (fragmentation / OTA headroom)
+    StaticJsonDocument<512> blockDoc;
+    snprintf(textBuf, sizeof(textBuf), "%s Largest Free Block", deviceName);
+    blockDoc["name"] = textBuf;
+    blockDoc["state_topic"] = statusTopic1;
+    blockDoc["value_template"] = "{{ value_json.heap_largest }}";
+    blockDoc["unit_of_measurement"] = "bytes";
+    snprintf(textBuf, sizeof(textBuf), "%s_heap_block", deviceId);
+    blockDoc["unique_id"] = textBuf;
+    blockDoc["entity_category"] = "diagnostic";
+    blockDoc["icon"] = "mdi:memory";
+
+    JsonObject blockDevice = blockDoc.createNestedObject("device");
+    blockDevice["identifiers"][0] = deviceId;
+
+    char blockPayload[512];
+    serializeJson(blockDoc, blockPayload);
+
+    char blockDiscTopic[128];
+    snprintf(blockDiscTopic, sizeof(blockDiscTopic),
+             "%s/sensor/%s_heap_block/config", HA_DISCOVERY_PREFIX, deviceId);
+    mqttClient.publish(blockDiscTopic, blockPayload, true);
+
+    Serial.println("[MQTT] Home Assistant discovery sent (3 climates + 6 energy/power + 4 diagnostics)");
     console_add_event(CONSOLE_EVENT_MQTT, "MQTT: HA discovery published");
 }
 
@@ -530,6 +687,7 @@ static void buildTopics(void) {
     snprintf(setTempTopic, sizeof(setTempTopic), "%s/setpoint/set", baseTopic);
     snprintf(modeSetTopic, sizeof(modeSetTopic), "%s/mode/set", baseTopic);
     snprintf(statusTopic, sizeof(statusTopic), "%s/status", baseTopic);
+    snprintf(telemetryTopic, sizeof(telemetryTopic), "%s/telemetry", baseTopic);
 }
 
 /**
@@ -591,3 +749,146 @@ static void mqttCallback(char* topic, byte* payload, unsigned int length) {
         }
     }
 }
+
+/**
+ * Publish one retained "{base}/output{n}/{leaf}" value
+ * Skipped if the topic doesn't fit, rather than sent to a truncated topic.
+ */
+static void publishOutputTopic(int outputNum, const char* leaf, const char* value) {
+    char topic[sizeof(baseTopic) + 24];   // "/output%d/" + the longest leaf
+    int n = snprintf(topic, sizeof(topic), "%s/output%d/%s", baseTopic, outputNum, leaf);
+    if (n < 0 || (size_t)n >= sizeof(topic)) {
+        return;
+    }
+    mqttClient.publish(topic, value, true);
+}
+
+/**
+ * Publish one output's plain topics (temperature, setpoint, state, mode, power)
+ */
+static void publishOutputTopics(int outputNum, float temp, float target, bool heating,
+                                bool active, int power) {
+    char valueStr[8];
+
+    snprintf(valueStr, sizeof(valueStr), "%.1f", temp);
+    publishOutputTopic(outputNum, "temperature", valueStr);
+
+    snprintf(valueStr, sizeof(valueStr), "%.1f", target);
+    publishOutputTopic(outputNum, "setpoint", valueStr);
+
+    // State topic (heating/idle)
+    publishOutputTopic(outputNum, "state", heating ? "heating" : "idle");
+
+    // Mode topic (map to HA modes)
+    publishOutputTopic(outputNum, "mode", active ? "heat" : "off");
+
+    snprintf(valueStr, sizeof(valueStr), "%d", power);
+    publishOutputTopic(outputNum, "power", valueStr);
+}
+
+/**
+ * Forward bus events to the broker
+ * Setpoint/mode/heating changes go out immediately instead of waiting for
+ * the 30s status publish. Events arriving while disconnected are dropped -
+ * the retained topics are refreshed on the next full publish.
+ */
+static void processEvents(void) {
+    Event_t event;
+    while (event_bus_poll(eventSub, &event)) {
+        if (!mqttClient.connected()) {
+            continue;
+        }
+
+        char topicBuf[96];
+        char payload[128];
+        snprintf(topicBuf, sizeof(topicBuf), "%s/alert", baseTopic);
+
+        switch (event.topic) {
+            case EVENT_OUTPUT_STATE: {
+                const OutputEvent_t* out = &event.output;
+                if (!(out->changed & OUTPUT_CHG_CONTROL)) {
+                    break;
+                }
+                if (compactMode) {
+                    publishTelemetry();
+                    break;
+                }
+                publishOutputTopics(out->index + 1, out->temp, out->target, out->heating,
+                                    out->mode != CONTROL_MODE_OFF && out->enabled, out->power);
+                console_add_event_p(CONSOLE_EVENT_MQTT, CONSOLE_FMT_MQTT_OUTPUT, out->index + 1);
+                break;
+            }
+
+            case EVENT_SENSOR_HEALTH:
+                snprintf(payload, sizeof(payload), "{\"type\":\"%s\",\"sensor\":\"%s\"}",
+                         event.sensor.ok ? "sensor_ok" : "sensor_fault", event.sensor.address);
+                mqttClient.publish(topicBuf, payload, false);
+                break;
+
+            case EVENT_SAFETY: {
+                static const char* kinds[] = {"emergency_stop", "outputs_held", "outputs_released",
+                                              "safe_mode_exit"};
+                const char* kind = (event.safety.kind < sizeof(kinds) / sizeof(kinds[0])) ? kinds[event.safety.kind] : "safety";
+                snprintf(payload, sizeof(payload), "{\"type\":\"%s\"}", kind);
+                mqttClient.publish(topicBuf, payload, false);
+                console_add_event_f(CONSOLE_EVENT_MQTT, "MQTT PUB: %s %s", topicBuf, kind);
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * Publish broker connection changes on the event bus
+ */
+static void publishConnectionEvent(bool connected) {
+    Event_t event;
+    event.topic = EVENT_MQTT_STATUS;
+    event.mqtt.connected = connected;
+    event_bus_publish(&event);
+}
+
+/**
+ * Publish the compact telemetry frame (all outputs + system stats)
+ */
+static void publishTelemetry(void) {
+    Telemetry_t telemetry;
+    memset(&telemetry, 0, sizeof(telemetry));
+    telemetry.flags = safety_manager_is_safe_mode() ? TELEMETRY_SYS_SAFE_MODE : 0;
+    telemetry.seq = telemetrySeq++;
+    telemetry.uptimeSec = time_service_uptime_sec();
+    telemetry.rssi = WiFi.isConnected() ? (int8_t)constrain(WiFi.RSSI(), -128, 0) : 0;
+    telemetry.heapFree = ESP.getFreeHeap();
+    telemetry.heapLargest = ESP.getMaxAllocHeap();
+    telemetry.outputCount = TELEMETRY_OUTPUTS;
+
+    for (int i = 0; i < TELEMETRY_OUTPUTS; i++) {
+        TelemetryOutput_t* o = &telemetry.outputs[i];
+        EnergyMeter_t meter;
+        o->energyWh = output_manager_get_energy(i, &meter) ? (uint32_t)(meter.energyMj / 3600000ULL) : 0;
+
+        OutputSnapshot output(i);
+        if (!output) {
+            o->temp = NAN;
+            o->target = NAN;
+            o->humidity = NAN;
+            continue;
+        }
+        o->temp = sensor_manager_is_valid_temp(output->currentTemp) ? output->currentTemp : NAN;
+        o->target = output->targetTemp;
+        o->humidity = sensor_manager_is_valid_humidity(output->currentHumidity) ? output->currentHumidity : NAN;
+        o->power = (uint8_t)constrain(output->currentPower, 0, 100);
+        o->mode = (uint8_t)output->controlMode;
+        o->flags = (output->enabled ? TELEMETRY_OUT_ENABLED : 0) |
+                   (output->heating ? TELEMETRY_OUT_HEATING : 0) |
+                   (output->faultState != FAULT_NONE ? TELEMETRY_OUT_FAULT : 0);
+        o->powerW = output->powerW;
+    }
+
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    size_t len = telemetry_frame_encode(&telemetry, frame, sizeof(frame));
+    mqttClient.publish(telemetryTopic, frame, len, true);
+}
@@ -0,0 +1,699 @@
+/**
+ * ota_manager.cpp
+ * A/B Firmware Update with Verification and Rollback Implementation
+ */
+
+#include "ota_manager.h"
+#include "config.h"
+#include "console.h"
+#include "delta_patch.h"
+#include "safety_manager.h"
+#include "scratch_pool.h"
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <Preferences.h>
+#include <Update.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+
+// NVS namespace for OTA bookkeeping
+#define OTA_NAMESPACE "ota"
+#define KEY_PEND_PART "pend_part"   // Slot activated by the last update
+#define KEY_PEND_VER "pend_ver"     // Manifest version of that update
+#define KEY_ROLLBACKS "rollbacks"   // Updates rejected by rollback
+#define KEY_UNVERIFIED "unverified" // Slot last written without an expected digest
+
+#define OTA_STALL_TIMEOUT_MS 15000  // Give up if the download stops this long
+
+// Session state
+static OtaState_t state = OTA_STATE_IDLE;
+static OtaError_t lastError = OTA_ERR_NONE;
+static mbedtls_sha256_context shaCtx;
+static uint8_t expectedSha[OTA_SHA256_LEN];
+static bool checkSha = false;
+static uint8_t lastSha[OTA_SHA256_LEN];
+static bool haveLastSha = false;
+static uint32_t expectedSize = 0;
+static uint32_t written = 0;
+static char sessionVersion[16] = "";
+static bool lastWasDelta = false;
+static uint32_t downloaded = 0;         // Bytes received over the network
+
+// Running image
+static bool pendingVerify = false;
+static bool rolledBack = false;
+static bool imageUnverified = false;
+static uint16_t rollbackCount = 0;
+
+// Forward declarations
+static bool fail(OtaError_t error);
+static bool fetchManifest(OtaManifest_t* manifest);
+static bool downloadImage(const OtaManifest_t* manifest);
+static bool downloadDelta(const OtaManifest_t* manifest);
+static bool streamDownload(const char* file, uint32_t length, bool (*sink)(void*, const uint8_t*, size_t), void* ctx);
+static bool sinkImage(void* ctx, const uint8_t* data, size_t len);
+static bool sinkPatch(void* ctx, const uint8_t* data, size_t len);
+static bool readRunning(void* ctx, uint32_t offset, uint8_t* buf, size_t len);
+static bool writePatched(void* ctx, const uint8_t* data, size_t len);
+static int hexNibble(char c);
+
+/**
+ * Bootloader hook: keep a freshly flashed image in pending-verify state
+ * instead of letting the Arduino core confirm it before setup().
+ */
+extern "C" bool verifyRollbackLater(void) {
+    return true;
+}
+
+/**
+ * Initialize OTA manager
+ */
+void ota_manager_init(void) {
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    esp_ota_img_states_t imgState;
+    if (running && esp_ota_get_state_partition(running, &imgState) == ESP_OK) {
+        pendingVerify = (imgState == ESP_OTA_IMG_PENDING_VERIFY);
+    }
+
+    Preferences prefs;
+    prefs.begin(OTA_NAMESPACE, false);
+    rollbackCount = prefs.getUShort(KEY_ROLLBACKS, 0);
+    imageUnverified = running && prefs.getString(KEY_UNVERIFIED, "") == running->label;
+
+    String pendPart = prefs.getString(KEY_PEND_PART, "");
+    if (pendPart.length() > 0 && running) {
+        String pendVer = prefs.getString(KEY_PEND_VER, "");
+
+        if (pendPart != running->label) {
+            // Updated slot did not survive verification - bootloader went back
+            rolledBack = true;
+            rollbackCount++;
+            prefs.putUShort(KEY_ROLLBACKS, rollbackCount);
+
+            Serial.printf("[OTA] Update %s in %s was rolled back\n", pendVer.c_str(), pendPart.c_str());
+            console_add_event_f(CONSOLE_EVENT_ERROR, "OTA: update %s rolled back, running %s",
+                               pendVer.length() ? pendVer.c_str() : "?", FIRMWARE_VERSION);
+        } else if (pendingVerify) {
+            console_add_event_f(CONSOLE_EVENT_SYSTEM, "OTA: running %s from %s, pending verify%s",
+                               FIRMWARE_VERSION, running->label,
+                               imageUnverified ? " (unverified: no sha256)" : "");
+        }
+
+        // Keep the record until the new image is confirmed
+        if (!pendingVerify || rolledBack) {
+            prefs.remove(KEY_PEND_PART);
+            prefs.remove(KEY_PEND_VER);
+        }
+    }
+    prefs.end();
+
+    Serial.printf("[OTA] Running from %s%s\n", running ? running->label : "?",
+                 pendingVerify ? " (pending verify)" : "");
+}
+
+/**
+ * Confirm a pending image once it is stable and regulating, roll it back
+ * if that does not happen in time
+ * Checked on every pass, so a sensor or control stall that happens to
+ * cover the stable mark only delays confirmation while it lasts.
+ */
+void ota_manager_task(void) {
+    if (!pendingVerify) {
+        return;
+    }
+
+    const SafetyState_t* safety = safety_manager_get_state();
+    if (safety->stableTime != 0 && !safety->safeMode && !safety->outputsHeldSafe) {
+        ota_manager_mark_valid();
+        return;
+    }
+
+    if (millis() > OTA_VERIFY_TIMEOUT_MS) {
+        Serial.println("[OTA] Image not confirmed in time");
+        console_add_event(CONSOLE_EVENT_ERROR, "OTA: new image not confirmed, rolling back");
+        ota_manager_rollback();
+    }
+}
+
+/**
+ * Start streaming an image
+ */
+bool ota_manager_begin(size_t size, const uint8_t* expectedSha256) {
+    if (state == OTA_STATE_WRITING) {
+        lastError = OTA_ERR_BUSY;
+        return false;
+    }
+
+    // Overwriting the other slot now would destroy the rollback target
+    if (pendingVerify) {
+        state = OTA_STATE_FAILED;
+        lastError = OTA_ERR_PENDING;
+        return false;
+    }
+
+    state = OTA_STATE_IDLE;
+    lastError = OTA_ERR_NONE;
+    expectedSize = size;
+    written = 0;
+    checkSha = (expectedSha256 != nullptr);
+    if (checkSha) {
+        memcpy(expectedSha, expectedSha256, OTA_SHA256_LEN);
+    }
+
+    if (!Update.begin(size > 0 ? size : UPDATE_SIZE_UNKNOWN)) {
+        Update.printError(Serial);
+        return fail(OTA_ERR_BEGIN);
+    }
+
+    mbedtls_sha256_init(&shaCtx);
+    mbedtls_sha256_starts_ret(&shaCtx, 0);
+    state = OTA_STATE_WRITING;
+
+    Serial.printf("[OTA] Writing %u bytes%s\n", (unsigned)size, checkSha ? " (sha256 checked)" : "");
+    return true;
+}
+
+/**
+ * Hash and write a chunk
+ */
+bool ota_manager_write(const uint8_t* data, size_t len) {
+    if (state != OTA_STATE_WRITING) {
+        return false;
+    }
+    if (expectedSize > 0 && written + len > expectedSize) {
+        return fail(OTA_ERR_SIZE);
+    }
+
+    mbedtls_sha256_update_ret(&shaCtx, data, len);
+    if (Update.write((uint8_t*)data, len) != len) {
+        Update.printError(Serial);
+        return fail(OTA_ERR_WRITE);
+    }
+    written += len;
+    return true;
+}
+
+/**
+ * Verify and activate
+ */
+bool ota_manager_end(void) {
+    if (state != OTA_STATE_WRITING) {
+        return false;
+    }
+
+    mbedtls_sha256_finish_ret(&shaCtx, lastSha);
+    mbedtls_sha256_free(&shaCtx);
+    haveLastSha = true;
+
+    if (expectedSize > 0 && written != expectedSize) {
+        return fail(OTA_ERR_SIZE);
+    }
+
+    if (checkSha) {
+        // Compare every byte so timing does not reveal the mismatch position
+        uint8_t diff = 0;
+        for (int i = 0; i < OTA_SHA256_LEN; i++) {
+            diff |= lastSha[i] ^ expectedSha[i];
+        }
+        if (diff != 0) {
+            return fail(OTA_ERR_HASH);
+        }
+    }
+
+    if (!Update.end(true)) {
+        Update.printError(Serial);
+        state = OTA_STATE_FAILED;
+        lastError = OTA_ERR_END;
+        console_add_event(CONSOLE_EVENT_ERROR, "OTA: image rejected by bootloader check");
+        return false;
+    }
+
+    // Remember which slot we switched to so the next boot can spot a rollback
+    const esp_partition_t* boot = esp_ota_get_boot_partition();
+    Preferences prefs;
+    prefs.begin(OTA_NAMESPACE, false);
+    prefs.putString(KEY_PEND_PART, boot ? boot->label : "");
+    prefs.putString(KEY_PEND_VER, sessionVersion);
+    prefs.putString(KEY_UNVERIFIED, checkSha || !boot ? "" : boot->label);
+    prefs.end();
+
+    state = OTA_STATE_READY;
+    lastError = OTA_ERR_NONE;
+    imageUnverified = !checkSha;
+
+    char hex[OTA_SHA256_LEN * 2 + 1];
+    ota_manager_format_sha256(lastSha, hex);
+    Serial.printf("[OTA] Image OK: %lu bytes, sha256 %s%s\n", (unsigned long)written, hex,
+                  checkSha ? "" : " (not checked)");
+    if (checkSha) {
+        console_add_event_f(CONSOLE_EVENT_SYSTEM, "OTA: %lu bytes verified (%.12s) -> %s",
+                           (unsigned long)written, hex, boot ? boot->label : "?");
+    } else {
+        console_add_event_f(CONSOLE_EVENT_ERROR, "OTA: %lu bytes UNVERIFIED, no sha256 given (%.12s) -> %s",
+                           (unsigned long)written, hex, boot ? boot->label : "?");
+    }
+    return true;
+}
+
+/**
+ * Abandon session
+ */
+void ota_manager_abort(void) {
+    if (state == OTA_STATE_WRITING) {
+        Update.abort();
+        mbedtls_sha256_free(&shaCtx);
+        state = OTA_STATE_IDLE;
+        Serial.println("[OTA] Aborted");
+    }
+}
+
+/**
+ * Install latest GitHub release
+ */
+bool ota_manager_install_release(void) {
+    if (state == OTA_STATE_WRITING) {
+        lastError = OTA_ERR_BUSY;
+        return false;
+    }
+
+    OtaManifest_t manifest;
+    if (!fetchManifest(&manifest)) {
+        state = OTA_STATE_FAILED;
+        lastError = OTA_ERR_MANIFEST;
+        console_add_event(CONSOLE_EVENT_ERROR, "OTA: release manifest missing or invalid");
+        return false;
+    }
+
+    Serial.printf("[OTA] Release %s: %s, %lu bytes\n", manifest.version, manifest.file,
+                 (unsigned long)manifest.size);
+    strlcpy(sessionVersion, manifest.version, sizeof(sessionVersion));
+
+    // Patch against the running image when the release has one for this version
+    bool ok = false;
+    if (manifest.deltaFile[0] != '\0') {
+        Serial.printf("[OTA] Delta %s, %lu bytes\n", manifest.deltaFile, (unsigned long)manifest.deltaSize);
+        ok = downloadDelta(&manifest);
+        if (!ok && lastError != OTA_ERR_BUSY && lastError != OTA_ERR_PENDING) {
+            console_add_event_f(CONSOLE_EVENT_SYSTEM, "OTA: delta failed (%s), downloading full image",
+                               ota_manager_get_error_name(lastError));
+        }
+    }
+    if (!ok && lastError != OTA_ERR_BUSY && lastError != OTA_ERR_PENDING) {
+        ok = downloadImage(&manifest);
+    }
+
+    sessionVersion[0] = '\0';
+    return ok;
+}
+
+/**
+ * Confirm running image
+ */
+void ota_manager_mark_valid(void) {
+    if (!pendingVerify) {
+        return;
+    }
+
+    esp_err_t err = esp_ota_mark_app_valid_cancel_rollback();
+    if (err != ESP_OK) {
+        Serial.printf("[OTA] Failed to confirm image: %d\n", err);
+        return;
+    }
+    pendingVerify = false;
+
+    Preferences prefs;
+    prefs.begin(OTA_NAMESPACE, false);
+    prefs.remove(KEY_PEND_PART);
+    prefs.remove(KEY_PEND_VER);
+    prefs.end();
+
+    Serial.println("[OTA] Image confirmed - rollback cancelled");
+    console_add_event_f(CONSOLE_EVENT_SYSTEM, "OTA: firmware %s confirmed", FIRMWARE_VERSION);
+}
+
+/**
+ * Reject running image
+ */
+void ota_manager_rollback(void) {
+    if (!pendingVerify) {
+        return;
+    }
+
+    safety_manager_emergency_stop();
+    Serial.println("[OTA] Rolling back to previous image");
+    Serial.flush();
+    delay(100);
+
+    // Only returns if there is no valid image to go back to
+    esp_err_t err = esp_ota_mark_app_invalid_rollback_and_reboot();
+    Serial.printf("[OTA] Rollback failed: %d\n", err);
+    pendingVerify = false;
+}
+
+/**
+ * Parse release manifest
+ */
+bool ota_manager_parse_manifest(const char* json, const char* runningVersion, OtaManifest_t* out) {
+    StaticJsonDocument<1024> doc;
+    if (deserializeJson(doc, json)) {
+        return false;
+    }
+
+    const char* version = doc["version"] | "";
+    const char* file = doc["file"] | "";
+    const char* sha = doc["sha256"] | "";
+
+    // File name is appended to the release URL - no paths
+    if (version[0] == '\0' || file[0] == '\0' || strchr(file, '/') || strstr(file, "..")) {
+        return false;
+    }
+    if (strlen(version) >= sizeof(out->version) || strlen(file) >= sizeof(out->file)) {
+        return false;
+    }
+    if (!ota_manager_parse_sha256(sha, out->sha256)) {
+        return false;
+    }
+
+    strlcpy(out->version, version, sizeof(out->version));
+    strlcpy(out->file, file, sizeof(out->file));
+    out->size = doc["size"] | 0UL;
+
+    // Optional patch from the running version (needs the full image size to check against)
+    out->deltaFile[0] = '\0';
+    out->deltaSize = 0;
+    JsonArray deltas = doc["deltas"];
+    for (JsonObject delta : deltas) {
+        const char* from = delta["from"] | "";
+        const char* dfile = delta["file"] | "";
+        if (!runningVersion || strcmp(from, runningVersion) != 0 || out->size == 0) continue;
+        if (dfile[0] == '\0' || strchr(dfile, '/') || strstr(dfile, "..") ||
+            strlen(dfile) >= sizeof(out->deltaFile)) continue;
+
+        strlcpy(out->deltaFile, dfile, sizeof(out->deltaFile));
+        out->deltaSize = delta["size"] | 0UL;
+        break;
+    }
+    return true;
+}
+
+/**
+ * Parse hex digest
+ */
+bool ota_manager_parse_sha256(const char* hex, uint8_t out[OTA_SHA256_LEN]) {
+    if (!hex || strlen(hex) != OTA_SHA256_LEN * 2) {
+        return false;
+    }
+    for (int i = 0; i < OTA_SHA256_LEN; i++) {
+        int hi = hexNibble(hex[i * 2]);
+        int lo = hexNibble(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        out[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+/**
+ * Format digest as hex
+ */
+void ota_manager_format_sha256(const uint8_t digest[OTA_SHA256_LEN], char* out) {
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < OTA_SHA256_LEN; i++) {
+        out[i * 2] = digits[digest[i] >> 4];
+        out[i * 2 + 1] = digits[digest[i] & 0x0F];
+    }
+    out[OTA_SHA256_LEN * 2] = '\0';
+}
+
+OtaState_t ota_manager_get_state(void) {
+    return state;
+}
+
+OtaError_t ota_manager_get_error(void) {
+    return lastError;
+}
+
+const char* ota_manager_get_state_name(OtaState_t s) {
+    switch (s) {
+        case OTA_STATE_IDLE:    return "idle";
+        case OTA_STATE_WRITING: return "writing";
+        case OTA_STATE_READY:   return "ready";
+        case OTA_STATE_FAILED:  return "failed";
+        default:                return "unknown";
+    }
+}
+
+const char* ota_manager_get_error_name(OtaError_t error) {
+    switch (error) {
+        case OTA_ERR_NONE:     return "None";
+        case OTA_ERR_BUSY:     return "Update already in progress";
+        case OTA_ERR_PENDING:  return "Running image not yet confirmed";
+        case OTA_ERR_BEGIN:    return "Could not open update partition";
+        case OTA_ERR_WRITE:    return "Flash write failed";
+        case OTA_ERR_SIZE:     return "Image size mismatch";
+        case OTA_ERR_HASH:     return "SHA-256 mismatch";
+        case OTA_ERR_END:      return "Image validation failed";
+        case OTA_ERR_MANIFEST: return "Release manifest missing or invalid";
+        case OTA_ERR_DOWNLOAD: return "Download failed";
+        case OTA_ERR_PATCH:    return "Delta patch failed";
+        default:               return "Unknown";
+    }
+}
+
+uint32_t ota_manager_get_progress(void) {
+    return written;
+}
+
+uint32_t ota_manager_get_download_bytes(void) {
+    return downloaded;
+}
+
+bool ota_manager_last_was_delta(void) {
+    return lastWasDelta;
+}
+
+const uint8_t* ota_manager_get_last_sha256(void) {
+    return haveLastSha ? lastSha : nullptr;
+}
+
+bool ota_manager_image_unverified(void) {
+    return imageUnverified;
+}
+
+bool ota_manager_is_pending_verify(void) {
+    return pendingVerify;
+}
+
+bool ota_manager_was_rolled_back(void) {
+    return rolledBack;
+}
+
+uint16_t ota_manager_get_rollback_count(void) {
+    return rollbackCount;
+}
+
+const char* ota_manager_get_running_partition(void) {
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    return running ? running->label : "?";
+}
+
+// ===== INTERNAL FUNCTIONS =====
+
+/**
+ * Abort session with error
+ */
+static bool fail(OtaError_t error) {
+    if (state == OTA_STATE_WRITING) {
+        Update.abort();
+        mbedtls_sha256_free(&shaCtx);
+    }
+    state = OTA_STATE_FAILED;
+    lastError = error;
+
+    Serial.printf("[OTA] Failed: %s (%lu bytes written)\n",
+                 ota_manager_get_error_name(error), (unsigned long)written);
+    console_add_event_f(CONSOLE_EVENT_ERROR, "OTA: %s", ota_manager_get_error_name(error));
+    return false;
+}
+
+/**
+ * Download and parse the release manifest
+ */
+static bool fetchManifest(OtaManifest_t* manifest) {
+    char url[160];
+    snprintf(url, sizeof(url), "https://github.com/%s/%s/releases/latest/download/%s",
+             GITHUB_USER, GITHUB_REPO, OTA_MANIFEST_FILE);
+
+    HTTPClient http;
+    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    http.begin(url);
+
+    bool ok = false;
+    if (http.GET() == 200) {
+        ok = ota_manager_parse_manifest(http.getString().c_str(), FIRMWARE_VERSION, manifest);
+    }
+    http.end();
+    return ok;
+}
+
+/**
+ * Stream firmware from the release into the inactive slot
+ */
+static bool downloadImage(const OtaManifest_t* manifest) {
+    lastWasDelta = false;
+    if (!ota_manager_begin(manifest->size, manifest->sha256)) {
+        return false;
+    }
+    if (!streamDownload(manifest->file, manifest->size, sinkImage, nullptr)) {
+        return false;
+    }
+    return ota_manager_end();
+}
+
+/**
+ * Rebuild the new image from the running slot plus a downloaded patch
+ * Decoder state comes from the scratch pool (fixed size, no window).
+ */
+static bool downloadDelta(const OtaManifest_t* manifest) {
+    lastWasDelta = true;
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    if (!running) {
+        return false;
+    }
+
+    DeltaPatch_t* patch = (DeltaPatch_t*)scratch_pool_malloc(sizeof(DeltaPatch_t));
+    if (!patch) {
+        return false;
+    }
+    delta_patch_init(patch, readRunning, writePatched, (void*)running, running->size);
+
+    bool ok = ota_manager_begin(manifest->size, manifest->sha256) &&
+              streamDownload(manifest->deltaFile, manifest->deltaSize, sinkPatch, patch);
+
+    if (ok) {
+        DeltaResult_t result = delta_patch_finish(patch);
+        if (result != DELTA_OK || delta_patch_get_new_size(patch) != manifest->size) {
+            Serial.printf("[OTA] Patch: %s\n", delta_patch_get_error_name(result));
+            ok = fail(OTA_ERR_PATCH);
+        }
+    }
+    scratch_pool_free(patch);
+
+    return ok && ota_manager_end();
+}
+
+/**
+ * GET a release asset and pass the body to sink in OTA_CHUNK_SIZE pieces
+ * @param length Expected body length (0 = trust Content-Length)
+ */
+static bool streamDownload(const char* file, uint32_t length,
+                           bool (*sink)(void*, const uint8_t*, size_t), void* ctx) {
+    char url[192];
+    snprintf(url, sizeof(url), "https://github.com/%s/%s/releases/latest/download/%s",
+             GITHUB_USER, GITHUB_REPO, file);
+
+    HTTPClient http;
+    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    http.begin(url);
+    downloaded = 0;
+
+    if (http.GET() != 200) {
+        http.end();
+        return fail(OTA_ERR_DOWNLOAD);
+    }
+
+    int contentLength = http.getSize();
+    if (length == 0 && contentLength > 0) {
+        length = (uint32_t)contentLength;
+    }
+    if (length == 0 || (contentLength > 0 && (uint32_t)contentLength != length)) {
+        http.end();
+        return fail(OTA_ERR_SIZE);
+    }
+
+    uint8_t* buf = (uint8_t*)scratch_pool_malloc(OTA_CHUNK_SIZE);
+    if (!buf) {
+        http.end();
+        return fail(OTA_ERR_DOWNLOAD);
+    }
+
+    WiFiClient* stream = http.getStreamPtr();
+    unsigned long lastData = millis();
+    bool ok = true;
+
+    while (downloaded < length) {
+        // Download blocks loop() - keep the watchdog and heartbeat fed
+        safety_manager_feed_watchdog();
+        safety_manager_heartbeat(HEARTBEAT_NETWORK);
+
+        size_t avail = stream->available();
+        if (avail == 0) {
+            if (!http.connected() || millis() - lastData > OTA_STALL_TIMEOUT_MS) {
+                ok = fail(OTA_ERR_DOWNLOAD);
+                break;
+            }
+            delay(1);
+            continue;
+        }
+
+        size_t want = length - downloaded;
+        if (want > avail) want = avail;
+        if (want > OTA_CHUNK_SIZE) want = OTA_CHUNK_SIZE;
+
+        int n = stream->readBytes(buf, want);
+        if (n <= 0) {
+            continue;
+        }
+        lastData = millis();
+        downloaded += n;
+
+        if (!sink(ctx, buf, (size_t)n)) {
+            ok = false;
+            break;
+        }
+    }
+
+    scratch_pool_free(buf);
+    http.end();
+    return ok;
+}
+
+static bool sinkImage(void* ctx, const uint8_t* data, size_t len) {
+    (void)ctx;
+    return ota_manager_write(data, len);
+}
+
+static bool sinkPatch(void* ctx, const uint8_t* data, size_t len) {
+    DeltaPatch_t* patch = (DeltaPatch_t*)ctx;
+    DeltaResult_t result = delta_patch_feed(patch, data, len);
+    if (result == DELTA_OK) {
+        return true;
+    }
+    // Write errors were already reported by ota_manager_write
+    if (state == OTA_STATE_WRITING) {
+        Serial.printf("[OTA] Patch: %s\n", delta_patch_get_error_name(result));
+        fail(OTA_ERR_PATCH);
+    }
+    return false;
+}
+
+static bool readRunning(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+    return esp_partition_read((const esp_partition_t*)ctx, offset, buf, len) == ESP_OK;
+}
+
+static bool writePatched(void* ctx, const uint8_t* data, size_t len) {
+    (void)ctx;
+    return ota_manager_write(data, len);
+}
+
+/**
+ * Hex digit value (-1 if not hex)
+ */
+static int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
@@ -0,0 +1,82 @@
+/**
+ * telemetry_frame.cpp
+ * Compact MQTT Telemetry Frame Implementation
+ */
+
+#include "telemetry_frame.h"
+#include "frame_codec.h"
+#include <math.h>
+#include <string.h>
+
+// ===== BYTE HELPERS =====
+
+static uint16_t encodeHeap(uint32_t bytes) {
+    uint32_t units = bytes / TELEMETRY_HEAP_UNIT;
+    return units > 0xFFFF ? 0xFFFF : (uint16_t)units;
+}
+
+// ===== FRAME =====
+
+/**
+ * Encode a telemetry frame
+ */
+size_t telemetry_frame_encode(const Telemetry_t* telemetry, uint8_t* buf, size_t len) {
+    if (len < TELEMETRY_FRAME_SIZE) {
+        return 0;
+    }
+    memset(buf, 0, TELEMETRY_FRAME_SIZE);
+    buf[0] = TELEMETRY_VERSION;
+    buf[1] = telemetry->flags;
+    frame_put16(buf + 2, telemetry->seq);
+    frame_put32(buf + 4, telemetry->uptimeSec);
+    buf[8] = (uint8_t)telemetry->rssi;
+    buf[9] = telemetry->outputCount > TELEMETRY_OUTPUTS ? TELEMETRY_OUTPUTS : telemetry->outputCount;
+    frame_put16(buf + 10, encodeHeap(telemetry->heapFree));
+    frame_put16(buf + 12, encodeHeap(telemetry->heapLargest));
+
+    for (int i = 0; i < TELEMETRY_OUTPUTS; i++) {
+        const TelemetryOutput_t* o = &telemetry->outputs[i];
+        uint8_t* p = buf + 14 + 14 * i;
+        frame_put16(p, (uint16_t)frame_encode_temp(o->temp));
+        frame_put16(p + 2, (uint16_t)frame_encode_temp(o->target));
+        p[4] = frame_encode_humidity(o->humidity);
+        p[5] = o->power;
+        p[6] = o->mode;
+        p[7] = o->flags;
+        frame_put16(p + 8, (isnan(o->powerW) || o->powerW < 0.0f) ? 0
+                     : o->powerW >= 6553.5f ? 0xFFFF : (uint16_t)lroundf(o->powerW * 10.0f));
+        frame_put32(p + 10, o->energyWh);
+    }
+    return TELEMETRY_FRAME_SIZE;
+}
+
+/**
+ * Decode a telemetry frame
+ */
+bool telemetry_frame_decode(const uint8_t* buf, size_t len, Telemetry_t* telemetry) {
+    if (len != TELEMETRY_FRAME_SIZE || buf[0] != TELEMETRY_VERSION || buf[9] > TELEMETRY_OUTPUTS) {
+        return false;
+    }
+    memset(telemetry, 0, sizeof(*telemetry));
+    telemetry->flags = buf[1];
+    telemetry->seq = frame_get16(buf + 2);
+    telemetry->uptimeSec = frame_get32(buf + 4);
+    telemetry->rssi = (int8_t)buf[8];
+    telemetry->outputCount = buf[9];
+    telemetry->heapFree = (uint32_t)frame_get16(buf + 10) * TELEMETRY_HEAP_UNIT;
+    telemetry->heapLargest = (uint32_t)frame_get16(buf + 12) * TELEMETRY_HEAP_UNIT;
+
+    for (int i = 0; i < TELEMETRY_OUTPUTS; i++) {
+        TelemetryOutput_t* o = &telemetry->outputs[i];
+        const uint8_t* p = buf + 14 + 14 * i;
+        o->temp = frame_decode_temp((int16_t)frame_get16(p));
+        o->target = frame_decode_temp((int16_t)frame_get16(p + 2));
+        o->humidity = frame_decode_humidity(p[4]);
+        o->power = p[5];
+        o->mode = p[6];
+        o->flags = p[7];
+        o->powerW = frame_get16(p + 8) / 10.0f;
+        o->energyWh = frame_get32(p + 10);
+    }
+    return true;
+}
@@ -6,10 +6,22 @@
 #include "web_server.h"
 #include "logger.h"
 #include "temp_history.h"
+#include "history_bulk.h"
+#include "metrics_exporter.h"
 #include "console.h"
 #include "sensor_manager.h"
 #include "output_manager.h"
 #include "safety_manager.h"
+#include "loop_profiler.h"
+#include "crash_log.h"
+#include "boot_profile.h"
+#include "heap_monitor.h"
+#include "scratch_pool.h"
+#include "ota_manager.h"
+#include "event_bus.h"
+#include "wifi_manager.h"
+#include "fleet_manager.h"
+#include "time_service.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <Preferences.h>
@@ -22,11 +34,11 @@ static TempModeCallback_t controlCallback = NULL;
 static ScheduleSaveCallback_t scheduleCallback = NULL;
 static WebServerCallback_t restartCallback = NULL;
 
-// State variables (updated by main code)
+// Legacy single-output state (Output 1, kept current from the event bus)
 static float currentTemp = 0.0;
 static float targetTemp = 28.0;
 static bool heatingState = false;
-static char currentMode[8] = "auto";
+static char currentMode[12] = "auto";
 static int powerOutput = 0;
 
 // Device info
@@ -39,8 +51,10 @@ static bool networkAPMode = false;
 static char networkSSID[33] = "";
 static char networkIP[16] = "";
 
+// Event bus subscription (Output 1 state, network status)
+static int eventSub = -1;
+
 // Logging (deprecated - using logger module now)
-#define MAX_LOGS 20
 
 // Schedule data (legacy - now handled per-output in output_manager)
 // Keeping variables for backward compatibility with old API endpoints
@@ -48,7 +62,6 @@ static char networkIP[16] = "";
 // GitHub auto-update configuration
 static const char* GITHUB_USER = "cheew";
 static const char* GITHUB_REPO = "Claude-ESP32-Thermostat";
-static const char* GITHUB_FIRMWARE = "firmware.bin";
 
 // Security settings
 static bool secureMode = false;
@@ -68,6 +81,7 @@ static void handleSchedule(void);
 static void handleHistoryPage(void);
 static void handleInfo(void);
 static void handleLogs(void);
+static void handleFleetPage(void);
 static void handleConsole(void);
 static void handleSettings(void);
 static void handleStatus(void);
@@ -96,6 +110,19 @@ static void handleSensorName(void);
 
 // v1 API handlers
 static void handleHealthAPI(void);
+static void handlePerfAPI(void);
+static void handlePerfReset(void);
+static void handlePerfLog(void);
+static void handleCrashLogAPI(void);
+static void handleCrashLogClear(void);
+static void handleBootAPI(void);
+static void handleHeapAPI(void);
+static void handleOtaAPI(void);
+static void handleEnergyAPI(void);
+static void handleFleetAPI(void);
+static void handleHistoryBulk(void);
+static void handleMetrics(void);
+static void handleTimeAPI(void);
 
 // Safety page and API handlers
 static void handleSafetyPage(void);
@@ -104,14 +131,149 @@ static void handleEmergencyStop(void);
 static void handleExitSafeMode(void);
 
 // HTML generation helpers
-static String buildCSS(void);
-static String buildNavBar(const char* activePage);
+static void writeCSS(Print& out);
+static void writeNavBar(Print& out, const char* activePage);
+
+// Event bus
+static void processEvents(void);
+static void applyOutput1(const OutputEvent_t* output);
+static void applyNetwork(const NetworkEvent_t* network);
+static const char* legacyModeName(uint8_t mode);
 
 // Authentication helpers
 static void generateSessionToken(void);
 static bool isAuthenticated(void);
 static void requireAuth(void);
 
+// ===== RESPONSE STREAMING =====
+// Responses go out through scratch pool buffers instead of being
+// concatenated into one heap String per request.
+
+static void flushToClient(void* ctx, const uint8_t* data, size_t len) {
+    (void)ctx;
+    server.sendContent((const char*)data, len);
+}
+
+/**
+ * Send a JSON document with a known Content-Length
+ */
+static void sendJson(int code, JsonDocument& doc) {
+    server.setContentLength(measureJson(doc));
+    server.send(code, "application/json", "");
+
+    ScratchStream out(flushToClient, nullptr);
+    serializeJson(doc, out);
+    out.flush();
+}
+
+/**
+ * Copy a snapshot string into a JSON document
+ * ArduinoJson stores const char* by reference; an OutputSnapshot released
+ * inside a loop may be reused before the document is serialized.
+ */
+static inline char* snapshotStr(const char* s) {
+    return const_cast<char*>(s);   // char* is duplicated into the document pool
+}
+
+/**
+ * Page/response writer (chunked transfer, text/html by default)
+ * Nothing is sent until the first chunk fills, so a handler can still
+ * bail out with a different response before then.
+ */
+class PageStream : public ScratchStream {
+public:
+    explicit PageStream(const char* contentType = "text/html")
+        : ScratchStream(onFlush, this), contentType_(contentType), started_(false), finished_(false) {}
+    ~PageStream() { if (started_ && !finished_) server.sendContent(""); }
+
+    // Flush remaining bytes and terminate the chunked response
+    void finish() {
+        flush();
+        if (!started_) {
+            start();
+        }
+        server.sendContent("");
+        finished_ = true;
+    }
+
+private:
+    void start() {
+        server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        server.send(200, contentType_, "");
+        started_ = true;
+    }
+
+    static void onFlush(void* ctx, const uint8_t* data, size_t len) {
+        PageStream* self = (PageStream*)ctx;
+        if (!self->started_) {
+            self->start();
+        }
+        server.sendContent((const char*)data, len);
+    }
+
+    const char* contentType_;
+    bool started_;
+    bool finished_;
+};
+
+/**
+ * Write a quoted, escaped JSON string
+ */
+static void writeJsonString(Print& out, const char* s) {
+    out.write('"');
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            out.write('\\');
+            out.write(c);
+        } else if (c < 0x20) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out.print(esc);
+        } else {
+            out.write(c);
+        }
+    }
+    out.write('"');
+}
+
+/**
+ * Read the ?since= cursor of an incremental fetch
+ * A cursor beyond next (the unit restarted since the client's last poll)
+ * starts over from the oldest entry.
+ * @param next Sequence number the next entry will get
+ * @param since Output cursor (0 if absent)
+ * @return true if the client sent a usable cursor (gaps are reportable)
+ */
+static bool parseSinceArg(uint32_t next, uint32_t* since) {
+    *since = 0;
+    if (!server.hasArg("since")) {
+        return false;
+    }
+    *since = strtoul(server.arg("since").c_str(), nullptr, 10);
+    if ((int32_t)(next - *since) < 0) {
+        *since = 0;
+    }
+    return true;
+}
+
+// ===== PER-REQUEST ALLOCATION STATS =====
+#define REQUEST_STATS_MAX 16
+
+typedef struct {
+    char uri[32];
+    uint32_t requests;
+    uint32_t lastAllocs;        // Heap allocations (tracking builds only)
+    uint32_t maxAllocs;
+    uint32_t lastArenas;        // Scratch arenas used
+    uint32_t fallbacks;         // Scratch requests that fell back to malloc
+} RequestStats_t;
+
+static RequestStats_t requestStats[REQUEST_STATS_MAX];
+static int requestStatsCount = 0;
+
+static void recordRequestStats(const char* uri, uint32_t allocs, uint32_t arenas, uint32_t fallbacks);
+
 /**
  * Generate a random session token
  */
@@ -158,7 +320,7 @@ static void requireAuth(void) {
  * Handle login page (GET shows form, POST validates)
  */
 static void handleLogin(void) {
-    String error = "";
+    const char* error = "";
     String redirect = server.arg("redirect");
     if (redirect.length() == 0) redirect = "/";
 
@@ -180,9 +342,12 @@ static void handleLogin(void) {
     }
 
     // Show login form
-    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'>";
+    PageStream html;
+    html += "<!DOCTYPE html><html><head><meta charset='UTF-8'>";
     html += "<meta name='viewport' content='width=device-width,initial-scale=1'>";
-    html += "<title>Login - " + String(deviceName) + "</title>";
+    html += "<title>Login - ";
+    html.print(deviceName);
+    html += "</title>";
     html += "<style>";
     html += "body{font-family:Arial,sans-serif;background:#f5f5f5;display:flex;justify-content:center;align-items:center;min-height:100vh;margin:0}";
     html += ".login-box{background:white;padding:40px;border-radius:10px;box-shadow:0 2px 10px rgba(0,0,0,0.1);text-align:center;max-width:300px;width:90%}";
@@ -195,19 +360,25 @@ static void handleLogin(void) {
     html += ".device-name{color:#666;font-size:14px;margin-bottom:10px}";
     html += "</style></head><body>";
     html += "<div class='login-box'>";
-    html += "<div class='device-name'>" + String(deviceName) + "</div>";
+    html += "<div class='device-name'>";
+    html.print(deviceName);
+    html += "</div>";
     html += "<h1>Enter PIN</h1>";
-    if (error.length() > 0) {
-        html += "<div class='error'>" + error + "</div>";
+    if (error[0] != '\0') {
+        html += "<div class='error'>";
+        html += error;
+        html += "</div>";
     }
     html += "<form method='POST'>";
-    html += "<input type='hidden' name='redirect' value='" + redirect + "'>";
+    html += "<input type='hidden' name='redirect' value='";
+    html += redirect;
+    html += "'>";
     html += "<input type='password' name='pin' maxlength='6' pattern='[0-9]*' inputmode='numeric' placeholder='****' autofocus required>";
     html += "<button type='submit'>Login</button>";
     html += "</form>";
     html += "</div></body></html>";
 
-    server.send(200, "text/html", html);
+    html.finish();
 }
 
 /**
@@ -302,6 +473,27 @@ void webserver_init(void) {
     // Generate initial session token
     generateSessionToken();
 
+    // Seed state (earlier events went out before we subscribed), then follow the bus
+    eventSub = event_bus_subscribe(EVENT_MASK(EVENT_OUTPUT_STATE) | EVENT_MASK(EVENT_NETWORK_STATUS), "web");
+    NetworkEvent_t network;
+    network.connected = !wifi_is_ap_mode();
+    network.apMode = wifi_is_ap_mode();
+    strlcpy(network.ssid, wifi_get_ssid(), sizeof(network.ssid));
+    strlcpy(network.ip, wifi_get_ip_address(), sizeof(network.ip));
+    applyNetwork(&network);
+    {
+        OutputSnapshot output1(0);
+        if (output1) {
+            OutputEvent_t output;
+            output.temp = output1->currentTemp;
+            output.target = output1->targetTemp;
+            output.heating = output1->heating;
+            output.mode = (uint8_t)output1->controlMode;
+            output.power = (uint8_t)output1->currentPower;
+            applyOutput1(&output);
+        }
+    }
+
     Serial.printf("[WebServer] Secure mode: %s, UI mode: %s\n",
                   secureMode ? "ON" : "OFF",
                   advancedMode ? "Advanced" : "Simple");
@@ -320,7 +512,8 @@ void webserver_init(void) {
     server.on("/outputs", []() {
         // Protected route
         if (!isAuthenticated()) { requireAuth(); return; }
-        String html = webserver_get_html_header("Outputs", "outputs");
+        PageStream html;
+        webserver_write_html_header(html, "Outputs", "outputs");
 
         html += "<h2>Output Configuration</h2>";
         html += "<p>Configure each output's settings, sensor assignment, and PID parameters.</p>";
@@ -328,8 +521,14 @@ void webserver_init(void) {
         // Output selector tabs
         html += "<div style='display:flex;gap:10px;margin:20px 0'>";
         for (int i = 1; i <= 3; i++) {
-            html += "<button onclick='showOutput(" + String(i) + ")' id='tab" + String(i) + "' style='padding:10px 20px;cursor:pointer'>";
-            html += "Output " + String(i) + "</button>";
+            html += "<button onclick='showOutput(";
+            html.print(i);
+            html += ")' id='tab";
+            html.print(i);
+            html += "' style='padding:10px 20px;cursor:pointer'>";
+            html += "Output ";
+            html.print(i);
+            html += "</button>";
         }
         html += "</div>";
 
@@ -352,9 +551,30 @@ void webserver_init(void) {
         html += "document.getElementById('out-kp').value=d.pid.kp;";
         html += "document.getElementById('out-ki').value=d.pid.ki;";
         html += "document.getElementById('out-kd').value=d.pid.kd;";
+        html += "document.getElementById('out-sp-weight').value=d.pid.setpointWeight;";
         html += "document.getElementById('out-tp-cycle').value=d.timeProp.cycleSec;";
         html += "document.getElementById('out-tp-min-on').value=d.timeProp.minOnSec;";
         html += "document.getElementById('out-tp-min-off').value=d.timeProp.minOffSec;";
+        html += "document.getElementById('out-surface-sensor').value=d.surfaceSensor||'';";
+        html += "['outer','inner'].forEach(l=>['kp','ki','kd','min','max'].forEach(k=>";
+        html += "document.getElementById('cs-'+l+'-'+k).value=d.cascade[l][k]));";
+        html += "document.getElementById('cs-surface-max').value=d.cascade.surfaceMaxC;";
+        html += "document.getElementById('cs-outer-sec').value=d.cascade.outerPeriodSec;";
+        html += "document.getElementById('cs-inner-sec').value=d.cascade.innerPeriodSec;";
+        html += "document.getElementById('out-ambient-sensor').value=d.ambientSensor||'';";
+        html += "let gs=d.gainSchedule;document.getElementById('gs-enabled').checked=gs.enabled;";
+        html += "document.getElementById('gs-ff').value=gs.ffGain;";
+        html += "for(let j=0;j<4;j++){let p=gs.points[j]||{load:'',kp:'',ki:'',kd:''};";
+        html += "['load','kp','ki','kd'].forEach(k=>document.getElementById('gs-'+j+'-'+k).value=p[k]);}";
+        html += "document.getElementById('gs-status').innerText=(gs.active.load===null?'Ambient unknown (no room sensor, model still learning) - fixed gains':";
+        html += "'Load '+gs.active.load+'°C: Kp '+gs.active.kp+', Ki '+gs.active.ki+', Kd '+gs.active.kd+', feedforward '+gs.active.ff+'%')+";
+        html += "(gs.ffGainSuggested!==null?' | Suggested ff gain '+gs.ffGainSuggested:'');";
+        html += "let rh=d.humidity;['target','hysteresis','band','cycleSec','minOnSec','minOffSec','maxOnSec','maxDutyPct','windowMin'].forEach(k=>";
+        html += "document.getElementById('rh-'+k).value=rh[k]);document.getElementById('rh-method').value=rh.method;";
+        html += "document.getElementById('rh-status').innerText=(rh.current===null?'No humidity reading':'Now '+rh.current+'%RH')+";
+        html += "' | '+(rh.on?'ON':'OFF')+', duty '+rh.duty+'%, budget '+rh.budgetSec+'s'+(rh.limited?' | Held off by mister limits':'');";
+        html += "document.getElementById('out-rated-w').value=d.energy.ratedWatts;";
+        html += "document.getElementById('energy-info').innerText='Now '+d.energy.powerW+' W, '+d.energy.totalKwh+' kWh total';";
         html += "document.getElementById('device-info').innerHTML='<strong>Device:</strong> '+d.deviceType+' | <strong>Hardware:</strong> '+d.hardwareType;";
         html += "});}";
         html += "function saveConfig(){let data={";
@@ -363,10 +583,26 @@ void webserver_init(void) {
         html += "sensor:document.getElementById('out-sensor').value,";
         html += "pid:{kp:parseFloat(document.getElementById('out-kp').value),";
         html += "ki:parseFloat(document.getElementById('out-ki').value),";
-        html += "kd:parseFloat(document.getElementById('out-kd').value)},";
+        html += "kd:parseFloat(document.getElementById('out-kd').value),";
+        html += "setpointWeight:parseFloat(document.getElementById('out-sp-weight').value)},";
         html += "timeProp:{cycleSec:parseInt(document.getElementById('out-tp-cycle').value),";
         html += "minOnSec:parseInt(document.getElementById('out-tp-min-on').value),";
-        html += "minOffSec:parseInt(document.getElementById('out-tp-min-off').value)}};";
+        html += "minOffSec:parseInt(document.getElementById('out-tp-min-off').value)},";
+        html += "surfaceSensor:document.getElementById('out-surface-sensor').value,";
+        html += "cascade:{surfaceMaxC:parseFloat(document.getElementById('cs-surface-max').value),";
+        html += "outerPeriodSec:parseFloat(document.getElementById('cs-outer-sec').value),";
+        html += "innerPeriodSec:parseFloat(document.getElementById('cs-inner-sec').value)}};";
+        html += "['outer','inner'].forEach(l=>{data.cascade[l]={};['kp','ki','kd','min','max'].forEach(k=>";
+        html += "data.cascade[l][k]=parseFloat(document.getElementById('cs-'+l+'-'+k).value));});";
+        html += "data.ambientSensor=document.getElementById('out-ambient-sensor').value;";
+        html += "data.gainSchedule={enabled:document.getElementById('gs-enabled').checked,";
+        html += "ffGain:parseFloat(document.getElementById('gs-ff').value)||0,points:[]};";
+        html += "for(let j=0;j<4;j++){let v=k=>parseFloat(document.getElementById('gs-'+j+'-'+k).value);";
+        html += "if(!isNaN(v('load'))){data.gainSchedule.points.push({load:v('load'),kp:v('kp')||0,ki:v('ki')||0,kd:v('kd')||0});}}";
+        html += "data.energy={ratedWatts:parseInt(document.getElementById('out-rated-w').value)||0};";
+        html += "data.humidity={method:document.getElementById('rh-method').value};";
+        html += "['target','hysteresis','band','cycleSec','minOnSec','minOffSec','maxOnSec','maxDutyPct','windowMin'].forEach(k=>{";
+        html += "let v=parseFloat(document.getElementById('rh-'+k).value);if(!isNaN(v)){data.humidity[k]=v;}});";
         html += "fetch('/api/output/'+currentOutput+'/config',{method:'POST',";
         html += "headers:{'Content-Type':'application/json'},body:JSON.stringify(data)})";
         html += ".then(()=>alert('Saved!'));}";
@@ -404,20 +640,20 @@ void webserver_init(void) {
         html += "infoBox.innerHTML='ℹ️ <strong>No Sensor Mode:</strong> Only Schedule and Manual modes available. Use for lights, foggers, or misters.';";
         html += "modeSelect.querySelector('option[value=\"pid\"]').disabled=true;";
         html += "modeSelect.querySelector('option[value=\"onoff\"]').disabled=true;";
-        html += "if(modeSelect.value==='pid'||modeSelect.value==='onoff'){modeSelect.value='manual';}";
-        html += "}else if(val==='humidity'){";
-        html += "tempControl.style.display='block';";
-        html += "document.querySelector('label[for=\"temp-display\"]').innerHTML='<strong>Target Humidity: <span id=\"temp-display\">50.0</span>%</strong>';";
-        html += "infoBox.style.display='block';";
-        html += "infoBox.innerHTML='⚠️ <strong>Humidity Mode:</strong> Coming soon! Humidity sensors not yet supported.';";
-        html += "modeSelect.querySelector('option[value=\"pid\"]').disabled=false;";
-        html += "modeSelect.querySelector('option[value=\"onoff\"]').disabled=false;";
+        html += "modeSelect.querySelector('option[value=\"cascade\"]').disabled=true;";
+        html += "modeSelect.querySelector('option[value=\"humidity\"]').disabled=true;";
+        html += "if(['pid','onoff','cascade','humidity'].includes(modeSelect.value)){modeSelect.value='manual';}";
         html += "}else{";
+        html += "let opt=document.querySelector('#out-sensor option[value=\"'+val+'\"]');";
+        html += "let hasRh=!!(opt&&opt.dataset.rh);";
         html += "tempControl.style.display='block';";
-        html += "infoBox.style.display='none';";
-        html += "document.querySelector('label[for=\"temp-display\"]').innerHTML='<strong>Target Temperature: <span id=\"temp-display\">28.0</span>°C</strong>';";
+        html += "infoBox.style.display=hasRh?'block':'none';";
+        html += "infoBox.innerHTML='💧 <strong>Humidity Sensor:</strong> Humidity mode available (see Humidity Settings). Temperature limits still apply.';";
         html += "modeSelect.querySelector('option[value=\"pid\"]').disabled=false;";
         html += "modeSelect.querySelector('option[value=\"onoff\"]').disabled=false;";
+        html += "modeSelect.querySelector('option[value=\"cascade\"]').disabled=false;";
+        html += "modeSelect.querySelector('option[value=\"humidity\"]').disabled=!hasRh;";
+        html += "if(!hasRh&&modeSelect.value==='humidity'){modeSelect.value='manual';}";
         html += "}}";
 
         html += "showOutput(1)";
@@ -432,17 +668,54 @@ void webserver_init(void) {
 
         html += "<div style='margin:10px 0'><label>Sensor: <select id='out-sensor' style='width:300px' onchange='handleSensorChange(this.value)'>";
         html += "<option value='none'>No Sensor (Time/Manual Only)</option>";
-        html += "<option value='humidity'>Humidity Sensor (Future)</option>";
         int sensorCount = sensor_manager_get_count();
         for (int i = 0; i < sensorCount; i++) {
             const SensorInfo_t* sensor = sensor_manager_get_sensor(i);
             if (sensor) {
-                html += "<option value='" + String(sensor->addressString) + "'>" + String(sensor->name) + "</option>";
+                html += "<option value='";
+                html.print(sensor->addressString);
+                html += "'";
+                if (sensor->type != SENSOR_TYPE_DS18B20) {
+                    html += " data-rh='1'";
+                }
+                html += ">";
+                html.print(sensor->name);
+                html += "</option>";
             }
         }
         html += "</select></label></div>";
         html += "<div id='sensor-type-info' style='margin:10px 0;padding:10px;background:#fff3cd;border-radius:5px;display:none'></div>";
 
+        html += "<div style='margin:10px 0'><label>Surface Sensor (Cascade): <select id='out-surface-sensor' style='width:300px'>";
+        html += "<option value=''>None</option>";
+        for (int i = 0; i < sensorCount; i++) {
+            const SensorInfo_t* sensor = sensor_manager_get_sensor(i);
+            if (sensor) {
+                html += "<option value='";
+                html.print(sensor->addressString);
+                html += "'>";
+                html.print(sensor->name);
+                html += "</option>";
+            }
+        }
+        html += "</select></label></div>";
+
+        html += "<div style='margin:10px 0'><label>Ambient Sensor (Room): <select id='out-ambient-sensor' style='width:300px'>";
+        html += "<option value=''>None (estimate from model)</option>";
+        for (int i = 0; i < sensorCount; i++) {
+            const SensorInfo_t* sensor = sensor_manager_get_sensor(i);
+            if (sensor) {
+                html += "<option value='";
+                html.print(sensor->addressString);
+                html += "'>";
+                html.print(sensor->name);
+                html += "</option>";
+            }
+        }
+        html += "</select></label></div>";
+
+        html += "<div style='margin:10px 0'><label>Rated Power (W): <input type='number' id='out-rated-w' min='0' max='10000' style='width:100px'></label> ";
+        html += "<small id='energy-info' style='color:#666'></small></div>";
         html += "<div id='device-info' style='margin:10px 0;padding:10px;background:#e3f2fd;border-radius:5px'></div>";
 
         html += "<button onclick='saveConfig()' style='margin:10px 5px 10px 0;padding:10px 20px;background:#4CAF50;color:white;border:none;border-radius:5px;cursor:pointer'>Save Configuration</button>";
@@ -471,6 +744,8 @@ void webserver_init(void) {
         html += "<option value='pid'>PID (Auto)</option>";
         html += "<option value='onoff'>On/Off Thermostat</option>";
         html += "<option value='timeprop'>Time-Proportional</option>";
+        html += "<option value='cascade'>Cascade (Air + Surface)</option>";
+        html += "<option value='humidity'>Humidity (Fogger/Mister)</option>";
         html += "<option value='schedule'>Schedule</option>";
         html += "</select></label></div>";
         html += "<div style='margin:10px 0'><label>Manual Power (%): <input type='number' id='out-power' min='0' max='100' style='width:100px'></label></div>";
@@ -484,7 +759,8 @@ void webserver_init(void) {
         html += "<div style='margin:10px 0'><label>Kp (Proportional): <input type='number' id='out-kp' step='0.1' style='width:100px'></label></div>";
         html += "<div style='margin:10px 0'><label>Ki (Integral): <input type='number' id='out-ki' step='0.01' style='width:100px'></label></div>";
         html += "<div style='margin:10px 0'><label>Kd (Derivative): <input type='number' id='out-kd' step='0.1' style='width:100px'></label></div>";
-        html += "<p style='color:#666;font-size:14px'>PID tuning affects PID and Time-Proportional modes. Start with Kp=10, Ki=0.5, Kd=2.</p>";
+        html += "<div style='margin:10px 0'><label>Setpoint Weight (0-1): <input type='number' id='out-sp-weight' step='0.05' min='0' max='1' style='width:100px'></label></div>";
+        html += "<p style='color:#666;font-size:14px'>PID tuning affects PID and Time-Proportional modes. Start with Kp=10, Ki=0.5, Kd=2. A setpoint weight below 1 softens the response to target changes (less overshoot) without slowing recovery from disturbances. Changing gains or mode does not make the output jump.</p>";
         html += "</div>";
 
         // Time-Proportional Settings
@@ -496,22 +772,94 @@ void webserver_init(void) {
         html += "<p style='color:#666;font-size:14px'>Time-proportional converts PID output into ON/OFF cycles. 60% duty with 30s cycle = 18s ON, 12s OFF. Longer cycles (30-60s) reduce relay wear.</p>";
         html += "</div>";
 
+        // Cascade Settings
+        html += "<button onclick='document.getElementById(\"cascade-settings\").style.display=document.getElementById(\"cascade-settings\").style.display===\"none\"?\"block\":\"none\";this.innerText=this.innerText.includes(\"Show\")?\"Hide Cascade Settings\":\"Show Cascade Settings\"' style='margin:10px 0;padding:10px 15px;background:#9c27b0;color:white;border:none;border-radius:5px;cursor:pointer'>Show Cascade Settings</button>";
+        html += "<div id='cascade-settings' style='display:none;margin-top:10px;padding:15px;background:#f3e5f5;border-radius:5px'>";
+        html += "<div style='margin:10px 0'><label>Surface Ceiling (°C): <input type='number' id='cs-surface-max' step='0.5' min='20' max='60' style='width:100px'></label></div>";
+        {
+            static const char* const loops[] = {"outer", "inner"};
+            static const char* const titles[] = {"Air Loop (sets surface target, °C above air target)",
+                                                 "Surface Loop (sets power %)"};
+            for (int l = 0; l < 2; l++) {
+                html += "<p><strong>";
+                html += titles[l];
+                html += "</strong></p><div style='margin:10px 0'>";
+                static const char* const keys[] = {"kp", "ki", "kd", "min", "max"};
+                static const char* const labels[] = {"Kp", "Ki", "Kd", "Min", "Max"};
+                for (int k = 0; k < 5; k++) {
+                    html += "<label>";
+                    html += labels[k];
+                    html += ": <input type='number' step='any' style='width:70px' id='cs-";
+                    html += loops[l];
+                    html += "-";
+                    html += keys[k];
+                    html += "'></label> ";
+                }
+                html += "</div>";
+            }
+        }
+        html += "<div style='margin:10px 0'><label>Air Loop Period (sec): <input type='number' id='cs-outer-sec' min='2' max='120' style='width:100px'></label></div>";
+        html += "<div style='margin:10px 0'><label>Surface Loop Period (sec): <input type='number' id='cs-inner-sec' step='0.5' min='0.5' max='120' style='width:100px'></label></div>";
+        html += "<p style='color:#666;font-size:14px'>Cascade uses the main sensor for air and the surface sensor for the heater. The air loop picks a surface target (never above the ceiling); the faster surface loop holds it. Power is cut while the surface reads at or above the ceiling. SSR outputs use the Time-Prop cycle settings.</p>";
+        html += "</div>";
+
+        // Gain Schedule
+        html += "<button onclick='document.getElementById(\"gain-schedule\").style.display=document.getElementById(\"gain-schedule\").style.display===\"none\"?\"block\":\"none\";this.innerText=this.innerText.includes(\"Show\")?\"Hide Gain Schedule\":\"Show Gain Schedule\"' style='margin:10px 0;padding:10px 15px;background:#009688;color:white;border:none;border-radius:5px;cursor:pointer'>Show Gain Schedule</button>";
+        html += "<div id='gain-schedule' style='display:none;margin-top:10px;padding:15px;background:#e0f2f1;border-radius:5px'>";
+        html += "<div style='margin:10px 0'><label><input type='checkbox' id='gs-enabled' style='width:auto'> Enable gain schedule and feedforward</label></div>";
+        html += "<div style='margin:10px 0'><label>Feedforward (% per °C above room): <input type='number' id='gs-ff' step='0.1' min='0' max='20' style='width:100px'></label></div>";
+        html += "<table style='margin:10px 0'><tr><th>Load (°C)</th><th>Kp</th><th>Ki</th><th>Kd</th></tr>";
+        for (int j = 0; j < GAIN_SCHEDULE_POINTS; j++) {
+            html += "<tr>";
+            static const char* const keys[] = {"load", "kp", "ki", "kd"};
+            for (int k = 0; k < 4; k++) {
+                html += "<td><input type='number' step='any' style='width:70px' id='gs-";
+                html.print(j);
+                html += "-";
+                html += keys[k];
+                html += "'></td>";
+            }
+            html += "</tr>";
+        }
+        html += "</table>";
+        html += "<p id='gs-status' style='font-size:14px'></p>";
+        html += "<p style='color:#666;font-size:14px'>Load is target minus room temperature (room sensor, else the learned model's estimate). Gains are interpolated between rows (leave Load empty to drop a row; no rows keeps the PID Tuning gains). Feedforward adds power in proportion to the load so the integral only trims. Applies to PID and Time-Proportional modes.</p>";
+        html += "</div>";
+
+        // Humidity Settings
+        html += "<button onclick='document.getElementById(\"humidity-settings\").style.display=document.getElementById(\"humidity-settings\").style.display===\"none\"?\"block\":\"none\";this.innerText=this.innerText.includes(\"Show\")?\"Hide Humidity Settings\":\"Show Humidity Settings\"' style='margin:10px 0;padding:10px 15px;background:#03a9f4;color:white;border:none;border-radius:5px;cursor:pointer'>Show Humidity Settings</button>";
+        html += "<div id='humidity-settings' style='display:none;margin-top:10px;padding:15px;background:#e1f5fe;border-radius:5px'>";
+        html += "<p id='rh-status' style='font-size:14px'></p>";
+        html += "<div style='margin:10px 0'><label>Target Humidity (%RH): <input type='number' id='rh-target' step='1' min='0' max='100' style='width:100px'></label></div>";
+        html += "<div style='margin:10px 0'><label>Method: <select id='rh-method'><option value='onoff'>On/Off</option><option value='timeprop'>Time-Proportional</option></select></label></div>";
+        html += "<div style='margin:10px 0'><label>Hysteresis (%RH, On/Off): <input type='number' id='rh-hysteresis' step='0.5' min='0.5' max='30' style='width:100px'></label></div>";
+        html += "<div style='margin:10px 0'><label>Band (%RH, Time-Prop): <input type='number' id='rh-band' step='1' min='1' max='50' style='width:100px'></label></div>";
+        html += "<div style='margin:10px 0'><label>Cycle Time (sec, Time-Prop): <input type='number' id='rh-cycleSec' min='10' max='3600' style='width:100px'></label></div>";
+        html += "<div style='margin:10px 0'><label>Min ON Time (sec): <input type='number' id='rh-minOnSec' min='1' max='600' style='width:100px'></label></div>";
+        html += "<div style='margin:10px 0'><label>Min OFF / Soak Time (sec): <input type='number' id='rh-minOffSec' min='0' max='3600' style='width:100px'></label></div>";
+        html += "<div style='margin:10px 0'><label>Max Burst (sec, 0 = none): <input type='number' id='rh-maxOnSec' min='0' max='3600' style='width:100px'></label></div>";
+        html += "<div style='margin:10px 0'><label>Max Duty (%): <input type='number' id='rh-maxDutyPct' min='1' max='100' style='width:100px'></label> ";
+        html += "<label>over (min): <input type='number' id='rh-windowMin' min='1' max='1440' style='width:100px'></label></div>";
+        html += "<p style='color:#666;font-size:14px'>Humidity mode switches the output fully on or off from the main sensor's humidity reading (SHT3x or BME280). Misters can waterlog an enclosure long before the sensor catches up, so every burst is capped at Max Burst, followed by at least the soak time, and the long-run ON time never exceeds Max Duty. The default is a 30 s burst, 60 s soak and 10% duty.</p>";
+        html += "</div>";
+
         html += "</div>";
 
-        html += webserver_get_html_footer(millis() / 1000);
-        server.send(200, "text/html", html);
+        webserver_write_html_footer(html, time_service_uptime_sec());
+        html.finish();
     });
     server.on("/sensors", []() {
-        String html = webserver_get_html_header("Sensors", "sensors");
+        PageStream html;
+        webserver_write_html_header(html, "Sensors", "sensors");
 
-        html += "<h2>Temperature Sensors</h2>";
-        html += "<p>Manage your DS18B20 temperature sensors. Rename sensors for easier identification.</p>";
+        html += "<h2>Sensors</h2>";
+        html += "<p>Manage your DS18B20 temperature and SHT3x/BME280 humidity sensors. Rename sensors for easier identification.</p>";
 
         // Auto-refresh script
         html += "<script>function updateSensors(){fetch('/api/sensors').then(r=>r.json()).then(d=>{";
         html += "let tbody=document.getElementById('sensor-tbody');tbody.innerHTML='';";
         html += "d.sensors.forEach(s=>{let row=tbody.insertRow();";
-        html += "row.innerHTML=`<td>${s.name}</td><td>${s.temp}°C</td><td><small>${s.address}</small></td>";
+        html += "row.innerHTML=`<td>${s.name}</td><td>${s.type}</td><td>${s.temp}°C</td><td>${s.humidity===null?'-':s.humidity+'%'}</td><td><small>${s.address}</small></td>";
         html += "<td><button onclick='renameSensor(\"${s.address}\",\"${s.name}\")'>Rename</button></td>`;";
         html += "});});}updateSensors();setInterval(updateSensors,3000);";
         html += "function renameSensor(addr,oldName){let name=prompt('Rename sensor:',oldName);if(name&&name!==oldName){";
@@ -522,7 +870,9 @@ void webserver_init(void) {
         // Sensors table
         html += "<table style='width:100%;border-collapse:collapse;margin:20px 0'>";
         html += "<thead><tr style='background:#f0f0f0'><th style='padding:10px;text-align:left'>Name</th>";
+        html += "<th style='padding:10px;text-align:left'>Type</th>";
         html += "<th style='padding:10px;text-align:left'>Temperature</th>";
+        html += "<th style='padding:10px;text-align:left'>Humidity</th>";
         html += "<th style='padding:10px;text-align:left'>Address</th>";
         html += "<th style='padding:10px;text-align:left'>Actions</th></tr></thead>";
         html += "<tbody id='sensor-tbody'>";
@@ -530,17 +880,38 @@ void webserver_init(void) {
         // Generate initial rows
         int sensorCount = sensor_manager_get_count();
         if (sensorCount == 0) {
-            html += "<tr><td colspan='4' style='padding:20px;text-align:center;color:#999'>No sensors found. Check wiring and restart.</td></tr>";
+            html += "<tr><td colspan='6' style='padding:20px;text-align:center;color:#999'>No sensors found. Check wiring and restart.</td></tr>";
         } else {
             for (int i = 0; i < sensorCount; i++) {
                 const SensorInfo_t* sensor = sensor_manager_get_sensor(i);
                 if (!sensor) continue;
 
                 html += "<tr style='border-bottom:1px solid #ddd'>";
-                html += "<td style='padding:10px'>" + String(sensor->name) + "</td>";
-                html += "<td style='padding:10px'>" + String(sensor->lastReading, 1) + "°C</td>";
-                html += "<td style='padding:10px'><small>" + String(sensor->addressString) + "</small></td>";
-                html += "<td style='padding:10px'><button onclick='renameSensor(\"" + String(sensor->addressString) + "\",\"" + String(sensor->name) + "\")'>Rename</button></td>";
+                html += "<td style='padding:10px'>";
+                html.print(sensor->name);
+                html += "</td>";
+                html += "<td style='padding:10px'>";
+                html.print(sensor_manager_get_type_name(sensor->type));
+                html += "</td>";
+                html += "<td style='padding:10px'>";
+                html.print(sensor->lastReading, 1);
+                html += "°C</td>";
+                html += "<td style='padding:10px'>";
+                if (sensor_manager_is_valid_humidity(sensor->lastHumidity)) {
+                    html.print(sensor->lastHumidity, 1);
+                    html += "%";
+                } else {
+                    html += "-";
+                }
+                html += "</td>";
+                html += "<td style='padding:10px'><small>";
+                html.print(sensor->addressString);
+                html += "</small></td>";
+                html += "<td style='padding:10px'><button onclick='renameSensor(\"";
+                html.print(sensor->addressString);
+                html += "\",\"";
+                html.print(sensor->name);
+                html += "\")'>Rename</button></td>";
                 html += "</tr>";
             }
         }
@@ -550,14 +921,14 @@ void webserver_init(void) {
         html += "<div style='margin:20px 0;padding:15px;background:#e3f2fd;border-radius:8px'>";
         html += "<strong>ℹ️ Sensor Information:</strong><br>";
         html += "• Sensors are auto-discovered on boot<br>";
-        html += "• Each sensor has a unique 64-bit ROM address<br>";
+        html += "• DS18B20 sensors have a unique 64-bit ROM address; I2C sensors show their bus address (SHT3x 0x44/0x45, BME280 0x76/0x77 on SDA 21 / SCL 26)<br>";
         html += "• Assign sensors to outputs in <a href='/outputs'>Outputs Configuration</a><br>";
         html += "• Temperature updates every 2 seconds<br>";
         html += "• To add new sensors: power off, connect sensor, power on";
         html += "</div>";
 
-        html += webserver_get_html_footer(millis() / 1000);
-        server.send(200, "text/html", html);
+        webserver_write_html_footer(html, time_service_uptime_sec());
+        html.finish();
     });
     server.on("/schedule", handleSchedule);
     server.on("/history", handleHistoryPage);
@@ -566,6 +937,7 @@ void webserver_init(void) {
     server.on("/console", handleConsole);
     server.on("/settings", handleSettings);
     server.on("/safety", handleSafetyPage);
+    server.on("/fleet", handleFleetPage);
 
     // API endpoints
     server.on("/api/status", handleStatus);
@@ -608,15 +980,31 @@ void webserver_init(void) {
     // Safety API routes
     server.on("/api/safety/state", HTTP_GET, []() {
         const SafetyState_t* state = safety_manager_get_state();
-        StaticJsonDocument<256> doc;
+        ScratchJsonDocument doc(1024);
         doc["safeMode"] = state->safeMode;
         doc["safeModeReason"] = safety_manager_get_reason_name(state->safeModeReason);
         doc["bootCount"] = state->bootCount;
         doc["watchdogEnabled"] = state->watchdogEnabled;
         doc["watchdogMarginMs"] = safety_manager_get_watchdog_margin();
-        String response;
-        serializeJson(doc, response);
-        server.send(200, "application/json", response);
+        doc["outputsHeldSafe"] = state->outputsHeldSafe;
+        doc["stallCount"] = state->stallCount;
+        doc["lastStall"] = state->lastStallId >= 0
+            ? safety_manager_get_heartbeat_name((HeartbeatId_t)state->lastStallId) : "none";
+
+        JsonArray hbs = doc.createNestedArray("heartbeats");
+        unsigned long now = millis();
+        for (int i = 0; i < HEARTBEAT_COUNT; i++) {
+            const HeartbeatInfo_t* hb = safety_manager_get_heartbeat((HeartbeatId_t)i);
+            if (!hb || !hb->registered) continue;
+            JsonObject h = hbs.createNestedObject();
+            h["name"] = safety_manager_get_heartbeat_name((HeartbeatId_t)i);
+            h["periodMs"] = hb->periodMs;
+            h["ageMs"] = now - hb->lastBeat;
+            h["beats"] = hb->beats;
+            h["stalls"] = hb->stalls;
+            h["stalled"] = hb->stalled;
+        }
+        sendJson(200, doc);
     });
     server.on("/api/safety/emergency-stop", HTTP_POST, handleEmergencyStop);
     server.on("/api/safety/exit-safe-mode", HTTP_POST, handleExitSafeMode);
@@ -627,6 +1015,21 @@ void webserver_init(void) {
     server.on("/api/v1/output/1", HTTP_GET, handleOutputAPI);
     server.on("/api/v1/output/2", HTTP_GET, handleOutputAPI);
     server.on("/api/v1/output/3", HTTP_GET, handleOutputAPI);
+    server.on("/api/v1/perf", HTTP_GET, handlePerfAPI);
+    server.on("/api/v1/perf/reset", HTTP_POST, handlePerfReset);
+    server.on("/api/v1/perf/log", HTTP_POST, handlePerfLog);
+    server.on("/api/v1/crashlog", HTTP_GET, handleCrashLogAPI);
+    server.on("/api/v1/crashlog/clear", HTTP_POST, handleCrashLogClear);
+    server.on("/api/v1/boot", HTTP_GET, handleBootAPI);
+    server.on("/api/v1/heap", HTTP_GET, handleHeapAPI);
+    server.on("/api/v1/ota", HTTP_GET, handleOtaAPI);
+    server.on("/api/v1/energy", HTTP_GET, handleEnergyAPI);
+    server.on("/api/v1/fleet", HTTP_GET, handleFleetAPI);
+    server.on("/api/v1/history/bulk", HTTP_GET, handleHistoryBulk);
+    server.on("/api/v1/time", HTTP_GET, handleTimeAPI);
+
+    // Prometheus scrape target
+    server.on("/metrics", HTTP_GET, handleMetrics);
 
     // Sensor API routes
     server.on("/api/sensors", HTTP_GET, handleSensorsAPI);
@@ -644,7 +1047,52 @@ void webserver_init(void) {
  * Web server task
  */
 void webserver_task(void) {
+    HEAP_TRACK_SCOPE("web_task");
+
+    processEvents();
+
+    const ScratchPoolStats_t* pool = scratch_pool_get_stats();
+    uint32_t allocsBefore = heap_monitor_get_alloc_count();
+    uint32_t arenasBefore = pool->acquisitions;
+    uint32_t fallbacksBefore = pool->fallbacks;
+
     server.handleClient();
+
+    // Handlers take at least one arena, so a change means a request was served
+    uint32_t arenas = pool->acquisitions - arenasBefore;
+    uint32_t allocs = heap_monitor_get_alloc_count() - allocsBefore;
+    if (arenas > 0 || allocs > 0) {
+        recordRequestStats(server.uri().c_str(), allocs, arenas, pool->fallbacks - fallbacksBefore);
+    }
+
+    safety_manager_heartbeat(HEARTBEAT_NETWORK);
+}
+
+/**
+ * Accumulate allocation stats for a URI
+ */
+static void recordRequestStats(const char* uri, uint32_t allocs, uint32_t arenas, uint32_t fallbacks) {
+    RequestStats_t* entry = nullptr;
+    for (int i = 0; i < requestStatsCount; i++) {
+        if (strncmp(requestStats[i].uri, uri, sizeof(requestStats[i].uri) - 1) == 0) {
+            entry = &requestStats[i];
+            break;
+        }
+    }
+    if (!entry) {
+        if (requestStatsCount >= REQUEST_STATS_MAX) {
+            return;
+        }
+        entry = &requestStats[requestStatsCount++];
+        memset(entry, 0, sizeof(*entry));
+        strncpy(entry->uri, uri, sizeof(entry->uri) - 1);
+    }
+
+    entry->requests++;
+    entry->lastAllocs = allocs;
+    if (allocs > entry->maxAllocs) entry->maxAllocs = allocs;
+    entry->lastArenas = arenas;
+    entry->fallbacks += fallbacks;
 }
 
 /**
@@ -668,18 +1116,6 @@ void webserver_set_restart_callback(WebServerCallback_t callback) {
     restartCallback = callback;
 }
 
-/**
- * Set current state
- */
-void webserver_set_state(float temp, float target, bool heating, 
-                         const char* mode, int power) {
-    currentTemp = temp;
-    targetTemp = target;
-    heatingState = heating;
-    strncpy(currentMode, mode, sizeof(currentMode) - 1);
-    powerOutput = power;
-}
-
 /**
  * Set device info
  */
@@ -688,17 +1124,6 @@ void webserver_set_device_info(const char* name, const char* version) {
     strncpy(firmwareVersion, version, sizeof(firmwareVersion) - 1);
 }
 
-/**
- * Set network status
- */
-void webserver_set_network_status(bool connected, bool apMode, 
-                                  const char* ssid, const char* ip) {
-    networkConnected = connected;
-    networkAPMode = apMode;
-    strncpy(networkSSID, ssid, sizeof(networkSSID) - 1);
-    strncpy(networkIP, ip, sizeof(networkIP) - 1);
-}
-
 /**
  * Add log entry (deprecated - use logger module)
  */
@@ -710,13 +1135,64 @@ void webserver_add_log(const char* message) {
 // webserver_set_schedule_data() removed - legacy function no longer needed
 // Schedule data now managed per-output via output_manager
 
+// ===== EVENT BUS =====
+
+/**
+ * Drain pending bus events (replaces per-loop state pushes from main)
+ */
+static void processEvents(void) {
+    Event_t event;
+    while (event_bus_poll(eventSub, &event)) {
+        if (event.topic == EVENT_OUTPUT_STATE && event.output.index == 0) {
+            applyOutput1(&event.output);
+        } else if (event.topic == EVENT_NETWORK_STATUS) {
+            applyNetwork(&event.network);
+        }
+    }
+}
+
+/**
+ * Update legacy state from Output 1
+ */
+static void applyOutput1(const OutputEvent_t* output) {
+    currentTemp = output->temp;
+    targetTemp = output->target;
+    heatingState = output->heating;
+    powerOutput = output->power;
+    strlcpy(currentMode, legacyModeName(output->mode), sizeof(currentMode));
+}
+
+/**
+ * Update network status
+ */
+static void applyNetwork(const NetworkEvent_t* network) {
+    networkConnected = network->connected;
+    networkAPMode = network->apMode;
+    strlcpy(networkSSID, network->ssid, sizeof(networkSSID));
+    strlcpy(networkIP, network->ip, sizeof(networkIP));
+}
+
+/**
+ * Map control mode to the legacy mode string (/api/status, /control)
+ */
+static const char* legacyModeName(uint8_t mode) {
+    switch (mode) {
+        case CONTROL_MODE_MANUAL:   return "manual";
+        case CONTROL_MODE_PID:      return "auto";
+        case CONTROL_MODE_ONOFF:    return "onoff";
+        case CONTROL_MODE_SCHEDULE: return "schedule";
+        default:                    return "off";
+    }
+}
+
 // ===== ROUTE HANDLERS =====
 
 /**
  * Handle root page (/) - Simple or Advanced mode
  */
 static void handleRoot(void) {
-    String html = webserver_get_html_header("Home", "home");
+    PageStream html;
+    webserver_write_html_header(html, "Home", "home");
 
     if (networkAPMode) {
         html += "<div class='warning-box'><strong>AP Mode Active</strong><br>";
@@ -810,42 +1286,55 @@ static void handleRoot(void) {
         html += "<div style='display:grid;grid-template-columns:repeat(auto-fit,minmax(300px,1fr));gap:20px;margin:20px 0'>";
 
         for (int i = 0; i < 3; i++) {
-            OutputConfig_t* output = output_manager_get_output(i);
+            OutputSnapshot output(i);
             if (!output) continue;
 
             int id = i + 1;
-            String cardClass = "simple-card";
-            if (output->faultState != FAULT_NONE) cardClass += " fault";
-            else if (output->heating) cardClass += " heating";
-            if (!output->enabled) cardClass += " disabled";
-
-            html += "<div id='card" + String(id) + "' class='" + cardClass + "'>";
+            html += "<div id='card";
+            html.print(id);
+            html += "' class='simple-card";
+            if (output->faultState != FAULT_NONE) html += " fault";
+            else if (output->heating) html += " heating";
+            if (!output->enabled) html += " disabled";
+            html += "'>";
 
             // Header with name, status indicator, and fault chip
-            html += "<h3><span><span id='status" + String(id) + "' class='status-indicator " + String(output->heating ? "on" : "off") + "'></span>";
-            html += String(output->name);
+            html += "<h3><span><span id='status";
+            html.print(id);
+            html += "' class='status-indicator ";
+            html.print(output->heating ? "on" : "off");
+            html += "'></span>";
+            html.print(output->name);
 
             // Fault chip - shows fault state
-            String faultChipClass = "fault-chip";
-            String faultText = "";
+            const char* faultChipClass = "fault-chip ok";
+            const char* faultText = "";
             if (output->faultState != FAULT_NONE) {
-                faultChipClass += " fault";
+                faultChipClass = "fault-chip fault";
                 faultText = output_manager_get_fault_name(output->faultState);
             } else if (output->sensorHealth != SENSOR_OK) {
-                faultChipClass += " stale";
+                faultChipClass = "fault-chip stale";
                 faultText = output_manager_get_sensor_health_name(output->sensorHealth);
-            } else {
-                faultChipClass += " ok";
             }
-            html += "<span id='faultChip" + String(id) + "' class='" + faultChipClass + "'>" + faultText + "</span>";
+            html += "<span id='faultChip";
+            html.print(id);
+            html += "' class='";
+            html += faultChipClass;
+            html += "'>";
+            html += faultText;
+            html += "</span>";
 
             html += "</span>";
-            html += "<span style='font-size:12px;color:#999'>Output " + String(id) + "</span></h3>";
+            html += "<span style='font-size:12px;color:#999'>Output ";
+            html.print(id);
+            html += "</span></h3>";
 
             // Current temperature (large)
-            html += "<div class='temp-display'><span id='currTemp" + String(id) + "'>";
+            html += "<div class='temp-display'><span id='currTemp";
+            html.print(id);
+            html += "'>";
             if (output->enabled && output->currentTemp > -100) {
-                html += String(output->currentTemp, 1);
+                html.print(output->currentTemp, 1);
             } else {
                 html += "--.-";
             }
@@ -854,36 +1343,86 @@ static void handleRoot(void) {
             // Target temperature slider
             html += "<div class='target-row'>";
             html += "<label>Target:</label>";
-            html += "<input type='range' min='15' max='35' step='0.5' value='" + String(output->targetTemp, 1) + "' ";
-            html += "oninput='document.getElementById(\"targetVal" + String(id) + "\").innerText=parseFloat(this.value).toFixed(1)+\"°C\"' ";
-            html += "onchange='setTarget(" + String(id) + ",this.value)'>";
-            html += "<span id='targetVal" + String(id) + "' class='target-val'>" + String(output->targetTemp, 1) + "°C</span>";
+            html += "<input type='range' min='15' max='35' step='0.5' value='";
+            html.print(output->targetTemp, 1);
+            html += "' ";
+            html += "oninput='document.getElementById(\"targetVal";
+            html.print(id);
+            html += "\").innerText=parseFloat(this.value).toFixed(1)+\"°C\"' ";
+            html += "onchange='setTarget(";
+            html.print(id);
+            html += ",this.value)'>";
+            html += "<span id='targetVal";
+            html.print(id);
+            html += "' class='target-val'>";
+            html.print(output->targetTemp, 1);
+            html += "°C</span>";
             html += "</div>";
 
             // Mode dropdown
             html += "<div class='mode-row'>";
             html += "<label>Mode:</label>";
-            html += "<select onchange='setMode(" + String(id) + ",this.value)'>";
-            html += "<option value='off'" + String(output->controlMode == CONTROL_MODE_OFF ? " selected" : "") + ">Off</option>";
-            html += "<option value='manual'" + String(output->controlMode == CONTROL_MODE_MANUAL ? " selected" : "") + ">Manual</option>";
-            html += "<option value='pid'" + String(output->controlMode == CONTROL_MODE_PID ? " selected" : "") + ">PID (Auto)</option>";
-            html += "<option value='onoff'" + String(output->controlMode == CONTROL_MODE_ONOFF ? " selected" : "") + ">On/Off</option>";
-            html += "<option value='timeprop'" + String(output->controlMode == CONTROL_MODE_TIME_PROP ? " selected" : "") + ">Time-Prop</option>";
+            html += "<select onchange='setMode(";
+            html.print(id);
+            html += ",this.value)'>";
+            html += "<option value='off'";
+            html.print(output->controlMode == CONTROL_MODE_OFF ? " selected" : "");
+            html += ">Off</option>";
+            html += "<option value='manual'";
+            html.print(output->controlMode == CONTROL_MODE_MANUAL ? " selected" : "");
+            html += ">Manual</option>";
+            html += "<option value='pid'";
+            html.print(output->controlMode == CONTROL_MODE_PID ? " selected" : "");
+            html += ">PID (Auto)</option>";
+            html += "<option value='onoff'";
+            html.print(output->controlMode == CONTROL_MODE_ONOFF ? " selected" : "");
+            html += ">On/Off</option>";
+            html += "<option value='timeprop'";
+            html.print(output->controlMode == CONTROL_MODE_TIME_PROP ? " selected" : "");
+            html += ">Time-Prop</option>";
+            html += "<option value='cascade'";
+            html.print(output->controlMode == CONTROL_MODE_CASCADE ? " selected" : "");
+            html += ">Cascade</option>";
+            html += "<option value='humidity'";
+            html.print(output->controlMode == CONTROL_MODE_HUMIDITY ? " selected" : "");
+            html += ">Humidity</option>";
             html += "</select>";
             html += "</div>";
 
             // Manual power slider (hidden unless manual mode)
-            html += "<div id='powerRow" + String(id) + "' class='power-row" + String(output->controlMode == CONTROL_MODE_MANUAL ? " show" : "") + "'>";
+            html += "<div id='powerRow";
+            html.print(id);
+            html += "' class='power-row";
+            html.print(output->controlMode == CONTROL_MODE_MANUAL ? " show" : "");
+            html += "'>";
             html += "<label>Power:</label>";
-            html += "<input type='range' id='powerSlider" + String(id) + "' min='0' max='100' value='" + String(output->manualPower) + "' ";
-            html += "oninput='document.getElementById(\"powerVal" + String(id) + "\").innerText=this.value+\"%\"' ";
-            html += "onchange='setPower(" + String(id) + ",this.value)'>";
-            html += "<span id='powerVal" + String(id) + "' class='power-val'>" + String(output->manualPower) + "%</span>";
+            html += "<input type='range' id='powerSlider";
+            html.print(id);
+            html += "' min='0' max='100' value='";
+            html.print(output->manualPower);
+            html += "' ";
+            html += "oninput='document.getElementById(\"powerVal";
+            html.print(id);
+            html += "\").innerText=this.value+\"%\"' ";
+            html += "onchange='setPower(";
+            html.print(id);
+            html += ",this.value)'>";
+            html += "<span id='powerVal";
+            html.print(id);
+            html += "' class='power-val'>";
+            html.print(output->manualPower);
+            html += "%</span>";
             html += "</div>";
 
             // Clear fault button (shown only when in fault)
-            String clearBtnStyle = output->faultState != FAULT_NONE ? "block" : "none";
-            html += "<button id='clearFault" + String(id) + "' class='clear-fault-btn' style='display:" + clearBtnStyle + "' onclick='clearFault(" + String(id) + ")'>Clear Fault</button>";
+            const char* clearBtnStyle = output->faultState != FAULT_NONE ? "block" : "none";
+            html += "<button id='clearFault";
+            html.print(id);
+            html += "' class='clear-fault-btn' style='display:";
+            html += clearBtnStyle;
+            html += "' onclick='clearFault(";
+            html.print(id);
+            html += ")'>Clear Fault</button>";
 
             html += "</div>";
         }
@@ -911,31 +1450,71 @@ static void handleRoot(void) {
 
         // Generate cards for all 3 outputs
         for (int i = 0; i < 3; i++) {
-            OutputConfig_t* output = output_manager_get_output(i);
+            OutputSnapshot output(i);
             if (!output) continue;
 
             int id = i + 1;
-            String bgColor = output->heating ? "#ffebee" : "#e8f5e9";
-
-            html += "<div id='output" + String(id) + "' style='background:" + bgColor + ";padding:15px;border-radius:8px;";
-            html += "box-shadow:0 2px 5px rgba(0,0,0,0.1);opacity:" + String(output->enabled ? "1" : "0.5") + "'>";
-            html += "<h3 style='margin:0 0 10px 0'>" + String(output->name) + " (Output " + String(id) + ")</h3>";
+            const char* bgColor = output->heating ? "#ffebee" : "#e8f5e9";
+
+            html += "<div id='output";
+            html.print(id);
+            html += "' style='background:";
+            html += bgColor;
+            html += ";padding:15px;border-radius:8px;";
+            html += "box-shadow:0 2px 5px rgba(0,0,0,0.1);opacity:";
+            html.print(output->enabled ? "1" : "0.5");
+            html += "'>";
+            html += "<h3 style='margin:0 0 10px 0'>";
+            html.print(output->name);
+            html += " (Output ";
+            html.print(id);
+            html += ")</h3>";
 
             // Status info
-            html += "<div style='margin:8px 0'><strong>Current:</strong> <span id='temp" + String(id) + "'>" + String(output->currentTemp, 1) + "°C</span></div>";
-            html += "<div style='margin:8px 0'><strong>Target:</strong> <span id='target" + String(id) + "'>" + String(output->targetTemp, 1) + "°C</span></div>";
-            html += "<div style='margin:8px 0'><strong>Status:</strong> <span id='heating" + String(id) + "'>" + String(output->heating ? "ON" : "OFF") + "</span></div>";
-            html += "<div style='margin:8px 0'><strong>Mode:</strong> <span id='mode" + String(id) + "'>" + String(output_manager_get_mode_name(output->controlMode)) + "</span></div>";
+            html += "<div style='margin:8px 0'><strong>Current:</strong> <span id='temp";
+            html.print(id);
+            html += "'>";
+            html.print(output->currentTemp, 1);
+            html += "°C</span></div>";
+            html += "<div style='margin:8px 0'><strong>Target:</strong> <span id='target";
+            html.print(id);
+            html += "'>";
+            html.print(output->targetTemp, 1);
+            html += "°C</span></div>";
+            html += "<div style='margin:8px 0'><strong>Status:</strong> <span id='heating";
+            html.print(id);
+            html += "'>";
+            html.print(output->heating ? "ON" : "OFF");
+            html += "</span></div>";
+            html += "<div style='margin:8px 0'><strong>Mode:</strong> <span id='mode";
+            html.print(id);
+            html += "'>";
+            html.print(output_manager_get_mode_name(output->controlMode));
+            html += "</span></div>";
 
             // Power bar
-            html += "<div style='margin:10px 0'><strong>Power: <span id='power-val" + String(id) + "'>" + String(output->currentPower) + "%</span></strong>";
+            html += "<div style='margin:10px 0'><strong>Power: <span id='power-val";
+            html.print(id);
+            html += "'>";
+            html.print(output->currentPower);
+            html += "%</span></strong>";
             html += "<div style='width:100%;height:20px;background:#ddd;border-radius:5px;overflow:hidden;margin-top:5px'>";
-            html += "<div id='power-fill" + String(id) + "' style='height:100%;background:linear-gradient(90deg,#4CAF50,#ff9800);transition:width 0.3s;width:" + String(output->currentPower) + "%'></div></div></div>";
+            html += "<div id='power-fill";
+            html.print(id);
+            html += "' style='height:100%;background:linear-gradient(90deg,#4CAF50,#ff9800);transition:width 0.3s;width:";
+            html.print(output->currentPower);
+            html += "%'></div></div></div>";
 
             // Quick controls
-            html += "<button onclick=\"fetch('/api/output/" + String(id) + "/control',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({mode:'off'})}).then(()=>updateOutputs())\" style='margin:5px 2px;padding:8px 12px;font-size:12px'>Off</button>";
-            html += "<button onclick=\"fetch('/api/output/" + String(id) + "/control',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({mode:'manual',power:50})}).then(()=>updateOutputs())\" style='margin:5px 2px;padding:8px 12px;font-size:12px'>Manual 50%</button>";
-            html += "<button onclick=\"fetch('/api/output/" + String(id) + "/control',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({mode:'pid'})}).then(()=>updateOutputs())\" style='margin:5px 2px;padding:8px 12px;font-size:12px'>PID</button>";
+            html += "<button onclick=\"fetch('/api/output/";
+            html.print(id);
+            html += "/control',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({mode:'off'})}).then(()=>updateOutputs())\" style='margin:5px 2px;padding:8px 12px;font-size:12px'>Off</button>";
+            html += "<button onclick=\"fetch('/api/output/";
+            html.print(id);
+            html += "/control',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({mode:'manual',power:50})}).then(()=>updateOutputs())\" style='margin:5px 2px;padding:8px 12px;font-size:12px'>Manual 50%</button>";
+            html += "<button onclick=\"fetch('/api/output/";
+            html.print(id);
+            html += "/control',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({mode:'pid'})}).then(()=>updateOutputs())\" style='margin:5px 2px;padding:8px 12px;font-size:12px'>PID</button>";
 
             html += "</div>";
         }
@@ -947,8 +1526,8 @@ static void handleRoot(void) {
         html += "Visit <a href='/sensors'>Sensors</a> to manage sensors</p>";
     }
 
-    html += webserver_get_html_footer(millis() / 1000);
-    server.send(200, "text/html", html);
+    webserver_write_html_footer(html, time_service_uptime_sec());
+    html.finish();
 }
 
 /**
@@ -963,9 +1542,7 @@ static void handleStatus(void) {
     doc["power"] = powerOutput;
     doc["secureMode"] = secureMode;
 
-    String output;
-    serializeJson(doc, output);
-    server.send(200, "application/json", output);
+    sendJson(200, doc);
 }
 
 /**
@@ -987,7 +1564,7 @@ static void handleInfo_API(void) {
     doc["ap_mode"] = networkAPMode;
 
     // System info
-    unsigned long uptimeSeconds = millis() / 1000;
+    unsigned long uptimeSeconds = time_service_uptime_sec();
     doc["uptime_seconds"] = uptimeSeconds;
     doc["uptime_days"] = uptimeSeconds / 86400;
     doc["uptime_hours"] = (uptimeSeconds % 86400) / 3600;
@@ -1000,56 +1577,112 @@ static void handleInfo_API(void) {
     // For now, just indicate if we have network
     doc["mqtt_configured"] = networkConnected && !networkAPMode;
 
-    String output;
-    serializeJson(doc, output);
-    server.send(200, "application/json", output);
+    sendJson(200, doc);
 }
 
 /**
- * Handle /api/logs
+ * Handle /api/logs?since=SEQ - entries from a sequence number on, oldest first
  */
 static void handleLogs_API(void) {
-    DynamicJsonDocument doc(2048);
-    JsonArray logs = doc.createNestedArray("logs");
-
-    int logCount = logger_get_count();
-    for (int i = 0; i < logCount; i++) {
-        const char* logEntry = logger_get_entry(i);
-        if (logEntry != nullptr) {
-            logs.add(logEntry);
-        }
+    uint32_t since;
+    bool hasSince = parseSinceArg(logger_get_next_seq(), &since);
+    uint32_t first = logger_get_first_seq();
+
+    PageStream out("application/json");
+    out += "{\"logs\":[";
+    LogRecord_t record;
+    uint32_t cursor = since;
+    int count = 0;
+    while (logger_read(cursor, &record)) {
+        char head[32];
+        snprintf(head, sizeof(head), "%s{\"seq\":%lu,\"message\":", count ? "," : "", (unsigned long)record.seq);
+        out += head;
+        writeJsonString(out, record.message);
+        out += '}';
+        cursor = record.seq + 1;
+        count++;
     }
 
-    doc["count"] = logCount;
-
-    String output;
-    serializeJson(doc, output);
-    server.send(200, "application/json", output);
+    char tail[96];
+    snprintf(tail, sizeof(tail), "],\"count\":%d,\"first\":%lu,\"next\":%lu,\"gap\":%s}",
+             count, (unsigned long)first, (unsigned long)(count ? cursor : logger_get_next_seq()),
+             hasSince && (int32_t)(since - first) < 0 ? "true" : "false");
+    out += tail;
+    out.finish();
 }
 
 /**
  * Handle /api/history
  */
 static void handleHistory(void) {
-    DynamicJsonDocument doc(8192);  // Large buffer for history data
-    JsonArray data = doc.createNestedArray("data");
+    // Written straight to the client: a full 288-point document needs ~14KB,
+    // which used to overflow the 8KB DynamicJsonDocument
+    PageStream out("application/json");
+    char item[64];
 
+    out += "{\"data\":[";
     int count = temp_history_get_count();
+    bool first = true;
     for (int i = 0; i < count; i++) {
         const TempHistoryPoint_t* point = temp_history_get_point(i);
         if (point != nullptr) {
-            JsonObject reading = data.createNestedObject();
-            reading["timestamp"] = point->timestamp;
-            reading["temperature"] = round(point->temperature * 10) / 10.0;
+            snprintf(item, sizeof(item), "%s{\"timestamp\":%lu,\"temperature\":%.1f}",
+                     first ? "" : ",", (unsigned long)point->timestamp, point->temperature);
+            out += item;
+            first = false;
         }
     }
 
-    doc["count"] = count;
-    doc["interval"] = HISTORY_SAMPLE_INTERVAL / 1000;  // Convert to seconds
+    snprintf(item, sizeof(item), "],\"count\":%d,\"interval\":%d}",
+             count, (int)(HISTORY_SAMPLE_INTERVAL / 1000));
+    out += item;
+    out.finish();
+}
+
+/**
+ * GET /api/v1/history/bulk?since=SEQ&max=N - History points from seq on, binary
+ * Format in history_bulk.h. Points older than the buffer are gone: the
+ * response then starts at the oldest one (firstSeq > since).
+ */
+static void handleHistoryBulk(void) {
+    uint32_t since = server.hasArg("since") ? strtoul(server.arg("since").c_str(), nullptr, 10) : 0;
+    int max = server.hasArg("max") ? server.arg("max").toInt() : HISTORY_BUFFER_SIZE;
+    if (max <= 0 || max > HISTORY_BUFFER_SIZE) {
+        max = HISTORY_BUFFER_SIZE;
+    }
 
-    String output;
-    serializeJson(doc, output);
-    server.send(200, "application/json", output);
+    // Snapshot the range: the control task records (and, once the ring is
+    // full, drops the oldest point) while this response is being written
+    TempHistoryPoint_t* points = (TempHistoryPoint_t*)scratch_pool_malloc(max * sizeof(TempHistoryPoint_t));
+    if (!points) {
+        server.send(503, "application/json", "{\"error\":\"Out of memory\"}");
+        return;
+    }
+    uint32_t start, next;
+    int count = temp_history_copy_since(since, max, points, &start, &next);
+
+    HistoryBulkHeader_t header;
+    header.flags = next - start > (uint32_t)count ? HISTORY_BULK_MORE : 0;
+    header.bootId = temp_history_get_boot_id();
+    header.firstSeq = start;
+    header.nextSeq = next;
+    header.baseTime = count > 0 ? (uint32_t)points[0].timestamp : 0;
+    header.count = count;
+    header.intervalSec = HISTORY_SAMPLE_INTERVAL / 1000;
+
+    PageStream out("application/octet-stream");
+    uint8_t buf[HISTORY_BULK_HEADER_SIZE];
+    history_bulk_encode_header(&header, buf);
+    out.write(buf, sizeof(buf));
+
+    uint32_t prevTime = header.baseTime;
+    for (int i = 0; i < count; i++) {
+        uint8_t item[HISTORY_BULK_POINT_MAX];
+        size_t len = history_bulk_encode_point(&prevTime, (uint32_t)points[i].timestamp, points[i].temperature, item);
+        out.write(item, len);
+    }
+    scratch_pool_free(points);
+    out.finish();
 }
 
 /**
@@ -1089,9 +1722,7 @@ static void handleControl(void) {
         StaticJsonDocument<128> errorDoc;
         errorDoc["success"] = false;
         errorDoc["error"] = "No JSON body provided";
-        String output;
-        serializeJson(errorDoc, output);
-        server.send(400, "application/json", output);
+        sendJson(400, errorDoc);
         return;
     }
 
@@ -1102,9 +1733,7 @@ static void handleControl(void) {
         StaticJsonDocument<128> errorDoc;
         errorDoc["success"] = false;
         errorDoc["error"] = "Invalid JSON";
-        String output;
-        serializeJson(errorDoc, output);
-        server.send(400, "application/json", output);
+        sendJson(400, errorDoc);
         return;
     }
 
@@ -1138,16 +1767,15 @@ static void handleControl(void) {
     responseDoc["target"] = newTarget;
     responseDoc["mode"] = newMode;
 
-    String output;
-    serializeJson(responseDoc, output);
-    server.send(200, "application/json", output);
+    sendJson(200, responseDoc);
 }
 
 /**
  * Handle info page
  */
 static void handleInfo(void) {
-    String html = webserver_get_html_header("Device Info", "info");
+    PageStream html;
+    webserver_write_html_header(html, "Device Info", "info");
     
     if (networkAPMode) {
         html += "<div class='warning-box'><strong>⚠️ AP Mode Active</strong><br>";
@@ -1156,33 +1784,49 @@ static void handleInfo(void) {
     
     html += "<h2>Device Information</h2>";
     html += "<div class='stat-grid'>";
-    html += "<div class='stat-card'><div class='stat-value'>" + String(deviceName) + "</div><div class='stat-label'>Device Name</div></div>";
-    html += "<div class='stat-card'><div class='stat-value'>" + String(firmwareVersion) + "</div><div class='stat-label'>Firmware</div></div>";
+    html += "<div class='stat-card'><div class='stat-value'>";
+    html.print(deviceName);
+    html += "</div><div class='stat-label'>Device Name</div></div>";
+    html += "<div class='stat-card'><div class='stat-value'>";
+    html.print(firmwareVersion);
+    html += "</div><div class='stat-label'>Firmware</div></div>";
     
-    unsigned long uptime = millis() / 1000;
+    unsigned long uptime = time_service_uptime_sec();
     unsigned long days = uptime / 86400;
     unsigned long hours = (uptime % 86400) / 3600;
     unsigned long minutes = (uptime % 3600) / 60;
-    String uptimeStr = "";
-    if (days > 0) uptimeStr += String(days) + "d ";
-    uptimeStr += String(hours) + "h " + String(minutes) + "m";
     
-    html += "<div class='stat-card'><div class='stat-value'>" + uptimeStr + "</div><div class='stat-label'>Uptime</div></div>";
-    html += "<div class='stat-card'><div class='stat-value'>" + String(ESP.getFreeHeap() / 1024) + " KB</div><div class='stat-label'>Free Memory</div></div>";
+    html += "<div class='stat-card'><div class='stat-value'>";
+    if (days > 0) html.printf("%lud ", days);
+    html.printf("%luh %lum", hours, minutes);
+    html += "</div><div class='stat-label'>Uptime</div></div>";
+    html += "<div class='stat-card'><div class='stat-value'>";
+    html.print(ESP.getFreeHeap() / 1024);
+    html += " KB</div><div class='stat-label'>Free Memory</div></div>";
     html += "</div>";
     
     html += "<h2>Network Status</h2>";
     html += "<div class='info-box'>";
     if (networkConnected) {
         html += "<strong>WiFi:</strong> Connected ✓<br>";
-        html += "<strong>SSID:</strong> " + String(networkSSID) + "<br>";
-        html += "<strong>IP Address:</strong> " + String(networkIP) + "<br>";
-        html += "<strong>Signal Strength:</strong> " + String(WiFi.RSSI()) + " dBm<br>";
-        html += "<strong>MAC Address:</strong> " + WiFi.macAddress();
+        html += "<strong>SSID:</strong> ";
+        html.print(networkSSID);
+        html += "<br>";
+        html += "<strong>IP Address:</strong> ";
+        html.print(networkIP);
+        html += "<br>";
+        html += "<strong>Signal Strength:</strong> ";
+        html.print(WiFi.RSSI());
+        html += " dBm<br>";
+        html += "<strong>MAC Address:</strong> ";
+        html += WiFi.macAddress();
     } else if (networkAPMode) {
         html += "<strong>Mode:</strong> Access Point<br>";
-        html += "<strong>SSID:</strong> " + String(networkSSID) + "<br>";
-        html += "<strong>IP Address:</strong> " + String(networkIP);
+        html += "<strong>SSID:</strong> ";
+        html.print(networkSSID);
+        html += "<br>";
+        html += "<strong>IP Address:</strong> ";
+        html.print(networkIP);
     } else {
         html += "<strong>WiFi:</strong> Not Connected ✗";
     }
@@ -1190,35 +1834,46 @@ static void handleInfo(void) {
     
     html += "<h2>Sensor Information</h2>";
     html += "<div class='stat-grid'>";
-    html += "<div class='stat-card'><div class='stat-value'>" + String(currentTemp, 1) + "°C</div><div class='stat-label'>Current Temp</div></div>";
-    html += "<div class='stat-card'><div class='stat-value'>" + String(targetTemp, 1) + "°C</div><div class='stat-label'>Target Temp</div></div>";
-    html += "<div class='stat-card'><div class='stat-value'>" + String(powerOutput) + "%</div><div class='stat-label'>Power Output</div></div>";
-    html += "<div class='stat-card'><div class='stat-value'>" + String(currentMode) + "</div><div class='stat-label'>Mode</div></div>";
+    html += "<div class='stat-card'><div class='stat-value'>";
+    html.print(currentTemp, 1);
+    html += "°C</div><div class='stat-label'>Current Temp</div></div>";
+    html += "<div class='stat-card'><div class='stat-value'>";
+    html.print(targetTemp, 1);
+    html += "°C</div><div class='stat-label'>Target Temp</div></div>";
+    html += "<div class='stat-card'><div class='stat-value'>";
+    html.print(powerOutput);
+    html += "%</div><div class='stat-label'>Power Output</div></div>";
+    html += "<div class='stat-card'><div class='stat-value'>";
+    html.print(currentMode);
+    html += "</div><div class='stat-label'>Mode</div></div>";
     html += "</div>";
     
-    html += webserver_get_html_footer(millis() / 1000);
-    server.send(200, "text/html", html);
+    webserver_write_html_footer(html, time_service_uptime_sec());
+    html.finish();
 }
 
 /**
  * Handle logs page
  */
 static void handleLogs(void) {
-    String html = webserver_get_html_header("System Logs", "logs");
+    PageStream html;
+    webserver_write_html_header(html, "System Logs", "logs");
     
     html += "<h2>Recent Events</h2>";
-    html += "<div class='info-box'>Showing last " + String(MAX_LOGS) + " log entries (newest first)</div>";
+    html += "<div class='info-box'>Showing last ";
+    html.print(logger_get_count());
+    html += " log entries (newest first)</div>";
     
-    html += "<div style='background:#f9f9f9;border-radius:5px;padding:10px;max-height:500px;overflow-y:auto'>";
+    // Entries are read oldest first; column-reverse shows the newest on top
+    html += "<div style='background:#f9f9f9;border-radius:5px;padding:10px;max-height:500px;overflow-y:auto;display:flex;flex-direction:column-reverse'>";
     
     bool hasLogs = false;
-    int logCount = logger_get_count();
-    for (int i = 0; i < logCount; i++) {
-        const char* logEntry = logger_get_entry(i);
-        if (logEntry != nullptr) {
-            html += "<div class='log-entry'>" + String(logEntry) + "</div>";
-            hasLogs = true;
-        }
+    LogRecord_t record;
+    for (uint32_t seq = 0; logger_read(seq, &record); seq = record.seq + 1) {
+        html += "<div class='log-entry'>";
+        html += record.message;
+        html += "</div>";
+        hasLogs = true;
     }
     
     if (!hasLogs) {
@@ -1228,15 +1883,38 @@ static void handleLogs(void) {
     html += "</div>";
     html += "<div style='margin-top:20px'><button onclick='location.reload()' class='btn-secondary'>Refresh Logs</button></div>";
     
-    html += webserver_get_html_footer(millis() / 1000);
-    server.send(200, "text/html", html);
+    webserver_write_html_footer(html, time_service_uptime_sec());
+    html.finish();
+}
+
+/**
+ * Handle fleet page
+ */
+static void handleFleetPage(void) {
+    PageStream html;
+    webserver_write_html_header(html, "Fleet", "fleet");
+
+    html += "<h2>Units on this Network</h2>";
+    if (!fleet_is_enabled()) {
+        html += "<div class='info-box'>Fleet mode is off. Enable it under <a href='/settings'>Settings</a> on each unit that should appear here.</div>";
+    } else {
+        html += "<div class='info-box'>Status frames from " FLEET_GROUP ", refreshed every 5s. Units silent for 30s are dropped.</div>";
+    }
+    html += "<div id='fleet'>Loading...</div>";
+    html += "<script>";
+    html += FLEET_DASHBOARD_JS;
+    html += "</script>";
+
+    webserver_write_html_footer(html, time_service_uptime_sec());
+    html.finish();
 }
 
 /**
  * Handle console page
  */
 static void handleConsole(void) {
-    String html = webserver_get_html_header("Live Console", "console");
+    PageStream html;
+    webserver_write_html_header(html, "Live Console", "console");
 
     html += "<h2>System Console</h2>";
     html += "<div class='info-box'>Real-time system events, MQTT activity, and debug messages</div>";
@@ -1244,87 +1922,134 @@ static void handleConsole(void) {
     html += "<div style='margin-bottom:15px'>";
     html += "<button onclick='refreshConsole()' class='btn-secondary' style='margin-right:10px'>Refresh</button>";
     html += "<button onclick='clearConsole()' class='btn-secondary' style='margin-right:10px'>Clear</button>";
+    if (profiler_is_enabled()) {
+        html += "<button onclick='logPerf()' class='btn-secondary' style='margin-right:10px'>Loop Timing</button>";
+    }
     html += "<label style='margin-left:20px'><input type='checkbox' id='autoRefresh' checked> Auto-refresh (2s)</label>";
     html += "</div>";
+    html += "<div style='margin-bottom:15px'>";
+    for (int t = CONSOLE_EVENT_SYSTEM; t <= CONSOLE_EVENT_DEBUG; t++) {
+        const char* name = console_get_type_name((ConsoleEventType_t)t);
+        html += "<label style='margin-right:12px'><input type='checkbox' class='ctype' value='";
+        html += name;
+        html += "' checked> ";
+        html += name;
+        html += "</label>";
+    }
+    html += "</div>";
 
     html += "<div id='console-output' style='background:#1e1e1e;color:#d4d4d4;font-family:\"Courier New\",monospace;font-size:13px;padding:15px;border-radius:5px;height:600px;overflow-y:auto;'>";
     html += "<div style='color:#888'>Loading console...</div>";
     html += "</div>";
 
     html += "<script>";
-    html += "let autoRefreshTimer=null;";
+    html += "let autoRefreshTimer=null,lastSeq=null;";
+    html += "const COLORS={ERROR:'#f48771',MQTT:'#4ec9b0',WIFI:'#dcdcaa',SYSTEM:'#569cd6',TEMP:'#ce9178',PID:'#c586c0'};";
+    html += "function types(){return [...document.querySelectorAll('.ctype:checked')].map(c=>c.value).join(',');}";
+    html += "function line(color,text){const div=document.createElement('div');div.style.marginBottom='2px';div.style.color=color;div.textContent=text;return div;}";
+    html += "function resetConsole(){lastSeq=null;document.getElementById('console-output').innerHTML='';refreshConsole();}";
     html += "function refreshConsole(){";
-    html += "fetch('/api/console').then(r=>r.json()).then(data=>{";
-    html += "const out=document.getElementById('console-output');out.innerHTML='';";
-    html += "if(data.events&&data.events.length>0){";
+    html += "let url='/api/console?types='+types();if(lastSeq!==null)url+='&since='+lastSeq;";
+    html += "fetch(url).then(r=>r.json()).then(data=>{";
+    html += "const out=document.getElementById('console-output');";
+    html += "if(lastSeq===null)out.innerHTML='';";
+    html += "const atBottom=out.scrollTop+out.clientHeight>=out.scrollHeight-20;";
+    html += "if(data.gap)out.appendChild(line('#888','... events missed (more than the device keeps arrived between polls)'));";
     html += "data.events.forEach(evt=>{";
-    html += "const div=document.createElement('div');div.style.marginBottom='2px';";
-    html += "let color='#d4d4d4';";
-    html += "if(evt.type==='ERROR')color='#f48771';";
-    html += "else if(evt.type==='MQTT')color='#4ec9b0';";
-    html += "else if(evt.type==='WIFI')color='#dcdcaa';";
-    html += "else if(evt.type==='SYSTEM')color='#569cd6';";
-    html += "else if(evt.type==='TEMP')color='#ce9178';";
-    html += "else if(evt.type==='PID')color='#c586c0';";
-    html += "div.innerHTML='<span style=\"color:'+color+'\">['+evt.type+']</span> '+evt.message;";
-    html += "out.appendChild(div);";
-    html += "});";
-    html += "out.scrollTop=out.scrollHeight;";
-    html += "}else{out.innerHTML='<div style=\"color:#888\">No console events yet...</div>';}";
+    html += "const div=line('#d4d4d4','');";
+    html += "const tag=document.createElement('span');tag.style.color=COLORS[evt.type]||'#d4d4d4';tag.textContent='['+evt.type+'] ';";
+    html += "div.appendChild(tag);div.appendChild(document.createTextNode(evt.message));out.appendChild(div);});";
+    html += "while(out.childNodes.length>500)out.removeChild(out.firstChild);";
+    html += "if(lastSeq===null&&!data.events.length)out.appendChild(line('#888','No console events yet...'));";
+    html += "lastSeq=data.next;";
+    html += "if(atBottom||data.events.length)out.scrollTop=out.scrollHeight;";
     html += "}).catch(err=>console.error('Error:',err));}";
     html += "function clearConsole(){";
     html += "if(confirm('Clear all console events?')){";
-    html += "fetch('/api/console-clear',{method:'POST'}).then(()=>refreshConsole());";
+    html += "fetch('/api/console-clear',{method:'POST'}).then(()=>resetConsole());";
     html += "}}";
+    html += "function logPerf(){";
+    html += "fetch('/api/v1/perf/log',{method:'POST'}).then(()=>refreshConsole());}";
     html += "function toggleAutoRefresh(){";
     html += "if(document.getElementById('autoRefresh').checked){";
     html += "autoRefreshTimer=setInterval(refreshConsole,2000);";
     html += "}else{if(autoRefreshTimer)clearInterval(autoRefreshTimer);}}";
     html += "document.getElementById('autoRefresh').addEventListener('change',toggleAutoRefresh);";
+    html += "document.querySelectorAll('.ctype').forEach(c=>c.addEventListener('change',resetConsole));";
     html += "refreshConsole();toggleAutoRefresh();";
     html += "</script>";
 
-    html += webserver_get_html_footer(millis() / 1000);
-    server.send(200, "text/html", html);
+    webserver_write_html_footer(html, time_service_uptime_sec());
+    html.finish();
 }
 
 /**
- * Handle console events API
+ * Handle /api/console?since=SEQ&types=MQTT,ERROR&max=N
+ * Events from a sequence number on, oldest first, streamed one copy at a
+ * time. "next" is the since= for the following poll; "gap" means events
+ * after the client's cursor were overwritten before it asked.
  */
 static void handleConsoleEvents(void) {
-    DynamicJsonDocument doc(4096);
-    JsonArray events = doc.createNestedArray("events");
-
-    int count = console_get_count();
-    for (int i = 0; i < count; i++) {
-        const char* event = console_get_event(i);
-        ConsoleEventType_t type = console_get_event_type(i);
-
-        if (event != nullptr) {
-            JsonObject evt = events.createNestedObject();
-            evt["message"] = event;
-            evt["type"] = console_get_type_name(type);
+    uint32_t since;
+    bool hasSince = parseSinceArg(console_get_next_seq(), &since);
+    uint32_t first = console_get_first_seq();
+
+    uint32_t mask = CONSOLE_TYPES_ALL;
+    if (server.hasArg("types") && server.arg("types").length() > 0) {
+        mask = 0;
+        char list[96];
+        strncpy(list, server.arg("types").c_str(), sizeof(list) - 1);
+        list[sizeof(list) - 1] = '\0';
+        char* save = nullptr;
+        for (char* name = strtok_r(list, ",", &save); name; name = strtok_r(nullptr, ",", &save)) {
+            ConsoleEventType_t type;
+            if (console_parse_type(name, &type)) {
+                mask |= CONSOLE_TYPE_MASK(type);
+            }
         }
     }
+    int max = server.hasArg("max") ? server.arg("max").toInt() : CONSOLE_MAX_EVENTS;
+    if (max <= 0 || max > CONSOLE_MAX_EVENTS) {
+        max = CONSOLE_MAX_EVENTS;
+    }
 
-    doc["count"] = count;
+    PageStream out("application/json");
+    out += "{\"events\":[";
+    ConsoleRecord_t record;
+    uint32_t cursor = since;
+    int count = 0;
+    while (count < max && console_read(&cursor, mask, &record)) {
+        char head[64];
+        snprintf(head, sizeof(head), "%s{\"seq\":%lu,\"type\":\"%s\",\"message\":", count ? "," : "",
+                 (unsigned long)record.seq, console_get_type_name(record.type));
+        out += head;
+        writeJsonString(out, record.message);
+        out += '}';
+        count++;
+    }
 
-    String output;
-    serializeJson(doc, output);
-    server.send(200, "application/json", output);
+    char tail[96];
+    snprintf(tail, sizeof(tail), "],\"count\":%d,\"first\":%lu,\"next\":%lu,\"gap\":%s}",
+             count, (unsigned long)first, (unsigned long)cursor,
+             hasSince && (int32_t)(since - first) < 0 ? "true" : "false");
+    out += tail;
+    out.finish();
 }
 
 /**
  * Handle history page
  */
 static void handleHistoryPage(void) {
-    String html = webserver_get_html_header("Temperature History", "history");
+    PageStream html;
+    webserver_write_html_header(html, "Temperature History", "history");
 
     html += "<h2>Temperature History</h2>";
 
     int count = temp_history_get_count();
     html += "<div class='info-box'>";
-    html += "Recording every 5 minutes. Currently storing " + String(count) + " readings";
+    html += "Recording every 5 minutes. Currently storing ";
+    html.print(count);
+    html += " readings";
     if (count >= HISTORY_BUFFER_SIZE) {
         html += " (last 24 hours)";
     }
@@ -1364,8 +2089,8 @@ static void handleHistoryPage(void) {
     html += "}).catch(e=>console.error('Error loading history:',e));";
     html += "</script>";
 
-    html += webserver_get_html_footer(millis() / 1000);
-    server.send(200, "text/html", html);
+    webserver_write_html_footer(html, time_service_uptime_sec());
+    html.finish();
 }
 
 /**
@@ -1375,7 +2100,9 @@ static void handleSettings(void) {
     // Protected route
     if (!isAuthenticated()) { requireAuth(); return; }
 
-    String html = webserver_get_html_header("Settings", "settings");
+    PageStream html;
+
+    webserver_write_html_header(html, "Settings", "settings");
 
     // Load settings from preferences
     Preferences prefs;
@@ -1386,6 +2113,8 @@ static void handleSettings(void) {
     float kp = prefs.getFloat("Kp", 10.0);
     float ki = prefs.getFloat("Ki", 0.5);
     float kd = prefs.getFloat("Kd", 5.0);
+    bool fleetEnabled = prefs.getBool("fleet_en", false);
+    bool mqttCompact = prefs.getBool("mqtt_compact", false);
     prefs.end();
     
     if (networkAPMode) {
@@ -1393,13 +2122,37 @@ static void handleSettings(void) {
         html += "Connect to WiFi to access all settings</div>";
     } else {
         html += "<div class='info-box'><strong>Status:</strong> Connected to WiFi ✓<br>";
-        html += "<strong>IP:</strong> " + String(networkIP) + "</div>";
+        html += "<strong>IP:</strong> ";
+        html.print(networkIP);
+        html += "</div>";
     }
     
     html += "<form action='/api/save-settings' method='POST'>";
     html += "<h2>Device Settings</h2>";
     html += "<div class='control'><label>Device Name:</label>";
-    html += "<input type='text' name='device_name' value='" + String(deviceName) + "' maxlength='15'></div>";
+    html += "<input type='text' name='device_name' value='";
+    html.print(deviceName);
+    html += "' maxlength='15'></div>";
+    html += "<div class='control'><label>Timezone (POSIX TZ):</label>";
+    html += "<input type='text' name='tz' list='tzlist' maxlength='";
+    html.print(TIME_TZ_MAX_LEN);
+    html += "' value='";
+    html.print(time_service_get_timezone());
+    html += "'>";
+    html += "<datalist id='tzlist'><option value='UTC0'><option value='GMT0BST,M3.5.0/1,M10.5.0'>"
+            "<option value='CET-1CEST,M3.5.0,M10.5.0/3'><option value='EST5EDT,M3.2.0,M11.1.0'>"
+            "<option value='CST6CDT,M3.2.0,M11.1.0'><option value='MST7MDT,M3.2.0,M11.1.0'>"
+            "<option value='PST8PDT,M3.2.0,M11.1.0'><option value='AEST-10AEDT,M10.1.0,M4.1.0/3'></datalist></div>";
+    struct tm localNow;
+    if (time_service_get_local(&localNow)) {
+        char nowStr[40];
+        strftime(nowStr, sizeof(nowStr), "%Y-%m-%d %H:%M %Z", &localNow);
+        html += "<p style='color:#666;font-size:14px'>Local time now: ";
+        html.print(nowStr);
+        html += ". Schedules and energy buckets use local time.</p>";
+    } else {
+        html += "<p style='color:#666;font-size:14px'>Clock not set yet (waiting for NTP). Schedules and energy buckets use local time.</p>";
+    }
 
     html += "<h2>Security</h2>";
     if (secureMode) {
@@ -1418,34 +2171,58 @@ static void handleSettings(void) {
     html += "'></div>";
     html += "<p style='color:#666;font-size:14px'>Leave PIN blank to keep current PIN. When enabled, Settings, Outputs config, and control actions require login.</p>";
 
+    html += "<h2>Fleet</h2>";
+    html += "<div class='control'><label><input type='checkbox' name='fleet_enabled' value='1'";
+    if (fleetEnabled) html += " checked";
+    html += "> Share status with other units on this network</label></div>";
+    html += "<p style='color:#666;font-size:14px'>Multicasts a 54-byte status frame every 5s to " FLEET_GROUP " and lists the other units on the <a href='/fleet'>Fleet</a> page. Takes effect after restart.</p>";
+
     html += "<h2>WiFi Configuration</h2>";
     html += "<div class='control'><label>WiFi SSID:</label>";
-    html += "<input type='text' name='wifi_ssid' value='" + savedSSID + "' required></div>";
+    html += "<input type='text' name='wifi_ssid' value='";
+    html += savedSSID;
+    html += "' required></div>";
     html += "<div class='control'><label>WiFi Password:</label>";
     html += "<input type='password' name='wifi_pass' placeholder='Enter new password or leave blank'></div>";
     
     html += "<h2>MQTT Configuration</h2>";
     html += "<div class='control'><label>MQTT Broker IP:</label>";
-    html += "<input type='text' name='mqtt_broker' value='" + savedMQTTBroker + "' required></div>";
+    html += "<input type='text' name='mqtt_broker' value='";
+    html += savedMQTTBroker;
+    html += "' required></div>";
     html += "<div class='control'><label>MQTT Port:</label>";
     html += "<input type='number' name='mqtt_port' value='1883' required></div>";
     html += "<div class='control'><label>MQTT Username:</label>";
-    html += "<input type='text' name='mqtt_user' value='" + savedMQTTUser + "'></div>";
+    html += "<input type='text' name='mqtt_user' value='";
+    html += savedMQTTUser;
+    html += "'></div>";
     html += "<div class='control'><label>MQTT Password:</label>";
     html += "<input type='password' name='mqtt_pass' placeholder='Enter new password or leave blank'></div>";
+    html += "<div class='control'><label><input type='checkbox' name='mqtt_compact' value='1'";
+    if (mqttCompact) html += " checked";
+    html += "> Compact telemetry (metered uplinks)</label></div>";
+    html += "<p style='color:#666;font-size:14px'>Publishes one 56-byte binary frame to &lt;base&gt;/telemetry instead of the per-output topics, and skips Home Assistant discovery. Decode with tools/telemetry_decode.</p>";
     
     html += "<h2>PID Tuning</h2>";
     html += "<div class='control'><label>Kp (Proportional):</label>";
-    html += "<input type='number' name='kp' value='" + String(kp, 2) + "' step='0.1' min='0'></div>";
+    html += "<input type='number' name='kp' value='";
+    html.print(kp, 2);
+    html += "' step='0.1' min='0'></div>";
     html += "<div class='control'><label>Ki (Integral):</label>";
-    html += "<input type='number' name='ki' value='" + String(ki, 2) + "' step='0.01' min='0'></div>";
+    html += "<input type='number' name='ki' value='";
+    html.print(ki, 2);
+    html += "' step='0.01' min='0'></div>";
     html += "<div class='control'><label>Kd (Derivative):</label>";
-    html += "<input type='number' name='kd' value='" + String(kd, 2) + "' step='0.1' min='0'></div>";
+    html += "<input type='number' name='kd' value='";
+    html.print(kd, 2);
+    html += "' step='0.1' min='0'></div>";
     
     html += "<button type='submit'>Save All Settings</button></form>";
     
     html += "<h2>Firmware</h2>";
-    html += "<div class='info-box'><strong>Current Version:</strong> " + String(firmwareVersion) + "</div>";
+    html += "<div class='info-box'><strong>Current Version:</strong> ";
+    html.print(firmwareVersion);
+    html += "</div>";
     html += "<div id='update-status'></div>";
     html += "<button type='button' class='btn-secondary' onclick='checkUpdates()' id='check-btn'>Check for Updates</button>";
     html += "<a href='/update'><button type='button' class='btn-secondary'>Manual Upload</button></a>";
@@ -1484,15 +2261,16 @@ static void handleSettings(void) {
     html += "<form action='/api/restart' method='POST'>";
     html += "<button type='submit' class='btn-danger' onclick='return confirm(\"Restart device?\")'>Restart Device</button></form>";
     
-    html += webserver_get_html_footer(millis() / 1000);
-    server.send(200, "text/html", html);
+    webserver_write_html_footer(html, time_service_uptime_sec());
+    html.finish();
 }
 
 /**
  * Handle schedule page
  */
 static void handleSchedule(void) {
-    String html = webserver_get_html_header("Schedule", "schedule");
+    PageStream html;
+    webserver_write_html_header(html, "Schedule", "schedule");
 
     html += "<div style='margin:20px 0;display:flex;justify-content:space-between;align-items:center'>";
     html += "<h2 style='margin:0'>Temperature Schedule</h2>";
@@ -1504,9 +2282,15 @@ static void handleSchedule(void) {
     html += "<strong>Select Output:</strong>";
     html += "<select id='output-selector' onchange='loadSchedule()' style='padding:8px;font-size:16px;border-radius:5px'>";
     for (int i = 0; i < 3; i++) {
-        OutputConfig_t* output = output_manager_get_output(i);
+        OutputSnapshot output(i);
         if (output) {
-            html += "<option value='" + String(i) + "'>" + String(output->name) + " (Output " + String(i + 1) + ")</option>";
+            html += "<option value='";
+            html.print(i);
+            html += "'>";
+            html.print(output->name);
+            html += " (Output ";
+            html.print(i + 1);
+            html += ")</option>";
         }
     }
     html += "</select>";
@@ -1515,6 +2299,10 @@ static void handleSchedule(void) {
     html += "<div id='next-schedule-info' style='margin-top:15px;padding:12px;background:#e3f2fd;border-radius:5px;border-left:4px solid #2196F3;display:none'>";
     html += "<strong>⏰ Next Scheduled Change:</strong> <span id='next-schedule-text'></span>";
     html += "</div>";
+    html += "<label style='display:flex;align-items:center;gap:8px;margin-top:15px'>";
+    html += "<input type='checkbox' id='predictive' style='width:auto'>";
+    html += "<span><strong>Preheat</strong> - start warming early so each slot's temperature is reached at its start time</span></label>";
+    html += "<p id='predictive-info' style='margin:5px 0 0 0;color:#666;font-size:14px'></p>";
     html += "</div>";
 
     // Schedule slots container (will be filled by JavaScript)
@@ -1529,6 +2317,7 @@ static void handleSchedule(void) {
     html += "<li>Enable/disable individual slots as needed</li>";
     html += "<li>Select active days for each slot (any combination)</li>";
     html += "<li>Schedule mode must be selected in Outputs page for this to activate</li>";
+    html += "<li>Preheat needs about an hour of heater history before it starts working</li>";
     html += "<li>Empty days = slot disabled</li>";
     html += "</ul>";
     html += "</div>";
@@ -1544,6 +2333,11 @@ static void handleSchedule(void) {
     html += "fetch('/api/output/'+(currentOutputId+1)).then(r=>r.json()).then(d=>{";
     html += "currentSchedule=d.schedule||[];";
     html += "document.getElementById('current-output-info').innerHTML='Currently viewing schedule for <strong>'+d.name+'</strong>';";
+    html += "let p=d.predictive;document.getElementById('predictive').checked=p.enabled;";
+    html += "document.getElementById('predictive-info').innerText=p.valid?";
+    html += "'Learned: heats '+p.heatCPerMin+'°C/min at full power, cools with a '+p.timeConstantMin+' min time constant'+";
+    html += "(p.rampActive?' - preheating now (target '+d.target+'°C)':''):";
+    html += "'Still learning this enclosure ('+p.samples+' samples) - schedule runs without preheat until then';";
     html += "renderSlots();";
     html += "updateNextSchedule();";
     html += "});}";
@@ -1626,15 +2420,15 @@ static void handleSchedule(void) {
     html += "schedule.push({enabled:enabled&&days.length>0,hour:hour,minute:minute,targetTemp:targetTemp,days:days});}";
     html += "fetch('/api/output/'+(currentOutputId+1)+'/config',{";
     html += "method:'POST',headers:{'Content-Type':'application/json'},";
-    html += "body:JSON.stringify({schedule:schedule})})";
+    html += "body:JSON.stringify({schedule:schedule,predictive:{enabled:document.getElementById('predictive').checked}})})";
     html += ".then(r=>r.ok?alert('Schedule saved!'):alert('Error saving schedule'));}";
 
     // Initialize on page load
     html += "loadSchedule();";
     html += "</script>";
 
-    html += webserver_get_html_footer(millis() / 1000);
-    server.send(200, "text/html", html);
+    webserver_write_html_footer(html, time_service_uptime_sec());
+    html.finish();
 }
 
 /**
@@ -1651,6 +2445,15 @@ static void handleSaveSettings(void) {
     if (server.hasArg("device_name")) {
         prefs.putString("device_name", server.arg("device_name"));
     }
+
+    // Invalid TZ strings are ignored (newlib would silently fall back to UTC)
+    if (server.hasArg("tz")) {
+        if (time_service_is_valid_timezone(server.arg("tz").c_str())) {
+            prefs.putString("tz", server.arg("tz"));
+        } else {
+            console_add_event_f(CONSOLE_EVENT_SYSTEM, "Settings: invalid timezone '%s' ignored", server.arg("tz").c_str());
+        }
+    }
     
     if (server.hasArg("wifi_ssid")) {
         prefs.putString("wifi_ssid", server.arg("wifi_ssid"));
@@ -1673,6 +2476,7 @@ static void handleSaveSettings(void) {
     if (server.hasArg("mqtt_pass") && server.arg("mqtt_pass").length() > 0) {
         prefs.putString("mqtt_pass", server.arg("mqtt_pass"));
     }
+    prefs.putBool("mqtt_compact", server.hasArg("mqtt_compact"));
     
     // Save PID settings
     if (server.hasArg("kp")) {
@@ -1701,14 +2505,19 @@ static void handleSaveSettings(void) {
 
     Serial.printf("[WebServer] Secure mode: %s\n", secureMode ? "ON" : "OFF");
 
+    // Fleet status multicast (read at boot)
+    prefs.putBool("fleet_en", server.hasArg("fleet_enabled"));
+
     prefs.end();
     
-    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'>";
+    PageStream html;
+    
+    html += "<!DOCTYPE html><html><head><meta charset='UTF-8'>";
     html += "<meta http-equiv='refresh' content='5;url=/'>";
     html += "<title>Settings Saved</title></head><body style='text-align:center;padding-top:50px'>";
     html += "<h1>Settings Saved!</h1><p>Device will restart in 5 seconds...</p></body></html>";
     
-    server.send(200, "text/html", html);
+    html.finish();
     
     if (restartCallback != NULL) {
         delay(5000);
@@ -1726,12 +2535,14 @@ static void handleRestart(void) {
     // Protected route
     if (!isAuthenticated()) { requireAuth(); return; }
 
-    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'>";
+    PageStream html;
+
+    html += "<!DOCTYPE html><html><head><meta charset='UTF-8'>";
     html += "<meta http-equiv='refresh' content='10;url=/'>";
     html += "<title>Restarting</title></head><body style='text-align:center;padding-top:50px'>";
     html += "<h1>Restarting...</h1><p>Page will reload in 10 seconds.</p></body></html>";
     
-    server.send(200, "text/html", html);
+    html.finish();
     
     if (restartCallback != NULL) {
         delay(1000);
@@ -1746,22 +2557,40 @@ static void handleUpdate(void) {
     // Protected route
     if (!isAuthenticated()) { requireAuth(); return; }
 
-    String html = webserver_get_html_header("Firmware Update", "settings");
+    PageStream html;
+
+    webserver_write_html_header(html, "Firmware Update", "settings");
     
-    html += "<div class='info-box'><strong>Current Version:</strong> " + String(firmwareVersion) + "</div>";
+    html += "<div class='info-box'><strong>Current Version:</strong> ";
+    html.print(firmwareVersion);
+    html += " (";
+    html.print(ota_manager_get_running_partition());
+    html += ")</div>";
+    if (ota_manager_is_pending_verify()) {
+        html += "<div class='warning-box'><strong>Pending verification:</strong> this image is confirmed ";
+        html += "once the boot is stable, otherwise the previous firmware is restored.</div>";
+    }
+    if (ota_manager_was_rolled_back()) {
+        html += "<div class='warning-box'><strong>Rolled back:</strong> the last update failed to start ";
+        html += "and the previous firmware was restored.</div>";
+    }
     html += "<div class='warning-box'><strong>⚠️ Warning:</strong><br>";
     html += "• Do not power off during update<br>";
     html += "• Update takes 30-60 seconds</div>";
     
     html += "<h2>Upload Firmware</h2>";
-    html += "<form method='POST' action='/api/upload' enctype='multipart/form-data'>";
+    // The digest goes in the query string: multipart fields are only parsed after the file
+    html += "<form method='POST' action='/api/upload' enctype='multipart/form-data' ";
+    html += "onsubmit=\"var h=this.sha256.value.trim();this.action='/api/upload'+(h?'?sha256='+h:'');\">";
     html += "<input type='file' name='firmware' accept='.bin' required style='margin:20px 0'>";
+    html += "<label>SHA-256 (optional, from firmware.json)</label>";
+    html += "<input type='text' name='sha256' maxlength='64' placeholder='64 hex digits'>";
     html += "<button type='submit'>Upload Firmware</button></form>";
     
     html += "<a href='/settings'><button type='button' class='btn-secondary'>Back to Settings</button></a>";
     
-    html += webserver_get_html_footer(millis() / 1000);
-    server.send(200, "text/html", html);
+    webserver_write_html_footer(html, time_service_uptime_sec());
+    html.finish();
 }
 
 /**
@@ -1777,19 +2606,23 @@ static void handleUpload(void) {
     
     if (upload.status == UPLOAD_FILE_START) {
         Serial.printf("[WebServer] Update: %s\n", upload.filename.c_str());
-        if (!Update.begin(UPDATE_SIZE_UNKNOWN)) {
-            Update.printError(Serial);
+
+        // Optional digest (?sha256=...) - a malformed one fails the upload
+        uint8_t digest[OTA_SHA256_LEN];
+        bool hasDigest = server.hasArg("sha256") && server.arg("sha256").length() > 0;
+        if (hasDigest && !ota_manager_parse_sha256(server.arg("sha256").c_str(), digest)) {
+            Serial.println("[WebServer] Update: invalid sha256 argument");
+            return;
         }
+        ota_manager_begin(0, hasDigest ? digest : nullptr);
     } else if (upload.status == UPLOAD_FILE_WRITE) {
-        if (Update.write(upload.buf, upload.currentSize) != upload.currentSize) {
-            Update.printError(Serial);
-        }
+        ota_manager_write(upload.buf, upload.currentSize);
     } else if (upload.status == UPLOAD_FILE_END) {
-        if (Update.end(true)) {
-            Serial.printf("[WebServer] Update Success: %u bytes\n", upload.totalSize);
-        } else {
-            Update.printError(Serial);
+        if (ota_manager_end()) {
+            Serial.printf("[WebServer] Update Success: %u bytes\n", (unsigned)upload.totalSize);
         }
+    } else if (upload.status == UPLOAD_FILE_ABORTED) {
+        ota_manager_abort();
     }
 }
 
@@ -1800,22 +2633,37 @@ static void handleUploadDone(void) {
     // Protected route
     if (!isAuthenticated()) { requireAuth(); return; }
 
-    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'>";
+    PageStream html;
+
+    html += "<!DOCTYPE html><html><head><meta charset='UTF-8'>";
     html += "<meta http-equiv='refresh' content='15;url=/'>";
     html += "<title>Update Complete</title></head><body style='text-align:center;padding-top:50px'>";
     
-    if (Update.hasError()) {
+    bool ready = (ota_manager_get_state() == OTA_STATE_READY);
+    if (!ready) {
         html += "<h1 style='color:#f44336'>✗ Update Failed</h1>";
+        uint8_t digest[OTA_SHA256_LEN];
+        if (server.hasArg("sha256") && server.arg("sha256").length() > 0 &&
+            !ota_manager_parse_sha256(server.arg("sha256").c_str(), digest)) {
+            html += "<p>Invalid SHA-256 (expected 64 hex digits)</p>";
+        } else {
+            html += "<p>";
+            html.print(ota_manager_get_error_name(ota_manager_get_error()));
+            html += "</p>";
+        }
         html += "<p><a href='/update'>Try Again</a></p>";
     } else {
         html += "<h1>✓ Update Successful!</h1>";
+        if (ota_manager_image_unverified()) {
+            html += "<p>No SHA-256 was given, so the image was not checked against a digest.</p>";
+        }
         html += "<p>Device is restarting...</p>";
     }
     
     html += "</body></html>";
-    server.send(200, "text/html", html);
+    html.finish();
     
-    if (!Update.hasError() && restartCallback != NULL) {
+    if (ready && restartCallback != NULL) {
         delay(1000);
         restartCallback();
     }
@@ -1880,130 +2728,113 @@ static void handleAutoUpdate(void) {
     
     Serial.println("[WebServer] Starting GitHub auto-update");
     
-    HTTPClient http;
-    String url = "https://github.com/" + String(GITHUB_USER) + "/" + String(GITHUB_REPO) + "/releases/latest/download/" + String(GITHUB_FIRMWARE);
-    
-    http.begin(url);
-    int httpCode = http.GET();
-    
-    if (httpCode == 200 || httpCode == 302) {
-        if (httpCode == 302) {
-            String redirectUrl = http.getLocation();
-            http.end();
-            http.begin(redirectUrl);
-            httpCode = http.GET();
-        }
+    // Manifest + image download, hashed while writing; only activated if the digest matches
+    if (ota_manager_install_release()) {
+        Serial.println("[WebServer] Update successful");
+        server.send(200, "application/json", "{\"success\":true}");
         
-        if (httpCode == 200) {
-            int contentLength = http.getSize();
-            
-            if (contentLength > 0 && Update.begin(contentLength)) {
-                WiFiClient* stream = http.getStreamPtr();
-                size_t written = Update.writeStream(*stream);
-                
-                if (written == contentLength && Update.end()) {
-                    if (Update.isFinished()) {
-                        Serial.println("[WebServer] Update successful");
-                        server.send(200, "application/json", "{\"success\":true}");
-                        http.end();
-                        
-                        if (restartCallback != NULL) {
-                            delay(1000);
-                            restartCallback();
-                        }
-                        return;
-                    }
-                }
-            }
+        if (restartCallback != NULL) {
+            delay(1000);
+            restartCallback();
         }
+        return;
     }
     
-    http.end();
     Serial.println("[WebServer] Update failed");
-    server.send(500, "application/json", "{\"success\":false,\"error\":\"Download failed\"}");
+    StaticJsonDocument<128> doc;
+    doc["success"] = false;
+    doc["error"] = ota_manager_get_error_name(ota_manager_get_error());
+    sendJson(500, doc);
 }
 
 // ===== HTML GENERATION HELPERS =====
 
 /**
- * Get HTML header with navigation
+ * Write HTML header with navigation
  */
-String webserver_get_html_header(const char* title, const char* activePage) {
-    String html = "<!DOCTYPE html><html><head>";
-    html += "<meta charset='UTF-8'>";
-    html += "<meta name='viewport' content='width=device-width, initial-scale=1'>";
-    html += "<title>" + String(title) + " - " + String(deviceName) + "</title>";
-    html += buildCSS();
-    html += "</head><body";
+void webserver_write_html_header(Print& out, const char* title, const char* activePage) {
+    out.print("<!DOCTYPE html><html><head>");
+    out.print("<meta charset='UTF-8'>");
+    out.print("<meta name='viewport' content='width=device-width, initial-scale=1'>");
+    out.print("<title>");
+    out.print(title);
+    out.print(" - ");
+    out.print(deviceName);
+    out.print("</title>");
+    writeCSS(out);
+    out.print("</head><body");
 
     // Auto-apply dark mode from localStorage or system preference
-    html += " onload=\"if(localStorage.getItem('darkMode')==='true'||((!localStorage.getItem('darkMode'))&&window.matchMedia('(prefers-color-scheme:dark)').matches)){document.body.classList.add('dark-mode');}\"";
-
-    html += "><div class='container'>";
-    html += "<div class='header'>";
-    html += "<h1>" + String(deviceName) + "</h1>";
-    html += "<div class='subtitle'>ESP32 Reptile Thermostat v" + String(firmwareVersion) + "</div>";
-    html += "<div id='current-time' style='font-size:14px;margin-top:8px;opacity:0.95'></div>";
-    html += "<script>";
-    html += "function updateClock(){";
-    html += "let now=new Date();";
-    html += "let h=now.getHours().toString().padStart(2,'0');";
-    html += "let m=now.getMinutes().toString().padStart(2,'0');";
-    html += "let s=now.getSeconds().toString().padStart(2,'0');";
-    html += "let date=now.toLocaleDateString('en-GB',{weekday:'short',day:'numeric',month:'short',year:'numeric'});";
-    html += "document.getElementById('current-time').innerHTML='🕐 '+h+':'+m+':'+s+' | '+date;";
-    html += "}updateClock();setInterval(updateClock,1000);";
-    html += "</script>";
-    html += "</div>";
-    html += buildNavBar(activePage);
-
-    return html;
+    out.print(" onload=\"if(localStorage.getItem('darkMode')==='true'||((!localStorage.getItem('darkMode'))&&window.matchMedia('(prefers-color-scheme:dark)').matches)){document.body.classList.add('dark-mode');}\"");
+
+    out.print("><div class='container'>");
+    out.print("<div class='header'>");
+    out.print("<h1>");
+    out.print(deviceName);
+    out.print("</h1>");
+    out.print("<div class='subtitle'>ESP32 Reptile Thermostat v");
+    out.print(firmwareVersion);
+    out.print("</div>");
+    out.print("<div id='current-time' style='font-size:14px;margin-top:8px;opacity:0.95'></div>");
+    out.print("<script>");
+    out.print("function updateClock(){");
+    out.print("let now=new Date();");
+    out.print("let h=now.getHours().toString().padStart(2,'0');");
+    out.print("let m=now.getMinutes().toString().padStart(2,'0');");
+    out.print("let s=now.getSeconds().toString().padStart(2,'0');");
+    out.print("let date=now.toLocaleDateString('en-GB',{weekday:'short',day:'numeric',month:'short',year:'numeric'});");
+    out.print("document.getElementById('current-time').innerHTML='🕐 '+h+':'+m+':'+s+' | '+date;");
+    out.print("}updateClock();setInterval(updateClock,1000);");
+    out.print("</script>");
+    out.print("</div>");
+    writeNavBar(out, activePage);
 }
 
 /**
- * Get HTML footer
+ * Write HTML footer
  */
-String webserver_get_html_footer(unsigned long uptimeSeconds) {
+void webserver_write_html_footer(Print& out, unsigned long uptimeSeconds) {
     unsigned long days = uptimeSeconds / 86400;
     unsigned long hours = (uptimeSeconds % 86400) / 3600;
     unsigned long minutes = (uptimeSeconds % 3600) / 60;
-    
-    String html = "<div class='footer'>";
-    html += "ESP32 Reptile Thermostat v" + String(firmwareVersion);
-    html += " | Uptime: ";
-    if (days > 0) html += String(days) + "d ";
-    html += String(hours) + "h " + String(minutes) + "m";
-    html += "</div></div></body></html>";
-    
-    return html;
+
+    out.print("<div class='footer'>");
+    out.print("ESP32 Reptile Thermostat v");
+    out.print(firmwareVersion);
+    out.print(" | Uptime: ");
+    if (days > 0) out.printf("%lud ", days);
+    out.printf("%luh %lum", hours, minutes);
+    out.print("</div></div></body></html>");
 }
 
-/**
- * Build CSS stylesheet
- */
 // ===== MULTI-OUTPUT API HANDLERS =====
 
 /**
  * GET /api/outputs - Get all outputs status
  */
 static void handleOutputsAPI(void) {
-    StaticJsonDocument<1536> doc;
+    ScratchJsonDocument doc(2048);
     JsonArray outputs = doc.createNestedArray("outputs");
 
     for (int i = 0; i < 3; i++) {
-        OutputConfig_t* output = output_manager_get_output(i);
+        OutputSnapshot output(i);
         if (!output) continue;
 
         JsonObject obj = outputs.createNestedObject();
         obj["id"] = i + 1;
-        obj["name"] = output->name;
+        obj["name"] = snapshotStr(output->name);
         obj["enabled"] = output->enabled;
         obj["temp"] = serialized(String(output->currentTemp, 1));
+        if (sensor_manager_is_valid_humidity(output->currentHumidity)) {
+            obj["humidity"] = serialized(String(output->currentHumidity, 1));
+        } else {
+            obj["humidity"] = nullptr;
+        }
         obj["target"] = serialized(String(output->targetTemp, 1));
         obj["mode"] = output_manager_get_mode_name(output->controlMode);
         obj["power"] = output->currentPower;
         obj["heating"] = output->heating;
-        obj["sensor"] = output->sensorAddress;
+        obj["sensor"] = snapshotStr(output->sensorAddress);
         obj["deviceType"] = output_manager_get_device_type_name(output->deviceType);
         obj["hardwareType"] = output_manager_get_hardware_type_name(output->hardwareType);
 
@@ -2013,9 +2844,7 @@ static void handleOutputsAPI(void) {
         obj["inFault"] = (output->faultState != FAULT_NONE);
     }
 
-    String response;
-    serializeJson(doc, response);
-    server.send(200, "application/json", response);
+    sendJson(200, doc);
 }
 
 /**
@@ -2031,13 +2860,13 @@ static void handleOutputAPI(void) {
         return;
     }
 
-    OutputConfig_t* output = output_manager_get_output(outputIndex);
+    OutputSnapshot output(outputIndex);
     if (!output) {
         server.send(404, "text/plain", "Output not found");
         return;
     }
 
-    StaticJsonDocument<1024> doc;
+    ScratchJsonDocument doc(5120);
     doc["id"] = outputId;
     doc["name"] = output->name;
     doc["enabled"] = output->enabled;
@@ -2056,6 +2885,7 @@ static void handleOutputAPI(void) {
     pid["kp"] = serialized(String(output->pidKp, 2));
     pid["ki"] = serialized(String(output->pidKi, 2));
     pid["kd"] = serialized(String(output->pidKd, 2));
+    pid["setpointWeight"] = serialized(String(output->pidSetpointWeight, 2));
 
     // Time-proportional parameters
     JsonObject timeProp = doc.createNestedObject("timeProp");
@@ -2065,6 +2895,87 @@ static void handleOutputAPI(void) {
     timeProp["dutyCycle"] = serialized(String(output->timePropDutyCycle, 1));
     timeProp["cycleState"] = output->timePropCurrentState;
 
+    // Cascade parameters and loop state
+    doc["surfaceSensor"] = snapshotStr(output->surfaceSensorAddress);
+    doc["surfaceTemp"] = serialized(String(output->surfaceTemp, 1));
+    JsonObject cascade = doc.createNestedObject("cascade");
+    const PidLoopParams_t* loops[] = {&output->cascade.outer, &output->cascade.inner};
+    for (int l = 0; l < 2; l++) {
+        JsonObject loop = cascade.createNestedObject(l == 0 ? "outer" : "inner");
+        loop["kp"] = serialized(String(loops[l]->kp, 3));
+        loop["ki"] = serialized(String(loops[l]->ki, 4));
+        loop["kd"] = serialized(String(loops[l]->kd, 3));
+        loop["min"] = serialized(String(loops[l]->outMin, 1));
+        loop["max"] = serialized(String(loops[l]->outMax, 1));
+    }
+    cascade["surfaceMaxC"] = serialized(String(output->cascade.surfaceMaxC, 1));
+    cascade["outerPeriodSec"] = serialized(String(output->cascade.outerPeriodSec, 1));
+    cascade["innerPeriodSec"] = serialized(String(output->cascade.innerPeriodSec, 1));
+    cascade["surfaceSetpoint"] = serialized(String(output->cascadeState.surfaceSetpoint, 1));
+    cascade["atCeiling"] = output->cascadeState.atCeiling;
+
+    // Gain schedule, feedforward and the operating point last used
+    doc["ambientSensor"] = snapshotStr(output->ambientSensorAddress);
+    doc["ambientTemp"] = serialized(String(output->ambientTemp, 1));
+    const GainSchedule_t* gs = &output->gainSchedule;
+    JsonObject gainSchedule = doc.createNestedObject("gainSchedule");
+    gainSchedule["enabled"] = gs->enabled;
+    gainSchedule["ffGain"] = serialized(String(gs->ffGain, 2));
+    if (thermal_model_valid(&output->thermalModel)) {
+        // Steady state: heat * u = -loss * (T - ambient) -> % per °C
+        const ThermalModel_t* tm = &output->thermalModel;
+        gainSchedule["ffGainSuggested"] = serialized(String(-100.0f * tm->theta[1] / tm->theta[0], 2));
+    } else {
+        gainSchedule["ffGainSuggested"] = nullptr;
+    }
+    JsonArray points = gainSchedule.createNestedArray("points");
+    for (int j = 0; j < gs->count; j++) {
+        JsonObject point = points.createNestedObject();
+        point["load"] = serialized(String(gs->points[j].load, 1));
+        point["kp"] = serialized(String(gs->points[j].kp, 3));
+        point["ki"] = serialized(String(gs->points[j].ki, 4));
+        point["kd"] = serialized(String(gs->points[j].kd, 3));
+    }
+    JsonObject active = gainSchedule.createNestedObject("active");
+    if (isnan(output->pidState.load)) {
+        active["load"] = nullptr;
+    } else {
+        active["load"] = serialized(String(output->pidState.load, 1));
+    }
+    active["kp"] = serialized(String(output->pidState.activeKp, 3));
+    active["ki"] = serialized(String(output->pidState.activeKi, 4));
+    active["kd"] = serialized(String(output->pidState.activeKd, 3));
+    active["ff"] = serialized(String(output->pidState.feedforward, 1));
+
+    // Humidity parameters and controller state
+    const HumidityParams_t* hp = &output->humidity;
+    JsonObject humidity = doc.createNestedObject("humidity");
+    if (sensor_manager_is_valid_humidity(output->currentHumidity)) {
+        humidity["current"] = serialized(String(output->currentHumidity, 1));
+    } else {
+        humidity["current"] = nullptr;
+    }
+    humidity["target"] = serialized(String(hp->targetRh, 1));
+    humidity["method"] = hp->method == HUMIDITY_METHOD_TIME_PROP ? "timeprop" : "onoff";
+    humidity["hysteresis"] = serialized(String(hp->hysteresisRh, 1));
+    humidity["band"] = serialized(String(hp->bandRh, 1));
+    humidity["cycleSec"] = hp->cycleSec;
+    humidity["minOnSec"] = hp->minOnSec;
+    humidity["minOffSec"] = hp->minOffSec;
+    humidity["maxOnSec"] = hp->maxOnSec;
+    humidity["maxDutyPct"] = hp->maxDutyPct;
+    humidity["windowMin"] = hp->dutyWindowMin;
+    humidity["on"] = output->humidityState.on;
+    humidity["duty"] = serialized(String(output->humidityState.duty, 1));
+    humidity["budgetSec"] = (int)output->humidityState.budgetSec;
+    humidity["limited"] = output->humidityState.limited;
+
+    // Energy (buckets: GET /api/v1/energy)
+    JsonObject energy = doc.createNestedObject("energy");
+    energy["ratedWatts"] = output->ratedWatts;
+    energy["powerW"] = serialized(String(output->powerW, 1));
+    energy["totalKwh"] = serialized(String(output->energyKwh, 3));
+
     // Safety settings
     JsonObject safety = doc.createNestedObject("safety");
     safety["maxTempC"] = serialized(String(output->maxTempC, 1));
@@ -2084,6 +2995,21 @@ static void handleOutputAPI(void) {
         fault["durationSec"] = (millis() - output->faultStartTime) / 1000;
     }
 
+    // Predictive schedule and learned model
+    JsonObject predictive = doc.createNestedObject("predictive");
+    const ThermalModel_t* model = &output->thermalModel;
+    bool modelValid = thermal_model_valid(model);
+    predictive["enabled"] = output->schedulePredictive;
+    predictive["valid"] = modelValid;
+    predictive["samples"] = model->samples;
+    predictive["heatCPerMin"] = serialized(String(model->theta[0], 3));
+    predictive["timeConstantMin"] = model->theta[1] < 0.0f ? (int)(-1.0f / model->theta[1]) : 0;
+    if (modelValid) {
+        predictive["fullPowerTempC"] = serialized(String(thermal_model_equilibrium(model, 100.0f), 1));
+    }
+    predictive["rampActive"] = output->controlMode == CONTROL_MODE_SCHEDULE &&
+                               output->targetTemp > output->scheduleSlotTarget;
+
     // Schedule
     JsonArray schedule = doc.createNestedArray("schedule");
     for (int i = 0; i < MAX_SCHEDULE_SLOTS; i++) {
@@ -2095,9 +3021,7 @@ static void handleOutputAPI(void) {
         slot["days"] = output->schedule[i].days;
     }
 
-    String response;
-    serializeJson(doc, response);
-    server.send(200, "application/json", response);
+    sendJson(200, doc);
 }
 
 /**
@@ -2149,6 +3073,8 @@ static void handleOutputControl(void) {
         else if (strcmp(modeStr, "onoff") == 0) mode = CONTROL_MODE_ONOFF;
         else if (strcmp(modeStr, "timeprop") == 0) mode = CONTROL_MODE_TIME_PROP;
         else if (strcmp(modeStr, "schedule") == 0) mode = CONTROL_MODE_SCHEDULE;
+        else if (strcmp(modeStr, "cascade") == 0) mode = CONTROL_MODE_CASCADE;
+        else if (strcmp(modeStr, "humidity") == 0) mode = CONTROL_MODE_HUMIDITY;
 
         output_manager_set_mode(outputIndex, mode);
     }
@@ -2189,7 +3115,7 @@ static void handleOutputConfig(void) {
         return;
     }
 
-    StaticJsonDocument<1024> doc;
+    ScratchJsonDocument doc(3072);
     DeserializationError error = deserializeJson(doc, server.arg("plain"));
 
     if (error) {
@@ -2222,6 +3148,9 @@ static void handleOutputConfig(void) {
         float ki = pid["ki"];
         float kd = pid["kd"];
         output_manager_set_pid_params(outputIndex, kp, ki, kd);
+        if (pid.containsKey("setpointWeight")) {
+            output_manager_set_setpoint_weight(outputIndex, pid["setpointWeight"]);
+        }
     }
 
     // Update time-proportional parameters
@@ -2233,6 +3162,118 @@ static void handleOutputConfig(void) {
         output_manager_set_time_prop_params(outputIndex, cycleSec, minOnSec, minOffSec);
     }
 
+    // Update surface sensor (cascade inner loop)
+    if (doc.containsKey("surfaceSensor")) {
+        const char* surfaceSensor = doc["surfaceSensor"] | "";
+        output_manager_set_surface_sensor(outputIndex, surfaceSensor);
+    }
+
+    // Update cascade parameters (missing fields keep their current value)
+    if (doc.containsKey("cascade")) {
+        JsonObject cs = doc["cascade"];
+        CascadeParams_t params;
+        {
+            OutputSnapshot output(outputIndex);
+            params = output->cascade;
+        }
+        PidLoopParams_t* loops[] = {&params.outer, &params.inner};
+        for (int l = 0; l < 2; l++) {
+            JsonObject loop = cs[l == 0 ? "outer" : "inner"];
+            if (loop.isNull()) {
+                continue;
+            }
+            loops[l]->kp = loop["kp"] | loops[l]->kp;
+            loops[l]->ki = loop["ki"] | loops[l]->ki;
+            loops[l]->kd = loop["kd"] | loops[l]->kd;
+            loops[l]->outMin = loop["min"] | loops[l]->outMin;
+            loops[l]->outMax = loop["max"] | loops[l]->outMax;
+        }
+        params.surfaceMaxC = cs["surfaceMaxC"] | params.surfaceMaxC;
+        params.outerPeriodSec = cs["outerPeriodSec"] | params.outerPeriodSec;
+        params.innerPeriodSec = cs["innerPeriodSec"] | params.innerPeriodSec;
+        output_manager_set_cascade_params(outputIndex, &params);
+    }
+
+    // Update ambient sensor (gain schedule / feedforward)
+    if (doc.containsKey("ambientSensor")) {
+        const char* ambientSensor = doc["ambientSensor"] | "";
+        output_manager_set_ambient_sensor(outputIndex, ambientSensor);
+    }
+
+    // Update gain schedule (points, when present, replace the whole table)
+    if (doc.containsKey("gainSchedule")) {
+        JsonObject gsJson = doc["gainSchedule"];
+        GainSchedule_t schedule;
+        {
+            OutputSnapshot output(outputIndex);
+            schedule = output->gainSchedule;
+        }
+        schedule.enabled = gsJson["enabled"] | schedule.enabled;
+        schedule.ffGain = gsJson["ffGain"] | schedule.ffGain;
+        if (gsJson.containsKey("points")) {
+            JsonArray points = gsJson["points"];
+            schedule.count = 0;
+            for (JsonObject point : points) {
+                if (schedule.count >= GAIN_SCHEDULE_POINTS) {
+                    break;
+                }
+                GainPoint_t* p = &schedule.points[schedule.count++];
+                p->load = point["load"] | 0.0f;
+                p->kp = point["kp"] | 0.0f;
+                p->ki = point["ki"] | 0.0f;
+                p->kd = point["kd"] | 0.0f;
+            }
+        }
+        output_manager_set_gain_schedule(outputIndex, &schedule);
+    }
+
+    // Update humidity parameters (missing fields keep their current value)
+    if (doc.containsKey("humidity")) {
+        JsonObject rh = doc["humidity"];
+        HumidityParams_t params;
+        {
+            OutputSnapshot output(outputIndex);
+            params = output->humidity;
+        }
+        params.targetRh = rh["target"] | params.targetRh;
+        if (rh.containsKey("method")) {
+            const char* method = rh["method"] | "onoff";
+            params.method = strcmp(method, "timeprop") == 0 ? HUMIDITY_METHOD_TIME_PROP : HUMIDITY_METHOD_ONOFF;
+        }
+        params.hysteresisRh = rh["hysteresis"] | params.hysteresisRh;
+        params.bandRh = rh["band"] | params.bandRh;
+        params.cycleSec = rh["cycleSec"] | params.cycleSec;
+        params.minOnSec = rh["minOnSec"] | params.minOnSec;
+        params.minOffSec = rh["minOffSec"] | params.minOffSec;
+        params.maxOnSec = rh["maxOnSec"] | params.maxOnSec;
+        params.maxDutyPct = rh["maxDutyPct"] | params.maxDutyPct;
+        params.dutyWindowMin = rh["windowMin"] | params.dutyWindowMin;
+        output_manager_set_humidity_params(outputIndex, &params);
+    }
+
+    // Update energy rating / reset counters
+    if (doc.containsKey("energy")) {
+        JsonObject energy = doc["energy"];
+        if (energy.containsKey("ratedWatts")) {
+            int watts = energy["ratedWatts"] | 0;
+            output_manager_set_rated_watts(outputIndex, (uint16_t)constrain(watts, 0, 10000));
+        }
+        if (energy["reset"] | false) {
+            output_manager_reset_energy(outputIndex);
+        }
+    }
+
+    // Update predictive preheat
+    if (doc.containsKey("predictive")) {
+        JsonObject predictive = doc["predictive"];
+        if (predictive.containsKey("enabled")) {
+            output_manager_set_schedule_predictive(outputIndex, predictive["enabled"]);
+        }
+        if (predictive["reset"] | false) {
+            output_manager_reset_thermal_model(outputIndex);
+        }
+    }
+
     // Update schedule
     if (doc.containsKey("schedule")) {
         JsonArray schedule = doc["schedule"];
@@ -2256,7 +3297,7 @@ static void handleOutputConfig(void) {
  * GET /api/sensors - Get all sensors
  */
 static void handleSensorsAPI(void) {
-    StaticJsonDocument<1024> doc;
+    ScratchJsonDocument doc(1536);
     JsonArray sensors = doc.createNestedArray("sensors");
 
     int count = sensor_manager_get_count();
@@ -2268,14 +3309,18 @@ static void handleSensorsAPI(void) {
         obj["index"] = i;
         obj["address"] = sensor->addressString;
         obj["name"] = sensor->name;
+        obj["type"] = sensor_manager_get_type_name(sensor->type);
         obj["temp"] = serialized(String(sensor->lastReading, 1));
+        if (sensor_manager_is_valid_humidity(sensor->lastHumidity)) {
+            obj["humidity"] = serialized(String(sensor->lastHumidity, 1));
+        } else {
+            obj["humidity"] = nullptr;
+        }
         obj["lastRead"] = sensor->lastReadTime;
         obj["errors"] = sensor->errorCount;
     }
 
-    String response;
-    serializeJson(doc, response);
-    server.send(200, "application/json", response);
+    sendJson(200, doc);
 }
 
 /**
@@ -2329,166 +3374,180 @@ static void handleSensorName(void) {
 
 // ===== HTML GENERATION HELPERS =====
 
-static String buildCSS(void) {
-    String css = "<style>";
-    css += "*{box-sizing:border-box}";
-    css += "body{font-family:Arial,sans-serif;margin:0;padding:20px;background:#f0f0f0}";
-    css += ".container{max-width:800px;margin:0 auto;background:white;padding:20px;border-radius:10px;box-shadow:0 2px 10px rgba(0,0,0,0.1)}";
-    css += ".header{background:linear-gradient(135deg,#4CAF50,#45a049);color:white;padding:20px;border-radius:10px 10px 0 0;margin:-20px -20px 20px -20px;text-align:center}";
-    css += ".header h1{margin:0;font-size:24px}";
-    css += ".header .subtitle{margin:5px 0 0 0;font-size:12px;opacity:0.9}";
-    css += ".nav{display:flex;flex-wrap:wrap;justify-content:center;gap:10px;margin-bottom:20px}";
-    css += ".nav a{flex:1;min-width:100px;padding:12px 20px;background:#2196F3;color:white;text-decoration:none;border-radius:5px;text-align:center;transition:background 0.3s}";
-    css += ".nav a:hover{background:#0b7dda}";
-    css += ".nav a.active{background:#4CAF50}";
-    css += "h2{color:#666;border-bottom:2px solid #4CAF50;padding-bottom:5px;margin-top:30px}";
-    css += ".status{display:flex;justify-content:space-between;margin:20px 0;padding:15px;border-radius:5px}";
-    css += ".control{margin:20px 0}";
-    css += "label{display:block;margin:10px 0 5px;font-weight:bold}";
-    css += "input,select{width:100%;padding:10px;border:1px solid #ddd;border-radius:5px;box-sizing:border-box;font-size:16px}";
-    css += "button{width:100%;padding:12px;background:#4CAF50;color:white;border:none;border-radius:5px;cursor:pointer;font-size:16px;margin-top:10px;min-height:44px}";
-    css += "button:hover{background:#45a049}";
-    css += "button:active{background:#3d8b40}";
-    css += ".btn-secondary{background:#2196F3}";
-    css += ".btn-secondary:hover{background:#0b7dda}";
-    css += ".btn-danger{background:#f44336}";
-    css += ".btn-danger:hover{background:#da190b}";
-    css += ".info-box{background:#e3f2fd;padding:15px;border-radius:5px;margin:10px 0;border-left:4px solid #2196F3}";
-    css += ".warning-box{background:#fff3cd;padding:15px;border-radius:5px;margin:10px 0;border-left:4px solid #ffc107}";
-    css += ".stat-grid{display:grid;grid-template-columns:repeat(auto-fit,minmax(150px,1fr));gap:15px;margin:20px 0}";
-    css += ".stat-card{background:#f5f5f5;padding:15px;border-radius:5px;text-align:center}";
-    css += ".stat-value{font-size:24px;font-weight:bold;color:#4CAF50}";
-    css += ".stat-label{font-size:12px;color:#666;margin-top:5px}";
-    css += ".log-entry{padding:10px;border-bottom:1px solid #eee;font-family:monospace;font-size:14px}";
-    css += ".footer{text-align:center;margin-top:30px;padding-top:20px;border-top:1px solid #ddd;color:#666;font-size:12px}";
+static void writeCSS(Print& out) {
+    out.print("<style>");
+    out.print("*{box-sizing:border-box}");
+    out.print("body{font-family:Arial,sans-serif;margin:0;padding:20px;background:#f0f0f0}");
+    out.print(".container{max-width:800px;margin:0 auto;background:white;padding:20px;border-radius:10px;box-shadow:0 2px 10px rgba(0,0,0,0.1)}");
+    out.print(".header{background:linear-gradient(135deg,#4CAF50,#45a049);color:white;padding:20px;border-radius:10px 10px 0 0;margin:-20px -20px 20px -20px;text-align:center}");
+    out.print(".header h1{margin:0;font-size:24px}");
+    out.print(".header .subtitle{margin:5px 0 0 0;font-size:12px;opacity:0.9}");
+    out.print(".nav{display:flex;flex-wrap:wrap;justify-content:center;gap:10px;margin-bottom:20px}");
+    out.print(".nav a{flex:1;min-width:100px;padding:12px 20px;background:#2196F3;color:white;text-decoration:none;border-radius:5px;text-align:center;transition:background 0.3s}");
+    out.print(".nav a:hover{background:#0b7dda}");
+    out.print(".nav a.active{background:#4CAF50}");
+    out.print("h2{color:#666;border-bottom:2px solid #4CAF50;padding-bottom:5px;margin-top:30px}");
+    out.print(".status{display:flex;justify-content:space-between;margin:20px 0;padding:15px;border-radius:5px}");
+    out.print(".control{margin:20px 0}");
+    out.print("label{display:block;margin:10px 0 5px;font-weight:bold}");
+    out.print("input,select{width:100%;padding:10px;border:1px solid #ddd;border-radius:5px;box-sizing:border-box;font-size:16px}");
+    out.print("button{width:100%;padding:12px;background:#4CAF50;color:white;border:none;border-radius:5px;cursor:pointer;font-size:16px;margin-top:10px;min-height:44px}");
+    out.print("button:hover{background:#45a049}");
+    out.print("button:active{background:#3d8b40}");
+    out.print(".btn-secondary{background:#2196F3}");
+    out.print(".btn-secondary:hover{background:#0b7dda}");
+    out.print(".btn-danger{background:#f44336}");
+    out.print(".btn-danger:hover{background:#da190b}");
+    out.print(".info-box{background:#e3f2fd;padding:15px;border-radius:5px;margin:10px 0;border-left:4px solid #2196F3}");
+    out.print(".warning-box{background:#fff3cd;padding:15px;border-radius:5px;margin:10px 0;border-left:4px solid #ffc107}");
+    out.print(".stat-grid{display:grid;grid-template-columns:repeat(auto-fit,minmax(150px,1fr));gap:15px;margin:20px 0}");
+    out.print(".stat-card{background:#f5f5f5;padding:15px;border-radius:5px;text-align:center}");
+    out.print(".stat-value{font-size:24px;font-weight:bold;color:#4CAF50}");
+    out.print(".stat-label{font-size:12px;color:#666;margin-top:5px}");
+    out.print(".log-entry{padding:10px;border-bottom:1px solid #eee;font-family:monospace;font-size:14px}");
+    out.print(".footer{text-align:center;margin-top:30px;padding-top:20px;border-top:1px solid #ddd;color:#666;font-size:12px}");
 
     // Mobile responsive media queries
-    css += "@media(max-width:768px){";
-    css += "body{padding:10px;font-size:16px}";
-    css += ".container{padding:15px;border-radius:5px}";
-    css += ".header{padding:15px;margin:-15px -15px 15px -15px}";
-    css += ".header h1{font-size:20px}";
-    css += ".header .subtitle{font-size:11px}";
-    css += ".nav{gap:8px}";
-    css += ".nav a{min-width:80px;padding:10px 12px;font-size:14px}";
-    css += ".theme-toggle{min-width:44px;padding:10px}";
-    css += ".status{flex-direction:column;gap:10px}";
-    css += "h2{font-size:18px;margin-top:20px}";
-    css += "input,select,button{font-size:16px;min-height:44px;padding:12px}";
-    css += "button{padding:14px 20px}";
-    css += ".stat-grid{grid-template-columns:1fr}";
-    css += ".output-grid{grid-template-columns:1fr!important}";
-    css += ".log-entry{font-size:13px;padding:8px}";
-    css += "}";
+    out.print("@media(max-width:768px){");
+    out.print("body{padding:10px;font-size:16px}");
+    out.print(".container{padding:15px;border-radius:5px}");
+    out.print(".header{padding:15px;margin:-15px -15px 15px -15px}");
+    out.print(".header h1{font-size:20px}");
+    out.print(".header .subtitle{font-size:11px}");
+    out.print(".nav{gap:8px}");
+    out.print(".nav a{min-width:80px;padding:10px 12px;font-size:14px}");
+    out.print(".theme-toggle{min-width:44px;padding:10px}");
+    out.print(".status{flex-direction:column;gap:10px}");
+    out.print("h2{font-size:18px;margin-top:20px}");
+    out.print("input,select,button{font-size:16px;min-height:44px;padding:12px}");
+    out.print("button{padding:14px 20px}");
+    out.print(".stat-grid{grid-template-columns:1fr}");
+    out.print(".output-grid{grid-template-columns:1fr!important}");
+    out.print(".log-entry{font-size:13px;padding:8px}");
+    out.print("}");
 
     // Extra small screens (phones in portrait)
-    css += "@media(max-width:480px){";
-    css += "body{padding:8px}";
-    css += ".container{padding:12px}";
-    css += ".header{padding:12px;margin:-12px -12px 12px -12px}";
-    css += ".header h1{font-size:18px}";
-    css += ".nav{gap:6px}";
-    css += ".nav a{min-width:70px;padding:8px 10px;font-size:12px}";
-    css += ".theme-toggle{min-width:40px;padding:8px;font-size:16px}";
-    css += "h2{font-size:16px}";
-    css += ".stat-value{font-size:20px}";
-    css += ".stat-label{font-size:11px}";
-    css += "}";
+    out.print("@media(max-width:480px){");
+    out.print("body{padding:8px}");
+    out.print(".container{padding:12px}");
+    out.print(".header{padding:12px;margin:-12px -12px 12px -12px}");
+    out.print(".header h1{font-size:18px}");
+    out.print(".nav{gap:6px}");
+    out.print(".nav a{min-width:70px;padding:8px 10px;font-size:12px}");
+    out.print(".theme-toggle{min-width:40px;padding:8px;font-size:16px}");
+    out.print("h2{font-size:16px}");
+    out.print(".stat-value{font-size:20px}");
+    out.print(".stat-label{font-size:11px}");
+    out.print("}");
 
     // Tablet landscape optimizations
-    css += "@media(min-width:769px) and (max-width:1024px){";
-    css += ".output-grid{grid-template-columns:repeat(2,1fr)!important}";
-    css += "}";
+    out.print("@media(min-width:769px) and (max-width:1024px){");
+    out.print(".output-grid{grid-template-columns:repeat(2,1fr)!important}");
+    out.print("}");
 
     // Output card styling
-    css += "[id^='output']{position:relative}";
-    css += "[id^='output'] h3{color:#333}";
-    css += "[id^='output'] div{color:#333}";
-    css += "[id^='output'] strong{color:#333}";
+    out.print("[id^='output']{position:relative}");
+    out.print("[id^='output'] h3{color:#333}");
+    out.print("[id^='output'] div{color:#333}");
+    out.print("[id^='output'] strong{color:#333}");
 
     // Theme toggle button (must be before dark mode to avoid being overridden)
-    css += ".theme-toggle{flex:0;min-width:50px;padding:12px 20px;background:#2196F3;color:white;border:none;border-radius:5px;cursor:pointer;font-size:18px;text-align:center;text-decoration:none;transition:background 0.3s;line-height:normal;box-sizing:border-box}";
-    css += ".theme-toggle:hover{background:#0b7dda}";
+    out.print(".theme-toggle{flex:0;min-width:50px;padding:12px 20px;background:#2196F3;color:white;border:none;border-radius:5px;cursor:pointer;font-size:18px;text-align:center;text-decoration:none;transition:background 0.3s;line-height:normal;box-sizing:border-box}");
+    out.print(".theme-toggle:hover{background:#0b7dda}");
 
     // Mode toggle dropdown
-    css += ".mode-toggle{padding:10px 15px;background:#ff9800;color:white;border:none;border-radius:5px;cursor:pointer;font-size:14px;font-weight:bold}";
+    out.print(".mode-toggle{padding:10px 15px;background:#ff9800;color:white;border:none;border-radius:5px;cursor:pointer;font-size:14px;font-weight:bold}");
 
     // Dark mode overrides - improved contrast
-    css += "body.dark-mode{background:#121212;color:#f0f0f0}";
-    css += "body.dark-mode .container{background:#1e1e1e;box-shadow:0 2px 10px rgba(0,0,0,0.8)}";
-    css += "body.dark-mode .header{background:linear-gradient(135deg,#2d5f2e,#1e3d1f)}";
-    css += "body.dark-mode h2{color:#f0f0f0;border-bottom-color:#4d4d4d}";
-    css += "body.dark-mode h3{color:#f0f0f0}";
-    css += "body.dark-mode p{color:#d0d0d0}";
-    css += "body.dark-mode label{color:#f0f0f0}";
-    css += "body.dark-mode input,body.dark-mode select,body.dark-mode textarea{background:#2d2d2d;color:#f0f0f0;border:1px solid #4d4d4d}";
-    css += "body.dark-mode input::placeholder{color:#808080}";
-    css += "body.dark-mode button{background:#2d5f2e;color:#f0f0f0}";
-    css += "body.dark-mode button:hover{background:#3d7f3e}";
-    css += "body.dark-mode .btn-secondary{background:#1e4d7a}";
-    css += "body.dark-mode .btn-secondary:hover{background:#163c5f}";
-    css += "body.dark-mode .stat-card{background:#2d2d2d;border:1px solid #3d3d3d}";
-    css += "body.dark-mode .stat-value{color:#4CAF50}";
-    css += "body.dark-mode .stat-label{color:#d0d0d0}";
-    css += "body.dark-mode .log-entry{border-bottom-color:#3d3d3d;color:#d0d0d0}";
-    css += "body.dark-mode .footer{border-top-color:#3d3d3d;color:#d0d0d0}";
-    css += "body.dark-mode .info-box{background:#1a2a3a;color:#d0f0ff;border-left-color:#2196F3}";
-    css += "body.dark-mode .warning-box{background:#3a3020;color:#ffe0a0;border-left-color:#ffc107}";
-    css += "body.dark-mode .nav a{background:#1e4d7a;color:#f0f0f0}";
-    css += "body.dark-mode .nav a:hover{background:#2d6fa0}";
-    css += "body.dark-mode .nav a.active{background:#2d5f2e}";
-    css += "body.dark-mode .theme-toggle{background:#1e4d7a}";
-    css += "body.dark-mode .theme-toggle:hover{background:#2d6fa0}";
-    css += "body.dark-mode #next-schedule-info{background:#1a2a3a;color:#d0f0ff;border-left-color:#2196F3}";
-    css += "body.dark-mode #pid-tuning{background:#2d2d2d;color:#f0f0f0}";
-    css += "body.dark-mode #pid-tuning p{color:#d0d0d0}";
-    css += "*{transition:background-color 0.3s,color 0.3s,border-color 0.3s}";
-
-    css += "</style>";
-
-    return css;
-}
-
-/**
- * Build navigation bar
- */
-static String buildNavBar(const char* activePage) {
-    String nav = "<div class='nav'>";
+    out.print("body.dark-mode{background:#121212;color:#f0f0f0}");
+    out.print("body.dark-mode .container{background:#1e1e1e;box-shadow:0 2px 10px rgba(0,0,0,0.8)}");
+    out.print("body.dark-mode .header{background:linear-gradient(135deg,#2d5f2e,#1e3d1f)}");
+    out.print("body.dark-mode h2{color:#f0f0f0;border-bottom-color:#4d4d4d}");
+    out.print("body.dark-mode h3{color:#f0f0f0}");
+    out.print("body.dark-mode p{color:#d0d0d0}");
+    out.print("body.dark-mode label{color:#f0f0f0}");
+    out.print("body.dark-mode input,body.dark-mode select,body.dark-mode textarea{background:#2d2d2d;color:#f0f0f0;border:1px solid #4d4d4d}");
+    out.print("body.dark-mode input::placeholder{color:#808080}");
+    out.print("body.dark-mode button{background:#2d5f2e;color:#f0f0f0}");
+    out.print("body.dark-mode button:hover{background:#3d7f3e}");
+    out.print("body.dark-mode .btn-secondary{background:#1e4d7a}");
+    out.print("body.dark-mode .btn-secondary:hover{background:#163c5f}");
+    out.print("body.dark-mode .stat-card{background:#2d2d2d;border:1px solid #3d3d3d}");
+    out.print("body.dark-mode .stat-value{color:#4CAF50}");
+    out.print("body.dark-mode .stat-label{color:#d0d0d0}");
+    out.print("body.dark-mode .log-entry{border-bottom-color:#3d3d3d;color:#d0d0d0}");
+    out.print("body.dark-mode .footer{border-top-color:#3d3d3d;color:#d0d0d0}");
+    out.print("body.dark-mode .info-box{background:#1a2a3a;color:#d0f0ff;border-left-color:#2196F3}");
+    out.print("body.dark-mode .warning-box{background:#3a3020;color:#ffe0a0;border-left-color:#ffc107}");
+    out.print("body.dark-mode .nav a{background:#1e4d7a;color:#f0f0f0}");
+    out.print("body.dark-mode .nav a:hover{background:#2d6fa0}");
+    out.print("body.dark-mode .nav a.active{background:#2d5f2e}");
+    out.print("body.dark-mode .theme-toggle{background:#1e4d7a}");
+    out.print("body.dark-mode .theme-toggle:hover{background:#2d6fa0}");
+    out.print("body.dark-mode #next-schedule-info{background:#1a2a3a;color:#d0f0ff;border-left-color:#2196F3}");
+    out.print("body.dark-mode #pid-tuning{background:#2d2d2d;color:#f0f0f0}");
+    out.print("body.dark-mode #pid-tuning p{color:#d0d0d0}");
+    out.print("*{transition:background-color 0.3s,color 0.3s,border-color 0.3s}");
+
+    out.print("</style>");
+}
+
+/**
+ * Write one navigation link, marked active on its own page
+ */
+static void writeNavLink(Print& out, const char* href, const char* page, const char* label, const char* activePage) {
+    out.print("<a href='");
+    out.print(href);
+    out.print("' class='");
+    out.print(strcmp(activePage, page) == 0 ? "active" : "");
+    out.print("'>");
+    out.print(label);
+    out.print("</a>");
+}
+
+/**
+ * Write navigation bar
+ */
+static void writeNavBar(Print& out, const char* activePage) {
+    out.print("<div class='nav'>");
 
     // Home always visible
-    nav += "<a href='/' class='" + String(strcmp(activePage, "home") == 0 ? "active" : "") + "'>🏠 Home</a>";
+    writeNavLink(out, "/", "home", "🏠 Home", activePage);
 
     // Advanced mode pages
     if (advancedMode) {
-        nav += "<a href='/outputs' class='" + String(strcmp(activePage, "outputs") == 0 ? "active" : "") + "'>💡 Outputs</a>";
-        nav += "<a href='/sensors' class='" + String(strcmp(activePage, "sensors") == 0 ? "active" : "") + "'>🌡️ Sensors</a>";
-        nav += "<a href='/schedule' class='" + String(strcmp(activePage, "schedule") == 0 ? "active" : "") + "'>📅 Schedule</a>";
-        nav += "<a href='/history' class='" + String(strcmp(activePage, "history") == 0 ? "active" : "") + "'>📈 History</a>";
-        nav += "<a href='/info' class='" + String(strcmp(activePage, "info") == 0 ? "active" : "") + "'>ℹ️ Info</a>";
-        nav += "<a href='/logs' class='" + String(strcmp(activePage, "logs") == 0 ? "active" : "") + "'>📋 Logs</a>";
-        nav += "<a href='/console' class='" + String(strcmp(activePage, "console") == 0 ? "active" : "") + "'>🖥️ Console</a>";
+        writeNavLink(out, "/outputs", "outputs", "💡 Outputs", activePage);
+        writeNavLink(out, "/sensors", "sensors", "🌡️ Sensors", activePage);
+        writeNavLink(out, "/schedule", "schedule", "📅 Schedule", activePage);
+        writeNavLink(out, "/history", "history", "📈 History", activePage);
+        writeNavLink(out, "/info", "info", "ℹ️ Info", activePage);
+        writeNavLink(out, "/logs", "logs", "📋 Logs", activePage);
+        writeNavLink(out, "/console", "console", "🖥️ Console", activePage);
+        writeNavLink(out, "/fleet", "fleet", "📡 Fleet", activePage);
     }
 
     // Settings and Safety always visible
-    nav += "<a href='/settings' class='" + String(strcmp(activePage, "settings") == 0 ? "active" : "") + "'>⚙️ Settings</a>";
-    nav += "<a href='/safety' class='" + String(strcmp(activePage, "safety") == 0 ? "active" : "") + "'>🛡️ Safety</a>";
+    writeNavLink(out, "/settings", "settings", "⚙️ Settings", activePage);
+    writeNavLink(out, "/safety", "safety", "🛡️ Safety", activePage);
 
     // Mode toggle dropdown
-    nav += "<select class='mode-toggle' onchange='switchUIMode(this.value)'>";
-    nav += "<option value='simple'" + String(!advancedMode ? " selected" : "") + ">Simple</option>";
-    nav += "<option value='advanced'" + String(advancedMode ? " selected" : "") + ">Advanced</option>";
-    nav += "</select>";
-
-    nav += "<button class='theme-toggle' onclick='toggleDarkMode()' title='Toggle Dark Mode'>🌓</button>";
-    nav += "</div>";
+    out.print("<select class='mode-toggle' onchange='switchUIMode(this.value)'>");
+    out.print("<option value='simple'");
+    out.print(!advancedMode ? " selected" : "");
+    out.print(">Simple</option>");
+    out.print("<option value='advanced'");
+    out.print(advancedMode ? " selected" : "");
+    out.print(">Advanced</option>");
+    out.print("</select>");
+
+    out.print("<button class='theme-toggle' onclick='toggleDarkMode()' title='Toggle Dark Mode'>🌓</button>");
+    out.print("</div>");
 
     // JavaScript for dark mode and UI mode switching
-    nav += "<script>";
-    nav += "function toggleDarkMode(){document.body.classList.toggle('dark-mode');localStorage.setItem('darkMode',document.body.classList.contains('dark-mode'));}";
-    nav += "function switchUIMode(mode){fetch('/api/ui-mode',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({mode:mode})}).then(()=>location.reload());}";
-    nav += "</script>";
-
-    return nav;
+    out.print("<script>");
+    out.print("function toggleDarkMode(){document.body.classList.toggle('dark-mode');localStorage.setItem('darkMode',document.body.classList.contains('dark-mode'));}");
+    out.print("function switchUIMode(mode){fetch('/api/ui-mode',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({mode:mode})}).then(()=>location.reload());}");
+    out.print("</script>");
 }
 
 // ===== NEW v1 API HANDLERS =====
@@ -2515,7 +3574,7 @@ static void handleOutputClearFault(void) {
         return;
     }
 
-    OutputConfig_t* output = output_manager_get_output(outputIndex);
+    OutputSnapshot output(outputIndex);
     if (!output) {
         server.send(404, "application/json", "{\"ok\":false,\"error\":{\"code\":\"NOT_FOUND\",\"message\":\"Output not found\"}}");
         return;
@@ -2534,22 +3593,20 @@ static void handleOutputClearFault(void) {
         doc["error"]["currentFault"] = output_manager_get_fault_name(output->faultState);
     }
 
-    String response;
-    serializeJson(doc, response);
-    server.send(cleared ? 200 : 400, "application/json", response);
+    sendJson(cleared ? 200 : 400, doc);
 }
 
 /**
  * GET /api/v1/health - System health and diagnostics
  */
 static void handleHealthAPI(void) {
-    StaticJsonDocument<1024> doc;
+    ScratchJsonDocument doc(1280);
     doc["ok"] = true;
 
     JsonObject data = doc.createNestedObject("data");
 
     // System info
-    data["uptime"] = millis() / 1000;
+    data["uptime"] = time_service_uptime_sec();
     data["freeHeap"] = ESP.getFreeHeap();
     data["minFreeHeap"] = ESP.getMinFreeHeap();
     data["heapSize"] = ESP.getHeapSize();
@@ -2568,6 +3625,14 @@ static void handleHealthAPI(void) {
     network["rssi"] = WiFi.RSSI();
     network["ip"] = WiFi.localIP().toString();
 
+    // Event bus (drops mean a subscriber is not draining its queue)
+    JsonObject bus = data.createNestedObject("eventBus");
+    bus["published"] = event_bus_get_published();
+    JsonObject dropped = bus.createNestedObject("dropped");
+    for (int i = 0; i < event_bus_get_subscriber_count(); i++) {
+        dropped[event_bus_get_subscriber_name(i)] = event_bus_get_dropped(i);
+    }
+
     // Sensor status summary
     JsonObject sensors = data.createNestedObject("sensors");
     int sensorCount = sensor_manager_get_count();
@@ -2586,7 +3651,7 @@ static void handleHealthAPI(void) {
     int faultCount = 0;
     int activeCount = 0;
     for (int i = 0; i < 3; i++) {
-        OutputConfig_t* output = output_manager_get_output(i);
+        OutputSnapshot output(i);
         if (output) {
             if (output->faultState != FAULT_NONE) faultCount++;
             if (output->enabled && output->heating) activeCount++;
@@ -2599,11 +3664,11 @@ static void handleHealthAPI(void) {
     // Detailed output fault status
     JsonArray faults = data.createNestedArray("faults");
     for (int i = 0; i < 3; i++) {
-        OutputConfig_t* output = output_manager_get_output(i);
+        OutputSnapshot output(i);
         if (output && output->faultState != FAULT_NONE) {
             JsonObject fault = faults.createNestedObject();
             fault["outputId"] = i + 1;
-            fault["outputName"] = output->name;
+            fault["outputName"] = snapshotStr(output->name);
             fault["fault"] = output_manager_get_fault_name(output->faultState);
             fault["sensorHealth"] = output_manager_get_sensor_health_name(output->sensorHealth);
             fault["durationSec"] = (millis() - output->faultStartTime) / 1000;
@@ -2614,9 +3679,407 @@ static void handleHealthAPI(void) {
     JsonObject build = data.createNestedObject("build");
     build["version"] = firmwareVersion;
 
-    String response;
-    serializeJson(doc, response);
-    server.send(200, "application/json", response);
+    sendJson(200, doc);
+}
+
+/**
+ * GET /api/v1/perf - Main-loop timing histograms
+ */
+static void handlePerfAPI(void) {
+    if (!profiler_is_enabled()) {
+        server.send(404, "application/json", "{\"ok\":false,\"error\":{\"code\":\"DISABLED\",\"message\":\"Profiler not compiled in\"}}");
+        return;
+    }
+
+    ScratchJsonDocument doc(2048);
+    doc["ok"] = true;
+
+    JsonObject data = doc.createNestedObject("data");
+    data["windowMs"] = profiler_get_window_ms();
+    data["cpuFreqMHz"] = ESP.getCpuFreqMHz();
+
+    JsonArray sections = data.createNestedArray("sections");
+    for (int i = 0; i < PROF_SECTION_COUNT; i++) {
+        ProfilerSection_t section = (ProfilerSection_t)i;
+        const ProfilerStats_t* s = profiler_get_stats(section);
+        if (!s) continue;
+
+        JsonObject obj = sections.createNestedObject();
+        obj["name"] = profiler_get_section_name(section);
+        obj["count"] = s->count;
+        obj["minUs"] = s->count ? profiler_cycles_to_us(s->minCycles) : 0;
+        obj["p50Us"] = profiler_get_percentile_us(section, 50);
+        obj["p99Us"] = profiler_get_percentile_us(section, 99);
+        obj["maxUs"] = profiler_cycles_to_us(s->maxCycles);
+        obj["avgUs"] = s->count ? profiler_cycles_to_us(s->totalCycles / s->count) : 0;
+        obj["totalMs"] = profiler_cycles_to_us64(s->totalCycles) / 1000;
+    }
+
+    sendJson(200, doc);
+}
+
+/**
+ * POST /api/v1/perf/reset - Clear timing histograms
+ */
+static void handlePerfReset(void) {
+    // Protected route
+    if (!isAuthenticated()) {
+        server.send(401, "application/json", "{\"ok\":false,\"error\":{\"code\":\"UNAUTHORIZED\",\"message\":\"Authentication required\"}}");
+        return;
+    }
+
+    profiler_reset();
+    console_add_event(CONSOLE_EVENT_DEBUG, "PERF: statistics reset");
+    server.send(200, "application/json", "{\"ok\":true}");
+}
+
+/**
+ * POST /api/v1/perf/log - Dump timing summary to the console
+ */
+static void handlePerfLog(void) {
+    // Protected route
+    if (!isAuthenticated()) {
+        server.send(401, "application/json", "{\"ok\":false,\"error\":{\"code\":\"UNAUTHORIZED\",\"message\":\"Authentication required\"}}");
+        return;
+    }
+
+    profiler_log_summary();
+    server.send(200, "application/json", "{\"ok\":true}");
+}
+
+/**
+ * GET /api/v1/crashlog - Reset reason and last crash breadcrumbs
+ */
+static void handleCrashLogAPI(void) {
+    ScratchJsonDocument doc(3072);
+    doc["ok"] = true;
+
+    JsonObject data = doc.createNestedObject("data");
+    data["resetReason"] = crash_log_get_reset_reason_name(crash_log_get_reset_reason());
+    data["crashCount"] = crash_log_get_count();
+
+    const CrashRecord_t* crash = crash_log_get_last();
+    if (!crash) {
+        data["lastCrash"] = nullptr;
+    } else {
+        JsonObject last = data.createNestedObject("lastCrash");
+        last["resetReason"] = crash_log_get_reset_reason_name(crash->resetReason);
+        last["uptimeMs"] = crash->uptimeMs;
+
+        // Last checkpoint per subsystem (ENTER without EXIT = was inside)
+        JsonObject crumbs = last.createNestedObject("breadcrumbs");
+        for (int i = 0; i < CRASH_SUB_COUNT; i++) {
+            crumbs[crash_log_get_subsystem_name((CrashSubsystem_t)i)] = crash->lastCrumb[i];
+        }
+
+        // Oldest first, newest last
+        JsonArray trail = last.createNestedArray("trail");
+        for (int i = 0; i < crash->trailCount; i++) {
+            JsonObject t = trail.createNestedObject();
+            t["sub"] = crash_log_get_subsystem_name((CrashSubsystem_t)(crash->trail[i] >> 8));
+            t["pt"] = crash->trail[i] & 0xFF;
+        }
+
+        JsonArray events = last.createNestedArray("events");
+        for (int i = 0; i < crash->eventCount; i++) {
+            events.add(crash->events[i]);
+        }
+    }
+
+    sendJson(200, doc);
+}
+
+/**
+ * GET /api/v1/boot - Boot phase timing
+ */
+static void handleBootAPI(void) {
+    ScratchJsonDocument doc(1024);
+    doc["ok"] = true;
+
+    JsonObject data = doc.createNestedObject("data");
+    data["resetReason"] = crash_log_get_reset_reason_name(crash_log_get_reset_reason());
+    data["controlReadyMs"] = boot_profile_get_ms(BOOT_PHASE_CONTROL);
+    data["bootCompleteMs"] = boot_profile_get_ms(BOOT_PHASE_READY);
+
+    JsonArray phases = data.createNestedArray("phases");
+    for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+        BootPhase_t phase = (BootPhase_t)i;
+        if (boot_profile_get_ms(phase) == 0) continue;
+
+        JsonObject p = phases.createNestedObject();
+        p["name"] = boot_profile_get_phase_name(phase);
+        p["atMs"] = boot_profile_get_ms(phase);
+        p["durationMs"] = boot_profile_get_duration_ms(phase);
+    }
+
+    sendJson(200, doc);
+}
+
+/**
+ * Append closed energy buckets as Wh (newest first)
+ */
+static void appendEnergyBuckets(PageStream& out, const char* key, const uint32_t* mwh, int count) {
+    char item[32];
+    snprintf(item, sizeof(item), ",\"%s\":[", key);
+    out += item;
+    for (int i = 0; i < count; i++) {
+        snprintf(item, sizeof(item), "%s%lu.%03lu", i ? "," : "",
+                 (unsigned long)(mwh[i] / 1000), (unsigned long)(mwh[i] % 1000));
+        out += item;
+    }
+    out += "]";
+}
+
+/**
+ * GET /api/v1/energy[?output=N] - Energy counters and hour/day/month buckets
+ * Streamed: three outputs' buckets don't fit a JSON document comfortably.
+ */
+static void handleEnergyAPI(void) {
+    int only = server.hasArg("output") ? server.arg("output").toInt() : 0;
+    if (only < 0 || only > MAX_OUTPUTS) {
+        server.send(400, "text/plain", "Invalid output ID");
+        return;
+    }
+
+    PageStream out("application/json");
+    char item[160];
+    snprintf(item, sizeof(item), "{\"ok\":true,\"data\":{\"clockValid\":%s,\"outputs\":[",
+             time_service_is_valid() ? "true" : "false");
+    out += item;
+
+    bool first = true;
+    for (int i = 0; i < MAX_OUTPUTS; i++) {
+        if (only && only != i + 1) {
+            continue;
+        }
+        EnergyMeter_t meter;
+        if (!output_manager_get_energy(i, &meter)) {
+            continue;
+        }
+        uint16_t ratedWatts;
+        float powerW;
+        {
+            OutputSnapshot output(i);
+            if (!output) {
+                continue;
+            }
+            ratedWatts = output->ratedWatts;
+            powerW = output->powerW;
+        }
+
+        uint32_t hourMwh = energy_meter_open_mwh(&meter, 'h');
+        uint32_t dayMwh = energy_meter_open_mwh(&meter, 'd');
+        uint32_t monthMwh = energy_meter_open_mwh(&meter, 'm');
+        snprintf(item, sizeof(item),
+                 "%s{\"id\":%d,\"ratedWatts\":%u,\"powerW\":%.1f,\"totalKwh\":%.3f,"
+                 "\"onHours\":%.2f,\"fullPowerHours\":%.2f,",
+                 first ? "" : ",", i + 1, ratedWatts, powerW, energy_meter_total_kwh(&meter),
+                 meter.onMs / 3.6e6, meter.dutyMs / 3.6e6);
+        out += item;
+        snprintf(item, sizeof(item),
+                 "\"thisHourWh\":%lu.%03lu,\"todayWh\":%lu.%03lu,\"thisMonthWh\":%lu.%03lu",
+                 (unsigned long)(hourMwh / 1000), (unsigned long)(hourMwh % 1000),
+                 (unsigned long)(dayMwh / 1000), (unsigned long)(dayMwh % 1000),
+                 (unsigned long)(monthMwh / 1000), (unsigned long)(monthMwh % 1000));
+        out += item;
+        appendEnergyBuckets(out, "hourlyWh", meter.hourMwh, ENERGY_HOURS);
+        appendEnergyBuckets(out, "dailyWh", meter.dayMwh, ENERGY_DAYS);
+        appendEnergyBuckets(out, "monthlyWh", meter.monthMwh, ENERGY_MONTHS);
+        out += "}";
+        first = false;
+    }
+
+    out += "]}}";
+    out.finish();
+}
+
+/**
+ * GET /api/v1/fleet - This unit and the units heard on the fleet group
+ * Streamed: the node list grows with the fleet.
+ */
+static void handleFleetAPI(void) {
+    const FleetTable_t* table = fleet_get_table();
+
+    PageStream out("application/json");
+    out += "{\"ok\":true,\"data\":{\"enabled\":";
+    out += table ? "true" : "false";
+    out += ",\"nodes\":[";
+
+    char* item = (char*)malloc(768);
+    if (table && item) {
+        uint32_t now = millis();
+        FleetPeer_t self;
+        fleet_get_self(&self);
+        if (fleet_peer_json(&self, now, true, item, 768)) {
+            out += item;
+        }
+        for (int i = 0; i < table->capacity; i++) {
+            if (table->peers[i].used && fleet_peer_json(&table->peers[i], now, false, item, 768)) {
+                out += ",";
+                out += item;
+            }
+        }
+    }
+    free(item);
+
+    char stats[192];
+    snprintf(stats, sizeof(stats),
+             "],\"stats\":{\"framesIn\":%lu,\"bytesIn\":%lu,\"rejected\":%lu,\"full\":%lu,\"framesSent\":%lu}}}",
+             (unsigned long)(table ? table->framesIn : 0), (unsigned long)(table ? table->bytesIn : 0),
+             (unsigned long)(table ? table->rejected : 0), (unsigned long)(table ? table->full : 0),
+             (unsigned long)fleet_get_frames_sent());
+    out += stats;
+    out.finish();
+}
+
+/**
+ * GET /metrics - Prometheus text exposition (see metrics_exporter.h)
+ */
+static void handleMetrics(void) {
+    PageStream out(METRICS_CONTENT_TYPE);
+    metrics_exporter_write(out, firmwareVersion);
+    out.finish();
+}
+
+/**
+ * GET /api/v1/time - Clock, sync quality and timezone
+ */
+static void handleTimeAPI(void) {
+    TimeStatus_t status;
+    time_service_get_status(&status);
+
+    char local[24] = "";
+    struct tm localNow;
+    if (time_service_get_local(&localNow)) {
+        strftime(local, sizeof(local), "%Y-%m-%dT%H:%M:%S", &localNow);
+    }
+
+    PageStream out("application/json");
+    char item[384];
+    snprintf(item, sizeof(item),
+             "{\"ok\":true,\"data\":{\"utc\":%lu,\"local\":\"%s\",\"tz\":\"%s\",\"valid\":%s,"
+             "\"synced\":%s,\"stale\":%s,\"syncCount\":%lu,\"lastSyncAgeSec\":%lu,\"firstStepSec\":%ld,"
+             "\"uptimeUs\":%llu}}",
+             (unsigned long)time_service_utc(), local, time_service_get_timezone(),
+             (status.flags & TIME_FLAG_VALID) ? "true" : "false",
+             (status.flags & TIME_FLAG_SYNCED) ? "true" : "false",
+             (status.flags & TIME_FLAG_STALE) ? "true" : "false",
+             (unsigned long)status.syncCount, (unsigned long)status.lastSyncAgeSec,
+             (long)status.firstStepSec, (unsigned long long)time_service_uptime_us());
+    out += item;
+    out.finish();
+}
+
+/**
+ * GET /api/v1/ota - Firmware slot, verification and last update result
+ */
+static void handleOtaAPI(void) {
+    StaticJsonDocument<512> doc;
+    doc["ok"] = true;
+
+    JsonObject data = doc.createNestedObject("data");
+    data["version"] = firmwareVersion;
+    data["partition"] = ota_manager_get_running_partition();
+    data["pendingVerify"] = ota_manager_is_pending_verify();
+    data["unverified"] = ota_manager_image_unverified();
+    data["rolledBack"] = ota_manager_was_rolled_back();
+    data["rollbackCount"] = ota_manager_get_rollback_count();
+    data["state"] = ota_manager_get_state_name(ota_manager_get_state());
+    data["error"] = ota_manager_get_error_name(ota_manager_get_error());
+    data["bytesWritten"] = ota_manager_get_progress();
+    data["method"] = ota_manager_last_was_delta() ? "delta" : "full";
+    data["bytesDownloaded"] = ota_manager_get_download_bytes();
+
+    const uint8_t* sha = ota_manager_get_last_sha256();
+    if (sha) {
+        char hex[OTA_SHA256_LEN * 2 + 1];
+        ota_manager_format_sha256(sha, hex);
+        data["sha256"] = hex;
+    } else {
+        data["sha256"] = nullptr;
+    }
+
+    sendJson(200, doc);
+}
+
+/**
+ * GET /api/v1/heap - Heap, fragmentation trend and tracked call sites
+ */
+static void handleHeapAPI(void) {
+    // Sized for the full trend (3 values x HEAP_TREND_POINTS) plus sites
+    ScratchJsonDocument doc(SCRATCH_LARGE_SIZE);
+    doc["ok"] = true;
+
+    JsonObject data = doc.createNestedObject("data");
+    const HeapSample_t* latest = heap_monitor_get_latest();
+    data["freeHeap"] = latest->freeBytes;
+    data["largestBlock"] = latest->largestBlock;
+    data["fragmentation"] = heap_monitor_get_fragmentation(latest);
+    data["minFreeHeap"] = ESP.getMinFreeHeap();
+    data["minLargestBlock"] = heap_monitor_get_min_largest_block();
+    data["trendBytesPerHour"] = heap_monitor_get_trend_bytes_per_hour();
+    data["lowBlockThreshold"] = HEAP_LOW_BLOCK_THRESHOLD;
+    data["lowBlock"] = heap_monitor_is_low();
+    data["sampleIntervalSec"] = HEAP_SAMPLE_INTERVAL_MS / 1000;
+
+    // Columnar trend (oldest first) keeps the document small
+    JsonArray t = data.createNestedArray("t");
+    JsonArray freeBytes = data.createNestedArray("free");
+    JsonArray largest = data.createNestedArray("largest");
+    for (int i = 0; i < heap_monitor_get_sample_count(); i++) {
+        const HeapSample_t* s = heap_monitor_get_sample(i);
+        t.add(s->uptimeSec);
+        freeBytes.add(s->freeBytes);
+        largest.add(s->largestBlock);
+    }
+
+    const ScratchPoolStats_t* pool = scratch_pool_get_stats();
+    JsonObject poolObj = data.createNestedObject("scratchPool");
+    poolObj["acquisitions"] = pool->acquisitions;
+    poolObj["fallbacks"] = pool->fallbacks;
+    poolObj["exhausted"] = pool->exhausted;
+    poolObj["peakInUse"] = pool->peakInUse;
+    poolObj["peakLargeUsed"] = pool->peakLargeUsed;
+
+    // allocs are only counted in tracking builds (malloc wrapped)
+    JsonArray reqs = data.createNestedArray("requests");
+    for (int i = 0; i < requestStatsCount; i++) {
+        JsonObject r = reqs.createNestedObject();
+        r["uri"] = requestStats[i].uri;
+        r["requests"] = requestStats[i].requests;
+        r["allocs"] = requestStats[i].lastAllocs;
+        r["maxAllocs"] = requestStats[i].maxAllocs;
+        r["arenas"] = requestStats[i].lastArenas;
+        r["fallbacks"] = requestStats[i].fallbacks;
+    }
+
+    data["tracking"] = (bool)HEAP_TRACKING_ENABLED;
+    JsonArray sites = data.createNestedArray("sites");
+    for (int i = 0; i < heap_monitor_get_site_count(); i++) {
+        const HeapTrackSite_t* site = heap_monitor_get_site(i);
+        JsonObject obj = sites.createNestedObject();
+        obj["tag"] = site->tag;
+        obj["calls"] = site->calls;
+        obj["netBytes"] = site->netBytes;
+        obj["maxRetained"] = site->maxRetained;
+    }
+
+    sendJson(200, doc);
+}
+
+/**
+ * POST /api/v1/crashlog/clear - Forget stored crash record
+ */
+static void handleCrashLogClear(void) {
+    // Protected route
+    if (!isAuthenticated()) {
+        server.send(401, "application/json", "{\"ok\":false,\"error\":{\"code\":\"UNAUTHORIZED\",\"message\":\"Authentication required\"}}");
+        return;
+    }
+
+    crash_log_clear();
+    console_add_event(CONSOLE_EVENT_SYSTEM, "Crash log cleared");
+    server.send(200, "application/json", "{\"ok\":true}");
 }
 
 // ===== SAFETY PAGE AND API HANDLERS =====
@@ -2629,14 +4092,18 @@ static void handleSafetyPage(void) {
     // Protected route
     if (!isAuthenticated()) { requireAuth(); return; }
 
-    String html = webserver_get_html_header("Safety Settings", "safety");
+    PageStream html;
+
+    webserver_write_html_header(html, "Safety Settings", "safety");
 
     // Safe mode banner (if active)
     const SafetyState_t* safetyState = safety_manager_get_state();
     if (safetyState->safeMode) {
         html += "<div style='background:#f44336;color:white;padding:20px;border-radius:8px;margin:20px 0;text-align:center'>";
         html += "<h2 style='margin:0'>SAFE MODE ACTIVE</h2>";
-        html += "<p style='margin:10px 0'>Reason: " + String(safety_manager_get_reason_name(safetyState->safeModeReason)) + "</p>";
+        html += "<p style='margin:10px 0'>Reason: ";
+        html.print(safety_manager_get_reason_name(safetyState->safeModeReason));
+        html += "</p>";
         html += "<p style='margin:10px 0'>All outputs are disabled for safety.</p>";
         html += "<button onclick='exitSafeMode()' style='padding:10px 20px;font-size:16px;cursor:pointer'>Exit Safe Mode</button>";
         html += "</div>";
@@ -2655,7 +4122,9 @@ static void handleSafetyPage(void) {
     // Boot count
     html += "<div style='background:#e3f2fd;padding:15px;border-radius:8px'>";
     html += "<strong>Boot Count</strong><br>";
-    html += String(safetyState->bootCount) + " / " + String(BOOT_LOOP_THRESHOLD);
+    html.print(safetyState->bootCount);
+    html += " / ";
+    html.print(BOOT_LOOP_THRESHOLD);
     html += "</div>";
 
     // System status
@@ -2680,9 +4149,15 @@ static void handleSafetyPage(void) {
     html += "<strong>Select Output:</strong>";
     html += "<select id='output-selector' onchange='loadSafetySettings()' style='padding:8px;font-size:16px;border-radius:5px'>";
     for (int i = 0; i < 3; i++) {
-        OutputConfig_t* output = output_manager_get_output(i);
+        OutputSnapshot output(i);
         if (output) {
-            html += "<option value='" + String(i) + "'>" + String(output->name) + " (Output " + String(i + 1) + ")</option>";
+            html += "<option value='";
+            html.print(i);
+            html += "'>";
+            html.print(output->name);
+            html += " (Output ";
+            html.print(i + 1);
+            html += ")</option>";
         }
     }
     html += "</select></label></div>";
@@ -2878,8 +4353,8 @@ static void handleSafetyPage(void) {
     html += "loadSafetySettings();";
     html += "</script>";
 
-    html += webserver_get_html_footer(millis() / 1000);
-    server.send(200, "text/html", html);
+    webserver_write_html_footer(html, time_service_uptime_sec());
+    html.finish();
 }
 
 /**
@@ -2916,7 +4391,7 @@ static void handleSafetyAPI(void) {
         return;
     }
 
-    OutputConfig_t* output = output_manager_get_output(outputIndex);
+    OutputSnapshot output(outputIndex);
     if (!output) {
         server.send(404, "application/json", "{\"ok\":false,\"error\":{\"code\":\"NOT_FOUND\",\"message\":\"Output not found\"}}");
         return;
@@ -2953,7 +4428,7 @@ static void handleSafetyAPI(void) {
 
     // Update auto-resume setting
     if (doc.containsKey("autoResumeOnSensorOk")) {
-        output->autoResumeOnSensorOk = doc["autoResumeOnSensorOk"];
+        output_manager_set_auto_resume(outputIndex, doc["autoResumeOnSensorOk"]);
     }
 
     // Save to NVS
@@ -4,6 +4,8 @@
  */
 
 #include "wifi_manager.h"
+#include "heap_monitor.h"
+#include "event_bus.h"
 #include <Arduino.h>
 
 // Default WiFi credentials (fallback)
@@ -31,6 +33,7 @@ static char macAddressBuffer[18] = "";
 // Forward declarations
 static void connectToWiFi(const char* ssid, const char* password);
 static void updateIPAddress(void);
+static void publishStatus(void);
 
 /**
  * Initialize WiFi manager
@@ -59,6 +62,8 @@ void wifi_init(void) {
  * WiFi task - handles reconnection
  */
 void wifi_task(void) {
+    HEAP_TRACK_SCOPE("wifi_task");
+
     // In AP mode: periodically try to reconnect to saved WiFi
     if (apMode) {
         if (millis() - lastConnectionAttempt >= CONNECTION_RETRY_INTERVAL) {
@@ -73,6 +78,7 @@ void wifi_task(void) {
         if (currentState != WIFI_STATE_DISCONNECTED) {
             Serial.println("[WiFi] Connection lost");
             currentState = WIFI_STATE_DISCONNECTED;
+            publishStatus();
         }
 
         // Attempt reconnection at interval
@@ -85,6 +91,7 @@ void wifi_task(void) {
             Serial.println("[WiFi] Connection established");
             currentState = WIFI_STATE_CONNECTED;
             updateIPAddress();
+            publishStatus();
         }
     }
 }
@@ -139,7 +146,8 @@ bool wifi_connect(const char* ssid, const char* password) {
         // Store MAC address
         String mac = WiFi.macAddress();
         mac.toCharArray(macAddressBuffer, sizeof(macAddressBuffer));
-        
+
+        publishStatus();
         return true;
     } else {
         Serial.println("[WiFi] Connection failed, starting AP mode");
@@ -168,6 +176,7 @@ void wifi_start_ap_mode(void) {
     
     updateIPAddress();
     strncpy(ssidBuffer, AP_SSID, sizeof(ssidBuffer));
+    publishStatus();
 }
 
 /**
@@ -320,3 +329,16 @@ static void updateIPAddress(void) {
         strncpy(ipAddressBuffer, "0.0.0.0", sizeof(ipAddressBuffer));
     }
 }
+
+/**
+ * Publish connection status on the event bus
+ */
+static void publishStatus(void) {
+    Event_t event;
+    event.topic = EVENT_NETWORK_STATUS;
+    event.network.connected = (currentState == WIFI_STATE_CONNECTED);
+    event.network.apMode = apMode;
+    strlcpy(event.network.ssid, ssidBuffer, sizeof(event.network.ssid));
+    strlcpy(event.network.ip, ipAddressBuffer, sizeof(event.network.ip));
+    event_bus_publish(&event);
+}
@@ -0,0 +1,67 @@
+/**
+ * boot_profile.cpp
+ * Boot Phase Timing Implementation
+ */
+
+#include "boot_profile.h"
+#include "console.h"
+
+// Completion time per phase (ms since reset, 0 = not reached)
+static uint32_t phaseMs[BOOT_PHASE_COUNT];
+
+void boot_profile_mark(BootPhase_t phase) {
+    if ((unsigned)phase >= BOOT_PHASE_COUNT) {
+        return;
+    }
+    // millis() starts at reset, so this includes ROM/bootloader-to-setup time
+    phaseMs[phase] = millis();
+    if (phaseMs[phase] == 0) phaseMs[phase] = 1;
+}
+
+uint32_t boot_profile_get_ms(BootPhase_t phase) {
+    if ((unsigned)phase >= BOOT_PHASE_COUNT) {
+        return 0;
+    }
+    return phaseMs[phase];
+}
+
+uint32_t boot_profile_get_duration_ms(BootPhase_t phase) {
+    uint32_t end = boot_profile_get_ms(phase);
+    if (end == 0) {
+        return 0;
+    }
+
+    // Previous phase that was actually reached
+    for (int i = (int)phase - 1; i >= 0; i--) {
+        if (phaseMs[i] != 0) {
+            return end - phaseMs[i];
+        }
+    }
+    return end;
+}
+
+const char* boot_profile_get_phase_name(BootPhase_t phase) {
+    switch (phase) {
+        case BOOT_PHASE_CORE:      return "core";
+        case BOOT_PHASE_CONFIG:    return "config";
+        case BOOT_PHASE_CONTROL:   return "control";
+        case BOOT_PHASE_DISPLAY:   return "display";
+        case BOOT_PHASE_WIFI:      return "wifi";
+        case BOOT_PHASE_NETWORK:   return "network";
+        case BOOT_PHASE_WEBSERVER: return "webserver";
+        case BOOT_PHASE_READY:     return "ready";
+        default:                   return "unknown";
+    }
+}
+
+void boot_profile_log_summary(void) {
+    char line[128];
+    int len = snprintf(line, sizeof(line), "BOOT:");
+    for (int i = 0; i < BOOT_PHASE_COUNT && len < (int)sizeof(line); i++) {
+        if (phaseMs[i] == 0) continue;
+        len += snprintf(line + len, sizeof(line) - len, " %s=%lu",
+                        boot_profile_get_phase_name((BootPhase_t)i),
+                        (unsigned long)phaseMs[i]);
+    }
+    console_add_event(CONSOLE_EVENT_SYSTEM, line);
+}
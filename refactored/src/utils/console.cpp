@@ -4,58 +4,236 @@
  */
 
 #include "console.h"
+#include "crash_log.h"
+#include "event_log.h"
+#include "time_service.h"
+#include <math.h>
 #include <stdarg.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
-#define MAX_CONSOLE_EVENTS 50
-#define MAX_EVENT_LENGTH 128
+// Console and log events, packed
+static uint8_t store_buffer[CONSOLE_STORE_BYTES];
+static EventLog_t store;
 
-// Event structure
-typedef struct {
-    ConsoleEventType_t type;
-    char message[MAX_EVENT_LENGTH];
-    unsigned long timestamp;
-} ConsoleEvent_t;
+// Events arrive from both the control task and loop()
+static SemaphoreHandle_t console_mutex = nullptr;
 
-// Console buffer (circular)
-static ConsoleEvent_t event_buffer[MAX_CONSOLE_EVENTS];
-static int event_count = 0;
-static int event_index = 0;
-static unsigned long boot_time = 0;
+// Formats of packed events, indexed by ConsoleFormat_t
+static const char* const packedFormats[CONSOLE_FMT_COUNT] = {
+    "Temp: %.1f°C",
+    "MQTT PUB: Output %d changed",
+};
 
-void console_init(void) {
-    boot_time = millis();
-    event_count = 0;
-    event_index = 0;
-    memset(event_buffer, 0, sizeof(event_buffer));
+/**
+ * Format "[hh:mm:ss] text"
+ */
+static void formatEvent(char* buf, size_t len, uint32_t uptime, const char* message) {
+    unsigned hours = uptime / 3600;         // Up to 7 digits; EVENT_LOG_MAX_LINE allows for them
+    unsigned minutes = (uptime % 3600) / 60;
+    unsigned seconds = uptime % 60;
+    snprintf(buf, len, "[%02u:%02u:%02u] %.*s", hours, minutes, seconds, EVENT_LOG_MAX_TEXT, message);
 }
 
-void console_add_event(ConsoleEventType_t type, const char* message) {
-    // Calculate uptime
-    unsigned long uptime = (millis() - boot_time) / 1000;
-    unsigned long hours = uptime / 3600;
-    unsigned long minutes = (uptime % 3600) / 60;
-    unsigned long seconds = uptime % 60;
+// ===== PACKED EVENTS =====
+
+/**
+ * Parse one conversion of a packed format
+ * @param fmt Just past the '%'
+ * @param spec The conversion without length modifiers, for snprintf
+ * @param isLong Out: had an 'l' modifier
+ * @param conv Out: conversion character
+ * @return Characters used after the '%', 0 if it can't be packed
+ */
+static size_t parseConversion(const char* fmt, char* spec, size_t specSize, bool* isLong, char* conv) {
+    size_t n = 0;
+    size_t out = 0;
+    spec[out++] = '%';
+    *isLong = false;
+    while (fmt[n] && strchr("-+ #0123456789.l", fmt[n])) {
+        if (fmt[n] == 'l') {
+            *isLong = true;
+        } else if (out + 2 < specSize) {
+            spec[out++] = fmt[n];
+        }
+        n++;
+    }
+    if (!fmt[n] || !strchr("diuxXf", fmt[n])) {
+        return 0;
+    }
+    *conv = fmt[n];
+    spec[out++] = fmt[n];
+    spec[out] = '\0';
+    return n + 1;
+}
 
-    // Format timestamp and message
-    snprintf(event_buffer[event_index].message, MAX_EVENT_LENGTH,
-             "[%02lu:%02lu:%02lu] %s",
-             hours, minutes, seconds, message);
+static bool putVarint(uint8_t* body, size_t size, size_t* length, uint32_t v) {
+    do {
+        if (*length >= size) {
+            return false;
+        }
+        body[(*length)++] = (uint8_t)((v & 0x7F) | (v >= 0x80 ? 0x80 : 0));
+        v >>= 7;
+    } while (v);
+    return true;
+}
 
-    event_buffer[event_index].type = type;
-    event_buffer[event_index].timestamp = millis();
+static bool getVarint(const uint8_t* body, size_t length, size_t* pos, uint32_t* v) {
+    *v = 0;
+    for (int shift = 0; *pos < length && shift < 35; shift += 7) {
+        uint8_t b = body[(*pos)++];
+        *v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/**
+ * Encode a format id and its arguments: integers as varints (signed ones
+ * zigzagged), floats as zigzagged tenths
+ * @return false if an argument can't be packed
+ */
+static bool packEvent(ConsoleFormat_t format, va_list args, uint8_t* body, size_t size, size_t* length) {
+    *length = 0;
+    body[(*length)++] = (uint8_t)format;
+    char spec[16];
+    bool isLong;
+    char conv;
+    for (const char* p = packedFormats[format]; *p; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        if (p[1] == '%') {
+            p++;
+            continue;
+        }
+        size_t used = parseConversion(p + 1, spec, sizeof(spec), &isLong, &conv);
+        if (used == 0) {
+            return false;
+        }
+        p += used;
+
+        uint32_t v;
+        if (conv == 'f') {
+            double f = va_arg(args, double);
+            if (!isfinite(f) || fabs(f) >= 2.0e8) {
+                return false;
+            }
+            v = zigzag((int32_t)lround(f * 10.0));
+        } else if (conv == 'd' || conv == 'i') {
+            v = zigzag(isLong ? (int32_t)va_arg(args, long) : (int32_t)va_arg(args, int));
+        } else {
+            v = isLong ? (uint32_t)va_arg(args, unsigned long) : (uint32_t)va_arg(args, unsigned);
+        }
+        if (!putVarint(body, size, length, v)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Format a packed body as text
+ */
+static void unpackEvent(const uint8_t* body, size_t length, char* text, size_t size) {
+    if (length == 0 || body[0] >= CONSOLE_FMT_COUNT) {
+        snprintf(text, size, "(unknown event)");
+        return;
+    }
+
+    size_t pos = 1;
+    size_t out = 0;
+    char spec[16];
+    bool isLong;
+    char conv;
+    for (const char* p = packedFormats[body[0]]; *p && out + 1 < size; p++) {
+        if (*p != '%') {
+            text[out++] = *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            text[out++] = '%';
+            p++;
+            continue;
+        }
+        size_t used = parseConversion(p + 1, spec, sizeof(spec), &isLong, &conv);
+        uint32_t v = 0;
+        if (used == 0 || !getVarint(body, length, &pos, &v)) {
+            break;
+        }
+        p += used;
+
+        int n;
+        if (conv == 'f') {
+            n = snprintf(text + out, size - out, spec, unzigzag(v) / 10.0);
+        } else if (conv == 'd' || conv == 'i') {
+            n = snprintf(text + out, size - out, spec, (int)unzigzag(v));
+        } else {
+            n = snprintf(text + out, size - out, spec, (unsigned)v);
+        }
+        if (n > 0) {
+            out += ((size_t)n < size - out) ? (size_t)n : size - out - 1;
+        }
+    }
+    text[out] = '\0';
+}
+
+// ===== EVENTS =====
+
+void console_init(void) {
+    if (!console_mutex) {
+        console_mutex = xSemaphoreCreateMutex();
+    }
+    event_log_init(&store, store_buffer, sizeof(store_buffer));
+}
+
+/**
+ * Echo an event to serial and the crash log, then store it as text or,
+ * with a body, packed
+ */
+static void addEvent(ConsoleEventType_t type, uint8_t views, const char* message,
+                     const uint8_t* body, size_t length) {
+    uint32_t uptime = time_service_uptime_sec();
 
     // Print to serial for traditional debugging
-    Serial.println(event_buffer[event_index].message);
+    char line[CONSOLE_MAX_EVENT_LENGTH];
+    formatEvent(line, sizeof(line), uptime, message);
+    Serial.println(line);
 
-    // Update circular buffer indices
-    event_index = (event_index + 1) % MAX_CONSOLE_EVENTS;
-    if (event_count < MAX_CONSOLE_EVENTS) {
-        event_count++;
+    // Mirror into RTC so the last few events survive a crash
+    if (views & CONSOLE_VIEW_CONSOLE) {
+        crash_log_add_event(line);
     }
+
+    if (console_mutex) xSemaphoreTake(console_mutex, portMAX_DELAY);
+    if (body) {
+        event_log_append_packed(&store, (uint8_t)type, views, uptime, body, length);
+    } else {
+        event_log_append(&store, (uint8_t)type, views, uptime, message);
+    }
+    if (console_mutex) xSemaphoreGive(console_mutex);
+}
+
+void console_add_event_to(ConsoleEventType_t type, uint8_t views, const char* message) {
+    addEvent(type, views, message, nullptr, 0);
+}
+
+void console_add_event(ConsoleEventType_t type, const char* message) {
+    console_add_event_to(type, CONSOLE_VIEW_CONSOLE, message);
 }
 
 void console_add_event_f(ConsoleEventType_t type, const char* format, ...) {
-    char buffer[MAX_EVENT_LENGTH];
+    char buffer[CONSOLE_MAX_EVENT_LENGTH];
     va_list args;
     va_start(args, format);
     vsnprintf(buffer, sizeof(buffer), format, args);
@@ -64,48 +242,76 @@ void console_add_event_f(ConsoleEventType_t type, const char* format, ...) {
     console_add_event(type, buffer);
 }
 
+void console_add_event_p(ConsoleEventType_t type, ConsoleFormat_t format, ...) {
+    if ((unsigned)format >= CONSOLE_FMT_COUNT) {
+        return;
+    }
+
+    uint8_t body[EVENT_LOG_MAX_TEXT];
+    size_t length;
+    va_list args;
+    va_start(args, format);
+    bool packed = packEvent(format, args, body, sizeof(body), &length);
+    va_end(args);
+
+    char text[EVENT_LOG_MAX_TEXT + 1];
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), packedFormats[format], args);
+    va_end(args);
+
+    addEvent(type, CONSOLE_VIEW_CONSOLE, text, packed ? body : nullptr, length);
+}
+
 int console_get_count(void) {
-    return event_count;
+    return console_get_view_count(CONSOLE_VIEW_CONSOLE);
 }
 
-const char* console_get_event(int index) {
-    if (index < 0 || index >= event_count) {
-        return nullptr;
-    }
+int console_get_view_count(uint8_t view) {
+    if (console_mutex) xSemaphoreTake(console_mutex, portMAX_DELAY);
+    int count = event_log_count(&store, view);
+    if (console_mutex) xSemaphoreGive(console_mutex);
+    return count;
+}
 
-    // Calculate actual buffer index (newest first)
-    int actual_index;
-    if (event_count < MAX_CONSOLE_EVENTS) {
-        // Buffer not full yet, start from beginning
-        actual_index = event_count - 1 - index;
-    } else {
-        // Buffer full, calculate from current position
-        actual_index = (event_index - 1 - index + MAX_CONSOLE_EVENTS) % MAX_CONSOLE_EVENTS;
-    }
+uint32_t console_get_first_seq(void) {
+    if (console_mutex) xSemaphoreTake(console_mutex, portMAX_DELAY);
+    uint32_t first = store.firstSeq;
+    if (console_mutex) xSemaphoreGive(console_mutex);
+    return first;
+}
 
-    return event_buffer[actual_index].message;
+uint32_t console_get_next_seq(void) {
+    return store.nextSeq;
 }
 
-ConsoleEventType_t console_get_event_type(int index) {
-    if (index < 0 || index >= event_count) {
-        return CONSOLE_EVENT_DEBUG;
-    }
+bool console_read_view(uint32_t* cursor, uint8_t views, uint32_t typeMask, ConsoleRecord_t* out) {
+    EventLogRecord_t record;
+    if (console_mutex) xSemaphoreTake(console_mutex, portMAX_DELAY);
+    bool found = event_log_read(&store, cursor, views, typeMask, &record);
+    if (console_mutex) xSemaphoreGive(console_mutex);
 
-    // Calculate actual buffer index (newest first)
-    int actual_index;
-    if (event_count < MAX_CONSOLE_EVENTS) {
-        actual_index = event_count - 1 - index;
-    } else {
-        actual_index = (event_index - 1 - index + MAX_CONSOLE_EVENTS) % MAX_CONSOLE_EVENTS;
+    if (found) {
+        out->seq = record.seq;
+        out->type = (ConsoleEventType_t)record.type;
+        if (record.packed) {
+            char text[EVENT_LOG_MAX_TEXT + 1];
+            unpackEvent((const uint8_t*)record.text, record.length, text, sizeof(text));
+            formatEvent(out->message, sizeof(out->message), record.timeSec, text);
+        } else {
+            formatEvent(out->message, sizeof(out->message), record.timeSec, record.text);
+        }
     }
+    return found;
+}
 
-    return event_buffer[actual_index].type;
+bool console_read(uint32_t* cursor, uint32_t typeMask, ConsoleRecord_t* out) {
+    return console_read_view(cursor, CONSOLE_VIEW_CONSOLE, typeMask, out);
 }
 
 void console_clear(void) {
-    event_count = 0;
-    event_index = 0;
-    memset(event_buffer, 0, sizeof(event_buffer));
+    if (console_mutex) xSemaphoreTake(console_mutex, portMAX_DELAY);
+    event_log_clear(&store);
+    if (console_mutex) xSemaphoreGive(console_mutex);
 }
 
 const char* console_get_type_name(ConsoleEventType_t type) {
@@ -121,3 +327,13 @@ const char* console_get_type_name(ConsoleEventType_t type) {
         default:                     return "UNKNOWN";
     }
 }
+
+bool console_parse_type(const char* name, ConsoleEventType_t* type) {
+    for (int t = CONSOLE_EVENT_SYSTEM; t <= CONSOLE_EVENT_DEBUG; t++) {
+        if (strcasecmp(name, console_get_type_name((ConsoleEventType_t)t)) == 0) {
+            *type = (ConsoleEventType_t)t;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,227 @@
+/**
+ * crash_log.cpp
+ * Crash/Reset Forensics Implementation
+ */
+
+#include "crash_log.h"
+#include <Preferences.h>
+#include <esp_system.h>
+
+// NVS namespace for crash data
+#define CRASH_NAMESPACE "crashlog"
+#define KEY_CRASH_RECORD "record"
+#define KEY_CRASH_COUNT "count"
+
+// RTC slow memory, not cleared by warm resets
+RTC_NOINIT_ATTR CrashRtcData_t crash_rtc;
+
+// Previous crash (loaded from / saved to NVS)
+static CrashRecord_t lastCrash;
+static bool hasLastCrash = false;
+static uint16_t crashCount = 0;
+static uint8_t resetReason = ESP_RST_UNKNOWN;
+
+// Forward declarations
+static void buildRecord(CrashRecord_t* record);
+static void armRtc(void);
+
+/**
+ * Initialize crash log
+ */
+void crash_log_init(void) {
+    resetReason = (uint8_t)esp_reset_reason();
+    bool rtcValid = (crash_rtc.magic == CRASH_LOG_MAGIC);
+
+    Preferences prefs;
+    prefs.begin(CRASH_NAMESPACE, false);
+
+    crashCount = prefs.getUShort(KEY_CRASH_COUNT, 0);
+    if (prefs.getBytesLength(KEY_CRASH_RECORD) == sizeof(CrashRecord_t)) {
+        prefs.getBytes(KEY_CRASH_RECORD, &lastCrash, sizeof(CrashRecord_t));
+        hasLastCrash = true;
+    }
+
+    if (crash_log_is_abnormal(resetReason)) {
+        memset(&lastCrash, 0, sizeof(lastCrash));
+        lastCrash.resetReason = resetReason;
+        if (rtcValid) {
+            buildRecord(&lastCrash);
+        }
+        hasLastCrash = true;
+        crashCount++;
+
+        prefs.putBytes(KEY_CRASH_RECORD, &lastCrash, sizeof(CrashRecord_t));
+        prefs.putUShort(KEY_CRASH_COUNT, crashCount);
+
+        Serial.printf("[CrashLog] Abnormal reset: %s after %lus (%s)\n",
+                     crash_log_get_reset_reason_name(resetReason),
+                     (unsigned long)(lastCrash.uptimeMs / 1000),
+                     rtcValid ? "trail saved" : "no RTC data");
+    } else {
+        Serial.printf("[CrashLog] Reset reason: %s\n",
+                     crash_log_get_reset_reason_name(resetReason));
+    }
+
+    prefs.end();
+
+    armRtc();
+}
+
+/**
+ * Record loop uptime
+ */
+void crash_log_tick(void) {
+    crash_rtc.uptimeMs = millis();
+}
+
+/**
+ * Copy console event into RTC ring
+ */
+void crash_log_add_event(const char* message) {
+    if (!message) {
+        return;
+    }
+
+    // Modulo keeps us in bounds even before crash_log_init() re-arms the record
+    uint8_t slot = crash_rtc.eventHead % CRASH_LOG_EVENTS;
+    strncpy(crash_rtc.events[slot], message, CRASH_LOG_EVENT_LEN - 1);
+    crash_rtc.events[slot][CRASH_LOG_EVENT_LEN - 1] = '\0';
+
+    crash_rtc.eventHead = (slot + 1) % CRASH_LOG_EVENTS;
+    if (crash_rtc.eventCount < CRASH_LOG_EVENTS) {
+        crash_rtc.eventCount++;
+    }
+}
+
+/**
+ * Get reset reason for this boot
+ */
+uint8_t crash_log_get_reset_reason(void) {
+    return resetReason;
+}
+
+/**
+ * Get reset reason name
+ */
+const char* crash_log_get_reset_reason_name(uint8_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON:   return "power_on";
+        case ESP_RST_EXT:       return "external";
+        case ESP_RST_SW:        return "software";
+        case ESP_RST_PANIC:     return "panic";
+        case ESP_RST_INT_WDT:   return "int_wdt";
+        case ESP_RST_TASK_WDT:  return "task_wdt";
+        case ESP_RST_WDT:       return "wdt";
+        case ESP_RST_DEEPSLEEP: return "deep_sleep";
+        case ESP_RST_BROWNOUT:  return "brownout";
+        case ESP_RST_SDIO:      return "sdio";
+        default:                return "unknown";
+    }
+}
+
+/**
+ * Check if reset reason indicates a crash
+ */
+bool crash_log_is_abnormal(uint8_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON:
+        case ESP_RST_EXT:
+        case ESP_RST_SW:
+        case ESP_RST_DEEPSLEEP:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/**
+ * Check if reset reason was a watchdog timeout
+ */
+bool crash_log_is_watchdog(uint8_t reason) {
+    return reason == ESP_RST_INT_WDT || reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT;
+}
+
+/**
+ * Get last stored crash record
+ */
+const CrashRecord_t* crash_log_get_last(void) {
+    return hasLastCrash ? &lastCrash : nullptr;
+}
+
+/**
+ * Get crash count
+ */
+uint16_t crash_log_get_count(void) {
+    return crashCount;
+}
+
+/**
+ * Clear stored crash record
+ */
+void crash_log_clear(void) {
+    Preferences prefs;
+    prefs.begin(CRASH_NAMESPACE, false);
+    prefs.remove(KEY_CRASH_RECORD);
+    prefs.remove(KEY_CRASH_COUNT);
+    prefs.end();
+
+    memset(&lastCrash, 0, sizeof(lastCrash));
+    hasLastCrash = false;
+    crashCount = 0;
+
+    Serial.println("[CrashLog] Crash record cleared");
+}
+
+/**
+ * Get subsystem name
+ */
+const char* crash_log_get_subsystem_name(CrashSubsystem_t sub) {
+    switch (sub) {
+        case CRASH_SUB_LOOP:    return "loop";
+        case CRASH_SUB_WIFI:    return "wifi";
+        case CRASH_SUB_MQTT:    return "mqtt";
+        case CRASH_SUB_WEB:     return "web";
+        case CRASH_SUB_DISPLAY: return "display";
+        case CRASH_SUB_SENSORS: return "sensors";
+        case CRASH_SUB_OUTPUTS: return "outputs";
+        case CRASH_SUB_SAFETY:  return "safety";
+        default:                return "unknown";
+    }
+}
+
+// ===== INTERNAL FUNCTIONS =====
+
+/**
+ * Unroll RTC rings into an oldest-first record
+ */
+static void buildRecord(CrashRecord_t* record) {
+    record->uptimeMs = crash_rtc.uptimeMs;
+    memcpy(record->lastCrumb, crash_rtc.lastCrumb, sizeof(record->lastCrumb));
+
+    // Walk from the oldest slot; unused slots are still zero (checkpoints start at 1)
+    uint8_t trailCount = 0;
+    for (uint8_t i = 0; i < CRASH_LOG_TRAIL_LEN; i++) {
+        uint16_t crumb = crash_rtc.trail[(uint8_t)(crash_rtc.trailHead + i) & (CRASH_LOG_TRAIL_LEN - 1)];
+        if (crumb != 0) {
+            record->trail[trailCount++] = crumb;
+        }
+    }
+    record->trailCount = trailCount;
+
+    uint8_t eventCount = crash_rtc.eventCount <= CRASH_LOG_EVENTS ? crash_rtc.eventCount : CRASH_LOG_EVENTS;
+    uint8_t head = crash_rtc.eventHead % CRASH_LOG_EVENTS;
+    for (uint8_t i = 0; i < eventCount; i++) {
+        uint8_t slot = (head + CRASH_LOG_EVENTS - eventCount + i) % CRASH_LOG_EVENTS;
+        memcpy(record->events[i], crash_rtc.events[slot], CRASH_LOG_EVENT_LEN);
+        record->events[i][CRASH_LOG_EVENT_LEN - 1] = '\0';
+    }
+    record->eventCount = eventCount;
+}
+
+/**
+ * Reset RTC record for this boot
+ */
+static void armRtc(void) {
+    memset(&crash_rtc, 0, sizeof(crash_rtc));
+    crash_rtc.magic = CRASH_LOG_MAGIC;
+}
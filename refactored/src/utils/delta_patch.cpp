@@ -0,0 +1,334 @@
+/**
+ * delta_patch.cpp
+ * Streaming Binary Delta Decoder Implementation
+ */
+
+#include "delta_patch.h"
+#include <string.h>
+
+// Decoder states
+enum {
+    ST_HEADER = 0,
+    ST_DIFF_LEN,
+    ST_EXTRA_LEN,
+    ST_SEEK,
+    ST_ZERO_RUN,
+    ST_LIT_LEN,
+    ST_LIT,
+    ST_EXTRA,
+    ST_DONE
+};
+
+// Forward declarations
+static bool readVarint(DeltaPatch_t* p, uint8_t b, uint32_t* value);
+static bool fillOld(DeltaPatch_t* p);
+static bool flushOut(DeltaPatch_t* p);
+static bool emitByte(DeltaPatch_t* p, uint8_t b);
+static bool copyOld(DeltaPatch_t* p, uint32_t n);
+static void afterDiff(DeltaPatch_t* p);
+static void endRecord(DeltaPatch_t* p);
+static uint32_t readLe32(const uint8_t* b);
+
+// ZigZag-decode a signed varint
+static inline int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/**
+ * Start decoding a patch
+ */
+void delta_patch_init(DeltaPatch_t* p, DeltaReadOldFn readOld, DeltaWriteFn write,
+                      void* ctx, uint32_t oldLimit) {
+    memset(p, 0, sizeof(DeltaPatch_t));
+    p->readOld = readOld;
+    p->write = write;
+    p->ctx = ctx;
+    p->oldLimit = oldLimit;
+    p->state = ST_HEADER;
+    p->error = DELTA_OK;
+}
+
+/**
+ * Feed patch data
+ */
+DeltaResult_t delta_patch_feed(DeltaPatch_t* p, const uint8_t* data, size_t len) {
+    size_t i = 0;
+    uint32_t v;
+
+    while (i < len && p->error == DELTA_OK) {
+        switch (p->state) {
+            case ST_HEADER:
+                p->header[p->headerLen++] = data[i++];
+                if (p->headerLen == DELTA_HEADER_SIZE) {
+                    if (memcmp(p->header, DELTA_MAGIC, 4) != 0) {
+                        p->error = DELTA_ERR_MAGIC;
+                        break;
+                    }
+                    p->oldSize = readLe32(p->header + 4);
+                    p->newSize = readLe32(p->header + 8);
+                    if (p->oldSize > p->oldLimit) {
+                        p->error = DELTA_ERR_RANGE;
+                        break;
+                    }
+                    p->state = (p->newSize == 0) ? ST_DONE : ST_DIFF_LEN;
+                }
+                break;
+
+            case ST_DIFF_LEN:
+                if (!readVarint(p, data[i++], &v)) break;
+                p->diffRemain = v;
+                p->state = ST_EXTRA_LEN;
+                break;
+
+            case ST_EXTRA_LEN:
+                if (!readVarint(p, data[i++], &v)) break;
+                p->extraRemain = v;
+                if ((uint64_t)p->newPos + p->diffRemain + p->extraRemain > p->newSize ||
+                    (uint64_t)p->oldPos + p->diffRemain > p->oldSize) {
+                    p->error = DELTA_ERR_RANGE;
+                    break;
+                }
+                p->state = ST_SEEK;
+                break;
+
+            case ST_SEEK:
+                if (!readVarint(p, data[i++], &v)) break;
+                p->seek = unzigzag(v);
+                if (p->diffRemain > 0) {
+                    p->state = ST_ZERO_RUN;
+                } else {
+                    afterDiff(p);
+                }
+                break;
+
+            case ST_ZERO_RUN:
+                if (!readVarint(p, data[i++], &v)) break;
+                if (v > p->diffRemain) {
+                    p->error = DELTA_ERR_FORMAT;
+                    break;
+                }
+                if (!copyOld(p, v)) break;
+                p->diffRemain -= v;
+                if (p->diffRemain > 0) {
+                    p->state = ST_LIT_LEN;
+                } else {
+                    afterDiff(p);
+                }
+                break;
+
+            case ST_LIT_LEN:
+                if (!readVarint(p, data[i++], &v)) break;
+                if (v > p->diffRemain) {
+                    p->error = DELTA_ERR_FORMAT;
+                    break;
+                }
+                p->runRemain = v;
+                p->state = (v > 0) ? ST_LIT : ST_ZERO_RUN;
+                break;
+
+            case ST_LIT:
+                // Changed bytes: new = old + delta
+                while (i < len && p->runRemain > 0) {
+                    if (p->oldPos < p->oldBufStart || p->oldPos >= p->oldBufStart + p->oldBufLen) {
+                        if (!fillOld(p)) break;
+                    }
+                    uint8_t b = p->oldBuf[p->oldPos - p->oldBufStart] + data[i++];
+                    p->oldPos++;
+                    p->runRemain--;
+                    p->diffRemain--;
+                    if (!emitByte(p, b)) break;
+                }
+                if (p->error == DELTA_OK && p->runRemain == 0) {
+                    if (p->diffRemain > 0) {
+                        p->state = ST_ZERO_RUN;
+                    } else {
+                        afterDiff(p);
+                    }
+                }
+                break;
+
+            case ST_EXTRA: {
+                // Inserted bytes: copy straight through
+                size_t n = len - i;
+                if (n > p->extraRemain) n = p->extraRemain;
+                while (n > 0) {
+                    size_t room = DELTA_OUT_BUF_SIZE - p->outLen;
+                    size_t take = (n < room) ? n : room;
+                    memcpy(p->outBuf + p->outLen, data + i, take);
+                    p->outLen += take;
+                    p->newPos += take;
+                    p->extraRemain -= take;
+                    i += take;
+                    n -= take;
+                    if (p->outLen == DELTA_OUT_BUF_SIZE && !flushOut(p)) break;
+                }
+                if (p->error == DELTA_OK && p->extraRemain == 0) {
+                    endRecord(p);
+                }
+                break;
+            }
+
+            case ST_DONE:
+            default:
+                // Data past the end of the patch
+                p->error = DELTA_ERR_FORMAT;
+                break;
+        }
+    }
+
+    return p->error;
+}
+
+/**
+ * Flush and check completion
+ */
+DeltaResult_t delta_patch_finish(DeltaPatch_t* p) {
+    if (p->error != DELTA_OK) {
+        return p->error;
+    }
+    if (p->state != ST_DONE) {
+        p->error = DELTA_ERR_TRUNCATED;
+        return p->error;
+    }
+    flushOut(p);
+    return p->error;
+}
+
+uint32_t delta_patch_get_new_size(const DeltaPatch_t* p) {
+    return (p->headerLen == DELTA_HEADER_SIZE) ? p->newSize : 0;
+}
+
+uint32_t delta_patch_get_progress(const DeltaPatch_t* p) {
+    return p->newPos;
+}
+
+const char* delta_patch_get_error_name(DeltaResult_t result) {
+    switch (result) {
+        case DELTA_OK:            return "OK";
+        case DELTA_ERR_MAGIC:     return "Not a delta patch";
+        case DELTA_ERR_FORMAT:    return "Malformed patch";
+        case DELTA_ERR_RANGE:     return "Patch out of range for this image";
+        case DELTA_ERR_READ:      return "Old image read failed";
+        case DELTA_ERR_WRITE:     return "Write failed";
+        case DELTA_ERR_TRUNCATED: return "Patch truncated";
+        default:                  return "Unknown";
+    }
+}
+
+// ===== INTERNAL FUNCTIONS =====
+
+/**
+ * Accumulate one LEB128 byte; true when the value is complete
+ */
+static bool readVarint(DeltaPatch_t* p, uint8_t b, uint32_t* value) {
+    if (p->varintShift > 28 || (p->varintShift == 28 && (b & 0x70))) {
+        p->error = DELTA_ERR_FORMAT;
+        return false;
+    }
+    p->varint |= (uint32_t)(b & 0x7F) << p->varintShift;
+    if (b & 0x80) {
+        p->varintShift += 7;
+        return false;
+    }
+    *value = p->varint;
+    p->varint = 0;
+    p->varintShift = 0;
+    return true;
+}
+
+/**
+ * Refill old-image read-ahead at oldPos
+ */
+static bool fillOld(DeltaPatch_t* p) {
+    if (p->oldPos >= p->oldSize) {
+        p->error = DELTA_ERR_RANGE;
+        return false;
+    }
+    uint32_t n = p->oldSize - p->oldPos;
+    if (n > DELTA_OLD_BUF_SIZE) n = DELTA_OLD_BUF_SIZE;
+
+    if (!p->readOld(p->ctx, p->oldPos, p->oldBuf, n)) {
+        p->error = DELTA_ERR_READ;
+        return false;
+    }
+    p->oldBufStart = p->oldPos;
+    p->oldBufLen = (uint16_t)n;
+    return true;
+}
+
+/**
+ * Hand buffered output to the write callback
+ */
+static bool flushOut(DeltaPatch_t* p) {
+    if (p->outLen == 0) {
+        return true;
+    }
+    if (!p->write(p->ctx, p->outBuf, p->outLen)) {
+        p->error = DELTA_ERR_WRITE;
+        return false;
+    }
+    p->outLen = 0;
+    return true;
+}
+
+static bool emitByte(DeltaPatch_t* p, uint8_t b) {
+    p->outBuf[p->outLen++] = b;
+    p->newPos++;
+    if (p->outLen == DELTA_OUT_BUF_SIZE) {
+        return flushOut(p);
+    }
+    return true;
+}
+
+/**
+ * Copy n unchanged bytes from the old image
+ */
+static bool copyOld(DeltaPatch_t* p, uint32_t n) {
+    while (n > 0) {
+        if (p->oldPos < p->oldBufStart || p->oldPos >= p->oldBufStart + p->oldBufLen) {
+            if (!fillOld(p)) return false;
+        }
+        uint32_t avail = p->oldBufStart + p->oldBufLen - p->oldPos;
+        uint32_t room = DELTA_OUT_BUF_SIZE - p->outLen;
+        uint32_t take = n;
+        if (take > avail) take = avail;
+        if (take > room) take = room;
+
+        memcpy(p->outBuf + p->outLen, p->oldBuf + (p->oldPos - p->oldBufStart), take);
+        p->outLen += take;
+        p->oldPos += take;
+        p->newPos += take;
+        n -= take;
+
+        if (p->outLen == DELTA_OUT_BUF_SIZE && !flushOut(p)) return false;
+    }
+    return true;
+}
+
+/**
+ * Diff section complete - move on to extra bytes or the next record
+ */
+static void afterDiff(DeltaPatch_t* p) {
+    if (p->extraRemain > 0) {
+        p->state = ST_EXTRA;
+    } else {
+        endRecord(p);
+    }
+}
+
+/**
+ * Apply the record's seek and start the next record
+ */
+static void endRecord(DeltaPatch_t* p) {
+    int64_t pos = (int64_t)p->oldPos + p->seek;
+    if (pos < 0 || pos > (int64_t)p->oldSize) {
+        p->error = DELTA_ERR_RANGE;
+        return;
+    }
+    p->oldPos = (uint32_t)pos;
+    p->state = (p->newPos == p->newSize) ? ST_DONE : ST_DIFF_LEN;
+}
+
+static uint32_t readLe32(const uint8_t* b) {
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
@@ -0,0 +1,160 @@
+/**
+ * event_bus.cpp
+ * Typed Publish/Subscribe Event Bus Implementation
+ */
+
+#include "event_bus.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static_assert(EVENT_TOPIC_COUNT <= 32, "topic mask is 32 bits");
+
+// Subscriber ring
+typedef struct {
+    const char* name;
+    uint32_t topicMask;
+    Event_t queue[EVENT_QUEUE_DEPTH];
+    uint8_t head;             // Oldest pending event
+    uint8_t count;
+    uint32_t dropped;
+} Subscriber_t;
+
+static Subscriber_t subscribers[EVENT_MAX_SUBSCRIBERS];
+static int subscriberCount = 0;
+static uint32_t publishedCount = 0;
+
+// Publishers run on both the control task and loop()
+static SemaphoreHandle_t busMutex = nullptr;
+
+/**
+ * Initialize event bus
+ */
+void event_bus_init(void) {
+    if (!busMutex) {
+        busMutex = xSemaphoreCreateMutex();
+    }
+    memset(subscribers, 0, sizeof(subscribers));
+    subscriberCount = 0;
+    publishedCount = 0;
+}
+
+/**
+ * Register a subscriber
+ */
+int event_bus_subscribe(uint32_t topicMask, const char* name) {
+    int id = -1;
+
+    if (busMutex) xSemaphoreTake(busMutex, portMAX_DELAY);
+    if (subscriberCount < EVENT_MAX_SUBSCRIBERS) {
+        id = subscriberCount++;
+        subscribers[id].name = name;
+        subscribers[id].topicMask = topicMask;
+        subscribers[id].head = 0;
+        subscribers[id].count = 0;
+        subscribers[id].dropped = 0;
+    }
+    if (busMutex) xSemaphoreGive(busMutex);
+
+    if (id < 0) {
+        Serial.printf("[EventBus] No subscriber slot for %s\n", name ? name : "?");
+    }
+    return id;
+}
+
+/**
+ * Publish an event
+ */
+int event_bus_publish(Event_t* event) {
+    if (!event || event->topic >= EVENT_TOPIC_COUNT) {
+        return 0;
+    }
+    event->timestamp = millis();
+    uint32_t bit = EVENT_MASK(event->topic);
+    int delivered = 0;
+
+    if (busMutex) xSemaphoreTake(busMutex, portMAX_DELAY);
+    for (int i = 0; i < subscriberCount; i++) {
+        Subscriber_t* sub = &subscribers[i];
+        if (!(sub->topicMask & bit)) {
+            continue;
+        }
+
+        if (sub->count == EVENT_QUEUE_DEPTH) {
+            // Full: overwrite the oldest
+            sub->head = (sub->head + 1) % EVENT_QUEUE_DEPTH;
+            sub->count--;
+            sub->dropped++;
+        }
+        uint8_t tail = (sub->head + sub->count) % EVENT_QUEUE_DEPTH;
+        memcpy(&sub->queue[tail], event, sizeof(Event_t));
+        sub->count++;
+        delivered++;
+    }
+    publishedCount++;
+    if (busMutex) xSemaphoreGive(busMutex);
+
+    return delivered;
+}
+
+/**
+ * Take the oldest pending event
+ */
+bool event_bus_poll(int subscriber, Event_t* event) {
+    if (subscriber < 0 || subscriber >= subscriberCount || !event) {
+        return false;
+    }
+    Subscriber_t* sub = &subscribers[subscriber];
+
+    // Cheap unlocked check - most polls find nothing
+    if (__atomic_load_n(&sub->count, __ATOMIC_ACQUIRE) == 0) {
+        return false;
+    }
+
+    bool found = false;
+    if (busMutex) xSemaphoreTake(busMutex, portMAX_DELAY);
+    if (sub->count > 0) {
+        memcpy(event, &sub->queue[sub->head], sizeof(Event_t));
+        sub->head = (sub->head + 1) % EVENT_QUEUE_DEPTH;
+        sub->count--;
+        found = true;
+    }
+    if (busMutex) xSemaphoreGive(busMutex);
+
+    return found;
+}
+
+uint32_t event_bus_get_dropped(int subscriber) {
+    if (subscriber < 0 || subscriber >= subscriberCount) {
+        return 0;
+    }
+    return subscribers[subscriber].dropped;
+}
+
+uint32_t event_bus_get_published(void) {
+    return publishedCount;
+}
+
+int event_bus_get_subscriber_count(void) {
+    return subscriberCount;
+}
+
+const char* event_bus_get_subscriber_name(int subscriber) {
+    if (subscriber < 0 || subscriber >= subscriberCount) {
+        return nullptr;
+    }
+    return subscribers[subscriber].name;
+}
+
+/**
+ * Get topic name
+ */
+const char* event_bus_get_topic_name(EventTopic_t topic) {
+    switch (topic) {
+        case EVENT_OUTPUT_STATE:   return "output";
+        case EVENT_SENSOR_HEALTH:  return "sensor";
+        case EVENT_NETWORK_STATUS: return "network";
+        case EVENT_MQTT_STATUS:    return "mqtt";
+        case EVENT_SAFETY:         return "safety";
+        default:                   return "unknown";
+    }
+}
@@ -0,0 +1,247 @@
+/**
+ * event_log.cpp
+ * Packed Event Store Implementation
+ */
+
+#include "event_log.h"
+#include <string.h>
+
+#define RECORD_FIXED 2    // len + tag
+
+// ===== RING HELPERS =====
+
+static uint8_t byteAt(const EventLog_t* log, uint32_t offset) {
+    return log->buf[offset % log->size];
+}
+
+static void putByte(EventLog_t* log, uint32_t offset, uint8_t value) {
+    log->buf[offset % log->size] = value;
+}
+
+static uint8_t recordLen(const EventLog_t* log, uint32_t offset) {
+    return byteAt(log, offset) & ~EVENT_LOG_PACKED;
+}
+
+/**
+ * Read a varint at an offset
+ * @return Bytes it used
+ */
+static uint32_t readVarint(const EventLog_t* log, uint32_t offset, uint32_t* value) {
+    uint32_t v = 0;
+    uint32_t n = 0;
+    uint8_t b;
+    do {
+        b = byteAt(log, offset + n);
+        v |= (uint32_t)(b & 0x7F) << (7 * n);
+        n++;
+    } while ((b & 0x80) && n < 5);
+    *value = v;
+    return n;
+}
+
+static uint32_t varintSize(uint32_t v) {
+    uint32_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * Time delta of the record at an offset
+ */
+static uint32_t recordDelta(const EventLog_t* log, uint32_t offset) {
+    uint32_t dt;
+    readVarint(log, offset + RECORD_FIXED, &dt);
+    return dt;
+}
+
+static void countViews(EventLog_t* log, uint8_t tag, int delta) {
+    for (int v = 0; v < EVENT_LOG_VIEWS; v++) {
+        if (tag & (0x10 << v)) {
+            log->viewCount[v] += delta;
+        }
+    }
+}
+
+/**
+ * Drop the oldest record
+ */
+static void dropOldest(EventLog_t* log) {
+    uint8_t len = recordLen(log, log->head);
+    countViews(log, byteAt(log, log->head + 1), -1);
+    log->head = (log->head + len) % log->size;
+    log->used -= len;
+    log->count--;
+    log->firstSeq++;
+    if (log->count > 0) {
+        log->firstTime += recordDelta(log, log->head);
+    }
+}
+
+// ===== STORE =====
+
+/**
+ * Initialize a store
+ */
+void event_log_init(EventLog_t* log, uint8_t* buf, uint32_t size) {
+    memset(log, 0, sizeof(*log));
+    log->buf = buf;
+    log->size = size;
+}
+
+/**
+ * Append a text or packed body
+ */
+static uint32_t appendRecord(EventLog_t* log, uint8_t type, uint8_t views, uint32_t timeSec,
+                             const uint8_t* body, size_t textLen, bool packed) {
+    uint32_t dt = 0;
+    if (log->count > 0 && timeSec > log->lastTime) {
+        dt = timeSec - log->lastTime;
+    }
+    uint32_t dtLen = varintSize(dt);
+    uint32_t len = RECORD_FIXED + dtLen + (uint32_t)textLen;
+    if (len > log->size) {
+        return log->nextSeq;   // Only with a buffer smaller than one record
+    }
+
+    while (log->size - log->used < len) {
+        dropOldest(log);
+    }
+
+    if (log->count == 0) {
+        log->head = 0;
+        log->firstTime = timeSec;
+        log->lastTime = timeSec;
+    } else {
+        log->lastTime += dt;
+    }
+
+    uint32_t offset = log->head + log->used;
+    uint8_t tag = (uint8_t)((views & 0x0F) << 4 | (type & 0x0F));
+    putByte(log, offset, (uint8_t)(len | (packed ? EVENT_LOG_PACKED : 0)));
+    putByte(log, offset + 1, tag);
+    offset += RECORD_FIXED;
+    uint32_t v = dt;
+    for (uint32_t i = 0; i < dtLen; i++, v >>= 7) {
+        putByte(log, offset++, (uint8_t)((v & 0x7F) | (i + 1 < dtLen ? 0x80 : 0)));
+    }
+    for (size_t i = 0; i < textLen; i++) {
+        putByte(log, offset++, body[i]);
+    }
+
+    log->used += len;
+    log->count++;
+    countViews(log, tag, 1);
+    return log->nextSeq++;
+}
+
+/**
+ * Append a record
+ */
+uint32_t event_log_append(EventLog_t* log, uint8_t type, uint8_t views, uint32_t timeSec, const char* text) {
+    return appendRecord(log, type, views, timeSec, (const uint8_t*)text, strnlen(text, EVENT_LOG_MAX_TEXT), false);
+}
+
+/**
+ * Append a packed record
+ */
+uint32_t event_log_append_packed(EventLog_t* log, uint8_t type, uint8_t views, uint32_t timeSec,
+                                 const uint8_t* data, size_t length) {
+    if (length > EVENT_LOG_MAX_TEXT) {
+        length = EVENT_LOG_MAX_TEXT;
+    }
+    return appendRecord(log, type, views, timeSec, data, length, true);
+}
+
+/**
+ * Copy the first matching record at or after a cursor
+ */
+bool event_log_read(EventLog_t* log, uint32_t* cursor, uint8_t views, uint32_t typeMask, EventLogRecord_t* out) {
+    uint32_t want = *cursor;
+    if ((int32_t)(want - log->firstSeq) < 0) {
+        want = log->firstSeq;
+    }
+    if ((int32_t)(log->nextSeq - want) <= 0) {
+        *cursor = log->nextSeq;
+        return false;
+    }
+
+    // Start from the hint if it is still held and not past the cursor
+    uint32_t seq = log->firstSeq;
+    uint32_t offset = log->head;
+    uint32_t time = log->firstTime;
+    if ((int32_t)(log->hintSeq - log->firstSeq) >= 0 && (int32_t)(log->nextSeq - log->hintSeq) > 0 &&
+        (int32_t)(want - log->hintSeq) >= 0) {
+        seq = log->hintSeq;
+        offset = log->hintOffset;
+        time = log->hintTime;
+    }
+
+    // offset/time describe record seq, which exists while seq != nextSeq
+    bool found = false;
+    while (seq != log->nextSeq) {
+        uint8_t lenByte = byteAt(log, offset);
+        uint8_t len = lenByte & ~EVENT_LOG_PACKED;
+        uint8_t tag = byteAt(log, offset + 1);
+        bool match = (int32_t)(seq - want) >= 0 && ((tag >> 4) & views) &&
+                     (typeMask & (1UL << (tag & 0x0F)));
+        if (match) {
+            uint32_t dt;
+            uint32_t textStart = RECORD_FIXED + readVarint(log, offset + RECORD_FIXED, &dt);
+            uint32_t textLen = len - textStart;
+            for (uint32_t i = 0; i < textLen; i++) {
+                out->text[i] = (char)byteAt(log, offset + textStart + i);
+            }
+            out->text[textLen] = '\0';
+            out->length = (uint8_t)textLen;
+            out->packed = (lenByte & EVENT_LOG_PACKED) != 0;
+            out->seq = seq;
+            out->timeSec = time;
+            out->type = tag & 0x0F;
+            out->views = tag >> 4;
+            found = true;
+        }
+
+        seq++;
+        offset = (offset + len) % log->size;
+        if (seq != log->nextSeq) {
+            time += recordDelta(log, offset);
+        }
+        if (found) {
+            break;
+        }
+    }
+
+    if (seq != log->nextSeq) {
+        log->hintSeq = seq;
+        log->hintOffset = offset;
+        log->hintTime = time;
+    }
+    *cursor = seq;
+    return found;
+}
+
+/**
+ * Count records in a view
+ */
+int event_log_count(const EventLog_t* log, uint8_t view) {
+    for (int v = 0; v < EVENT_LOG_VIEWS; v++) {
+        if (view == (1 << v)) {
+            return log->viewCount[v];
+        }
+    }
+    return 0;
+}
+
+/**
+ * Remove all records
+ */
+void event_log_clear(EventLog_t* log) {
+    log->head = 0;
+    log->used = 0;
+    log->count = 0;
+    log->firstSeq = log->nextSeq;
+    memset(log->viewCount, 0, sizeof(log->viewCount));
+}
@@ -0,0 +1,270 @@
+/**
+ * heap_monitor.cpp
+ * Heap and Fragmentation Tracker Implementation
+ */
+
+#include "heap_monitor.h"
+#include "console.h"
+#include "time_service.h"
+#include <esp_heap_caps.h>
+
+// Trend ring buffer
+static HeapSample_t trend[HEAP_TREND_POINTS];
+static int trendCount = 0;
+static int trendIndex = 0;
+static HeapSample_t latest = {0, 0, 0};
+static unsigned long lastSample = 0;
+static uint32_t minLargestBlock = 0xFFFFFFFF;
+
+// Low-block alert
+static bool lowBlock = false;
+static HeapAlertCallback_t alertCallback = nullptr;
+
+// Call-site tracking (debug builds)
+static HeapTrackSite_t sites[HEAP_MAX_TRACK_SITES];
+static int siteCount = 0;
+
+// Allocation counter (fed by the malloc wrappers in tracking builds)
+static volatile uint32_t allocCount = 0;
+
+// Forward declarations
+static void takeSample(void);
+static void checkThreshold(void);
+
+/**
+ * Initialize heap monitor
+ */
+void heap_monitor_init(void) {
+    trendCount = 0;
+    trendIndex = 0;
+    siteCount = 0;
+    lowBlock = false;
+    minLargestBlock = 0xFFFFFFFF;
+
+    takeSample();
+    lastSample = millis();
+
+    Serial.printf("[HeapMon] Free %lu, largest block %lu (%u%% fragmented)\n",
+                 (unsigned long)latest.freeBytes, (unsigned long)latest.largestBlock,
+                 heap_monitor_get_fragmentation(&latest));
+}
+
+/**
+ * Periodic sampling
+ */
+void heap_monitor_task(void) {
+    if (millis() - lastSample < HEAP_SAMPLE_INTERVAL_MS) {
+        return;
+    }
+    lastSample = millis();
+
+    takeSample();
+    checkThreshold();
+}
+
+/**
+ * Get most recent sample
+ */
+const HeapSample_t* heap_monitor_get_latest(void) {
+    return &latest;
+}
+
+/**
+ * Get trend sample (oldest first)
+ */
+const HeapSample_t* heap_monitor_get_sample(int index) {
+    if (index < 0 || index >= trendCount) {
+        return nullptr;
+    }
+    int start = (trendCount < HEAP_TREND_POINTS) ? 0 : trendIndex;
+    return &trend[(start + index) % HEAP_TREND_POINTS];
+}
+
+/**
+ * Get number of trend samples
+ */
+int heap_monitor_get_sample_count(void) {
+    return trendCount;
+}
+
+/**
+ * Calculate fragmentation
+ */
+uint8_t heap_monitor_get_fragmentation(const HeapSample_t* sample) {
+    if (!sample || sample->freeBytes == 0) {
+        return 0;
+    }
+    return 100 - (uint8_t)((uint64_t)sample->largestBlock * 100 / sample->freeBytes);
+}
+
+/**
+ * Least-squares slope of free heap over the trend window
+ */
+int32_t heap_monitor_get_trend_bytes_per_hour(void) {
+    if (trendCount < 3) {
+        return 0;
+    }
+
+    // Centre x on the first sample to keep the sums small
+    const HeapSample_t* first = heap_monitor_get_sample(0);
+    double sumX = 0, sumY = 0, sumXY = 0, sumXX = 0;
+    for (int i = 0; i < trendCount; i++) {
+        const HeapSample_t* s = heap_monitor_get_sample(i);
+        double x = (double)(s->uptimeSec - first->uptimeSec);
+        double y = (double)s->freeBytes;
+        sumX += x;
+        sumY += y;
+        sumXY += x * y;
+        sumXX += x * x;
+    }
+
+    double n = trendCount;
+    double denom = n * sumXX - sumX * sumX;
+    if (denom <= 0) {
+        return 0;
+    }
+    double bytesPerSec = (n * sumXY - sumX * sumY) / denom;
+    return (int32_t)(bytesPerSec * 3600.0);
+}
+
+/**
+ * Get minimum largest block since boot
+ */
+uint32_t heap_monitor_get_min_largest_block(void) {
+    return minLargestBlock;
+}
+
+/**
+ * Check low-block alert
+ */
+bool heap_monitor_is_low(void) {
+    return lowBlock;
+}
+
+/**
+ * Set alert callback
+ */
+void heap_monitor_set_alert_callback(HeapAlertCallback_t callback) {
+    alertCallback = callback;
+}
+
+/**
+ * Get tracked site count
+ */
+int heap_monitor_get_site_count(void) {
+    return siteCount;
+}
+
+/**
+ * Get tracked site
+ */
+const HeapTrackSite_t* heap_monitor_get_site(int index) {
+    if (index < 0 || index >= siteCount) {
+        return nullptr;
+    }
+    return &sites[index];
+}
+
+/**
+ * Record one tracked scope
+ */
+void heap_monitor_record_site(const char* tag, uint32_t freeBefore, uint32_t freeAfter) {
+    // Tags are string literals, so pointer comparison is enough
+    HeapTrackSite_t* site = nullptr;
+    for (int i = 0; i < siteCount; i++) {
+        if (sites[i].tag == tag) {
+            site = &sites[i];
+            break;
+        }
+    }
+    if (!site) {
+        if (siteCount >= HEAP_MAX_TRACK_SITES) {
+            return;
+        }
+        site = &sites[siteCount++];
+        site->tag = tag;
+        site->calls = 0;
+        site->netBytes = 0;
+        site->maxRetained = 0;
+    }
+
+    int32_t retained = (int32_t)freeBefore - (int32_t)freeAfter;
+    site->calls++;
+    site->netBytes += retained;
+    if (retained > site->maxRetained) {
+        site->maxRetained = retained;
+    }
+}
+
+/**
+ * Get allocation count
+ */
+uint32_t heap_monitor_get_alloc_count(void) {
+    return allocCount;
+}
+
+#if HEAP_TRACKING_ENABLED
+
+// Linker --wrap hooks: every call to malloc/calloc/realloc lands here first
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    __atomic_add_fetch(&allocCount, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    __atomic_add_fetch(&allocCount, 1, __ATOMIC_RELAXED);
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    __atomic_add_fetch(&allocCount, 1, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+}
+
+#endif // HEAP_TRACKING_ENABLED
+
+// ===== INTERNAL FUNCTIONS =====
+
+/**
+ * Take one sample into the trend ring
+ */
+static void takeSample(void) {
+    latest.uptimeSec = time_service_uptime_sec();
+    latest.freeBytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    latest.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+
+    if (latest.largestBlock < minLargestBlock) {
+        minLargestBlock = latest.largestBlock;
+    }
+
+    trend[trendIndex] = latest;
+    trendIndex = (trendIndex + 1) % HEAP_TREND_POINTS;
+    if (trendCount < HEAP_TREND_POINTS) {
+        trendCount++;
+    }
+}
+
+/**
+ * Raise/clear low-block alert with hysteresis
+ */
+static void checkThreshold(void) {
+    if (!lowBlock && latest.largestBlock < HEAP_LOW_BLOCK_THRESHOLD) {
+        lowBlock = true;
+        console_add_event_f(CONSOLE_EVENT_ERROR, "HEAP: largest block %lu < %u (free %lu, %u%% frag)",
+                           (unsigned long)latest.largestBlock, HEAP_LOW_BLOCK_THRESHOLD,
+                           (unsigned long)latest.freeBytes, heap_monitor_get_fragmentation(&latest));
+        if (alertCallback) {
+            alertCallback(latest.largestBlock, latest.freeBytes);
+        }
+    } else if (lowBlock && latest.largestBlock >= HEAP_LOW_BLOCK_THRESHOLD + HEAP_LOW_BLOCK_HYSTERESIS) {
+        lowBlock = false;
+        console_add_event_f(CONSOLE_EVENT_SYSTEM, "HEAP: largest block recovered (%lu)",
+                           (unsigned long)latest.largestBlock);
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * history_bulk.cpp
+ * Compact Binary History Transfer Implementation
+ */
+
+#include "history_bulk.h"
+#include "frame_codec.h"
+#include <string.h>
+
+#define DT_ABSOLUTE 0xFFFF
+
+/**
+ * Encode the response header
+ */
+void history_bulk_encode_header(const HistoryBulkHeader_t* header, uint8_t* buf) {
+    buf[0] = 'T';
+    buf[1] = 'H';
+    buf[2] = HISTORY_BULK_VERSION;
+    buf[3] = header->flags;
+    frame_put32(buf + 4, header->bootId);
+    frame_put32(buf + 8, header->firstSeq);
+    frame_put32(buf + 12, header->nextSeq);
+    frame_put32(buf + 16, header->baseTime);
+    frame_put16(buf + 20, header->count);
+    frame_put16(buf + 22, header->intervalSec);
+}
+
+/**
+ * Encode one point
+ */
+size_t history_bulk_encode_point(uint32_t* prevTime, uint32_t timestamp, float temperature, uint8_t* buf) {
+    int16_t temp = frame_encode_temp(temperature);
+    bool jump = timestamp < *prevTime || timestamp - *prevTime >= DT_ABSOLUTE;
+    uint32_t dt = timestamp - *prevTime;
+    *prevTime = timestamp;
+
+    // Backwards or long jumps (clock set, long outage) carry the full time
+    if (jump) {
+        frame_put16(buf, DT_ABSOLUTE);
+        frame_put32(buf + 2, timestamp);
+        frame_put16(buf + 6, (uint16_t)temp);
+        return 8;
+    }
+    frame_put16(buf, (uint16_t)dt);
+    frame_put16(buf + 2, (uint16_t)temp);
+    return 4;
+}
+
+/**
+ * Decode a response
+ */
+int history_bulk_decode(const uint8_t* buf, size_t len, HistoryBulkHeader_t* header,
+                        uint32_t* times, float* temps, int max) {
+    if (len < HISTORY_BULK_HEADER_SIZE || buf[0] != 'T' || buf[1] != 'H' || buf[2] != HISTORY_BULK_VERSION) {
+        return -1;
+    }
+    memset(header, 0, sizeof(*header));
+    header->flags = buf[3];
+    header->bootId = frame_get32(buf + 4);
+    header->firstSeq = frame_get32(buf + 8);
+    header->nextSeq = frame_get32(buf + 12);
+    header->baseTime = frame_get32(buf + 16);
+    header->count = frame_get16(buf + 20);
+    header->intervalSec = frame_get16(buf + 22);
+    if (!times) {
+        return 0;
+    }
+    if (header->count > max) {
+        return -1;
+    }
+
+    size_t pos = HISTORY_BULK_HEADER_SIZE;
+    uint32_t t = header->baseTime;
+    for (int i = 0; i < header->count; i++) {
+        if (pos + 4 > len) {
+            return -1;
+        }
+        uint16_t dt = frame_get16(buf + pos);
+        if (dt == DT_ABSOLUTE) {
+            if (pos + 8 > len) {
+                return -1;
+            }
+            t = frame_get32(buf + pos + 2);
+            pos += 6;
+        } else {
+            t += dt;
+            pos += 2;
+        }
+        int16_t temp = (int16_t)frame_get16(buf + pos);
+        pos += 2;
+        times[i] = t;
+        temps[i] = frame_decode_temp(temp);
+    }
+    return pos == len ? header->count : -1;
+}
@@ -0,0 +1,132 @@
+/**
+ * loop_profiler.cpp
+ * Main-Loop Subsystem Profiler Implementation
+ */
+
+#include "loop_profiler.h"
+#include "console.h"
+
+#if LOOP_PROFILER_ENABLED
+
+// Per-section statistics (~150 bytes each)
+static ProfilerStats_t stats[PROF_SECTION_COUNT];
+static unsigned long windowStart = 0;
+
+void profiler_record(ProfilerSection_t section, uint32_t cycles) {
+    if ((unsigned)section >= PROF_SECTION_COUNT) {
+        return;
+    }
+
+    ProfilerStats_t* s = &stats[section];
+
+    // Bucket = position of highest set bit (log2)
+    int bucket = cycles ? 31 - __builtin_clz(cycles) : 0;
+    s->buckets[bucket]++;
+
+    if (s->count == 0 || cycles < s->minCycles) s->minCycles = cycles;
+    if (cycles > s->maxCycles) s->maxCycles = cycles;
+    s->totalCycles += cycles;
+    s->count++;
+}
+
+void profiler_reset(void) {
+    memset(stats, 0, sizeof(stats));
+    windowStart = millis();
+}
+
+const ProfilerStats_t* profiler_get_stats(ProfilerSection_t section) {
+    if ((unsigned)section >= PROF_SECTION_COUNT) {
+        return nullptr;
+    }
+    return &stats[section];
+}
+
+uint32_t profiler_get_percentile_us(ProfilerSection_t section, uint8_t percentile) {
+    const ProfilerStats_t* s = profiler_get_stats(section);
+    if (!s || s->count == 0) {
+        return 0;
+    }
+    if (percentile > 100) percentile = 100;
+
+    // Rank of the sample we are looking for (1-based, rounded up)
+    uint32_t rank = (uint32_t)(((uint64_t)s->count * percentile + 99) / 100);
+    if (rank == 0) rank = 1;
+
+    uint32_t seen = 0;
+    for (int i = 0; i < PROFILER_BUCKETS; i++) {
+        seen += s->buckets[i];
+        if (seen >= rank) {
+            // Upper edge of bucket, but never report beyond observed range
+            uint64_t upper = (i >= 31) ? 0xFFFFFFFFULL : ((1ULL << (i + 1)) - 1);
+            if (upper > s->maxCycles) upper = s->maxCycles;
+            if (upper < s->minCycles) upper = s->minCycles;
+            return profiler_cycles_to_us(upper);
+        }
+    }
+
+    return profiler_cycles_to_us(s->maxCycles);
+}
+
+unsigned long profiler_get_window_ms(void) {
+    return millis() - windowStart;
+}
+
+void profiler_log_summary(void) {
+    console_add_event_f(CONSOLE_EVENT_DEBUG, "PERF: %lus window (us: min/p50/p99/max)",
+                        profiler_get_window_ms() / 1000);
+
+    for (int i = 0; i < PROF_SECTION_COUNT; i++) {
+        const ProfilerStats_t* s = &stats[i];
+        if (s->count == 0) {
+            continue;
+        }
+        ProfilerSection_t section = (ProfilerSection_t)i;
+        console_add_event_f(CONSOLE_EVENT_DEBUG, "PERF %-8s n=%lu %lu/%lu/%lu/%lu",
+                            profiler_get_section_name(section),
+                            (unsigned long)s->count,
+                            (unsigned long)profiler_cycles_to_us(s->minCycles),
+                            (unsigned long)profiler_get_percentile_us(section, 50),
+                            (unsigned long)profiler_get_percentile_us(section, 99),
+                            (unsigned long)profiler_cycles_to_us(s->maxCycles));
+    }
+}
+
+bool profiler_is_enabled(void) {
+    return true;
+}
+
+#else
+
+void profiler_record(ProfilerSection_t section, uint32_t cycles) {}
+void profiler_reset(void) {}
+const ProfilerStats_t* profiler_get_stats(ProfilerSection_t section) { return nullptr; }
+uint32_t profiler_get_percentile_us(ProfilerSection_t section, uint8_t percentile) { return 0; }
+unsigned long profiler_get_window_ms(void) { return 0; }
+void profiler_log_summary(void) {}
+bool profiler_is_enabled(void) { return false; }
+
+#endif // LOOP_PROFILER_ENABLED
+
+uint32_t profiler_cycles_to_us(uint64_t cycles) {
+    return (uint32_t)profiler_cycles_to_us64(cycles);
+}
+
+uint64_t profiler_cycles_to_us64(uint64_t cycles) {
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    if (mhz == 0) mhz = 240;
+    return cycles / mhz;
+}
+
+const char* profiler_get_section_name(ProfilerSection_t section) {
+    switch (section) {
+        case PROF_LOOP_TOTAL:      return "loop";
+        case PROF_WIFI:            return "wifi";
+        case PROF_MQTT:            return "mqtt";
+        case PROF_WEBSERVER:       return "web";
+        case PROF_DISPLAY:         return "display";
+        case PROF_SENSORS:         return "sensors";
+        case PROF_OUTPUTS:         return "outputs";
+        case PROF_MQTT_PUBLISH:    return "mqtt_pub";
+        default:                   return "unknown";
+    }
+}
@@ -2,12 +2,16 @@
  * safety_manager.cpp
  * System-level Safety Management
  *
- * Implements hardware watchdog, boot loop detection, and safe mode
+ * Implements hardware watchdog, boot loop detection, safe mode,
+ * and per-subsystem heartbeat supervision
  */
 
 #include "safety_manager.h"
 #include "output_manager.h"
 #include "console.h"
+#include "crash_log.h"
+#include "ota_manager.h"
+#include "event_bus.h"
 #include <Preferences.h>
 #include <esp_task_wdt.h>
 
@@ -19,7 +23,8 @@
 #define KEY_LAST_BOOT "last_boot"
 #define KEY_SAFE_MODE "safe_mode"
 #define KEY_SAFE_REASON "safe_reason"
-#define KEY_WDT_RESET "wdt_reset"
+#define KEY_HB_STALL "hb_stall"         // Last stalled subsystem (id + 1, 0 = none)
+#define KEY_HB_STALL_CNT "hb_stall_cnt" // Total stalls recorded
 
 // Internal state
 static SafetyState_t safetyState = {
@@ -29,15 +34,23 @@ static SafetyState_t safetyState = {
     .lastBootTime = 0,
     .stableTime = 0,
     .watchdogEnabled = false,
-    .lastWatchdogFeed = 0
+    .lastWatchdogFeed = 0,
+    .outputsHeldSafe = false,
+    .lastStallId = -1,
+    .stallCount = 0
 };
 
+// Heartbeat registry
+static HeartbeatInfo_t heartbeats[HEARTBEAT_COUNT];
+
 // Forward declarations
 static void loadSafetyState(void);
 static void saveSafetyState(void);
 static void checkBootLoop(void);
 static void initWatchdog(void);
 static void enterSafeMode(SafeModeReason_t reason);
+static void recordStall(HeartbeatId_t id, unsigned long lateMs);
+static void publishSafetyEvent(SafetyEventKind_t kind);
 
 /**
  * Initialize safety manager
@@ -48,19 +61,26 @@ bool safety_manager_init(void) {
     // Load previous state from NVS
     loadSafetyState();
 
-    // Check if watchdog triggered last boot
-    Preferences prefs;
-    prefs.begin(SAFETY_NAMESPACE, false);
-    bool wdtReset = prefs.getBool(KEY_WDT_RESET, false);
-    if (wdtReset) {
+    // Check if watchdog triggered last boot (reset reason captured by crash_log_init)
+    uint8_t resetReason = crash_log_get_reset_reason();
+    if (crash_log_is_watchdog(resetReason)) {
         Serial.println("[SafetyMgr] WARNING: Previous boot ended by watchdog!");
-        prefs.putBool(KEY_WDT_RESET, false);  // Clear flag
-        console_add_event(CONSOLE_EVENT_SYSTEM, "WATCHDOG: Previous boot timed out");
+        console_add_event_f(CONSOLE_EVENT_SYSTEM, "WATCHDOG: Previous boot timed out (%s)",
+                           crash_log_get_reset_reason_name(resetReason));
 
         // Increment boot count for watchdog-caused reboot
         safetyState.bootCount++;
+    } else if (crash_log_is_abnormal(resetReason)) {
+        console_add_event_f(CONSOLE_EVENT_SYSTEM, "RESET: Previous boot ended by %s",
+                           crash_log_get_reset_reason_name(resetReason));
+    }
+
+    // Report subsystem stall recorded on a previous boot
+    if (safetyState.lastStallId >= 0) {
+        console_add_event_f(CONSOLE_EVENT_SYSTEM, "HEARTBEAT: last stall was %s (%u total)",
+                           safety_manager_get_heartbeat_name((HeartbeatId_t)safetyState.lastStallId),
+                           safetyState.stallCount);
     }
-    prefs.end();
 
     // Check for boot loop
     checkBootLoop();
@@ -98,6 +118,19 @@ void safety_manager_feed_watchdog(void) {
     }
 }
 
+/**
+ * Subscribe calling task to watchdog
+ */
+void safety_manager_watchdog_subscribe(void) {
+    if (!safetyState.watchdogEnabled) {
+        return;
+    }
+    esp_err_t err = esp_task_wdt_add(NULL);
+    if (err != ESP_OK) {
+        Serial.printf("[SafetyMgr] Failed to subscribe task to watchdog: %d\n", err);
+    }
+}
+
 /**
  * Mark boot as stable
  */
@@ -109,6 +142,12 @@ void safety_manager_mark_stable(void) {
 
         Serial.println("[SafetyMgr] Boot marked as stable - boot counter reset");
         console_add_event(CONSOLE_EVENT_SYSTEM, "Boot stable - safety counters reset");
+
+        // ota_manager_task() confirms a freshly updated image once it is
+        // actually regulating, and rolls it back if it never is
+        if (ota_manager_is_pending_verify() && (safetyState.safeMode || safetyState.outputsHeldSafe)) {
+            console_add_event(CONSOLE_EVENT_ERROR, "OTA: image not confirmed yet (safe mode or stalled control)");
+        }
     }
 }
 
@@ -173,6 +212,7 @@ bool safety_manager_exit_safe_mode(void) {
 
     console_add_event(CONSOLE_EVENT_SYSTEM, "Exited safe mode");
     Serial.println("[SafetyMgr] Exited safe mode");
+    publishSafetyEvent(SAFETY_EVENT_SAFE_MODE_EXIT);
 
     return true;
 }
@@ -189,6 +229,7 @@ void safety_manager_emergency_stop(void) {
         output_manager_set_mode(i, CONTROL_MODE_OFF);
         output_manager_set_manual_power(i, 0);
     }
+    publishSafetyEvent(SAFETY_EVENT_EMERGENCY_STOP);
 }
 
 /**
@@ -222,6 +263,107 @@ unsigned long safety_manager_get_watchdog_margin(void) {
     return millis() - safetyState.lastWatchdogFeed;
 }
 
+/**
+ * Register a subsystem for heartbeat supervision
+ */
+void safety_manager_register_heartbeat(HeartbeatId_t id, uint32_t periodMs) {
+    if (id < 0 || id >= HEARTBEAT_COUNT || periodMs == 0) {
+        return;
+    }
+
+    HeartbeatInfo_t* hb = &heartbeats[id];
+    hb->periodMs = periodMs;
+    hb->lastBeat = millis();
+    hb->stalled = false;
+    hb->registered = true;
+
+    Serial.printf("[SafetyMgr] Heartbeat registered: %s (%lums)\n",
+                 safety_manager_get_heartbeat_name(id), (unsigned long)periodMs);
+}
+
+/**
+ * Subsystem check-in
+ */
+void safety_manager_heartbeat(HeartbeatId_t id) {
+    if (id < 0 || id >= HEARTBEAT_COUNT) {
+        return;
+    }
+    heartbeats[id].lastBeat = millis();
+    heartbeats[id].beats++;
+}
+
+/**
+ * Check heartbeats for missed deadlines
+ */
+void safety_manager_check_heartbeats(void) {
+    unsigned long now = millis();
+    bool criticalStall = false;
+
+    for (int i = 0; i < HEARTBEAT_COUNT; i++) {
+        HeartbeatInfo_t* hb = &heartbeats[i];
+        if (!hb->registered) {
+            continue;
+        }
+
+        // lastBeat may be updated from another task after 'now' was taken
+        long age = (long)(now - hb->lastBeat);
+        if (age < 0) age = 0;
+        bool late = (unsigned long)age > hb->periodMs * HEARTBEAT_GRACE_FACTOR;
+
+        if (late && !hb->stalled) {
+            hb->stalled = true;
+            hb->stalls++;
+            recordStall((HeartbeatId_t)i, (unsigned long)age);
+        } else if (!late && hb->stalled) {
+            hb->stalled = false;
+            console_add_event_f(CONSOLE_EVENT_SYSTEM, "HEARTBEAT: %s recovered",
+                               safety_manager_get_heartbeat_name((HeartbeatId_t)i));
+        }
+
+        // Control and sensor stalls mean outputs are no longer being regulated
+        if (hb->stalled && (i == HEARTBEAT_CONTROL || i == HEARTBEAT_SENSORS)) {
+            criticalStall = true;
+        }
+    }
+
+    if (criticalStall && !safetyState.outputsHeldSafe) {
+        safetyState.outputsHeldSafe = true;
+        output_manager_set_safe_hold(true);
+        Serial.println("[SafetyMgr] Control/sensor stall - outputs forced OFF");
+        console_add_event(CONSOLE_EVENT_ERROR, "HEARTBEAT: outputs forced OFF");
+        publishSafetyEvent(SAFETY_EVENT_OUTPUTS_HELD);
+    } else if (!criticalStall && safetyState.outputsHeldSafe) {
+        safetyState.outputsHeldSafe = false;
+        output_manager_set_safe_hold(false);
+        Serial.println("[SafetyMgr] Control/sensor recovered - outputs released");
+        console_add_event(CONSOLE_EVENT_SYSTEM, "HEARTBEAT: outputs released");
+        publishSafetyEvent(SAFETY_EVENT_OUTPUTS_RELEASED);
+    }
+}
+
+/**
+ * Get heartbeat registry entry
+ */
+const HeartbeatInfo_t* safety_manager_get_heartbeat(HeartbeatId_t id) {
+    if (id < 0 || id >= HEARTBEAT_COUNT) {
+        return nullptr;
+    }
+    return &heartbeats[id];
+}
+
+/**
+ * Get heartbeat subsystem name
+ */
+const char* safety_manager_get_heartbeat_name(HeartbeatId_t id) {
+    switch (id) {
+        case HEARTBEAT_CONTROL: return "control";
+        case HEARTBEAT_SENSORS: return "sensors";
+        case HEARTBEAT_NETWORK: return "network";
+        case HEARTBEAT_DISPLAY: return "display";
+        default:                return "unknown";
+    }
+}
+
 // ===== INTERNAL FUNCTIONS =====
 
 /**
@@ -235,6 +377,8 @@ static void loadSafetyState(void) {
     safetyState.lastBootTime = prefs.getULong(KEY_LAST_BOOT, 0);
     safetyState.safeMode = prefs.getBool(KEY_SAFE_MODE, false);
     safetyState.safeModeReason = (SafeModeReason_t)prefs.getUChar(KEY_SAFE_REASON, 0);
+    safetyState.lastStallId = (int8_t)prefs.getUChar(KEY_HB_STALL, 0) - 1;
+    safetyState.stallCount = prefs.getUShort(KEY_HB_STALL_CNT, 0);
 
     prefs.end();
 }
@@ -304,11 +448,6 @@ static void initWatchdog(void) {
         Serial.printf("[SafetyMgr] Failed to init watchdog: %d\n", err);
     }
 
-    // Set flag so we can detect watchdog reset on next boot
-    Preferences prefs;
-    prefs.begin(SAFETY_NAMESPACE, false);
-    prefs.putBool(KEY_WDT_RESET, true);  // Will be cleared if normal shutdown
-    prefs.end();
 }
 
 /**
@@ -325,3 +464,35 @@ static void enterSafeMode(SafeModeReason_t reason) {
     // Force all outputs OFF
     safety_manager_emergency_stop();
 }
+
+/**
+ * Record a missed heartbeat deadline in NVS
+ */
+static void recordStall(HeartbeatId_t id, unsigned long lateMs) {
+    CRASH_BREADCRUMB(CRASH_SUB_SAFETY, CRASH_PT_HEARTBEAT_STALL + (uint8_t)id);
+
+    safetyState.lastStallId = (int8_t)id;
+    safetyState.stallCount++;
+
+    Preferences prefs;
+    prefs.begin(SAFETY_NAMESPACE, false);
+    prefs.putUChar(KEY_HB_STALL, (uint8_t)id + 1);
+    prefs.putUShort(KEY_HB_STALL_CNT, safetyState.stallCount);
+    prefs.end();
+
+    Serial.printf("[SafetyMgr] HEARTBEAT STALL: %s silent for %lums\n",
+                 safety_manager_get_heartbeat_name(id), lateMs);
+    console_add_event_f(CONSOLE_EVENT_ERROR, "HEARTBEAT: %s missed deadline (%lums)",
+                       safety_manager_get_heartbeat_name(id), lateMs);
+}
+
+/**
+ * Publish a safety action on the event bus
+ */
+static void publishSafetyEvent(SafetyEventKind_t kind) {
+    Event_t event;
+    event.topic = EVENT_SAFETY;
+    event.safety.kind = (uint8_t)kind;
+    event.safety.heartbeat = safetyState.lastStallId;
+    event_bus_publish(&event);
+}
@@ -0,0 +1,224 @@
+/**
+ * scratch_pool.cpp
+ * Fixed-Size Scratch Arena Pool Implementation
+ */
+
+#include "scratch_pool.h"
+
+// Arena storage lives in .bss - never on the heap
+static uint8_t smallBuffers[SCRATCH_SMALL_COUNT][SCRATCH_SMALL_SIZE] __attribute__((aligned(4)));
+static uint8_t largeBuffers[SCRATCH_LARGE_COUNT][SCRATCH_LARGE_SIZE] __attribute__((aligned(4)));
+
+#define SCRATCH_ARENA_COUNT (SCRATCH_SMALL_COUNT + SCRATCH_LARGE_COUNT)
+
+// Smallest first, so acquire() picks the tightest fit
+static ScratchArena_t arenas[SCRATCH_ARENA_COUNT];
+static bool arenasReady = false;
+static ScratchPoolStats_t stats;
+
+// Forward declarations
+static void setupArenas(void);
+static ScratchArena_t* findArena(const void* ptr);
+
+/**
+ * Acquire an arena
+ */
+ScratchArena_t* scratch_pool_acquire(size_t minSize) {
+    if (!arenasReady) {
+        setupArenas();
+    }
+
+    for (int i = 0; i < SCRATCH_ARENA_COUNT; i++) {
+        ScratchArena_t* arena = &arenas[i];
+        if (!arena->inUse && arena->size >= minSize) {
+            arena->inUse = true;
+            arena->used = 0;
+
+            stats.acquisitions++;
+            stats.inUse++;
+            if (stats.inUse > stats.peakInUse) stats.peakInUse = stats.inUse;
+            return arena;
+        }
+    }
+
+    stats.exhausted++;
+    return nullptr;
+}
+
+/**
+ * Release an arena
+ */
+void scratch_pool_release(ScratchArena_t* arena) {
+    if (!arena || !arena->inUse) {
+        return;
+    }
+    if (arena->size == SCRATCH_LARGE_SIZE && arena->used > stats.peakLargeUsed) {
+        stats.peakLargeUsed = arena->used;
+    }
+    arena->inUse = false;
+    arena->used = 0;
+    stats.inUse--;
+}
+
+/**
+ * Bump-allocate
+ */
+void* scratch_alloc(ScratchArena_t* arena, size_t size) {
+    if (!arena) {
+        return nullptr;
+    }
+    size_t aligned = (size + 3) & ~(size_t)3;
+    if (arena->used + aligned > arena->size) {
+        return nullptr;
+    }
+    void* ptr = arena->buffer + arena->used;
+    arena->used += aligned;
+    return ptr;
+}
+
+/**
+ * Get statistics
+ */
+const ScratchPoolStats_t* scratch_pool_get_stats(void) {
+    return &stats;
+}
+
+/**
+ * Reset statistics
+ */
+void scratch_pool_reset_stats(void) {
+    uint8_t inUse = stats.inUse;
+    memset(&stats, 0, sizeof(stats));
+    stats.inUse = inUse;
+    stats.peakInUse = inUse;
+}
+
+/**
+ * Pool-first allocation (one arena per block)
+ */
+void* scratch_pool_malloc(size_t size) {
+    ScratchArena_t* arena = scratch_pool_acquire(size);
+    if (arena) {
+        return scratch_alloc(arena, size);
+    }
+    stats.fallbacks++;
+    return malloc(size);
+}
+
+/**
+ * Free pool or heap block
+ */
+void scratch_pool_free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    ScratchArena_t* arena = findArena(ptr);
+    if (arena) {
+        scratch_pool_release(arena);
+    } else {
+        free(ptr);
+    }
+}
+
+/**
+ * Resize pool or heap block
+ */
+void* scratch_pool_realloc(void* ptr, size_t size) {
+    ScratchArena_t* arena = findArena(ptr);
+    if (!arena) {
+        return realloc(ptr, size);
+    }
+    // Block always starts at the arena base, so it can use the whole arena
+    if (size > arena->size) {
+        return nullptr;
+    }
+    arena->used = (size + 3) & ~(size_t)3;
+    return ptr;
+}
+
+// ===== ScratchStream =====
+
+ScratchStream::ScratchStream(FlushFn flush, void* ctx)
+    : arena_(scratch_pool_acquire(SCRATCH_SMALL_SIZE)),
+      buf_(nullptr), cap_(0), len_(0), total_(0), flushFn_(flush), ctx_(ctx) {
+    if (arena_) {
+        buf_ = arena_->buffer;
+        cap_ = arena_->size;
+        arena_->used = arena_->size;
+    } else {
+        // Pool busy: smaller chunks, still no heap
+        buf_ = fallback_;
+        cap_ = sizeof(fallback_);
+    }
+}
+
+ScratchStream::~ScratchStream() {
+    scratch_pool_release(arena_);
+}
+
+size_t ScratchStream::write(uint8_t c) {
+    if (len_ >= cap_) {
+        flush();
+    }
+    buf_[len_++] = c;
+    total_++;
+    return 1;
+}
+
+size_t ScratchStream::write(const uint8_t* data, size_t len) {
+    size_t remaining = len;
+    while (remaining > 0) {
+        if (len_ >= cap_) {
+            flush();
+        }
+        size_t n = cap_ - len_;
+        if (n > remaining) n = remaining;
+        memcpy(buf_ + len_, data, n);
+        len_ += n;
+        data += n;
+        remaining -= n;
+    }
+    total_ += len;
+    return len;
+}
+
+void ScratchStream::flush() {
+    if (len_ > 0 && flushFn_) {
+        flushFn_(ctx_, buf_, len_);
+    }
+    len_ = 0;
+}
+
+// ===== INTERNAL FUNCTIONS =====
+
+/**
+ * Wire arena descriptors to their static buffers
+ */
+static void setupArenas(void) {
+    int n = 0;
+    for (int i = 0; i < SCRATCH_SMALL_COUNT; i++, n++) {
+        arenas[n].buffer = smallBuffers[i];
+        arenas[n].size = SCRATCH_SMALL_SIZE;
+        arenas[n].used = 0;
+        arenas[n].inUse = false;
+    }
+    for (int i = 0; i < SCRATCH_LARGE_COUNT; i++, n++) {
+        arenas[n].buffer = largeBuffers[i];
+        arenas[n].size = SCRATCH_LARGE_SIZE;
+        arenas[n].used = 0;
+        arenas[n].inUse = false;
+    }
+    arenasReady = true;
+}
+
+/**
+ * Find the arena whose buffer starts at ptr
+ */
+static ScratchArena_t* findArena(const void* ptr) {
+    for (int i = 0; i < SCRATCH_ARENA_COUNT; i++) {
+        if (arenasReady && arenas[i].inUse && arenas[i].buffer == ptr) {
+            return &arenas[i];
+        }
+    }
+    return nullptr;
+}
@@ -12,12 +12,19 @@ static int history_count = 0;
 static int history_index = 0;
 static unsigned long last_sample_time = 0;
 static unsigned long boot_time = 0;
+static uint32_t history_next_seq = 0;   // Points recorded since boot
+static uint32_t history_boot_id = 0;
+
+// Recording runs on the control task, re-stamping on loop()
+static portMUX_TYPE history_mux = portMUX_INITIALIZER_UNLOCKED;
 
 void temp_history_init(unsigned long boot_time_ms) {
     boot_time = boot_time_ms;
     history_count = 0;
     history_index = 0;
     last_sample_time = 0;
+    history_next_seq = 0;
+    history_boot_id = esp_random();
     memset(history_buffer, 0, sizeof(history_buffer));
 }
 
@@ -35,6 +42,7 @@ void temp_history_record(float temp) {
     unsigned long timestamp = tv.tv_sec;
 
     // Store reading in circular buffer
+    portENTER_CRITICAL(&history_mux);
     history_buffer[history_index].timestamp = timestamp;
     history_buffer[history_index].temperature = temp;
 
@@ -43,6 +51,8 @@ void temp_history_record(float temp) {
     if (history_count < HISTORY_BUFFER_SIZE) {
         history_count++;
     }
+    history_next_seq++;
+    portEXIT_CRITICAL(&history_mux);
 
     last_sample_time = current_time;
 }
@@ -70,12 +80,75 @@ const TempHistoryPoint_t* temp_history_get_point(int index) {
 }
 
 void temp_history_clear(void) {
+    portENTER_CRITICAL(&history_mux);
     history_count = 0;
     history_index = 0;
     last_sample_time = 0;
     memset(history_buffer, 0, sizeof(history_buffer));
+    portEXIT_CRITICAL(&history_mux);
 }
 
 unsigned long temp_history_get_last_sample_time(void) {
     return last_sample_time;
 }
+
+int temp_history_restamp(unsigned long before, long offset) {
+    int moved = 0;
+    portENTER_CRITICAL(&history_mux);
+    for (int i = 0; i < history_count; i++) {
+        if (history_buffer[i].timestamp < before) {
+            history_buffer[i].timestamp += offset;
+            moved++;
+        }
+    }
+    portEXIT_CRITICAL(&history_mux);
+    return moved;
+}
+
+uint32_t temp_history_get_first_seq(void) {
+    portENTER_CRITICAL(&history_mux);
+    uint32_t first = history_next_seq - (uint32_t)history_count;
+    portEXIT_CRITICAL(&history_mux);
+    return first;
+}
+
+uint32_t temp_history_get_next_seq(void) {
+    return history_next_seq;
+}
+
+int temp_history_copy_since(uint32_t since, int max, TempHistoryPoint_t* points,
+                            uint32_t* firstSeq, uint32_t* nextSeq) {
+    portENTER_CRITICAL(&history_mux);
+    uint32_t next = history_next_seq;
+    uint32_t first = next - (uint32_t)history_count;
+
+    // Sequence numbers wrap, so compare by difference
+    uint32_t start = since;
+    if ((int32_t)(start - first) < 0) {
+        start = first;
+    }
+    if ((int32_t)(next - start) < 0) {
+        start = next;
+    }
+    uint32_t available = next - start;
+    int count = available > (uint32_t)max ? max : (int)available;
+
+    // Oldest point is at index 0 until the ring fills, then at history_index
+    int oldest = (history_count < HISTORY_BUFFER_SIZE) ? 0 : history_index;
+    int from = (oldest + (int)(start - first)) % HISTORY_BUFFER_SIZE;
+    int head = HISTORY_BUFFER_SIZE - from;
+    if (head > count) {
+        head = count;
+    }
+    memcpy(points, &history_buffer[from], head * sizeof(TempHistoryPoint_t));
+    memcpy(points + head, history_buffer, (count - head) * sizeof(TempHistoryPoint_t));
+    portEXIT_CRITICAL(&history_mux);
+
+    *firstSeq = start;
+    *nextSeq = next;
+    return count;
+}
+
+uint32_t temp_history_get_boot_id(void) {
+    return history_boot_id;
+}
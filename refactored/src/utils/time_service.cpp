@@ -0,0 +1,359 @@
+/**
+ * time_service.cpp
+ * Clock, Timezone and Cached Local Time Implementation
+ */
+
+#include "time_service.h"
+#include "console.h"
+#include <Preferences.h>
+#include <ctype.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+
+static const char* NTP_SERVER_1 = "pool.ntp.org";
+static const char* NTP_SERVER_2 = "time.nist.gov";
+
+static char tzString[TIME_TZ_MAX_LEN + 1] = TIME_DEFAULT_TZ;
+
+// Cached local time, double-buffered: the writer fills the slot readers
+// aren't using, then bumps the generation. A read is torn only if two
+// refreshes (2s) land inside it, which the generation check catches.
+typedef struct {
+    time_t utc;                // 0 if the clock isn't set
+    struct tm local;
+} LocalCache_t;
+
+static LocalCache_t cache[2];
+static volatile uint32_t cacheGen = 0;
+static time_t cachedSecond = -1;
+
+// First valid time detection
+static bool validSeen = false;
+static bool havePreValid = false;
+static int64_t preValidOffsetUs = 0;   // Wall clock minus monotonic clock before it was set
+static int32_t firstStepSec = 0;
+static TimeSyncCallback_t syncCallback = nullptr;
+
+// Written from the SNTP callback (lwIP task)
+static volatile uint32_t syncCount = 0;
+static volatile uint32_t lastSyncUptimeSec = 0;
+
+// Forward declarations
+static void applyTimezone(void);
+static void refreshCache(const struct timeval* tv);
+static void onSntpSync(struct timeval* tv);
+
+/**
+ * Initialize time service
+ */
+void time_service_init(void) {
+    Preferences prefs;
+    prefs.begin("thermostat", true);
+    String tz = prefs.getString("tz", TIME_DEFAULT_TZ);
+    prefs.end();
+
+    if (!time_service_is_valid_timezone(tz.c_str())) {
+        tz = TIME_DEFAULT_TZ;
+    }
+    strncpy(tzString, tz.c_str(), TIME_TZ_MAX_LEN);
+    tzString[TIME_TZ_MAX_LEN] = '\0';
+    applyTimezone();
+
+    cachedSecond = -1;
+    time_service_task();
+}
+
+/**
+ * Start NTP
+ */
+void time_service_start_sync(void) {
+    sntp_set_time_sync_notification_cb(onSntpSync);
+    configTzTime(tzString, NTP_SERVER_1, NTP_SERVER_2);
+    console_add_event_f(CONSOLE_EVENT_SYSTEM, "Time: NTP started, TZ %s", tzString);
+}
+
+/**
+ * Time service task
+ */
+void time_service_task(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    if (tv.tv_sec == cachedSecond) {
+        return;
+    }
+    cachedSecond = tv.tv_sec;
+
+    int64_t offsetUs = (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec - (int64_t)time_service_uptime_us();
+    if (tv.tv_sec < TIME_VALID_EPOCH) {
+        // The boot clock runs in step with the monotonic clock until it is set
+        preValidOffsetUs = offsetUs;
+        havePreValid = true;
+    } else if (!validSeen) {
+        validSeen = true;
+        if (havePreValid) {
+            firstStepSec = (int32_t)((offsetUs - preValidOffsetUs + 500000LL) / 1000000LL);
+        }
+        refreshCache(&tv);
+        struct tm local;
+        time_service_get_local(&local);
+        char when[24];
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &local);
+        console_add_event_f(CONSOLE_EVENT_SYSTEM, "Time: clock set, %s %s (step %+lds)",
+                            when, tzString, (long)firstStepSec);
+        if (havePreValid && syncCallback) {
+            syncCallback(firstStepSec);
+        }
+        return;
+    }
+    refreshCache(&tv);
+}
+
+/**
+ * Get monotonic time since boot (us)
+ */
+uint64_t time_service_uptime_us(void) {
+    return (uint64_t)esp_timer_get_time();
+}
+
+/**
+ * Get monotonic time since boot (ms)
+ */
+uint64_t time_service_uptime_ms(void) {
+    return time_service_uptime_us() / 1000ULL;
+}
+
+/**
+ * Get seconds since boot
+ */
+uint32_t time_service_uptime_sec(void) {
+    return (uint32_t)(time_service_uptime_us() / 1000000ULL);
+}
+
+/**
+ * Check if the clock is set
+ */
+bool time_service_is_valid(void) {
+    return time(nullptr) >= TIME_VALID_EPOCH;
+}
+
+/**
+ * Get UTC
+ */
+time_t time_service_utc(void) {
+    time_t now = time(nullptr);
+    return now >= TIME_VALID_EPOCH ? now : 0;
+}
+
+/**
+ * Get cached local time
+ */
+bool time_service_get_local(struct tm* out) {
+    LocalCache_t copy;
+    uint32_t gen;
+    do {
+        gen = cacheGen;
+        __sync_synchronize();
+        copy = cache[gen & 1];
+        __sync_synchronize();
+    } while (cacheGen - gen >= 2);
+
+    if (copy.utc == 0) {
+        return false;
+    }
+    *out = copy.local;
+    return true;
+}
+
+/**
+ * Get clock status
+ */
+void time_service_get_status(TimeStatus_t* status) {
+    uint32_t count = syncCount;
+    uint32_t age = count > 0 ? time_service_uptime_sec() - lastSyncUptimeSec : 0;
+
+    status->flags = (time_service_is_valid() ? TIME_FLAG_VALID : 0) |
+                    (count > 0 ? TIME_FLAG_SYNCED : 0) |
+                    (count > 0 && age > TIME_SYNC_STALE_SEC ? TIME_FLAG_STALE : 0);
+    status->syncCount = count;
+    status->lastSyncAgeSec = age;
+    status->firstStepSec = firstStepSec;
+}
+
+/**
+ * Get timezone
+ */
+const char* time_service_get_timezone(void) {
+    return tzString;
+}
+
+/**
+ * Parse a TZ name: 3+ letters, or <...> quoted (e.g. <+03>)
+ */
+static const char* parseTzName(const char* p) {
+    const char* start = p;
+    if (*p == '<') {
+        p++;
+        while (*p && *p != '>') {
+            if (!isalnum((unsigned char)*p) && *p != '+' && *p != '-') {
+                return nullptr;
+            }
+            p++;
+        }
+        return (*p == '>' && p - start >= 4) ? p + 1 : nullptr;
+    }
+    while (isalpha((unsigned char)*p)) {
+        p++;
+    }
+    return p - start >= 3 ? p : nullptr;
+}
+
+/**
+ * Parse [+-]hh[:mm[:ss]]
+ */
+static const char* parseTzOffset(const char* p, bool allowSign) {
+    if (allowSign && (*p == '+' || *p == '-')) {
+        p++;
+    }
+    for (int part = 0; part < 3; part++) {
+        if (!isdigit((unsigned char)*p)) {
+            return nullptr;
+        }
+        p++;
+        if (isdigit((unsigned char)*p)) {
+            p++;
+        }
+        if (*p != ':' || part == 2) {
+            return p;
+        }
+        p++;
+    }
+    return p;
+}
+
+/**
+ * Parse a DST rule: Mm.w.d, Jn or n, optionally /time
+ */
+static const char* parseTzRule(const char* p) {
+    if (*p == 'M') {
+        p++;
+        for (int part = 0; part < 3; part++) {
+            if (!isdigit((unsigned char)*p)) {
+                return nullptr;
+            }
+            while (isdigit((unsigned char)*p)) {
+                p++;
+            }
+            if (part < 2 && *p++ != '.') {
+                return nullptr;
+            }
+        }
+    } else {
+        if (*p == 'J') {
+            p++;
+        }
+        if (!isdigit((unsigned char)*p)) {
+            return nullptr;
+        }
+        while (isdigit((unsigned char)*p)) {
+            p++;
+        }
+    }
+    if (*p == '/') {
+        p = parseTzOffset(p + 1, true);
+    }
+    return p;
+}
+
+/**
+ * Check a POSIX TZ string
+ */
+bool time_service_is_valid_timezone(const char* tz) {
+    if (!tz || strlen(tz) > TIME_TZ_MAX_LEN) {
+        return false;
+    }
+    const char* p = parseTzName(tz);
+    if (!p || !(p = parseTzOffset(p, true))) {
+        return false;
+    }
+    if (*p == '\0') {
+        return true;
+    }
+
+    // Daylight saving: name, optional offset, optional start/end rules
+    if (!(p = parseTzName(p))) {
+        return false;
+    }
+    if (*p && *p != ',' && !(p = parseTzOffset(p, true))) {
+        return false;
+    }
+    if (*p == '\0') {
+        return true;
+    }
+    if (*p != ',' || !(p = parseTzRule(p + 1)) || *p != ',' || !(p = parseTzRule(p + 1))) {
+        return false;
+    }
+    return *p == '\0';
+}
+
+/**
+ * Set timezone
+ */
+bool time_service_set_timezone(const char* tz) {
+    if (!time_service_is_valid_timezone(tz)) {
+        return false;
+    }
+    strncpy(tzString, tz, TIME_TZ_MAX_LEN);
+    tzString[TIME_TZ_MAX_LEN] = '\0';
+
+    Preferences prefs;
+    prefs.begin("thermostat", false);
+    prefs.putString("tz", tzString);
+    prefs.end();
+
+    applyTimezone();
+    cachedSecond = -1;      // Recompute local time on the next task call
+    console_add_event_f(CONSOLE_EVENT_SYSTEM, "Time: timezone set to %s", tzString);
+    return true;
+}
+
+/**
+ * Set first-valid-time callback
+ */
+void time_service_set_sync_callback(TimeSyncCallback_t callback) {
+    syncCallback = callback;
+}
+
+/**
+ * Apply the timezone to newlib (localtime_r)
+ */
+static void applyTimezone(void) {
+    setenv("TZ", tzString, 1);
+    tzset();
+}
+
+/**
+ * Recompute local time into the idle slot and publish it
+ */
+static void refreshCache(const struct timeval* tv) {
+    uint32_t next = cacheGen + 1;
+    LocalCache_t* slot = &cache[next & 1];
+    if (tv->tv_sec >= TIME_VALID_EPOCH) {
+        time_t now = tv->tv_sec;
+        localtime_r(&now, &slot->local);
+        slot->utc = now;
+    } else {
+        memset(slot, 0, sizeof(*slot));
+    }
+    __sync_synchronize();
+    cacheGen = next;
+}
+
+/**
+ * SNTP sync notification (lwIP task)
+ */
+static void onSntpSync(struct timeval* tv) {
+    (void)tv;
+    lastSyncUptimeSec = time_service_uptime_sec();
+    syncCount = syncCount + 1;
+}
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""
+bench_compare.py
+Hot-path benchmark comparison
+
+Compares two result files from the bench environment (Google Benchmark JSON,
+see bench/include/bench.h), e.g. main against a branch, and exits 1 if any
+benchmark got slower than the threshold, so it can gate a flash or a merge.
+
+    bench_compare.py base.json new.json [--threshold 10] [--metric cpu_time] [--json]
+
+Each benchmark is compared on its median: the _median aggregate when the
+runs used --benchmark_repetitions, otherwise the median of its repetitions.
+Only the standard library is used.
+"""
+
+import argparse
+import json
+import statistics
+import sys
+
+
+def load(path, metric):
+    """Map run name -> median time (ns) and names that reported an error"""
+    with open(path) as f:
+        data = json.load(f)
+
+    runs = {}
+    medians = {}
+    errors = set()
+    for b in data.get("benchmarks", []):
+        name = b.get("run_name", b["name"])
+        if b.get("error_occurred"):
+            errors.add(name)
+        elif b.get("run_type") == "aggregate":
+            if b.get("aggregate_name") == "median":
+                medians[name] = b[metric]
+        else:
+            runs.setdefault(name, []).append(b[metric])
+
+    for name, values in runs.items():
+        medians.setdefault(name, statistics.median(values))
+    return medians, errors, data.get("context", {})
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare hot-path benchmark results")
+    parser.add_argument("base", help="baseline results (JSON)")
+    parser.add_argument("new", help="results to check (JSON)")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="slowdown in percent that counts as a regression (default 10)")
+    parser.add_argument("--metric", choices=("cpu_time", "real_time"), default="cpu_time")
+    parser.add_argument("--json", action="store_true", help="one JSON object per benchmark")
+    args = parser.parse_args()
+
+    base, baseErrors, baseContext = load(args.base, args.metric)
+    new, newErrors, newContext = load(args.new, args.metric)
+    if baseContext.get("host_name") != newContext.get("host_name"):
+        print("warning: results are from different hosts (%s, %s)" %
+              (baseContext.get("host_name"), newContext.get("host_name")), file=sys.stderr)
+
+    rows = []
+    for name in list(base) + [n for n in new if n not in base]:
+        row = {"name": name, "base": base.get(name), "new": new.get(name), "change": None}
+        if name in newErrors:
+            row["status"] = "error"
+        elif row["new"] is None:
+            row["status"] = "removed"
+        elif row["base"] is None:
+            row["status"] = "added"
+        else:
+            row["change"] = 100.0 * (row["new"] - row["base"]) / row["base"] if row["base"] else 0.0
+            row["status"] = "slower" if row["change"] > args.threshold else "ok"
+        rows.append(row)
+
+    if args.json:
+        for row in rows:
+            print(json.dumps(row))
+    else:
+        width = max([len(r["name"]) for r in rows] + [9])
+        print("%-*s %14s %14s %9s" % (width, "Benchmark", "base ns", "new ns", "change"))
+        for r in rows:
+            print("%-*s %14s %14s %9s  %s" %
+                  (width, r["name"],
+                   "-" if r["base"] is None else "%.1f" % r["base"],
+                   "-" if r["new"] is None else "%.1f" % r["new"],
+                   "" if r["change"] is None else "%+.1f%%" % r["change"],
+                   "" if r["status"] == "ok" else r["status"].upper()))
+
+    failed = [r for r in rows if r["status"] in ("slower", "error")]
+    if failed:
+        print("%d benchmark(s) regressed more than %.0f%% or failed" % (len(failed), args.threshold),
+              file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+/**
+ * delta_bench.cpp
+ * Host benchmark for the delta OTA decoder
+ *
+ * Runs the firmware's delta_patch.cpp on the host: feeds the patch in
+ * 1KB chunks (as the OTA download does) and reports apply throughput.
+ * Output is verified against the expected new image.
+ *
+ * Build (from refactored/):
+ *   g++ -O2 -std=gnu++17 -Iinclude tools/delta_bench.cpp src/utils/delta_patch.cpp -o delta_bench
+ * Run:
+ *   ./delta_bench old.bin patch.tdp new.bin [iterations]
+ * Prints one JSON line (used by delta_ota.py bench --applier).
+ */
+
+#include "delta_patch.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define FEED_CHUNK 1024   // Same as OTA_CHUNK_SIZE
+
+typedef struct {
+    const std::vector<uint8_t>* oldImage;
+    std::vector<uint8_t> out;
+    uint32_t reads;
+    uint32_t writes;
+} BenchCtx_t;
+
+static bool readOld(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+    BenchCtx_t* c = (BenchCtx_t*)ctx;
+    if (offset + len > c->oldImage->size()) {
+        return false;
+    }
+    memcpy(buf, c->oldImage->data() + offset, len);
+    c->reads++;
+    return true;
+}
+
+static bool writeNew(void* ctx, const uint8_t* data, size_t len) {
+    BenchCtx_t* c = (BenchCtx_t*)ctx;
+    c->out.insert(c->out.end(), data, data + len);
+    c->writes++;
+    return true;
+}
+
+static bool loadFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data.resize(size > 0 ? size : 0);
+    size_t got = data.empty() ? 0 : fread(data.data(), 1, data.size(), f);
+    fclose(f);
+    return got == data.size();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s old.bin patch.tdp new.bin [iterations]\n", argv[0]);
+        return 2;
+    }
+    int iterations = (argc > 4) ? atoi(argv[4]) : 5;
+    if (iterations < 1) iterations = 1;
+
+    std::vector<uint8_t> oldImage, patch, expected;
+    if (!loadFile(argv[1], oldImage) || !loadFile(argv[2], patch) || !loadFile(argv[3], expected)) {
+        return 2;
+    }
+
+    double bestSec = 1e9;
+    BenchCtx_t ctx;
+    DeltaResult_t result = DELTA_OK;
+    static DeltaPatch_t decoder;   // Same fixed footprint as on the device
+
+    for (int it = 0; it < iterations; it++) {
+        ctx.oldImage = &oldImage;
+        ctx.out.clear();
+        ctx.out.reserve(expected.size());
+        ctx.reads = 0;
+        ctx.writes = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        delta_patch_init(&decoder, readOld, writeNew, &ctx, (uint32_t)oldImage.size());
+        for (size_t pos = 0; pos < patch.size() && result == DELTA_OK; pos += FEED_CHUNK) {
+            size_t n = patch.size() - pos;
+            if (n > FEED_CHUNK) n = FEED_CHUNK;
+            result = delta_patch_feed(&decoder, patch.data() + pos, n);
+        }
+        if (result == DELTA_OK) {
+            result = delta_patch_finish(&decoder);
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (result != DELTA_OK) {
+            fprintf(stderr, "apply failed: %s\n", delta_patch_get_error_name(result));
+            return 1;
+        }
+        if (sec < bestSec) bestSec = sec;
+    }
+
+    bool ok = (ctx.out == expected);
+    printf("{\"applyMBps\":%.2f,\"applyMs\":%.3f,\"decoderBytes\":%u,\"oldReads\":%u,\"writes\":%u,\"ok\":%s}\n",
+           expected.size() / bestSec / 1e6, bestSec * 1000.0, (unsigned)sizeof(DeltaPatch_t),
+           ctx.reads, ctx.writes, ok ? "true" : "false");
+    return ok ? 0 : 1;
+}
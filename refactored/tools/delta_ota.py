@@ -0,0 +1,373 @@
+#!/usr/bin/env python3
+"""
+delta_ota.py
+Delta OTA patch tool
+
+Builds TDP1 patches (see include/delta_patch.h) between two firmware images,
+writes the release manifest (firmware.json) and benchmarks consecutive releases.
+
+    delta_ota.py diff old.bin new.bin patch.tdp
+    delta_ota.py apply old.bin patch.tdp out.bin
+    delta_ota.py manifest --version 2.4.0 --image firmware.bin \\
+        --delta 2.3.0=firmware-2.3.0.bin [--delta ...] --out release/
+    delta_ota.py bench firmware-2.1.0.bin firmware-2.2.0.bin firmware-2.3.0.bin \\
+        [--applier ./delta_bench] [--json]
+
+Only the standard library is used.
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import re
+import struct
+import subprocess
+import sys
+import time
+
+MAGIC = b"TDP1"
+KEY_LEN = 12            # Bytes hashed to find match candidates
+MIN_MATCH = 24          # Shortest exact match worth a record
+APPROX_LOOKAHEAD = 128  # Give up extending a match after this many bytes without gain
+ZERO_RUNS = re.compile(b"\x00{3,}")
+
+
+# ===== ENCODING =====
+
+def _varint(value, out):
+    while True:
+        b = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return
+
+
+def _zigzag(value):
+    return (value << 1) ^ (value >> 63)
+
+
+def _build_index(old):
+    """Map every KEY_LEN-byte window of the old image to its last position."""
+    index = {}
+    for i in range(len(old) - KEY_LEN + 1):
+        index[old[i:i + KEY_LEN]] = i
+    return index
+
+
+def _exact_len(old, o, new, n):
+    """Length of the exact match starting at old[o], new[n]."""
+    start = n
+    limit = min(len(old) - o, len(new) - n)
+    step = 64
+    while limit >= step and old[o:o + step] == new[n:n + step]:
+        o += step
+        n += step
+        limit -= step
+    while limit > 0 and old[o] == new[n]:
+        o += 1
+        n += 1
+        limit -= 1
+    return n - start
+
+
+def _approx_len(old, o, new, n):
+    """
+    Extend a match allowing changed bytes (bsdiff-style): keep the length that
+    maximises 2*equal - length, i.e. at least half the bytes still match.
+    Typical case is code that moved, where only embedded addresses change.
+    """
+    limit = min(len(old) - o, len(new) - n)
+    i = 0
+    equal = 0
+    best = 0
+    best_score = 0
+    while i < limit and i - best <= APPROX_LOOKAHEAD:
+        if old[o + i] == new[n + i]:
+            run = _exact_len(old, o + i, new, n + i)
+            i += run
+            equal += run
+        else:
+            i += 1
+        score = 2 * equal - i
+        if score > best_score:
+            best_score = score
+            best = i
+    return best
+
+
+def _find_matches(old, new):
+    """Greedy match list: (new_start, old_start, length)."""
+    index = _build_index(old)
+    matches = []
+    pos = 0
+    align = 0           # old - new offset of the previous match
+    end = len(new) - KEY_LEN
+    while pos <= end:
+        key = new[pos:pos + KEY_LEN]
+        cand = pos + align
+        if not (0 <= cand <= len(old) - KEY_LEN and old[cand:cand + KEY_LEN] == key):
+            cand = index.get(key)
+            if cand is None:
+                pos += 1
+                continue
+        length = _exact_len(old, cand, new, pos)
+        if length < MIN_MATCH:
+            pos += 1
+            continue
+        length += _approx_len(old, cand + length, new, pos + length)
+        matches.append((pos, cand, length))
+        align = cand - pos
+        pos += length
+    return matches
+
+
+def _encode_diff(old_seg, new_seg, out):
+    """
+    Diff bytes as (zero run, literal run) pairs. Short zero runs stay inside
+    the literal - splitting costs two varints.
+    """
+    delta = bytes((a - b) & 0xFF for a, b in zip(new_seg, old_seg))
+    pos = 0
+    while pos < len(delta):
+        m = ZERO_RUNS.match(delta, pos)
+        zeros = m.end() - pos if m else 0
+        _varint(zeros, out)
+        pos += zeros
+        if pos >= len(delta):
+            break
+        nxt = ZERO_RUNS.search(delta, pos)
+        lit_end = nxt.start() if nxt else len(delta)
+        _varint(lit_end - pos, out)
+        out += delta[pos:lit_end]
+        pos = lit_end
+
+
+def _record(diff_len, extra_len, seek, out):
+    _varint(diff_len, out)
+    _varint(extra_len, out)
+    _varint(_zigzag(seek), out)
+
+
+def make_patch(old, new):
+    """Build a TDP1 patch turning old into new."""
+    out = bytearray(MAGIC)
+    out += struct.pack("<II", len(old), len(new))
+    if not new:
+        return bytes(out)
+
+    matches = _find_matches(old, new)
+
+    # Leading literal bytes / initial seek before the first match
+    first_new, first_old = (matches[0][0], matches[0][1]) if matches else (len(new), 0)
+    if first_new > 0 or first_old > 0:
+        _record(0, first_new, first_old, out)
+        out += new[:first_new]
+
+    for i, (n_start, o_start, length) in enumerate(matches):
+        extra_end = matches[i + 1][0] if i + 1 < len(matches) else len(new)
+        next_old = matches[i + 1][1] if i + 1 < len(matches) else o_start + length
+
+        _record(length, extra_end - (n_start + length), next_old - (o_start + length), out)
+        _encode_diff(old[o_start:o_start + length], new[n_start:n_start + length], out)
+        out += new[n_start + length:extra_end]
+
+    return bytes(out)
+
+
+# ===== DECODING (reference) =====
+
+def _read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        if not b & 0x80:
+            return value, pos
+        shift += 7
+
+
+def apply_patch(old, patch):
+    """Reference decoder - same rules as delta_patch.cpp."""
+    if patch[:4] != MAGIC:
+        raise ValueError("not a TDP1 patch")
+    old_size, new_size = struct.unpack_from("<II", patch, 4)
+    if old_size > len(old):
+        raise ValueError("patch needs a %d byte base image, got %d" % (old_size, len(old)))
+    pos = 12
+    out = bytearray()
+    old_pos = 0
+    while len(out) < new_size:
+        diff_len, pos = _read_varint(patch, pos)
+        extra_len, pos = _read_varint(patch, pos)
+        seek, pos = _read_varint(patch, pos)
+        seek = (seek >> 1) ^ -(seek & 1)
+
+        remain = diff_len
+        while remain:
+            zeros, pos = _read_varint(patch, pos)
+            out += old[old_pos:old_pos + zeros]
+            old_pos += zeros
+            remain -= zeros
+            if not remain:
+                break
+            lit, pos = _read_varint(patch, pos)
+            out += bytes((old[old_pos + k] + patch[pos + k]) & 0xFF for k in range(lit))
+            old_pos += lit
+            pos += lit
+            remain -= lit
+
+        out += patch[pos:pos + extra_len]
+        pos += extra_len
+        old_pos += seek
+    if pos != len(patch) or len(out) != new_size:
+        raise ValueError("malformed patch")
+    return bytes(out)
+
+
+# ===== COMMANDS =====
+
+def _read(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def _write(path, data):
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+def cmd_diff(args):
+    old = _read(args.old)
+    new = _read(args.new)
+    start = time.perf_counter()
+    patch = make_patch(old, new)
+    elapsed = time.perf_counter() - start
+    if apply_patch(old, patch) != new:
+        sys.exit("internal error: patch does not reproduce the new image")
+    _write(args.patch, patch)
+    print("%s: %d bytes (%.1f%% of %d), %.1fs" %
+          (args.patch, len(patch), 100.0 * len(patch) / len(new), len(new), elapsed))
+
+
+def cmd_apply(args):
+    _write(args.out, apply_patch(_read(args.old), _read(args.patch)))
+
+
+def cmd_manifest(args):
+    image = _read(args.image)
+    os.makedirs(args.out, exist_ok=True)
+    manifest = {
+        "version": args.version,
+        "file": os.path.basename(args.image),
+        "size": len(image),
+        "sha256": hashlib.sha256(image).hexdigest(),
+    }
+    deltas = []
+    for spec in args.delta or []:
+        from_version, base_path = spec.split("=", 1)
+        patch = make_patch(_read(base_path), image)
+        name = "firmware-from-%s.tdp" % from_version
+        _write(os.path.join(args.out, name), patch)
+        deltas.append({"from": from_version, "file": name, "size": len(patch)})
+        print("delta from %s: %d bytes" % (from_version, len(patch)))
+    if deltas:
+        manifest["deltas"] = deltas
+    with open(os.path.join(args.out, "firmware.json"), "w") as f:
+        json.dump(manifest, f, separators=(",", ":"))
+    print("firmware.json: %s %d bytes sha256 %s" % (args.version, len(image), manifest["sha256"]))
+
+
+def _run_applier(applier, old_path, patch, new_path):
+    """Time the device decoder (tools/delta_bench.cpp) on the host."""
+    tmp = new_path + ".tdp.tmp"
+    _write(tmp, patch)
+    try:
+        result = subprocess.run([applier, old_path, tmp, new_path],
+                                capture_output=True, text=True, check=True)
+        return json.loads(result.stdout.strip().splitlines()[-1])
+    finally:
+        os.remove(tmp)
+
+
+def cmd_bench(args):
+    if len(args.images) < 2:
+        sys.exit("bench needs at least two images (oldest first)")
+    rows = []
+    for old_path, new_path in zip(args.images, args.images[1:]):
+        old = _read(old_path)
+        new = _read(new_path)
+        start = time.perf_counter()
+        patch = make_patch(old, new)
+        diff_s = time.perf_counter() - start
+        start = time.perf_counter()
+        ok = apply_patch(old, patch) == new
+        apply_s = time.perf_counter() - start
+        row = {
+            "from": os.path.basename(old_path),
+            "to": os.path.basename(new_path),
+            "imageBytes": len(new),
+            "patchBytes": len(patch),
+            "ratio": round(len(patch) / float(len(new)), 4),
+            "diffSec": round(diff_s, 3),
+            "pyApplyMBps": round(len(new) / apply_s / 1e6, 2),
+            "ok": ok,
+        }
+        if args.applier:
+            row.update(_run_applier(args.applier, old_path, patch, new_path))
+        rows.append(row)
+
+    if args.json:
+        for row in rows:
+            print(json.dumps(row))
+        return
+    print("%-24s %-24s %10s %10s %7s %8s %10s" %
+          ("from", "to", "image", "patch", "ratio", "diff s", "apply MB/s"))
+    for r in rows:
+        mbps = r.get("applyMBps", r["pyApplyMBps"])
+        print("%-24s %-24s %10d %10d %6.1f%% %8.2f %10.2f%s" %
+              (r["from"], r["to"], r["imageBytes"], r["patchBytes"], 100 * r["ratio"],
+               r["diffSec"], mbps, "" if r["ok"] else "  MISMATCH"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Delta OTA patch tool")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("diff", help="build a patch")
+    p.add_argument("old")
+    p.add_argument("new")
+    p.add_argument("patch")
+    p.set_defaults(func=cmd_diff)
+
+    p = sub.add_parser("apply", help="apply a patch (reference decoder)")
+    p.add_argument("old")
+    p.add_argument("patch")
+    p.add_argument("out")
+    p.set_defaults(func=cmd_apply)
+
+    p = sub.add_parser("manifest", help="write firmware.json and delta patches for a release")
+    p.add_argument("--version", required=True)
+    p.add_argument("--image", required=True, help="new firmware.bin")
+    p.add_argument("--delta", action="append", metavar="VERSION=BASE.bin",
+                   help="build a patch from an earlier release (repeatable)")
+    p.add_argument("--out", required=True, help="output directory")
+    p.set_defaults(func=cmd_manifest)
+
+    p = sub.add_parser("bench", help="patch size and apply speed for consecutive releases")
+    p.add_argument("images", nargs="+", help="firmware images, oldest first")
+    p.add_argument("--applier", help="path to the compiled delta_bench binary")
+    p.add_argument("--json", action="store_true", help="one JSON object per release pair")
+    p.set_defaults(func=cmd_bench)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,253 @@
+/**
+ * fleet_aggregator.cpp
+ * Linux fleet dashboard
+ *
+ * Joins the fleet multicast group, keeps the same peer table as the
+ * firmware (fleet_frame.cpp) and serves the same dashboard and
+ * GET /api/v1/fleet, so a Raspberry Pi or server can show every unit
+ * without any thermostat hosting the page. Prints receive rate and its
+ * own CPU use every stats period.
+ *
+ * Build (from refactored/):
+ *   g++ -O2 -std=gnu++17 -Iinclude tools/fleet_aggregator.cpp src/network/fleet_frame.cpp -o fleet_aggregator
+ * Run:
+ *   ./fleet_aggregator [--http PORT] [--iface LOCAL_IP] [--peers N] [--stats SEC]
+ * Then open http://<host>:8080/
+ */
+
+#include "fleet_frame.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+static uint32_t nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000);
+}
+
+static double cpuSeconds(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static int openGroup(const char* iface) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(FLEET_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    struct ip_mreq mreq;
+    inet_pton(AF_INET, FLEET_GROUP, &mreq.imr_multiaddr);
+    mreq.imr_interface.s_addr = iface ? inet_addr(iface) : htonl(INADDR_ANY);
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int openHttp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static std::string fleetJson(const FleetTable_t* table) {
+    std::string out = "{\"ok\":true,\"data\":{\"enabled\":true,\"nodes\":[";
+    char item[768];
+    uint32_t now = nowMs();
+    bool first = true;
+    for (int i = 0; i < table->capacity; i++) {
+        if (table->peers[i].used && fleet_peer_json(&table->peers[i], now, false, item, sizeof(item))) {
+            out += first ? "" : ",";
+            out += item;
+            first = false;
+        }
+    }
+    snprintf(item, sizeof(item),
+             "],\"stats\":{\"framesIn\":%u,\"bytesIn\":%u,\"rejected\":%u,\"full\":%u,\"framesSent\":0}}}",
+             table->framesIn, table->bytesIn, table->rejected, table->full);
+    return out + item;
+}
+
+static std::string dashboardHtml(void) {
+    std::string out = "<!DOCTYPE html><html><head><meta charset='utf-8'><title>Fleet</title>"
+                      "<style>body{font-family:sans-serif;margin:20px}a{color:#1976d2}</style></head>"
+                      "<body><h1>Fleet</h1><div id='fleet'>Loading...</div><script>";
+    out += FLEET_DASHBOARD_JS;
+    return out + "</script></body></html>";
+}
+
+/**
+ * Answer one request (Connection: close, so one request per accept)
+ */
+static void serveClient(int client, const FleetTable_t* table) {
+    struct timeval tv = {1, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    char req[1024];
+    ssize_t n = recv(client, req, sizeof(req) - 1, 0);
+    if (n <= 0) {
+        close(client);
+        return;
+    }
+    req[n] = '\0';
+
+    const char* status = "200 OK";
+    const char* type = "application/json";
+    std::string body;
+    if (strncmp(req, "GET /api/v1/fleet", 17) == 0) {
+        body = fleetJson(table);
+    } else if (strncmp(req, "GET / ", 6) == 0 || strncmp(req, "GET /fleet ", 11) == 0) {
+        type = "text/html; charset=utf-8";
+        body = dashboardHtml();
+    } else {
+        status = "404 Not Found";
+        type = "text/plain";
+        body = "Not found";
+    }
+
+    char head[160];
+    int len = snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+                       "Connection: close\r\n\r\n", status, type, body.size());
+    std::string resp = std::string(head, len) + body;
+    for (size_t off = 0; off < resp.size();) {
+        ssize_t w = send(client, resp.data() + off, resp.size() - off, MSG_NOSIGNAL);
+        if (w <= 0) {
+            break;
+        }
+        off += (size_t)w;
+    }
+    close(client);
+}
+
+int main(int argc, char** argv) {
+    int httpPort = 8080;
+    int capacity = 1024;
+    int statsSec = 10;
+    const char* iface = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--http") && i + 1 < argc) {
+            httpPort = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--iface") && i + 1 < argc) {
+            iface = argv[++i];
+        } else if (!strcmp(argv[i], "--peers") && i + 1 < argc) {
+            capacity = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--stats") && i + 1 < argc) {
+            statsSec = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--http PORT] [--iface LOCAL_IP] [--peers N] [--stats SEC]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (capacity < 1 || statsSec < 1) {
+        fprintf(stderr, "--peers and --stats must be positive\n");
+        return 1;
+    }
+
+    int udp = openGroup(iface);
+    if (udp < 0) {
+        fprintf(stderr, "cannot join %s:%d: %s\n", FLEET_GROUP, FLEET_PORT, strerror(errno));
+        return 1;
+    }
+    int http = openHttp(httpPort);
+    if (http < 0) {
+        fprintf(stderr, "cannot listen on :%d: %s\n", httpPort, strerror(errno));
+        return 1;
+    }
+
+    std::vector<FleetPeer_t> storage(capacity);
+    FleetTable_t table;
+    fleet_table_init(&table, storage.data(), capacity);
+    printf("Listening on %s:%d, dashboard on http://0.0.0.0:%d/\n", FLEET_GROUP, FLEET_PORT, httpPort);
+
+    uint32_t lastExpire = nowMs();
+    uint32_t lastStats = lastExpire;
+    uint32_t statFrames = 0, statBytes = 0;
+    double statCpu = cpuSeconds();
+
+    for (;;) {
+        struct pollfd fds[2] = {{udp, POLLIN, 0}, {http, POLLIN, 0}};
+        poll(fds, 2, 1000);
+
+        if (fds[0].revents & POLLIN) {
+            uint8_t buf[FLEET_FRAME_SIZE + 1];
+            struct sockaddr_in from;
+            socklen_t fromLen = sizeof(from);
+            ssize_t n;
+            while ((n = recvfrom(udp, buf, sizeof(buf), MSG_DONTWAIT, (struct sockaddr*)&from, &fromLen)) > 0) {
+                FleetPeer_t* peer = fleet_table_receive(&table, buf, (size_t)n, from.sin_addr.s_addr, nowMs());
+                if (peer && peer->frames == 1) {
+                    printf("found %08x %s (%s)\n", peer->status.nodeId, peer->status.name, inet_ntoa(from.sin_addr));
+                }
+                fromLen = sizeof(from);
+            }
+        }
+        if (fds[1].revents & POLLIN) {
+            int client = accept(http, nullptr, nullptr);
+            if (client >= 0) {
+                serveClient(client, &table);
+            }
+        }
+
+        uint32_t now = nowMs();
+        if (now - lastExpire >= 1000) {
+            lastExpire = now;
+            int dropped = fleet_table_expire(&table, now);
+            if (dropped > 0) {
+                printf("%d unit(s) went silent\n", dropped);
+            }
+        }
+        if (now - lastStats >= (uint32_t)statsSec * 1000) {
+            double secs = (now - lastStats) / 1000.0;
+            double cpu = cpuSeconds();
+            printf("units=%d frames/s=%.1f bytes/s=%.0f rejected=%u full=%u cpu=%.3f%%\n",
+                   fleet_table_count(&table), (table.framesIn - statFrames) / secs,
+                   (table.bytesIn - statBytes) / secs, table.rejected, table.full,
+                   100.0 * (cpu - statCpu) / secs);
+            fflush(stdout);
+            lastStats = now;
+            statFrames = table.framesIn;
+            statBytes = table.bytesIn;
+            statCpu = cpu;
+        }
+    }
+}
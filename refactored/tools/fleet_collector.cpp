@@ -0,0 +1,1035 @@
+/**
+ * fleet_collector.cpp
+ * Linux fleet history collector and config pusher
+ *
+ * Keeps every unit's temperature history on a server so the units only
+ * need their 24h RAM buffer:
+ * - sync: pulls new points from each unit with
+ *   GET /api/v1/history/bulk?since=SEQ (history_bulk.h), resuming from
+ *   the last sequence number stored, and appends them to one columnar
+ *   file per unit. Reboots (new boot ID) and points that rolled out of
+ *   the unit's buffer before they were pulled are detected and counted.
+ * - push: POSTs one config template to /api/output/N/config on every
+ *   unit, in parallel.
+ * - dump: prints a stored file as CSV.
+ * - standin: serves N simulated units on consecutive local ports.
+ * - bench: runs sync and push against 100 (--devices) stand-in units and
+ *   prints one JSON line per phase; exits non-zero if the stored history
+ *   does not match what the units recorded.
+ *
+ * Column file (<dir>/<name>.thc, little-endian):
+ *   header 40 B: "THC1", version u32, bootId u32, nextSeq u32, points u64,
+ *                dataEnd u64, blocks u32, lost u32
+ *   blocks, one per pull: 'B', count u32, firstSeq u32, bootId u32,
+ *     firstTime u32, timeBytes u32, tempBytes u32, then the time column
+ *     (zigzag varint delta-of-delta, ~1 B/point at a fixed interval) and
+ *     the temperature column (zigzag varint delta of 0.1°C, ~1 B/point)
+ *   The header is rewritten after each block, so a torn append is
+ *   overwritten by the next one.
+ *
+ * Build (from refactored/):
+ *   g++ -O2 -std=gnu++17 -pthread -Iinclude tools/fleet_collector.cpp src/utils/history_bulk.cpp -o fleet_collector
+ * Run:
+ *   ./fleet_collector sync DEVICES DIR [--jobs J] [--pin PIN]
+ *   ./fleet_collector push DEVICES TEMPLATE.json --output N [--jobs J] [--pin PIN]
+ *   ./fleet_collector dump FILE.thc
+ *   ./fleet_collector standin N [--port P] [--latency MS]
+ *   ./fleet_collector bench [--devices N] [--jobs J] [--latency MS]
+ * DEVICES has one "host[:port] [name]" per line ('#' starts a comment).
+ */
+
+#include "history_bulk.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <errno.h>
+#include <functional>
+#include <math.h>
+#include <mutex>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#define STORE_MAGIC "THC1"
+#define STORE_VERSION 1
+#define STORE_HEADER_SIZE 40
+#define BLOCK_HEADER_SIZE 25
+#define PULL_MAX 288                    // Points per request (the unit's whole buffer)
+#define HTTP_TIMEOUT_MS 5000
+#define TEMP_NONE INT16_MIN
+
+// ===== HELPERS =====
+
+static double monoSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put64(uint8_t* p, uint64_t v) {
+    put32(p, (uint32_t)v);
+    put32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get64(const uint8_t* p) {
+    return get32(p) | (uint64_t)get32(p + 4) << 32;
+}
+
+static void putVarint(std::vector<uint8_t>& out, int64_t v) {
+    uint64_t z = ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);   // Zigzag
+    while (z >= 0x80) {
+        out.push_back((uint8_t)(z | 0x80));
+        z >>= 7;
+    }
+    out.push_back((uint8_t)z);
+}
+
+static bool getVarint(const uint8_t* buf, size_t len, size_t* pos, int64_t* v) {
+    uint64_t z = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= len) {
+            return false;
+        }
+        uint8_t b = buf[(*pos)++];
+        z |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+static int16_t tempCode(float c) {
+    return isnan(c) ? TEMP_NONE : (int16_t)lroundf(c * 10.0f);
+}
+
+/**
+ * Run fn(0..count-1) on up to jobs threads
+ */
+static void runParallel(int count, int jobs, const std::function<void(int)>& fn) {
+    std::atomic<int> next(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < jobs && t < count; t++) {
+        threads.emplace_back([&]() {
+            for (int i; (i = next++) < count;) {
+                fn(i);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+}
+
+// ===== HTTP CLIENT =====
+
+typedef struct {
+    std::string host;
+    int port;
+    std::string name;
+} Device_t;
+
+typedef struct {
+    int status;
+    std::string body;
+    std::string cookie;         // session=... from Set-Cookie
+    size_t wireBytes;           // Request + response, headers included
+} HttpResult_t;
+
+static int connectTo(const std::string& host, int port) {
+    struct addrinfo hints, *res = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    char portStr[8];
+    snprintf(portStr, sizeof(portStr), "%d", port);
+    if (getaddrinfo(host.c_str(), portStr, &hints, &res) != 0) {
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct timeval tv = {HTTP_TIMEOUT_MS / 1000, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    if (connect(fd, res->ai_addr, res->ai_addrlen) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static bool decodeChunked(const std::string& in, std::string* out) {
+    size_t pos = 0;
+    out->clear();
+    for (;;) {
+        size_t eol = in.find("\r\n", pos);
+        if (eol == std::string::npos) {
+            return false;
+        }
+        size_t size = strtoul(in.c_str() + pos, nullptr, 16);
+        pos = eol + 2;
+        if (size == 0) {
+            return true;
+        }
+        if (pos + size > in.size()) {
+            return false;
+        }
+        out->append(in, pos, size);
+        pos += size + 2;
+    }
+}
+
+/**
+ * One request on its own connection (the unit's web server closes after each)
+ */
+static bool httpRequest(const Device_t& dev, const char* method, const std::string& path,
+                        const std::string& body, const std::string& cookie, HttpResult_t* result) {
+    result->status = -1;
+    result->body.clear();
+    result->wireBytes = 0;
+
+    int fd = connectTo(dev.host, dev.port);
+    if (fd < 0) {
+        return false;
+    }
+    std::string req = std::string(method) + " " + path + " HTTP/1.1\r\nHost: " + dev.host +
+                      "\r\nConnection: close\r\n";
+    if (!cookie.empty()) {
+        req += "Cookie: " + cookie + "\r\n";
+    }
+    if (!body.empty()) {
+        req += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+    }
+    req += "\r\n" + body;
+    for (size_t off = 0; off < req.size();) {
+        ssize_t n = send(fd, req.data() + off, req.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) {
+            close(fd);
+            return false;
+        }
+        off += (size_t)n;
+    }
+
+    std::string resp;
+    char buf[4096];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        resp.append(buf, (size_t)n);
+    }
+    close(fd);
+    result->wireBytes = req.size() + resp.size();
+
+    size_t headEnd = resp.find("\r\n\r\n");
+    if (headEnd == std::string::npos || resp.compare(0, 5, "HTTP/") != 0) {
+        return false;
+    }
+    result->status = atoi(resp.c_str() + resp.find(' ') + 1);
+    std::string head = resp.substr(0, headEnd);
+    std::string payload = resp.substr(headEnd + 4);
+
+    size_t sc = head.find("Set-Cookie: ");
+    if (sc != std::string::npos) {
+        size_t end = head.find_first_of(";\r", sc + 12);
+        result->cookie = head.substr(sc + 12, end - sc - 12);
+    }
+    if (head.find("Transfer-Encoding: chunked") != std::string::npos) {
+        return decodeChunked(payload, &result->body);
+    }
+    size_t cl = head.find("Content-Length: ");
+    if (cl != std::string::npos && strtoul(head.c_str() + cl + 16, nullptr, 10) != payload.size()) {
+        return false;
+    }
+    result->body = payload;
+    return true;
+}
+
+/**
+ * Log in when the unit has PIN protection (empty PIN = none)
+ */
+static bool login(const Device_t& dev, const std::string& pin, std::string* cookie, size_t* wireBytes) {
+    cookie->clear();
+    if (pin.empty()) {
+        return true;
+    }
+    HttpResult_t r;
+    bool ok = httpRequest(dev, "POST", "/api/login", "{\"pin\":\"" + pin + "\"}", "", &r);
+    *wireBytes += r.wireBytes;
+    if (!ok || r.status != 200) {
+        return false;
+    }
+    *cookie = r.cookie;
+    return true;
+}
+
+static bool loadDevices(const char* path, std::vector<Device_t>* devices) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        char addr[192] = "", name[64] = "";
+        if (sscanf(line, "%191s %63s", addr, name) < 1) {
+            continue;
+        }
+        Device_t d;
+        char* colon = strchr(addr, ':');
+        d.port = colon ? atoi(colon + 1) : 80;
+        if (colon) *colon = '\0';
+        d.host = addr;
+        d.name = name[0] ? name : d.host + "_" + std::to_string(d.port);
+        devices->push_back(d);
+    }
+    fclose(f);
+    return true;
+}
+
+// ===== COLUMN STORE =====
+
+typedef struct {
+    uint32_t bootId;
+    uint32_t nextSeq;
+    uint64_t points;
+    uint64_t dataEnd;
+    uint32_t blocks;
+    uint32_t lost;
+} StoreState_t;
+
+static void writeStoreHeader(FILE* f, const StoreState_t* s) {
+    uint8_t h[STORE_HEADER_SIZE];
+    memcpy(h, STORE_MAGIC, 4);
+    put32(h + 4, STORE_VERSION);
+    put32(h + 8, s->bootId);
+    put32(h + 12, s->nextSeq);
+    put64(h + 16, s->points);
+    put64(h + 24, s->dataEnd);
+    put32(h + 32, s->blocks);
+    put32(h + 36, s->lost);
+    fseek(f, 0, SEEK_SET);
+    fwrite(h, 1, sizeof(h), f);
+}
+
+/**
+ * Open (or create) a unit's file and read its state
+ */
+static FILE* storeOpen(const std::string& path, StoreState_t* s) {
+    memset(s, 0, sizeof(*s));
+    FILE* f = fopen(path.c_str(), "r+b");
+    if (!f) {
+        f = fopen(path.c_str(), "w+b");
+        if (!f) {
+            return nullptr;
+        }
+        s->dataEnd = STORE_HEADER_SIZE;
+        writeStoreHeader(f, s);
+        return f;
+    }
+    uint8_t h[STORE_HEADER_SIZE];
+    if (fread(h, 1, sizeof(h), f) != sizeof(h) || memcmp(h, STORE_MAGIC, 4) != 0 ||
+        get32(h + 4) != STORE_VERSION) {
+        fclose(f);
+        return nullptr;
+    }
+    s->bootId = get32(h + 8);
+    s->nextSeq = get32(h + 12);
+    s->points = get64(h + 16);
+    s->dataEnd = get64(h + 24);
+    s->blocks = get32(h + 32);
+    s->lost = get32(h + 36);
+    return f;
+}
+
+/**
+ * Append one pulled batch as a block
+ */
+static bool storeAppend(FILE* f, StoreState_t* s, uint32_t bootId, uint32_t firstSeq,
+                        const uint32_t* times, const float* temps, int count) {
+    std::vector<uint8_t> timeCol, tempCol;
+    int64_t prevTime = times[0], prevDelta = 0, prevTemp = 0;
+    for (int i = 0; i < count; i++) {
+        int64_t delta = (int64_t)times[i] - prevTime;
+        putVarint(timeCol, delta - prevDelta);
+        prevDelta = delta;
+        prevTime = times[i];
+        int64_t code = tempCode(temps[i]);
+        putVarint(tempCol, code - prevTemp);
+        prevTemp = code;
+    }
+
+    uint8_t h[BLOCK_HEADER_SIZE];
+    h[0] = 'B';
+    put32(h + 1, (uint32_t)count);
+    put32(h + 5, firstSeq);
+    put32(h + 9, bootId);
+    put32(h + 13, times[0]);
+    put32(h + 17, (uint32_t)timeCol.size());
+    put32(h + 21, (uint32_t)tempCol.size());
+
+    fseek(f, (long)s->dataEnd, SEEK_SET);
+    if (fwrite(h, 1, sizeof(h), f) != sizeof(h) ||
+        fwrite(timeCol.data(), 1, timeCol.size(), f) != timeCol.size() ||
+        fwrite(tempCol.data(), 1, tempCol.size(), f) != tempCol.size() || fflush(f) != 0) {
+        return false;
+    }
+    s->dataEnd += sizeof(h) + timeCol.size() + tempCol.size();
+    s->points += count;
+    s->blocks++;
+    return true;
+}
+
+/**
+ * Read every stored point
+ * @return Points read, -1 if the file is damaged
+ */
+static long storeRead(const std::string& path, StoreState_t* s,
+                      const std::function<void(uint32_t bootId, uint32_t seq, uint32_t time, float temp)>& fn) {
+    FILE* f = storeOpen(path, s);
+    if (!f) {
+        return -1;
+    }
+    std::vector<uint8_t> data(s->dataEnd - STORE_HEADER_SIZE);
+    fseek(f, STORE_HEADER_SIZE, SEEK_SET);
+    bool ok = fread(data.data(), 1, data.size(), f) == data.size();
+    fclose(f);
+    if (!ok) {
+        return -1;
+    }
+
+    long total = 0;
+    for (size_t pos = 0; pos < data.size();) {
+        if (pos + BLOCK_HEADER_SIZE > data.size() || data[pos] != 'B') {
+            return -1;
+        }
+        const uint8_t* h = &data[pos];
+        uint32_t count = get32(h + 1), seq = get32(h + 5), bootId = get32(h + 9);
+        int64_t t = get32(h + 13), delta = 0, temp = 0;
+        size_t tp = pos + BLOCK_HEADER_SIZE;
+        size_t end = tp + get32(h + 17);
+        size_t vp = end;
+        size_t blockEnd = vp + get32(h + 21);
+        if (blockEnd > data.size()) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            int64_t dod, dtemp;
+            if (!getVarint(data.data(), end, &tp, &dod) || !getVarint(data.data(), blockEnd, &vp, &dtemp)) {
+                return -1;
+            }
+            delta += dod;
+            t += delta;
+            temp += dtemp;
+            fn(bootId, seq + i, (uint32_t)t, temp == TEMP_NONE ? NAN : temp / 10.0f);
+            total++;
+        }
+        pos = blockEnd;
+    }
+    return total;
+}
+
+// ===== SYNC =====
+
+typedef struct {
+    bool ok;
+    int requests;
+    size_t wireBytes;
+    uint32_t points;
+    uint32_t lost;
+    bool rebooted;
+} SyncResult_t;
+
+/**
+ * Pull everything new from one unit into its file
+ */
+static SyncResult_t syncDevice(const Device_t& dev, const std::string& dir, const std::string& pin) {
+    SyncResult_t r;
+    memset(&r, 0, sizeof(r));
+
+    StoreState_t s;
+    FILE* f = storeOpen(dir + "/" + dev.name + ".thc", &s);
+    if (!f) {
+        return r;
+    }
+    std::string cookie;
+    if (!login(dev, pin, &cookie, &r.wireBytes)) {
+        fclose(f);
+        return r;
+    }
+
+    bool known = s.blocks > 0;
+    std::vector<uint32_t> times(PULL_MAX);
+    std::vector<float> temps(PULL_MAX);
+    for (;;) {
+        uint32_t since = known ? s.nextSeq : 0;
+        HttpResult_t http;
+        r.requests++;
+        bool ok = httpRequest(dev, "GET", "/api/v1/history/bulk?since=" + std::to_string(since) +
+                              "&max=" + std::to_string(PULL_MAX), "", cookie, &http);
+        r.wireBytes += http.wireBytes;
+        if (!ok || http.status != 200) {
+            fclose(f);
+            return r;
+        }
+        HistoryBulkHeader_t h;
+        int count = history_bulk_decode((const uint8_t*)http.body.data(), http.body.size(), &h,
+                                        times.data(), temps.data(), PULL_MAX);
+        if (count < 0) {
+            fclose(f);
+            return r;
+        }
+
+        // Numbering restarted: start over from the new boot's first point
+        if (known && h.bootId != s.bootId) {
+            r.rebooted = true;
+            s.bootId = h.bootId;
+            s.nextSeq = 0;
+            if (since != 0) {
+                continue;
+            }
+        }
+        // Points that left the unit's buffer before we got here
+        if (known && h.firstSeq != since) {
+            r.lost += h.firstSeq - since;
+            s.lost += h.firstSeq - since;
+        }
+        if (count > 0 && !storeAppend(f, &s, h.bootId, h.firstSeq, times.data(), temps.data(), count)) {
+            fclose(f);
+            return r;
+        }
+        r.points += count;
+        s.bootId = h.bootId;
+        s.nextSeq = h.firstSeq + count;
+        known = true;
+        if (!(h.flags & HISTORY_BULK_MORE)) {
+            break;
+        }
+    }
+    writeStoreHeader(f, &s);
+    r.ok = fflush(f) == 0;
+    fclose(f);
+    return r;
+}
+
+typedef struct {
+    double seconds;
+    int ok;
+    int failed;
+    int requests;
+    size_t wireBytes;
+    uint64_t points;
+    uint64_t lost;
+    int rebooted;
+} RunStats_t;
+
+static RunStats_t syncAll(const std::vector<Device_t>& devices, const std::string& dir,
+                          const std::string& pin, int jobs) {
+    std::vector<SyncResult_t> results(devices.size());
+    double start = monoSeconds();
+    runParallel((int)devices.size(), jobs, [&](int i) { results[i] = syncDevice(devices[i], dir, pin); });
+
+    RunStats_t st;
+    memset(&st, 0, sizeof(st));
+    st.seconds = monoSeconds() - start;
+    for (size_t i = 0; i < results.size(); i++) {
+        const SyncResult_t& r = results[i];
+        (r.ok ? st.ok : st.failed)++;
+        st.requests += r.requests;
+        st.wireBytes += r.wireBytes;
+        st.points += r.points;
+        st.lost += r.lost;
+        st.rebooted += r.rebooted;
+        if (!r.ok) {
+            fprintf(stderr, "%s: sync failed\n", devices[i].name.c_str());
+        }
+    }
+    return st;
+}
+
+static RunStats_t pushAll(const std::vector<Device_t>& devices, const std::string& body, int output,
+                          const std::string& pin, int jobs) {
+    std::vector<HttpResult_t> results(devices.size());
+    std::vector<bool> oks(devices.size());
+    std::string path = "/api/output/" + std::to_string(output) + "/config";
+    double start = monoSeconds();
+    runParallel((int)devices.size(), jobs, [&](int i) {
+        std::string cookie;
+        size_t loginBytes = 0;
+        bool ok = login(devices[i], pin, &cookie, &loginBytes) &&
+                  httpRequest(devices[i], "POST", path, body, cookie, &results[i]) && results[i].status == 200;
+        results[i].wireBytes += loginBytes;
+        oks[i] = ok;
+    });
+
+    RunStats_t st;
+    memset(&st, 0, sizeof(st));
+    st.seconds = monoSeconds() - start;
+    for (size_t i = 0; i < results.size(); i++) {
+        (oks[i] ? st.ok : st.failed)++;
+        st.requests += pin.empty() ? 1 : 2;
+        st.wireBytes += results[i].wireBytes;
+        if (!oks[i]) {
+            fprintf(stderr, "%s: push failed (HTTP %d)\n", devices[i].name.c_str(), results[i].status);
+        }
+    }
+    return st;
+}
+
+static void printStats(const char* phase, size_t devices, int jobs, int latencyMs, const RunStats_t& st) {
+    printf("{\"phase\":\"%s\",\"devices\":%zu,\"jobs\":%d,\"latencyMs\":%d,\"seconds\":%.3f,"
+           "\"ok\":%d,\"failed\":%d,\"requests\":%d,\"points\":%llu,\"lost\":%llu,\"rebooted\":%d,"
+           "\"wireBytes\":%zu,\"devicesPerSec\":%.1f,\"pointsPerSec\":%.0f}\n",
+           phase, devices, jobs, latencyMs, st.seconds, st.ok, st.failed, st.requests,
+           (unsigned long long)st.points, (unsigned long long)st.lost, st.rebooted, st.wireBytes,
+           devices / st.seconds, st.points / st.seconds);
+    fflush(stdout);
+}
+
+// ===== STAND-IN UNITS =====
+
+/**
+ * Simulated unit: history buffer and API as on the device
+ */
+class SimUnit {
+public:
+    SimUnit(int port, int latencyMs, uint32_t seed)
+        : configs(0), port_(port), latencyMs_(latencyMs), rng_(seed), listenFd_(-1), stop_(false) {
+        reboot(1700000000);
+    }
+
+    bool start(void) {
+        listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port_);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listenFd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd_, 16) < 0) {
+            close(listenFd_);
+            return false;
+        }
+        thread_ = std::thread([this]() { serve(); });
+        return true;
+    }
+
+    void requestStop(void) {
+        stop_ = true;
+    }
+
+    void stop(void) {
+        stop_ = true;
+        thread_.join();
+        close(listenFd_);
+    }
+
+    // Record points at the 5 minute interval
+    void advance(int points) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int i = 0; i < points; i++) {
+            clock_ += 300;
+            phase_ += 0.02f;
+            float temp = 28.0f + 2.0f * sinf(phase_) + (float)(next() % 5) / 10.0f;
+            times_[nextSeq_ % PULL_MAX] = clock_;
+            temps_[nextSeq_ % PULL_MAX] = (nextSeq_ % 97 == 50) ? NAN : temp;   // Occasional bad read
+            nextSeq_++;
+        }
+        recorded += points;
+    }
+
+    // New boot: new ID, sequence numbers restart, buffer empty
+    void reboot(uint32_t clock) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bootId_ = next();
+        nextSeq_ = 0;
+        clock_ = clock;
+        phase_ = 0;
+    }
+
+    bool lastPoint(uint32_t* time, float* temp) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (nextSeq_ == 0) {
+            return false;
+        }
+        *time = times_[(nextSeq_ - 1) % PULL_MAX];
+        *temp = temps_[(nextSeq_ - 1) % PULL_MAX];
+        return true;
+    }
+
+    std::atomic<int> configs;
+    uint64_t recorded = 0;      // Points generated over all boots
+
+private:
+    uint32_t next(void) {
+        rng_ = rng_ * 1664525u + 1013904223u;
+        return rng_ >> 8;
+    }
+
+    void serve(void) {
+        while (!stop_) {
+            struct pollfd pfd = {listenFd_, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) {
+                continue;
+            }
+            int client = accept(listenFd_, nullptr, nullptr);
+            if (client >= 0) {
+                handle(client);
+                close(client);
+            }
+        }
+    }
+
+    void handle(int client) {
+        std::string req;
+        char buf[2048];
+        size_t headEnd;
+        while ((headEnd = req.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t n = recv(client, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                return;
+            }
+            req.append(buf, (size_t)n);
+        }
+        size_t cl = req.find("Content-Length: ");
+        size_t bodyLen = cl < headEnd ? strtoul(req.c_str() + cl + 16, nullptr, 10) : 0;
+        while (req.size() < headEnd + 4 + bodyLen) {
+            ssize_t n = recv(client, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                return;
+            }
+            req.append(buf, (size_t)n);
+        }
+        if (latencyMs_ > 0) {
+            usleep(latencyMs_ * 1000);
+        }
+
+        std::string type = "text/plain", body, extra;
+        int status = 200;
+        if (req.compare(0, 25, "GET /api/v1/history/bulk?") == 0) {
+            uint32_t since = 0;
+            int max = PULL_MAX;
+            const char* q = strstr(req.c_str(), "since=");
+            if (q) since = strtoul(q + 6, nullptr, 10);
+            q = strstr(req.c_str(), "max=");
+            if (q) max = atoi(q + 4);
+            type = "application/octet-stream";
+            body = bulk(since, max);
+        } else if (req.compare(0, 16, "POST /api/login ") == 0) {
+            extra = "Set-Cookie: session=standin; Path=/; HttpOnly\r\n";
+            body = "{\"success\":true}";
+        } else if (req.compare(0, 17, "POST /api/output/") == 0 && req.find("/config ") < headEnd) {
+            configs++;
+            body = "OK";
+        } else {
+            status = 404;
+            body = "Not found";
+        }
+
+        std::string resp = "HTTP/1.1 " + std::to_string(status) + (status == 200 ? " OK" : " Not Found") +
+                           "\r\nContent-Type: " + type + "\r\nContent-Length: " + std::to_string(body.size()) +
+                           "\r\n" + extra + "Connection: close\r\n\r\n" + body;
+        for (size_t off = 0; off < resp.size();) {
+            ssize_t n = send(client, resp.data() + off, resp.size() - off, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return;
+            }
+            off += (size_t)n;
+        }
+    }
+
+    // Same selection as handleHistoryBulk() in web_server.cpp
+    std::string bulk(uint32_t since, int max) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (max <= 0 || max > PULL_MAX) max = PULL_MAX;
+        uint32_t first = nextSeq_ > PULL_MAX ? nextSeq_ - PULL_MAX : 0;
+        uint32_t start = since;
+        if ((int32_t)(start - first) < 0) start = first;
+        if ((int32_t)(nextSeq_ - start) < 0) start = nextSeq_;
+        uint32_t available = nextSeq_ - start;
+        int count = available > (uint32_t)max ? max : (int)available;
+
+        HistoryBulkHeader_t h;
+        h.flags = available > (uint32_t)count ? HISTORY_BULK_MORE : 0;
+        h.bootId = bootId_;
+        h.firstSeq = start;
+        h.nextSeq = nextSeq_;
+        h.baseTime = count > 0 ? times_[start % PULL_MAX] : 0;
+        h.count = (uint16_t)count;
+        h.intervalSec = 300;
+
+        std::string out(HISTORY_BULK_HEADER_SIZE, '\0');
+        history_bulk_encode_header(&h, (uint8_t*)&out[0]);
+        uint32_t prev = h.baseTime;
+        for (int i = 0; i < count; i++) {
+            uint8_t item[HISTORY_BULK_POINT_MAX];
+            uint32_t seq = start + i;
+            size_t len = history_bulk_encode_point(&prev, times_[seq % PULL_MAX], temps_[seq % PULL_MAX], item);
+            out.append((const char*)item, len);
+        }
+        return out;
+    }
+
+    int port_;
+    int latencyMs_;
+    uint32_t rng_;
+    int listenFd_;
+    std::atomic<bool> stop_;
+    std::thread thread_;
+    std::mutex mutex_;
+
+    uint32_t bootId_ = 0;
+    uint32_t nextSeq_ = 0;
+    uint32_t clock_ = 0;
+    float phase_ = 0;
+    uint32_t times_[PULL_MAX];
+    float temps_[PULL_MAX];
+};
+
+static bool startUnits(int count, int basePort, int latencyMs, std::vector<SimUnit*>* units,
+                       std::vector<Device_t>* devices) {
+    for (int i = 0; i < count; i++) {
+        SimUnit* u = new SimUnit(basePort + i, latencyMs, 1234u + i);
+        if (!u->start()) {
+            fprintf(stderr, "cannot listen on 127.0.0.1:%d\n", basePort + i);
+            delete u;
+            return false;
+        }
+        units->push_back(u);
+        Device_t d;
+        d.host = "127.0.0.1";
+        d.port = basePort + i;
+        char name[32];
+        snprintf(name, sizeof(name), "unit%03d", i);
+        d.name = name;
+        devices->push_back(d);
+    }
+    return true;
+}
+
+// ===== COMMANDS =====
+
+static int cmdBench(int deviceCount, int jobs, int latencyMs) {
+    char dirTemplate[] = "/tmp/fleet_collector.XXXXXX";
+    if (!mkdtemp(dirTemplate)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    std::string dir = dirTemplate;
+
+    std::vector<SimUnit*> units;
+    std::vector<Device_t> devices;
+    if (!startUnits(deviceCount, 18100, latencyMs, &units, &devices)) {
+        return 1;
+    }
+    for (SimUnit* u : units) {
+        u->advance(PULL_MAX);   // A full day already recorded
+    }
+    const std::string pin;
+
+    // 1. First contact: each unit's whole buffer
+    RunStats_t st = syncAll(devices, dir, pin, jobs);
+    printStats("initial", devices.size(), jobs, latencyMs, st);
+
+    // 2. An hour later: 12 new points per unit
+    for (SimUnit* u : units) u->advance(12);
+    st = syncAll(devices, dir, pin, jobs);
+    printStats("incremental", devices.size(), jobs, latencyMs, st);
+
+    // 3. Nothing new
+    st = syncAll(devices, dir, pin, jobs);
+    printStats("idle", devices.size(), jobs, latencyMs, st);
+
+    // 4. Unit 0 rebooted, unit 1 was unreachable for 33 hours (112 points rolled out)
+    uint64_t expectLost = 0;
+    for (size_t i = 0; i < units.size(); i++) {
+        if (i == 0 && units.size() > 1) {
+            units[i]->reboot(1800000000);
+            units[i]->advance(5);
+        } else if (i == 1) {
+            units[i]->advance(PULL_MAX + 112);
+            expectLost = 112;
+        } else {
+            units[i]->advance(1);
+        }
+    }
+    st = syncAll(devices, dir, pin, jobs);
+    printStats("recovery", devices.size(), jobs, latencyMs, st);
+    bool ok = st.failed == 0 && st.lost == expectLost && st.rebooted == (units.size() > 1 ? 1 : 0);
+
+    // 5. One template to every unit
+    st = pushAll(devices, "{\"pid\":{\"kp\":12.0,\"ki\":0.4,\"kd\":6.0}}", 1, pin, jobs);
+    printStats("push", devices.size(), jobs, latencyMs, st);
+    for (SimUnit* u : units) {
+        ok = ok && u->configs == 1;
+    }
+
+    // Stored history must be every recorded point except the ones that rolled out
+    uint64_t stored = 0, fileBytes = 0, jsonBytes = 0;
+    for (size_t i = 0; i < units.size(); i++) {
+        StoreState_t s;
+        uint32_t lastTime = 0;
+        float lastTemp = 0;
+        char item[64];
+        long n = storeRead(dir + "/" + devices[i].name + ".thc", &s, [&](uint32_t, uint32_t, uint32_t t, float c) {
+            lastTime = t;
+            lastTemp = c;
+            jsonBytes += snprintf(item, sizeof(item), "{\"timestamp\":%lu,\"temperature\":%.1f},",
+                                  (unsigned long)t, c);
+        });
+        uint32_t wantTime;
+        float wantTemp;
+        bool match = n >= 0 && units[i]->lastPoint(&wantTime, &wantTemp) && lastTime == wantTime &&
+                     (isnan(wantTemp) ? isnan(lastTemp) : fabsf(lastTemp - wantTemp) < 0.051f) &&
+                     (uint64_t)n == units[i]->recorded - (i == 1 ? expectLost : 0);
+        if (!match) {
+            fprintf(stderr, "%s: stored history does not match (%ld points)\n", devices[i].name.c_str(), n);
+            ok = false;
+        }
+        stored += n > 0 ? n : 0;
+        fileBytes += s.dataEnd;
+    }
+    printf("{\"phase\":\"storage\",\"points\":%llu,\"fileBytes\":%llu,\"bytesPerPoint\":%.2f,"
+           "\"jsonBytesPerPoint\":%.1f,\"verified\":%s,\"dir\":\"%s\"}\n",
+           (unsigned long long)stored, (unsigned long long)fileBytes, (double)fileBytes / stored,
+           (double)jsonBytes / stored, ok ? "true" : "false", dir.c_str());
+
+    for (SimUnit* u : units) {
+        u->requestStop();
+    }
+    for (SimUnit* u : units) {
+        u->stop();
+        delete u;
+    }
+    return ok ? 0 : 1;
+}
+
+static int cmdStandin(int count, int basePort, int latencyMs) {
+    std::vector<SimUnit*> units;
+    std::vector<Device_t> devices;
+    if (!startUnits(count, basePort, latencyMs, &units, &devices)) {
+        return 1;
+    }
+    for (SimUnit* u : units) {
+        u->advance(PULL_MAX);
+    }
+    for (const Device_t& d : devices) {
+        printf("%s:%d %s\n", d.host.c_str(), d.port, d.name.c_str());
+    }
+    fflush(stdout);
+    fprintf(stderr, "%d units up, one new point per unit every 5s (Ctrl+C to stop)\n", count);
+    for (;;) {
+        sleep(5);
+        for (SimUnit* u : units) u->advance(1);
+    }
+}
+
+static int cmdDump(const char* path) {
+    StoreState_t s;
+    printf("boot_id,seq,timestamp,temperature\n");
+    long n = storeRead(path, &s, [](uint32_t bootId, uint32_t seq, uint32_t t, float c) {
+        if (isnan(c)) {
+            printf("%08x,%u,%u,\n", bootId, seq, t);
+        } else {
+            printf("%08x,%u,%u,%.1f\n", bootId, seq, t, c);
+        }
+    });
+    if (n < 0) {
+        fprintf(stderr, "%s: not a readable history file\n", path);
+        return 1;
+    }
+    fprintf(stderr, "%ld points, %u blocks, %u lost, %llu bytes\n", n, s.blocks, s.lost,
+            (unsigned long long)s.dataEnd);
+    return 0;
+}
+
+static const char* optArg(int argc, char** argv, const char* name, const char* def) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (!strcmp(argv[i], name)) {
+            return argv[i + 1];
+        }
+    }
+    return def;
+}
+
+int main(int argc, char** argv) {
+    int jobs = atoi(optArg(argc, argv, "--jobs", "16"));
+    int latencyMs = atoi(optArg(argc, argv, "--latency", "20"));
+    std::string pin = optArg(argc, argv, "--pin", "");
+    if (jobs < 1) {
+        jobs = 1;
+    }
+
+    if (argc >= 2 && !strcmp(argv[1], "bench")) {
+        return cmdBench(atoi(optArg(argc, argv, "--devices", "100")), jobs, latencyMs);
+    }
+    if (argc >= 3 && !strcmp(argv[1], "standin")) {
+        return cmdStandin(atoi(argv[2]), atoi(optArg(argc, argv, "--port", "18100")), latencyMs);
+    }
+    if (argc >= 3 && !strcmp(argv[1], "dump")) {
+        return cmdDump(argv[2]);
+    }
+    if (argc >= 4 && !strcmp(argv[1], "sync")) {
+        std::vector<Device_t> devices;
+        if (!loadDevices(argv[2], &devices)) {
+            return 1;
+        }
+        mkdir(argv[3], 0755);
+        RunStats_t st = syncAll(devices, argv[3], pin, jobs);
+        printStats("sync", devices.size(), jobs, 0, st);
+        return st.failed ? 1 : 0;
+    }
+    if (argc >= 4 && !strcmp(argv[1], "push")) {
+        std::vector<Device_t> devices;
+        FILE* f = fopen(argv[3], "rb");
+        if (!loadDevices(argv[2], &devices) || !f) {
+            if (!f) perror(argv[3]);
+            return 1;
+        }
+        std::string body;
+        char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            body.append(buf, n);
+        }
+        fclose(f);
+        int output = atoi(optArg(argc, argv, "--output", "1"));
+        if (output < 1 || output > 3) {
+            fprintf(stderr, "--output must be 1-3\n");
+            return 1;
+        }
+        RunStats_t st = pushAll(devices, body, output, pin, jobs);
+        printStats("push", devices.size(), jobs, 0, st);
+        return st.failed ? 1 : 0;
+    }
+
+    fprintf(stderr, "usage: %s sync DEVICES DIR [--jobs J] [--pin PIN]\n"
+                    "       %s push DEVICES TEMPLATE.json --output N [--jobs J] [--pin PIN]\n"
+                    "       %s dump FILE.thc\n"
+                    "       %s standin N [--port P] [--latency MS]\n"
+                    "       %s bench [--devices N] [--jobs J] [--latency MS]\n",
+            argv[0], argv[0], argv[0], argv[0], argv[0]);
+    return 1;
+}
@@ -0,0 +1,370 @@
+/**
+ * fleet_sim.cpp
+ * Host simulator for fleet status multicast
+ *
+ * Virtual thermostats that send the firmware's fleet frames
+ * (fleet_frame.cpp), for sizing an aggregator before buying hardware.
+ *
+ * bench: for 1, 10, 100 and 1000 nodes (up to --max), sends frames
+ *   time-compressed by --speedup to an in-process receiver running the
+ *   aggregator's receive path, and measures the receiver's thread CPU
+ *   time per frame and the cost of rendering GET /api/v1/fleet. Results
+ *   are extrapolated to the real 5s period: frames/s, bytes/s on the
+ *   wire and CPU %. Loopback unicast by default; --multicast uses the
+ *   real group over lo (ip link set lo multicast on;
+ *   ip route add 239.0.0.0/8 dev lo).
+ * send: runs N nodes at the real period against FLEET_GROUP, for
+ *   watching tools/fleet_aggregator or a unit's /fleet page.
+ *
+ * Build (from refactored/):
+ *   g++ -O2 -std=gnu++17 -pthread -Iinclude tools/fleet_sim.cpp src/network/fleet_frame.cpp -o fleet_sim
+ * Run:
+ *   ./fleet_sim bench [--max N] [--seconds S] [--speedup X] [--multicast]
+ *   ./fleet_sim send N [--iface LOCAL_IP]
+ * bench prints one JSON line per node count.
+ */
+
+#include "fleet_frame.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+// Ethernet (14 + 4 FCS) + IPv4 (20) + UDP (8) around each frame
+#define WIRE_OVERHEAD 46
+
+/**
+ * One virtual thermostat
+ */
+typedef struct {
+    FleetStatus_t status;
+} SimNode_t;
+
+static double monoSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double threadCpuSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void initNodes(std::vector<SimNode_t>& nodes) {
+    for (size_t i = 0; i < nodes.size(); i++) {
+        SimNode_t* n = &nodes[i];
+        memset(n, 0, sizeof(*n));
+        n->status.nodeId = 0x51000000u + (uint32_t)i;
+        snprintf(n->status.name, sizeof(n->status.name), "sim-%04u", (unsigned)(i % 10000));
+        n->status.outputCount = FLEET_OUTPUTS;
+        for (int o = 0; o < FLEET_OUTPUTS; o++) {
+            FleetOutput_t* out = &n->status.outputs[o];
+            out->target = 20.0f + (float)((i + o) % 8);
+            out->temp = out->target - 2.0f + (float)(rand() % 40) / 10.0f;
+            out->humidity = o == 2 ? 55.0f : NAN;
+            out->mode = 2;   // PID
+            out->flags = FLEET_OUT_ENABLED;
+        }
+    }
+}
+
+/**
+ * Advance one node by one period and encode its frame
+ */
+static size_t stepNode(SimNode_t* n, uint32_t uptimeSec, uint8_t* buf) {
+    for (int o = 0; o < FLEET_OUTPUTS; o++) {
+        FleetOutput_t* out = &n->status.outputs[o];
+        bool heating = out->temp < out->target;
+        out->temp += heating ? 0.05f : -0.05f;
+        out->temp += (float)(rand() % 11 - 5) / 100.0f;
+        out->power = heating ? 40 + rand() % 60 : 0;
+        out->flags = FLEET_OUT_ENABLED | (heating ? FLEET_OUT_HEATING : 0);
+    }
+    n->status.uptimeSec = uptimeSec;
+    size_t len = fleet_frame_encode(&n->status, buf, FLEET_FRAME_SIZE);
+    n->status.seq++;
+    return len;
+}
+
+static int openReceiver(bool multicast, uint16_t* port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    int rcvbuf = 8 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(multicast ? FLEET_PORT : 0);
+    addr.sin_addr.s_addr = htonl(multicast ? INADDR_ANY : INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    if (multicast) {
+        struct ip_mreq mreq;
+        inet_pton(AF_INET, FLEET_GROUP, &mreq.imr_multiaddr);
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(fd, (struct sockaddr*)&addr, &len);
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static int openSender(const char* iface) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int sndbuf = 8 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    unsigned char loop = 1;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    if (iface) {
+        struct in_addr ifaddr;
+        ifaddr.s_addr = inet_addr(iface);
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &ifaddr, sizeof(ifaddr));
+    }
+    return fd;
+}
+
+/**
+ * Aggregator receive path, timed with this thread's CPU clock
+ */
+typedef struct {
+    int fd;
+    FleetTable_t* table;
+    std::atomic<bool> stop;
+    double cpuSec;
+} Receiver_t;
+
+static void receiverThread(Receiver_t* r) {
+    double cpu0 = threadCpuSeconds();
+    uint8_t buf[FLEET_FRAME_SIZE + 1];
+    for (;;) {
+        struct pollfd pfd = {r->fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 20);
+        if (ready <= 0) {
+            if (r->stop.load()) {
+                break;
+            }
+            continue;
+        }
+        struct sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        ssize_t n;
+        while ((n = recvfrom(r->fd, buf, sizeof(buf), MSG_DONTWAIT, (struct sockaddr*)&from, &fromLen)) > 0) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            fleet_table_receive(r->table, buf, (size_t)n, from.sin_addr.s_addr,
+                                (uint32_t)(ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000));
+            fromLen = sizeof(from);
+        }
+    }
+    r->cpuSec = threadCpuSeconds() - cpu0;
+}
+
+/**
+ * Render GET /api/v1/fleet the way the aggregator does
+ * @return Response bytes
+ */
+static size_t renderFleet(const FleetTable_t* table) {
+    std::string out = "{\"ok\":true,\"data\":{\"enabled\":true,\"nodes\":[";
+    char item[768];
+    bool first = true;
+    for (int i = 0; i < table->capacity; i++) {
+        if (table->peers[i].used && fleet_peer_json(&table->peers[i], 0, false, item, sizeof(item))) {
+            out += first ? "" : ",";
+            out += item;
+            first = false;
+        }
+    }
+    out += "]}}";
+    return out.size();
+}
+
+static bool benchOne(int nodeCount, double seconds, double speedup, bool multicast) {
+    uint16_t port = 0;
+    int rx = openReceiver(multicast, &port);
+    int tx = openSender(multicast ? "127.0.0.1" : nullptr);
+    if (rx < 0 || tx < 0) {
+        fprintf(stderr, "cannot open sockets%s\n", multicast ? " (is there a multicast route?)" : "");
+        return false;
+    }
+    struct sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(port);
+    inet_pton(AF_INET, multicast ? FLEET_GROUP : "127.0.0.1", &dest.sin_addr);
+
+    std::vector<FleetPeer_t> storage(nodeCount);
+    FleetTable_t table;
+    fleet_table_init(&table, storage.data(), nodeCount);
+    Receiver_t r;
+    r.fd = rx;
+    r.table = &table;
+    r.stop = false;
+    r.cpuSec = 0;
+    std::thread thread(receiverThread, &r);
+
+    std::vector<SimNode_t> nodes(nodeCount);
+    initNodes(nodes);
+
+    // Each node sends once per compressed period, spread evenly across it
+    double period = FLEET_TX_PERIOD_MS / 1000.0 / speedup;
+    double gap = period / nodeCount;
+    uint64_t sent = 0;
+    uint8_t buf[FLEET_FRAME_SIZE];
+    double start = monoSeconds();
+    for (uint64_t k = 0;; k++) {
+        double due = start + k * gap;
+        double now = monoSeconds();
+        if (due - start >= seconds) {
+            break;
+        }
+        if (due > now) {
+            struct timespec ts = {(time_t)(due - now), (long)(fmod(due - now, 1.0) * 1e9)};
+            nanosleep(&ts, nullptr);
+        }
+        SimNode_t* n = &nodes[k % nodeCount];
+        size_t len = stepNode(n, (uint32_t)(k / nodeCount * FLEET_TX_PERIOD_MS / 1000), buf);
+        if (sendto(tx, buf, len, 0, (struct sockaddr*)&dest, sizeof(dest)) == (ssize_t)len) {
+            sent++;
+        }
+    }
+    double elapsed = monoSeconds() - start;
+    usleep(100000);
+    r.stop = true;
+    thread.join();
+    close(rx);
+    close(tx);
+
+    uint64_t lost = 0;
+    for (int i = 0; i < nodeCount; i++) {
+        lost += storage[i].lost;
+    }
+
+    const int renders = 20;
+    double render0 = threadCpuSeconds();
+    size_t jsonBytes = 0;
+    for (int i = 0; i < renders; i++) {
+        jsonBytes = renderFleet(&table);
+    }
+    double renderUs = (threadCpuSeconds() - render0) * 1e6 / renders;
+
+    // Extrapolate to the real period
+    double usPerFrame = table.framesIn ? r.cpuSec * 1e6 / table.framesIn : 0;
+    double realFps = nodeCount * 1000.0 / FLEET_TX_PERIOD_MS;
+    printf("{\"nodes\":%d,\"transport\":\"%s\",\"seconds\":%.2f,\"sent\":%llu,\"received\":%u,"
+           "\"dropped\":%llu,\"seqLost\":%llu,\"rejected\":%u,\"rxUsPerFrame\":%.2f,"
+           "\"realFramesPerSec\":%.1f,\"realWireBytesPerSec\":%.0f,\"realPayloadBytesPerSec\":%.0f,"
+           "\"realRxCpuPct\":%.4f,\"apiJsonBytes\":%zu,\"apiRenderUs\":%.1f}\n",
+           nodeCount, multicast ? "multicast" : "loopback", elapsed, (unsigned long long)sent, table.framesIn,
+           (unsigned long long)(sent - table.framesIn), (unsigned long long)lost, table.rejected,
+           usPerFrame, realFps, realFps * (FLEET_FRAME_SIZE + WIRE_OVERHEAD), realFps * FLEET_FRAME_SIZE,
+           usPerFrame * realFps / 1e4, jsonBytes, renderUs);
+    fflush(stdout);
+    return true;
+}
+
+static int runSend(int nodeCount, const char* iface) {
+    int tx = openSender(iface);
+    if (tx < 0) {
+        perror("socket");
+        return 1;
+    }
+    struct sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(FLEET_PORT);
+    inet_pton(AF_INET, FLEET_GROUP, &dest.sin_addr);
+
+    std::vector<SimNode_t> nodes(nodeCount);
+    initNodes(nodes);
+    printf("Sending %d nodes to %s:%d every %dms (Ctrl+C to stop)\n", nodeCount, FLEET_GROUP, FLEET_PORT,
+           FLEET_TX_PERIOD_MS);
+
+    double gap = FLEET_TX_PERIOD_MS / 1000.0 / nodeCount;
+    double start = monoSeconds();
+    uint8_t buf[FLEET_FRAME_SIZE];
+    for (uint64_t k = 0;; k++) {
+        double due = start + k * gap;
+        double now = monoSeconds();
+        if (due > now) {
+            struct timespec ts = {(time_t)(due - now), (long)(fmod(due - now, 1.0) * 1e9)};
+            nanosleep(&ts, nullptr);
+        }
+        size_t len = stepNode(&nodes[k % nodeCount], (uint32_t)(monoSeconds() - start), buf);
+        if (sendto(tx, buf, len, 0, (struct sockaddr*)&dest, sizeof(dest)) != (ssize_t)len) {
+            perror("sendto");
+            return 1;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && !strcmp(argv[1], "bench")) {
+        int maxNodes = 1000;
+        double seconds = 3.0;
+        double speedup = 50.0;
+        bool multicast = false;
+        for (int i = 2; i < argc; i++) {
+            if (!strcmp(argv[i], "--max") && i + 1 < argc) {
+                maxNodes = atoi(argv[++i]);
+            } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+                seconds = atof(argv[++i]);
+            } else if (!strcmp(argv[i], "--speedup") && i + 1 < argc) {
+                speedup = atof(argv[++i]);
+            } else if (!strcmp(argv[i], "--multicast")) {
+                multicast = true;
+            } else {
+                fprintf(stderr, "unknown option %s\n", argv[i]);
+                return 1;
+            }
+        }
+        if (seconds <= 0 || speedup <= 0) {
+            fprintf(stderr, "--seconds and --speedup must be positive\n");
+            return 1;
+        }
+        srand(1);
+        for (int n = 1; n <= maxNodes; n *= 10) {
+            if (!benchOne(n, seconds, speedup, multicast)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    if (argc >= 3 && !strcmp(argv[1], "send")) {
+        int nodeCount = atoi(argv[2]);
+        const char* iface = (argc >= 5 && !strcmp(argv[3], "--iface")) ? argv[4] : nullptr;
+        if (nodeCount < 1) {
+            fprintf(stderr, "node count must be positive\n");
+            return 1;
+        }
+        return runSend(nodeCount, iface);
+    }
+    fprintf(stderr, "usage: %s bench [--max N] [--seconds S] [--speedup X] [--multicast]\n"
+                    "       %s send N [--iface LOCAL_IP]\n", argv[0], argv[0]);
+    return 1;
+}
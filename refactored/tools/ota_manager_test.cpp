@@ -0,0 +1,319 @@
+/**
+ * ota_manager_test.cpp
+ * Host test for the OTA manifest parser and image verification
+ *
+ * Runs the firmware's ota_manager.cpp against the host/ stand-ins:
+ * manifest and digest parsing, delta selection, and begin/write/end
+ * sessions whose size and SHA-256 checks must pass or fail as on the
+ * device (Update accepts the image via host_ota_accept()).
+ *
+ * Build and run (from refactored/):
+ *   pio run -e ota-test && .pio/build/ota-test/program
+ * Prints one line per failed check and exits 1 if there was any.
+ */
+
+#include "console.h"
+#include "host.h"
+#include "ota_manager.h"
+#include <dirent.h>
+#include <mbedtls/sha256.h>
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#define IMAGE_SIZE 5000          // Several OTA_CHUNK_SIZE writes plus a partial one
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+// sha256 of IMAGE_SIZE bytes of makeImage(), filled in by main()
+static char imageHex[OTA_SHA256_LEN * 2 + 1];
+static char dataDir[] = "/tmp/ota_test.XXXXXX";
+static int checks = 0;
+static int failures = 0;
+
+// ===== HOST PROCESS =====
+
+const char* host_data_dir(void) {
+    return dataDir;
+}
+
+uint16_t host_http_port(void) {
+    return 0;
+}
+
+uint32_t host_local_ip(void) {
+    return 0;
+}
+
+bool host_restarted(void) {
+    return false;
+}
+
+void host_restart(void) {
+    fprintf(stderr, "ota_manager_test: firmware asked to restart\n");
+    _exit(1);
+}
+
+// ===== HELPERS =====
+
+static void check(bool ok, const char* what, int line) {
+    checks++;
+    if (!ok) {
+        failures++;
+        fprintf(stderr, "FAIL line %d: %s\n", line, what);
+    }
+}
+
+static std::vector<uint8_t> makeImage(size_t size) {
+    std::vector<uint8_t> image(size);
+    for (size_t i = 0; i < size; i++) {
+        image[i] = (uint8_t)(i * 31 + (i >> 8));
+    }
+    return image;
+}
+
+static void sha256(const uint8_t* data, size_t len, uint8_t out[OTA_SHA256_LEN]) {
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts_ret(&ctx, 0);
+    mbedtls_sha256_update_ret(&ctx, data, len);
+    mbedtls_sha256_finish_ret(&ctx, out);
+    mbedtls_sha256_free(&ctx);
+}
+
+/**
+ * Build a manifest around the given fields
+ */
+static std::string manifest(const char* version, const char* file, const char* sha, const char* deltas = nullptr) {
+    std::string json = std::string("{\"version\":\"") + version + "\",\"file\":\"" + file +
+                       "\",\"size\":" + std::to_string(IMAGE_SIZE) + ",\"sha256\":\"" + sha + "\"";
+    if (deltas) {
+        json += std::string(",\"deltas\":") + deltas;
+    }
+    return json + "}";
+}
+
+static bool parse(const std::string& json, const char* running, OtaManifest_t* out) {
+    memset(out, 0xAA, sizeof(*out));
+    return ota_manager_parse_manifest(json.c_str(), running, out);
+}
+
+/**
+ * One session: begin, write in OTA_CHUNK_SIZE pieces, end
+ */
+static bool install(const std::vector<uint8_t>& image, size_t declaredSize, const uint8_t* digest) {
+    if (!ota_manager_begin(declaredSize, digest)) {
+        return false;
+    }
+    for (size_t pos = 0; pos < image.size(); pos += OTA_CHUNK_SIZE) {
+        size_t len = image.size() - pos < OTA_CHUNK_SIZE ? image.size() - pos : OTA_CHUNK_SIZE;
+        if (!ota_manager_write(image.data() + pos, len)) {
+            return false;
+        }
+    }
+    return ota_manager_end();
+}
+
+static void removeDataDir(void) {
+    DIR* dir = opendir(dataDir);
+    struct dirent* entry;
+    while (dir && (entry = readdir(dir))) {
+        if (entry->d_name[0] != '.') {
+            std::string path = std::string(dataDir) + "/" + entry->d_name;
+            unlink(path.c_str());
+        }
+    }
+    if (dir) closedir(dir);
+    rmdir(dataDir);
+}
+
+// ===== SHA-256 TEXT =====
+
+static void testParseSha256(void) {
+    uint8_t digest[OTA_SHA256_LEN];
+    uint8_t upper[OTA_SHA256_LEN];
+    char hex[OTA_SHA256_LEN * 2 + 1];
+
+    CHECK(ota_manager_parse_sha256(imageHex, digest));
+    ota_manager_format_sha256(digest, hex);
+    CHECK(strcmp(hex, imageHex) == 0);
+
+    // Uppercase parses to the same digest
+    std::string text = imageHex;
+    for (char& c : text) c = (char)toupper(c);
+    CHECK(ota_manager_parse_sha256(text.c_str(), upper));
+    CHECK(memcmp(upper, digest, OTA_SHA256_LEN) == 0);
+
+    // Short, long, empty and non-hex
+    CHECK(!ota_manager_parse_sha256(std::string(imageHex, 63).c_str(), digest));
+    CHECK(!ota_manager_parse_sha256((std::string(imageHex) + "0").c_str(), digest));
+    CHECK(!ota_manager_parse_sha256("", digest));
+    CHECK(!ota_manager_parse_sha256(nullptr, digest));
+    text = imageHex;
+    text[10] = 'g';
+    CHECK(!ota_manager_parse_sha256(text.c_str(), digest));
+    text[10] = ' ';
+    CHECK(!ota_manager_parse_sha256(text.c_str(), digest));
+}
+
+// ===== MANIFEST =====
+
+static void testParseManifest(void) {
+    OtaManifest_t m;
+    uint8_t digest[OTA_SHA256_LEN];
+    ota_manager_parse_sha256(imageHex, digest);
+
+    // Valid, no deltas
+    CHECK(parse(manifest("2.4.0", "firmware.bin", imageHex), "2.3.0", &m));
+    CHECK(strcmp(m.version, "2.4.0") == 0);
+    CHECK(strcmp(m.file, "firmware.bin") == 0);
+    CHECK(m.size == IMAGE_SIZE);
+    CHECK(memcmp(m.sha256, digest, OTA_SHA256_LEN) == 0);
+    CHECK(m.deltaFile[0] == '\0' && m.deltaSize == 0);
+
+    // Malformed JSON and missing fields
+    CHECK(!parse("{\"version\":\"2.4.0\"", nullptr, &m));
+    CHECK(!parse(manifest("", "firmware.bin", imageHex), nullptr, &m));
+    CHECK(!parse(manifest("2.4.0", "", imageHex), nullptr, &m));
+    CHECK(!parse("{\"version\":\"2.4.0\",\"file\":\"firmware.bin\"}", nullptr, &m));
+
+    // File names are appended to the release URL: no paths
+    CHECK(!parse(manifest("2.4.0", "../firmware.bin", imageHex), nullptr, &m));
+    CHECK(!parse(manifest("2.4.0", "bin/firmware.bin", imageHex), nullptr, &m));
+    CHECK(!parse(manifest("2.4.0", "/firmware.bin", imageHex), nullptr, &m));
+    CHECK(!parse(manifest("2.4.0", "..", imageHex), nullptr, &m));
+
+    // Fields must fit OtaManifest_t
+    std::string version(sizeof(m.version) - 1, '9');
+    CHECK(parse(manifest(version.c_str(), "firmware.bin", imageHex), nullptr, &m));
+    CHECK(strcmp(m.version, version.c_str()) == 0);
+    version += "9";
+    CHECK(!parse(manifest(version.c_str(), "firmware.bin", imageHex), nullptr, &m));
+    std::string file(sizeof(m.file), 'f');
+    CHECK(!parse(manifest("2.4.0", file.c_str(), imageHex), nullptr, &m));
+
+    // Digest must be 64 hex digits (either case)
+    std::string sha = imageHex;
+    CHECK(!parse(manifest("2.4.0", "firmware.bin", sha.substr(0, 63).c_str()), nullptr, &m));
+    sha[0] = 'x';
+    CHECK(!parse(manifest("2.4.0", "firmware.bin", sha.c_str()), nullptr, &m));
+    sha = imageHex;
+    for (char& c : sha) c = (char)toupper(c);
+    CHECK(parse(manifest("2.4.0", "firmware.bin", sha.c_str()), nullptr, &m));
+    CHECK(memcmp(m.sha256, digest, OTA_SHA256_LEN) == 0);
+}
+
+static void testDeltaSelection(void) {
+    OtaManifest_t m;
+    const char* deltas =
+        "[{\"from\":\"2.2.0\",\"file\":\"firmware-from-2.2.0.tdp\",\"size\":51234},"
+        "{\"from\":\"2.3.0\",\"file\":\"firmware-from-2.3.0.tdp\",\"size\":48213}]";
+
+    // Entry picked by "from"
+    CHECK(parse(manifest("2.4.0", "firmware.bin", imageHex, deltas), "2.3.0", &m));
+    CHECK(strcmp(m.deltaFile, "firmware-from-2.3.0.tdp") == 0);
+    CHECK(m.deltaSize == 48213);
+    CHECK(parse(manifest("2.4.0", "firmware.bin", imageHex, deltas), "2.2.0", &m));
+    CHECK(strcmp(m.deltaFile, "firmware-from-2.2.0.tdp") == 0);
+    CHECK(m.deltaSize == 51234);
+
+    // No entry for the running version, or full image only
+    CHECK(parse(manifest("2.4.0", "firmware.bin", imageHex, deltas), "2.1.0", &m));
+    CHECK(m.deltaFile[0] == '\0' && m.deltaSize == 0);
+    CHECK(parse(manifest("2.4.0", "firmware.bin", imageHex, deltas), nullptr, &m));
+    CHECK(m.deltaFile[0] == '\0');
+
+    // A matching entry with a path is skipped, not fatal
+    CHECK(parse(manifest("2.4.0", "firmware.bin", imageHex,
+                         "[{\"from\":\"2.3.0\",\"file\":\"../x.tdp\",\"size\":10},"
+                         "{\"from\":\"2.3.0\",\"file\":\"ok.tdp\",\"size\":20}]"), "2.3.0", &m));
+    CHECK(strcmp(m.deltaFile, "ok.tdp") == 0 && m.deltaSize == 20);
+
+    // A delta needs the full image size to check the rebuilt image against
+    CHECK(parse("{\"version\":\"2.4.0\",\"file\":\"firmware.bin\",\"sha256\":\"" + std::string(imageHex) +
+                "\",\"deltas\":" + deltas + "}", "2.3.0", &m));
+    CHECK(m.size == 0 && m.deltaFile[0] == '\0');
+}
+
+// ===== SESSIONS =====
+
+static void testSessions(void) {
+    std::vector<uint8_t> image = makeImage(IMAGE_SIZE);
+    uint8_t digest[OTA_SHA256_LEN];
+    ota_manager_parse_sha256(imageHex, digest);
+
+    // Matching image
+    CHECK(install(image, image.size(), digest));
+    CHECK(ota_manager_get_state() == OTA_STATE_READY);
+    CHECK(ota_manager_get_error() == OTA_ERR_NONE);
+    CHECK(ota_manager_get_progress() == IMAGE_SIZE);
+    CHECK(memcmp(ota_manager_get_last_sha256(), digest, OTA_SHA256_LEN) == 0);
+    CHECK(!ota_manager_image_unverified());
+
+    // One flipped byte in the image
+    std::vector<uint8_t> corrupt = image;
+    corrupt[IMAGE_SIZE / 2] ^= 0x01;
+    CHECK(!install(corrupt, corrupt.size(), digest));
+    CHECK(ota_manager_get_state() == OTA_STATE_FAILED);
+    CHECK(ota_manager_get_error() == OTA_ERR_HASH);
+
+    // One flipped byte in the expected digest
+    uint8_t wrong[OTA_SHA256_LEN];
+    memcpy(wrong, digest, sizeof(wrong));
+    wrong[OTA_SHA256_LEN - 1] ^= 0x80;
+    CHECK(!install(image, image.size(), wrong));
+    CHECK(ota_manager_get_error() == OTA_ERR_HASH);
+
+    // Short image (one byte missing)
+    std::vector<uint8_t> shortImage(image.begin(), image.end() - 1);
+    CHECK(!install(shortImage, image.size(), digest));
+    CHECK(ota_manager_get_state() == OTA_STATE_FAILED);
+    CHECK(ota_manager_get_error() == OTA_ERR_SIZE);
+
+    // Longer than declared: rejected at the write that overruns
+    std::vector<uint8_t> longImage = image;
+    longImage.push_back(0);
+    CHECK(!install(longImage, image.size(), nullptr));
+    CHECK(ota_manager_get_error() == OTA_ERR_SIZE);
+
+    // Unknown size and no digest (manual upload): accepted as written,
+    // flagged unverified until an image with a digest replaces it
+    CHECK(install(corrupt, 0, nullptr));
+    CHECK(ota_manager_get_state() == OTA_STATE_READY);
+    CHECK(ota_manager_image_unverified());
+    CHECK(install(image, image.size(), digest));
+    CHECK(!ota_manager_image_unverified());
+
+    // end() without a session
+    CHECK(!ota_manager_end());
+}
+
+int main(void) {
+    if (!mkdtemp(dataDir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    console_init();
+    ota_manager_init();
+    host_ota_accept(true);
+
+    // Digest routine against the FIPS 180-2 "abc" vector, then the test image
+    uint8_t digest[OTA_SHA256_LEN];
+    char hex[OTA_SHA256_LEN * 2 + 1];
+    sha256((const uint8_t*)"abc", 3, digest);
+    ota_manager_format_sha256(digest, hex);
+    CHECK(strcmp(hex, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad") == 0);
+    std::vector<uint8_t> image = makeImage(IMAGE_SIZE);
+    sha256(image.data(), image.size(), digest);
+    ota_manager_format_sha256(digest, imageHex);
+
+    testParseSha256();
+    testParseManifest();
+    testDeltaSelection();
+    testSessions();
+
+    removeDataDir();
+    printf("ota_manager_test: %d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
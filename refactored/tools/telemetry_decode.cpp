@@ -0,0 +1,334 @@
+/**
+ * telemetry_decode.cpp
+ * Host decoder and bandwidth benchmark for compact MQTT telemetry
+ *
+ * decode: turns {base}/telemetry frames (telemetry_frame.cpp) back into
+ *   JSON with the same keys as the {base}/outputN/status payloads, one
+ *   line per frame. Takes a hex frame as an argument, or reads
+ *   "topic hex" / "hex" lines from stdin, which is what
+ *   mosquitto_sub -v -F '%t %x' prints.
+ * bench: bytes per day for the JSON and compact publish modes at the
+ *   firmware's 30s period, at the MQTT layer and on the wire. The wire
+ *   estimate assumes one TCP segment per MQTT packet (IPv4 + TCP with
+ *   timestamps, 52 bytes), one pure ACK per segment, and a keepalive
+ *   ping every keepalive interval (PubSubClient pings on inbound
+ *   silence, so QoS 0 publishing doesn't suppress them).
+ *
+ * Build (from refactored/):
+ *   g++ -O2 -std=gnu++17 -Iinclude tools/telemetry_decode.cpp src/network/telemetry_frame.cpp -o telemetry_decode
+ * Run:
+ *   ./telemetry_decode HEX
+ *   mosquitto_sub -h BROKER -v -F '%t %x' -t 'reptile/+/telemetry' | ./telemetry_decode
+ *   ./telemetry_decode bench [--period S] [--base TOPIC]
+ * bench prints one JSON line per mode.
+ */
+
+#include "telemetry_frame.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TCP_IP_HEADER 52
+#define DEFAULT_KEEPALIVE_S 15      // PubSubClient MQTT_KEEPALIVE
+#define COMPACT_KEEPALIVE_S 120     // mqtt_manager.cpp in compact mode
+#define SECONDS_PER_DAY 86400
+
+// Same names as output_manager_get_mode_name()
+static const char* MODE_NAMES[] = {"Off", "Manual", "PID", "OnOff", "Schedule", "TimeProp", "Cascade", "Humidity"};
+
+static const char* modeName(uint8_t mode) {
+    return mode < sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0]) ? MODE_NAMES[mode] : "Unknown";
+}
+
+static const char* jsonBool(bool v) {
+    return v ? "true" : "false";
+}
+
+// ===== DECODE =====
+
+/**
+ * Parse hex (whitespace allowed between bytes)
+ * @return Bytes parsed, -1 on a bad digit or overflow
+ */
+static int parseHex(const char* s, uint8_t* buf, int max) {
+    int len = 0;
+    while (*s) {
+        if (isspace((unsigned char)*s)) {
+            s++;
+            continue;
+        }
+        if (!isxdigit((unsigned char)s[0]) || !isxdigit((unsigned char)s[1]) || len >= max) {
+            return -1;
+        }
+        char byte[3] = {s[0], s[1], '\0'};
+        buf[len++] = (uint8_t)strtoul(byte, nullptr, 16);
+        s += 2;
+    }
+    return len;
+}
+
+/**
+ * Print a decoded frame as one JSON line
+ */
+static void printTelemetry(const Telemetry_t* t, const char* topic) {
+    printf("{");
+    if (topic) {
+        printf("\"topic\":\"%s\",", topic);
+    }
+    printf("\"seq\":%u,\"uptime\":%u,\"wifi_rssi\":%d,\"free_heap\":%u,\"heap_largest\":%u,\"safe_mode\":%s,\"outputs\":[",
+           t->seq, t->uptimeSec, t->rssi, t->heapFree, t->heapLargest,
+           jsonBool(t->flags & TELEMETRY_SYS_SAFE_MODE));
+    for (int i = 0; i < t->outputCount; i++) {
+        const TelemetryOutput_t* o = &t->outputs[i];
+        printf("%s{\"output\":%d,", i ? "," : "", i + 1);
+        if (isnan(o->temp)) {
+            printf("\"temperature\":null,");
+        } else {
+            printf("\"temperature\":%.1f,", o->temp);
+        }
+        if (!isnan(o->humidity)) {
+            printf("\"humidity\":%.1f,", o->humidity);
+        }
+        printf("\"setpoint\":%.1f,\"heating\":%s,\"mode\":\"%s\",\"power\":%u,\"power_w\":%.1f,"
+               "\"energy_kwh\":%.3f,\"enabled\":%s,\"fault\":%s}",
+               o->target, jsonBool(o->flags & TELEMETRY_OUT_HEATING), modeName(o->mode), o->power,
+               o->powerW, o->energyWh / 1000.0, jsonBool(o->flags & TELEMETRY_OUT_ENABLED),
+               jsonBool(o->flags & TELEMETRY_OUT_FAULT));
+    }
+    printf("]}\n");
+}
+
+/**
+ * Decode one hex frame
+ * @return true if it was a valid frame
+ */
+static bool decodeHex(const char* hex, const char* topic) {
+    uint8_t buf[256];
+    int len = parseHex(hex, buf, sizeof(buf));
+    Telemetry_t t;
+    if (len < 0 || !telemetry_frame_decode(buf, len, &t)) {
+        fprintf(stderr, "not a v%d telemetry frame (%d bytes)%s%s\n", TELEMETRY_VERSION, len,
+                topic ? " on " : "", topic ? topic : "");
+        return false;
+    }
+    printTelemetry(&t, topic);
+    return true;
+}
+
+/**
+ * Decode "topic hex" or "hex" lines until EOF
+ */
+static int decodeStdin(void) {
+    char line[1024];
+    int bad = 0;
+    while (fgets(line, sizeof(line), stdin)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char* space = strchr(line, ' ');
+        if (space && strchr(line, '/') && strchr(line, '/') < space) {
+            *space = '\0';
+            bad += !decodeHex(space + 1, line);
+        } else if (line[0]) {
+            bad += !decodeHex(line, nullptr);
+        }
+        fflush(stdout);
+    }
+    return bad ? 1 : 0;
+}
+
+// ===== BENCH =====
+
+/**
+ * Size of a QoS 0 PUBLISH packet
+ */
+static size_t publishSize(const char* topic, size_t payloadLen) {
+    size_t remaining = 2 + strlen(topic) + payloadLen;
+    size_t lengthBytes = remaining < 128 ? 1 : remaining < 16384 ? 2 : 3;
+    return 1 + lengthBytes + remaining;
+}
+
+/**
+ * Per-day traffic for one publish mode
+ */
+typedef struct {
+    unsigned packetsPerPeriod;
+    size_t payloadPerPeriod;
+    size_t mqttPerPeriod;
+} PeriodTraffic_t;
+
+static void addPublish(PeriodTraffic_t* traffic, const char* topic, size_t len) {
+    traffic->packetsPerPeriod++;
+    traffic->payloadPerPeriod += len;
+    traffic->mqttPerPeriod += publishSize(topic, len);
+}
+
+/**
+ * Sample unit: three outputs, humidity on the first
+ */
+static void sampleTelemetry(Telemetry_t* t) {
+    static const float temps[] = {31.4f, 26.8f, 62.5f};
+    static const float targets[] = {32.0f, 27.0f, 60.0f};
+    static const uint8_t powers[] = {42, 0, 100};
+    static const uint8_t modes[] = {2, 5, 7};
+    static const float watts[] = {42.5f, 0.0f, 12.0f};
+    static const uint32_t energy[] = {18234, 9120, 2210};
+
+    memset(t, 0, sizeof(*t));
+    t->seq = 2880;
+    t->uptimeSec = 864000;
+    t->rssi = -67;
+    t->heapFree = 182344;
+    t->heapLargest = 110580;
+    t->outputCount = 3;
+    for (int i = 0; i < 3; i++) {
+        TelemetryOutput_t* o = &t->outputs[i];
+        o->temp = temps[i];
+        o->target = targets[i];
+        o->humidity = i == 0 ? 61.5f : NAN;
+        o->power = powers[i];
+        o->mode = modes[i];
+        o->flags = TELEMETRY_OUT_ENABLED | (powers[i] ? TELEMETRY_OUT_HEATING : 0);
+        o->powerW = watts[i];
+        o->energyWh = energy[i];
+    }
+}
+
+/**
+ * The JSON mode's publishes (mqtt_publish_all_outputs)
+ */
+static void jsonPeriod(const Telemetry_t* t, const char* base, PeriodTraffic_t* traffic) {
+    char topic[128];
+    char payload[512];
+    for (int i = 0; i < t->outputCount; i++) {
+        const TelemetryOutput_t* o = &t->outputs[i];
+        int n = i + 1;
+        bool heating = o->flags & TELEMETRY_OUT_HEATING;
+
+        snprintf(topic, sizeof(topic), "%s/output%d/temperature", base, n);
+        addPublish(traffic, topic, snprintf(payload, sizeof(payload), "%.1f", o->temp));
+        snprintf(topic, sizeof(topic), "%s/output%d/setpoint", base, n);
+        addPublish(traffic, topic, snprintf(payload, sizeof(payload), "%.1f", o->target));
+        snprintf(topic, sizeof(topic), "%s/output%d/state", base, n);
+        addPublish(traffic, topic, snprintf(payload, sizeof(payload), "%s", heating ? "heating" : "idle"));
+        snprintf(topic, sizeof(topic), "%s/output%d/mode", base, n);
+        addPublish(traffic, topic, snprintf(payload, sizeof(payload), "%s", o->mode ? "heat" : "off"));
+        snprintf(topic, sizeof(topic), "%s/output%d/power", base, n);
+        addPublish(traffic, topic, snprintf(payload, sizeof(payload), "%u", o->power));
+
+        // Same keys and number formatting as ArduinoJson writes them
+        int len = snprintf(payload, sizeof(payload), "{\"temperature\":%g,", o->temp);
+        if (!isnan(o->humidity)) {
+            len += snprintf(payload + len, sizeof(payload) - len, "\"humidity\":%g,", o->humidity);
+        }
+        len += snprintf(payload + len, sizeof(payload) - len,
+                        "\"setpoint\":%g,\"heating\":%s,\"mode\":\"%s\",\"power\":%u,\"power_w\":%g,"
+                        "\"energy_kwh\":%g,\"enabled\":true,\"name\":\"Output %d\"",
+                        o->target, jsonBool(heating), modeName(o->mode), o->power, o->powerW,
+                        o->energyWh / 1000.0, n);
+        if (i == 0) {
+            len += snprintf(payload + len, sizeof(payload) - len,
+                            ",\"wifi_rssi\":%d,\"free_heap\":%u,\"uptime\":%u,\"heap_largest\":%u,"
+                            "\"heap_frag\":%d,\"heap_trend\":%d",
+                            t->rssi, t->heapFree, t->uptimeSec, t->heapLargest, 39, -120);
+        }
+        len += snprintf(payload + len, sizeof(payload) - len, "}");
+        snprintf(topic, sizeof(topic), "%s/output%d/status", base, n);
+        addPublish(traffic, topic, len);
+    }
+}
+
+/**
+ * The compact mode's publish
+ */
+static void compactPeriod(const Telemetry_t* t, const char* base, PeriodTraffic_t* traffic) {
+    char topic[128];
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    snprintf(topic, sizeof(topic), "%s/telemetry", base);
+    addPublish(traffic, topic, telemetry_frame_encode(t, frame, sizeof(frame)));
+}
+
+static void printDay(const char* mode, const PeriodTraffic_t* traffic, int periodSec, int keepaliveSec) {
+    double periods = (double)SECONDS_PER_DAY / periodSec;
+    double pings = (double)SECONDS_PER_DAY / keepaliveSec;
+
+    // PINGREQ + PINGRESP (2 bytes each) and their segments; each segment is ACKed
+    double mqtt = periods * traffic->mqttPerPeriod + pings * 4;
+    double wire = periods * (traffic->mqttPerPeriod + traffic->packetsPerPeriod * 2.0 * TCP_IP_HEADER) +
+                  pings * (4 + 4.0 * TCP_IP_HEADER);
+    printf("{\"mode\":\"%s\",\"periodSec\":%d,\"keepaliveSec\":%d,\"publishesPerPeriod\":%u,"
+           "\"payloadBytesPerPeriod\":%zu,\"mqttBytesPerPeriod\":%zu,\"mqttBytesPerDay\":%.0f,"
+           "\"wireBytesPerDay\":%.0f,\"wireMBPer30Days\":%.1f}\n",
+           mode, periodSec, keepaliveSec, traffic->packetsPerPeriod, traffic->payloadPerPeriod,
+           traffic->mqttPerPeriod, mqtt, wire, wire * 30 / 1e6);
+}
+
+/**
+ * Encode/decode the sample and check every field survives at its resolution
+ */
+static bool roundTrip(const Telemetry_t* t) {
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    Telemetry_t d;
+    if (telemetry_frame_encode(t, frame, sizeof(frame)) != TELEMETRY_FRAME_SIZE ||
+        !telemetry_frame_decode(frame, sizeof(frame), &d)) {
+        return false;
+    }
+    bool ok = d.seq == t->seq && d.uptimeSec == t->uptimeSec && d.rssi == t->rssi &&
+              t->heapFree - d.heapFree < TELEMETRY_HEAP_UNIT && d.outputCount == t->outputCount;
+    for (int i = 0; i < t->outputCount; i++) {
+        const TelemetryOutput_t* a = &t->outputs[i];
+        const TelemetryOutput_t* b = &d.outputs[i];
+        ok = ok && fabsf(a->temp - b->temp) < 0.051f && fabsf(a->target - b->target) < 0.051f &&
+             (isnan(a->humidity) ? isnan(b->humidity) : fabsf(a->humidity - b->humidity) < 0.26f) &&
+             a->power == b->power && a->mode == b->mode && a->flags == b->flags &&
+             fabsf(a->powerW - b->powerW) < 0.051f && a->energyWh == b->energyWh;
+    }
+    return ok;
+}
+
+static int bench(int periodSec, const char* base) {
+    Telemetry_t t;
+    sampleTelemetry(&t);
+    if (!roundTrip(&t)) {
+        fprintf(stderr, "round trip failed\n");
+        return 1;
+    }
+
+    PeriodTraffic_t json = {};
+    PeriodTraffic_t compact = {};
+    jsonPeriod(&t, base, &json);
+    compactPeriod(&t, base, &compact);
+    printDay("json", &json, periodSec, DEFAULT_KEEPALIVE_S);
+    printDay("compact", &compact, periodSec, COMPACT_KEEPALIVE_S);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && !strcmp(argv[1], "bench")) {
+        int periodSec = 30;
+        const char* base = "reptile/thermostat_01";
+        for (int i = 2; i < argc; i++) {
+            if (!strcmp(argv[i], "--period") && i + 1 < argc) {
+                periodSec = atoi(argv[++i]);
+            } else if (!strcmp(argv[i], "--base") && i + 1 < argc) {
+                base = argv[++i];
+            } else {
+                fprintf(stderr, "unknown option %s\n", argv[i]);
+                return 1;
+            }
+        }
+        if (periodSec <= 0) {
+            fprintf(stderr, "--period must be positive\n");
+            return 1;
+        }
+        return bench(periodSec, base);
+    }
+    if (argc >= 2 && (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help"))) {
+        fprintf(stderr, "usage: %s [HEX] | bench [--period S] [--base TOPIC]\n", argv[0]);
+        return 1;
+    }
+    if (argc >= 2) {
+        return decodeHex(argv[1], nullptr) ? 0 : 1;
+    }
+    return decodeStdin();
+}
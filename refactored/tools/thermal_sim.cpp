@@ -0,0 +1,733 @@
+/**
+ * thermal_sim.cpp
+ * Host simulator for heat mat control
+ *
+ * Two-node thermal model: the mat surface (heated, loses heat to the air
+ * and through the floor to the room) and the enclosure air (loses heat to
+ * the room). Sensors are sampled every 2s at DS18B20 resolution and the SSR
+ * is driven with time-proportional cycles, as on the device.
+ *
+ * Scenarios:
+ *   cascade   single-loop PID (pid_control.cpp, as updatePID() runs it on the
+ *             air sensor) vs cascade_control.cpp
+ *             0h warm-up from room temperature to the air target
+ *             4h damp substrate: mat floor losses triple (disturbance at the heater)
+ *             8h room drops 4°C (disturbance at the air)
+ *             10h mode left and re-entered (bumpless restart of both loops)
+ *   schedule  plain schedule vs predictive preheat (thermal_model.cpp), 3 days
+ *             of 07:00 -> 30°C / 21:00 -> 23°C; day 1 is for learning, days 2-3
+ *             are scored on lateness and error after each transition
+ *   ambient   fixed-gain PID vs gain schedule + ambient feedforward
+ *             (gain_schedule.cpp) with the room at 10, 15, 20 and 25°C, scored
+ *             on steady-state error, overshoot and integrator windup
+ *             (how much of the output the I term has to carry)
+ *   windup    anti-windup and bumpless transfer (pid_control.cpp) vs the PID
+ *             before them ("legacy"); "weighted" adds setpoint weight 0.5
+ *             3h door open 15 min (air losses x20), 5h target 28 -> 31,
+ *             7.5h back to 28, 10h manual 30% for an hour, 12.5h Kp 14 -> 8
+ *
+ * Build (from refactored/):
+ *   g++ -O2 -std=gnu++17 -Iinclude tools/thermal_sim.cpp src/control/cascade_control.cpp \
+ *       src/control/thermal_model.cpp src/control/gain_schedule.cpp src/control/pid_control.cpp \
+ *       -o thermal_sim
+ * Run:
+ *   ./thermal_sim [cascade|schedule|ambient|windup|all] [trace.csv]
+ * Prints one JSON line per scenario and controller; exits 1 if the cascade
+ * breaks the surface ceiling, fails to settle or bumps the power when
+ * re-entered, if preheat makes the
+ * schedule later than without it, if feedforward does not reduce the
+ * worst steady-state error of the sweep, if anti-windup does not beat the
+ * legacy PID on error around the door opening and the target steps, if
+ * its overshoot after the door closes passes WINDUP_MAX_DOOR_OVERSHOOT
+ * (legacy has none: its I term is capped at Ki * 100 = 0.6%, so it sits
+ * below target instead), if mode or gain changes still bump the output,
+ * or if setpoint weighting does not reduce the step overshoot.
+ */
+
+#include "cascade_control.h"
+#include "gain_schedule.h"
+#include "pid_control.h"
+#include "thermal_model.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_DT 0.1f                // Control task update period (s)
+#define SIM_HOURS 12
+#define SENSOR_PERIOD 2.0f         // sensor_manager read interval (s)
+#define SENSOR_RES 0.0625f         // DS18B20 12-bit resolution
+#define TP_CYCLE_SEC 30.0f         // Time-prop defaults
+#define TP_MIN_SEC 1.0f
+
+#define AIR_TARGET 28.0f
+#define RESTART_MAX_BUMP 1.0f      // % power a bumpless mode re-entry may move the output
+#define ROOM_C 20.0f
+#define SETTLE_BAND 0.3f
+
+// Firmware PID defaults / limits (output_manager.cpp)
+#define PID_KP 10.0f
+#define PID_KI 0.5f
+#define PID_KD 2.0f
+#define PID_INTEGRAL_MAX 100.0f
+#define PID_MAX_GAP_SEC 5.0f
+
+typedef struct {
+    float surface;      // Mat surface (°C)
+    float air;          // Enclosure air (°C)
+    float room;
+    float capSurface;   // J/K
+    float capAir;
+    float gSurfaceAir;  // W/K
+    float gSurfaceRoom;
+    float gAirRoom;
+    float heaterW;
+} Plant_t;
+
+typedef struct {
+    float integral;
+    float lastError;
+} LegacyPid_t;
+
+typedef struct {
+    const char* name;
+    float peakSurface;
+    float aboveCeilingSec;
+    float warmOvershoot;
+    float settleMin;            // -1 if never settled
+    float dampMaxDev;
+    float dampIae;              // °C·min
+    float roomMaxDev;
+    float roomIae;
+    float energyWh;
+    float restartBump;          // |power change| when the mode is re-entered at 10h (%)
+} Result_t;
+
+static void plantInit(Plant_t* p) {
+    p->surface = ROOM_C;
+    p->air = ROOM_C;
+    p->room = ROOM_C;
+    p->capSurface = 400.0f;     // Mat + glass floor patch
+    p->capAir = 1500.0f;        // Air + furnishings, effective
+    p->gSurfaceAir = 0.5f;
+    p->gSurfaceRoom = 0.2f;
+    p->gAirRoom = 0.6f;
+    p->heaterW = 20.0f;
+}
+
+static void plantStep(Plant_t* p, bool heaterOn, float dt) {
+    float qHeat = heaterOn ? p->heaterW : 0.0f;
+    float qSa = p->gSurfaceAir * (p->surface - p->air);
+    float qSr = p->gSurfaceRoom * (p->surface - p->room);
+    float qAr = p->gAirRoom * (p->air - p->room);
+    p->surface += (qHeat - qSa - qSr) / p->capSurface * dt;
+    p->air += (qSa - qAr) / p->capAir * dt;
+}
+
+static float quantize(float t) {
+    return floorf(t / SENSOR_RES) * SENSOR_RES;
+}
+
+// PID before anti-windup: integral of error clamped at +-100 °C·s
+// regardless of gains, D on error, reset to zero on mode/gain changes
+static float legacyPidStep(LegacyPid_t* s, float kp, float ki, float kd, float target, float temp,
+                           float dt) {
+    float error = target - temp;
+    s->integral += error * dt;
+    if (s->integral > PID_INTEGRAL_MAX) s->integral = PID_INTEGRAL_MAX;
+    if (s->integral < -PID_INTEGRAL_MAX) s->integral = -PID_INTEGRAL_MAX;
+    float out = kp * error + ki * s->integral + kd * (error - s->lastError) / dt;
+    s->lastError = error;
+    return out < 0.0f ? 0.0f : (out > 100.0f ? 100.0f : out);
+}
+
+// Firmware limits (output_manager.cpp computePID()) around the given gains
+static PidControlParams_t pidParams(float kp, float ki, float kd, float weight,
+                                    const GainSchedule_t* schedule) {
+    PidControlParams_t params;
+    params.kp = kp;
+    params.ki = ki;
+    params.kd = kd;
+    params.setpointWeight = weight;
+    params.outMin = 0.0f;
+    params.outMax = 100.0f;
+    params.integralMax = PID_INTEGRAL_MAX;
+    params.maxGapSec = PID_MAX_GAP_SEC;
+    params.schedule = schedule;
+    return params;
+}
+
+// Same cycle rules as updateTimeProp()
+static bool timePropOn(float duty, float timeInCycle) {
+    if (duty < 2.0f) return false;
+    if (duty > 98.0f) return true;
+    float onSec = duty / 100.0f * TP_CYCLE_SEC;
+    if (onSec < TP_MIN_SEC) onSec = TP_MIN_SEC;
+    if (onSec > TP_CYCLE_SEC - TP_MIN_SEC) onSec = TP_CYCLE_SEC - TP_MIN_SEC;
+    return timeInCycle < onSec;
+}
+
+static Result_t runCascade(bool cascade, const CascadeParams_t* params, FILE* trace) {
+    Plant_t plant;
+    plantInit(&plant);
+    PidControlParams_t pidDefaults = pidParams(PID_KP, PID_KI, PID_KD, 1.0f, nullptr);
+    PidControlState_t pid = {};
+    pid_control_reset(&pid, false);
+    CascadeState_t cs;
+    cascade_reset(&cs, false);
+
+    Result_t r;
+    memset(&r, 0, sizeof(r));
+    r.name = cascade ? "cascade" : "pid";
+    r.settleMin = -1.0f;
+
+    float airRead = quantize(plant.air);
+    float surfRead = quantize(plant.surface);
+    float sinceRead = 0.0f;
+    float cycleTime = 0.0f;
+    float duty = 0.0f;
+    float lastOut = 0.0f;
+    float warmEnd = 4 * 3600.0f;
+    float lastOutside = 0.0f;
+    int steps = (int)(SIM_HOURS * 3600.0f / SIM_DT);
+
+    for (int n = 0; n < steps; n++) {
+        float t = n * SIM_DT;
+
+        // Disturbances
+        if (n == (int)(4 * 3600.0f / SIM_DT)) plant.gSurfaceRoom *= 3.0f;
+        if (n == (int)(8 * 3600.0f / SIM_DT)) plant.room -= 4.0f;
+
+        sinceRead += SIM_DT;
+        if (sinceRead >= SENSOR_PERIOD) {
+            airRead = quantize(plant.air);
+            surfRead = quantize(plant.surface);
+            sinceRead = 0.0f;
+        }
+
+        // 10h: the mode is left and entered again (from Manual, say)
+        bool restart = (n == (int)(10 * 3600.0f / SIM_DT));
+        float before = duty;
+        if (restart) {
+            if (cascade) {
+                cascade_reset(&cs, true);
+            } else {
+                pid_control_reset(&pid, true);
+            }
+        }
+
+        if (cascade) {
+            duty = cascade_update(params, &cs, AIR_TARGET, airRead, surfRead, 1.0f, duty, SIM_DT);
+        } else {
+            duty = pid_control_step(&pidDefaults, &pid, AIR_TARGET, airRead, NAN, duty, SIM_DT);
+        }
+        if (restart) r.restartBump = fabsf(duty - before);
+
+        cycleTime += SIM_DT;
+        if (cycleTime >= TP_CYCLE_SEC) cycleTime = 0.0f;
+        bool on = timePropOn(duty, cycleTime);
+        if (cascade && cs.atCeiling) on = false;
+        plantStep(&plant, on, SIM_DT);
+        if (on) r.energyWh += plant.heaterW * SIM_DT / 3600.0f;
+
+        // Metrics
+        if (plant.surface > r.peakSurface) r.peakSurface = plant.surface;
+        if (plant.surface > params->surfaceMaxC) r.aboveCeilingSec += SIM_DT;
+        float dev = fabsf(plant.air - AIR_TARGET);
+        if (t < warmEnd) {
+            if (plant.air - AIR_TARGET > r.warmOvershoot) r.warmOvershoot = plant.air - AIR_TARGET;
+            if (dev > SETTLE_BAND) lastOutside = t;
+        } else if (t < 8 * 3600.0f) {
+            if (dev > r.dampMaxDev) r.dampMaxDev = dev;
+            r.dampIae += dev * SIM_DT / 60.0f;
+        } else {
+            if (dev > r.roomMaxDev) r.roomMaxDev = dev;
+            r.roomIae += dev * SIM_DT / 60.0f;
+        }
+
+        if (trace && t - lastOut >= 10.0f) {
+            fprintf(trace, "%s,%.0f,%.3f,%.3f,%.1f,%.2f\n", r.name, t, plant.air, plant.surface,
+                    duty, cascade ? cs.surfaceSetpoint : 0.0f);
+            lastOut = t;
+        }
+    }
+
+    if (lastOutside < warmEnd - 30 * 60.0f) {
+        r.settleMin = lastOutside / 60.0f;
+    }
+    return r;
+}
+
+static void printResult(const Result_t* r) {
+    printf("{\"scenario\":\"cascade\",\"controller\":\"%s\",\"peakSurfaceC\":%.2f,\"aboveCeilingSec\":%.0f,"
+           "\"warmOvershootC\":%.2f,\"settleMin\":%.1f,\"dampMaxDevC\":%.2f,\"dampIaeCmin\":%.1f,"
+           "\"roomMaxDevC\":%.2f,\"roomIaeCmin\":%.1f,\"energyWh\":%.1f,\"restartBumpPct\":%.1f}\n",
+           r->name, r->peakSurface, r->aboveCeilingSec, r->warmOvershoot, r->settleMin,
+           r->dampMaxDev, r->dampIae, r->roomMaxDev, r->roomIae, r->energyWh, r->restartBump);
+}
+
+// ===== SCHEDULE SCENARIO =====
+
+#define SCHED_DAYS 3
+#define SCHED_SCORE_MIN 120.0f     // Error window after each transition
+#define SCHED_ON_TIME_BAND 0.5f
+
+typedef struct {
+    int minuteOfDay;
+    float target;
+} SimSlot_t;
+
+static const SimSlot_t simSlots[] = {
+    {7 * 60, 30.0f},
+    {21 * 60, 23.0f},
+};
+#define SIM_SLOT_COUNT (int)(sizeof(simSlots) / sizeof(simSlots[0]))
+
+typedef struct {
+    const char* name;
+    float lateMin;              // Mean minutes after an upward slot until within band
+    float maxLateMin;
+    float mae;                  // Mean |air - slot target| in the window after each slot
+    float preheatMin;           // Mean minutes the ramp started before upward slots
+    float energyWh;
+    float modelHeat;
+    float modelLoss;
+    bool modelValid;
+} SchedResult_t;
+
+// Active and next slot, as updateSchedule() picks them
+static void findSlots(int minuteOfDay, int* active, int* next, float* minutesToNext) {
+    *active = SIM_SLOT_COUNT - 1;
+    for (int i = 0; i < SIM_SLOT_COUNT; i++) {
+        if (simSlots[i].minuteOfDay <= minuteOfDay) *active = i;
+    }
+    *next = (*active + 1) % SIM_SLOT_COUNT;
+    int until = simSlots[*next].minuteOfDay - minuteOfDay;
+    if (until <= 0) until += 24 * 60;
+    *minutesToNext = (float)until;
+}
+
+static SchedResult_t runSchedule(bool predictive, FILE* trace) {
+    Plant_t plant;
+    plantInit(&plant);
+    plant.air = 23.0f;
+    plant.surface = 25.0f;
+    PidControlParams_t params = pidParams(PID_KP, PID_KI, PID_KD, 1.0f, nullptr);
+    PidControlState_t pid = {};
+    pid_control_reset(&pid, false);
+    ThermalModel_t model;
+    thermal_model_init(&model);
+
+    SchedResult_t r;
+    memset(&r, 0, sizeof(r));
+    r.name = predictive ? "predictive" : "schedule";
+
+    float airRead = quantize(plant.air);
+    float sinceRead = 0.0f;
+    float cycleTime = 0.0f;
+    float lastOut = 0.0f;
+    int steps = (int)(SCHED_DAYS * 24 * 3600.0f / SIM_DT);
+
+    // Scoring state
+    float slotStart = -1.0f;        // Sim time the scored slot began
+    float slotTarget = 0.0f;
+    bool slotUp = false;
+    bool reached = false;
+    int lateCount = 0;
+    float maeSum = 0.0f;
+    float maeSec = 0.0f;
+    float rampStart = -1.0f;
+    int preheatCount = 0;
+    int lastActive = -1;
+
+    for (int n = 0; n < steps; n++) {
+        float t = n * SIM_DT;
+        int minuteOfDay = (int)(t / 60.0f) % (24 * 60);
+        bool scoring = t >= 24 * 3600.0f;
+
+        sinceRead += SIM_DT;
+        if (sinceRead >= SENSOR_PERIOD) {
+            airRead = quantize(plant.air);
+            sinceRead = 0.0f;
+        }
+
+        int active, next;
+        float minutesToNext;
+        findSlots(minuteOfDay, &active, &next, &minutesToNext);
+        float target = simSlots[active].target;
+        float setpoint = target;
+        if (predictive) {
+            setpoint = thermal_model_ramp_setpoint(&model, target, simSlots[next].target,
+                                                   minutesToNext - fmodf(t, 60.0f) / 60.0f);
+            if (setpoint > target && rampStart < 0.0f) rampStart = t;
+        }
+
+        // Slot change
+        if (active != lastActive) {
+            if (lastActive >= 0 && scoring) {
+                slotStart = t;
+                slotTarget = target;
+                slotUp = target > simSlots[lastActive].target;
+                reached = false;
+                if (slotUp && rampStart >= 0.0f) {
+                    r.preheatMin += (t - rampStart) / 60.0f;
+                    preheatCount++;
+                }
+            }
+            rampStart = -1.0f;
+            lastActive = active;
+        }
+
+        float duty = pid_control_step(&params, &pid, setpoint, airRead, NAN, 0.0f, SIM_DT);
+        cycleTime += SIM_DT;
+        if (cycleTime >= TP_CYCLE_SEC) cycleTime = 0.0f;
+        bool on = timePropOn(duty, cycleTime);
+        plantStep(&plant, on, SIM_DT);
+        thermal_model_update(&model, airRead, on ? 100.0f : 0.0f, SIM_DT);
+        if (on && scoring) r.energyWh += plant.heaterW * SIM_DT / 3600.0f;
+
+        // Score the window after each slot change
+        if (slotStart >= 0.0f && t - slotStart < SCHED_SCORE_MIN * 60.0f) {
+            maeSum += fabsf(plant.air - slotTarget) * SIM_DT;
+            maeSec += SIM_DT;
+            if (slotUp && !reached && plant.air >= slotTarget - SCHED_ON_TIME_BAND) {
+                float late = (t - slotStart) / 60.0f;
+                r.lateMin += late;
+                if (late > r.maxLateMin) r.maxLateMin = late;
+                lateCount++;
+                reached = true;
+            }
+        }
+
+        if (trace && t - lastOut >= 30.0f) {
+            fprintf(trace, "%s,%.0f,%.3f,%.3f,%.1f,%.2f\n", r.name, t, plant.air, plant.surface,
+                    duty, setpoint);
+            lastOut = t;
+        }
+    }
+
+    if (lateCount) r.lateMin /= lateCount;
+    if (maeSec > 0.0f) r.mae = maeSum / maeSec;
+    if (preheatCount) r.preheatMin /= preheatCount;
+    r.modelHeat = model.theta[0];
+    r.modelLoss = -model.theta[1];
+    r.modelValid = thermal_model_valid(&model);
+    return r;
+}
+
+static void printSchedResult(const SchedResult_t* r) {
+    printf("{\"scenario\":\"schedule\",\"controller\":\"%s\",\"lateMin\":%.1f,\"maxLateMin\":%.1f,"
+           "\"maeC\":%.2f,\"preheatMin\":%.1f,\"energyWh\":%.1f,\"modelValid\":%s,"
+           "\"modelHeatCPerMin\":%.3f,\"modelLossPerMin\":%.4f}\n",
+           r->name, r->lateMin, r->maxLateMin, r->mae, r->preheatMin, r->energyWh,
+           r->modelValid ? "true" : "false", r->modelHeat, r->modelLoss);
+}
+
+// ===== AMBIENT SWEEP SCENARIO =====
+
+#define SWEEP_HOURS 8
+#define SWEEP_HEATER_W 30.0f        // Enough to hold the target in a 10°C room
+#define SWEEP_SS_START_H 6          // Steady-state window: last 2 hours
+
+typedef struct {
+    const char* name;
+    float room;
+    float ssErr;                // Mean |error| in the steady-state window
+    float overshoot;
+    float meanITerm;            // Mean |Ki * integral| (% power)
+    float maxITerm;             // Largest |Ki * integral| (% power)
+} SweepResult_t;
+
+static void sweepSchedule(GainSchedule_t* gs) {
+    // Feedforward carries most of the steady-state power (ffGain is about
+    // 85% of this plant's %/°C), so the integral only trims and can be slow
+    // (Ti ~ 4-5h); P is softer at light load, firmer at heavy load
+    static const GainPoint_t points[] = {
+        {3.0f, 14.0f, 0.001f, 0.0f},
+        {8.0f, 16.0f, 0.001f, 0.0f},
+        {13.0f, 18.0f, 0.001f, 0.0f},
+        {18.0f, 20.0f, 0.001f, 0.0f},
+    };
+    gain_schedule_init(gs);
+    gs->enabled = true;
+    gs->count = GAIN_SCHEDULE_POINTS;
+    memcpy(gs->points, points, sizeof(points));
+    gs->ffGain = 3.0f;
+    gain_schedule_prepare(gs);
+}
+
+static SweepResult_t runSweep(bool scheduled, float room, FILE* trace) {
+    Plant_t plant;
+    plantInit(&plant);
+    plant.room = room;
+    plant.air = room;
+    plant.surface = room;
+    plant.heaterW = SWEEP_HEATER_W;
+    GainSchedule_t gs;
+    sweepSchedule(&gs);
+    PidControlParams_t params = pidParams(PID_KP, PID_KI, PID_KD, 1.0f, scheduled ? &gs : nullptr);
+    PidControlState_t pid = {};
+    pid_control_reset(&pid, false);
+
+    SweepResult_t r;
+    memset(&r, 0, sizeof(r));
+    r.name = scheduled ? "scheduled" : "pid";
+    r.room = room;
+
+    float airRead = quantize(plant.air);
+    float roomRead = quantize(room);
+    float sinceRead = 0.0f;
+    float cycleTime = 0.0f;
+    float lastOut = 0.0f;
+    float ssSec = 0.0f;
+    int steps = (int)(SWEEP_HOURS * 3600.0f / SIM_DT);
+
+    for (int n = 0; n < steps; n++) {
+        float t = n * SIM_DT;
+        sinceRead += SIM_DT;
+        if (sinceRead >= SENSOR_PERIOD) {
+            airRead = quantize(plant.air);
+            sinceRead = 0.0f;
+        }
+
+        float duty = pid_control_step(&params, &pid, AIR_TARGET, airRead, roomRead, 0.0f, SIM_DT);
+
+        cycleTime += SIM_DT;
+        if (cycleTime >= TP_CYCLE_SEC) cycleTime = 0.0f;
+        plantStep(&plant, timePropOn(duty, cycleTime), SIM_DT);
+
+        float iTerm = fabsf(pid.integral);
+        if (iTerm > r.maxITerm) r.maxITerm = iTerm;
+        r.meanITerm += iTerm * SIM_DT;
+        if (plant.air - AIR_TARGET > r.overshoot) r.overshoot = plant.air - AIR_TARGET;
+        if (t >= SWEEP_SS_START_H * 3600.0f) {
+            r.ssErr += fabsf(plant.air - AIR_TARGET) * SIM_DT;
+            ssSec += SIM_DT;
+        }
+
+        if (trace && t - lastOut >= 30.0f) {
+            fprintf(trace, "%s@%.0f,%.0f,%.3f,%.3f,%.1f,%.2f\n", r.name, room, t, plant.air,
+                    plant.surface, duty, AIR_TARGET);
+            lastOut = t;
+        }
+    }
+    if (ssSec > 0.0f) r.ssErr /= ssSec;
+    r.meanITerm /= steps * SIM_DT;
+    return r;
+}
+
+static void printSweepResult(const SweepResult_t* r) {
+    printf("{\"scenario\":\"ambient\",\"controller\":\"%s\",\"roomC\":%.0f,\"ssErrC\":%.2f,"
+           "\"overshootC\":%.2f,\"meanITermPct\":%.1f,\"maxITermPct\":%.1f}\n",
+           r->name, r->room, r->ssErr, r->overshoot, r->meanITerm, r->maxITerm);
+}
+
+// ===== WINDUP / TRANSFER SCENARIO =====
+
+#define WINDUP_HOURS 14
+#define DOOR_OPEN_H 3.0f            // Door open: air losses x DOOR_LOSS
+#define DOOR_OPEN_MIN 15.0f
+#define DOOR_LOSS 20.0f
+#define STEP_UP_H 5.0f              // Target 28 -> 31
+#define STEP_UP_TARGET 31.0f
+#define STEP_DOWN_H 7.5f            // Target back to 28
+#define MANUAL_H 10.0f              // Manual 30% for an hour, then back to PID
+#define MANUAL_POWER 30.0f
+#define RESUME_H 11.0f
+#define GAIN_H 12.5f                // Kp 14 -> 8 from the web page
+#define GAIN_KP 8.0f
+#define WINDUP_KP 14.0f             // Tuned for this plant (Ti 40 min, no D)
+#define WINDUP_KI 0.006f
+#define WINDUP_MAX_DOOR_OVERSHOOT 1.5f  // °C: anti-windup recovers the lost heat, with a bounded overshoot
+
+typedef struct {
+    const char* name;
+    float doorOvershoot;        // Peak above target after the door closes
+    float doorIae;              // °C·min from door open to the target step
+    float stepOvershoot;        // Peak above the new target after the step up
+    float stepUndershoot;       // Peak below the target after the step down
+    float resumeBump;           // |first PID output - manual power| (%)
+    float resumeIae;            // °C·min in the 90 min after resuming
+    float gainBump;             // |output change| across the gain change (%)
+} WindupResult_t;
+
+// legacy: PID before anti-windup, reset on mode and gain changes
+static WindupResult_t runWindup(const char* name, bool legacy, float weight, FILE* trace) {
+    Plant_t plant;
+    plantInit(&plant);
+    plant.heaterW = SWEEP_HEATER_W;
+    float gAirRoom = plant.gAirRoom;
+    LegacyPid_t old = {0.0f, 0.0f};
+    PidControlParams_t params = pidParams(WINDUP_KP, WINDUP_KI, 0.0f, weight, nullptr);
+    PidControlState_t pid = {};
+    pid_control_reset(&pid, false);
+
+    WindupResult_t r;
+    memset(&r, 0, sizeof(r));
+    r.name = name;
+
+    float airRead = quantize(plant.air);
+    float sinceRead = 0.0f;
+    float cycleTime = 0.0f;
+    float duty = 0.0f;
+    float lastOut = 0.0f;
+    float target = AIR_TARGET;
+    bool manual = false;
+    bool resumed = false;
+    float beforeGain = -1.0f;
+    int steps = (int)(WINDUP_HOURS * 3600.0f / SIM_DT);
+
+    for (int n = 0; n < steps; n++) {
+        float t = n * SIM_DT;
+        float h = t / 3600.0f;
+
+        // Events
+        bool doorOpen = h >= DOOR_OPEN_H && h < DOOR_OPEN_H + DOOR_OPEN_MIN / 60.0f;
+        plant.gAirRoom = doorOpen ? gAirRoom * DOOR_LOSS : gAirRoom;
+        if (n == (int)(STEP_UP_H * 3600.0f / SIM_DT)) target = STEP_UP_TARGET;
+        if (n == (int)(STEP_DOWN_H * 3600.0f / SIM_DT)) target = AIR_TARGET;
+        if (n == (int)(MANUAL_H * 3600.0f / SIM_DT)) manual = true;
+        if (n == (int)(RESUME_H * 3600.0f / SIM_DT)) {
+            // output_manager_set_mode(PID)
+            manual = false;
+            if (legacy) {
+                old.integral = 0.0f;
+                old.lastError = 0.0f;
+            } else {
+                pid_control_reset(&pid, true);
+            }
+        }
+        bool gainChange = n == (int)(GAIN_H * 3600.0f / SIM_DT);
+        if (gainChange) {
+            // output_manager_set_pid_params()
+            beforeGain = duty;
+            params.kp = GAIN_KP;
+            if (legacy) {
+                old.integral = 0.0f;
+            } else {
+                pid_control_reset(&pid, true);
+            }
+        }
+
+        sinceRead += SIM_DT;
+        if (sinceRead >= SENSOR_PERIOD) {
+            airRead = quantize(plant.air);
+            sinceRead = 0.0f;
+        }
+
+        if (manual) {
+            duty = MANUAL_POWER;
+        } else if (legacy) {
+            duty = legacyPidStep(&old, params.kp, WINDUP_KI, 0.0f, target, airRead, SIM_DT);
+        } else {
+            duty = pid_control_step(&params, &pid, target, airRead, NAN, duty, SIM_DT);
+        }
+        if (h >= RESUME_H && !resumed) {
+            r.resumeBump = fabsf(duty - MANUAL_POWER);
+            resumed = true;
+        }
+        if (gainChange) r.gainBump = fabsf(duty - beforeGain);
+
+        cycleTime += SIM_DT;
+        if (cycleTime >= TP_CYCLE_SEC) cycleTime = 0.0f;
+        plantStep(&plant, timePropOn(duty, cycleTime), SIM_DT);
+
+        // Metrics
+        float err = plant.air - target;
+        if (h >= DOOR_OPEN_H && h < STEP_UP_H) {
+            if (!doorOpen && err > r.doorOvershoot) r.doorOvershoot = err;
+            r.doorIae += fabsf(err) * SIM_DT / 60.0f;
+        }
+        if (h >= STEP_UP_H && h < STEP_DOWN_H && err > r.stepOvershoot) r.stepOvershoot = err;
+        if (h >= STEP_DOWN_H + 0.5f && h < MANUAL_H && -err > r.stepUndershoot) r.stepUndershoot = -err;
+        if (h >= RESUME_H && h < RESUME_H + 1.5f) r.resumeIae += fabsf(err) * SIM_DT / 60.0f;
+
+        if (trace && t - lastOut >= 10.0f) {
+            fprintf(trace, "%s,%.0f,%.3f,%.3f,%.1f,%.2f\n", r.name, t, plant.air, plant.surface,
+                    duty, target);
+            lastOut = t;
+        }
+    }
+    return r;
+}
+
+static void printWindupResult(const WindupResult_t* r) {
+    printf("{\"scenario\":\"windup\",\"controller\":\"%s\",\"doorOvershootC\":%.2f,"
+           "\"doorIaeCmin\":%.1f,\"stepOvershootC\":%.2f,\"stepUndershootC\":%.2f,"
+           "\"resumeBumpPct\":%.1f,\"resumeIaeCmin\":%.1f,\"gainBumpPct\":%.1f}\n",
+           r->name, r->doorOvershoot, r->doorIae, r->stepOvershoot, r->stepUndershoot,
+           r->resumeBump, r->resumeIae, r->gainBump);
+}
+
+int main(int argc, char** argv) {
+    const char* scenario = (argc > 1) ? argv[1] : "all";
+    bool all = strcmp(scenario, "all") == 0;
+    bool doCascade = all || strcmp(scenario, "cascade") == 0;
+    bool doSchedule = all || strcmp(scenario, "schedule") == 0;
+    bool doAmbient = all || strcmp(scenario, "ambient") == 0;
+    bool doWindup = all || strcmp(scenario, "windup") == 0;
+    if (!doCascade && !doSchedule && !doAmbient && !doWindup) {
+        fprintf(stderr, "usage: %s [cascade|schedule|ambient|windup|all] [trace.csv]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* trace = nullptr;
+    if (argc > 2) {
+        trace = fopen(argv[2], "w");
+        if (!trace) {
+            fprintf(stderr, "cannot open %s\n", argv[2]);
+            return 2;
+        }
+        fprintf(trace, "controller,t,air,surface,power,setpoint\n");
+    }
+
+    bool ok = true;
+    if (doCascade) {
+        CascadeParams_t params;
+        cascade_default_params(&params);
+
+        Result_t pid = runCascade(false, &params, trace);
+        Result_t cascade = runCascade(true, &params, trace);
+        printResult(&pid);
+        printResult(&cascade);
+        ok = ok && cascade.peakSurface <= params.surfaceMaxC + 0.5f && cascade.settleMin >= 0.0f &&
+             cascade.restartBump < RESTART_MAX_BUMP;
+    }
+    if (doSchedule) {
+        SchedResult_t plain = runSchedule(false, trace);
+        SchedResult_t predictive = runSchedule(true, trace);
+        printSchedResult(&plain);
+        printSchedResult(&predictive);
+        ok = ok && predictive.modelValid && predictive.lateMin <= plain.lateMin;
+    }
+    if (doAmbient) {
+        static const float rooms[] = {10.0f, 15.0f, 20.0f, 25.0f};
+        float worstPid = 0.0f;
+        float worstScheduled = 0.0f;
+        for (float room : rooms) {
+            SweepResult_t pid = runSweep(false, room, trace);
+            SweepResult_t scheduled = runSweep(true, room, trace);
+            printSweepResult(&pid);
+            printSweepResult(&scheduled);
+            if (pid.ssErr > worstPid) worstPid = pid.ssErr;
+            if (scheduled.ssErr > worstScheduled) worstScheduled = scheduled.ssErr;
+        }
+        ok = ok && worstScheduled < worstPid;
+    }
+    if (doWindup) {
+        WindupResult_t legacy = runWindup("legacy", true, 1.0f, trace);
+        WindupResult_t antiWindup = runWindup("antiwindup", false, 1.0f, trace);
+        WindupResult_t weighted = runWindup("weighted", false, 0.5f, trace);
+        printWindupResult(&legacy);
+        printWindupResult(&antiWindup);
+        printWindupResult(&weighted);
+        ok = ok && antiWindup.doorIae < legacy.doorIae &&
+             antiWindup.doorOvershoot <= WINDUP_MAX_DOOR_OVERSHOOT &&
+             antiWindup.stepUndershoot < legacy.stepUndershoot &&
+             antiWindup.resumeBump < legacy.resumeBump && antiWindup.resumeIae < legacy.resumeIae &&
+             antiWindup.gainBump < legacy.gainBump &&
+             weighted.stepOvershoot < antiWindup.stepOvershoot;
+    }
+
+    if (trace) fclose(trace);
+    return ok ? 0 : 1;
+}